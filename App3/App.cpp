@@ -200,6 +200,10 @@ void App::OnDpiChanged(DisplayInformation^ sender, Object^ args)
 	// you should always retrieve it using the GetDpi method.
 	// See DeviceResources.cpp for more details.
 //	m_main->OnWindowSizeChanged();
+	if (m_main != nullptr)
+	{
+		m_main->SetLogicalDpi(sender->LogicalDpi);
+	}
 }
 
 void App::OnOrientationChanged(DisplayInformation^ sender, Object^ args)
@@ -0,0 +1,379 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <ppl.h>
+
+#include "AssetPackage.h"
+#include "DerivedDataCache.h"
+#include "LZCodec.h"
+
+namespace WoodenEngine
+{
+	namespace
+	{
+		uint64 AlignOffset(uint64 Offset)
+		{
+			return (Offset + AssetPackageAlignment - 1) & ~(AssetPackageAlignment - 1);
+		}
+	}
+
+	FAssetPackage::FAssetPackage(const std::string& FilePath):
+		MappedFile(FilePath)
+	{
+		const auto Data = MappedFile.GetData();
+		const auto Size = MappedFile.GetSize();
+		if (Size < sizeof(FAssetPackageHeader))
+		{
+			throw std::invalid_argument("Asset package is truncated: " + FilePath);
+		}
+
+		Header = reinterpret_cast<const FAssetPackageHeader*>(Data);
+		if (Header->Magic != AssetPackageMagic || Header->Version != AssetPackageVersion)
+		{
+			throw std::invalid_argument("File isn't an asset package of the current version: " + FilePath);
+		}
+
+		const auto EntriesSize = static_cast<uint64>(Header->NumEntries)*sizeof(FAssetPackageEntry);
+		if (Header->EntriesOffset % AssetPackageAlignment != 0 ||
+			Header->EntriesOffset > Size || EntriesSize > Size - Header->EntriesOffset ||
+			Header->NamesOffset > Size || Header->NamesSize > Size - Header->NamesOffset)
+		{
+			throw std::invalid_argument("Asset package has the table of contents out of bounds: " + FilePath);
+		}
+
+		Entries = reinterpret_cast<const FAssetPackageEntry*>(Data + Header->EntriesOffset);
+		Names = reinterpret_cast<const char*>(Data + Header->NamesOffset);
+
+		for (uint32 iEntry = 0; iEntry < Header->NumEntries; ++iEntry)
+		{
+			const auto& Entry = Entries[iEntry];
+
+			const auto bDataInBounds = Entry.Offset <= Size && Entry.Size <= Size - Entry.Offset;
+			const auto bNameInBounds = Entry.NameOffset <= Header->NamesSize &&
+				Entry.NameSize <= Header->NamesSize - Entry.NameOffset;
+			const auto bSorted = iEntry == 0 || Entries[iEntry - 1].NameHash < Entry.NameHash;
+			const auto bValidSize = Entry.Compression == EAssetCompression::LZ ||
+				(Entry.Compression == EAssetCompression::None && Entry.Size == Entry.UncompressedSize);
+			if (!bDataInBounds || !bNameInBounds || !bSorted || !bValidSize)
+			{
+				throw std::invalid_argument("Asset package has an invalid entry: " + FilePath);
+			}
+		}
+	}
+
+	const FAssetPackageEntry* FAssetPackage::FindEntry(const std::string& Name) const
+	{
+		const auto NormalizedName = NormalizeName(Name);
+		const auto NameHash = HashName(NormalizedName);
+
+		const auto EntriesEnd = Entries + Header->NumEntries;
+		const auto Entry = std::lower_bound(Entries, EntriesEnd, NameHash,
+			[](const FAssetPackageEntry& Entry, uint64 NameHash)
+		{
+			return Entry.NameHash < NameHash;
+		});
+
+		if (Entry == EntriesEnd || Entry->NameHash != NameHash)
+		{
+			return nullptr;
+		}
+
+		// Hashes of names are unique in a package, but the name may be not there
+		if (NormalizedName.compare(0, std::string::npos, Names + Entry->NameOffset, Entry->NameSize) != 0)
+		{
+			return nullptr;
+		}
+
+		return Entry;
+	}
+
+	const FAssetPackageEntry* FAssetPackage::FindEntry(const std::wstring& Name) const
+	{
+		const auto NameLength = WideCharToMultiByte(
+			CP_UTF8, 0, Name.c_str(), static_cast<int>(Name.size()), nullptr, 0, nullptr, nullptr);
+		std::string NameUTF8(NameLength, '\0');
+		WideCharToMultiByte(CP_UTF8, 0, Name.c_str(), static_cast<int>(Name.size()),
+			&NameUTF8[0], NameLength, nullptr, nullptr);
+
+		return FindEntry(NameUTF8);
+	}
+
+	const uint8* FAssetPackage::GetEntryData(const FAssetPackageEntry& Entry) const noexcept
+	{
+		return MappedFile.GetData() + Entry.Offset;
+	}
+
+	std::vector<uint8> FAssetPackage::ReadEntry(const FAssetPackageEntry& Entry) const
+	{
+		const auto EntryData = GetEntryData(Entry);
+		if (Entry.Compression == EAssetCompression::None)
+		{
+			return std::vector<uint8>(EntryData, EntryData + Entry.Size);
+		}
+
+		std::vector<uint8> Data(static_cast<std::size_t>(Entry.UncompressedSize));
+		FLZCodec::Decompress(EntryData, Entry.Size, Data.data(), Entry.UncompressedSize);
+		return Data;
+	}
+
+	std::string FAssetPackage::GetEntryName(const FAssetPackageEntry& Entry) const
+	{
+		return std::string(Names + Entry.NameOffset, Entry.NameSize);
+	}
+
+	uint32 FAssetPackage::GetNumEntries() const noexcept
+	{
+		return Header->NumEntries;
+	}
+
+	std::string FAssetPackage::GetSourceKey() const
+	{
+		const auto KeyEnd = std::find(Header->SourceKey, Header->SourceKey + sizeof(Header->SourceKey), '\0');
+		return std::string(Header->SourceKey, KeyEnd);
+	}
+
+	const std::string& FAssetPackage::GetFilePath() const noexcept
+	{
+		return MappedFile.GetFilePath();
+	}
+
+	std::string FAssetPackage::NormalizeName(const std::string& Name)
+	{
+		std::string NormalizedName;
+		NormalizedName.reserve(Name.size());
+		for (auto Char : Name)
+		{
+			if (Char == '/')
+			{
+				Char = '\\';
+			}
+			else if (Char >= 'A' && Char <= 'Z')
+			{
+				Char = Char - 'A' + 'a';
+			}
+			NormalizedName.push_back(Char);
+		}
+
+		if (NormalizedName.compare(0, 2, ".\\") == 0)
+		{
+			NormalizedName.erase(0, 2);
+		}
+
+		return NormalizedName;
+	}
+
+	uint64 FAssetPackage::HashName(const std::string& Name)
+	{
+		uint64 Hash = 14695981039346656037ULL;
+		for (const auto Char : Name)
+		{
+			Hash ^= static_cast<uint8>(Char);
+			Hash *= 1099511628211ULL;
+		}
+
+		return Hash;
+	}
+
+	void FAssetPackageWriter::AddFile(const std::string& FilePath, bool bCompress)
+	{
+		CheckName(FilePath);
+
+		FSourceEntry SourceEntry;
+		SourceEntry.Name = FAssetPackage::NormalizeName(FilePath);
+		SourceEntry.File = std::make_unique<DX::FMappedFile>(FilePath);
+		SourceEntry.bCompress = bCompress;
+		SourceEntries.push_back(std::move(SourceEntry));
+	}
+
+	void FAssetPackageWriter::AddData(const std::string& Name, std::vector<uint8>&& Data, bool bCompress)
+	{
+		CheckName(Name);
+
+		FSourceEntry SourceEntry;
+		SourceEntry.Name = FAssetPackage::NormalizeName(Name);
+		SourceEntry.Bytes = std::move(Data);
+		SourceEntry.bCompress = bCompress;
+		SourceEntries.push_back(std::move(SourceEntry));
+	}
+
+	void FAssetPackageWriter::CheckName(const std::string& Name) const
+	{
+		const auto NormalizedName = FAssetPackage::NormalizeName(Name);
+		const auto NameHash = FAssetPackage::HashName(NormalizedName);
+		for (const auto& SourceEntry : SourceEntries)
+		{
+			if (SourceEntry.Name == NormalizedName)
+			{
+				throw std::invalid_argument("Asset package already has entry " + NormalizedName);
+			}
+
+			if (FAssetPackage::HashName(SourceEntry.Name) == NameHash)
+			{
+				throw std::invalid_argument("Names' hashes collide in asset package: " +
+					NormalizedName + " and " + SourceEntry.Name);
+			}
+		}
+	}
+
+	FAssetPackageStats FAssetPackageWriter::Save(const std::string& FilePath, const std::string& SourceKey) const
+	{
+		const auto StartTime = std::chrono::high_resolution_clock::now();
+
+		FAssetPackageHeader Header;
+		if (SourceKey.size() >= sizeof(Header.SourceKey))
+		{
+			throw std::invalid_argument("Source key of asset package is too long: " + SourceKey);
+		}
+
+		const auto NumEntries = static_cast<uint32>(SourceEntries.size());
+		std::vector<FAssetPackageEntry> Entries(NumEntries);
+		std::vector<std::vector<uint8>> CompressedData(NumEntries);
+		std::vector<const uint8*> EntriesData(NumEntries);
+
+		// Entries are compressed independently, so they're spread over all cores
+		concurrency::parallel_for(uint32(0), NumEntries, [this, &Entries, &CompressedData, &EntriesData](uint32 iEntry)
+		{
+			const auto& SourceEntry = SourceEntries[iEntry];
+			const auto Data = SourceEntry.File ? SourceEntry.File->GetData() : SourceEntry.Bytes.data();
+			const auto Size = SourceEntry.File ? SourceEntry.File->GetSize() : SourceEntry.Bytes.size();
+
+			auto& Entry = Entries[iEntry];
+			Entry.NameHash = FAssetPackage::HashName(SourceEntry.Name);
+			Entry.Size = Size;
+			Entry.UncompressedSize = Size;
+			EntriesData[iEntry] = Data;
+
+			if (!SourceEntry.bCompress || Size == 0)
+			{
+				return;
+			}
+
+			auto Compressed = FLZCodec::Compress(Data, Size);
+			if (Compressed.size() <= static_cast<uint64>(Size*MaxCompressionRatio))
+			{
+				Entry.Compression = EAssetCompression::LZ;
+				Entry.Size = Compressed.size();
+				EntriesData[iEntry] = Compressed.data();
+				CompressedData[iEntry] = std::move(Compressed);
+			}
+		});
+
+		// Table of contents is sorted by hashes for the binary search. Names and data keep the order of adding
+		std::vector<uint32> SortedEntries(NumEntries);
+		for (uint32 iEntry = 0; iEntry < NumEntries; ++iEntry)
+		{
+			SortedEntries[iEntry] = iEntry;
+		}
+		std::sort(SortedEntries.begin(), SortedEntries.end(), [&Entries](uint32 iLeft, uint32 iRight)
+		{
+			return Entries[iLeft].NameHash < Entries[iRight].NameHash;
+		});
+
+		std::string Names;
+		for (uint32 iEntry = 0; iEntry < NumEntries; ++iEntry)
+		{
+			Entries[iEntry].NameOffset = static_cast<uint32>(Names.size());
+			Entries[iEntry].NameSize = static_cast<uint32>(SourceEntries[iEntry].Name.size());
+			Names += SourceEntries[iEntry].Name;
+		}
+
+		Header.Magic = AssetPackageMagic;
+		Header.Version = AssetPackageVersion;
+		Header.NumEntries = NumEntries;
+		Header.EntriesOffset = AlignOffset(sizeof(FAssetPackageHeader));
+		Header.NamesOffset = Header.EntriesOffset + NumEntries*sizeof(FAssetPackageEntry);
+		Header.NamesSize = Names.size();
+		std::memcpy(Header.SourceKey, SourceKey.c_str(), SourceKey.size());
+
+		FAssetPackageStats Stats;
+		Stats.NumEntries = NumEntries;
+
+		auto DataOffset = AlignOffset(Header.NamesOffset + Header.NamesSize);
+		for (auto& Entry : Entries)
+		{
+			Entry.Offset = DataOffset;
+			DataOffset = AlignOffset(DataOffset + Entry.Size);
+
+			Stats.UncompressedSize += Entry.UncompressedSize;
+			Stats.NumCompressedEntries += Entry.Compression == EAssetCompression::LZ ? 1 : 0;
+		}
+
+		// Readers never see a partially written package
+		const auto TempFilePath = FilePath + ".tmp";
+		{
+			std::ofstream File(TempFilePath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+
+			const char Padding[AssetPackageAlignment] = {};
+			uint64 Offset = 0;
+			const auto Write = [&File, &Offset, &Padding](const void* Data, uint64 Size, uint64 DataOffset)
+			{
+				File.write(Padding, DataOffset - Offset);
+				File.write(static_cast<const char*>(Data), Size);
+				Offset = DataOffset + Size;
+			};
+
+			Write(&Header, sizeof(Header), 0);
+			for (uint32 iEntry = 0; iEntry < NumEntries; ++iEntry)
+			{
+				Write(&Entries[SortedEntries[iEntry]], sizeof(FAssetPackageEntry),
+					Header.EntriesOffset + iEntry*sizeof(FAssetPackageEntry));
+			}
+			Write(Names.data(), Names.size(), Header.NamesOffset);
+			for (uint32 iEntry = 0; iEntry < NumEntries; ++iEntry)
+			{
+				Write(EntriesData[iEntry], Entries[iEntry].Size, Entries[iEntry].Offset);
+			}
+
+			Stats.PackageSize = Offset;
+
+			if (!File.good())
+			{
+				File.close();
+				std::remove(TempFilePath.c_str());
+				throw std::invalid_argument("Asset package can't be written to " + TempFilePath);
+			}
+		}
+
+		auto ToWide = [](const std::string& Path)
+		{
+			const auto WidePathLength = MultiByteToWideChar(
+				CP_UTF8, 0, Path.c_str(), static_cast<int>(Path.size()), nullptr, 0);
+			std::wstring WidePath(WidePathLength, L'\0');
+			MultiByteToWideChar(CP_UTF8, 0, Path.c_str(), static_cast<int>(Path.size()), &WidePath[0], WidePathLength);
+			return WidePath;
+		};
+
+		// The old package is replaced in one step, so there's no moment without it. Replacing fails while it's mapped
+		if (!MoveFileExW(ToWide(TempFilePath).c_str(), ToWide(FilePath).c_str(), MOVEFILE_REPLACE_EXISTING))
+		{
+			std::remove(TempFilePath.c_str());
+			throw std::invalid_argument("Asset package can't be moved to " + FilePath);
+		}
+
+		Stats.Seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - StartTime).count();
+		return Stats;
+	}
+
+	std::string FAssetPackageWriter::GetSourceKey(const std::vector<std::string>& FilesPaths, std::vector<std::string>& FoundFilesPaths)
+	{
+		auto SourceKey = FDerivedDataKey("AssetPackage").Add(AssetPackageVersion);
+		FoundFilesPaths.clear();
+		for (const auto& FilePath : FilesPaths)
+		{
+			const std::wstring WideFilePath(FilePath.cbegin(), FilePath.cend());
+			WIN32_FILE_ATTRIBUTE_DATA Attributes;
+			if (!GetFileAttributesExW(WideFilePath.c_str(), GetFileExInfoStandard, &Attributes))
+			{
+				continue;
+			}
+
+			SourceKey.Add(FAssetPackage::NormalizeName(FilePath)).Add(Attributes.nFileSizeHigh).Add(Attributes.nFileSizeLow).
+				Add(Attributes.ftLastWriteTime.dwHighDateTime).Add(Attributes.ftLastWriteTime.dwLowDateTime);
+			FoundFilesPaths.push_back(FilePath);
+		}
+
+		return SourceKey.ToString();
+	}
+}
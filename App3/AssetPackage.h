@@ -0,0 +1,270 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pch.h"
+#include "Common/MappedFile.h"
+
+namespace WoodenEngine
+{
+	// "WPAK"
+	constexpr uint32 AssetPackageMagic = 0x4B415057;
+	constexpr uint32 AssetPackageVersion = 1;
+
+	// Table of contents and data of every entry are aligned to it, so mapped entries keep alignment of their blobs
+	constexpr uint64 AssetPackageAlignment = 64;
+
+	/*!
+	 * \enum EAssetCompression
+	 *
+	 * \brief Compression of a package's entry
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	enum class EAssetCompression : uint32
+	{
+		// Data is served right from the mapped package
+		None = 0,
+
+		// FLZCodec. Data is decompressed by the reader
+		LZ
+	};
+
+	/*!
+	 * \struct FAssetPackageHeader
+	 *
+	 * \brief Header of an asset package (.wpak). It's followed by the table of entries sorted by names' hashes,
+	 * names of entries and their data
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FAssetPackageHeader
+	{
+		uint32 Magic = 0;
+		uint32 Version = 0;
+
+		uint32 NumEntries = 0;
+		uint32 Padding = 0;
+
+		uint64 EntriesOffset = 0;
+
+		uint64 NamesOffset = 0;
+		uint64 NamesSize = 0;
+
+		// Key of sources the package was packed from, so a stale package is repacked
+		char SourceKey[40] = {};
+	};
+
+	/*!
+	 * \struct FAssetPackageEntry
+	 *
+	 * \brief Entry of an asset package's table of contents
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FAssetPackageEntry
+	{
+		// FAssetPackage::HashName of the normalized name
+		uint64 NameHash = 0;
+
+		// Stored data from the start of the package
+		uint64 Offset = 0;
+		uint64 Size = 0;
+
+		uint64 UncompressedSize = 0;
+
+		// Name from the start of the names
+		uint32 NameOffset = 0;
+		uint32 NameSize = 0;
+
+		EAssetCompression Compression = EAssetCompression::None;
+		uint32 Padding = 0;
+	};
+
+	/*!
+	 * \struct FAssetPackageStats
+	 *
+	 * \brief Statistics of packing
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FAssetPackageStats
+	{
+		uint32 NumEntries = 0;
+		uint32 NumCompressedEntries = 0;
+
+		uint64 UncompressedSize = 0;
+
+		// Size of the package's file
+		uint64 PackageSize = 0;
+
+		double Seconds = 0.0;
+	};
+
+	/*!
+	 * \class FAssetPackage
+	 *
+	 * \brief Asset package mapped to memory. Loads of entries don't open files or read them:
+	 * uncompressed entries are served right from the mapping, compressed ones are decompressed by the caller's thread.
+	 * Names are relative paths of loose files. They're case-insensitive and both slashes are accepted
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FAssetPackage
+	{
+	public:
+		/** @brief Maps the package and validates its header and table of contents.
+		  * Throws invalid_argument if the file isn't a valid package
+		  * @param FilePath Path to file (format: *.wpak) (const std::string &)
+		  */
+		explicit FAssetPackage(const std::string& FilePath);
+		~FAssetPackage() = default;
+
+		FAssetPackage& operator=(const FAssetPackage& AssetPackage) = delete;
+		FAssetPackage(const FAssetPackage& AssetPackage) = delete;
+		FAssetPackage(FAssetPackage&& AssetPackage) = delete;
+
+		/** @brief Finds the entry by the binary search of its name's hash
+		  * @param Name (const std::string &)
+		  * @return nullptr if there isn't the entry (const WoodenEngine::FAssetPackageEntry*)
+		  */
+		const FAssetPackageEntry* FindEntry(const std::string& Name) const;
+
+		/** @brief Finds the entry by the binary search of its name's hash
+		  * @param Name (const std::wstring &)
+		  * @return nullptr if there isn't the entry (const WoodenEngine::FAssetPackageEntry*)
+		  */
+		const FAssetPackageEntry* FindEntry(const std::wstring& Name) const;
+
+		/** @brief Returns stored data of the entry inside of the mapped package
+		  * @param Entry (const FAssetPackageEntry &)
+		  * @return (const uint8 *)
+		  */
+		const uint8* GetEntryData(const FAssetPackageEntry& Entry) const noexcept;
+
+		/** @brief Decompresses the entry or copies it if it isn't compressed
+		  * @param Entry (const FAssetPackageEntry &)
+		  * @return (std::vector<uint8>)
+		  */
+		std::vector<uint8> ReadEntry(const FAssetPackageEntry& Entry) const;
+
+		/** @brief Returns the normalized name of the entry
+		  * @param Entry (const FAssetPackageEntry &)
+		  * @return (std::string)
+		  */
+		std::string GetEntryName(const FAssetPackageEntry& Entry) const;
+
+		uint32 GetNumEntries() const noexcept;
+
+		/** @brief Returns the key of sources the package was packed from
+		  * @return (std::string)
+		  */
+		std::string GetSourceKey() const;
+
+		/** @brief Returns path of the package's file
+		  * @return (const std::string&)
+		  */
+		const std::string& GetFilePath() const noexcept;
+
+		/** @brief Lower case name with backslashes and without leading ".\"
+		  * @param Name (const std::string &)
+		  * @return (std::string)
+		  */
+		static std::string NormalizeName(const std::string& Name);
+
+		/** @brief 64-bit FNV-1a hash of the normalized name
+		  * @param Name (const std::string &)
+		  * @return (uint64)
+		  */
+		static uint64 HashName(const std::string& Name);
+
+	private:
+		DX::FMappedFile MappedFile;
+
+		const FAssetPackageHeader* Header = nullptr;
+
+		const FAssetPackageEntry* Entries = nullptr;
+
+		const char* Names = nullptr;
+	};
+
+	/*!
+	 * \class FAssetPackageWriter
+	 *
+	 * \brief Offline packer of asset packages. Added files are mapped until the package is saved.
+	 * Entries are compressed on all cores and are stored compressed only if it saves enough
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FAssetPackageWriter
+	{
+	public:
+		FAssetPackageWriter() = default;
+		~FAssetPackageWriter() = default;
+
+		FAssetPackageWriter& operator=(const FAssetPackageWriter& AssetPackageWriter) = delete;
+		FAssetPackageWriter(const FAssetPackageWriter& AssetPackageWriter) = delete;
+		FAssetPackageWriter(FAssetPackageWriter&& AssetPackageWriter) = delete;
+
+		/** @brief Maps the file and adds it as the entry. Throws invalid_argument if it can't be mapped
+		  * @param FilePath Path to the loose file, which is the entry's name (const std::string &)
+		  * @param bCompress (bool)
+		  * @return (void)
+		  */
+		void AddFile(const std::string& FilePath, bool bCompress);
+
+		/** @brief Adds the data as the entry
+		  * @param Name (const std::string &)
+		  * @param Data (std::vector<uint8> &&)
+		  * @param bCompress (bool)
+		  * @return (void)
+		  */
+		void AddData(const std::string& Name, std::vector<uint8>&& Data, bool bCompress);
+
+		/** @brief Writes the package to a temporary file which replaces FilePath in one move,
+		  * so a package with the path is always complete. Throws invalid_argument if it can't be written or moved
+		  * @param FilePath Path to file (format: *.wpak) (const std::string &)
+		  * @param SourceKey Up to 39 characters (const std::string &)
+		  * @return (WoodenEngine::FAssetPackageStats)
+		  */
+		FAssetPackageStats Save(const std::string& FilePath, const std::string& SourceKey) const;
+
+		/** @brief Returns the key of paths, sizes and write times of the files, so a package is validated
+		  * without reading them. The game and the offline packer key the same files to the same package
+		  * @param FilesPaths (const std::vector<std::string> &)
+		  * @param FoundFilesPaths Files which exist in the order of FilesPaths. Missing ones aren't keyed (std::vector<std::string> &)
+		  * @return (std::string)
+		  */
+		static std::string GetSourceKey(const std::vector<std::string>& FilesPaths, std::vector<std::string>& FoundFilesPaths);
+
+		// Compressed entries must be smaller than this part of their data
+		static constexpr float MaxCompressionRatio = 0.875f;
+
+	private:
+		struct FSourceEntry
+		{
+			std::string Name;
+
+			std::unique_ptr<DX::FMappedFile> File;
+			std::vector<uint8> Bytes;
+
+			bool bCompress = false;
+		};
+
+		/** @brief Throws invalid_argument if an entry with the same normalized name is added
+		  * @param Name (const std::string &)
+		  * @return (void)
+		  */
+		void CheckName(const std::string& Name) const;
+
+		std::vector<FSourceEntry> SourceEntries;
+	};
+}
@@ -0,0 +1,907 @@
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+#include <ppl.h>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "BlockCompressor.h"
+
+namespace WoodenEngine
+{
+	using namespace DirectX;
+
+	namespace
+	{
+		constexpr uint32 NumBlockTexels = 16;
+
+		// Least squares refinements of endpoints of a color block
+		constexpr uint32 NumColorRefinements = 2;
+
+		// Iterations of the power method which finds the principal axis of colors
+		constexpr uint32 NumPowerIterations = 8;
+
+		/*!
+		 * \struct FBlockVectors
+		 *
+		 * \brief Channels of 4x4 texels in [0, 255]. A vector holds a row of the block
+		 *
+		 * \author devmi
+		 * \date October 2018
+		 */
+		struct FBlockVectors
+		{
+			XMVECTOR Channels[4][4];
+		};
+
+		/** @brief Loads RGBA8 texels of the block to vectors
+		  * @param Texels 16 texels, row-major (const uint8 *)
+		  * @return (FBlockVectors)
+		  */
+		FBlockVectors LoadBlock(const uint8* Texels)
+		{
+			alignas(16) float Channels[4][NumBlockTexels];
+			for (uint32 iTexel = 0; iTexel < NumBlockTexels; ++iTexel)
+			{
+				for (uint32 iChannel = 0; iChannel < 4; ++iChannel)
+				{
+					Channels[iChannel][iTexel] = Texels[iTexel * 4 + iChannel];
+				}
+			}
+
+			FBlockVectors Block;
+			for (uint32 iChannel = 0; iChannel < 4; ++iChannel)
+			{
+				for (uint32 iRow = 0; iRow < 4; ++iRow)
+				{
+					Block.Channels[iChannel][iRow] =
+						XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(&Channels[iChannel][iRow * 4]));
+				}
+			}
+
+			return Block;
+		}
+
+		/** @brief Stores 4 rows of values of the block to 16 integers
+		  * @param Rows (const XMVECTOR *)
+		  * @param Values (uint32 *)
+		  * @return (void)
+		  */
+		void StoreBlockIndices(const XMVECTOR* Rows, uint32* Values)
+		{
+			alignas(16) XMFLOAT4A Row;
+			for (uint32 iRow = 0; iRow < 4; ++iRow)
+			{
+				XMStoreFloat4A(&Row, Rows[iRow]);
+				Values[iRow * 4 + 0] = static_cast<uint32>(Row.x);
+				Values[iRow * 4 + 1] = static_cast<uint32>(Row.y);
+				Values[iRow * 4 + 2] = static_cast<uint32>(Row.z);
+				Values[iRow * 4 + 3] = static_cast<uint32>(Row.w);
+			}
+		}
+
+		float SumAcross(FXMVECTOR V)
+		{
+			alignas(16) XMFLOAT4A Components;
+			XMStoreFloat4A(&Components, V);
+			return Components.x + Components.y + Components.z + Components.w;
+		}
+
+		float MinAcross(FXMVECTOR V)
+		{
+			alignas(16) XMFLOAT4A Components;
+			XMStoreFloat4A(&Components, V);
+			return std::min(std::min(Components.x, Components.y), std::min(Components.z, Components.w));
+		}
+
+		float MaxAcross(FXMVECTOR V)
+		{
+			alignas(16) XMFLOAT4A Components;
+			XMStoreFloat4A(&Components, V);
+			return std::max(std::max(Components.x, Components.y), std::max(Components.z, Components.w));
+		}
+
+		/** @brief Quantizes the color in [0, 255] to 5:6:5 bits
+		  * @param Color (const float *)
+		  * @return (uint16)
+		  */
+		uint16 PackColor565(const float* Color)
+		{
+			const auto Quantize = [](float Value, int32 MaxValue)
+			{
+				const auto Quantized = static_cast<int32>(Value * MaxValue / 255.0f + 0.5f);
+				return static_cast<uint16>(std::max(0, std::min(Quantized, MaxValue)));
+			};
+
+			return static_cast<uint16>(
+				(Quantize(Color[0], 31) << 11) | (Quantize(Color[1], 63) << 5) | Quantize(Color[2], 31));
+		}
+
+		/** @brief Expands 5:6:5 bits of the color to [0, 255] as decoders do
+		  * @param Packed (uint16)
+		  * @param Color (uint8 *)
+		  * @return (void)
+		  */
+		void UnpackColor565(uint16 Packed, uint8* Color)
+		{
+			const auto R = (Packed >> 11) & 31;
+			const auto G = (Packed >> 5) & 63;
+			const auto B = Packed & 31;
+			Color[0] = static_cast<uint8>((R << 3) | (R >> 2));
+			Color[1] = static_cast<uint8>((G << 2) | (G >> 4));
+			Color[2] = static_cast<uint8>((B << 3) | (B >> 2));
+		}
+
+		/** @brief Builds the palette of color endpoints. 3-color blocks have the transparent fourth color
+		  * @param Color0 (uint16)
+		  * @param Color1 (uint16)
+		  * @param b3Colors (bool)
+		  * @param Palette (float[4][3])
+		  * @return (void)
+		  */
+		void BuildColorPalette(uint16 Color0, uint16 Color1, bool b3Colors, float Palette[4][3])
+		{
+			uint8 Endpoints[2][3];
+			UnpackColor565(Color0, Endpoints[0]);
+			UnpackColor565(Color1, Endpoints[1]);
+
+			for (uint32 iChannel = 0; iChannel < 3; ++iChannel)
+			{
+				const float Value0 = Endpoints[0][iChannel];
+				const float Value1 = Endpoints[1][iChannel];
+				Palette[0][iChannel] = Value0;
+				Palette[1][iChannel] = Value1;
+				if (b3Colors)
+				{
+					Palette[2][iChannel] = (Value0 + Value1) / 2.0f;
+					Palette[3][iChannel] = 0.0f;
+				}
+				else
+				{
+					Palette[2][iChannel] = (2.0f*Value0 + Value1) / 3.0f;
+					Palette[3][iChannel] = (Value0 + 2.0f*Value1) / 3.0f;
+				}
+			}
+		}
+
+		/** @brief Selects the nearest colors of the palette for texels. Transparent texels select the fourth one
+		  * @param Block (const FBlockVectors &)
+		  * @param OpaqueMasks Rows of masks of opaque texels, nullptr if all of them are opaque (const XMVECTOR *)
+		  * @param Palette (const float[4][3])
+		  * @param NumColors (uint32)
+		  * @param Indices Rows of indices (XMVECTOR *)
+		  * @return Squared error of opaque texels (float)
+		  */
+		float SelectColorIndices(
+			const FBlockVectors& Block,
+			const XMVECTOR* OpaqueMasks,
+			const float Palette[4][3],
+			uint32 NumColors,
+			XMVECTOR* Indices)
+		{
+			XMVECTOR PaletteVectors[4][3];
+			for (uint32 iColor = 0; iColor < NumColors; ++iColor)
+			{
+				for (uint32 iChannel = 0; iChannel < 3; ++iChannel)
+				{
+					PaletteVectors[iColor][iChannel] = XMVectorReplicate(Palette[iColor][iChannel]);
+				}
+			}
+
+			auto Error = XMVectorZero();
+			for (uint32 iRow = 0; iRow < 4; ++iRow)
+			{
+				auto BestDistance = XMVectorReplicate(FLT_MAX);
+				auto BestIndex = XMVectorZero();
+				for (uint32 iColor = 0; iColor < NumColors; ++iColor)
+				{
+					auto Distance = XMVectorZero();
+					for (uint32 iChannel = 0; iChannel < 3; ++iChannel)
+					{
+						const auto Delta = XMVectorSubtract(Block.Channels[iChannel][iRow], PaletteVectors[iColor][iChannel]);
+						Distance = XMVectorMultiplyAdd(Delta, Delta, Distance);
+					}
+
+					const auto Closer = XMVectorLess(Distance, BestDistance);
+					BestDistance = XMVectorSelect(BestDistance, Distance, Closer);
+					BestIndex = XMVectorSelect(BestIndex, XMVectorReplicate(static_cast<float>(iColor)), Closer);
+				}
+
+				if (OpaqueMasks != nullptr)
+				{
+					BestIndex = XMVectorSelect(XMVectorReplicate(3.0f), BestIndex, OpaqueMasks[iRow]);
+					BestDistance = XMVectorSelect(XMVectorZero(), BestDistance, OpaqueMasks[iRow]);
+				}
+
+				Indices[iRow] = BestIndex;
+				Error = XMVectorAdd(Error, BestDistance);
+			}
+
+			return SumAcross(Error);
+		}
+
+		/** @brief Finds endpoints which minimize squared error of opaque texels with the selected indices
+		  * @param Block (const FBlockVectors &)
+		  * @param Weights Rows of 1 for opaque texels and 0 for transparent ones (const XMVECTOR *)
+		  * @param Indices (const XMVECTOR *)
+		  * @param b3Colors (bool)
+		  * @param Endpoints (float[2][3])
+		  * @return False if indices don't define endpoints (bool)
+		  */
+		bool RefineColorEndpoints(
+			const FBlockVectors& Block,
+			const XMVECTOR* Weights,
+			const XMVECTOR* Indices,
+			bool b3Colors,
+			float Endpoints[2][3])
+		{
+			// Weights of the first endpoint in colors of the palette
+			const float EndpointWeights[2][4] = { { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f }, { 1.0f, 0.0f, 0.5f, 0.0f } };
+			const auto& IndexWeights = EndpointWeights[b3Colors ? 1 : 0];
+
+			auto SumAA = XMVectorZero();
+			auto SumBB = XMVectorZero();
+			auto SumAB = XMVectorZero();
+			XMVECTOR SumAX[3] = { XMVectorZero(), XMVectorZero(), XMVectorZero() };
+			XMVECTOR SumBX[3] = { XMVectorZero(), XMVectorZero(), XMVectorZero() };
+			for (uint32 iRow = 0; iRow < 4; ++iRow)
+			{
+				auto A = XMVectorZero();
+				for (uint32 iIndex = 0; iIndex < 4; ++iIndex)
+				{
+					const auto bIndex = XMVectorEqual(Indices[iRow], XMVectorReplicate(static_cast<float>(iIndex)));
+					A = XMVectorSelect(A, XMVectorReplicate(IndexWeights[iIndex]), bIndex);
+				}
+
+				auto B = XMVectorMultiply(XMVectorSubtract(XMVectorSplatOne(), A), Weights[iRow]);
+				A = XMVectorMultiply(A, Weights[iRow]);
+
+				SumAA = XMVectorMultiplyAdd(A, A, SumAA);
+				SumBB = XMVectorMultiplyAdd(B, B, SumBB);
+				SumAB = XMVectorMultiplyAdd(A, B, SumAB);
+				for (uint32 iChannel = 0; iChannel < 3; ++iChannel)
+				{
+					SumAX[iChannel] = XMVectorMultiplyAdd(A, Block.Channels[iChannel][iRow], SumAX[iChannel]);
+					SumBX[iChannel] = XMVectorMultiplyAdd(B, Block.Channels[iChannel][iRow], SumBX[iChannel]);
+				}
+			}
+
+			const auto AA = SumAcross(SumAA);
+			const auto BB = SumAcross(SumBB);
+			const auto AB = SumAcross(SumAB);
+			const auto Determinant = AA*BB - AB*AB;
+			if (std::abs(Determinant) < 1e-6f)
+			{
+				return false;
+			}
+
+			for (uint32 iChannel = 0; iChannel < 3; ++iChannel)
+			{
+				const auto AX = SumAcross(SumAX[iChannel]);
+				const auto BX = SumAcross(SumBX[iChannel]);
+				Endpoints[0][iChannel] = std::max(0.0f, std::min((AX*BB - BX*AB) / Determinant, 255.0f));
+				Endpoints[1][iChannel] = std::max(0.0f, std::min((BX*AA - AX*AB) / Determinant, 255.0f));
+			}
+
+			return true;
+		}
+
+		/** @brief Finds endpoints at extremes of projections of colors on their principal axis
+		  * @param Block (const FBlockVectors &)
+		  * @param Weights Rows of 1 for opaque texels and 0 for transparent ones (const XMVECTOR *)
+		  * @param NumOpaqueTexels (float)
+		  * @param OpaqueMasks Rows of masks of opaque texels (const XMVECTOR *)
+		  * @param Endpoints (float[2][3])
+		  * @return (void)
+		  */
+		void FitColorEndpoints(
+			const FBlockVectors& Block,
+			const XMVECTOR* Weights,
+			float NumOpaqueTexels,
+			const XMVECTOR* OpaqueMasks,
+			float Endpoints[2][3])
+		{
+			XMVECTOR Means[3];
+			float Mean[3];
+			for (uint32 iChannel = 0; iChannel < 3; ++iChannel)
+			{
+				auto Sum = XMVectorZero();
+				for (uint32 iRow = 0; iRow < 4; ++iRow)
+				{
+					Sum = XMVectorMultiplyAdd(Block.Channels[iChannel][iRow], Weights[iRow], Sum);
+				}
+
+				Mean[iChannel] = SumAcross(Sum) / NumOpaqueTexels;
+				Means[iChannel] = XMVectorReplicate(Mean[iChannel]);
+			}
+
+			// Deviations from the mean. Transparent texels don't deviate
+			XMVECTOR Deviations[3][4];
+			for (uint32 iChannel = 0; iChannel < 3; ++iChannel)
+			{
+				for (uint32 iRow = 0; iRow < 4; ++iRow)
+				{
+					Deviations[iChannel][iRow] = XMVectorMultiply(
+						XMVectorSubtract(Block.Channels[iChannel][iRow], Means[iChannel]), Weights[iRow]);
+				}
+			}
+
+			// Symmetric covariance matrix: RR, RG, RB, GG, GB, BB
+			const uint32 CovariancePairs[6][2] = { { 0, 0 }, { 0, 1 }, { 0, 2 }, { 1, 1 }, { 1, 2 }, { 2, 2 } };
+			float Covariances[6];
+			for (uint32 iPair = 0; iPair < 6; ++iPair)
+			{
+				auto Sum = XMVectorZero();
+				for (uint32 iRow = 0; iRow < 4; ++iRow)
+				{
+					Sum = XMVectorMultiplyAdd(
+						Deviations[CovariancePairs[iPair][0]][iRow], Deviations[CovariancePairs[iPair][1]][iRow], Sum);
+				}
+
+				Covariances[iPair] = SumAcross(Sum);
+			}
+
+			const float Covariance[3][3] = {
+				{ Covariances[0], Covariances[1], Covariances[2] },
+				{ Covariances[1], Covariances[3], Covariances[4] },
+				{ Covariances[2], Covariances[4], Covariances[5] } };
+
+			// The power method starts from the most varying channel
+			uint32 iMaxChannel = 0;
+			for (uint32 iChannel = 1; iChannel < 3; ++iChannel)
+			{
+				if (Covariance[iChannel][iChannel] > Covariance[iMaxChannel][iMaxChannel])
+				{
+					iMaxChannel = iChannel;
+				}
+			}
+
+			if (Covariance[iMaxChannel][iMaxChannel] < 1e-3f)
+			{
+				for (uint32 iChannel = 0; iChannel < 3; ++iChannel)
+				{
+					Endpoints[0][iChannel] = Mean[iChannel];
+					Endpoints[1][iChannel] = Mean[iChannel];
+				}
+				return;
+			}
+
+			float Axis[3] = { Covariance[iMaxChannel][0], Covariance[iMaxChannel][1], Covariance[iMaxChannel][2] };
+			for (uint32 iIteration = 0; iIteration < NumPowerIterations; ++iIteration)
+			{
+				float NextAxis[3];
+				for (uint32 iChannel = 0; iChannel < 3; ++iChannel)
+				{
+					NextAxis[iChannel] = Covariance[iChannel][0] * Axis[0] +
+						Covariance[iChannel][1] * Axis[1] + Covariance[iChannel][2] * Axis[2];
+				}
+
+				const auto MaxComponent = std::max(std::abs(NextAxis[0]), std::max(std::abs(NextAxis[1]), std::abs(NextAxis[2])));
+				if (MaxComponent < 1e-6f)
+				{
+					break;
+				}
+
+				for (uint32 iChannel = 0; iChannel < 3; ++iChannel)
+				{
+					Axis[iChannel] = NextAxis[iChannel] / MaxComponent;
+				}
+			}
+
+			const auto AxisLength = std::sqrt(Axis[0] * Axis[0] + Axis[1] * Axis[1] + Axis[2] * Axis[2]);
+			for (auto& Component : Axis)
+			{
+				Component /= AxisLength;
+			}
+
+			// Extremes of projections of opaque texels
+			auto MinProjection = XMVectorReplicate(FLT_MAX);
+			auto MaxProjection = XMVectorReplicate(-FLT_MAX);
+			for (uint32 iRow = 0; iRow < 4; ++iRow)
+			{
+				auto Projection = XMVectorMultiply(Deviations[0][iRow], XMVectorReplicate(Axis[0]));
+				Projection = XMVectorMultiplyAdd(Deviations[1][iRow], XMVectorReplicate(Axis[1]), Projection);
+				Projection = XMVectorMultiplyAdd(Deviations[2][iRow], XMVectorReplicate(Axis[2]), Projection);
+
+				MinProjection = XMVectorMin(MinProjection, XMVectorSelect(XMVectorReplicate(FLT_MAX), Projection, OpaqueMasks[iRow]));
+				MaxProjection = XMVectorMax(MaxProjection, XMVectorSelect(XMVectorReplicate(-FLT_MAX), Projection, OpaqueMasks[iRow]));
+			}
+
+			const auto Max = MaxAcross(MaxProjection);
+			const auto Min = MinAcross(MinProjection);
+			for (uint32 iChannel = 0; iChannel < 3; ++iChannel)
+			{
+				Endpoints[0][iChannel] = std::max(0.0f, std::min(Mean[iChannel] + Axis[iChannel] * Max, 255.0f));
+				Endpoints[1][iChannel] = std::max(0.0f, std::min(Mean[iChannel] + Axis[iChannel] * Min, 255.0f));
+			}
+		}
+
+		/** @brief Encodes colors of the block to 8 bytes of BC1 layout
+		  * @param Block (const FBlockVectors &)
+		  * @param bPunchThrough Texels with alpha less than 128 are encoded as transparent (BC1 only) (bool)
+		  * @param Dst (uint8 *)
+		  * @return (void)
+		  */
+		void EncodeColorBlock(const FBlockVectors& Block, bool bPunchThrough, uint8* Dst)
+		{
+			XMVECTOR OpaqueMasks[4];
+			XMVECTOR Weights[4];
+			auto NumOpaqueTexels = XMVectorZero();
+			for (uint32 iRow = 0; iRow < 4; ++iRow)
+			{
+				OpaqueMasks[iRow] = bPunchThrough ?
+					XMVectorGreaterOrEqual(Block.Channels[3][iRow], XMVectorReplicate(128.0f)) : XMVectorTrueInt();
+				Weights[iRow] = XMVectorSelect(XMVectorZero(), XMVectorSplatOne(), OpaqueMasks[iRow]);
+				NumOpaqueTexels = XMVectorAdd(NumOpaqueTexels, Weights[iRow]);
+			}
+
+			const auto NumOpaque = SumAcross(NumOpaqueTexels);
+			const auto b3Colors = NumOpaque < NumBlockTexels;
+
+			uint32 Indices[NumBlockTexels];
+			uint16 Colors[2] = { 0, 0 };
+			if (NumOpaque == 0.0f)
+			{
+				// Equal endpoints select 3-color mode, whose fourth color is transparent
+				std::fill(std::begin(Indices), std::end(Indices), 3);
+			}
+			else
+			{
+				float Endpoints[2][3];
+				FitColorEndpoints(Block, Weights, NumOpaque, OpaqueMasks, Endpoints);
+
+				const auto NumColors = b3Colors ? 3u : 4u;
+				auto BestError = FLT_MAX;
+				for (uint32 iRefinement = 0; iRefinement <= NumColorRefinements; ++iRefinement)
+				{
+					const uint16 Candidates[2] = { PackColor565(Endpoints[0]), PackColor565(Endpoints[1]) };
+
+					float Palette[4][3];
+					BuildColorPalette(Candidates[0], Candidates[1], b3Colors, Palette);
+
+					XMVECTOR CandidateIndices[4];
+					const auto Error = SelectColorIndices(
+						Block, b3Colors ? OpaqueMasks : nullptr, Palette, NumColors, CandidateIndices);
+					if (Error < BestError)
+					{
+						BestError = Error;
+						Colors[0] = Candidates[0];
+						Colors[1] = Candidates[1];
+						StoreBlockIndices(CandidateIndices, Indices);
+					}
+
+					if (Error == 0.0f || iRefinement == NumColorRefinements ||
+						!RefineColorEndpoints(Block, Weights, CandidateIndices, b3Colors, Endpoints))
+					{
+						break;
+					}
+				}
+
+				// Order of endpoints selects the mode: 4 colors if Color0 > Color1, otherwise 3 colors
+				if (b3Colors)
+				{
+					if (Colors[0] > Colors[1])
+					{
+						std::swap(Colors[0], Colors[1]);
+						for (auto& Index : Indices)
+						{
+							Index = Index < 2 ? Index ^ 1 : Index;
+						}
+					}
+				}
+				else if (Colors[0] < Colors[1])
+				{
+					std::swap(Colors[0], Colors[1]);
+					for (auto& Index : Indices)
+					{
+						Index ^= 1;
+					}
+				}
+				else if (Colors[0] == Colors[1])
+				{
+					std::fill(std::begin(Indices), std::end(Indices), 0);
+				}
+			}
+
+			uint32 PackedIndices = 0;
+			for (uint32 iTexel = 0; iTexel < NumBlockTexels; ++iTexel)
+			{
+				PackedIndices |= Indices[iTexel] << (iTexel * 2);
+			}
+
+			Dst[0] = static_cast<uint8>(Colors[0] & 0xFF);
+			Dst[1] = static_cast<uint8>(Colors[0] >> 8);
+			Dst[2] = static_cast<uint8>(Colors[1] & 0xFF);
+			Dst[3] = static_cast<uint8>(Colors[1] >> 8);
+			std::memcpy(Dst + 4, &PackedIndices, sizeof(PackedIndices));
+		}
+
+		/** @brief Builds the palette of BC4 endpoints as decoders do. 8 values are interpolated if Value0 > Value1,
+		  * otherwise 6 values, 0 and 255
+		  * @param Value0 (uint32)
+		  * @param Value1 (uint32)
+		  * @param Palette (uint8[8])
+		  * @return (void)
+		  */
+		void BuildValuePalette(uint32 Value0, uint32 Value1, uint8 Palette[8])
+		{
+			Palette[0] = static_cast<uint8>(Value0);
+			Palette[1] = static_cast<uint8>(Value1);
+			if (Value0 > Value1)
+			{
+				for (uint32 iValue = 2; iValue < 8; ++iValue)
+				{
+					Palette[iValue] = static_cast<uint8>(((8 - iValue)*Value0 + (iValue - 1)*Value1 + 3) / 7);
+				}
+			}
+			else
+			{
+				for (uint32 iValue = 2; iValue < 6; ++iValue)
+				{
+					Palette[iValue] = static_cast<uint8>(((6 - iValue)*Value0 + (iValue - 1)*Value1 + 2) / 5);
+				}
+				Palette[6] = 0;
+				Palette[7] = 255;
+			}
+		}
+
+		/** @brief Encodes one channel of the block to 8 bytes of BC4 layout with 8 interpolated values
+		  * @param Rows Rows of the channel (const XMVECTOR *)
+		  * @param Dst (uint8 *)
+		  * @return (void)
+		  */
+		void EncodeValueBlock(const XMVECTOR* Rows, uint8* Dst)
+		{
+			auto MinValues = Rows[0];
+			auto MaxValues = Rows[0];
+			for (uint32 iRow = 1; iRow < 4; ++iRow)
+			{
+				MinValues = XMVectorMin(MinValues, Rows[iRow]);
+				MaxValues = XMVectorMax(MaxValues, Rows[iRow]);
+			}
+
+			// Endpoints are stored as integers, so texels select the nearest of the values decoders interpolate
+			const auto Quantize = [](float Value)
+			{
+				return static_cast<uint8>(std::max(0.0f, std::min(std::round(Value), 255.0f)));
+			};
+			const auto Max = Quantize(MaxAcross(MaxValues));
+			const auto Min = Quantize(MinAcross(MinValues));
+
+			Dst[0] = Max;
+			Dst[1] = Min;
+			std::memset(Dst + 2, 0, 6);
+			if (Max == Min)
+			{
+				return;
+			}
+
+			uint8 Palette[8];
+			BuildValuePalette(Max, Min, Palette);
+
+			XMVECTOR Indices[4];
+			for (uint32 iRow = 0; iRow < 4; ++iRow)
+			{
+				auto BestDistance = XMVectorReplicate(FLT_MAX);
+				auto BestIndex = XMVectorZero();
+				for (uint32 iValue = 0; iValue < 8; ++iValue)
+				{
+					const auto Distance = XMVectorAbs(XMVectorSubtract(Rows[iRow], XMVectorReplicate(Palette[iValue])));
+					const auto Closer = XMVectorLess(Distance, BestDistance);
+					BestDistance = XMVectorSelect(BestDistance, Distance, Closer);
+					BestIndex = XMVectorSelect(BestIndex, XMVectorReplicate(static_cast<float>(iValue)), Closer);
+				}
+				Indices[iRow] = BestIndex;
+			}
+
+			uint32 TexelsIndices[NumBlockTexels];
+			StoreBlockIndices(Indices, TexelsIndices);
+
+			uint64 PackedIndices = 0;
+			for (uint32 iTexel = 0; iTexel < NumBlockTexels; ++iTexel)
+			{
+				PackedIndices |= static_cast<uint64>(TexelsIndices[iTexel]) << (iTexel * 3);
+			}
+
+			for (uint32 iByte = 0; iByte < 6; ++iByte)
+			{
+				Dst[2 + iByte] = static_cast<uint8>(PackedIndices >> (iByte * 8));
+			}
+		}
+
+		/** @brief Decodes 8 bytes of BC1 layout to RGBA8 texels
+		  * @param Src (const uint8 *)
+		  * @param bForce4Colors Color blocks of BC2 and BC3 always have 4 colors (bool)
+		  * @param Texels (uint8 *)
+		  * @return (void)
+		  */
+		void DecodeColorBlock(const uint8* Src, bool bForce4Colors, uint8* Texels)
+		{
+			const auto Color0 = static_cast<uint16>(Src[0] | (Src[1] << 8));
+			const auto Color1 = static_cast<uint16>(Src[2] | (Src[3] << 8));
+
+			uint8 Palette[4][4];
+			UnpackColor565(Color0, Palette[0]);
+			UnpackColor565(Color1, Palette[1]);
+			Palette[0][3] = 255;
+			Palette[1][3] = 255;
+
+			const auto b4Colors = bForce4Colors || Color0 > Color1;
+			for (uint32 iChannel = 0; iChannel < 3; ++iChannel)
+			{
+				const uint32 Value0 = Palette[0][iChannel];
+				const uint32 Value1 = Palette[1][iChannel];
+				if (b4Colors)
+				{
+					Palette[2][iChannel] = static_cast<uint8>((2 * Value0 + Value1 + 1) / 3);
+					Palette[3][iChannel] = static_cast<uint8>((Value0 + 2 * Value1 + 1) / 3);
+				}
+				else
+				{
+					Palette[2][iChannel] = static_cast<uint8>((Value0 + Value1) / 2);
+					Palette[3][iChannel] = 0;
+				}
+			}
+			Palette[2][3] = 255;
+			Palette[3][3] = b4Colors ? 255 : 0;
+
+			uint32 PackedIndices = 0;
+			std::memcpy(&PackedIndices, Src + 4, sizeof(PackedIndices));
+			for (uint32 iTexel = 0; iTexel < NumBlockTexels; ++iTexel)
+			{
+				std::memcpy(Texels + iTexel * 4, Palette[(PackedIndices >> (iTexel * 2)) & 3], 4);
+			}
+		}
+
+		/** @brief Decodes 8 bytes of BC4 layout to one channel of texels
+		  * @param Src (const uint8 *)
+		  * @param Values (uint8 *)
+		  * @param Stride Bytes between values of neighbour texels (uint32)
+		  * @return (void)
+		  */
+		void DecodeValueBlock(const uint8* Src, uint8* Values, uint32 Stride)
+		{
+			uint8 Palette[8];
+			BuildValuePalette(Src[0], Src[1], Palette);
+
+			uint64 PackedIndices = 0;
+			for (uint32 iByte = 0; iByte < 6; ++iByte)
+			{
+				PackedIndices |= static_cast<uint64>(Src[2 + iByte]) << (iByte * 8);
+			}
+
+			for (uint32 iTexel = 0; iTexel < NumBlockTexels; ++iTexel)
+			{
+				Values[iTexel * Stride] = Palette[(PackedIndices >> (iTexel * 3)) & 7];
+			}
+		}
+
+		/** @brief Copies texels of the block from the image. Texels out of the image repeat edge ones
+		  * @param Texels (const uint8 *)
+		  * @param Width (uint32)
+		  * @param Height (uint32)
+		  * @param BlockX (uint32)
+		  * @param BlockY (uint32)
+		  * @param BlockTexels (uint8 *)
+		  * @return (void)
+		  */
+		void GatherBlock(const uint8* Texels, uint32 Width, uint32 Height, uint32 BlockX, uint32 BlockY, uint8* BlockTexels)
+		{
+			for (uint32 y = 0; y < 4; ++y)
+			{
+				const auto TexelY = std::min(BlockY * 4 + y, Height - 1);
+				for (uint32 x = 0; x < 4; ++x)
+				{
+					const auto TexelX = std::min(BlockX * 4 + x, Width - 1);
+					std::memcpy(BlockTexels + (y * 4 + x) * 4, Texels + (static_cast<uint64>(TexelY)*Width + TexelX) * 4, 4);
+				}
+			}
+		}
+
+		uint32 GetBytesPerBlock(DXGI_FORMAT Format) noexcept
+		{
+			return Format == DXGI_FORMAT_BC1_UNORM || Format == DXGI_FORMAT_BC1_UNORM_SRGB ? 8 : 16;
+		}
+	}
+
+	FTextureCompressionStats FBlockCompressor::Compress(
+		const uint8* Texels,
+		uint32 Width,
+		uint32 Height,
+		DXGI_FORMAT Format,
+		uint8* Blocks)
+	{
+		if (!IsSupported(Format))
+		{
+			throw std::invalid_argument("Only BC1, BC3 and BC5 formats are supported");
+		}
+
+		if (Width == 0 || Height == 0)
+		{
+			throw std::invalid_argument("Image must be not empty");
+		}
+
+		const auto NumBlocksX = (Width + 3) / 4;
+		const auto NumBlocksY = (Height + 3) / 4;
+		const auto BytesPerBlock = GetBytesPerBlock(Format);
+		const auto NumChunks = (NumBlocksY + NumBlockRowsPerChunk - 1) / NumBlockRowsPerChunk;
+
+		const auto StartTime = std::chrono::high_resolution_clock::now();
+
+		concurrency::parallel_for(std::size_t(0), NumChunks, [&](std::size_t iChunk)
+		{
+			uint8 BlockTexels[NumBlockTexels * 4];
+
+			const auto ChunkEnd = std::min<std::size_t>((iChunk + 1)*NumBlockRowsPerChunk, NumBlocksY);
+			for (auto BlockY = iChunk*NumBlockRowsPerChunk; BlockY < ChunkEnd; ++BlockY)
+			{
+				for (uint32 BlockX = 0; BlockX < NumBlocksX; ++BlockX)
+				{
+					GatherBlock(Texels, Width, Height, BlockX, static_cast<uint32>(BlockY), BlockTexels);
+					EncodeBlock(BlockTexels, Format, Blocks + (BlockY*NumBlocksX + BlockX)*BytesPerBlock);
+				}
+			}
+		});
+
+		const auto EndTime = std::chrono::high_resolution_clock::now();
+
+		FTextureCompressionStats Stats;
+		Stats.NumPixels = static_cast<uint64>(Width)*Height;
+		Stats.Seconds = std::chrono::duration<double>(EndTime - StartTime).count();
+
+		// BC5 stores red and green only
+		const uint32 NumChannels = Format == DXGI_FORMAT_BC5_UNORM ? 2 : 4;
+		std::vector<double> ChunksErrors(NumChunks, 0.0);
+		concurrency::parallel_for(std::size_t(0), NumChunks, [&](std::size_t iChunk)
+		{
+			uint8 DecodedTexels[NumBlockTexels * 4];
+
+			const auto ChunkEnd = std::min<std::size_t>((iChunk + 1)*NumBlockRowsPerChunk, NumBlocksY);
+			for (auto BlockY = iChunk*NumBlockRowsPerChunk; BlockY < ChunkEnd; ++BlockY)
+			{
+				for (uint32 BlockX = 0; BlockX < NumBlocksX; ++BlockX)
+				{
+					DecodeBlock(Blocks + (BlockY*NumBlocksX + BlockX)*BytesPerBlock, Format, DecodedTexels);
+
+					const auto NumRows = std::min<uint32>(4, Height - static_cast<uint32>(BlockY) * 4);
+					const auto NumColumns = std::min<uint32>(4, Width - BlockX * 4);
+					for (uint32 y = 0; y < NumRows; ++y)
+					{
+						for (uint32 x = 0; x < NumColumns; ++x)
+						{
+							const auto Texel = Texels + ((BlockY * 4 + y)*Width + BlockX * 4 + x) * 4;
+							const auto DecodedTexel = DecodedTexels + (y * 4 + x) * 4;
+							for (uint32 iChannel = 0; iChannel < NumChannels; ++iChannel)
+							{
+								const double Delta = static_cast<int32>(Texel[iChannel]) - DecodedTexel[iChannel];
+								ChunksErrors[iChunk] += Delta*Delta;
+							}
+						}
+					}
+				}
+			}
+		});
+
+		for (auto ChunkError : ChunksErrors)
+		{
+			Stats.SquaredError += ChunkError;
+		}
+		Stats.NumErrorValues = Stats.NumPixels*NumChannels;
+
+		return Stats;
+	}
+
+	void FBlockCompressor::Decompress(
+		const uint8* Blocks,
+		uint32 Width,
+		uint32 Height,
+		DXGI_FORMAT Format,
+		uint8* Texels)
+	{
+		if (!IsSupported(Format))
+		{
+			throw std::invalid_argument("Only BC1, BC3 and BC5 formats are supported");
+		}
+
+		const auto NumBlocksX = (Width + 3) / 4;
+		const auto NumBlocksY = (Height + 3) / 4;
+		const auto BytesPerBlock = GetBytesPerBlock(Format);
+
+		uint8 DecodedTexels[NumBlockTexels * 4];
+		for (uint32 BlockY = 0; BlockY < NumBlocksY; ++BlockY)
+		{
+			for (uint32 BlockX = 0; BlockX < NumBlocksX; ++BlockX)
+			{
+				DecodeBlock(Blocks + (static_cast<uint64>(BlockY)*NumBlocksX + BlockX)*BytesPerBlock, Format, DecodedTexels);
+
+				const auto NumRows = std::min<uint32>(4, Height - BlockY * 4);
+				const auto NumColumns = std::min<uint32>(4, Width - BlockX * 4);
+				for (uint32 y = 0; y < NumRows; ++y)
+				{
+					std::memcpy(
+						Texels + ((static_cast<uint64>(BlockY) * 4 + y)*Width + BlockX * 4) * 4,
+						DecodedTexels + y * 16,
+						NumColumns * 4);
+				}
+			}
+		}
+	}
+
+	void FBlockCompressor::EncodeBlock(const uint8* Texels, DXGI_FORMAT Format, uint8* Block)
+	{
+		const auto BlockVectors = LoadBlock(Texels);
+
+		switch (Format)
+		{
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+			EncodeColorBlock(BlockVectors, true, Block);
+			break;
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+			EncodeValueBlock(BlockVectors.Channels[3], Block);
+			EncodeColorBlock(BlockVectors, false, Block + 8);
+			break;
+		case DXGI_FORMAT_BC5_UNORM:
+			EncodeValueBlock(BlockVectors.Channels[0], Block);
+			EncodeValueBlock(BlockVectors.Channels[1], Block + 8);
+			break;
+		default:
+			throw std::invalid_argument("Only BC1, BC3 and BC5 formats are supported");
+		}
+	}
+
+	void FBlockCompressor::DecodeBlock(const uint8* Block, DXGI_FORMAT Format, uint8* Texels)
+	{
+		switch (Format)
+		{
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+			DecodeColorBlock(Block, false, Texels);
+			break;
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+			DecodeColorBlock(Block + 8, true, Texels);
+			DecodeValueBlock(Block, Texels + 3, 4);
+			break;
+		case DXGI_FORMAT_BC5_UNORM:
+			for (uint32 iTexel = 0; iTexel < NumBlockTexels; ++iTexel)
+			{
+				Texels[iTexel * 4 + 2] = 0;
+				Texels[iTexel * 4 + 3] = 255;
+			}
+			DecodeValueBlock(Block, Texels, 4);
+			DecodeValueBlock(Block + 8, Texels + 1, 4);
+			break;
+		default:
+			throw std::invalid_argument("Only BC1, BC3 and BC5 formats are supported");
+		}
+	}
+
+	bool FBlockCompressor::IsSupported(DXGI_FORMAT Format) noexcept
+	{
+		switch (Format)
+		{
+		case DXGI_FORMAT_BC1_UNORM:
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+		case DXGI_FORMAT_BC3_UNORM:
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+		case DXGI_FORMAT_BC5_UNORM:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	uint64 FBlockCompressor::GetCompressedSize(uint32 Width, uint32 Height, DXGI_FORMAT Format)
+	{
+		if (!IsSupported(Format))
+		{
+			throw std::invalid_argument("Only BC1, BC3 and BC5 formats are supported");
+		}
+
+		return static_cast<uint64>((Width + 3) / 4)*((Height + 3) / 4)*GetBytesPerBlock(Format);
+	}
+}
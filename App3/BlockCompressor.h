@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cmath>
+
+#include "pch.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FTextureCompressionStats
+	 *
+	 * \brief Throughput and quality of block compression
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FTextureCompressionStats
+	{
+		uint64 NumPixels = 0;
+
+		// Time of encoding only. Measuring of errors isn't included
+		double Seconds = 0.0;
+
+		// Sum of squared errors of stored channels in [0, 255] and number of summed values
+		double SquaredError = 0.0;
+		uint64 NumErrorValues = 0;
+
+		/** @brief Millions of pixels encoded per second
+		  * @return (double)
+		  */
+		double GetMPixelsPerSecond() const noexcept
+		{
+			return Seconds > 0.0 ? NumPixels / Seconds / 1000000.0 : 0.0;
+		}
+
+		/** @brief Peak signal-to-noise ratio in dB. Lossless compression has infinite one
+		  * @return (double)
+		  */
+		double GetPSNR() const noexcept
+		{
+			if (NumErrorValues == 0 || SquaredError <= 0.0)
+			{
+				return INFINITY;
+			}
+
+			return 10.0*std::log10(255.0*255.0*NumErrorValues / SquaredError);
+		}
+
+		FTextureCompressionStats& operator+=(const FTextureCompressionStats& Stats) noexcept
+		{
+			NumPixels += Stats.NumPixels;
+			Seconds += Stats.Seconds;
+			SquaredError += Stats.SquaredError;
+			NumErrorValues += Stats.NumErrorValues;
+			return *this;
+		}
+	};
+
+	/*!
+	 * \class FBlockCompressor
+	 *
+	 * \brief Encodes RGBA8 images to BC1, BC3 and BC5 and decodes them back.
+	 * Colors of a block are fitted along their principal axis, and endpoints are refined by least squares.
+	 * Texels of a block are processed as 4 vectors of 4 texels, so DirectXMath maps it to SSE or NEON.
+	 * Block rows of an image are encoded on all cores
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FBlockCompressor
+	{
+	public:
+		FBlockCompressor() = default;
+		~FBlockCompressor() = default;
+
+		FBlockCompressor& operator=(const FBlockCompressor& BlockCompressor) = delete;
+		FBlockCompressor(const FBlockCompressor& BlockCompressor) = delete;
+		FBlockCompressor(FBlockCompressor&& BlockCompressor) = delete;
+
+		/** @brief Encodes the image. Blocks on edges of images which aren't multiple of 4 repeat edge texels
+		  * @param Texels RGBA8 texels of Width*Height (const uint8 *)
+		  * @param Width (uint32)
+		  * @param Height (uint32)
+		  * @param Format BC1, BC3 or BC5 (DXGI_FORMAT)
+		  * @param Blocks Rows of blocks, GetCompressedSize bytes (uint8 *)
+		  * @return Time and errors of the encoding (WoodenEngine::FTextureCompressionStats)
+		  */
+		static FTextureCompressionStats Compress(
+			const uint8* Texels,
+			uint32 Width,
+			uint32 Height,
+			DXGI_FORMAT Format,
+			uint8* Blocks);
+
+		/** @brief Decodes the image. Channels which aren't stored by the format are 0, alpha is 255
+		  * @param Blocks (const uint8 *)
+		  * @param Width (uint32)
+		  * @param Height (uint32)
+		  * @param Format BC1, BC3 or BC5 (DXGI_FORMAT)
+		  * @param Texels RGBA8 texels of Width*Height (uint8 *)
+		  * @return (void)
+		  */
+		static void Decompress(
+			const uint8* Blocks,
+			uint32 Width,
+			uint32 Height,
+			DXGI_FORMAT Format,
+			uint8* Texels);
+
+		/** @brief Encodes 4x4 RGBA8 texels
+		  * @param Texels 16 texels, row-major (const uint8 *)
+		  * @param Format (DXGI_FORMAT)
+		  * @param Block (uint8 *)
+		  * @return (void)
+		  */
+		static void EncodeBlock(const uint8* Texels, DXGI_FORMAT Format, uint8* Block);
+
+		/** @brief Decodes the block to 4x4 RGBA8 texels
+		  * @param Block (const uint8 *)
+		  * @param Format (DXGI_FORMAT)
+		  * @param Texels 16 texels, row-major (uint8 *)
+		  * @return (void)
+		  */
+		static void DecodeBlock(const uint8* Block, DXGI_FORMAT Format, uint8* Texels);
+
+		/** @brief Returns true for BC1, BC3 and BC5 formats
+		  * @param Format (DXGI_FORMAT)
+		  * @return (bool)
+		  */
+		static bool IsSupported(DXGI_FORMAT Format) noexcept;
+
+		/** @brief Returns size of the compressed image
+		  * @param Width (uint32)
+		  * @param Height (uint32)
+		  * @param Format (DXGI_FORMAT)
+		  * @return (uint64)
+		  */
+		static uint64 GetCompressedSize(uint32 Width, uint32 Height, DXGI_FORMAT Format);
+
+		// Block rows which are encoded by one task
+		static constexpr std::size_t NumBlockRowsPerChunk = 4;
+	};
+}
@@ -0,0 +1,188 @@
+//--------------------------------------------------------------------------------------
+// File: DDSLayout.h
+//
+// Device-independent part of DDSTextureLoader: DDS file structures, header parsing
+// and layout of subresources in the file. Depends on DXGI formats only, so it's
+// built and tested without Direct3D (on Linux with winadapter.h of DirectX-Headers)
+//
+// Based on DDSTextureLoader.cpp
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <wsl/winadapter.h>
+#endif
+
+#include <dxgiformat.h>
+
+//--------------------------------------------------------------------------------------
+// Macros
+//--------------------------------------------------------------------------------------
+#ifndef MAKEFOURCC
+    #define MAKEFOURCC(ch0, ch1, ch2, ch3)                              \
+                ((uint32_t)(uint8_t)(ch0) | ((uint32_t)(uint8_t)(ch1) << 8) |       \
+                ((uint32_t)(uint8_t)(ch2) << 16) | ((uint32_t)(uint8_t)(ch3) << 24 ))
+#endif /* defined(MAKEFOURCC) */
+
+//--------------------------------------------------------------------------------------
+// DDS file structure definitions
+//
+// See DDS.h in the 'Texconv' sample and the 'DirectXTex' library
+//--------------------------------------------------------------------------------------
+#pragma pack(push,1)
+
+const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+struct DDS_PIXELFORMAT
+{
+    uint32_t    size;
+    uint32_t    flags;
+    uint32_t    fourCC;
+    uint32_t    RGBBitCount;
+    uint32_t    RBitMask;
+    uint32_t    GBitMask;
+    uint32_t    BBitMask;
+    uint32_t    ABitMask;
+};
+
+#define DDS_FOURCC      0x00000004  // DDPF_FOURCC
+#define DDS_RGB         0x00000040  // DDPF_RGB
+#define DDS_LUMINANCE   0x00020000  // DDPF_LUMINANCE
+#define DDS_ALPHA       0x00000002  // DDPF_ALPHA
+
+#define DDS_HEADER_FLAGS_VOLUME         0x00800000  // DDSD_DEPTH
+
+#define DDS_HEIGHT 0x00000002 // DDSD_HEIGHT
+#define DDS_WIDTH  0x00000004 // DDSD_WIDTH
+
+#define DDS_CUBEMAP_POSITIVEX 0x00000600 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEX
+#define DDS_CUBEMAP_NEGATIVEX 0x00000a00 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEX
+#define DDS_CUBEMAP_POSITIVEY 0x00001200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEY
+#define DDS_CUBEMAP_NEGATIVEY 0x00002200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEY
+#define DDS_CUBEMAP_POSITIVEZ 0x00004200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEZ
+#define DDS_CUBEMAP_NEGATIVEZ 0x00008200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEZ
+
+#define DDS_CUBEMAP_ALLFACES ( DDS_CUBEMAP_POSITIVEX | DDS_CUBEMAP_NEGATIVEX |\
+                               DDS_CUBEMAP_POSITIVEY | DDS_CUBEMAP_NEGATIVEY |\
+                               DDS_CUBEMAP_POSITIVEZ | DDS_CUBEMAP_NEGATIVEZ )
+
+#define DDS_CUBEMAP 0x00000200 // DDSCAPS2_CUBEMAP
+
+enum DDS_MISC_FLAGS2
+{
+    DDS_MISC_FLAGS2_ALPHA_MODE_MASK = 0x7L,
+};
+
+struct DDS_HEADER
+{
+    uint32_t        size;
+    uint32_t        flags;
+    uint32_t        height;
+    uint32_t        width;
+    uint32_t        pitchOrLinearSize;
+    uint32_t        depth; // only if DDS_HEADER_FLAGS_VOLUME is set in flags
+    uint32_t        mipMapCount;
+    uint32_t        reserved1[11];
+    DDS_PIXELFORMAT ddspf;
+    uint32_t        caps;
+    uint32_t        caps2;
+    uint32_t        caps3;
+    uint32_t        caps4;
+    uint32_t        reserved2;
+};
+
+struct DDS_HEADER_DXT10
+{
+    DXGI_FORMAT     dxgiFormat;
+    uint32_t        resourceDimension;
+    uint32_t        miscFlag; // see D3D11_RESOURCE_MISC_FLAG
+    uint32_t        arraySize;
+    uint32_t        miscFlags2;
+};
+
+#pragma pack(pop)
+
+namespace DirectX
+{
+    // Values of D3D12_RESOURCE_DIMENSION and of resourceDimension in DDS_HEADER_DXT10
+    enum DDS_RESOURCE_DIMENSION
+    {
+        DDS_DIMENSION_UNKNOWN   = 0,
+        DDS_DIMENSION_TEXTURE1D = 2,
+        DDS_DIMENSION_TEXTURE2D = 3,
+        DDS_DIMENSION_TEXTURE3D = 4,
+    };
+
+    // D3D11_RESOURCE_MISC_TEXTURECUBE in miscFlag of DDS_HEADER_DXT10
+    const uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+    enum DDS_ALPHA_MODE
+    {
+        DDS_ALPHA_MODE_UNKNOWN       = 0,
+        DDS_ALPHA_MODE_STRAIGHT      = 1,
+        DDS_ALPHA_MODE_PREMULTIPLIED = 2,
+        DDS_ALPHA_MODE_OPAQUE        = 3,
+        DDS_ALPHA_MODE_CUSTOM        = 4,
+    };
+
+    // Subresource's data in the DDS file
+    struct DDS_SUBRESOURCE_LAYOUT
+    {
+        size_t offset;      // from the start of the file
+        size_t rowPitch;
+        size_t slicePitch;
+    };
+
+    // Texture described by a DDS file. Mips larger than maxsize are skipped
+    struct DDS_TEXTURE_LAYOUT
+    {
+        DDS_RESOURCE_DIMENSION resDim;
+        size_t width;       // of the most detailed loaded mip
+        size_t height;
+        size_t depth;
+        size_t mipCount;    // loaded mips
+        size_t skipMip;
+        size_t arraySize;   // number of faces for cube maps
+        DXGI_FORMAT format;
+        bool isCubeMap;
+        DDS_ALPHA_MODE alphaMode;
+
+        // mipCount * arraySize subresources, mip-major inside of every array slice
+        std::vector<DDS_SUBRESOURCE_LAYOUT> subresources;
+    };
+
+    size_t BitsPerPixel( DXGI_FORMAT fmt );
+
+    void GetSurfaceInfo( size_t width,
+                         size_t height,
+                         DXGI_FORMAT fmt,
+                         size_t* outNumBytes,
+                         size_t* outRowBytes,
+                         size_t* outNumRows );
+
+    DXGI_FORMAT GetDXGIFormat( const DDS_PIXELFORMAT& ddpf );
+
+    DDS_ALPHA_MODE GetAlphaMode( const DDS_HEADER* header );
+
+    // Validates headers of the whole DDS file and computes where its subresources are.
+    // Nothing is copied, so data can be uploaded right from a mapped file
+    HRESULT GetDDSTextureLayout( const uint8_t* ddsData,
+                                 size_t ddsDataSize,
+                                 size_t maxsize,
+                                 DDS_TEXTURE_LAYOUT& layout );
+
+    // Headers of a DDS file with the DX10 extension which describe a 2D texture.
+    // Mips follow them tightly packed, most detailed first
+    std::vector<uint8_t> CreateDDSHeaders( DXGI_FORMAT format,
+                                           size_t width,
+                                           size_t height,
+                                           size_t mipCount );
+}
@@ -22,9 +22,11 @@
 #pragma once
 #endif
 
+#include <functional>
 #include <wrl.h>
 #include <d3d11_1.h>
 #include "d3dx12.h"
+#include "DDSLayout.h"
 
 #pragma warning(push)
 #pragma warning(disable : 4005)
@@ -46,14 +48,10 @@
 
 namespace DirectX
 {
-    enum DDS_ALPHA_MODE
-    {
-        DDS_ALPHA_MODE_UNKNOWN       = 0,
-        DDS_ALPHA_MODE_STRAIGHT      = 1,
-        DDS_ALPHA_MODE_PREMULTIPLIED = 2,
-        DDS_ALPHA_MODE_OPAQUE        = 3,
-        DDS_ALPHA_MODE_CUSTOM        = 4,
-    };
+	// Allocates a range of an upload buffer for subresources of a texture. Returns the buffer or nullptr
+	// and sets the range's offset, which must be aligned to D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT.
+	// The range must be alive until the copy recorded to the command list is executed
+	typedef std::function<ID3D12Resource*(UINT64 size, UINT64& offset)> DDS_UPLOAD_ALLOCATOR;
 
     // Standard version
     HRESULT CreateDDSTextureFromMemory( _In_ ID3D11Device* d3dDevice,
@@ -75,6 +73,17 @@ namespace DirectX
 		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
 		                                 );
 
+	// Subresources are copied to a range allocated by uploadAllocator instead of a new upload heap
+	HRESULT CreateDDSTextureFromMemory12(_In_ ID3D12Device* device,
+		                                 _In_ ID3D12GraphicsCommandList* cmdList,
+		                                 _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
+		                                 _In_ size_t ddsDataSize,
+		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+		                                 _In_ const DDS_UPLOAD_ALLOCATOR& uploadAllocator,
+		                                 _In_ size_t maxsize = 0,
+		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                                 );
+
     HRESULT CreateDDSTextureFromFile( _In_ ID3D11Device* d3dDevice,
                                       _In_z_ const wchar_t* szFileName,
                                       _Outptr_opt_ ID3D11Resource** texture,
@@ -92,6 +101,26 @@ namespace DirectX
 		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
 		                               );
 
+	// Subresources are copied to a range allocated by uploadAllocator instead of a new upload heap
+	HRESULT CreateDDSTextureFromFile12(_In_ ID3D12Device* device,
+		                               _In_ ID3D12GraphicsCommandList* cmdList,
+		                               _In_z_ const wchar_t* szFileName,
+		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+		                               _In_ const DDS_UPLOAD_ALLOCATOR& uploadAllocator,
+		                               _In_ size_t maxsize = 0,
+		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                               );
+
+	// Creates the texture from DDS data whose layout was got by GetDDSTextureLayout,
+	// e.g. from a file which was mapped by a loading thread. ddsData is copied to the upload range during the call
+	HRESULT CreateDDSTextureFromLayout12(_In_ ID3D12Device* device,
+		                                 _In_ ID3D12GraphicsCommandList* cmdList,
+		                                 _In_ const uint8_t* ddsData,
+		                                 _In_ const DDS_TEXTURE_LAYOUT& layout,
+		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
+		                                 _In_ const DDS_UPLOAD_ALLOCATOR& uploadAllocator
+		                                 );
+
     // Standard version with optional auto-gen mipmap support
     HRESULT CreateDDSTextureFromMemory( _In_ ID3D11Device* d3dDevice,
                                         _In_opt_ ID3D11DeviceContext* d3dContext,
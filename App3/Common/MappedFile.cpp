@@ -0,0 +1,99 @@
+#include "MappedFile.h"
+
+namespace DX
+{
+	FMappedFile::FMappedFile(const std::string& FilePath):
+		FilePath(FilePath)
+	{
+		const auto WideFilePathLength = MultiByteToWideChar(
+			CP_UTF8, 0, FilePath.c_str(), static_cast<int>(FilePath.size()), nullptr, 0);
+		std::wstring WideFilePath(WideFilePathLength, L'\0');
+		MultiByteToWideChar(CP_UTF8, 0, FilePath.c_str(), static_cast<int>(FilePath.size()),
+			&WideFilePath[0], WideFilePathLength);
+
+		Map(WideFilePath);
+	}
+
+	FMappedFile::FMappedFile(const std::wstring& WideFilePath)
+	{
+		const auto FilePathLength = WideCharToMultiByte(
+			CP_UTF8, 0, WideFilePath.c_str(), static_cast<int>(WideFilePath.size()), nullptr, 0, nullptr, nullptr);
+		FilePath.resize(FilePathLength);
+		WideCharToMultiByte(CP_UTF8, 0, WideFilePath.c_str(), static_cast<int>(WideFilePath.size()),
+			&FilePath[0], FilePathLength, nullptr, nullptr);
+
+		Map(WideFilePath);
+	}
+
+	void FMappedFile::Map(const std::wstring& WideFilePath)
+	{
+		File = CreateFile2(WideFilePath.c_str(), GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr);
+		if (File == INVALID_HANDLE_VALUE)
+		{
+			throw std::invalid_argument("File can't be opened by path " + FilePath);
+		}
+
+		FILE_STANDARD_INFO FileInfo;
+		if (!GetFileInformationByHandleEx(File, FileStandardInfo, &FileInfo, sizeof(FileInfo)))
+		{
+			CloseHandle(File);
+			throw std::invalid_argument("Size of file " + FilePath + " can't be read");
+		}
+
+		Size = static_cast<uint64>(FileInfo.EndOfFile.QuadPart);
+
+		// Empty files can't be mapped
+		if (Size == 0)
+		{
+			return;
+		}
+
+		FileMapping = CreateFileMappingFromApp(File, nullptr, PAGE_READONLY, 0, nullptr);
+		if (FileMapping == nullptr)
+		{
+			CloseHandle(File);
+			throw std::invalid_argument("File " + FilePath + " can't be mapped");
+		}
+
+		Data = static_cast<const uint8*>(MapViewOfFileFromApp(FileMapping, FILE_MAP_READ, 0, 0));
+		if (Data == nullptr)
+		{
+			CloseHandle(FileMapping);
+			CloseHandle(File);
+			throw std::invalid_argument("View of file " + FilePath + " can't be mapped");
+		}
+	}
+
+	FMappedFile::~FMappedFile()
+	{
+		if (Data != nullptr)
+		{
+			UnmapViewOfFile(Data);
+		}
+
+		if (FileMapping != nullptr)
+		{
+			CloseHandle(FileMapping);
+		}
+
+		if (File != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(File);
+		}
+	}
+
+	const uint8* FMappedFile::GetData() const noexcept
+	{
+		return Data;
+	}
+
+	uint64 FMappedFile::GetSize() const noexcept
+	{
+		return Size;
+	}
+
+	const std::string& FMappedFile::GetFilePath() const noexcept
+	{
+		return FilePath;
+	}
+}
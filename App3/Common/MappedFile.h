@@ -0,0 +1,64 @@
+#pragma once
+
+#include "pch.h"
+
+namespace DX
+{
+	/*!
+	 * \class FMappedFile
+	 *
+	 * \brief Read-only view of a whole file mapped to the process' memory.
+	 * Pages are loaded by the OS on first access, nothing is copied on opening
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FMappedFile
+	{
+	public:
+		/** @brief Opens and maps the file. Throws invalid_argument if it can't be mapped
+		  * @param FilePath Path to the file (const std::string &)
+		  */
+		explicit FMappedFile(const std::string& FilePath);
+
+		/** @brief Opens and maps the file. Throws invalid_argument if it can't be mapped
+		  * @param FilePath Path to the file (const std::wstring &)
+		  */
+		explicit FMappedFile(const std::wstring& FilePath);
+		~FMappedFile();
+
+		FMappedFile& operator=(const FMappedFile& MappedFile) = delete;
+		FMappedFile(const FMappedFile& MappedFile) = delete;
+		FMappedFile(FMappedFile&& MappedFile) = delete;
+
+		/** @brief Returns the file's content. nullptr for an empty file
+		  * @return (const uint8 *)
+		  */
+		const uint8* GetData() const noexcept;
+
+		/** @brief Returns size of the file in bytes
+		  * @return (uint64)
+		  */
+		uint64 GetSize() const noexcept;
+
+		/** @brief Returns path of the mapped file
+		  * @return (const std::string&)
+		  */
+		const std::string& GetFilePath() const noexcept;
+
+	private:
+		/** @brief Opens and maps the file by its wide path
+		  * @param WideFilePath (const std::wstring &)
+		  * @return (void)
+		  */
+		void Map(const std::wstring& WideFilePath);
+
+		std::string FilePath;
+
+		HANDLE File = INVALID_HANDLE_VALUE;
+		HANDLE FileMapping = nullptr;
+
+		const uint8* Data = nullptr;
+		uint64 Size = 0;
+	};
+}
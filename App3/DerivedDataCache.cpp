@@ -0,0 +1,460 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#include "DerivedDataCache.h"
+
+namespace WoodenEngine
+{
+	namespace
+	{
+		// Entry of serialized meshes. Followed by the name, vertices and indices
+		struct FDerivedMeshRecord
+		{
+			uint32 NameSize = 0;
+			uint32 NumVertices = 0;
+			uint32 NumIndices = 0;
+			uint32 Topology = 0;
+			float GeometricError = 0.0f;
+			uint32 MaterialIndex = 0;
+			XMFLOAT4X4 Transform;
+		};
+
+		uint64 RotateLeft(uint64 Value, uint32 Shift)
+		{
+			return (Value << Shift) | (Value >> (64 - Shift));
+		}
+
+		uint64 MixHashWord(uint64 Word)
+		{
+			Word *= 0x87c37b91114253d5ULL;
+			Word = RotateLeft(Word, 31);
+			return Word * 0x4cf5ad432745937fULL;
+		}
+
+		uint64 FinalizeHash(uint64 Hash)
+		{
+			Hash ^= Hash >> 33;
+			Hash *= 0xff51afd7ed558ccdULL;
+			Hash ^= Hash >> 33;
+			Hash *= 0xc4ceb9fe1a85ec53ULL;
+			Hash ^= Hash >> 33;
+			return Hash;
+		}
+
+		// Bounds checked reading of a payload
+		class FPayloadReader
+		{
+		public:
+			FPayloadReader(const uint8* Data, uint64 Size):
+				Data(Data), Size(Size)
+			{ }
+
+			void Read(void* Destination, uint64 NumBytes)
+			{
+				if (NumBytes > Size - Offset)
+				{
+					throw std::invalid_argument("Derived data is truncated");
+				}
+
+				if (NumBytes > 0)
+				{
+					memcpy(Destination, Data + Offset, NumBytes);
+				}
+				Offset += NumBytes;
+			}
+
+		private:
+			const uint8* Data;
+			uint64 Size;
+			uint64 Offset = 0;
+		};
+
+		template<typename T>
+		void WritePayload(const T* Values, uint64 NumValues, std::vector<uint8>* Payload)
+		{
+			const auto Bytes = reinterpret_cast<const uint8*>(Values);
+			Payload->insert(Payload->end(), Bytes, Bytes + NumValues*sizeof(T));
+		}
+	}
+
+	FDerivedDataKey::FDerivedDataKey(const std::string& Type)
+	{
+		Hash[0] = 0x9e3779b97f4a7c15ULL;
+		Hash[1] = 0x6a09e667f3bcc909ULL;
+
+		Add(DerivedDataCacheVersion);
+		Add(Type);
+	}
+
+	FDerivedDataKey& FDerivedDataKey::Add(const void* Data, uint64 Size)
+	{
+		const auto Bytes = static_cast<const uint8*>(Data);
+
+		// Two lanes are mixed by 8 bytes words like in 128-bit MurmurHash3
+		const auto NumWords = Size / sizeof(uint64);
+		for (uint64 iWord = 0; iWord < NumWords; ++iWord)
+		{
+			uint64 Word;
+			memcpy(&Word, Bytes + iWord*sizeof(uint64), sizeof(Word));
+
+			Hash[0] = RotateLeft(Hash[0] ^ MixHashWord(Word), 27) * 5 + 0x52dce729;
+			Hash[1] = RotateLeft(Hash[1] ^ MixHashWord(Word ^ Hash[0]), 31) * 5 + 0x38495ab5;
+		}
+
+		uint64 Tail = 0;
+		memcpy(&Tail, Bytes + NumWords*sizeof(uint64), Size % sizeof(uint64));
+
+		Hash[0] = FinalizeHash(Hash[0] ^ MixHashWord(Tail) ^ Size);
+		Hash[1] = FinalizeHash(Hash[1] ^ MixHashWord(Tail ^ Hash[0]) ^ Size);
+
+		return *this;
+	}
+
+	FDerivedDataKey& FDerivedDataKey::Add(const std::string& String)
+	{
+		return Add(String.data(), String.size());
+	}
+
+	FDerivedDataKey& FDerivedDataKey::Add(const char* String)
+	{
+		return Add(String, strlen(String));
+	}
+
+	FDerivedDataKey& FDerivedDataKey::AddFile(const std::string& FilePath)
+	{
+		DX::FMappedFile File(FilePath);
+		return Add(File.GetData(), File.GetSize());
+	}
+
+	std::string FDerivedDataKey::ToString() const
+	{
+		char String[33];
+		snprintf(String, sizeof(String), "%016llx%016llx",
+			static_cast<unsigned long long>(Hash[0]), static_cast<unsigned long long>(Hash[1]));
+		return String;
+	}
+
+	FDerivedDataCache::FDerivedDataCache(const std::string& CacheDirectory):
+		CacheDirectory(CacheDirectory)
+	{
+		if (CacheDirectory.empty())
+		{
+			throw std::invalid_argument("CacheDirectory must be not empty");
+		}
+	}
+
+	std::unique_ptr<DX::FMappedFile> FDerivedDataCache::Find(const FDerivedDataKey& Key) const
+	{
+		std::unique_ptr<DX::FMappedFile> File;
+		try
+		{
+			File = std::make_unique<DX::FMappedFile>(GetFilePath(Key));
+		}
+		catch (const std::invalid_argument&)
+		{
+			return nullptr;
+		}
+
+		if (File->GetSize() < sizeof(FDerivedDataHeader))
+		{
+			return nullptr;
+		}
+
+		const auto& Header = *reinterpret_cast<const FDerivedDataHeader*>(File->GetData());
+		if (Header.Magic != DerivedDataMagic || Header.Version != DerivedDataCacheVersion ||
+			Header.PayloadSize != File->GetSize() - sizeof(FDerivedDataHeader))
+		{
+			return nullptr;
+		}
+
+		return File;
+	}
+
+	void FDerivedDataCache::Store(const FDerivedDataKey& Key, const void* Data, uint64 Size, double BuildSeconds)
+	{
+		const auto FilePath = GetFilePath(Key);
+
+		// Other threads and processes never see a partially written file
+		const auto TempFilePath = GetTempFilePath(FilePath);
+
+		FDerivedDataHeader Header;
+		Header.Magic = DerivedDataMagic;
+		Header.Version = DerivedDataCacheVersion;
+		Header.PayloadSize = Size;
+		Header.BuildSeconds = BuildSeconds;
+
+		{
+			std::ofstream File(TempFilePath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+			File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+			File.write(static_cast<const char*>(Data), Size);
+
+			if (!File.good())
+			{
+				DBOUT("Derived data isn't cached", TempFilePath);
+				File.close();
+				std::remove(TempFilePath.c_str());
+				return;
+			}
+		}
+
+		CommitFile(TempFilePath, FilePath);
+	}
+
+	std::vector<std::unique_ptr<FMeshRawData>> FDerivedDataCache::GetMeshes(
+		const FDerivedDataKey& Key,
+		const std::function<std::vector<std::unique_ptr<FMeshRawData>>()>& Build)
+	{
+		std::vector<std::unique_ptr<FMeshRawData>> MeshesData;
+		LoadOrBuild(Key,
+			[&MeshesData](const uint8* Data, uint64 Size)
+			{
+				MeshesData = LoadMeshes(Data, Size);
+			},
+			[&MeshesData, &Build]()
+			{
+				MeshesData = Build();
+				return SaveMeshes(MeshesData);
+			});
+
+		return MeshesData;
+	}
+
+	std::unique_ptr<FMeshRawData> FDerivedDataCache::GetMesh(
+		const FDerivedDataKey& Key,
+		const std::function<std::unique_ptr<FMeshRawData>()>& Build)
+	{
+		auto MeshesData = GetMeshes(Key, [&Build]()
+		{
+			std::vector<std::unique_ptr<FMeshRawData>> MeshesData;
+			MeshesData.push_back(Build());
+			return MeshesData;
+		});
+
+		if (MeshesData.size() != 1)
+		{
+			throw std::invalid_argument("Derived data " + Key.ToString() + " isn't a mesh");
+		}
+
+		return std::move(MeshesData[0]);
+	}
+
+	std::vector<uint8> FDerivedDataCache::GetData(
+		const FDerivedDataKey& Key,
+		const std::function<std::vector<uint8>()>& Build)
+	{
+		std::vector<uint8> Payload;
+		LoadOrBuild(Key,
+			[&Payload](const uint8* Data, uint64 Size)
+			{
+				Payload.assign(Data, Data + Size);
+			},
+			[&Payload, &Build]()
+			{
+				Payload = Build();
+				return Payload;
+			});
+
+		return Payload;
+	}
+
+	std::string FDerivedDataCache::GetFile(
+		const FDerivedDataKey& Key,
+		const std::string& Extension,
+		const std::function<void(const std::string&)>& Build)
+	{
+		const auto FilePath = GetFilePath(Key, Extension);
+		if (std::ifstream(FilePath, std::ios_base::in | std::ios_base::binary).is_open())
+		{
+			std::lock_guard<std::mutex> Lock(StatsMutex);
+			++Stats.NumHits;
+			return FilePath;
+		}
+
+		const auto StartTime = std::chrono::high_resolution_clock::now();
+
+		const auto TempFilePath = GetTempFilePath(FilePath);
+		try
+		{
+			Build(TempFilePath);
+		}
+		catch (...)
+		{
+			std::remove(TempFilePath.c_str());
+			throw;
+		}
+
+		CommitFile(TempFilePath, FilePath);
+
+		const std::chrono::duration<double> BuildTime =
+			std::chrono::high_resolution_clock::now() - StartTime;
+		{
+			std::lock_guard<std::mutex> Lock(StatsMutex);
+			++Stats.NumMisses;
+		}
+
+		DBOUT("Derived file " + Key.ToString() + Extension + " miss", "built in " << BuildTime.count() * 1000.0 << " ms");
+		return FilePath;
+	}
+
+	FDerivedDataCacheStats FDerivedDataCache::GetStats() const
+	{
+		std::lock_guard<std::mutex> Lock(StatsMutex);
+		return Stats;
+	}
+
+	std::vector<uint8> FDerivedDataCache::SaveMeshes(const std::vector<std::unique_ptr<FMeshRawData>>& MeshesData)
+	{
+		std::vector<uint8> Payload;
+
+		const auto NumMeshes = static_cast<uint32>(MeshesData.size());
+		WritePayload(&NumMeshes, 1, &Payload);
+
+		for (const auto& MeshData : MeshesData)
+		{
+			if (MeshData->Vertices.size() > UINT32_MAX || MeshData->Indices.size() > UINT32_MAX)
+			{
+				throw std::invalid_argument("Mesh " + MeshData->Name + " is too big for derived data");
+			}
+
+			FDerivedMeshRecord Record;
+			Record.NameSize = static_cast<uint32>(MeshData->Name.size());
+			Record.NumVertices = static_cast<uint32>(MeshData->Vertices.size());
+			Record.NumIndices = static_cast<uint32>(MeshData->Indices.size());
+			Record.Topology = static_cast<uint32>(MeshData->Topology);
+			Record.GeometricError = MeshData->GeometricError;
+			Record.MaterialIndex = MeshData->MaterialIndex;
+			Record.Transform = MeshData->Transform;
+
+			WritePayload(&Record, 1, &Payload);
+			WritePayload(MeshData->Name.data(), MeshData->Name.size(), &Payload);
+			WritePayload(MeshData->Vertices.data(), MeshData->Vertices.size(), &Payload);
+			WritePayload(MeshData->Indices.data(), MeshData->Indices.size(), &Payload);
+		}
+
+		return Payload;
+	}
+
+	std::vector<std::unique_ptr<FMeshRawData>> FDerivedDataCache::LoadMeshes(const uint8* Data, uint64 Size)
+	{
+		FPayloadReader Reader(Data, Size);
+
+		uint32 NumMeshes = 0;
+		Reader.Read(&NumMeshes, sizeof(NumMeshes));
+
+		std::vector<std::unique_ptr<FMeshRawData>> MeshesData;
+		for (uint32 iMesh = 0; iMesh < NumMeshes; ++iMesh)
+		{
+			FDerivedMeshRecord Record;
+			Reader.Read(&Record, sizeof(Record));
+
+			// Sizes are validated before allocations
+			if (Record.NameSize > Size ||
+				Record.NumVertices > Size / sizeof(FVertex) ||
+				Record.NumIndices > Size / sizeof(uint32))
+			{
+				throw std::invalid_argument("Derived data is truncated");
+			}
+
+			auto MeshData = std::make_unique<FMeshRawData>();
+			MeshData->Name.resize(Record.NameSize);
+			MeshData->Vertices.resize(Record.NumVertices);
+			MeshData->Indices.resize(Record.NumIndices);
+			MeshData->Topology = static_cast<D3D_PRIMITIVE_TOPOLOGY>(Record.Topology);
+			MeshData->GeometricError = Record.GeometricError;
+			MeshData->MaterialIndex = Record.MaterialIndex;
+			MeshData->Transform = Record.Transform;
+
+			Reader.Read(&MeshData->Name[0], Record.NameSize);
+			Reader.Read(MeshData->Vertices.data(), Record.NumVertices*sizeof(FVertex));
+			Reader.Read(MeshData->Indices.data(), Record.NumIndices*sizeof(uint32));
+
+			MeshesData.push_back(std::move(MeshData));
+		}
+
+		return MeshesData;
+	}
+
+	void FDerivedDataCache::LoadOrBuild(
+		const FDerivedDataKey& Key,
+		const std::function<void(const uint8*, uint64)>& Load,
+		const std::function<std::vector<uint8>()>& Build)
+	{
+		const auto StartTime = std::chrono::high_resolution_clock::now();
+
+		auto File = Find(Key);
+		if (File != nullptr)
+		{
+			const auto& Header = *reinterpret_cast<const FDerivedDataHeader*>(File->GetData());
+			try
+			{
+				Load(File->GetData() + sizeof(FDerivedDataHeader), Header.PayloadSize);
+
+				const std::chrono::duration<double> LoadTime =
+					std::chrono::high_resolution_clock::now() - StartTime;
+				{
+					std::lock_guard<std::mutex> Lock(StatsMutex);
+					++Stats.NumHits;
+					Stats.SavedSeconds += Header.BuildSeconds - LoadTime.count();
+				}
+
+				DBOUT("Derived data " + Key.ToString() + " hit", "loaded in " << LoadTime.count() * 1000.0 <<
+					" ms instead of " << Header.BuildSeconds * 1000.0 << " ms");
+				return;
+			}
+			catch (const std::invalid_argument& Exception)
+			{
+				// Corrupted data is rebuilt
+				DBOUT("Derived data " + Key.ToString() + " is invalid", Exception.what());
+			}
+		}
+
+		const auto Payload = Build();
+
+		const std::chrono::duration<double> BuildTime =
+			std::chrono::high_resolution_clock::now() - StartTime;
+
+		File.reset();
+		Store(Key, Payload.data(), Payload.size(), BuildTime.count());
+
+		{
+			std::lock_guard<std::mutex> Lock(StatsMutex);
+			++Stats.NumMisses;
+		}
+
+		DBOUT("Derived data " + Key.ToString() + " miss", "built in " << BuildTime.count() * 1000.0 << " ms");
+	}
+
+	std::string FDerivedDataCache::GetFilePath(const FDerivedDataKey& Key, const std::string& Extension) const
+	{
+		return CacheDirectory + "\\" + Key.ToString() + Extension;
+	}
+
+	std::string FDerivedDataCache::GetTempFilePath(const std::string& FilePath)
+	{
+		return FilePath + "." +
+			std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + "." +
+			std::to_string(NumStores++) + ".tmp";
+	}
+
+	void FDerivedDataCache::CommitFile(const std::string& TempFilePath, const std::string& FilePath)
+	{
+		auto ToWide = [](const std::string& Path)
+		{
+			const auto WidePathLength = MultiByteToWideChar(
+				CP_UTF8, 0, Path.c_str(), static_cast<int>(Path.size()), nullptr, 0);
+			std::wstring WidePath(WidePathLength, L'\0');
+			MultiByteToWideChar(CP_UTF8, 0, Path.c_str(), static_cast<int>(Path.size()), &WidePath[0], WidePathLength);
+			return WidePath;
+		};
+
+		// The old file (stored by someone else or invalid) is replaced in one step, so readers never miss the file.
+		// Replacing fails while the old file is mapped, then it's kept
+		if (!MoveFileExW(ToWide(TempFilePath).c_str(), ToWide(FilePath).c_str(), MOVEFILE_REPLACE_EXISTING))
+		{
+			std::remove(TempFilePath.c_str());
+		}
+	}
+}
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+
+#include "Common/MappedFile.h"
+#include "MeshData.h"
+
+namespace WoodenEngine
+{
+	// Is hashed to every key. Must be increased when importers, generators or formats of derived data change
+	constexpr uint32 DerivedDataCacheVersion = 1;
+
+	// "WDDC"
+	constexpr uint32 DerivedDataMagic = 0x43444457;
+
+	/*!
+	 * \struct FDerivedDataHeader
+	 *
+	 * \brief Header of a cached derived data file. Followed by the payload
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FDerivedDataHeader
+	{
+		uint32 Magic = 0;
+		uint32 Version = 0;
+
+		uint64 PayloadSize = 0;
+
+		// Time spent on building the data on the cache miss
+		double BuildSeconds = 0.0;
+	};
+
+	/*!
+	 * \struct FDerivedDataCacheStats
+	 *
+	 * \brief Statistics of derived data cache's lookups
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FDerivedDataCacheStats
+	{
+		uint32 NumHits = 0;
+		uint32 NumMisses = 0;
+
+		// Sum of build time of hit data minus time of their loading
+		double SavedSeconds = 0.0;
+
+		float GetHitRate() const noexcept
+		{
+			const auto NumLookups = NumHits + NumMisses;
+			return NumLookups > 0 ? static_cast<float>(NumHits) / NumLookups : 0.0f;
+		}
+	};
+
+	/*!
+	 * \class FDerivedDataKey
+	 *
+	 * \brief 128-bit hash of everything which derived data depends on:
+	 * its type, source bytes, parameters of importers and generators and the cache's version
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FDerivedDataKey
+	{
+	public:
+		/** @brief Starts the key with the data's type and DerivedDataCacheVersion
+		  * @param Type Name of the data's producer (const std::string &)
+		  */
+		explicit FDerivedDataKey(const std::string& Type);
+
+		/** @brief Hashes the bytes. Their size is hashed too, so sequences of arguments don't collide
+		  * @param Data (const void *)
+		  * @param Size (uint64)
+		  * @return (WoodenEngine::FDerivedDataKey&)
+		  */
+		FDerivedDataKey& Add(const void* Data, uint64 Size);
+
+		/** @brief Hashes the string's characters
+		  * @param String (const std::string &)
+		  * @return (WoodenEngine::FDerivedDataKey&)
+		  */
+		FDerivedDataKey& Add(const std::string& String);
+
+		/** @brief Hashes the string's characters
+		  * @param String Zero-terminated string (const char *)
+		  * @return (WoodenEngine::FDerivedDataKey&)
+		  */
+		FDerivedDataKey& Add(const char* String);
+
+		/** @brief Hashes bytes of the parameter
+		  * @param Value Trivially copyable value (const T &)
+		  * @return (WoodenEngine::FDerivedDataKey&)
+		  */
+		template<typename T>
+		FDerivedDataKey& Add(const T& Value)
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "Parameter must be trivially copyable");
+			return Add(&Value, sizeof(Value));
+		}
+
+		/** @brief Hashes content of the file. Throws invalid_argument if it can't be read
+		  * @param FilePath (const std::string &)
+		  * @return (WoodenEngine::FDerivedDataKey&)
+		  */
+		FDerivedDataKey& AddFile(const std::string& FilePath);
+
+		/** @brief Returns the key as 32 hex digits
+		  * @return (std::string)
+		  */
+		std::string ToString() const;
+
+	private:
+		uint64 Hash[2];
+	};
+
+	/*!
+	 * \class FDerivedDataCache
+	 *
+	 * \brief Content-addressed on-disk cache of processed assets.
+	 * Data is stored in files named by their keys. Hits are read from mapped files,
+	 * misses are written to temporary files which are renamed to keys' names,
+	 * so a file with a key's name is always complete. Lookups are thread-safe
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FDerivedDataCache
+	{
+	public:
+		/** @brief Cache in the existing directory
+		  * @param CacheDirectory (const std::string &)
+		  */
+		explicit FDerivedDataCache(const std::string& CacheDirectory);
+		~FDerivedDataCache() = default;
+
+		FDerivedDataCache& operator=(const FDerivedDataCache& DerivedDataCache) = delete;
+		FDerivedDataCache(const FDerivedDataCache& DerivedDataCache) = delete;
+		FDerivedDataCache(FDerivedDataCache&& DerivedDataCache) = delete;
+
+		/** @brief Maps the cached data file. Its payload follows FDerivedDataHeader
+		  * @param Key (const FDerivedDataKey &)
+		  * @return Mapped file or nullptr if the data isn't cached or is invalid (std::unique_ptr<DX::FMappedFile>)
+		  */
+		std::unique_ptr<DX::FMappedFile> Find(const FDerivedDataKey& Key) const;
+
+		/** @brief Writes the data to the cache atomically. Failures are reported to debug output only
+		  * @param Key (const FDerivedDataKey &)
+		  * @param Data (const void *)
+		  * @param Size (uint64)
+		  * @param BuildSeconds Time spent on building the data (double)
+		  * @return (void)
+		  */
+		void Store(const FDerivedDataKey& Key, const void* Data, uint64 Size, double BuildSeconds);
+
+		/** @brief Returns cached meshes or builds and caches them
+		  * @param Key (const FDerivedDataKey &)
+		  * @param Build Is called on the cache miss
+		  * (const std::function<std::vector<std::unique_ptr<FMeshRawData>>()> &)
+		  * @return (std::vector<std::unique_ptr<WoodenEngine::FMeshRawData>>)
+		  */
+		std::vector<std::unique_ptr<FMeshRawData>> GetMeshes(
+			const FDerivedDataKey& Key,
+			const std::function<std::vector<std::unique_ptr<FMeshRawData>>()>& Build);
+
+		/** @brief Returns the cached mesh or builds and caches it
+		  * @param Key (const FDerivedDataKey &)
+		  * @param Build Is called on the cache miss (const std::function<std::unique_ptr<FMeshRawData>()> &)
+		  * @return (std::unique_ptr<WoodenEngine::FMeshRawData>)
+		  */
+		std::unique_ptr<FMeshRawData> GetMesh(
+			const FDerivedDataKey& Key,
+			const std::function<std::unique_ptr<FMeshRawData>()>& Build);
+
+		/** @brief Returns cached data or builds and caches it. Used for textures' mips and compressed data
+		  * @param Key (const FDerivedDataKey &)
+		  * @param Build Is called on the cache miss (const std::function<std::vector<uint8>()> &)
+		  * @return (std::vector<uint8>)
+		  */
+		std::vector<uint8> GetData(
+			const FDerivedDataKey& Key,
+			const std::function<std::vector<uint8>()>& Build);
+
+		/** @brief Returns path of the cached file or builds it. Is used for data which is mapped by its own loader,
+		  * like baked mesh files. The file is built to a temporary path and moved to the cache atomically
+		  * @param Key (const FDerivedDataKey &)
+		  * @param Extension Extension of the cached file (like ".wmesh") (const std::string &)
+		  * @param Build Writes the file to the given path on the cache miss (const std::function<void(const std::string &)> &)
+		  * @return (std::string)
+		  */
+		std::string GetFile(
+			const FDerivedDataKey& Key,
+			const std::string& Extension,
+			const std::function<void(const std::string&)>& Build);
+
+		/** @brief Returns statistics of lookups
+		  * @return (WoodenEngine::FDerivedDataCacheStats)
+		  */
+		FDerivedDataCacheStats GetStats() const;
+
+		/** @brief Serializes meshes to a derived data payload
+		  * @param MeshesData (const std::vector<std::unique_ptr<FMeshRawData>> &)
+		  * @return (std::vector<uint8>)
+		  */
+		static std::vector<uint8> SaveMeshes(const std::vector<std::unique_ptr<FMeshRawData>>& MeshesData);
+
+		/** @brief Deserializes meshes. Throws invalid_argument if the payload is truncated
+		  * @param Data (const uint8 *)
+		  * @param Size (uint64)
+		  * @return (std::vector<std::unique_ptr<WoodenEngine::FMeshRawData>>)
+		  */
+		static std::vector<std::unique_ptr<FMeshRawData>> LoadMeshes(const uint8* Data, uint64 Size);
+
+	private:
+		/** @brief Looks up the key and reads its payload by Load or builds and stores the payload
+		  * @param Key (const FDerivedDataKey &)
+		  * @param Load Is called with the payload on the cache hit. Throws if it's invalid
+		  * (const std::function<void(const uint8 *, uint64)> &)
+		  * @param Build Builds the payload on the cache miss (const std::function<std::vector<uint8>()> &)
+		  * @return (void)
+		  */
+		void LoadOrBuild(
+			const FDerivedDataKey& Key,
+			const std::function<void(const uint8*, uint64)>& Load,
+			const std::function<std::vector<uint8>()>& Build);
+
+		/** @brief Returns path of the key's file
+		  * @param Key (const FDerivedDataKey &)
+		  * @param Extension (const std::string &)
+		  * @return (std::string)
+		  */
+		std::string GetFilePath(const FDerivedDataKey& Key, const std::string& Extension = ".ddc") const;
+
+		/** @brief Returns unique path of a temporary file, which is moved to the file path when it's written
+		  * @param FilePath (const std::string &)
+		  * @return (std::string)
+		  */
+		std::string GetTempFilePath(const std::string& FilePath);
+
+		/** @brief Moves the written temporary file to the cache, atomically replacing an existing file.
+		  * The temporary file is removed on failure
+		  * @param TempFilePath (const std::string &)
+		  * @param FilePath (const std::string &)
+		  * @return (void)
+		  */
+		static void CommitFile(const std::string& TempFilePath, const std::string& FilePath);
+
+		std::string CacheDirectory;
+
+		// Makes names of temporary files unique
+		std::atomic<uint32> NumStores{ 0 };
+
+		mutable std::mutex StatsMutex;
+
+		FDerivedDataCacheStats Stats;
+	};
+}
@@ -1,11 +1,19 @@
 #include "pch.h"
+#include <algorithm>
 #include <array>
 
+#include "AssetPackage.h"
 #include "MeshData.h"
+#include "MeshFile.h"
+#include "MeshletBuilder.h"
+#include "MeshSimplifier.h"
+#include "MeshWelder.h"
+#include "TextureBuilder.h"
 #include "GameMain.h"
 #include "Object.h"
 #include "Camera.h"
 #include "Common/DirectXHelper.h"
+#include "Common/MappedFile.h"
 #include "LightPoint.h"
 #include "LightDirectional.h"
 #include "LightSpot.h"
@@ -34,6 +42,7 @@ namespace WoodenEngine
 	bool FGameMain::Initialize(Windows::UI::Core::CoreWindow^ outWindow)
 	{		
 		Window = outWindow;
+		LogicalDpi = Windows::Graphics::Display::DisplayInformation::GetForCurrentView()->LogicalDpi;
 
 
 		InitDevice();
@@ -61,6 +70,10 @@ namespace WoodenEngine
 
 		SignalAndWaitForGPU();
 
+		// Staging memory of initial uploads is recycled at once
+		GameResources->SubmitUploads(FenceValue);
+		GameResources->ReclaimUploads(Fence->GetCompletedValue());
+
 		return true;
 	}
 
@@ -131,45 +144,59 @@ namespace WoodenEngine
 
 	void FGameMain::InitTexturesViews()
 	{
-		CD3DX12_CPU_DESCRIPTOR_HANDLE SRVDescriptorHandle(
-			SRVDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
-
-		const auto& TexturesData = GameResources->GetTexturesData();
+		// Textures are stored in order of their adding, so views are too. Back slots follow views of render targets
+		const auto iFirstBackSRVHeap = GameResources->GetNumTexturesData() + 5;
 		uint32 iTexture = 0;
-		for (auto TexturesDataIter = TexturesData.cbegin(); TexturesDataIter != TexturesData.cend(); ++TexturesDataIter, ++iTexture)
+		for (auto& TextureData : GameResources->GetTexturesData())
 		{
-			auto TextureData = TexturesDataIter->second.get();
-		
-			D3D12_SHADER_RESOURCE_VIEW_DESC SRVDesc = {};
-			SRVDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-			SRVDesc.Format = TextureData->Resource->GetDesc().Format;
+			TextureData.iBackSRVHeap = iFirstBackSRVHeap + iTexture;
+			TextureData.iSRVHeap = iTexture++;
+
+			InitTextureView(&TextureData);
+		}
+	}
+
+	void FGameMain::InitTextureView(const FTextureData* TextureData)
+	{
+		CD3DX12_CPU_DESCRIPTOR_HANDLE SRVDescriptorHandle(
+			SRVDescriptorHeap->GetCPUDescriptorHandleForHeapStart(),
+			TextureData->iSRVHeap, CBVSRVDescriptorHandleIncrementSize);
+
+		// Loaded by now
+		auto Resource = TextureData->Resource != nullptr ? 
+			TextureData->Resource.Get() : GameResources->GetTextureData(PlaceholderTextureHandle)->Resource.Get();
 
-			SRVDesc.ViewDimension = TextureData->ViewDimension;
-			switch (SRVDesc.ViewDimension)
+		D3D12_SHADER_RESOURCE_VIEW_DESC SRVDesc = {};
+		SRVDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+		SRVDesc.Format = Resource->GetDesc().Format;
+
+		SRVDesc.ViewDimension = TextureData->ViewDimension;
+		switch (SRVDesc.ViewDimension)
+		{
+		case D3D12_SRV_DIMENSION_TEXTURE2D:
 			{
-			case D3D12_SRV_DIMENSION_TEXTURE2D:
-				{
-					SRVDesc.Texture2D.MostDetailedMip = 0;
-					SRVDesc.Texture2D.MipLevels = TextureData->Resource->GetDesc().MipLevels;
-					SRVDesc.Texture2D.ResourceMinLODClamp = 0.0f;
-					break;
-				}
-			case D3D12_SRV_DIMENSION_TEXTURE2DARRAY:
+				SRVDesc.Texture2D.MostDetailedMip = 0;
+				SRVDesc.Texture2D.MipLevels = Resource->GetDesc().MipLevels;
+				SRVDesc.Texture2D.ResourceMinLODClamp = 0.0f;
+				break;
+			}
+		case D3D12_SRV_DIMENSION_TEXTURE2DARRAY:
+			{
+				// Null view of a not loaded array is read as zeros
+				if (TextureData->Resource == nullptr)
 				{
-					SRVDesc.Texture2DArray.MostDetailedMip = 0;
-					SRVDesc.Texture2DArray.MipLevels = TextureData->Resource->GetDesc().MipLevels;
-					SRVDesc.Texture2DArray.FirstArraySlice = 0;
-					SRVDesc.Texture2DArray.ArraySize = TextureData->Resource->GetDesc().DepthOrArraySize;
-					break;
+					Resource = nullptr;
 				}
-			}
-
-			Device->CreateShaderResourceView(TextureData->Resource.Get(), &SRVDesc, SRVDescriptorHandle);
-
-			TextureData->iSRVHeap = iTexture;
 
-			SRVDescriptorHandle.Offset(CBVSRVDescriptorHandleIncrementSize);
+				SRVDesc.Texture2DArray.MostDetailedMip = 0;
+				SRVDesc.Texture2DArray.MipLevels = Resource != nullptr ? Resource->GetDesc().MipLevels : 1;
+				SRVDesc.Texture2DArray.FirstArraySlice = 0;
+				SRVDesc.Texture2DArray.ArraySize = Resource != nullptr ? Resource->GetDesc().DepthOrArraySize : 1;
+				break;
+			}
 		}
+
+		Device->CreateShaderResourceView(Resource, &SRVDesc, SRVDescriptorHandle);
 	}
 
 	void FGameMain::InitDevice()
@@ -219,26 +246,191 @@ namespace WoodenEngine
 
 	void FGameMain::InitGameResources()
 	{
+		// Imported and generated meshes are cached between starts
+		const std::wstring CacheDirectory = std::wstring(
+			Windows::Storage::ApplicationData::Current->LocalCacheFolder->Path->Data()) + L"\\DerivedData";
+		CreateDirectoryW(CacheDirectory.c_str(), nullptr);
+
+		const auto CacheDirectoryLength = WideCharToMultiByte(CP_UTF8, 0, CacheDirectory.c_str(),
+			static_cast<int>(CacheDirectory.size()), nullptr, 0, nullptr, nullptr);
+		std::string CacheDirectoryUTF8(CacheDirectoryLength, '\0');
+		WideCharToMultiByte(CP_UTF8, 0, CacheDirectory.c_str(), static_cast<int>(CacheDirectory.size()),
+			&CacheDirectoryUTF8[0], CacheDirectoryLength, nullptr, nullptr);
+
+		DerivedDataCache = std::make_unique<FDerivedDataCache>(CacheDirectoryUTF8);
+
 		GameResources = std::make_unique<FGameResource>(Device);
+		TextureStreamer = std::make_unique<FTextureStreamer>();
+
+		if (bUseAssetPackage)
+		{
+			InitAssetPackage(CacheDirectoryUTF8 + "\\Assets.wpak");
+		}
 
 		AddTextures();
 		AddMaterials();
+		TextureAtlasBuilder.reset();
+
 		AddObjects();
 		AddLights();
+
+		const auto CacheStats = DerivedDataCache->GetStats();
+		DBOUT("Derived data cache at startup", CacheStats.NumHits << " hits, " << CacheStats.NumMisses << 
+			" misses, saved " << CacheStats.SavedSeconds << " s");
 	}
 	
+	void FGameMain::InitAssetPackage(const std::string& PackageFilePath)
+	{
+		const std::vector<std::string> AssetFilesPaths = {
+			"Assets\\Textures\\white1x1.dds",
+			"Assets\\Textures\\WoodCrate01.dds",
+			"Assets\\Textures\\WireFence.dds",
+			"Assets\\Textures\\water1.dds",
+			"Assets\\Textures\\grass.dds",
+			"Assets\\Textures\\ice.dds",
+			"Assets\\Textures\\treeArray2.dds" };
+
+		// Key is computed from sizes and write times, so the package is validated without reading asset files.
+		// A package packed offline by AssetPacker from the same files is accepted as well
+		std::vector<std::string> PackedFilesPaths;
+		const auto SourceKey = FAssetPackageWriter::GetSourceKey(AssetFilesPaths, PackedFilesPaths);
+		for (const auto& AssetFilePath : AssetFilesPaths)
+		{
+			if (std::find(PackedFilesPaths.cbegin(), PackedFilesPaths.cend(), AssetFilePath) == PackedFilesPaths.cend())
+			{
+				DBOUT("Asset isn't packed", AssetFilePath << " is missing");
+			}
+		}
+
+		const auto StartTime = std::chrono::high_resolution_clock::now();
+
+		std::shared_ptr<const FAssetPackage> AssetPackage;
+		try
+		{
+			AssetPackage = std::make_shared<const FAssetPackage>(PackageFilePath);
+			if (AssetPackage->GetSourceKey() != SourceKey)
+			{
+				AssetPackage.reset();
+			}
+		}
+		catch (const std::invalid_argument&)
+		{
+		}
+
+		if (AssetPackage == nullptr)
+		{
+			FAssetPackageWriter AssetPackageWriter;
+			for (const auto& PackedFilePath : PackedFilesPaths)
+			{
+				AssetPackageWriter.AddFile(PackedFilePath, true);
+			}
+
+			const auto PackageStats = AssetPackageWriter.Save(PackageFilePath, SourceKey);
+			DBOUT("Asset package is packed", PackageStats.NumEntries << " entries (" << 
+				PackageStats.NumCompressedEntries << " compressed), " << PackageStats.UncompressedSize << " -> " <<
+				PackageStats.PackageSize << " bytes in " << PackageStats.Seconds << " s");
+
+			AssetPackage = std::make_shared<const FAssetPackage>(PackageFilePath);
+		}
+
+		const std::chrono::duration<double, std::milli> OpenTime = std::chrono::high_resolution_clock::now() - StartTime;
+		DBOUT("Asset package is opened", AssetPackage->GetNumEntries() << " entries in " << OpenTime.count() << " ms");
+
+		GameResources->SetAssetPackage(std::move(AssetPackage));
+	}
+
 	void FGameMain::AddTextures()
 	{
 		auto BasePath = static_cast<std::wstring>(L"Assets\\Textures\\");
 
-		GameResources->LoadTexture(BasePath + L"WireFence.dds", "wirefence", CMDList);
-		GameResources->LoadTexture(BasePath + L"WoodCrate01.dds", "crate", CMDList);
-		GameResources->LoadTexture(BasePath + L"water1.dds", "water", CMDList);
-		GameResources->LoadTexture(BasePath + L"grass.dds", "grass", CMDList);
-		GameResources->LoadTexture(BasePath + L"ice.dds", "glass", CMDList);
+		// Placeholder of textures which are being loaded
 		GameResources->LoadTexture(BasePath + L"white1x1.dds", "white1x1", CMDList);
-		GameResources->LoadTexture(BasePath + L"treeArray2.dds", "tree", CMDList, 
-								   D3D12_SRV_DIMENSION_TEXTURE2DARRAY);
+		PlaceholderTextureHandle = GameResources->GetTextureHandle("white1x1");
+
+		// Untiled textures are packed to one atlas, so their objects are drawn with the same descriptor table.
+		// Placement is computed from headers here. The atlas is built by a loading worker once and then is cached
+		const std::string AtlasBasePath = "Assets\\Textures\\";
+		const std::vector<std::pair<std::string, std::string>> AtlasTextures = {
+			{ "white1x1", "white1x1.dds" },
+			{ "crate", "WoodCrate01.dds" },
+			{ "wirefence", "WireFence.dds" } };
+
+		const FTextureAtlasSettings AtlasSettings;
+		TextureAtlasBuilder = std::make_shared<FTextureAtlasBuilder>(AtlasSettings);
+		for (const auto& AtlasTexture : AtlasTextures)
+		{
+			TextureAtlasBuilder->AddTexture(AtlasTexture.first, AtlasBasePath + AtlasTexture.second);
+		}
+
+		if (TextureAtlasBuilder->Pack())
+		{
+			auto DerivedDataCache = this->DerivedDataCache.get();
+			auto AtlasBuilder = TextureAtlasBuilder;
+			GameResources->LoadGeneratedTextureAsync(
+				[DerivedDataCache, AtlasBuilder, AtlasSettings, AtlasBasePath, AtlasTextures]()
+			{
+				auto AtlasKey = FDerivedDataKey("TextureAtlas").Add(AtlasSettings.MaxSize).Add(AtlasSettings.NumMips);
+				for (const auto& AtlasTexture : AtlasTextures)
+				{
+					AtlasKey.Add(AtlasTexture.first).AddFile(AtlasBasePath + AtlasTexture.second);
+				}
+
+				return DerivedDataCache->GetData(AtlasKey, [&AtlasBuilder]()
+				{
+					return AtlasBuilder->Build();
+				});
+			}, "atlas");
+
+			DBOUT("Texture atlas", TextureAtlasBuilder->GetWidth() << "x" << TextureAtlasBuilder->GetHeight() <<
+				", occupancy " << TextureAtlasBuilder->GetOccupancy());
+		}
+		else
+		{
+			TextureAtlasBuilder.reset();
+		}
+
+		// Only tail mips are loaded. More detailed ones are streamed when they're needed
+		const auto TailMipSize = TextureStreamer->GetSettings().TailMipSize;
+		const auto Texture2D = D3D12_SRV_DIMENSION_TEXTURE2D;
+
+		// Textures which can't be packed are loaded alone
+		for (const auto& AtlasTexture : AtlasTextures)
+		{
+			const auto bLoaded = GameResources->HasTexture(AtlasTexture.first);
+			const auto bPacked = TextureAtlasBuilder != nullptr && TextureAtlasBuilder->HasEntry(AtlasTexture.first);
+			if (!bLoaded && !bPacked)
+			{
+				const std::wstring FileName(AtlasTexture.second.cbegin(), AtlasTexture.second.cend());
+				GameResources->LoadTextureAsync(BasePath + FileName, AtlasTexture.first, Texture2D, TailMipSize);
+			}
+		}
+
+		GameResources->LoadTextureAsync(BasePath + L"water1.dds", "water", Texture2D, TailMipSize);
+		GameResources->LoadTextureAsync(BasePath + L"grass.dds", "grass", Texture2D, TailMipSize);
+		// ice.dds has no mips, so they're built once and cached. Blocks of the most detailed mip are kept
+		const std::string GlassFilePath = "Assets\\Textures\\ice.dds";
+		auto DerivedDataCache = this->DerivedDataCache.get();
+		GameResources->LoadGeneratedTextureAsync([DerivedDataCache, GlassFilePath]()
+		{
+			const FTextureBuildSettings BuildSettings;
+			const auto MipsKey = FDerivedDataKey("TextureMips").Add(BuildSettings.Format).Add(BuildSettings.MipFilter).
+				Add(BuildSettings.bGammaCorrect).Add(BuildSettings.NumMips).AddFile(GlassFilePath);
+
+			return DerivedDataCache->GetData(MipsKey, [&GlassFilePath, &BuildSettings]()
+			{
+				DX::FMappedFile SourceFile(GlassFilePath);
+
+				FTextureBuildStats BuildStats;
+				auto Data = FTextureBuilder::Build(SourceFile.GetData(), SourceFile.GetSize(), BuildSettings, &BuildStats);
+
+				DBOUT("Texture mips of " << GlassFilePath, BuildStats.NumMips << " mips in " << BuildStats.MipsSeconds <<
+					" s, encoded " << BuildStats.Compression.GetMPixelsPerSecond() << " MPix/s, PSNR " <<
+					BuildStats.Compression.GetPSNR() << " dB");
+				return Data;
+			});
+		}, "glass");
+		GameResources->LoadTextureAsync(BasePath + L"treeArray2.dds", "tree", 
+										D3D12_SRV_DIMENSION_TEXTURE2DARRAY, TailMipSize);
 	}
 
 
@@ -250,7 +442,7 @@ namespace WoodenEngine
 		GrassMaterial->iConstBuffer = iConstBuffer;
 		GrassMaterial->FresnelR0 = { 0.01f, 0.01f, 0.01f };
 		GrassMaterial->Roughness = 0.800f;
-		GrassMaterial->DiffuseTexture = GameResources->GetTextureData("grass");
+		GrassMaterial->DiffuseTexture = GameResources->GetTextureHandle("grass");
 		GameResources->AddMaterial(std::move(GrassMaterial));
 		++iConstBuffer;
 
@@ -259,8 +451,8 @@ namespace WoodenEngine
 		WaterMaterial->FresnelR0 = { 0.1f, 0.1f, 0.1f };
 		WaterMaterial->Roughness = 0.0f;
 		WaterMaterial->DiffuseAlbedo = { 1.0f, 1.0f, 1.0f, 0.4f };
-		WaterMaterial->DiffuseTexture = GameResources->GetTextureData("water");
-		GameResources->AddMaterial(std::move(WaterMaterial));
+		WaterMaterial->DiffuseTexture = GameResources->GetTextureHandle("water");
+		WaterMaterialHandle = GameResources->AddMaterial(std::move(WaterMaterial));
 		++iConstBuffer;
 
 		auto DinoMaterial1 = std::make_unique<FMaterialData>("dino1");
@@ -268,7 +460,7 @@ namespace WoodenEngine
 		DinoMaterial1->iConstBuffer = iConstBuffer;
 		DinoMaterial1->FresnelR0 = { 0.1f, 0.1f, 0.1f };
 		DinoMaterial1->Roughness = 0.95f;
-		DinoMaterial1->DiffuseTexture = GameResources->GetTextureData("white1x1");
+		SetDiffuseTexture(DinoMaterial1.get(), "white1x1");
 		GameResources->AddMaterial(std::move(DinoMaterial1));
 		++iConstBuffer;
 
@@ -277,7 +469,7 @@ namespace WoodenEngine
 		DinoMaterial2->DiffuseAlbedo = { 0.8f, 0.8f, 0.8f, 1.0f };
 		DinoMaterial2->FresnelR0 = { 0.1f, 0.1f, 0.1f };
 		DinoMaterial2->Roughness = 0.01f;
-		DinoMaterial2->DiffuseTexture = GameResources->GetTextureData("white1x1");
+		SetDiffuseTexture(DinoMaterial2.get(), "white1x1");
 		GameResources->AddMaterial(std::move(DinoMaterial2));
 		++iConstBuffer;
 
@@ -286,7 +478,7 @@ namespace WoodenEngine
 		DinoMaterial3->DiffuseAlbedo = { 0.8f, 0.8f, 0.8f, 1.0f };
 		DinoMaterial3->FresnelR0 = { 0.9f, 0.9f, 0.9f };
 		DinoMaterial3->Roughness = 0.01f;
-		DinoMaterial3->DiffuseTexture = GameResources->GetTextureData("white1x1");
+		SetDiffuseTexture(DinoMaterial3.get(), "white1x1");
 		GameResources->AddMaterial(std::move(DinoMaterial3));
 		++iConstBuffer;
 
@@ -294,7 +486,7 @@ namespace WoodenEngine
 		CrateMaterial->iConstBuffer = iConstBuffer;
 		CrateMaterial->FresnelR0 = { 0.05f, 0.05f, 0.05f };
 		CrateMaterial->Roughness = 0.85f;
-		CrateMaterial->DiffuseTexture = GameResources->GetTextureData("crate");
+		SetDiffuseTexture(CrateMaterial.get(), "crate");
 		GameResources->AddMaterial(std::move(CrateMaterial));
 		++iConstBuffer;
 
@@ -302,7 +494,7 @@ namespace WoodenEngine
 		WireFenceMaterial->iConstBuffer = iConstBuffer;
 		WireFenceMaterial->FresnelR0 = { 0.05f, 0.05f, 0.05f };
 		WireFenceMaterial->Roughness = 0.85f;
-		WireFenceMaterial->DiffuseTexture = GameResources->GetTextureData("wirefence");
+		SetDiffuseTexture(WireFenceMaterial.get(), "wirefence");
 		GameResources->AddMaterial(std::move(WireFenceMaterial));
 		++iConstBuffer;
 
@@ -311,7 +503,7 @@ namespace WoodenEngine
 		GlassMaterial->FresnelR0 = { 0.1f, 0.1f, 0.1f };
 		GlassMaterial->Roughness = 0.7f;
 		GlassMaterial->DiffuseAlbedo = { 1.0f, 1.0f, 1.0f, 0.4f };
-		GlassMaterial->DiffuseTexture = GameResources->GetTextureData("glass");
+		GlassMaterial->DiffuseTexture = GameResources->GetTextureHandle("glass");
 		GameResources->AddMaterial(std::move(GlassMaterial));
 		++iConstBuffer;
 
@@ -320,7 +512,7 @@ namespace WoodenEngine
 		ShadowMaterial->FresnelR0 = { 0.001f, 0.001f, 0.001f};
 		ShadowMaterial->DiffuseAlbedo = { 0.0f, 0.0f, 0.0f, 0.3f };
 		ShadowMaterial->Roughness = 1.0f;
-		ShadowMaterial->DiffuseTexture = GameResources->GetTextureData("white1x1");
+		SetDiffuseTexture(ShadowMaterial.get(), "white1x1");
 		GameResources->AddMaterial(std::move(ShadowMaterial));
 		++iConstBuffer;
 
@@ -329,7 +521,7 @@ namespace WoodenEngine
 		RedMaterial->FresnelR0 = { 1.00f, 1.00f, 1.00f };
 		RedMaterial->DiffuseAlbedo = { 1.0f, 0.0f, 0.0f, 1.0f };
 		RedMaterial->Roughness =0.0f;
-		RedMaterial->DiffuseTexture = GameResources->GetTextureData("white1x1");
+		SetDiffuseTexture(RedMaterial.get(), "white1x1");
 		GameResources->AddMaterial(std::move(RedMaterial));
 		++iConstBuffer;
 
@@ -338,7 +530,7 @@ namespace WoodenEngine
 		GreenMaterial->FresnelR0 = { 1.00f, 1.00f, 1.00f };
 		GreenMaterial->DiffuseAlbedo = { 0.0f, 1.0f, 1.0f, 1.0f };
 		GreenMaterial->Roughness = 0.0f;
-		GreenMaterial->DiffuseTexture = GameResources->GetTextureData("white1x1");
+		SetDiffuseTexture(GreenMaterial.get(), "white1x1");
 		GameResources->AddMaterial(std::move(GreenMaterial));
 		++iConstBuffer;
 
@@ -346,11 +538,25 @@ namespace WoodenEngine
 		TreesMaterial->iConstBuffer = iConstBuffer;
 		TreesMaterial->FresnelR0 = { 0.05f, 0.05f, 0.05f };
 		TreesMaterial->Roughness = 0.8f;
-		TreesMaterial->DiffuseTexture = GameResources->GetTextureData("tree");
+		TreesMaterial->DiffuseTexture = GameResources->GetTextureHandle("tree");
 		GameResources->AddMaterial(std::move(TreesMaterial));
 		++iConstBuffer;
 	}
 
+	void FGameMain::SetDiffuseTexture(FMaterialData* Material, const std::string& TextureName)
+	{
+		if (TextureAtlasBuilder == nullptr || !TextureAtlasBuilder->HasEntry(TextureName))
+		{
+			Material->DiffuseTexture = GameResources->GetTextureHandle(TextureName);
+			return;
+		}
+
+		// Texture coordinates are transformed by the material after the object
+		const auto UVTransform = TextureAtlasBuilder->GetEntry(TextureName).GetUVTransform();
+		XMStoreFloat4x4(&Material->Transform, XMMatrixMultiply(XMLoadFloat4x4(&Material->Transform), UVTransform));
+		Material->DiffuseTexture = GameResources->GetTextureHandle("atlas");
+	}
+
 	void FGameMain::AddObjects()
 	{
 		// Build and load static meshes
@@ -362,22 +568,36 @@ namespace WoodenEngine
 
 		auto SphereMesh = MeshGenerator->CreateSphere(1.0f, 15.0f, 15.0f);
 
-		auto LandscapeMesh = MeshGenerator->CreateLandscapeGrid(40.0f, 40.0f, 80, 80);
-		LandscapeMesh->Name = "landscape";
-
-		auto MirrorMesh = MeshGenerator->CreateBox(6.0f, 6.0f, 0.5f, 4);
-		MirrorMesh->Name = "Mirror";
+		// Heavy generated meshes are taken from the derived data cache. Keys hash generators' parameters
+		auto LandscapeMesh = DerivedDataCache->GetMesh(
+			FDerivedDataKey("CreateLandscapeGrid").Add(40.0f).Add(40.0f).Add(80).Add(80),
+			[&MeshGenerator]()
+		{
+			auto LandscapeMesh = MeshGenerator->CreateLandscapeGrid(40.0f, 40.0f, 80, 80);
+			LandscapeMesh->Name = "landscape";
+			return LandscapeMesh;
+		});
+
+		auto MirrorMesh = DerivedDataCache->GetMesh(
+			FDerivedDataKey("CreateBox").Add(6.0f).Add(6.0f).Add(0.5f).Add(4),
+			[&MeshGenerator]()
+		{
+			auto MirrorMesh = MeshGenerator->CreateBox(6.0f, 6.0f, 0.5f, 4);
+			MirrorMesh->Name = "Mirror";
+			return MirrorMesh;
+		});
 
 		auto GeosphereMesh = MeshGenerator->CreateGeoSphere(1.0f, 0);
 
-		auto PlaneMesh = MeshGenerator->CreateGrid(23.0f, 23.0f, 30, 30);
+		auto PlaneMesh = DerivedDataCache->GetMesh(
+			FDerivedDataKey("CreateGrid").Add(23.0f).Add(23.0f).Add(30).Add(30),
+			[&MeshGenerator]()
+		{
+			return MeshGenerator->CreateGrid(23.0f, 23.0f, 30, 30);
+		});
 
 		auto BezierGridMesh = MeshGenerator->CreateBezierGrid();
 
-		auto MeshParser = std::make_unique<FMeshParser>();
-
-		auto DinoMesh = MeshParser->ParseObjFile("Assets\\Models\\robot.obj");
-		DinoMesh->Name = "dino";
 
 		const auto QuadSubmeshName = QuadMesh->Name;
 		const auto BoxSubmeshName = BoxMesh->Name;
@@ -387,7 +607,7 @@ namespace WoodenEngine
 		const auto PlaneSubmeshName = PlaneMesh->Name;
 		const auto LandscapeSubmeshName = LandscapeMesh->Name;
 		const auto MirrorSubmeshName = MirrorMesh->Name;
-		const auto dinoSubmeshName = DinoMesh->Name;
+		const auto dinoSubmeshName = std::string("dino");
 		const auto GeosphereSubmeshName = GeosphereMesh->Name;
 
 		const std::string& GeoMeshName = "geo";
@@ -406,80 +626,137 @@ namespace WoodenEngine
 		EnviromentSubmeshes.push_back(std::move(MirrorMesh));
 		GameResources->LoadStaticMesh(std::move(EnviromentSubmeshes), EnviromentMeshName, CMDList);
 
+		// Dino and skull are loaded from baked mesh files. The files are converted from their sources
+		// by loading workers on misses of the derived data cache and are drawn since their upload
 		const std::string& DinoMeshName = "dino";
-		std::vector<std::unique_ptr<FMeshRawData>> DinoSubmeshes;
-		DinoSubmeshes.push_back(std::move(DinoMesh));
-		GameResources->LoadStaticMesh(std::move(DinoSubmeshes), DinoMeshName, CMDList);
+		auto DerivedDataCache = this->DerivedDataCache.get();
+		GameResources->LoadStaticMeshFileAsync([DerivedDataCache, dinoSubmeshName]()
+		{
+			const std::string DinoFilePath = "Assets\\Models\\robot.obj";
+			const std::vector<float> DinoLODsRatios = { 0.5f, 0.25f, 0.1f };
+
+			FMeshBakeSettings BakeSettings;
+			BakeSettings.VertexFormat = EVertexFormat::Quantized;
+
+			// Import, simplification and baking are skipped while the source and settings are the same
+			auto DinoKey = FDerivedDataKey("ParseObjFile+Weld+GenerateLODs+Bake").AddFile(DinoFilePath);
+			DinoKey.Add(dinoSubmeshName).Add(MeshFileVersion).Add(BakeSettings.VertexFormat);
+			DinoKey.Add(DinoLODsRatios.data(), DinoLODsRatios.size()*sizeof(float));
+
+			return DerivedDataCache->GetFile(DinoKey, ".wmesh", 
+				[&DinoFilePath, &DinoLODsRatios, &dinoSubmeshName, &BakeSettings](const std::string& FilePath)
+			{
+				FMeshParser MeshParser;
+				auto DinoMesh = MeshParser.ParseObjFile(DinoFilePath);
+				DinoMesh->Name = dinoSubmeshName;
+
+				// OBJ corners are separate vertices, so they're welded for collapses to share them
+				FMeshWelder MeshWelder;
+				MeshWelder.Weld(DinoMesh.get());
+
+				FMeshSimplifier MeshSimplifier;
+				auto DinoLODs = MeshSimplifier.GenerateLODs(*DinoMesh, DinoLODsRatios);
+
+				std::vector<std::unique_ptr<FMeshRawData>> DinoSubmeshes;
+				DinoSubmeshes.push_back(std::move(DinoMesh));
+				for (auto& DinoLOD : DinoLODs)
+				{
+					DinoSubmeshes.push_back(std::move(DinoLOD));
+				}
+
+				FMeshFile::Convert(std::move(DinoSubmeshes), FilePath, BakeSettings);
+			});
+		}, DinoMeshName);
+
+		// Submesh of a converted .txt file is named as the file
+		const std::string& SkullMeshName = "skull";
+		GameResources->LoadStaticMeshFileAsync([DerivedDataCache]()
+		{
+			const std::string SkullFilePath = "Assets\\Models\\skull.txt";
+
+			auto SkullKey = FDerivedDataKey("FMeshFile::Convert").AddFile(SkullFilePath).Add(MeshFileVersion);
+			return DerivedDataCache->GetFile(SkullKey, ".wmesh", [&SkullFilePath](const std::string& FilePath)
+			{
+				FMeshFile::Convert(SkullFilePath, FilePath);
+			});
+		}, SkullMeshName);
 
 		uint8 iConstBuffer = 0;
 
 		/*
-		auto LandscapeObject = std::make_unique<WObject>(EnviromentMeshName, LandscapeSubmeshName);
+		auto LandscapeObject = std::make_unique<WObject>(
+			GameResources->GetSubmeshHandle(EnviromentMeshName, LandscapeSubmeshName));
 		XMFLOAT4X4 LandscapeTextureTransform;
 		XMStoreFloat4x4(&LandscapeTextureTransform, XMMatrixScaling(6.0f, 6.0f, 1.0f));
 		LandscapeObject->SetTextureTransform(std::move(LandscapeTextureTransform));
 		LandscapeObject->SetPosition(0, -2, 0);
 		LandscapeObject->SetWaterFactor(0);
-		LandscapeObject->SetMaterial(GameResources->GetMaterialData("grass"));
+		LandscapeObject->SetMaterial(GameResources->GetMaterialHandle("grass"));
 		
 		AddObjectToScene(ERenderLayer::Opaque, LandscapeObject.get());
 		Objects.push_back(std::move(LandscapeObject));
 		*/
 
 
-		auto LandscapeObject = std::make_unique<WObject>(GeoMeshName, QuadSubmeshName);
+		auto LandscapeObject = std::make_unique<WObject>(
+			GameResources->GetSubmeshHandle(GeoMeshName, QuadSubmeshName));
 		XMFLOAT4X4 LandscapeTextureTransform;
 		XMStoreFloat4x4(&LandscapeTextureTransform, XMMatrixScaling(6.0f, 6.0f, 1.0f));
 		LandscapeObject->SetTextureTransform(std::move(LandscapeTextureTransform));
 		LandscapeObject->SetPosition(0, -2, 0);
 		LandscapeObject->SetWaterFactor(0);
-		LandscapeObject->SetMaterial(GameResources->GetMaterialData("grass"));
+		LandscapeObject->SetMaterial(GameResources->GetMaterialHandle("grass"));
 		LandscapeObject->SetRenderPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_4_CONTROL_POINT_PATCHLIST);
 
 		AddObjectToScene(ERenderLayer::Landscape, LandscapeObject.get());
 		Objects.push_back(std::move(LandscapeObject));
 
-		auto BezierObject = std::make_unique<WObject>(GeoMeshName, BezierGridSubmeshName);
+		auto BezierObject = std::make_unique<WObject>(
+			GameResources->GetSubmeshHandle(GeoMeshName, BezierGridSubmeshName));
 		XMStoreFloat4x4(&LandscapeTextureTransform, XMMatrixScaling(6.0f, 6.0f, 1.0f));
 		BezierObject->SetPosition(25.0f, 5.0f, 0.0f);
 		BezierObject->SetWaterFactor(0);
-		BezierObject->SetMaterial(GameResources->GetMaterialData("grass"));
+		BezierObject->SetMaterial(GameResources->GetMaterialHandle("grass"));
 		BezierObject->SetRenderPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_16_CONTROL_POINT_PATCHLIST);
 		AddObjectToScene(ERenderLayer::Bezier, BezierObject.get());
 		Objects.push_back(std::move(BezierObject));
 
-		auto WaterObject = std::make_unique<WObject>(EnviromentMeshName, PlaneSubmeshName);
+		auto WaterObject = std::make_unique<WObject>(
+			GameResources->GetSubmeshHandle(EnviromentMeshName, PlaneSubmeshName));
 		XMFLOAT4X4 TextureTransform;
 		XMStoreFloat4x4(&TextureTransform, XMMatrixScaling(5.0f, 5.0f, 1.0f));
 		WaterObject->SetTextureTransform(std::move(TextureTransform));
 		WaterObject->SetPosition(0, 0, 0);
-		WaterObject->SetMaterial(GameResources->GetMaterialData("water"));
+		WaterObject->SetMaterial(WaterMaterialHandle);
 
 		AddObjectToScene(ERenderLayer::Transparent, WaterObject.get());
 		Objects.push_back(std::move(WaterObject));
 
 		// Create objects
-		auto BoxObject = std::make_unique<WObject>(GeoMeshName, BoxSubmeshName);
+		auto BoxObject = std::make_unique<WObject>(
+			GameResources->GetSubmeshHandle(GeoMeshName, BoxSubmeshName));
 		BoxObject->SetPosition(1.5f, 0.2f, 0.0f);
 		BoxObject->SetWaterFactor(1.0);
-		BoxObject->SetMaterial(GameResources->GetMaterialData("wirefence"));
+		BoxObject->SetMaterial(GameResources->GetMaterialHandle("wirefence"));
 
 		AddObjectToScene(ERenderLayer::AlphaTested, BoxObject.get());
 		Objects.push_back(std::move(BoxObject));
 
-		auto SphereObject = std::make_unique<WObject>(GeoMeshName, SphereSubmeshName);
+		auto SphereObject = std::make_unique<WObject>(
+			GameResources->GetSubmeshHandle(GeoMeshName, SphereSubmeshName));
 		SphereObject->SetPosition(-2.5f, -0.2f, 2.0f);
 		SphereObject->SetWaterFactor(-1.0);
-		SphereObject->SetMaterial(GameResources->GetMaterialData("crate"));
+		SphereObject->SetMaterial(GameResources->GetMaterialHandle("crate"));
 
 		AddObjectToScene(ERenderLayer::Opaque, SphereObject.get());
 		Objects.push_back(std::move(SphereObject));
 	
-		auto PlatformObject = std::make_unique<WObject>(GeoMeshName, BoxSubmeshName);
+		auto PlatformObject = std::make_unique<WObject>(
+			GameResources->GetSubmeshHandle(GeoMeshName, BoxSubmeshName));
 		PlatformObject->SetPosition(-20.0f, 3.5f, 0.0f);
 		PlatformObject->SetScale(25.0f, 1.0f, 30.0f);
 		PlatformObject->SetWaterFactor(0);
-		PlatformObject->SetMaterial(GameResources->GetMaterialData("grass"));
+		PlatformObject->SetMaterial(GameResources->GetMaterialHandle("grass"));
 
 		auto ShadowPlaneNormal = XMVectorSet(0.0f, 1.0f, 0.0f, 1.0f);
 		auto ShadowPlaneDisplacement = XMVectorGetX(
@@ -489,10 +766,11 @@ namespace WoodenEngine
 		AddObjectToScene(ERenderLayer::Opaque, PlatformObject.get());
 		Objects.push_back(std::move(PlatformObject));
 
-		auto MirrorObject = std::make_unique<WObject>(EnviromentMeshName, MirrorSubmeshName);
+		auto MirrorObject = std::make_unique<WObject>(
+			GameResources->GetSubmeshHandle(EnviromentMeshName, MirrorSubmeshName));
 		MirrorObject->SetPosition(-20.0f, 6.0f, 0.0f);
 		MirrorObject->SetWaterFactor(0);
-		MirrorObject->SetMaterial(GameResources->GetMaterialData("glass"));
+		MirrorObject->SetMaterial(GameResources->GetMaterialHandle("glass"));
 
 		auto MirrorPlaneDirection = XMVectorSet(-0.0f, -0.0f, -1.0f, 1.0f);
 		auto MirrorDisplacement = XMVectorGetX(
@@ -502,12 +780,13 @@ namespace WoodenEngine
 		AddObjectToScene(ERenderLayer::Mirrors, MirrorObject.get());
 		Objects.push_back(std::move(MirrorObject));
 
-		auto DinoObject = std::make_unique<WObject>(DinoMeshName, dinoSubmeshName);
+		auto DinoObject = std::make_unique<WObject>(
+			GameResources->GetSubmeshHandle(DinoMeshName, dinoSubmeshName));
 		DinoObject->SetPosition(-20.0f, 4.0f, 10.0f);
 		DinoObject->SetRotation(0, XM_PI, 0);
 		DinoObject->SetScale(0.5f, 0.5f, 0.5f);
 		DinoObject->SetWaterFactor(0);
-		DinoObject->SetMaterial(GameResources->GetMaterialData("dino1"));
+		DinoObject->SetMaterial(GameResources->GetMaterialHandle("dino1"));
 
 		auto DinoReflectedObject = std::make_unique<WObject>(*DinoObject);
 
@@ -516,7 +795,17 @@ namespace WoodenEngine
 		DinoReflectedObject->SetWorldTransform(DinoWorldTransform*ReflectTransform);
 
 		auto DinoShadowObject = std::make_unique<WObject>(*DinoObject);
-		DinoShadowObject->SetMaterial(GameResources->GetMaterialData("shadow"));
+		DinoShadowObject->SetMaterial(GameResources->GetMaterialHandle("shadow"));
+
+		auto SkullObject = std::make_unique<WObject>(
+			GameResources->GetSubmeshHandle(SkullMeshName, "skull"));
+		SkullObject->SetPosition(-20.0f, 4.5f, -8.0f);
+		SkullObject->SetScale(0.4f, 0.4f, 0.4f);
+		SkullObject->SetWaterFactor(0);
+		SkullObject->SetMaterial(GameResources->GetMaterialHandle("crate"));
+
+		AddObjectToScene(ERenderLayer::Opaque, SkullObject.get());
+		Objects.push_back(std::move(SkullObject));
 
 		this->DinoObject = DinoObject.get();
 		this->DinoShadowObject = DinoShadowObject.get();
@@ -548,18 +837,52 @@ namespace WoodenEngine
 
 		GameResources->LoadBillboards(BillboardVerticesData, "Billboards", "Trees", CMDList);
 
-		auto BillboardsObject = std::make_unique<WObject>("Billboards", "Trees");
+		auto BillboardsObject = std::make_unique<WObject>(
+			GameResources->GetSubmeshHandle("Billboards", "Trees"));
 		BillboardsObject->SetRenderPrimitiveTopology(D3D10_PRIMITIVE_TOPOLOGY_POINTLIST);
-		BillboardsObject->SetMaterial(GameResources->GetMaterialData("tree"));
+		BillboardsObject->SetMaterial(GameResources->GetMaterialHandle("tree"));
 		AddObjectToScene(ERenderLayer::Billboard, BillboardsObject.get());
 		Objects.push_back(std::move(BillboardsObject));
 
-		auto GeosphereObject = std::make_unique<WObject>("geo", "Geosphere");
-		GeosphereObject->SetMaterial(GameResources->GetMaterialData("green"));
+		auto GeosphereObject = std::make_unique<WObject>(
+			GameResources->GetSubmeshHandle("geo", "Geosphere"));
+		GeosphereObject->SetMaterial(GameResources->GetMaterialHandle("green"));
 		GeosphereObject->SetPosition(0.0f, 10.0f, 0.0f);
 		GeosphereObject->SetScale(2.0f, 2.0f, 2.0f);
 		AddObjectToScene(ERenderLayer::Geosphere, GeosphereObject.get());
 		Objects.push_back(std::move(GeosphereObject));
+
+		// Terrain around the scene. Its tiles are generated by workers and uploaded by UpdateTerrain.
+		// Nodes are split closer than by default, so any selection fits the budget (up to 124 tiles of 82 KB)
+		FTerrainSettings TerrainSettings;
+		TerrainSettings.WorldSize = 1024.0f;
+		TerrainSettings.MaxDepth = 6;
+		TerrainSettings.LODDistanceFactor = 1.0f;
+		TerrainSettings.MemoryBudget = 16 * 1024 * 1024;
+		TerrainSettings.MaxNumPendingTiles = 8;
+		Terrain = std::make_unique<FTerrain>(TerrainSettings, [](float X, float Z)
+		{
+			return 4.0f*sinf(X*0.05f)*cosf(Z*0.05f) - 10.0f;
+		});
+
+		XMFLOAT4X4 TerrainTextureTransform;
+		XMStoreFloat4x4(&TerrainTextureTransform, XMMatrixScaling(128.0f, 128.0f, 1.0f));
+
+		// Selection is drawn only if every tile has an object
+		const auto NumTerrainTilesObjects = FTerrain::GetMaxNumSelectedTiles(TerrainSettings);
+		for (uint32 iTileObject = 0; iTileObject < NumTerrainTilesObjects; ++iTileObject)
+		{
+			// Tiles are in world space. Objects get their meshes when tiles are uploaded
+			auto TileObject = std::make_unique<WObject>(FSubmeshHandle());
+			TileObject->SetTextureTransform(TerrainTextureTransform);
+			TileObject->SetWaterFactor(0);
+			TileObject->SetMaterial(GameResources->GetMaterialHandle("grass"));
+			TileObject->SetIsVisible(false);
+
+			TerrainTilesObjects.push_back(TileObject.get());
+			AddObjectToScene(ERenderLayer::Opaque, TileObject.get());
+			Objects.push_back(std::move(TileObject));
+		}
 	}
 
 	void FGameMain::AddLights()
@@ -595,8 +918,8 @@ namespace WoodenEngine
 		);
 
 		DinoLight->SetIsRenderable(true);
-		DinoLight->SetMesh("geo", "sphere");
-		DinoLight->SetMaterial(GameResources->GetMaterialData("red"));
+		DinoLight->SetMesh(GameResources->GetSubmeshHandle("geo", "sphere"));
+		DinoLight->SetMaterial(GameResources->GetMaterialHandle("red"));
 		DinoLight->SetScale(0.2f, 0.2f, 0.2f);
 
 		CastShadowLight = DinoLight.get();
@@ -610,8 +933,8 @@ namespace WoodenEngine
 			XMFLOAT3(5.0f, 10.0f, 5.0f), 50.0f, 100.0f, 200.0f);
 
 		SpotLight->SetIsRenderable(true);
-		SpotLight->SetMesh("geo", "sphere");
-		SpotLight->SetMaterial(GameResources->GetMaterialData("green"));
+		SpotLight->SetMesh(GameResources->GetSubmeshHandle("geo", "sphere"));
+		SpotLight->SetMaterial(GameResources->GetMaterialHandle("green"));
 		SpotLight->SetScale(0.4f, 0.4f, 0.4f);
 		AddObjectToScene(ERenderLayer::Opaque, SpotLight.get());
 		LightsSpot.push_back(SpotLight.get());
@@ -639,7 +962,7 @@ namespace WoodenEngine
 		D3D12_DESCRIPTOR_HEAP_DESC srvDescriptorHeapDesc = {};
 		srvDescriptorHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
 		srvDescriptorHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-		srvDescriptorHeapDesc.NumDescriptors = GameResources->GetNumTexturesData()+5;
+		srvDescriptorHeapDesc.NumDescriptors = GameResources->GetNumTexturesData()*2+5;
 		DX::ThrowIfFailed(Device->CreateDescriptorHeap(&srvDescriptorHeapDesc, IID_PPV_ARGS(&SRVDescriptorHeap)));
 	}
 
@@ -757,7 +1080,13 @@ namespace WoodenEngine
 			NULL, NULL
 		};
 
+		const D3D_SHADER_MACRO PackedVertexShaderDefines[] = {
+			"PACKED_VERTEX", "1",
+			NULL, NULL
+		};
+
 		Shaders["standartVS"] = DX::CompileShader(L"Shaders\\Shader.hlsl", nullptr, "VS", "vs_5_0");
+		Shaders["packedVS"] = DX::CompileShader(L"Shaders\\Shader.hlsl", PackedVertexShaderDefines, "VS", "vs_5_0");
 		Shaders["opaquePS"] = DX::CompileShader(L"Shaders\\Shader.hlsl", OpaqueShaderDefines, "PS", "ps_5_0");
 		Shaders["alphatestPS"] = DX::CompileShader(L"Shaders\\Shader.hlsl", AlphaTestShaderDefines, "PS", "ps_5_0");
 		Shaders["shadowPS"] = DX::CompileShader(L"Shaders\\Shader.hlsl", ShadowShaderDefines, "PS", "ps_5_0");
@@ -873,16 +1202,22 @@ namespace WoodenEngine
 		diffuseTexturesDataParameter.InitAsDescriptorTable(
 			1, &DiffuseTexturesRange, D3D12_SHADER_VISIBILITY_PIXEL);
 
+		// decoding constants of packed vertices (SVertexQuantizationData)
+		CD3DX12_ROOT_PARAMETER VertexQuantizationParameter;
+		VertexQuantizationParameter.InitAsConstants(
+			sizeof(SVertexQuantizationData) / sizeof(uint32), 3, 0, D3D12_SHADER_VISIBILITY_VERTEX);
+
 		auto Parameters = { 
 			ObjectDataParameter,
 			MaterialDataParameter, 
 			FrameDataParameter,
-			diffuseTexturesDataParameter };
+			diffuseTexturesDataParameter,
+			VertexQuantizationParameter };
 
 		// Initialize root signature
 		CD3DX12_ROOT_SIGNATURE_DESC RootSignatureDesc;
 		RootSignatureDesc.Init(
-			4, Parameters.begin(), 6, GetStaticSamplers().data(), 
+			Parameters.size(), Parameters.begin(), 6, GetStaticSamplers().data(), 
 			D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT);
 
 		ComPtr<ID3DBlob> rootSignatureBlob = nullptr;
@@ -1127,6 +1462,50 @@ namespace WoodenEngine
 			IID_PPV_ARGS(&PipelineStates["shadow"])
 		));
 
+		// Create variants of static meshes' pipeline state objects for packed vertices.
+		// Both packed formats are decoded by the same vertex shader
+		const D3D12_INPUT_ELEMENT_DESC PackedInputElements[] =
+		{
+			{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+			{ "NORMAL", 0, DXGI_FORMAT_R10G10B10A2_UNORM, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+			{ "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 16, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+		};
+
+		const D3D12_INPUT_ELEMENT_DESC QuantizedInputElements[] =
+		{
+			{ "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+			{ "NORMAL", 0, DXGI_FORMAT_R10G10B10A2_UNORM, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+			{ "TEXCOORD", 0, DXGI_FORMAT_R16G16_UNORM, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+		};
+
+		const std::pair<std::string, D3D12_GRAPHICS_PIPELINE_STATE_DESC> StaticMeshesPSODescs[] =
+		{
+			{ "opaque", OpaquePSODesc },
+			{ "transparent", TransparentPSODesc },
+			{ "alphatest", AlfaTestPSODesc },
+			{ "markmirrors", MarkMirrorsPSODesc },
+			{ "reflections", ReflectionsPSODesc },
+			{ "shadow", ShadowPSODesc }
+		};
+
+		for (const auto& StaticMeshesPSODesc : StaticMeshesPSODescs)
+		{
+			auto PackedPSODesc = StaticMeshesPSODesc.second;
+			PackedPSODesc.VS = { Shaders["packedVS"]->GetBufferPointer(), Shaders["packedVS"]->GetBufferSize() };
+
+			PackedPSODesc.InputLayout = { PackedInputElements, _countof(PackedInputElements) };
+			DX::ThrowIfFailed(Device->CreateGraphicsPipelineState(
+				&PackedPSODesc,
+				IID_PPV_ARGS(&PipelineStates[GetPipelineStateName(StaticMeshesPSODesc.first, EVertexFormat::Packed)])
+			));
+
+			PackedPSODesc.InputLayout = { QuantizedInputElements, _countof(QuantizedInputElements) };
+			DX::ThrowIfFailed(Device->CreateGraphicsPipelineState(
+				&PackedPSODesc,
+				IID_PPV_ARGS(&PipelineStates[GetPipelineStateName(StaticMeshesPSODesc.first, EVertexFormat::Quantized)])
+			));
+		}
+
 		auto BillboardPSODesc = AlfaTestPSODesc;
 		const D3D12_INPUT_ELEMENT_DESC BillboardPSOInput[2] =
 		{
@@ -1362,6 +1741,12 @@ namespace WoodenEngine
 
 		UpdateDemoLogic();
 
+		// World matrices of objects moved by this frame are computed at once
+		WObject::GetTransformStore().UpdateWorldTransforms();
+
+		UpdateTerrain();
+		UpdateTexturesStreaming();
+
 		GameTime += dtime;
 
 		// Shift frame to the next
@@ -1377,6 +1762,81 @@ namespace WoodenEngine
 		UpdateReflectedFrameConstBuffer();
 	}
 
+	void FGameMain::UpdateTerrain()
+	{
+		Terrain->Update(Camera->GetWorldPosition());
+
+		const auto& SelectedTiles = Terrain->GetSelectedTiles();
+
+		auto bSelectedTilesReady = SelectedTiles.size() <= TerrainTilesObjects.size();
+		for (const auto Tile : SelectedTiles)
+		{
+			auto& TileMesh = TerrainTilesMeshes[Tile->Key];
+
+			// Meshes which failed or were evicted before they were drawn are requested again
+			if (TileMesh.MeshName.empty() ||
+				(TileMesh.LoadTask.is_done() && !GameResources->IsMeshReady(TileMesh.MeshName)))
+			{
+				TileMesh.MeshName = "terrain_" + std::to_string(Tile->Key);
+
+				// The tile may be evicted by the terrain before the worker copies its mesh
+				auto TileMeshData = Tile->MeshData;
+				TileMesh.LoadTask = GameResources->LoadStaticMeshAsync([TileMeshData]()
+				{
+					std::vector<std::unique_ptr<FMeshRawData>> SubmeshesData;
+					SubmeshesData.push_back(std::make_unique<FMeshRawData>(*TileMeshData));
+					return SubmeshesData;
+				}, TileMesh.MeshName);
+				TileMesh.SubmeshHandle = GameResources->GetSubmeshHandle(TileMesh.MeshName, TileMeshData->Name);
+			}
+
+			bSelectedTilesReady = bSelectedTilesReady && GameResources->IsSubmeshReady(TileMesh.SubmeshHandle);
+		}
+
+		// Objects keep the previous selection until all tiles of the new one are uploaded, so there are no holes
+		if (bSelectedTilesReady)
+		{
+			DrawnTerrainTiles.clear();
+			for (std::size_t iTileObject = 0; iTileObject < TerrainTilesObjects.size(); ++iTileObject)
+			{
+				auto TileObject = TerrainTilesObjects[iTileObject];
+				if (iTileObject < SelectedTiles.size())
+				{
+					DrawnTerrainTiles.push_back(SelectedTiles[iTileObject]->Key);
+					TileObject->SetMesh(TerrainTilesMeshes[SelectedTiles[iTileObject]->Key].SubmeshHandle);
+				}
+
+				TileObject->SetIsVisible(iTileObject < SelectedTiles.size());
+			}
+		}
+
+		// Meshes of tiles which are neither selected nor drawn are removed.
+		// Frames in flight may draw them, so their buffers are retired until the next uploads' fence
+		for (auto TileMeshIter = TerrainTilesMeshes.begin(); TileMeshIter != TerrainTilesMeshes.end();)
+		{
+			const auto TileKey = TileMeshIter->first;
+			const auto& TileMesh = TileMeshIter->second;
+
+			const auto bUsed =
+				std::any_of(SelectedTiles.begin(), SelectedTiles.end(),
+					[TileKey](const FTerrainTile* Tile) { return Tile->Key == TileKey; }) ||
+				std::find(DrawnTerrainTiles.begin(), DrawnTerrainTiles.end(), TileKey) != DrawnTerrainTiles.end();
+
+			if (bUsed || !TileMesh.LoadTask.is_done())
+			{
+				++TileMeshIter;
+				continue;
+			}
+
+			if (GameResources->IsMeshReady(TileMesh.MeshName))
+			{
+				GameResources->RetireResources(GameResources->RemoveStaticMesh(TileMesh.MeshName));
+			}
+
+			TileMeshIter = TerrainTilesMeshes.erase(TileMeshIter);
+		}
+	}
+
 	void FGameMain::UpdateReflectionTransform()
 	{
 		auto ReflectTransform = XMMatrixReflect(MirrorPlane);
@@ -1397,7 +1857,11 @@ namespace WoodenEngine
 
 	void FGameMain::AnimateWaterMaterial()
 	{
-		auto WaterMaterial = GameResources->GetMaterialData("water");
+		auto WaterMaterial = GameResources->GetMaterialData(WaterMaterialHandle);
+		if (WaterMaterial == nullptr)
+		{
+			return;
+		}
 
 		auto& TexU = WaterMaterial->Transform(3, 0);
 		auto& TexV = WaterMaterial->Transform(3, 1);
@@ -1445,11 +1909,15 @@ namespace WoodenEngine
 		for(auto iObject=0; iObject < Objects.size(); ++iObject)
 		{
 			auto Object = Objects[iObject].get();
-			if (Object->IsRenderable() && Object->GetNumDirtyConstBuffers() > 0)
+			// Objects' data is updated since upload of their meshes. Objects of evicted meshes stay dirty until reloads
+			const auto SubmeshData = Object->IsRenderable() && Object->GetNumDirtyConstBuffers() > 0 ?
+				GameResources->GetSubmeshData(Object->GetSubmeshHandle()) : nullptr;
+			if (SubmeshData != nullptr)
 			{
 				SObjectData ObjectShaderData;
 
-				auto WorldMatrix = Object->GetWorldTransform();
+				// Submeshes of imported scenes keep transforms of their nodes
+				auto WorldMatrix = XMMatrixMultiply(XMLoadFloat4x4(&SubmeshData->Transform), Object->GetWorldTransform());
 				XMStoreFloat4x4(&ObjectShaderData.WorldMatrix, XMMatrixTranspose(WorldMatrix));
 				
 				auto TextureTransform = Object->GetTextureTransform();
@@ -1460,7 +1928,7 @@ namespace WoodenEngine
 				ObjectShaderData.Time = Object->GetLifeTime();
 				
 				// Crunch!!!!!!!!!!!!!!!!!!!!!!!!!!!
-				ObjectShaderData.IsWater = Object->GetMaterial()->Name == "water";
+				ObjectShaderData.IsWater = GetObjectMaterialHandle(*Object) == WaterMaterialHandle;
 				ObjectShaderData.WaterFactor = Object->GetWaterFactor();
 
 				ObjectsBuffer->CopyData(Object->GetConstBufferIndex(), ObjectShaderData);
@@ -1470,26 +1938,228 @@ namespace WoodenEngine
 		}
 	}
 
+	void FGameMain::SetLogicalDpi(float LogicalDpi) noexcept
+	{
+		this->LogicalDpi = LogicalDpi;
+	}
+
+	float FGameMain::GetProjectionScale() const
+	{
+		// Bounds of the window are in DIPs, but projected sizes are compared with pixels
+		const auto OutputHeight = DX::ConvertDipsToPixels(Window->Bounds.Height, LogicalDpi);
+		return OutputHeight / (2.0f*tanf(CameraFovY*0.5f));
+	}
+
+	void FGameMain::UpdateTexturesStreaming()
+	{
+		++iFrame;
+
+		const auto CameraWorldPosition = Camera->GetWorldPosition();
+		const auto CameraPosition = XMLoadFloat3(&CameraWorldPosition);
+		const auto ProjectionScale = GetProjectionScale();
+
+		for (const auto& Object : Objects)
+		{
+			// Textures of objects whose meshes are loading or evicted aren't streamed
+			const auto SubmeshData = Object->IsRenderable() && Object->IsVisible() ?
+				GameResources->GetSubmeshData(Object->GetSubmeshHandle()) : nullptr;
+			if (SubmeshData == nullptr)
+			{
+				continue;
+			}
+
+			const auto Material = GameResources->GetMaterialData(GetObjectMaterialHandle(*Object));
+			const auto DiffuseTexture = Material != nullptr ? GameResources->GetTextureData(Material->DiffuseTexture) : nullptr;
+			if (DiffuseTexture == nullptr)
+			{
+				continue;
+			}
+
+			const auto WorldTransform = XMMatrixMultiply(
+				XMLoadFloat4x4(&SubmeshData->Transform), Object->GetWorldTransform());
+
+			const auto BoundsMin = XMLoadFloat3(&SubmeshData->BoundsMin);
+			const auto BoundsMax = XMLoadFloat3(&SubmeshData->BoundsMax);
+			const auto Center = XMVector3TransformCoord(XMVectorScale(XMVectorAdd(BoundsMin, BoundsMax), 0.5f), WorldTransform);
+			const auto Extent = XMVectorGetX(XMVector3Length(
+				XMVector3TransformNormal(XMVectorSubtract(BoundsMax, BoundsMin), WorldTransform)));
+			const auto Distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(Center, CameraPosition)));
+
+			// The texture is assumed to be mapped across the submesh's bounds once per its tiling
+			const auto TextureTransform = XMLoadFloat4x4(&Object->GetTextureTransform());
+			const auto Tiling = std::max({
+				XMVectorGetX(XMVector3Length(TextureTransform.r[0])),
+				XMVectorGetX(XMVector3Length(TextureTransform.r[1])),
+				1.0f });
+
+			const auto ScreenSize = Extent*ProjectionScale / std::max(Distance, 0.001f);
+			TextureStreamer->UpdateTextureUsage(DiffuseTexture->Name, ScreenSize / Tiling, iFrame);
+		}
+
+		for (const auto& Request : TextureStreamer->Update(iFrame))
+		{
+			TexturesStreamingTasks[Request.TextureName] = 
+				GameResources->StreamTextureAsync(Request.TextureName, Request.MostDetailedMip);
+		}
+	}
+
+	void FGameMain::CompleteTexturesStreaming(const FUploadedResources& UploadedResources)
+	{
+		// Textures are streamed since upload of their tail mips. Generated ones don't have files to stream from
+		for (auto TextureHandle : UploadedResources.TexturesHandles)
+		{
+			const auto TextureData = GameResources->GetTextureData(TextureHandle);
+			if (!TextureData->FileName.empty() && !TextureStreamer->HasTexture(TextureData->Name))
+			{
+				TextureStreamer->AddTexture(TextureData->Name, TextureData->MipsSizes,
+					TextureData->Width, TextureData->MostDetailedMip);
+			}
+		}
+
+		auto bCompleted = false;
+		for (auto TaskIter = TexturesStreamingTasks.begin(); TaskIter != TexturesStreamingTasks.end(); )
+		{
+			if (!TaskIter->second.is_done())
+			{
+				++TaskIter;
+				continue;
+			}
+
+			TextureStreamer->CompleteRequest(TaskIter->first, TaskIter->second.get());
+			TaskIter = TexturesStreamingTasks.erase(TaskIter);
+			bCompleted = true;
+		}
+
+		if (bCompleted)
+		{
+			const auto StreamingStats = TextureStreamer->GetStats();
+			DBOUT("Texture streaming", (StreamingStats.ResidentBytes >> 10) << " KB of " << 
+				(StreamingStats.BudgetBytes >> 10) << " KB resident, " << StreamingStats.NumStreamedIn << 
+				" streamed in, " << StreamingStats.NumEvicted << " evicted");
+		}
+	}
+
+	void FGameMain::UpdateTexturesViews()
+	{
+		const auto CompletedFenceValue = Fence->GetCompletedValue();
+		auto& TexturesData = GameResources->GetTexturesData();
+
+		// A view is created in the back slot of the texture, so frames in flight keep reading the current one
+		auto PendingEnd = std::remove_if(PendingTexturesViews.begin(), PendingTexturesViews.end(),
+			[this, CompletedFenceValue, &TexturesData](FTextureHandle TextureHandle)
+		{
+			auto TextureData = TexturesData.Find(TextureHandle);
+			if (TextureData == nullptr)
+			{
+				return true;
+			}
+
+			// Slots swapped by the current frame get its fence value when it's submitted
+			if (TextureData->SRVFenceValue == UINT64_MAX || TextureData->SRVFenceValue > CompletedFenceValue)
+			{
+				return false;
+			}
+
+			std::swap(TextureData->iSRVHeap, TextureData->iBackSRVHeap);
+			TextureData->SRVFenceValue = UINT64_MAX;
+			InitTextureView(TextureData);
+
+			SwappedTexturesViews.push_back(TextureHandle);
+			return true;
+		});
+		PendingTexturesViews.erase(PendingEnd, PendingTexturesViews.end());
+
+		// Frames which read retired resources through old views are submitted before the current one
+		if (PendingTexturesViews.empty() && !PendingRetiredResources.empty())
+		{
+			GameResources->RetireResources(std::move(PendingRetiredResources));
+			PendingRetiredResources.clear();
+		}
+	}
+
+	void FGameMain::UpdateResourcesResidency()
+	{
+		ObjectsReferences.resize(Objects.size());
+		for (std::size_t iObject = 0; iObject < Objects.size(); ++iObject)
+		{
+			const auto& Object = *Objects[iObject];
+			auto& ObjectReferences = ObjectsReferences[iObject];
+
+			FObjectReferences CurrentReferences;
+			if (Object.IsRenderable())
+			{
+				CurrentReferences.SubmeshHandle = Object.GetSubmeshHandle();
+				CurrentReferences.MaterialHandle = GetObjectMaterialHandle(Object);
+			}
+
+			// New references are added first, so resources referred before and now aren't unreferenced for a moment
+			if (CurrentReferences.SubmeshHandle != ObjectReferences.SubmeshHandle)
+			{
+				GameResources->ReferenceSubmesh(CurrentReferences.SubmeshHandle, true);
+				GameResources->ReferenceSubmesh(ObjectReferences.SubmeshHandle, false);
+			}
+
+			if (CurrentReferences.MaterialHandle != ObjectReferences.MaterialHandle)
+			{
+				GameResources->ReferenceMaterial(CurrentReferences.MaterialHandle, true);
+				GameResources->ReferenceMaterial(ObjectReferences.MaterialHandle, false);
+			}
+
+			ObjectReferences = CurrentReferences;
+		}
+
+		auto ResidencyUpdate = GameResources->UpdateResidency(iFrame);
+		if (ResidencyUpdate.EvictedMeshesNames.empty() && ResidencyUpdate.EvictedTexturesHandles.empty())
+		{
+			return;
+		}
+
+		// Views of evicted textures are replaced with the placeholder when their back slots are free,
+		// and resources are retired after that, since frames in flight and current views still refer them
+		for (auto TextureHandle : ResidencyUpdate.EvictedTexturesHandles)
+		{
+			if (std::find(PendingTexturesViews.cbegin(), PendingTexturesViews.cend(), TextureHandle) == PendingTexturesViews.cend())
+			{
+				PendingTexturesViews.push_back(TextureHandle);
+			}
+
+			const auto TextureData = GameResources->GetTextureData(TextureHandle);
+			if (TextureStreamer->HasTexture(TextureData->Name))
+			{
+				TextureStreamer->RemoveTexture(TextureData->Name);
+			}
+		}
+
+		for (auto& Resource : ResidencyUpdate.RetiredResources)
+		{
+			PendingRetiredResources.push_back(std::move(Resource));
+		}
+
+		const auto BudgetStats = GameResources->GetResourceBudgetStats();
+		DBOUT("Resources evicted", ResidencyUpdate.EvictedMeshesNames.size() << " meshes, " <<
+			ResidencyUpdate.EvictedTexturesHandles.size() << " textures, " <<
+			BudgetStats.ResidentFootprint.GetTotalBytes() << "/" << BudgetStats.BudgetBytes << " bytes resident");
+	}
+
 	void WoodenEngine::FGameMain::UpdateMaterialsConstBuffer()
 	{
 		auto MaterialsBuffer = CurrFrameResource->MaterialsDataBuffer.get();
 
-		const auto& MaterialsData = GameResources->GetMaterialsData();
-		for (auto MaterialsDataIter = MaterialsData.cbegin(); MaterialsDataIter != MaterialsData.cend(); MaterialsDataIter++)
+		// Materials are contiguous in the pool
+		for (auto& MaterialData : GameResources->GetMaterialsData())
 		{
-			auto MaterialData = MaterialsDataIter->second.get();
-			if (MaterialData->NumDirtyConstBuffers > 0)
+			if (MaterialData.NumDirtyConstBuffers > 0)
 			{
 				SMaterialData MaterialShaderData;
-				MaterialShaderData.DiffuzeAlbedo = MaterialData->DiffuseAlbedo;
-				MaterialShaderData.FresnelR0 = MaterialData->FresnelR0;
-				MaterialShaderData.Roughness = MaterialData->Roughness;
+				MaterialShaderData.DiffuzeAlbedo = MaterialData.DiffuseAlbedo;
+				MaterialShaderData.FresnelR0 = MaterialData.FresnelR0;
+				MaterialShaderData.Roughness = MaterialData.Roughness;
 				XMStoreFloat4x4(&MaterialShaderData.MaterialTransform, 
-					XMMatrixTranspose(XMLoadFloat4x4(&MaterialData->Transform)));
+					XMMatrixTranspose(XMLoadFloat4x4(&MaterialData.Transform)));
 
-				MaterialsBuffer->CopyData(MaterialData->iConstBuffer, MaterialShaderData);
+				MaterialsBuffer->CopyData(MaterialData.iConstBuffer, MaterialShaderData);
 
-				--MaterialData->NumDirtyConstBuffers;
+				--MaterialData.NumDirtyConstBuffers;
 			}
 		}
 	}
@@ -1502,7 +2172,7 @@ namespace WoodenEngine
 
 		XMStoreFloat4x4(&FrameConstData.ViewMatrix, XMMatrixTranspose(ViewMatrix));
 
-		auto ProjMatrix = XMMatrixPerspectiveFovLH(XM_PI / 4.0f, Window->Bounds.Width / Window->Bounds.Height, 1.0, 1000.0f);
+		auto ProjMatrix = XMMatrixPerspectiveFovLH(CameraFovY, Window->Bounds.Width / Window->Bounds.Height, 1.0, 1000.0f);
 		XMStoreFloat4x4(&FrameConstData.ProjMatrix, XMMatrixTranspose(ProjMatrix));
 
 		auto ViewProj = XMMatrixMultiply(ViewMatrix, ProjMatrix);
@@ -1595,17 +2265,17 @@ namespace WoodenEngine
 
 		if (key == '1')
 		{
-			DinoObject->SetMaterial(GameResources->GetMaterialData("dino1"));
+			DinoObject->SetMaterial(GameResources->GetMaterialHandle("dino1"));
 			DinoObject->SetNumDirtyConstBuffers(NMR_SWAP_BUFFERS);
 		}
 		else if(key == '2')
 		{
-			DinoObject->SetMaterial(GameResources->GetMaterialData("dino2"));
+			DinoObject->SetMaterial(GameResources->GetMaterialHandle("dino2"));
 			DinoObject->SetNumDirtyConstBuffers(NMR_SWAP_BUFFERS);
 		}
 		else if (key == '3')
 		{
-			DinoObject->SetMaterial(GameResources->GetMaterialData("dino3"));
+			DinoObject->SetMaterial(GameResources->GetMaterialHandle("dino3"));
 			DinoObject->SetNumDirtyConstBuffers(NMR_SWAP_BUFFERS);
 		}
 	}
@@ -1629,6 +2299,59 @@ namespace WoodenEngine
 		DX::ThrowIfFailed(CmdListAllocator->Reset());
 
 		DX::ThrowIfFailed(CMDList->Reset(CmdListAllocator.Get(), PipelineStates["opaque"].Get()));
+		SetCurrPipelineStateName("opaque");
+
+		RenderStats = FRenderStats();
+
+		GameResources->ReclaimUploads(Fence->GetCompletedValue());
+
+		if (GameResources->HasPendingLoads())
+		{
+			auto UploadedResources = GameResources->FlushUploads(CMDList);
+			for (auto TextureHandle : UploadedResources.TexturesHandles)
+			{
+				if (std::find(PendingTexturesViews.begin(), PendingTexturesViews.end(), TextureHandle) == 
+					PendingTexturesViews.end())
+				{
+					PendingTexturesViews.push_back(TextureHandle);
+				}
+			}
+
+			// Retired resources of streamed textures are read through views until the views are swapped
+			std::move(UploadedResources.RetiredResources.begin(), UploadedResources.RetiredResources.end(),
+				std::back_inserter(PendingRetiredResources));
+
+			CompleteTexturesStreaming(UploadedResources);
+
+			if (!GameResources->HasPendingLoads())
+			{
+				const auto CacheStats = DerivedDataCache->GetStats();
+				DBOUT("Derived data cache after loads", CacheStats.NumHits << " hits, " << CacheStats.NumMisses << 
+					" misses, hit rate " << CacheStats.GetHitRate() << ", saved " << CacheStats.SavedSeconds << " s");
+
+				const auto GeometryStats = GameResources->GetGeometryStats();
+				DBOUT("Geometry arena after loads", GeometryStats.NumAllocations << " ranges in " <<
+					GeometryStats.NumPages << " pages (" << GeometryStats.NumDedicatedPages << " dedicated), " <<
+					GeometryStats.UsedBytes << "/" << GeometryStats.ReservedBytes << " bytes used, fragmentation " <<
+					GeometryStats.MaxFragmentation);
+
+				const auto UploadStats = GameResources->GetUploadStats();
+				DBOUT("Upload heap after loads", UploadStats.UploadedSize << " bytes in " << UploadStats.NumUploads <<
+					" uploads (" << UploadStats.NumDedicatedUploads << " dedicated), " <<
+					UploadStats.GetReservedSize() << " bytes of staging memory kept");
+
+				const auto BudgetStats = GameResources->GetResourceBudgetStats();
+				DBOUT("Resource budget after loads", BudgetStats.ResidentFootprint.GetTotalBytes() << "/" <<
+					BudgetStats.BudgetBytes << " bytes (CPU " << BudgetStats.ResidentFootprint[EResourceMemory::CPU] <<
+					", buffers " << BudgetStats.ResidentFootprint[EResourceMemory::GPUBuffers] << ", textures " <<
+					BudgetStats.ResidentFootprint[EResourceMemory::Textures] << "), " << BudgetStats.NumResident <<
+					" of " << BudgetStats.NumResources << " resources resident");
+			}
+		}
+
+		// Views of textures evicted by this frame may be swapped at once
+		UpdateResourcesResidency();
+		UpdateTexturesViews();
 
 		CMDList->ResourceBarrier(
 			1, &CD3DX12_RESOURCE_BARRIER::Transition(CurrentBackBuffer(), D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET)
@@ -1636,6 +2359,9 @@ namespace WoodenEngine
 
 		CMDList->SetGraphicsRootSignature(RootSignatures["main"].Get());
 
+		// Root arguments are undefined after the root signature is set
+		iBoundDiffuseTextureSRV = UINT32_MAX;
+
 		ID3D12DescriptorHeap* srvDescriptorHeaps[] = {  SRVDescriptorHeap.Get()};
 		CMDList->SetDescriptorHeaps(_countof(srvDescriptorHeaps), srvDescriptorHeaps);
 
@@ -1654,10 +2380,10 @@ namespace WoodenEngine
 
 		RenderObjects(ERenderLayer::Opaque, CMDList);
 
-		CMDList->SetPipelineState(PipelineStates["landscape"].Get());
+		SetPipelineState("landscape", CMDList);
 		RenderObjects(ERenderLayer::Landscape, CMDList);
 
-		CMDList->SetPipelineState(PipelineStates["bezier"].Get());
+		SetPipelineState("bezier", CMDList);
 		RenderObjects(ERenderLayer::Bezier, CMDList);
 
 
@@ -1665,7 +2391,7 @@ namespace WoodenEngine
 		//RenderObjects(ERenderLayer::Opaque, CMDList);
 
 		CMDList->OMSetStencilRef(1);
-		CMDList->SetPipelineState(PipelineStates["markmirrors"].Get());
+		SetPipelineState("markmirrors", CMDList);
 		RenderObjects(ERenderLayer::Mirrors, CMDList);
 
 		// Set reflected frame const buffer as argument to shader
@@ -1673,28 +2399,28 @@ namespace WoodenEngine
 			CurrFrameResource->FrameDataBuffer->GetElementByteSize();
 		CMDList->SetGraphicsRootConstantBufferView(2, ReflectedFrameConstDataResAddress);
 
-		CMDList->SetPipelineState(PipelineStates["reflections"].Get());
+		SetPipelineState("reflections", CMDList);
 		RenderObjects(ERenderLayer::Reflected, CMDList);
 
 		CMDList->OMSetStencilRef(0);
 		CMDList->SetGraphicsRootConstantBufferView(2, FrameConstDataResAddress);
 
-		CMDList->SetPipelineState(PipelineStates["alphatest"].Get());
+		SetPipelineState("alphatest", CMDList);
 		RenderObjects(ERenderLayer::AlphaTested, CMDList);
 
-		CMDList->SetPipelineState(PipelineStates["billboard"].Get());
+		SetPipelineState("billboard", CMDList);
 		RenderObjects(ERenderLayer::Billboard, CMDList);
 
-		CMDList->SetPipelineState(PipelineStates["shadow"].Get());
+		SetPipelineState("shadow", CMDList);
 		RenderObjects(ERenderLayer::Shadow, CMDList);
 
-		CMDList->SetPipelineState(PipelineStates["opaque"].Get());
+		SetPipelineState("opaque", CMDList);
 		RenderObjects(ERenderLayer::CastShadow, CMDList);
 
-		CMDList->SetPipelineState(PipelineStates["geosphere"].Get());
+		SetPipelineState("geosphere", CMDList);
 		RenderObjects(ERenderLayer::Geosphere, CMDList);
 
-		CMDList->SetPipelineState(PipelineStates["transparent"].Get());
+		SetPipelineState("transparent", CMDList);
 		RenderObjects(ERenderLayer::Mirrors, CMDList);
 		RenderObjects(ERenderLayer::Transparent, CMDList);
 
@@ -1799,6 +2525,34 @@ namespace WoodenEngine
 		++FenceValue;
 		CurrFrameResource->Fence = FenceValue;
 		CmdQueue->Signal(Fence.Get(), FenceValue);
+
+		// Uploads recorded by the frame are recycled when it's completed
+		GameResources->SubmitUploads(FenceValue);
+
+		// Back slots of views swapped by the frame are free when it's completed
+		for (auto TextureHandle : SwappedTexturesViews)
+		{
+			if (auto TextureData = GameResources->GetTexturesData().Find(TextureHandle))
+			{
+				TextureData->SRVFenceValue = FenceValue;
+			}
+		}
+		SwappedTexturesViews.clear();
+
+		// Without sharing of descriptor tables one is set per drawn object
+		if (RenderStats.NumDrawnObjects != ReportedRenderStats.NumDrawnObjects ||
+			RenderStats.NumDescriptorTablesSet != ReportedRenderStats.NumDescriptorTablesSet ||
+			RenderStats.NumPipelineStatesSet != ReportedRenderStats.NumPipelineStatesSet ||
+			RenderStats.NumGeometryBuffersSet != ReportedRenderStats.NumGeometryBuffersSet)
+		{
+			DBOUT("Render stats", RenderStats.NumDrawnObjects << " objects drawn, " << 
+				RenderStats.NumDescriptorTablesSet << " descriptor tables set (" << 
+				RenderStats.NumDrawnObjects - RenderStats.NumDescriptorTablesSet << " saved), " << 
+				RenderStats.NumPipelineStatesSet << " pipeline states set, " <<
+				RenderStats.NumGeometryBuffersSet << " geometry buffers set");
+
+			ReportedRenderStats = RenderStats;
+		}
 	}
 
 	void FGameMain::AddObjectToScene(ERenderLayer RenderLayer, WObject* Object)
@@ -1809,34 +2563,142 @@ namespace WoodenEngine
 		++NumRenderableObjectsConstBuffers;
 	}
 
+	FMaterialHandle FGameMain::GetObjectMaterialHandle(const WObject& Object) const noexcept
+	{
+		const auto MaterialHandle = Object.GetMaterial();
+		if (MaterialHandle.IsValid())
+		{
+			return MaterialHandle;
+		}
+
+		// Submeshes of evicted meshes don't have materials until reloads
+		return GameResources->GetSubmeshMaterialHandle(Object.GetSubmeshHandle());
+	}
+
+	const FSubmeshData& FGameMain::SelectSubmeshLOD(
+		const FSubmeshData& SubmeshData, 
+		const XMMATRIX& WorldTransform,
+		const XMFLOAT3& CameraPosition) const
+	{
+		if (SubmeshData.LODs.empty())
+		{
+			return SubmeshData;
+		}
+
+		// Geometric error is scaled by the largest axis scale of the object
+		const auto MaxScale = std::max({
+			XMVectorGetX(XMVector3Length(WorldTransform.r[0])),
+			XMVectorGetX(XMVector3Length(WorldTransform.r[1])),
+			XMVectorGetX(XMVector3Length(WorldTransform.r[2])) });
+
+		const auto Distance = XMVectorGetX(XMVector3Length(
+			XMVectorSubtract(WorldTransform.r[3], XMLoadFloat3(&CameraPosition))));
+
+		const auto ProjectionScale = GetProjectionScale();
+
+		// The coarsest level which error isn't visible
+		const FSubmeshData* SelectedSubmeshData = &SubmeshData;
+		for (const auto LOD : SubmeshData.LODs)
+		{
+			const auto ScreenSpaceError = FMeshSimplifier::ComputeScreenSpaceError(
+				LOD->GeometricError*MaxScale, Distance, ProjectionScale);
+
+			if (ScreenSpaceError > MaxLODScreenSpaceError)
+			{
+				break;
+			}
+
+			SelectedSubmeshData = LOD;
+		}
+
+		return *SelectedSubmeshData;
+	}
+
 	void FGameMain::RenderObjects(ERenderLayer RenderLayer, ComPtr<ID3D12GraphicsCommandList> CMDList)
 	{
-		RenderObjects(RenderableObjects[(uint8)RenderLayer], CMDList);
+		// Alpha tested and billboard layers are rendered without back-face culling
+		const auto bCullBackfacingMeshlets = bCullMeshlets &&
+			RenderLayer != ERenderLayer::AlphaTested &&
+			RenderLayer != ERenderLayer::Billboard;
+
+		RenderObjects(RenderableObjects[(uint8)RenderLayer], CMDList, bCullBackfacingMeshlets);
 	}
 
 	void FGameMain::RenderObjects(
 		const std::vector<WObject*>& RenderableObjects, 
-		ComPtr<ID3D12GraphicsCommandList> CMDList)
+		ComPtr<ID3D12GraphicsCommandList> CMDList,
+		bool bCullBackfacingMeshlets)
 	{
+		const auto CameraPosition = Camera->GetWorldPosition();
+
 		auto* CurMaterialsResource = CurrFrameResource->MaterialsDataBuffer.get();
 
 		const auto MaterialConstBufferSize = CurMaterialsResource->GetElementByteSize();
 		const auto ObjectConstBufferSize = CurrFrameResource->ObjectsDataBuffer->GetElementByteSize();
 
+		// Vertex format of the bound variant of the current pipeline state
+		auto BoundVertexFormat = EVertexFormat::Full;
+
+		// Meshes of the same geometry arena's page share its buffers
+		D3D12_GPU_VIRTUAL_ADDRESS BoundVertexBufferLocation = 0;
+		D3D12_GPU_VIRTUAL_ADDRESS BoundIndexBufferLocation = 0;
+
 		for (auto Object : RenderableObjects)
 		{
-			if (!Object->IsVisible())
+			// Objects whose meshes are being loaded or are evicted aren't drawn. Submeshes are found by handles, not names
+			const auto SubmeshHandle = Object->GetSubmeshHandle();
+			const auto MeshData = Object->IsVisible() ? GameResources->GetMeshData(SubmeshHandle) : nullptr;
+			const auto SourceSubmeshData = GameResources->GetSubmeshData(SubmeshHandle);
+			if (MeshData == nullptr || SourceSubmeshData == nullptr)
+			{
+				continue;
+			}
+
+			// Objects with removed materials or without any material aren't drawn
+			const auto Material = GameResources->GetMaterialData(GetObjectMaterialHandle(*Object));
+			if (Material == nullptr)
 			{
 				continue;
 			}
 
-			const auto& MeshData = GameResources->GetMeshData(Object->GetMeshName());
-			const auto& SubmeshData = GameResources->GetSubmeshData(Object->GetMeshName(), Object->GetSubmeshName());
+			const auto WorldTransform = XMMatrixMultiply(
+				XMLoadFloat4x4(&SourceSubmeshData->Transform), Object->GetWorldTransform());
+			const auto& SubmeshData = SelectSubmeshLOD(*SourceSubmeshData, WorldTransform, CameraPosition);
+
+			if (MeshData->VertexFormat != BoundVertexFormat)
+			{
+				const auto PipelineState = CurrPipelineStates[static_cast<uint8>(MeshData->VertexFormat)];
+				if (PipelineState == nullptr)
+				{
+					throw std::invalid_argument("Pipeline state " + 
+						GetPipelineStateName(CurrPipelineStateName, MeshData->VertexFormat) + " doesn't exist");
+				}
+
+				CMDList->SetPipelineState(PipelineState);
+				BoundVertexFormat = MeshData->VertexFormat;
+				++RenderStats.NumPipelineStatesSet;
+			}
+
+			if (MeshData->VertexFormat != EVertexFormat::Full)
+			{
+				CMDList->SetGraphicsRoot32BitConstants(4, 
+					sizeof(SVertexQuantizationData) / sizeof(uint32), &SubmeshData.VertexQuantization, 0);
+			}
 
 			CMDList->IASetPrimitiveTopology(Object->GetRenderPrimitiveTopology());
-			CMDList->IASetVertexBuffers(0, 1, &MeshData.VertexBufferView);
-			CMDList->IASetIndexBuffer(&MeshData.IndexBufferView);
+			if (MeshData->VertexBufferView.BufferLocation != BoundVertexBufferLocation)
+			{
+				CMDList->IASetVertexBuffers(0, 1, &MeshData->VertexBufferView);
+				BoundVertexBufferLocation = MeshData->VertexBufferView.BufferLocation;
+				++RenderStats.NumGeometryBuffersSet;
+			}
 
+			if (MeshData->IndexBufferView.BufferLocation != BoundIndexBufferLocation)
+			{
+				CMDList->IASetIndexBuffer(&MeshData->IndexBufferView);
+				BoundIndexBufferLocation = MeshData->IndexBufferView.BufferLocation;
+				++RenderStats.NumGeometryBuffersSet;
+			}
 
 			auto ObjectDataResAddress =
 				CurrFrameResource->ObjectsDataBuffer->Resource()->GetGPUVirtualAddress() +
@@ -1844,21 +2706,127 @@ namespace WoodenEngine
 
 			auto MaterialsResAddress =
 				CurMaterialsResource->Resource()->GetGPUVirtualAddress() +
-				Object->GetMaterial()->iConstBuffer*MaterialConstBufferSize;
-
-			auto DiffuseTexSRVHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE{
-				SRVDescriptorHeap->GetGPUDescriptorHandleForHeapStart()
-			};
-			DiffuseTexSRVHandle.Offset(Object->GetMaterial()->DiffuseTexture->iSRVHeap, 
-				CBVSRVDescriptorHandleIncrementSize);
+				Material->iConstBuffer*MaterialConstBufferSize;
 
 			CMDList->SetGraphicsRootConstantBufferView(0, ObjectDataResAddress);
 			CMDList->SetGraphicsRootConstantBufferView(1, MaterialsResAddress);
-			CMDList->SetGraphicsRootDescriptorTable(3, DiffuseTexSRVHandle);
 
-			CMDList->DrawIndexedInstanced(
-				SubmeshData.NumIndices, 1, SubmeshData.IndexBegin,
-				SubmeshData.VertexBegin, 0);
+			// Objects with textures packed to the same atlas share the table
+			// Removed textures are replaced by the placeholder
+			auto DiffuseTexture = GameResources->GetTextureData(Material->DiffuseTexture);
+			if (DiffuseTexture == nullptr)
+			{
+				DiffuseTexture = GameResources->GetTextureData(PlaceholderTextureHandle);
+			}
+
+			const auto iDiffuseTextureSRV = DiffuseTexture->iSRVHeap;
+			if (iDiffuseTextureSRV != iBoundDiffuseTextureSRV)
+			{
+				auto DiffuseTexSRVHandle = CD3DX12_GPU_DESCRIPTOR_HANDLE{
+					SRVDescriptorHeap->GetGPUDescriptorHandleForHeapStart()
+				};
+				DiffuseTexSRVHandle.Offset(iDiffuseTextureSRV, CBVSRVDescriptorHandleIncrementSize);
+
+				CMDList->SetGraphicsRootDescriptorTable(3, DiffuseTexSRVHandle);
+				iBoundDiffuseTextureSRV = iDiffuseTextureSRV;
+				++RenderStats.NumDescriptorTablesSet;
+			}
+
+			++RenderStats.NumDrawnObjects;
+
+			XMVECTOR WorldTransformDeterminant = XMVectorZero();
+			XMMATRIX InvWorldTransform = XMMatrixIdentity();
+			if (bCullBackfacingMeshlets && SubmeshData.Meshlets.size() > 1)
+			{
+				InvWorldTransform = XMMatrixInverse(&WorldTransformDeterminant, WorldTransform);
+			}
+
+			// Submeshes' ranges are relative to the mesh's ranges in the pages
+			const auto IndexBegin = MeshData.StartIndexLocation + SubmeshData.IndexBegin;
+			const auto VertexBegin = MeshData.BaseVertexLocation + SubmeshData.VertexBegin;
+
+			// Projected objects (like planar shadows) have degenerate transforms and are drawn whole
+			if (fabsf(XMVectorGetX(WorldTransformDeterminant)) <= FLT_EPSILON)
+			{
+				CMDList->DrawIndexedInstanced(
+					SubmeshData.NumIndices, 1, IndexBegin,
+					VertexBegin, 0);
+				continue;
+			}
+
+			// Meshlets are tested in the object's local space. 
+			// Adjacent visible meshlets are merged to one draw call
+			const auto LocalCameraPosition = XMVector3TransformCoord(
+				XMLoadFloat3(&CameraPosition), InvWorldTransform);
+
+			uint64 NumBatchIndices = 0;
+			uint64 BatchIndexBegin = 0;
+			for (const auto& Meshlet : SubmeshData.Meshlets)
+			{
+				if (!FMeshletBuilder::IsBackfacing(Meshlet, LocalCameraPosition))
+				{
+					if (NumBatchIndices == 0)
+					{
+						BatchIndexBegin = Meshlet.IndexBegin;
+					}
+					NumBatchIndices += Meshlet.NumTriangles * 3;
+					continue;
+				}
+
+				if (NumBatchIndices > 0)
+				{
+					CMDList->DrawIndexedInstanced(
+						NumBatchIndices, 1, IndexBegin + BatchIndexBegin,
+						VertexBegin, 0);
+					NumBatchIndices = 0;
+				}
+			}
+
+			if (NumBatchIndices > 0)
+			{
+				CMDList->DrawIndexedInstanced(
+					NumBatchIndices, 1, IndexBegin + BatchIndexBegin,
+					VertexBegin, 0);
+			}
+		}
+
+		if (BoundVertexFormat != EVertexFormat::Full)
+		{
+			CMDList->SetPipelineState(CurrPipelineStates[static_cast<uint8>(EVertexFormat::Full)]);
+		}
+	}
+
+	void FGameMain::SetPipelineState(const std::string& Name, ComPtr<ID3D12GraphicsCommandList> CMDList)
+	{
+		CMDList->SetPipelineState(PipelineStates[Name].Get());
+		SetCurrPipelineStateName(Name);
+		++RenderStats.NumPipelineStatesSet;
+	}
+
+	void FGameMain::SetCurrPipelineStateName(const std::string& Name)
+	{
+		CurrPipelineStateName = Name;
+
+		// Variants are found once here, so RenderObjects doesn't look them up by names
+		for (uint8 iVertexFormat = 0; iVertexFormat < CurrPipelineStates.size(); ++iVertexFormat)
+		{
+			const auto PipelineStateIter = PipelineStates.find(
+				GetPipelineStateName(Name, static_cast<EVertexFormat>(iVertexFormat)));
+			CurrPipelineStates[iVertexFormat] = PipelineStateIter != PipelineStates.end() ? 
+				PipelineStateIter->second.Get() : nullptr;
+		}
+	}
+
+	std::string FGameMain::GetPipelineStateName(const std::string& Name, EVertexFormat VertexFormat)
+	{
+		switch (VertexFormat)
+		{
+		case EVertexFormat::Packed:
+			return Name + "_packed";
+		case EVertexFormat::Quantized:
+			return Name + "_quantized";
+		default:
+			return Name;
 		}
 	}
 
@@ -10,6 +10,10 @@
 #include "ShaderStructures.h"
 #include "FrameResource.h"
 #include "GameResource.h"
+#include "DerivedDataCache.h"
+#include "TextureStreamer.h"
+#include "TextureAtlas.h"
+#include "Terrain.h"
 
 // Renders Direct3D content on the screen.
 namespace WoodenEngine
@@ -110,13 +114,54 @@ namespace WoodenEngine
 		/** @brief Renders list of objects
 		  * @param RenderableObjects List of renderable objects(const std::vector<WObject * > &)
 		  * @param CMDList Current command list for sending commands(ComPtr<ID3D12GraphicsCommandList>)
+		  * @param bCullBackfacingMeshlets Skips meshlets back-facing to the camera (bool)
 		  * @return (void)
 		  */
 		void RenderObjects(
 			const std::vector<WObject*>& RenderableObjects,
-			ComPtr<ID3D12GraphicsCommandList> CMDList
+			ComPtr<ID3D12GraphicsCommandList> CMDList,
+			bool bCullBackfacingMeshlets = false
 		);
 
+		/** @brief Selects the coarsest LOD of the submesh which screen-space error is acceptable
+		  * @param SubmeshData Source submesh (const FSubmeshData &)
+		  * @param WorldTransform World transform of the object (const XMMATRIX &)
+		  * @param CameraPosition (const XMFLOAT3 &)
+		  * @return The submesh or one of its LODs (const WoodenEngine::FSubmeshData&)
+		  */
+		const FSubmeshData& SelectSubmeshLOD(
+			const FSubmeshData& SubmeshData,
+			const XMMATRIX& WorldTransform,
+			const XMFLOAT3& CameraPosition) const;
+
+		/** @brief Returns the object's material. Objects without their own materials
+		  * take the source material of their ready submeshes
+		  * @param Object (const WObject &)
+		  * @return Invalid handle if the object has no material (WoodenEngine::FMaterialHandle)
+		  */
+		FMaterialHandle GetObjectMaterialHandle(const WObject& Object) const noexcept;
+
+		/** @brief Sets pipeline state for rendering the next objects.
+		  * RenderObjects switches to its packed vertices' variant for packed meshes
+		  * @param Name Name of pipeline state (const std::string &)
+		  * @param CMDList Current command list for sending commands (ComPtr<ID3D12GraphicsCommandList>)
+		  * @return (void)
+		  */
+		void SetPipelineState(const std::string& Name, ComPtr<ID3D12GraphicsCommandList> CMDList);
+
+		/** @brief Name of pipeline state's variant for meshes with the vertex format
+		  * @param Name Name of pipeline state for the full vertex format (const std::string &)
+		  * @param VertexFormat (EVertexFormat)
+		  * @return (std::string)
+		  */
+		static std::string GetPipelineStateName(const std::string& Name, EVertexFormat VertexFormat);
+
+		/** @brief Remembers the pipeline state set to the command list and finds its vertex formats' variants
+		  * @param Name Name of pipeline state (const std::string &)
+		  * @return (void)
+		  */
+		void SetCurrPipelineStateName(const std::string& Name);
+
 		/** @brief Renders list of renderable objects of specific render layer
 		  * @param RenderLayer Render layer (ERenderLayer)
 		  * @param CMDList Current command list for sending commands (ComPtr<ID3D12GraphicsCommandList>)
@@ -133,6 +178,12 @@ namespace WoodenEngine
 		  * @return (bool)
 		  */
 		bool Initialize(Windows::UI::Core::CoreWindow^ outputWindow);
+
+		/** @brief Sets DPI of the window's display, which converts the window's bounds to pixels
+		  * @param LogicalDpi (float)
+		  * @return (void)
+		  */
+		void SetLogicalDpi(float LogicalDpi) noexcept;
 	private:
 		/** @brief Returns current back buffer
 		  * @return (ID3D12Resource*)
@@ -161,6 +212,13 @@ namespace WoodenEngine
 		  */
 		void InitGameResources();
 
+		/** @brief Opens the asset package and sets it to game resources.
+		  * The package is repacked if it's missing or packed from other asset files
+		  * @param PackageFilePath (const std::string &)
+		  * @return (void)
+		  */
+		void InitAssetPackage(const std::string& PackageFilePath);
+
 		/** @brief Adds renderable objects
 		  * @return (void)
 		  */
@@ -180,6 +238,14 @@ namespace WoodenEngine
 		  * @return (void)
 		  */
 		void AddTextures();
+
+		/** @brief Sets the material's diffuse texture. Textures packed to the atlas are replaced by it,
+		  * and the material's transform is mapped to the texture's rectangle
+		  * @param Material (FMaterialData *)
+		  * @param TextureName (const std::string &)
+		  * @return (void)
+		  */
+		void SetDiffuseTexture(FMaterialData* Material, const std::string& TextureName);
 		
 		/** @brief Initializes descriptor heaps
 		  * @return (void)
@@ -196,11 +262,18 @@ namespace WoodenEngine
 		  */
 		void InitDepthStencilBuffer();
 
-		/** @brief Initializes loaded textures views
+		/** @brief Initializes textures views. Textures which are being loaded get placeholders
 		  * @return (void)
 		  */
 		void InitTexturesViews();
 
+		/** @brief Creates view of the texture in its slot of SRV heap.
+		  * Texture without resource is viewed as white1x1 or as null array
+		  * @param TextureData (const FTextureData *)
+		  * @return (void)
+		  */
+		void InitTextureView(const FTextureData* TextureData);
+
 		/** @brief Initializes viewport settins and scissor rectangle
 		  * @return (void)
 		  */
@@ -257,6 +330,43 @@ namespace WoodenEngine
 		  */
 		void UpdateObjectsConstBuffer();
 
+		/** @brief Reports required resolution of visible objects' textures to the streamer
+		  * and starts reloads of textures requested by it
+		  * @return (void)
+		  */
+		void UpdateTexturesStreaming();
+
+		/** @brief Returns height in pixels of a view space unit at distance 1 from the camera
+		  * @return (float)
+		  */
+		float GetProjectionScale() const;
+
+		/** @brief Selects terrain tiles for the camera, starts uploads of generated tiles
+		  * and assigns uploaded ones to terrain objects. Unused tiles' meshes are removed
+		  * @return (void)
+		  */
+		void UpdateTerrain();
+
+		/** @brief Registers uploaded textures in the streamer and confirms finished reloads.
+		  * Is called after FlushUploads
+		  * @param UploadedResources (const FUploadedResources &)
+		  * @return (void)
+		  */
+		void CompleteTexturesStreaming(const FUploadedResources& UploadedResources);
+
+		/** @brief Swaps views of uploaded textures whose back slots aren't read by frames in flight.
+		  * Retires replaced resources once every pending view is swapped
+		  * @return (void)
+		  */
+		void UpdateTexturesViews();
+
+		/** @brief Updates references of objects whose resources changed, evicts unreferenced resources over the budget
+		  * and queues views of evicted textures to be replaced with placeholders. Evicted resources are retired
+		  * by the fence once the views are swapped. Is called after FlushUploads
+		  * @return (void)
+		  */
+		void UpdateResourcesResidency();
+
 
 		/** @brief Updates reflected frame's const buffers
 		  * @return (void)
@@ -293,6 +403,15 @@ namespace WoodenEngine
 		// Current view camera
 		WCamera* Camera;
 
+		// Enables per-meshlet backface culling for layers rendered with back-face culling
+		bool bCullMeshlets = true;
+
+		// Vertical field of view of the camera
+		static constexpr float CameraFovY = XM_PI / 4.0f;
+
+		// Max error of simplified submeshes in pixels
+		float MaxLODScreenSpaceError = 1.0f;
+
 		XMVECTOR MirrorPlane;
 		XMVECTOR ShadowPlane;
 
@@ -340,7 +459,85 @@ namespace WoodenEngine
 		std::unique_ptr<FFilterBlur> FilterBlur;
 		std::unique_ptr<FFilterSobel> FilterSobel;
 
+		// Is used by loading workers, so it's destroyed after game resources
+		std::unique_ptr<FDerivedDataCache> DerivedDataCache;
+
 		std::unique_ptr<FGameResource> GameResources;
+
+		// Placeholder of textures which are being loaded or are removed. It isn't reloadable, so it's never evicted
+		FTextureHandle PlaceholderTextureHandle;
+
+		// Material whose texture coordinates are animated every frame
+		FMaterialHandle WaterMaterialHandle;
+
+		// Textures and meshes are loaded from one mapped package. Loose files are loaded if it's false
+		bool bUseAssetPackage = true;
+
+		// Decides which mips of textures are resident
+		std::unique_ptr<FTextureStreamer> TextureStreamer;
+
+		// Reloads of textures requested by the streamer, by textures' names
+		std::unordered_map<std::string, Concurrency::task<bool>> TexturesStreamingTasks;
+
+		// Uploaded textures whose views wait for their back slots
+		std::vector<FTextureHandle> PendingTexturesViews;
+
+		// Replaced resources of textures. Views which wait for back slots still refer them
+		std::vector<ComPtr<ID3D12Resource>> PendingRetiredResources;
+
+		// Textures whose views are swapped by the current frame
+		std::vector<FTextureHandle> SwappedTexturesViews;
+
+		// Submesh and material which an object refers in the resource budget
+		struct FObjectReferences
+		{
+			FSubmeshHandle SubmeshHandle;
+			FMaterialHandle MaterialHandle;
+		};
+
+		// References of objects, indexed as Objects. They're updated only when objects' handles change
+		std::vector<FObjectReferences> ObjectsReferences;
+
+		// Streamed terrain. Its selected tiles are drawn by TerrainTilesObjects
+		std::unique_ptr<FTerrain> Terrain;
+
+		// Pool of objects for selected terrain tiles. Objects are added at init, since const buffers are
+		std::vector<WObject*> TerrainTilesObjects;
+
+		// Uploaded or uploading mesh of a terrain tile
+		struct FTerrainTileMesh
+		{
+			std::string MeshName;
+			FSubmeshHandle SubmeshHandle;
+			Concurrency::task<bool> LoadTask;
+		};
+
+		// Meshes of terrain tiles by tiles' keys
+		std::unordered_map<uint64, FTerrainTileMesh> TerrainTilesMeshes;
+
+		// Keys of tiles drawn by TerrainTilesObjects
+		std::vector<uint64> DrawnTerrainTiles;
+
+		// Index of the current frame, which streamed textures were used in
+		uint64 iFrame = 0;
+
+		// Placement of textures packed to the atlas. Is released when materials are added
+		std::shared_ptr<FTextureAtlasBuilder> TextureAtlasBuilder;
+
+		// Draws and state changes of a frame
+		struct FRenderStats
+		{
+			uint32 NumDrawnObjects = 0;
+			uint32 NumDescriptorTablesSet = 0;
+			uint32 NumPipelineStatesSet = 0;
+			uint32 NumGeometryBuffersSet = 0;
+		};
+
+		FRenderStats RenderStats;
+		FRenderStats ReportedRenderStats;
+
+		// Descriptor table of the diffuse texture isn't set again for objects with the same texture
+		uint32 iBoundDiffuseTextureSRV = UINT32_MAX;
 		std::unique_ptr<FFrameResource> FramesResource[NMR_SWAP_BUFFERS];
 
 		SFrameData FrameConstData;
@@ -353,6 +550,12 @@ namespace WoodenEngine
 
 		// PSO
 		std::unordered_map<std::string, ComPtr<ID3D12PipelineState>> PipelineStates;
+
+		// Pipeline state set by SetPipelineState
+		std::string CurrPipelineStateName;
+
+		// Variants of the current pipeline state indexed by EVertexFormat. nullptr if there's no variant
+		std::array<ID3D12PipelineState*, 3> CurrPipelineStates = {};
 		
 		uint16 RTVDescriptorHandleIncrementSize = 0;
 		uint16 DSVDescriptorHandleIncrementSize = 0;
@@ -379,6 +582,9 @@ namespace WoodenEngine
 		// Cached reference to the output window
 		Platform::Agile<Windows::UI::Core::CoreWindow> Window;
 
+		// DPI of the window's display. Bounds of the window are in DIPs
+		float LogicalDpi = 96.0f;
+
 		float GameTime;
 	};
 }
\ No newline at end of file
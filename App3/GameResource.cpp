@@ -1,10 +1,34 @@
 #pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
 #include "Common/DirectXHelper.h"
 #include "Common/DDSTextureLoader.h"
+#include "Common/MappedFile.h"
 #include "GameResource.h"
+#include "MeshBaker.h"
+#include "MeshFile.h"
 
 namespace WoodenEngine
 {
+	namespace
+	{
+		/** @brief Returns the allocator which places subresources of textures to the upload heap
+		  * @param UploadHeap (FUploadHeap &)
+		  * @return (DirectX::DDS_UPLOAD_ALLOCATOR)
+		  */
+		DirectX::DDS_UPLOAD_ALLOCATOR CreateTextureUploadAllocator(FUploadHeap& UploadHeap)
+		{
+			return [&UploadHeap](UINT64 Size, UINT64& Offset) -> ID3D12Resource*
+			{
+				const auto Upload = UploadHeap.Allocate(Size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+				Offset = Upload.Offset;
+				return Upload.Resource;
+			};
+		}
+	}
+
 	FGameResource::FGameResource()
 	{
 	}
@@ -12,6 +36,8 @@ namespace WoodenEngine
 	FGameResource::FGameResource(ComPtr<ID3D12Device> Device):
 		Device(Device)
 	{
+		UploadHeap.SetDevice(Device);
+		GeometryArena.SetDevice(Device);
 	}
 
 	FGameResource::~FGameResource()
@@ -21,119 +47,530 @@ namespace WoodenEngine
 	void FGameResource::LoadStaticMesh(
 		std::vector<std::unique_ptr<FMeshRawData>>&& SubmeshesData,
 		const std::string& MeshName,
-		ComPtr<ID3D12GraphicsCommandList> CMDList)
+		ComPtr<ID3D12GraphicsCommandList> CMDList,
+		EVertexFormat VertexFormat)
 	{
 		if (SubmeshesData.empty())
 		{
 			throw std::invalid_argument("SubmeshesData must be not empty");
 		}
 
-		if (MeshName.empty())
+		CheckMeshName(MeshName);
+
+		FMeshBakeSettings BakeSettings;
+		BakeSettings.VertexFormat = VertexFormat;
+		BakeSettings.bOptimizeOverdraw = bOptimizeMeshesOverdraw;
+		BakeSettings.WeldSettings = MeshesWeldSettings;
+
+		FMeshBaker MeshBaker;
+		auto BakedMesh = MeshBaker.Bake(std::move(SubmeshesData), MeshName, BakeSettings);
+
+		CreateStaticMesh(MeshName, BakedMesh.get(), CMDList);
+
+		// Synchronously loaded resources don't have loads to reload them, so they aren't evicted
+		ResourceBudget.AddResource(EResourceType::Mesh, MeshName, GetMeshFootprint(GetMeshData(MeshName)), false);
+	}
+
+	void FGameResource::LoadStaticMeshFile(
+		const std::string& FilePath,
+		const std::string& MeshName,
+		ComPtr<ID3D12GraphicsCommandList> CMDList)
+	{
+		CheckMeshName(MeshName);
+
+		const auto StartTime = std::chrono::high_resolution_clock::now();
+
+		const auto Entry = AssetPackage != nullptr ? AssetPackage->FindEntry(FilePath) : nullptr;
+		const auto MeshFile = Entry != nullptr ?
+			std::make_unique<FMeshFile>(AssetPackage, *Entry) : std::make_unique<FMeshFile>(FilePath);
+		CreateStaticMesh(MeshName, *MeshFile, CMDList);
+		ResourceBudget.AddResource(EResourceType::Mesh, MeshName, GetMeshFootprint(GetMeshData(MeshName)), false);
+
+		const std::chrono::duration<double, std::milli> LoadTime =
+			std::chrono::high_resolution_clock::now() - StartTime;
+		DBOUT(MeshName + " loaded from " + (Entry != nullptr ? AssetPackage->GetFilePath() : FilePath), 
+			MeshFile->GetHeader().VerticesSize + MeshFile->GetHeader().IndicesSize <<
+			" bytes in " << LoadTime.count() << " ms");
+	}
+
+	Concurrency::task<bool> FGameResource::LoadStaticMeshAsync(
+		FSubmeshesDataSource SubmeshesDataSource,
+		const std::string& MeshName,
+		EVertexFormat VertexFormat)
+	{
+		CheckMeshName(MeshName);
+
+		// Settings are captured at the request
+		FMeshBakeSettings BakeSettings;
+		BakeSettings.VertexFormat = VertexFormat;
+		BakeSettings.bOptimizeOverdraw = bOptimizeMeshesOverdraw;
+		BakeSettings.WeldSettings = MeshesWeldSettings;
+
+		MeshesLoads[MeshName] = [SubmeshesDataSource, MeshName, BakeSettings](FLoadedResource* LoadedResource)
 		{
-			throw std::invalid_argument("MeshName must be not empty");
+			auto SubmeshesData = SubmeshesDataSource();
+			if (SubmeshesData.empty())
+			{
+				throw std::invalid_argument("SubmeshesData must be not empty");
+			}
+
+			FMeshBaker MeshBaker;
+			LoadedResource->BakedMesh = MeshBaker.Bake(std::move(SubmeshesData), MeshName, BakeSettings);
+		};
+
+		return EnqueueLoad(MeshName, MeshesLoads[MeshName]);
+	}
+
+	Concurrency::task<bool> FGameResource::LoadStaticMeshFileAsync(
+		const std::string& FilePath,
+		const std::string& MeshName)
+	{
+		return LoadStaticMeshFileAsync([FilePath]() { return FilePath; }, MeshName);
+	}
+
+	Concurrency::task<bool> FGameResource::LoadStaticMeshFileAsync(
+		FMeshFileSource MeshFileSource,
+		const std::string& MeshName)
+	{
+		CheckMeshName(MeshName);
+
+		const auto AssetPackage = this->AssetPackage;
+		MeshesLoads[MeshName] = [MeshFileSource, AssetPackage](FLoadedResource* LoadedResource)
+		{
+			const auto FilePath = MeshFileSource();
+			const auto Entry = AssetPackage != nullptr ? AssetPackage->FindEntry(FilePath) : nullptr;
+			if (Entry != nullptr)
+			{
+				LoadedResource->MeshFile = std::make_unique<FMeshFile>(AssetPackage, *Entry);
+				LoadedResource->bFromPackage = true;
+			}
+			else
+			{
+				LoadedResource->MeshFile = std::make_unique<FMeshFile>(FilePath);
+			}
+		};
+
+		return EnqueueLoad(MeshName, MeshesLoads[MeshName]);
+	}
+
+	Concurrency::task<bool> FGameResource::LoadTextureAsync(
+		const std::wstring& FileName,
+		const std::string& Name,
+		D3D12_SRV_DIMENSION ViewDimension,
+		uint32 MaxSize)
+	{
+		const auto TextureHandle = AddTexture(Name, FileName, ViewDimension);
+
+		// Evicted texture is reloaded with its tail mips, and then it's streamed again
+		const auto AssetPackage = this->AssetPackage;
+		TexturesLoads[Name] = [FileName, MaxSize, AssetPackage](FLoadedResource* LoadedResource)
+		{
+			LoadTextureFile(FileName, MaxSize, AssetPackage, LoadedResource);
+		};
+
+		return EnqueueLoad(Name, TexturesLoads[Name], TextureHandle);
+	}
+
+	Concurrency::task<bool> FGameResource::LoadGeneratedTextureAsync(
+		FTextureDataSource TextureDataSource,
+		const std::string& Name,
+		D3D12_SRV_DIMENSION ViewDimension)
+	{
+		const auto TextureHandle = AddTexture(Name, std::wstring(), ViewDimension);
+
+		TexturesLoads[Name] = [TextureDataSource, Name](FLoadedResource* LoadedResource)
+		{
+			LoadedResource->TextureBytes = TextureDataSource();
+			LoadTextureLayout(LoadedResource->TextureBytes.data(), LoadedResource->TextureBytes.size(),
+				Name, 0, LoadedResource);
+		};
+
+		return EnqueueLoad(Name, TexturesLoads[Name], TextureHandle);
+	}
+
+	Concurrency::task<bool> FGameResource::StreamTextureAsync(const std::string& Name, uint32 MostDetailedMip)
+	{
+		const auto TextureHandleIter = TexturesHandles.find(Name);
+		const auto TextureHandle = TextureHandleIter != TexturesHandles.cend() ?
+			TextureHandleIter->second : FTextureHandle();
+		const auto TextureData = TexturesData.Find(TextureHandle);
+		if (TextureData == nullptr || TextureData->Resource == nullptr)
+		{
+			throw std::invalid_argument("Texture " + Name + " isn't uploaded");
 		}
 
-		auto StaticMeshesDataIter = StaticMeshesData.find(MeshName);
-		if (StaticMeshesDataIter != StaticMeshesData.end())
+		if (TextureData->FileName.empty())
 		{
-			throw std::invalid_argument("A mesh with the name " + MeshName + " exists yet");
+			throw std::invalid_argument("Texture " + Name + " is generated and can't be reloaded");
 		}
 
-		auto MeshData = std::make_unique<FMeshData>(MeshName);
+		if (MostDetailedMip >= TextureData->MipsSizes.size())
+		{
+			throw std::invalid_argument("Texture " + Name + " doesn't have mip " + std::to_string(MostDetailedMip));
+		}
 
-		uint16 NumVertices = 0;
-		uint64 NumIndices = 0;
-		
-		for (auto iMesh = 0; iMesh < SubmeshesData.size(); ++iMesh)
+		const auto bPending = std::any_of(PendingLoads.cbegin(), PendingLoads.cend(),
+			[TextureHandle](const FPendingLoad& PendingLoad)
 		{
-			auto MeshData = SubmeshesData[iMesh].get();
+			return PendingLoad.TextureHandle == TextureHandle;
+		});
 
-			NumVertices += MeshData->Vertices.size();
-			NumIndices += MeshData->Indices.size();
+		if (bPending)
+		{
+			throw std::invalid_argument("Texture " + Name + " is being loaded yet");
 		}
 
+		// Mips of the file are selected by their size
+		const auto MaxSize = std::max({ TextureData->Width >> MostDetailedMip, TextureData->Height >> MostDetailedMip, 1u });
 
-		std::vector<SVertexData> VerticesData;
-		std::vector<uint16> IndicesData;
+		const auto FileName = TextureData->FileName;
+		const auto AssetPackage = this->AssetPackage;
+		return EnqueueLoad(Name, [FileName, MaxSize, AssetPackage](FLoadedResource* LoadedResource)
+		{
+			LoadTextureFile(FileName, MaxSize, AssetPackage, LoadedResource);
+		}, TextureHandle);
+	}
 
-		VerticesData.resize(NumVertices);
-		IndicesData.reserve(NumIndices);
-		
-		auto VertexDataIter = VerticesData.cend();
-		auto IndexDataIter = IndicesData.cend();
+	FUploadedResources FGameResource::FlushUploads(ComPtr<ID3D12GraphicsCommandList> CMDList)
+	{
+		FUploadedResources UploadedResources;
+		if (PendingLoads.empty())
+		{
+			return UploadedResources;
+		}
 
-		auto NumFilledVertices = 0;
-		// Adding vertices and indices of every mesh to common arrays
-		for (auto iMesh = 0; iMesh < SubmeshesData.size(); ++iMesh)
+		for (auto PendingLoadIter = PendingLoads.begin(); PendingLoadIter != PendingLoads.end(); )
 		{
-			auto SubmeshRawData = SubmeshesData[iMesh].get();
-			
-			auto SubmeshData = std::make_unique<FSubmeshData>(SubmeshRawData->Name);
-			SubmeshData->VertexBegin = NumFilledVertices;
-			SubmeshData->IndexBegin = IndicesData.size();
-			SubmeshData->NumIndices = SubmeshRawData->Indices.size();
+			auto& PendingLoad = *PendingLoadIter;
+			if (!PendingLoad.Loaded.is_done())
+			{
+				++PendingLoadIter;
+				continue;
+			}
+
+			const auto LoadedResource = PendingLoad.Loaded.get();
+			LoadingStats.LoadSeconds += LoadedResource->LoadSeconds;
 
-			const auto VertexDataNewSize = NumFilledVertices + SubmeshRawData->Vertices.size();
+			auto bUploaded = false;
+			if (!LoadedResource->Error.empty())
+			{
+				DBOUT(PendingLoad.Name + " isn't loaded", LoadedResource->Error);
+			}
+			else if (PendingLoad.TextureHandle.IsValid())
+			{
+				// Streamed texture keeps its old resource if the new one isn't created
+				ComPtr<ID3D12Resource> Resource;
+				const auto TextureBytes = LoadedResource->TextureFileData != nullptr ?
+					LoadedResource->TextureFileData : LoadedResource->TextureBytes.data();
+				const auto Result = CreateDDSTextureFromLayout12(Device.Get(), CMDList.Get(),
+					TextureBytes, LoadedResource->TextureLayout, Resource, CreateTextureUploadAllocator(UploadHeap));
+
+				// Textures aren't removed while they're loaded
+				auto TextureData = &TexturesData.Get(PendingLoad.TextureHandle);
+				if (SUCCEEDED(Result))
+				{
+					if (TextureData->Resource != nullptr)
+					{
+						UploadedResources.RetiredResources.push_back(std::move(TextureData->Resource));
+					}
+
+					TextureData->Resource = std::move(Resource);
+					TextureData->Width = LoadedResource->TextureWidth;
+					TextureData->Height = LoadedResource->TextureHeight;
+					TextureData->MipsSizes = std::move(LoadedResource->TextureMipsSizes);
+					TextureData->MostDetailedMip = static_cast<uint32>(LoadedResource->TextureLayout.skipMip);
+
+					UploadedResources.TexturesHandles.push_back(PendingLoad.TextureHandle);
+					bUploaded = true;
+				}
+				else
+				{
+					DBOUT(PendingLoad.Name + " isn't loaded", "invalid texture data " << Result);
+				}
+			}
+			else
+			{
+				// The mesh isn't added if its buffers aren't created, so the load fails like an invalid file
+				try
+				{
+					if (LoadedResource->MeshFile != nullptr)
+					{
+						CreateStaticMesh(PendingLoad.Name, *LoadedResource->MeshFile, CMDList);
+					}
+					else
+					{
+						CreateStaticMesh(PendingLoad.Name, LoadedResource->BakedMesh.get(), CMDList);
+					}
+
+					UploadedResources.MeshesNames.push_back(PendingLoad.Name);
+					bUploaded = true;
+				}
+				catch (const std::exception& Exception)
+				{
+					DBOUT(PendingLoad.Name + " isn't loaded", Exception.what());
+				}
+			}
 
-			for (auto i = SubmeshData->VertexBegin; i < VertexDataNewSize; i++)
+			if (PendingLoad.TextureHandle.IsValid())
+			{
+				ResourceBudget.CompleteLoad(EResourceType::Texture, PendingLoad.Name, bUploaded, bUploaded ?
+					GetTextureFootprint(TexturesData.Get(PendingLoad.TextureHandle)) : FResourceFootprint());
+			}
+			else
 			{
-				const auto iVertex = i - SubmeshData->VertexBegin;
+				ResourceBudget.CompleteLoad(EResourceType::Mesh, PendingLoad.Name, bUploaded, bUploaded ?
+					GetMeshFootprint(GetMeshData(PendingLoad.Name)) : FResourceFootprint());
+			}
+
+			++(bUploaded ? LoadingStats.NumLoaded : LoadingStats.NumFailed);
+			LoadingStats.NumFromPackage += bUploaded && LoadedResource->bFromPackage ? 1 : 0;
+			PendingLoad.Uploaded.set(bUploaded);
+
+			PendingLoadIter = PendingLoads.erase(PendingLoadIter);
+		}
+
+		if (PendingLoads.empty())
+		{
+			const std::chrono::duration<double> WallTime = 
+				std::chrono::high_resolution_clock::now() - FirstPendingLoadTime;
+			LoadingStats.WallSeconds = WallTime.count();
+
+			DBOUT("Loads finished", LoadingStats.NumLoaded << " loaded (" << LoadingStats.NumFromPackage << 
+				" from package), " << LoadingStats.NumFailed << " failed in " <<
+				LoadingStats.WallSeconds << " s by " << LoadingWorkers.GetNumWorkers() << " workers, workers' time " << 
+				LoadingStats.LoadSeconds << " s");
+		}
+
+		return UploadedResources;
+	}
+
+	void FGameResource::WaitForLoads()
+	{
+		LoadingWorkers.Wait();
+	}
+
+	void FGameResource::SetNumLoadingWorkers(uint32 NumLoadingWorkers)
+	{
+		LoadingWorkers.SetNumWorkers(NumLoadingWorkers);
+	}
+
+	bool FGameResource::HasPendingLoads() const noexcept
+	{
+		return !PendingLoads.empty();
+	}
+
+	bool FGameResource::IsMeshReady(const std::string& MeshName) const
+	{
+		return StaticMeshesHandles.find(MeshName) != StaticMeshesHandles.cend();
+	}
+
+	const FLoadingStats& FGameResource::GetLoadingStats() const noexcept
+	{
+		return LoadingStats;
+	}
+
+	Concurrency::task<bool> FGameResource::EnqueueLoad(
+		const std::string& Name,
+		std::function<void(FLoadedResource*)> Load,
+		FTextureHandle TextureHandle)
+	{
+		if (PendingLoads.empty())
+		{
+			FirstPendingLoadTime = std::chrono::high_resolution_clock::now();
+			LoadingStats = FLoadingStats();
+		}
 
-				SVertexData Vertex = { 
-					SubmeshRawData->Vertices[iVertex].Position,
-					SubmeshRawData->Vertices[iVertex].Normal, 
-					SubmeshRawData->Vertices[iVertex].TexC 
-				};
+		// Resources are reloadable if they have stored loads
+		if (TextureHandle.IsValid())
+		{
+			ResourceBudget.BeginLoad(EResourceType::Texture, Name, TexturesLoads.find(Name) != TexturesLoads.cend());
+		}
+		else
+		{
+			ResourceBudget.BeginLoad(EResourceType::Mesh, Name, MeshesLoads.find(Name) != MeshesLoads.cend());
+		}
 
-				VerticesData[i] = std::move(Vertex);
+		Concurrency::task_completion_event<std::shared_ptr<FLoadedResource>> LoadedEvent;
+
+		FPendingLoad PendingLoad;
+		PendingLoad.Name = Name;
+		PendingLoad.TextureHandle = TextureHandle;
+		PendingLoad.Loaded = Concurrency::create_task(LoadedEvent);
+
+		auto UploadedTask = Concurrency::create_task(PendingLoad.Uploaded);
+		PendingLoads.push_back(std::move(PendingLoad));
+
+		LoadingWorkers.Enqueue([Load, LoadedEvent]()
+		{
+			const auto StartTime = std::chrono::high_resolution_clock::now();
+
+			// Errors are reported by FlushUploads on the owner's thread
+			auto LoadedResource = std::make_shared<FLoadedResource>();
+			try
+			{
+				Load(LoadedResource.get());
 			}
+			catch (const std::exception& Exception)
+			{
+				LoadedResource->Error = Exception.what();
+			}
+
+			const std::chrono::duration<double> LoadTime = 
+				std::chrono::high_resolution_clock::now() - StartTime;
+			LoadedResource->LoadSeconds = LoadTime.count();
+
+			LoadedEvent.set(LoadedResource);
+		});
+
+		return UploadedTask;
+	}
+
+	void FGameResource::LoadTextureFile(
+		const std::wstring& FileName,
+		uint32 MaxSize,
+		std::shared_ptr<const FAssetPackage> AssetPackage,
+		FLoadedResource* LoadedResource)
+	{
+		const auto Entry = AssetPackage != nullptr ? AssetPackage->FindEntry(FileName) : nullptr;
+		if (Entry != nullptr && Entry->Compression != EAssetCompression::None)
+		{
+			LoadedResource->TextureBytes = AssetPackage->ReadEntry(*Entry);
+			LoadTextureLayout(LoadedResource->TextureBytes.data(), LoadedResource->TextureBytes.size(),
+				"Entry " + AssetPackage->GetEntryName(*Entry), MaxSize, LoadedResource);
+			LoadedResource->bFromPackage = true;
+			return;
+		}
 
-			NumFilledVertices += SubmeshRawData->Vertices.size();
+		// Uncompressed entry is used as a mapped file, but nothing is opened
+		const uint8* Data = nullptr;
+		if (Entry != nullptr)
+		{
+			Data = AssetPackage->GetEntryData(*Entry);
+			LoadTextureLayout(Data, Entry->Size, "Entry " + AssetPackage->GetEntryName(*Entry), MaxSize, LoadedResource);
+
+			LoadedResource->TexturePackage = std::move(AssetPackage);
+			LoadedResource->bFromPackage = true;
+		}
+		else
+		{
+			auto File = std::make_unique<DX::FMappedFile>(FileName);
+			Data = File->GetData();
+			LoadTextureLayout(Data, File->GetSize(), "File " + File->GetFilePath(), MaxSize, LoadedResource);
 
-			const auto IndexDataNewSize = IndicesData.size() + SubmeshRawData->Indices.size();
-			
-			for (auto i = SubmeshData->IndexBegin; i < IndexDataNewSize; i++)
+			LoadedResource->TextureFile = std::move(File);
+		}
+
+		// Pages of subresources are touched here, so the upload doesn't wait for the disk
+		volatile uint8 PageByte = 0;
+		for (const auto& Subresource : LoadedResource->TextureLayout.subresources)
+		{
+			const auto SubresourceData = Data + Subresource.offset;
+			for (size_t Offset = 0; Offset < Subresource.slicePitch; Offset += 4096)
 			{
-				auto Index = SubmeshRawData->Indices[i - SubmeshData->IndexBegin];
-				
-				IndexDataIter = IndicesData.insert(IndexDataIter, std::move(Index));
-				IndexDataIter++;
+				PageByte = SubresourceData[Offset];
 			}
+		}
+
+		LoadedResource->TextureFileData = Data;
+	}
+
+	void FGameResource::LoadTextureLayout(
+		const uint8* Data,
+		uint64 Size,
+		const std::string& SourceName,
+		uint32 MaxSize,
+		FLoadedResource* LoadedResource)
+	{
+		const auto DataSize = static_cast<size_t>(Size);
 
-			MeshData->SubmeshesData.insert(std::make_pair(SubmeshRawData->Name, std::move(SubmeshData)));
+		DirectX::DDS_TEXTURE_LAYOUT FileLayout;
+		if (FAILED(DirectX::GetDDSTextureLayout(Data, DataSize, 0, FileLayout)))
+		{
+			throw std::invalid_argument(SourceName + " isn't a valid DDS texture");
 		}
 
-		// Create vertex buffer 
-		const auto VertexBufferSize = sizeof(SVertexData)*VerticesData.size();
+		LoadedResource->TextureWidth = static_cast<uint32>(FileLayout.width);
+		LoadedResource->TextureHeight = static_cast<uint32>(FileLayout.height);
 
-		MeshData->VertexBuffer = DX::CreateBuffer(Device, CMDList, 
-			VertexBufferSize, VerticesData.data(), MeshData->
-												  VertexUploadBuffer);
+		// Subresources are ordered by slices and then by mips
+		LoadedResource->TextureMipsSizes.assign(FileLayout.mipCount, 0);
+		for (size_t iSubresource = 0; iSubresource < FileLayout.subresources.size(); ++iSubresource)
+		{
+			const auto iMip = iSubresource % FileLayout.mipCount;
+			const auto MipDepth = std::max<size_t>(FileLayout.depth >> iMip, 1);
+			LoadedResource->TextureMipsSizes[iMip] += FileLayout.subresources[iSubresource].slicePitch*MipDepth;
+		}
 
-		CMDList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			MeshData->VertexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, 
-			D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER));
+		if (MaxSize == 0)
+		{
+			LoadedResource->TextureLayout = std::move(FileLayout);
+		}
+		else if (FAILED(DirectX::GetDDSTextureLayout(Data, DataSize, MaxSize, LoadedResource->TextureLayout)))
+		{
+			throw std::invalid_argument(SourceName + " isn't a valid DDS texture");
+		}
+	}
 
-		// Setup vertex buffer view
-		MeshData->VertexBufferView.BufferLocation = MeshData->VertexBuffer->GetGPUVirtualAddress();
-		MeshData->VertexBufferView.SizeInBytes = VertexBufferSize;
-		MeshData->VertexBufferView.StrideInBytes = sizeof(SVertexData);
+	void FGameResource::CheckMeshName(const std::string& MeshName) const
+	{
+		if (MeshName.empty())
+		{
+			throw std::invalid_argument("MeshName must be not empty");
+		}
 
-		// Create index buffer
-		const auto IndexBufferSize = sizeof(uint16)*IndicesData.size();
-		MeshData->IndexBuffer = DX::CreateBuffer(Device, CMDList,
-			IndexBufferSize, IndicesData.data(), MeshData->IndexUploadBuffer);
+		const auto bPending = std::any_of(PendingLoads.cbegin(), PendingLoads.cend(), 
+			[&MeshName](const FPendingLoad& PendingLoad)
+		{
+			return !PendingLoad.TextureHandle.IsValid() && PendingLoad.Name == MeshName;
+		});
 
-		CMDList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			MeshData->IndexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, 
-			D3D12_RESOURCE_STATE_INDEX_BUFFER));
+		if (bPending || StaticMeshesHandles.find(MeshName) != StaticMeshesHandles.cend())
+		{
+			throw std::invalid_argument("A mesh with the name " + MeshName + " exists yet");
+		}
+	}
 
-		// Setup index buffer view
-		MeshData->IndexBufferView.BufferLocation = MeshData->IndexBuffer->GetGPUVirtualAddress();
-		MeshData->IndexBufferView.SizeInBytes = IndexBufferSize;
-		MeshData->IndexBufferView.Format = DXGI_FORMAT_R16_UINT;
+	void FGameResource::CreateStaticMesh(
+		const std::string& MeshName,
+		FBakedMesh* BakedMesh,
+		ComPtr<ID3D12GraphicsCommandList> CMDList)
+	{
+		auto MeshData = std::make_unique<FMeshData>(MeshName);
+		MeshData->VertexFormat = BakedMesh->VertexFormat;
+		MeshData->VertexBufferView.StrideInBytes = BakedMesh->VertexStride;
+		MeshData->IndexBufferView.Format = BakedMesh->IndexFormat;
+
+		AddSubmeshes(std::move(BakedMesh->SubmeshesData), MeshData.get());
+
+		CreateBuffers(
+			BakedMesh->VerticesData.data(), BakedMesh->VerticesData.size(),
+			BakedMesh->IndicesData.data(), BakedMesh->IndicesData.size(),
+			MeshData.get(), CMDList);
+
+		AddStaticMesh(std::move(MeshData));
+	}
+
+	void FGameResource::CreateStaticMesh(
+		const std::string& MeshName,
+		const FMeshFile& MeshFile,
+		ComPtr<ID3D12GraphicsCommandList> CMDList)
+	{
+		const auto& Header = MeshFile.GetHeader();
+
+		auto MeshData = std::make_unique<FMeshData>(MeshName);
+		MeshData->VertexFormat = Header.VertexFormat;
+		MeshData->VertexBufferView.StrideInBytes = Header.VertexStride;
+		MeshData->IndexBufferView.Format = MeshFile.GetIndexFormat();
+
+		AddSubmeshes(MeshFile.CreateSubmeshesData(), MeshData.get());
+
+		// Buffers' content is copied to upload heaps right from the mapped file
+		CreateBuffers(
+			MeshFile.GetVerticesData(), Header.VerticesSize,
+			MeshFile.GetIndicesData(), Header.IndicesSize,
+			MeshData.get(), CMDList);
 
-		StaticMeshesData[MeshData->Name] = std::move(MeshData);
+		AddStaticMesh(std::move(MeshData));
 	}
 
 	void FGameResource::LoadBillboards(
@@ -147,77 +584,510 @@ namespace WoodenEngine
 			throw std::invalid_argument("MeshName must be not empty");
 		}
 
-		auto StaticMeshesDataIter = StaticMeshesData.find(MeshName);
-		if (StaticMeshesDataIter != StaticMeshesData.end())
+		if (StaticMeshesHandles.find(MeshName) != StaticMeshesHandles.cend())
 		{
 			throw std::invalid_argument("A mesh with the name " + MeshName + " exists yet");
 		}
 
 		auto MeshData = std::make_unique<FMeshData>(MeshName);
 
-		uint16_t NumVertices = VerticesData.size();
+		const auto NumVertices = VerticesData.size();
+		if (NumVertices > UINT32_MAX)
+		{
+			throw std::invalid_argument("Mesh " + MeshName + " has too many vertices");
+		}
 
-		std::vector<uint16_t> IndicesData;
-		IndicesData.resize(NumVertices);
+		std::vector<uint32> Indices;
+		Indices.resize(NumVertices);
 		
-		for (uint16_t i = 0; i < NumVertices; ++i)
+		for (uint32 i = 0; i < NumVertices; ++i)
 		{
-			IndicesData[i] = i;
+			Indices[i] = i;
 		}
+
+		std::vector<uint8> IndicesData;
+		MeshData->IndexBufferView.Format = FMeshBaker::PackIndices(Indices, &IndicesData);
+		MeshData->VertexBufferView.StrideInBytes = sizeof(SVertexBillboardData);
 		
 		auto SubmeshData = std::make_unique<FSubmeshData>(SubmeshName);
 		SubmeshData->NumIndices = NumVertices;
 		SubmeshData->IndexBegin = 0;
 		SubmeshData->VertexBegin = 0;
+		SubmeshData->NumVertices = static_cast<uint32>(NumVertices);
 
 		MeshData->SubmeshesData.insert(std::make_pair(SubmeshName, std::move(SubmeshData)));
 
-		// Create vertex buffer 
-		const auto VertexBufferSize = sizeof(SVertexBillboardData)*VerticesData.size();
+		CreateBuffers(
+			VerticesData.data(), sizeof(SVertexBillboardData)*VerticesData.size(),
+			IndicesData.data(), IndicesData.size(),
+			MeshData.get(), CMDList);
 
-		MeshData->VertexBuffer = DX::CreateBuffer(Device, CMDList,
-												  VertexBufferSize, VerticesData.data(), MeshData->
-												  VertexUploadBuffer);
+		ResourceBudget.AddResource(EResourceType::Mesh, MeshName, GetMeshFootprint(*MeshData), false);
+		AddStaticMesh(std::move(MeshData));
+	}
 
-		CMDList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			MeshData->VertexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST,
-			D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER));
+	void FGameResource::AddStaticMesh(std::unique_ptr<FMeshData> MeshData)
+	{
+		const auto MeshName = MeshData->Name;
+		const auto MeshHandle = StaticMeshesData.Create(std::move(*MeshData));
+		StaticMeshesHandles[MeshName] = MeshHandle;
 
-		// Setup vertex buffer view
-		MeshData->VertexBufferView.BufferLocation = MeshData->VertexBuffer->GetGPUVirtualAddress();
-		MeshData->VertexBufferView.SizeInBytes = VertexBufferSize;
-		MeshData->VertexBufferView.StrideInBytes = sizeof(SVertexBillboardData);
+		SubmeshRegistry.ResolveMesh(MeshHandle, StaticMeshesData.Get(MeshHandle), MaterialsHandles);
+	}
+
+	std::vector<ComPtr<ID3D12Resource>> FGameResource::RemoveStaticMesh(const std::string& MeshName)
+	{
+		auto RetiredResources = DestroyStaticMesh(MeshName);
+
+		ResourceBudget.RemoveResource(EResourceType::Mesh, MeshName);
+		MeshesLoads.erase(MeshName);
+
+		return RetiredResources;
+	}
+
+	std::vector<ComPtr<ID3D12Resource>> FGameResource::DestroyStaticMesh(const std::string& MeshName)
+	{
+		const auto MeshHandleIter = StaticMeshesHandles.find(MeshName);
+		if (MeshHandleIter == StaticMeshesHandles.end())
+		{
+			throw std::invalid_argument("Hasn't found any mesh data with name - " + MeshName);
+		}
+
+		const auto MeshHandle = MeshHandleIter->second;
+		SubmeshRegistry.ResetMesh(MeshHandle);
+
+		// Freed ranges are reused by next uploads, which are executed after frames in flight
+		const auto& MeshData = StaticMeshesData.Get(MeshHandle);
+		const auto VertexPage = GeometryArena.Free(MeshData.VertexAllocation);
+		const auto IndexPage = GeometryArena.Free(MeshData.IndexAllocation);
+
+		std::vector<ComPtr<ID3D12Resource>> RetiredResources;
+		for (auto Resource : { VertexPage, IndexPage })
+		{
+			if (Resource != nullptr)
+			{
+				RetiredResources.push_back(std::move(Resource));
+			}
+		}
 
-		// Create index buffer
-		const auto IndexBufferSize = sizeof(uint16)*IndicesData.size();
-		MeshData->IndexBuffer = DX::CreateBuffer(Device, CMDList,
-												 IndexBufferSize, IndicesData.data(), MeshData->IndexUploadBuffer);
+		StaticMeshesData.Destroy(MeshHandle);
+		StaticMeshesHandles.erase(MeshHandleIter);
 
-		CMDList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
-			MeshData->IndexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST,
-			D3D12_RESOURCE_STATE_INDEX_BUFFER));
+		return RetiredResources;
+	}
+
+	void FGameResource::AddSubmeshes(
+		std::vector<std::unique_ptr<FSubmeshData>>&& SubmeshesData,
+		FMeshData* MeshData) const
+	{
+		for (auto& SubmeshData : SubmeshesData)
+		{
+			auto SubmeshName = SubmeshData->Name;
+			MeshData->SubmeshesData.insert(std::make_pair(SubmeshName, std::move(SubmeshData)));
+		}
 
-		// Setup index buffer view
-		MeshData->IndexBufferView.BufferLocation = MeshData->IndexBuffer->GetGPUVirtualAddress();
-		MeshData->IndexBufferView.SizeInBytes = IndexBufferSize;
-		MeshData->IndexBufferView.Format = DXGI_FORMAT_R16_UINT;
+		// Link simplified submeshes "<Name>_lod<i>" to their source submesh
+		for (auto& SubmeshDataIter : MeshData->SubmeshesData)
+		{
+			auto& SubmeshData = *SubmeshDataIter.second;
+			for (auto iLOD = 1; ; ++iLOD)
+			{
+				const auto LODIter = MeshData->SubmeshesData.find(SubmeshData.Name + "_lod" + std::to_string(iLOD));
+				if (LODIter == MeshData->SubmeshesData.end())
+				{
+					break;
+				}
 
-		StaticMeshesData[MeshData->Name] = std::move(MeshData);
+				SubmeshData.LODs.push_back(LODIter->second.get());
+			}
+		}
 	}
 
-	void FGameResource::AddMaterial(std::unique_ptr<FMaterialData> MaterialData)
+	void FGameResource::CreateBuffers(
+		const void* VerticesData,
+		uint64 VerticesSize,
+		const void* IndicesData,
+		uint64 IndicesSize,
+		FMeshData* MeshData,
+		ComPtr<ID3D12GraphicsCommandList> CMDList)
+	{
+		if (VerticesSize > UINT32_MAX)
+		{
+			throw std::invalid_argument("Vertex buffer of mesh " + MeshData->Name + " is bigger than 4GB");
+		}
+
+		if (IndicesSize > UINT32_MAX)
+		{
+			throw std::invalid_argument("Index buffer of mesh " + MeshData->Name + " is bigger than 4GB");
+		}
+
+		const auto VertexStride = MeshData->VertexBufferView.StrideInBytes;
+		if (VertexStride == 0 || VerticesSize % VertexStride != 0)
+		{
+			throw std::invalid_argument("Vertex buffer of mesh " + MeshData->Name + " isn't a whole number of vertices");
+		}
+
+		const uint32 IndexSize = MeshData->IndexBufferView.Format == DXGI_FORMAT_R16_UINT ? 2 : 4;
+		if (IndicesSize % IndexSize != 0)
+		{
+			throw std::invalid_argument("Index buffer of mesh " + MeshData->Name + " isn't a whole number of indices");
+		}
+
+		// Checked before the vertices are allocated, so a failed mesh doesn't keep its vertex range
+		if (VerticesSize == 0 || IndicesSize == 0)
+		{
+			throw std::invalid_argument("Mesh " + MeshData->Name + " has no vertices or indices");
+		}
+
+		// Vertices and indices are suballocated, so meshes don't have their own buffers
+		MeshData->VertexAllocation = GeometryArena.Allocate(EGeometryBufferType::Vertex, VertexStride,
+			static_cast<uint32>(VerticesSize / VertexStride), VerticesData, CMDList, UploadHeap);
+
+		MeshData->IndexAllocation = GeometryArena.Allocate(EGeometryBufferType::Index, IndexSize,
+			static_cast<uint32>(IndicesSize / IndexSize), IndicesData, CMDList, UploadHeap);
+
+		UpdateGeometryLocations(MeshData);
+	}
+
+	void FGameResource::UpdateGeometryLocations(FMeshData* MeshData) const
+	{
+		const auto VertexLocation = GeometryArena.GetLocation(MeshData->VertexAllocation);
+		MeshData->VertexBufferView.BufferLocation = VertexLocation.BufferLocation;
+		MeshData->VertexBufferView.SizeInBytes = VertexLocation.BufferSize;
+		MeshData->BaseVertexLocation = VertexLocation.FirstElement;
+
+		const auto IndexLocation = GeometryArena.GetLocation(MeshData->IndexAllocation);
+		MeshData->IndexBufferView.BufferLocation = IndexLocation.BufferLocation;
+		MeshData->IndexBufferView.SizeInBytes = IndexLocation.BufferSize;
+		MeshData->StartIndexLocation = IndexLocation.FirstElement;
+	}
+
+	FResourceFootprint FGameResource::GetMeshFootprint(const FMeshData& MeshData) const
+	{
+		FResourceFootprint Footprint;
+		Footprint[EResourceMemory::GPUBuffers] =
+			GeometryArena.GetLocation(MeshData.VertexAllocation).RangeSize +
+			GeometryArena.GetLocation(MeshData.IndexAllocation).RangeSize;
+
+		auto CPUBytes = static_cast<uint64>(sizeof(FMeshData));
+		for (const auto& SubmeshDataIter : MeshData.SubmeshesData)
+		{
+			const auto& SubmeshData = *SubmeshDataIter.second;
+			CPUBytes += sizeof(FSubmeshData) + SubmeshData.Meshlets.size()*sizeof(FMeshlet) +
+				SubmeshData.LODs.size()*sizeof(const FSubmeshData*);
+		}
+		Footprint[EResourceMemory::CPU] = CPUBytes;
+
+		return Footprint;
+	}
+
+	FResourceFootprint FGameResource::GetTextureFootprint(const FTextureData& TextureData) const
+	{
+		FResourceFootprint Footprint;
+		Footprint[EResourceMemory::CPU] = sizeof(FTextureData) + TextureData.MipsSizes.size()*sizeof(uint64);
+
+		// Placed size of the resource with its alignment and padding
+		if (TextureData.Resource != nullptr)
+		{
+			const auto ResourceDesc = TextureData.Resource->GetDesc();
+			Footprint[EResourceMemory::Textures] = Device->GetResourceAllocationInfo(0, 1, &ResourceDesc).SizeInBytes;
+		}
+
+		return Footprint;
+	}
+
+	std::vector<ComPtr<ID3D12Resource>> FGameResource::DefragmentGeometry(
+		ComPtr<ID3D12GraphicsCommandList> CMDList,
+		float MinFragmentation)
+	{
+		auto RetiredResources = GeometryArena.Defragment(CMDList, MinFragmentation);
+		if (!RetiredResources.empty())
+		{
+			for (auto& MeshData : StaticMeshesData)
+			{
+				UpdateGeometryLocations(&MeshData);
+			}
+		}
+
+		return RetiredResources;
+	}
+
+	FGeometryArenaStats FGameResource::GetGeometryStats() const
+	{
+		return GeometryArena.GetStats();
+	}
+
+	void FGameResource::SubmitUploads(uint64 FenceValue)
+	{
+		UploadHeap.Submit(FenceValue);
+	}
+
+	void FGameResource::ReclaimUploads(uint64 CompletedFenceValue)
+	{
+		UploadHeap.Reclaim(CompletedFenceValue);
+	}
+
+	void FGameResource::RetireResources(std::vector<ComPtr<ID3D12Resource>> Resources)
+	{
+		UploadHeap.Retire(std::move(Resources));
+	}
+
+	FUploadHeapStats FGameResource::GetUploadStats() const
+	{
+		return UploadHeap.GetStats();
+	}
+
+	void FGameResource::ReferenceSubmesh(FSubmeshHandle SubmeshHandle, bool bReference)
+	{
+		if (!SubmeshHandle.IsValid() || SubmeshHandle.Index >= SubmeshRegistry.GetNumSlots())
+		{
+			return;
+		}
+
+		if (SubmeshesSlotsReferences.size() < SubmeshRegistry.GetNumSlots())
+		{
+			SubmeshesSlotsReferences.resize(SubmeshRegistry.GetNumSlots(), 0);
+		}
+
+		// The budget counts referenced slots of the mesh, so names are read on first and last references only
+		auto& NumReferences = SubmeshesSlotsReferences[SubmeshHandle.Index];
+		const auto& MeshName = SubmeshRegistry.GetNames(SubmeshHandle).first;
+		if (bReference)
+		{
+			if (NumReferences++ == 0)
+			{
+				ResourceBudget.AddReference(EResourceType::Mesh, MeshName);
+			}
+		}
+		else if (NumReferences > 0 && --NumReferences == 0)
+		{
+			ResourceBudget.ReleaseReference(EResourceType::Mesh, MeshName);
+		}
+	}
+
+	void FGameResource::ReferenceMaterial(FMaterialHandle MaterialHandle, bool bReference)
+	{
+		const auto Key = (uint64(MaterialHandle.Generation) << 32) | MaterialHandle.Index;
+		if (!bReference)
+		{
+			const auto MaterialReferencesIter = MaterialsReferences.find(Key);
+			if (MaterialReferencesIter == MaterialsReferences.end())
+			{
+				return;
+			}
+
+			auto& MaterialReferences = MaterialReferencesIter->second;
+			if (--MaterialReferences.NumReferences == 0)
+			{
+				if (ResourceBudget.ReleaseReference(EResourceType::Material, MaterialReferences.Name) == 0)
+				{
+					ReferenceMaterialTexture(MaterialReferences.Name, false);
+				}
+				MaterialsReferences.erase(MaterialReferencesIter);
+			}
+			return;
+		}
+
+		auto MaterialReferencesIter = MaterialsReferences.find(Key);
+		if (MaterialReferencesIter == MaterialsReferences.end())
+		{
+			const auto MaterialData = MaterialsData.Find(MaterialHandle);
+			if (MaterialData == nullptr)
+			{
+				return;
+			}
+
+			MaterialReferencesIter = MaterialsReferences.emplace(Key, FMaterialReferences()).first;
+			MaterialReferencesIter->second.Name = MaterialData->Name;
+		}
+
+		auto& MaterialReferences = MaterialReferencesIter->second;
+		if (MaterialReferences.NumReferences++ == 0 &&
+			ResourceBudget.AddReference(EResourceType::Material, MaterialReferences.Name) == 1)
+		{
+			ReferenceMaterialTexture(MaterialReferences.Name, true);
+		}
+	}
+
+	FResidencyUpdate FGameResource::UpdateResidency(uint64 Frame)
+	{
+		FResidencyUpdate ResidencyUpdate;
+		for (const auto& Request : ResourceBudget.Update(Frame))
+		{
+			// Only resources with stored loads are reloadable, so only they're requested
+			if (Request.Type == EResourceType::Mesh)
+			{
+				if (!Request.bEvict)
+				{
+					EnqueueLoad(Request.Name, MeshesLoads.at(Request.Name));
+					continue;
+				}
+
+				// Handles of the mesh's submeshes stay interned and are resolved again by its reload
+				for (auto& Resource : DestroyStaticMesh(Request.Name))
+				{
+					ResidencyUpdate.RetiredResources.push_back(std::move(Resource));
+				}
+
+				ResidencyUpdate.EvictedMeshesNames.push_back(Request.Name);
+			}
+			else if (Request.Type == EResourceType::Texture)
+			{
+				const auto TextureHandle = TexturesHandles.at(Request.Name);
+				if (!Request.bEvict)
+				{
+					EnqueueLoad(Request.Name, TexturesLoads.at(Request.Name), TextureHandle);
+					continue;
+				}
+
+				// Texture data is kept, so materials' handles stay valid
+				auto& TextureData = TexturesData.Get(TextureHandle);
+				ResidencyUpdate.RetiredResources.push_back(std::move(TextureData.Resource));
+
+				ResidencyUpdate.EvictedTexturesHandles.push_back(TextureHandle);
+			}
+		}
+
+		return ResidencyUpdate;
+	}
+
+	void FGameResource::SetResourceBudget(uint64 BudgetBytes) noexcept
+	{
+		ResourceBudget.SetBudget(BudgetBytes);
+	}
+
+	FResourceBudgetStats FGameResource::GetResourceBudgetStats() const noexcept
+	{
+		return ResourceBudget.GetStats();
+	}
+
+	void FGameResource::ReferenceMaterialTexture(const std::string& MaterialName, bool bReference)
+	{
+		if (!bReference)
+		{
+			const auto MaterialTextureIter = MaterialsTextures.find(MaterialName);
+			if (MaterialTextureIter != MaterialsTextures.end())
+			{
+				ResourceBudget.ReleaseReference(EResourceType::Texture, MaterialTextureIter->second);
+				MaterialsTextures.erase(MaterialTextureIter);
+			}
+			return;
+		}
+
+		// The texture is remembered, since the material may refer another one by its release
+		const auto MaterialHandleIter = MaterialsHandles.find(MaterialName);
+		const auto MaterialData = MaterialHandleIter != MaterialsHandles.cend() ?
+			MaterialsData.Find(MaterialHandleIter->second) : nullptr;
+		const auto TextureData = MaterialData != nullptr ? TexturesData.Find(MaterialData->DiffuseTexture) : nullptr;
+		if (TextureData != nullptr)
+		{
+			ResourceBudget.AddReference(EResourceType::Texture, TextureData->Name);
+			MaterialsTextures[MaterialName] = TextureData->Name;
+		}
+	}
+
+	FMaterialHandle FGameResource::AddMaterial(std::unique_ptr<FMaterialData> MaterialData)
 	{
 		if (MaterialData->Name.empty())
 		{
 			throw std::invalid_argument("Material's name must be not empty");
 		}
 
-		if (MaterialsData.find(MaterialData->Name) != MaterialsData.end())
+		if (MaterialsHandles.find(MaterialData->Name) != MaterialsHandles.end())
 		{
 			throw std::invalid_argument("A material with the same name exists");
 		}
 
-		MaterialsData[MaterialData->Name] = std::move(MaterialData);
+		const auto MaterialName = MaterialData->Name;
+		const auto MaterialHandle = MaterialsData.Create(std::move(*MaterialData));
+		MaterialsHandles[MaterialName] = MaterialHandle;
+
+		FResourceFootprint Footprint;
+		Footprint[EResourceMemory::CPU] = sizeof(FMaterialData);
+		ResourceBudget.AddResource(EResourceType::Material, MaterialName, Footprint, false);
+
+		// Objects may refer the name of a removed material
+		if (ResourceBudget.GetNumReferences(EResourceType::Material, MaterialName) > 0)
+		{
+			ReferenceMaterialTexture(MaterialName, true);
+		}
+
+		return MaterialHandle;
+	}
+
+	void FGameResource::RemoveMaterial(FMaterialHandle MaterialHandle)
+	{
+		const auto MaterialData = MaterialsData.Find(MaterialHandle);
+		if (MaterialData == nullptr)
+		{
+			throw std::invalid_argument("Material is removed yet");
+		}
+
+		ReferenceMaterialTexture(MaterialData->Name, false);
+		ResourceBudget.RemoveResource(EResourceType::Material, MaterialData->Name);
+
+		MaterialsHandles.erase(MaterialData->Name);
+		MaterialsData.Destroy(MaterialHandle);
+	}
+
+	std::vector<ComPtr<ID3D12Resource>> FGameResource::RemoveTexture(FTextureHandle TextureHandle)
+	{
+		const auto TextureData = TexturesData.Find(TextureHandle);
+		if (TextureData == nullptr)
+		{
+			throw std::invalid_argument("Texture is removed yet");
+		}
+
+		const auto bPending = std::any_of(PendingLoads.cbegin(), PendingLoads.cend(),
+			[TextureHandle](const FPendingLoad& PendingLoad)
+		{
+			return PendingLoad.TextureHandle == TextureHandle;
+		});
+
+		if (bPending)
+		{
+			throw std::invalid_argument("Texture " + TextureData->Name + " is being loaded yet");
+		}
+
+		std::vector<ComPtr<ID3D12Resource>> RetiredResources;
+		if (TextureData->Resource != nullptr)
+		{
+			RetiredResources.push_back(std::move(TextureData->Resource));
+		}
+
+		ResourceBudget.RemoveResource(EResourceType::Texture, TextureData->Name);
+		TexturesLoads.erase(TextureData->Name);
+
+		TexturesHandles.erase(TextureData->Name);
+		TexturesData.Destroy(TextureHandle);
+
+		return RetiredResources;
+	}
+
+	FTextureHandle FGameResource::AddTexture(
+		const std::string& Name,
+		const std::wstring& FileName,
+		D3D12_SRV_DIMENSION ViewDimension)
+	{
+		if (Name.empty())
+		{
+			throw std::invalid_argument("Name must be not empty");
+		}
+
+		if (TexturesHandles.find(Name) != TexturesHandles.cend())
+		{
+			throw std::invalid_argument("A texture with same name exists");
+		}
+
+		const auto TextureHandle = TexturesData.Create();
+		auto& TextureData = TexturesData.Get(TextureHandle);
+		TextureData.Name = Name;
+		TextureData.FileName = FileName;
+		TextureData.ViewDimension = ViewDimension;
+
+		TexturesHandles[Name] = TextureHandle;
+
+		return TextureHandle;
 	}
 
 	void FGameResource::LoadTexture(
@@ -236,20 +1106,47 @@ namespace WoodenEngine
 			throw std::invalid_argument("Name must be not empty");
 		}
 
-		if (TexturesData.find(Name) != TexturesData.cend())
+		if (TexturesHandles.find(Name) != TexturesHandles.cend())
 		{
 			throw std::invalid_argument("A texture with same name exists");
 		}
 
-		auto Texture = std::make_unique<FTextureData>();
-		DX::ThrowIfFailed(CreateDDSTextureFromFile12(Device.Get(), CmdList.Get(), FileName.c_str(), 
-			Texture->Resource, Texture->UploadResource));
+		ComPtr<ID3D12Resource> Resource;
+		const auto UploadAllocator = CreateTextureUploadAllocator(UploadHeap);
+		const auto Entry = AssetPackage != nullptr ? AssetPackage->FindEntry(FileName) : nullptr;
+		if (Entry != nullptr)
+		{
+			const auto Data = Entry->Compression == EAssetCompression::None ?
+				std::vector<uint8>() : AssetPackage->ReadEntry(*Entry);
+			const auto TextureBytes = Data.empty() ? AssetPackage->GetEntryData(*Entry) : Data.data();
+			DX::ThrowIfFailed(CreateDDSTextureFromMemory12(Device.Get(), CmdList.Get(), 
+				TextureBytes, static_cast<size_t>(Entry->UncompressedSize), Resource, UploadAllocator));
+		}
+		else
+		{
+			DX::ThrowIfFailed(CreateDDSTextureFromFile12(Device.Get(), CmdList.Get(), FileName.c_str(), 
+				Resource, UploadAllocator));
+		}
+
+		auto& TextureData = TexturesData.Get(AddTexture(Name, FileName, ViewDimension));
+		TextureData.Resource = std::move(Resource);
+
+		ResourceBudget.AddResource(EResourceType::Texture, Name, GetTextureFootprint(TextureData), false);
+	}
 
-		Texture->Name = Name;
-		Texture->FileName = FileName;
-		Texture->ViewDimension = ViewDimension;
+	void FGameResource::SetOptimizeMeshesOverdraw(bool bOptimizeOverdraw) noexcept
+	{
+		bOptimizeMeshesOverdraw = bOptimizeOverdraw;
+	}
+
+	void FGameResource::SetAssetPackage(std::shared_ptr<const FAssetPackage> AssetPackage)
+	{
+		this->AssetPackage = std::move(AssetPackage);
+	}
 
-		TexturesData[Texture->Name] = std::move(Texture);
+	void FGameResource::SetMeshesWeldSettings(const FWeldSettings& WeldSettings) noexcept
+	{
+		MeshesWeldSettings = WeldSettings;
 	}
 
 	void FGameResource::SetDevice(ComPtr<ID3D12Device> Device)
@@ -260,26 +1157,38 @@ namespace WoodenEngine
 		}
 
 		this->Device = Device;
+		UploadHeap.SetDevice(Device);
+		GeometryArena.SetDevice(Device);
 	}
 
 	uint64 FGameResource::GetMaterialConstBufferIndex(const std::string& MaterialName) const
 	{
-		auto MaterialDataIter = MaterialsData.find(MaterialName);
-		if (MaterialDataIter == MaterialsData.cend())
-		{
-			throw std::invalid_argument("Hasn't found any material data with name - " + MaterialName);
-		}
-		return MaterialDataIter->second->iConstBuffer;
+		return MaterialsData.Get(GetMaterialHandle(MaterialName)).iConstBuffer;
+	}
+
+	FMaterialData* FGameResource::GetMaterialData(const std::string& MaterialName)
+	{
+		return &MaterialsData.Get(GetMaterialHandle(MaterialName));
 	}
 
-	FMaterialData* FGameResource::GetMaterialData(const std::string& MaterialName) const
+	FMaterialHandle FGameResource::GetMaterialHandle(const std::string& MaterialName) const
 	{
-		auto MaterialDataIter = MaterialsData.find(MaterialName);
-		if (MaterialDataIter == MaterialsData.cend())
+		auto MaterialHandleIter = MaterialsHandles.find(MaterialName);
+		if (MaterialHandleIter == MaterialsHandles.cend())
 		{
 			throw std::invalid_argument("Hasn't found any material data with name - " + MaterialName);
 		}
-		return MaterialDataIter->second.get();
+		return MaterialHandleIter->second;
+	}
+
+	const FMaterialData* FGameResource::GetMaterialData(FMaterialHandle MaterialHandle) const noexcept
+	{
+		return MaterialsData.Find(MaterialHandle);
+	}
+
+	FMaterialData* FGameResource::GetMaterialData(FMaterialHandle MaterialHandle) noexcept
+	{
+		return MaterialsData.Find(MaterialHandle);
 	}
 
 	const FSubmeshData& FGameResource::GetSubmeshData(
@@ -300,18 +1209,71 @@ namespace WoodenEngine
 
 	const FMeshData& FGameResource::GetMeshData(const std::string& MeshName) const
 	{
-		auto MeshDataIter = StaticMeshesData.find(MeshName);
-		if (MeshDataIter == StaticMeshesData.cend())
+		auto MeshHandleIter = StaticMeshesHandles.find(MeshName);
+		if (MeshHandleIter == StaticMeshesHandles.cend())
 		{
 			throw std::invalid_argument("Hasn't found any mesh data with name - " + MeshName);
 		}
 
-		return *MeshDataIter->second;
+		return StaticMeshesData.Get(MeshHandleIter->second);
+	}
+
+	FSubmeshHandle FGameResource::GetSubmeshHandle(const std::string& MeshName, const std::string& SubmeshName)
+	{
+		auto SubmeshHandle = SubmeshRegistry.FindHandle(MeshName, SubmeshName);
+		if (SubmeshHandle.IsValid())
+		{
+			return SubmeshHandle;
+		}
+
+		// The uploaded mesh must have the submesh, otherwise names aren't interned
+		const auto MeshHandleIter = StaticMeshesHandles.find(MeshName);
+		const auto SubmeshData = MeshHandleIter != StaticMeshesHandles.cend() ?
+			&GetSubmeshData(MeshName, SubmeshName) : nullptr;
+
+		SubmeshHandle = SubmeshRegistry.AddHandle(MeshName, SubmeshName);
+		if (SubmeshData != nullptr)
+		{
+			SubmeshRegistry.ResolveSlot(SubmeshHandle, MeshHandleIter->second, *SubmeshData, MaterialsHandles);
+		}
+
+		return SubmeshHandle;
+	}
+
+	bool FGameResource::IsSubmeshReady(FSubmeshHandle SubmeshHandle) const noexcept
+	{
+		return SubmeshRegistry.IsReady(SubmeshHandle);
+	}
+
+	const FMeshData* FGameResource::GetMeshData(FSubmeshHandle SubmeshHandle) const noexcept
+	{
+		// Slots are reset when their meshes are removed or evicted, so stale mesh handles aren't looked up
+		if (!SubmeshRegistry.IsReady(SubmeshHandle))
+		{
+			return nullptr;
+		}
+
+		return StaticMeshesData.Find(SubmeshRegistry.GetSlot(SubmeshHandle).MeshHandle);
+	}
+
+	const FSubmeshData* FGameResource::GetSubmeshData(FSubmeshHandle SubmeshHandle) const noexcept
+	{
+		return SubmeshRegistry.IsReady(SubmeshHandle) ? SubmeshRegistry.GetSlot(SubmeshHandle).SubmeshData : nullptr;
+	}
+
+	FMaterialHandle FGameResource::GetSubmeshMaterialHandle(FSubmeshHandle SubmeshHandle) const noexcept
+	{
+		return SubmeshRegistry.IsReady(SubmeshHandle) ? SubmeshRegistry.GetSlot(SubmeshHandle).MaterialHandle : FMaterialHandle();
 	}
 
 	uint64 FGameResource::GetNumMaterials() const noexcept
 	{
-		return MaterialsData.size();
+		return MaterialsData.GetNumValues();
+	}
+
+	FGameResource::FMaterialsData& FGameResource::GetMaterialsData() noexcept
+	{
+		return MaterialsData;
 	}
 
 	const FGameResource::FMaterialsData& FGameResource::GetMaterialsData() const noexcept
@@ -319,6 +1281,11 @@ namespace WoodenEngine
 		return MaterialsData;
 	}
 
+	FGameResource::FTexturesData& FGameResource::GetTexturesData() noexcept
+	{
+		return TexturesData;
+	}
+
 	const WoodenEngine::FGameResource::FTexturesData& FGameResource::GetTexturesData() const noexcept
 	{
 		return TexturesData;
@@ -326,17 +1293,32 @@ namespace WoodenEngine
 
 	const FTextureData* FGameResource::GetTextureData(const std::string& Name) const
 	{
-		auto TextureDataIter = TexturesData.find(Name);
-		if (TextureDataIter == TexturesData.cend())
+		return &TexturesData.Get(GetTextureHandle(Name));
+	}
+
+	FTextureHandle FGameResource::GetTextureHandle(const std::string& Name) const
+	{
+		auto TextureHandleIter = TexturesHandles.find(Name);
+		if (TextureHandleIter == TexturesHandles.cend())
 		{
 			throw std::invalid_argument("Texture with name " + Name + " doesn't exist");
 		}
 
-		return TextureDataIter->second.get();
+		return TextureHandleIter->second;
+	}
+
+	const FTextureData* FGameResource::GetTextureData(FTextureHandle TextureHandle) const noexcept
+	{
+		return TexturesData.Find(TextureHandle);
+	}
+
+	bool FGameResource::HasTexture(const std::string& Name) const noexcept
+	{
+		return TexturesHandles.find(Name) != TexturesHandles.cend();
 	}
 
 	const uint32 FGameResource::GetNumTexturesData() const noexcept
 	{
-		return TexturesData.size();
+		return TexturesData.GetNumValues();
 	}
 }
\ No newline at end of file
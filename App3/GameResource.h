@@ -1,17 +1,102 @@
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <ppltasks.h>
 #include <string>
 #include <unordered_map>
 
 #include "ShaderStructures.h"
+#include "AssetPackage.h"
+#include "GeometryArena.h"
+#include "LoadingWorkers.h"
 #include "MeshData.h"
+#include "MeshWelder.h"
 #include "BillboardData.h"
 #include "MaterialData.h"
+#include "ResourceBudget.h"
+#include "ResourcePool.h"
+#include "SubmeshRegistry.h"
 #include "TextureData.h"
+#include "UploadHeap.h"
+#include "Common/DDSLayout.h"
+#include "Common/MappedFile.h"
 
 namespace WoodenEngine
 {
+	class FMeshFile;
+	struct FBakedMesh;
+
+	// Produces submeshes of a static mesh on a loading worker
+	using FSubmeshesDataSource = std::function<std::vector<std::unique_ptr<FMeshRawData>>()>;
+
+	// Returns path of a baked mesh file on a loading worker. The file may be converted by it on a cache miss
+	using FMeshFileSource = std::function<std::string()>;
+
+	// Produces a whole DDS file of a generated texture on a loading worker
+	using FTextureDataSource = std::function<std::vector<uint8>()>;
+
+	/*!
+	 * \struct FUploadedResources
+	 *
+	 * \brief Resources whose upload was recorded by FGameResource::FlushUploads
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FUploadedResources
+	{
+		std::vector<std::string> MeshesNames;
+
+		// Their views must be created by the renderer
+		std::vector<FTextureHandle> TexturesHandles;
+
+		// Replaced resources of streamed textures. Frames in flight may use them
+		std::vector<ComPtr<ID3D12Resource>> RetiredResources;
+	};
+
+	/*!
+	 * \struct FResidencyUpdate
+	 *
+	 * \brief Resources evicted by FGameResource::UpdateResidency. Reloads of evicted ones are uploaded by FlushUploads
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FResidencyUpdate
+	{
+		std::vector<std::string> EvictedMeshesNames;
+
+		// Their data is kept without resources, so their views must be created by the renderer again
+		std::vector<FTextureHandle> EvictedTexturesHandles;
+
+		// Frames in flight and views of evicted textures may use them, so they're retired by the fence
+		std::vector<ComPtr<ID3D12Resource>> RetiredResources;
+	};
+
+	/*!
+	 * \struct FLoadingStats
+	 *
+	 * \brief Statistics of asynchronous loading
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FLoadingStats
+	{
+		uint32 NumLoaded = 0;
+		uint32 NumFailed = 0;
+
+		// Loads served from the asset package instead of loose files
+		uint32 NumFromPackage = 0;
+
+		// Sum of reading and decoding time of all workers
+		double LoadSeconds = 0.0;
+
+		// Time from the first request to the last upload of the current batch of loads
+		double WallSeconds = 0.0;
+	};
 
 	/*!
 	 * \class FGameResources
@@ -24,14 +109,11 @@ namespace WoodenEngine
 	class FGameResource
 	{
 	public:
-		using FMaterialsData =
-			std::unordered_map<std::string, std::unique_ptr<FMaterialData>>;
+		using FMaterialsData = FResourcePool<FMaterialData>;
 
-		using FMeshesData =
-			std::unordered_map<std::string, std::unique_ptr<FMeshData>>;
+		using FMeshesData = FResourcePool<FMeshData>;
 
-		using FTexturesData =
-			std::unordered_map<std::string, std::unique_ptr<FTextureData>>;
+		using FTexturesData = FResourcePool<FTextureData>;
 
 		FGameResource();
 		FGameResource(ComPtr<ID3D12Device> Device);
@@ -41,6 +123,163 @@ namespace WoodenEngine
 		FGameResource(const FGameResource& GameResources) = delete;
 		FGameResource(FGameResource&& GameResources) = delete;
 
+		/** @brief Requests loading of a static mesh. Its submeshes are produced and baked by a loading worker,
+		  * buffers are created by FlushUploads. The mesh isn't accessible until then
+		  * @param SubmeshesDataSource Is called by the worker (FSubmeshesDataSource)
+		  * @param MeshName (const std::string &)
+		  * @param VertexFormat (EVertexFormat)
+		  * @return Task which is completed by FlushUploads with true if the mesh is uploaded (Concurrency::task<bool>)
+		  */
+		Concurrency::task<bool> LoadStaticMeshAsync(
+			FSubmeshesDataSource SubmeshesDataSource,
+			const std::string& MeshName,
+			EVertexFormat VertexFormat = EVertexFormat::Full);
+
+		/** @brief Requests loading of a baked mesh file. It's mapped and validated by a loading worker
+		  * @param FilePath Path to file (format: *.wmesh) (const std::string &)
+		  * @param MeshName (const std::string &)
+		  * @return Task which is completed by FlushUploads with true if the mesh is uploaded (Concurrency::task<bool>)
+		  */
+		Concurrency::task<bool> LoadStaticMeshFileAsync(
+			const std::string& FilePath,
+			const std::string& MeshName);
+
+		/** @brief Requests loading of a baked mesh file, which path is returned by a loading worker.
+		  * So the file may be converted from its source asset without stalling the caller
+		  * @param MeshFileSource Is called by the worker (FMeshFileSource)
+		  * @param MeshName (const std::string &)
+		  * @return Task which is completed by FlushUploads with true if the mesh is uploaded (Concurrency::task<bool>)
+		  */
+		Concurrency::task<bool> LoadStaticMeshFileAsync(
+			FMeshFileSource MeshFileSource,
+			const std::string& MeshName);
+
+		/** @brief Requests loading of a texture. The texture data is added at once without resource,
+		  * so materials can refer it. The file is read by a loading worker
+		  * @param FileName Texture's file name (const std::wstring &)
+		  * @param Name Texture's name (const std::string &)
+		  * @param ViewDimension (D3D12_SRV_DIMENSION)
+		  * @param MaxSize Mips larger than it aren't loaded. All mips are loaded if it's 0 (uint32)
+		  * @return Task which is completed by FlushUploads with true if the texture is uploaded (Concurrency::task<bool>)
+		  */
+		Concurrency::task<bool> LoadTextureAsync(
+			const std::wstring& FileName,
+			const std::string& Name,
+			D3D12_SRV_DIMENSION ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D,
+			uint32 MaxSize = 0);
+
+		/** @brief Requests loading of a generated texture (like an atlas). The texture data is added at once
+		  * without resource, so materials can refer it. Generated textures aren't streamed: they don't have files
+		  * @param TextureDataSource Is called by the worker (FTextureDataSource)
+		  * @param Name Texture's name (const std::string &)
+		  * @param ViewDimension (D3D12_SRV_DIMENSION)
+		  * @return Task which is completed by FlushUploads with true if the texture is uploaded (Concurrency::task<bool>)
+		  */
+		Concurrency::task<bool> LoadGeneratedTextureAsync(
+			FTextureDataSource TextureDataSource,
+			const std::string& Name,
+			D3D12_SRV_DIMENSION ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D);
+
+		/** @brief Requests reloading of an uploaded texture with mips from MostDetailedMip of its file.
+		  * Its old resource is retired by FlushUploads when the new one is uploaded
+		  * @param Name Texture's name (const std::string &)
+		  * @param MostDetailedMip (uint32)
+		  * @return Task which is completed by FlushUploads with true if the texture is uploaded (Concurrency::task<bool>)
+		  */
+		Concurrency::task<bool> StreamTextureAsync(const std::string& Name, uint32 MostDetailedMip);
+
+		/** @brief The only point where loaded resources are uploaded.
+		  * Records upload of every finished load to the command list
+		  * @param CMDList (ComPtr<ID3D12GraphicsCommandList>)
+		  * @return Uploaded resources (WoodenEngine::FUploadedResources)
+		  */
+		FUploadedResources FlushUploads(ComPtr<ID3D12GraphicsCommandList> CMDList);
+
+		/** @brief Tags uploads recorded since the previous submit with the fence value.
+		  * Command lists with the uploads must be executed before the fence is signaled with the value
+		  * @param FenceValue (uint64)
+		  * @return (void)
+		  */
+		void SubmitUploads(uint64 FenceValue);
+
+		/** @brief Recycles staging memory of uploads and releases retired resources whose fence values are completed
+		  * @param CompletedFenceValue (uint64)
+		  * @return (void)
+		  */
+		void ReclaimUploads(uint64 CompletedFenceValue);
+
+		/** @brief Keeps removed or replaced resources, which frames in flight may use,
+		  * until the fence of the next SubmitUploads is completed
+		  * @param Resources (std::vector<ComPtr<ID3D12Resource>>)
+		  * @return (void)
+		  */
+		void RetireResources(std::vector<ComPtr<ID3D12Resource>> Resources);
+
+		/** @brief Returns staging memory of uploads
+		  * @return (WoodenEngine::FUploadHeapStats)
+		  */
+		FUploadHeapStats GetUploadStats() const;
+
+		/** @brief Adds or releases an object's reference to the submesh's mesh. The mesh is referenced
+		  * while any of its submeshes is. Referenced resources aren't evicted, and evicted ones are reloaded by next UpdateResidency
+		  * @param SubmeshHandle Invalid handles are skipped (FSubmeshHandle)
+		  * @param bReference Adds the reference if it's true, otherwise releases it (bool)
+		  * @return (void)
+		  */
+		void ReferenceSubmesh(FSubmeshHandle SubmeshHandle, bool bReference);
+
+		/** @brief Adds or releases an object's reference to the material. Referenced materials refer their textures.
+		  * References of removed materials are released by their stale handles
+		  * @param MaterialHandle Stale handles are skipped by references (FMaterialHandle)
+		  * @param bReference Adds the reference if it's true, otherwise releases it (bool)
+		  * @return (void)
+		  */
+		void ReferenceMaterial(FMaterialHandle MaterialHandle, bool bReference);
+
+		/** @brief Evicts unreferenced resources over the memory budget in LRU order and requests reloading
+		  * of evicted resources which are referenced again. Only asynchronously loaded resources are evicted
+		  * @param Frame Index of the current frame (uint64)
+		  * @return (WoodenEngine::FResidencyUpdate)
+		  */
+		FResidencyUpdate UpdateResidency(uint64 Frame);
+
+		/** @brief Changes the memory budget of meshes, textures and materials
+		  * @param BudgetBytes (uint64)
+		  * @return (void)
+		  */
+		void SetResourceBudget(uint64 BudgetBytes) noexcept;
+
+		/** @brief Returns memory of resident resources
+		  * @return (WoodenEngine::FResourceBudgetStats)
+		  */
+		FResourceBudgetStats GetResourceBudgetStats() const noexcept;
+
+		/** @brief Waits until loading workers finish all requested loads. Doesn't upload them
+		  * @return (void)
+		  */
+		void WaitForLoads();
+
+		/** @brief Sets max number of loads processed by workers at the same time
+		  * @param NumLoadingWorkers (uint32)
+		  * @return (void)
+		  */
+		void SetNumLoadingWorkers(uint32 NumLoadingWorkers);
+
+		/** @brief Returns true if there're requested but not uploaded resources
+		  * @return (bool)
+		  */
+		bool HasPendingLoads() const noexcept;
+
+		/** @brief Returns true if the mesh is uploaded
+		  * @param MeshName (const std::string &)
+		  * @return (bool)
+		  */
+		bool IsMeshReady(const std::string& MeshName) const;
+
+		/** @brief Returns statistics of the current or last batch of loads
+		  * @return (const WoodenEngine::FLoadingStats&)
+		  */
+		const FLoadingStats& GetLoadingStats() const noexcept;
 
 		/** @brief Method set dx12 device. It'll be used for comitting resources
 		  * @param Device DX12 Device (ComPtr<ID3D12Device>)
@@ -48,20 +287,56 @@ namespace WoodenEngine
 		  */
 		void SetDevice(ComPtr<ID3D12Device> Device);
 
+		/** @brief Enables overdraw-aware triangles clusters sorting of static meshes. It's disabled by default.
+		  * Vertex cache and vertex fetch optimizations are always applied in LoadStaticMesh
+		  * @param bOptimizeOverdraw (bool)
+		  * @return (void)
+		  */
+		void SetOptimizeMeshesOverdraw(bool bOptimizeOverdraw) noexcept;
+
+		/** @brief Sets the package which serves textures and baked meshes requested by their files' paths.
+		  * Files which aren't in the package are loaded as loose ones. Loads requested before aren't affected
+		  * @param AssetPackage nullptr to load loose files only (std::shared_ptr<const FAssetPackage>)
+		  * @return (void)
+		  */
+		void SetAssetPackage(std::shared_ptr<const FAssetPackage> AssetPackage);
+
+		/** @brief Sets epsilons used for welding vertices of triangle list static meshes
+		  * @param WeldSettings (const FWeldSettings &)
+		  * @return (void)
+		  */
+		void SetMeshesWeldSettings(const FWeldSettings& WeldSettings) noexcept;
+
 		/** @brief Method load an array of meshes to video and cpu memory.
+		  * Triangle list submeshes are welded and optimized for vertex cache before uploading
+		  * Submeshes named "<Name>_lod<i>" are linked as LODs of the submesh <Name>
 		  *	(The Device must be set!)
 		  * @param SubmeshesData An array of submeshes
 		  * It'll have only nullptrs after executing function 
 		  * (const std::vector<std::unique_ptr<FMeshRawData>> &&)
 		  * @param MeshName Mesh name of group of the submehes (const std::string& )
 		  * @param CmdList A Graphics Command List for comitting vertex and indices resources
+		  * @param VertexFormat Layout of the mesh's vertices in the vertex buffer (EVertexFormat)
 		  * @return (void)
 		  */
 		void LoadStaticMesh(
 			std::vector<std::unique_ptr<FMeshRawData>>&& SubmeshesData,
 			const std::string& MeshName,
-			ComPtr<ID3D12GraphicsCommandList> CmdList);
+			ComPtr<ID3D12GraphicsCommandList> CmdList,
+			EVertexFormat VertexFormat = EVertexFormat::Full);
 
+		/** @brief Loads a baked mesh file (see FMeshFile::Convert) to video and cpu memory.
+		  * The file is mapped to memory and its buffers are uploaded without parsing and conversions
+		  *	(The Device must be set!)
+		  * @param FilePath Path to file (format: *.wmesh) (const std::string &)
+		  * @param MeshName Mesh name of group of the submehes (const std::string &)
+		  * @param CmdList A Graphics Command List for comitting vertex and indices resources
+		  * @return (void)
+		  */
+		void LoadStaticMeshFile(
+			const std::string& FilePath,
+			const std::string& MeshName,
+			ComPtr<ID3D12GraphicsCommandList> CmdList);
 
 		/** @brief Add billboards
 		  * @param Vertices Vector of billboards vertices (const std::vector<SVertexBillboardData> &)
@@ -77,11 +352,47 @@ namespace WoodenEngine
 			ComPtr<ID3D12GraphicsCommandList> CMDList
 		);
 
+		/** @brief Removes the mesh. Its submeshes' handles stay interned and are resolved again
+		  * if a mesh with the name is uploaded. Throws invalid_argument if there's no uploaded mesh with the name
+		  * @param MeshName (const std::string &)
+		  * @return Resources of the mesh. Frames in flight may use them (std::vector<ComPtr<ID3D12Resource>>)
+		  */
+		std::vector<ComPtr<ID3D12Resource>> RemoveStaticMesh(const std::string& MeshName);
+
+		/** @brief Compacts fragmented pages of the geometry arena and updates views of moved meshes
+		  * @param CMDList (ComPtr<ID3D12GraphicsCommandList>)
+		  * @param MinFragmentation Pages fragmented less aren't compacted (float)
+		  * @return Replaced pages. Frames in flight may use them (std::vector<ComPtr<ID3D12Resource>>)
+		  */
+		std::vector<ComPtr<ID3D12Resource>> DefragmentGeometry(
+			ComPtr<ID3D12GraphicsCommandList> CMDList,
+			float MinFragmentation = 0.25f);
+
+		/** @brief Returns occupancy of the geometry arena of static meshes
+		  * @return (WoodenEngine::FGeometryArenaStats)
+		  */
+		FGeometryArenaStats GetGeometryStats() const;
+
 		/** @brief Adds material data to cache for future access
 		  * @param MaterialData Unique ptr to material data (std::unique_ptr<FMaterialData>)
+		  * @return (WoodenEngine::FMaterialHandle)
+		  */
+		FMaterialHandle AddMaterial(std::unique_ptr<FMaterialData> MaterialData);
+
+		/** @brief Removes the material. Its handles become stale, so objects with it aren't drawn.
+		  * Throws invalid_argument if the handle is stale
+		  * @param MaterialHandle (FMaterialHandle)
 		  * @return (void)
 		  */
-		void AddMaterial(std::unique_ptr<FMaterialData> MaterialData);
+		void RemoveMaterial(FMaterialHandle MaterialHandle);
+
+		/** @brief Removes the uploaded texture. Its handles become stale.
+		  * Throws invalid_argument if the handle is stale or the texture is being loaded
+		  * @param TextureHandle (FTextureHandle)
+		  * @return Resources of the texture. Frames in flight may use them (std::vector<ComPtr<ID3D12Resource>>)
+		  */
+		std::vector<ComPtr<ID3D12Resource>> RemoveTexture(FTextureHandle TextureHandle);
+
 		/** @brief Loads texture data to gpu memory
 		  * @param FileName Texture's file name (const std::wstring &)
 		  * @param Name Texture's name (const std::string &)
@@ -98,11 +409,31 @@ namespace WoodenEngine
 		  */
 		uint64 GetMaterialConstBufferIndex(const std::string& MaterialName) const;
 
-		/** @brief Finds a material data by name and returns it
+		/** @brief Finds a material data by name and returns it.
+		  * The pointer is valid until a material is added or removed
 		  * @param MaterialName (const std::string &)
-		  * @return Material Data(const WoodenEngine::FMaterialData&)
+		  * @return Material Data(WoodenEngine::FMaterialData*)
+		  */
+		FMaterialData* GetMaterialData(const std::string& MaterialName);
+
+		/** @brief Finds a material by name and returns its handle
+		  * Throws invalid_argument if there's no material with the name
+		  * @param MaterialName (const std::string &)
+		  * @return (WoodenEngine::FMaterialHandle)
+		  */
+		FMaterialHandle GetMaterialHandle(const std::string& MaterialName) const;
+
+		/** @brief Returns material data without lookups by names
+		  * @param MaterialHandle (FMaterialHandle)
+		  * @return nullptr if the material is removed (const WoodenEngine::FMaterialData*)
+		  */
+		const FMaterialData* GetMaterialData(FMaterialHandle MaterialHandle) const noexcept;
+
+		/** @brief Returns material data without lookups by names, so materials animated every frame are updated
+		  * @param MaterialHandle (FMaterialHandle)
+		  * @return nullptr if the material is removed (WoodenEngine::FMaterialData*)
 		  */
-		FMaterialData* GetMaterialData(const std::string& MaterialName) const;
+		FMaterialData* GetMaterialData(FMaterialHandle MaterialHandle) noexcept;
 
 		/** @brief Finds a submesh data by its name and name of mesh which contains it
 			and returns it.
@@ -122,17 +453,62 @@ namespace WoodenEngine
 		  */
 		const FMeshData& GetMeshData(const std::string& MeshName) const;
 
+		/** @brief Interns names of the submesh to a handle. The same names always get the same handle.
+		  * The handle is resolved at once if the mesh is uploaded, otherwise when it's uploaded.
+		  * Throws invalid_argument if the uploaded mesh doesn't have the submesh
+		  * @param MeshName (const std::string &)
+		  * @param SubmeshName (const std::string &)
+		  * @return (WoodenEngine::FSubmeshHandle)
+		  */
+		FSubmeshHandle GetSubmeshHandle(const std::string& MeshName, const std::string& SubmeshName);
+
+		/** @brief Returns true if the mesh of the submesh is uploaded and has it.
+		  * It becomes false when the mesh is removed or evicted by UpdateResidency, and true again when it's reloaded
+		  * @param SubmeshHandle (FSubmeshHandle)
+		  * @return (bool)
+		  */
+		bool IsSubmeshReady(FSubmeshHandle SubmeshHandle) const noexcept;
+
+		/** @brief Returns mesh data of the submesh without lookups by names
+		  * @param SubmeshHandle (FSubmeshHandle)
+		  * @return nullptr if the submesh isn't ready: its mesh is loading, removed or evicted (const WoodenEngine::FMeshData*)
+		  */
+		const FMeshData* GetMeshData(FSubmeshHandle SubmeshHandle) const noexcept;
+
+		/** @brief Returns data of the submesh without lookups by names
+		  * @param SubmeshHandle (FSubmeshHandle)
+		  * @return nullptr if the submesh isn't ready (const WoodenEngine::FSubmeshData*)
+		  */
+		const FSubmeshData* GetSubmeshData(FSubmeshHandle SubmeshHandle) const noexcept;
+
+		/** @brief Returns the material named as the source material of the submesh.
+		  * It's resolved when the submesh's mesh is uploaded, so the material must be added before
+		  * @param SubmeshHandle (FSubmeshHandle)
+		  * @return Invalid handle if there's no such material or the submesh isn't ready (WoodenEngine::FMaterialHandle)
+		  */
+		FMaterialHandle GetSubmeshMaterialHandle(FSubmeshHandle SubmeshHandle) const noexcept;
+
 		/** @brief Returns number of materials
 		  * @return Number of materials (default::uint64)
 		  */
 		uint64 GetNumMaterials() const noexcept;
 
-		/** @brief Returns materials data
+		/** @brief Returns materials data in order of their adding
+		  * @return Material Data (WoodenEngine::FGameResource::FMaterialsData&)
+		  */
+		FMaterialsData& GetMaterialsData() noexcept;
+
+		/** @brief Returns materials data in order of their adding
 		  * @return Material Data (const WoodenEngine::FGameResource::FMaterialsData&)
 		  */
 		const FMaterialsData& GetMaterialsData() const noexcept;
 
-		/** @brief Returns textures data
+		/** @brief Returns textures data in order of their adding
+		  * @return Textures data (WoodenEngine::FGameResource::FTexturesData&)
+		  */
+		FTexturesData& GetTexturesData() noexcept;
+
+		/** @brief Returns textures data in order of their adding
 		  * @return Textures data (const WoodenEngine::FGameResource::FTexturesData&)
 		  */
 		const FTexturesData& GetTexturesData() const noexcept;
@@ -143,22 +519,288 @@ namespace WoodenEngine
 		  */
 		const FTextureData* GetTextureData(const std::string& Name) const;
 
+		/** @brief Finds a texture by name and returns its handle
+		  * Throws invalid_argument if there's no texture with the name
+		  * @param Name Texture Name (const std::string &)
+		  * @return (FTextureHandle)
+		  */
+		FTextureHandle GetTextureHandle(const std::string& Name) const;
+
+		/** @brief Returns texture data without lookups by names
+		  * @param TextureHandle (FTextureHandle)
+		  * @return nullptr if the texture is removed (const FTextureData*)
+		  */
+		const FTextureData* GetTextureData(FTextureHandle TextureHandle) const noexcept;
+
+		/** @brief Returns true if a texture with the name is added (it may be not uploaded yet)
+		  * @param Name Texture Name (const std::string &)
+		  * @return (bool)
+		  */
+		bool HasTexture(const std::string& Name) const noexcept;
+
 		/** @brief Returns number of textures data in cache
 		  * @return Number of textures data (const uint32)
 		  */
 		const uint32 GetNumTexturesData() const noexcept;
 
 	private:
-		// Hash-Table consists of static meshes data, where key is a mesh's name
+		// CPU part of a load, which is done by a worker
+		struct FLoadedResource
+		{
+			std::unique_ptr<FBakedMesh> BakedMesh;
+			std::unique_ptr<FMeshFile> MeshFile;
+
+			// Mapped texture's file or package and layout of its loaded subresources,
+			// which are uploaded straight from the mapping
+			std::unique_ptr<DX::FMappedFile> TextureFile;
+			std::shared_ptr<const FAssetPackage> TexturePackage;
+			const uint8* TextureFileData = nullptr;
+			DirectX::DDS_TEXTURE_LAYOUT TextureLayout;
+
+			// DDS file of a generated or decompressed texture. It's used if there's no mapping
+			std::vector<uint8> TextureBytes;
+
+			bool bFromPackage = false;
+
+			// Description of all mips in the texture's file
+			uint32 TextureWidth = 0;
+			uint32 TextureHeight = 0;
+			std::vector<uint64> TextureMipsSizes;
+
+			// What() of an exception thrown by the worker
+			std::string Error;
+
+			double LoadSeconds = 0.0;
+		};
+
+		struct FPendingLoad
+		{
+			std::string Name;
+
+			// Texture which gets the resource on upload. Invalid for meshes
+			FTextureHandle TextureHandle;
+
+			Concurrency::task<std::shared_ptr<FLoadedResource>> Loaded;
+
+			Concurrency::task_completion_event<bool> Uploaded;
+		};
+
+		/** @brief Queues a load for workers and adds it to pending loads
+		  * @param Name (const std::string &)
+		  * @param Load Is called by a worker (std::function<void(FLoadedResource*)>)
+		  * @param TextureHandle Invalid for meshes (FTextureHandle)
+		  * @return (Concurrency::task<bool>)
+		  */
+		Concurrency::task<bool> EnqueueLoad(
+			const std::string& Name,
+			std::function<void(FLoadedResource*)> Load,
+			FTextureHandle TextureHandle = FTextureHandle());
+
+		/** @brief Adds texture data without resource.
+		  * Throws invalid_argument if the name is empty or a texture with the name exists
+		  * @param Name (const std::string &)
+		  * @param FileName Empty for generated textures (const std::wstring &)
+		  * @param ViewDimension (D3D12_SRV_DIMENSION)
+		  * @return (FTextureHandle)
+		  */
+		FTextureHandle AddTexture(
+			const std::string& Name,
+			const std::wstring& FileName,
+			D3D12_SRV_DIMENSION ViewDimension);
+
+		/** @brief Maps the texture's file or finds it in the package and computes layout of its mips.
+		  * Compressed entry is decompressed here. Is called by a worker
+		  * @param FileName (const std::wstring &)
+		  * @param MaxSize Mips larger than it aren't loaded. All mips are loaded if it's 0 (uint32)
+		  * @param AssetPackage May be nullptr (std::shared_ptr<const FAssetPackage>)
+		  * @param LoadedResource (FLoadedResource *)
+		  * @return (void)
+		  */
+		static void LoadTextureFile(
+			const std::wstring& FileName,
+			uint32 MaxSize,
+			std::shared_ptr<const FAssetPackage> AssetPackage,
+			FLoadedResource* LoadedResource);
+
+		/** @brief Computes layout of the texture's mips and describes all mips of the file. Is called by a worker
+		  * @param Data Whole DDS file (const uint8 *)
+		  * @param Size (uint64)
+		  * @param SourceName File path or texture's name for errors (const std::string &)
+		  * @param MaxSize Mips larger than it aren't loaded. All mips are loaded if it's 0 (uint32)
+		  * @param LoadedResource (FLoadedResource *)
+		  * @return (void)
+		  */
+		static void LoadTextureLayout(
+			const uint8* Data,
+			uint64 Size,
+			const std::string& SourceName,
+			uint32 MaxSize,
+			FLoadedResource* LoadedResource);
+
+		/** @brief Creates the mesh's buffers from the baked mesh and adds it to static meshes
+		  * @param MeshName (const std::string &)
+		  * @param BakedMesh Its submeshes are moved to the mesh (FBakedMesh *)
+		  * @param CMDList (ComPtr<ID3D12GraphicsCommandList>)
+		  * @return (void)
+		  */
+		void CreateStaticMesh(
+			const std::string& MeshName,
+			FBakedMesh* BakedMesh,
+			ComPtr<ID3D12GraphicsCommandList> CMDList);
+
+		/** @brief Creates the mesh's buffers right from the mapped file and adds it to static meshes
+		  * @param MeshName (const std::string &)
+		  * @param MeshFile (const FMeshFile &)
+		  * @param CMDList (ComPtr<ID3D12GraphicsCommandList>)
+		  * @return (void)
+		  */
+		void CreateStaticMesh(
+			const std::string& MeshName,
+			const FMeshFile& MeshFile,
+			ComPtr<ID3D12GraphicsCommandList> CMDList);
+
+		/** @brief Adds the mesh to static meshes and resolves slots of its submeshes
+		  * @param MeshData (std::unique_ptr<FMeshData>)
+		  * @return (void)
+		  */
+		void AddStaticMesh(std::unique_ptr<FMeshData> MeshData);
+
+		/** @brief Frees the mesh's ranges and unresolves slots of its submeshes. The budget isn't changed
+		  * @param MeshName (const std::string &)
+		  * @return Resources of the mesh. Frames in flight may use them (std::vector<ComPtr<ID3D12Resource>>)
+		  */
+		std::vector<ComPtr<ID3D12Resource>> DestroyStaticMesh(const std::string& MeshName);
+
+		/** @brief Returns memory of the uploaded mesh
+		  * @param MeshData (const FMeshData &)
+		  * @return (WoodenEngine::FResourceFootprint)
+		  */
+		FResourceFootprint GetMeshFootprint(const FMeshData& MeshData) const;
+
+		/** @brief Returns memory of the uploaded texture
+		  * @param TextureData (const FTextureData &)
+		  * @return (WoodenEngine::FResourceFootprint)
+		  */
+		FResourceFootprint GetTextureFootprint(const FTextureData& TextureData) const;
+
+		/** @brief Adds or releases a reference of the material to its texture
+		  * @param MaterialName (const std::string &)
+		  * @param bReference (bool)
+		  * @return (void)
+		  */
+		void ReferenceMaterialTexture(const std::string& MaterialName, bool bReference);
+
+		/** @brief Throws invalid_argument if a mesh with the name is loaded or requested
+		  * @param MeshName (const std::string &)
+		  * @return (void)
+		  */
+		void CheckMeshName(const std::string& MeshName) const;
+
+		/** @brief Adds submeshes to the mesh and links simplified submeshes
+		  * "<Name>_lod<i>" as LODs of the submesh <Name>
+		  * @param SubmeshesData (std::vector<std::unique_ptr<FSubmeshData>> &&)
+		  * @param MeshData (FMeshData *)
+		  * @return (void)
+		  */
+		void AddSubmeshes(
+			std::vector<std::unique_ptr<FSubmeshData>>&& SubmeshesData,
+			FMeshData* MeshData) const;
+
+		/** @brief Allocates vertices and indices of the mesh in the geometry arena and sets its views.
+		  * Vertex stride and index format must be set in the views yet
+		  * @param VerticesData Content of vertex buffer (const void *)
+		  * @param VerticesSize Size of vertex buffer in bytes (uint64)
+		  * @param IndicesData Content of index buffer (const void *)
+		  * @param IndicesSize Size of index buffer in bytes (uint64)
+		  * @param MeshData (FMeshData *)
+		  * @param CMDList (ComPtr<ID3D12GraphicsCommandList>)
+		  * @return (void)
+		  */
+		void CreateBuffers(
+			const void* VerticesData,
+			uint64 VerticesSize,
+			const void* IndicesData,
+			uint64 IndicesSize,
+			FMeshData* MeshData,
+			ComPtr<ID3D12GraphicsCommandList> CMDList);
+
+		/** @brief Sets the mesh's views and first elements to current locations of its ranges in the geometry arena
+		  * @param MeshData (FMeshData *)
+		  * @return (void)
+		  */
+		void UpdateGeometryLocations(FMeshData* MeshData) const;
+
+		// Staging memory of all uploads
+		FUploadHeap UploadHeap;
+
+		// Vertices and indices of all static meshes
+		FGeometryArena GeometryArena;
+
+		// Pool of static meshes data
 		FMeshesData StaticMeshesData;
 
-		// Hash-table consists of materials data, where key is a material's name
+		// Hash-Table consists of static meshes' handles, where key is a mesh's name
+		std::unordered_map<std::string, FMeshHandle> StaticMeshesHandles;
+
+		// Submeshes referred by objects, which are resolved when their meshes are uploaded
+		FSubmeshRegistry SubmeshRegistry;
+
+		// Pool of materials data
 		FMaterialsData MaterialsData;
 
-		// Hash-table consists of textures data, where key is a texture's name
+		// Hash-table consists of materials' handles, where key is a material's name
+		std::unordered_map<std::string, FMaterialHandle> MaterialsHandles;
+
+		// Pool of textures data
 		FTexturesData TexturesData;
 
+		// Hash-table consists of textures' handles, where key is a texture's name
+		std::unordered_map<std::string, FTextureHandle> TexturesHandles;
+
+		// Decides which meshes, textures and materials stay in memory
+		FResourceBudget ResourceBudget;
+
+		// Loads of asynchronously loaded resources, where key is a resource's name.
+		// They're enqueued again to reload evicted resources
+		std::unordered_map<std::string, std::function<void(FLoadedResource*)>> MeshesLoads;
+		std::unordered_map<std::string, std::function<void(FLoadedResource*)>> TexturesLoads;
+
+		// Textures referred by referenced materials, where key is a material's name
+		std::unordered_map<std::string, std::string> MaterialsTextures;
+
+		// Number of objects' references to every submesh slot, indexed by FSubmeshHandle
+		std::vector<uint32> SubmeshesSlotsReferences;
+
+		// Objects' references to a material. Its name is kept, so the material may be removed before releases
+		struct FMaterialReferences
+		{
+			uint32 NumReferences = 0;
+			std::string Name;
+		};
+
+		// Referenced materials, where key is a handle's generation and index
+		std::unordered_map<uint64, FMaterialReferences> MaterialsReferences;
+
 		// DX12 Device
 		ComPtr<ID3D12Device> Device;
+
+		// Sort triangles clusters of loaded static meshes for less overdraw. See FMeshBakeSettings
+		bool bOptimizeMeshesOverdraw = false;
+
+		// Epsilons for welding vertices of loaded static meshes
+		FWeldSettings MeshesWeldSettings;
+
+		// Serves loads of files which are packed. Captured by loads at their requests
+		std::shared_ptr<const FAssetPackage> AssetPackage;
+
+		// Requested loads in order of requests. Accessed by the owner's thread only
+		std::vector<FPendingLoad> PendingLoads;
+
+		std::chrono::high_resolution_clock::time_point FirstPendingLoadTime;
+
+		FLoadingStats LoadingStats;
+
+		// It's the last member, so running loads are finished before other members are destroyed
+		FLoadingWorkers LoadingWorkers;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "Common/DirectXHelper.h"
+#include "GeometryArena.h"
+
+namespace WoodenEngine
+{
+	FGeometryArena::FGeometryArena(uint32 PageSize):
+		PageSize(PageSize)
+	{
+		if (PageSize == 0)
+		{
+			throw std::invalid_argument("PageSize must be positive");
+		}
+	}
+
+	void FGeometryArena::SetDevice(ComPtr<ID3D12Device> Device)
+	{
+		if (Device == nullptr)
+		{
+			throw std::invalid_argument("Device must be not nullptr");
+		}
+
+		this->Device = Device;
+	}
+
+	FGeometryAllocation FGeometryArena::Allocate(
+		EGeometryBufferType Type,
+		uint32 ElementSize,
+		uint32 NumElements,
+		const void* Data,
+		ComPtr<ID3D12GraphicsCommandList> CMDList,
+		FUploadHeap& UploadHeap)
+	{
+		if (ElementSize == 0 || NumElements == 0)
+		{
+			throw std::invalid_argument("ElementSize and NumElements must be positive");
+		}
+
+		const auto ByteSize = static_cast<uint64>(ElementSize)*NumElements;
+		if (ByteSize > UINT32_MAX)
+		{
+			throw std::invalid_argument("Geometry range is bigger than 4GB");
+		}
+
+		FGeometryRange Range;
+		for (uint32 iPage = 0; iPage < Pages.size() && !Range.Allocation.IsValid(); ++iPage)
+		{
+			const auto& Page = Pages[iPage];
+			if (Page != nullptr && !Page->bDedicated && Page->Type == Type && Page->ElementSize == ElementSize)
+			{
+				Range.Allocation = Page->Allocator.Allocate(NumElements);
+				Range.iPage = iPage;
+			}
+		}
+
+		// Ranges larger than shared pages get their own ones
+		if (!Range.Allocation.IsValid())
+		{
+			const auto NumPageElements = PageSize / ElementSize;
+			const auto bDedicated = NumElements > NumPageElements;
+			Range.iPage = CreatePage(Type, ElementSize, bDedicated ? NumElements : NumPageElements, bDedicated);
+			Range.Allocation = Pages[Range.iPage]->Allocator.Allocate(NumElements);
+		}
+
+		auto& Page = *Pages[Range.iPage];
+
+		const auto Upload = UploadHeap.Allocate(ByteSize);
+		std::memcpy(Upload.MappedData, Data, static_cast<size_t>(ByteSize));
+
+		TransitionPage(Page, D3D12_RESOURCE_STATE_COPY_DEST, CMDList);
+		CMDList->CopyBufferRegion(Page.Buffer.Get(), static_cast<uint64>(Range.Allocation.Offset)*ElementSize,
+			Upload.Resource, Upload.Offset, ByteSize);
+		TransitionPage(Page, GetReadState(Type), CMDList);
+
+		return Ranges.Create(Range);
+	}
+
+	ComPtr<ID3D12Resource> FGeometryArena::Free(FGeometryAllocation Allocation)
+	{
+		const auto Range = Ranges.Get(Allocation);
+		Ranges.Destroy(Allocation);
+
+		auto& Page = Pages[Range.iPage];
+		Page->Allocator.Free(Range.Allocation);
+
+		ComPtr<ID3D12Resource> ReleasedBuffer;
+		if (Page->bDedicated)
+		{
+			ReleasedBuffer = std::move(Page->Buffer);
+			Page.reset();
+		}
+
+		return ReleasedBuffer;
+	}
+
+	FGeometryLocation FGeometryArena::GetLocation(FGeometryAllocation Allocation) const
+	{
+		const auto& Range = Ranges.Get(Allocation);
+		const auto& Page = *Pages[Range.iPage];
+
+		FGeometryLocation Location;
+		Location.BufferLocation = Page.Buffer->GetGPUVirtualAddress();
+		Location.BufferSize = Page.Allocator.GetSize()*Page.ElementSize;
+		Location.FirstElement = Page.Allocator.GetOffset(Range.Allocation);
+		Location.RangeSize = Range.Allocation.Size*Page.ElementSize;
+		return Location;
+	}
+
+	std::vector<ComPtr<ID3D12Resource>> FGeometryArena::Defragment(
+		ComPtr<ID3D12GraphicsCommandList> CMDList,
+		float MinFragmentation)
+	{
+		std::vector<ComPtr<ID3D12Resource>> RetiredBuffers;
+		for (uint32 iPage = 0; iPage < Pages.size(); ++iPage)
+		{
+			auto Page = Pages[iPage].get();
+			if (Page == nullptr || Page->bDedicated || Page->Allocator.IsEmpty())
+			{
+				continue;
+			}
+
+			const auto Stats = Page->Allocator.GetStats();
+			if (Stats.NumFreeRanges < 2 || Stats.GetFragmentation() < MinFragmentation)
+			{
+				continue;
+			}
+
+			// Sources of moved ranges. Other ranges stay at their offsets
+			std::unordered_map<uint32, uint32> SourceOffsets;
+			for (const auto& Move : Page->Allocator.Compact())
+			{
+				SourceOffsets[Move.iBlock] = Move.SourceOffset;
+			}
+
+			// Ranges may overlap their sources, so they're copied to a new buffer
+			auto Buffer = CreatePageBuffer(static_cast<uint64>(Page->Allocator.GetSize())*Page->ElementSize);
+			CMDList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
+				Buffer.Get(), D3D12_RESOURCE_STATE_COMMON, D3D12_RESOURCE_STATE_COPY_DEST));
+			TransitionPage(*Page, D3D12_RESOURCE_STATE_COPY_SOURCE, CMDList);
+
+			for (const auto& Range : Ranges)
+			{
+				if (Range.iPage != iPage)
+				{
+					continue;
+				}
+
+				const auto DestinationOffset = Page->Allocator.GetOffset(Range.Allocation);
+				const auto SourceOffsetIter = SourceOffsets.find(Range.Allocation.iBlock);
+				const auto SourceOffset = SourceOffsetIter != SourceOffsets.cend() ?
+					SourceOffsetIter->second : DestinationOffset;
+
+				CMDList->CopyBufferRegion(
+					Buffer.Get(), static_cast<uint64>(DestinationOffset)*Page->ElementSize,
+					Page->Buffer.Get(), static_cast<uint64>(SourceOffset)*Page->ElementSize,
+					static_cast<uint64>(Range.Allocation.Size)*Page->ElementSize);
+			}
+
+			RetiredBuffers.push_back(std::move(Page->Buffer));
+			Page->Buffer = std::move(Buffer);
+			Page->State = D3D12_RESOURCE_STATE_COPY_DEST;
+			TransitionPage(*Page, GetReadState(Page->Type), CMDList);
+		}
+
+		return RetiredBuffers;
+	}
+
+	FGeometryArenaStats FGeometryArena::GetStats() const
+	{
+		FGeometryArenaStats Stats;
+		for (const auto& Page : Pages)
+		{
+			if (Page == nullptr)
+			{
+				continue;
+			}
+
+			const auto PageStats = Page->Allocator.GetStats();
+			++Stats.NumPages;
+			Stats.NumDedicatedPages += Page->bDedicated ? 1 : 0;
+			Stats.NumAllocations += PageStats.NumAllocations;
+			Stats.ReservedBytes += static_cast<uint64>(PageStats.Size)*Page->ElementSize;
+			Stats.UsedBytes += static_cast<uint64>(PageStats.UsedSize)*Page->ElementSize;
+			if (!Page->bDedicated)
+			{
+				Stats.MaxFragmentation = std::max(Stats.MaxFragmentation, PageStats.GetFragmentation());
+			}
+		}
+
+		return Stats;
+	}
+
+	uint32 FGeometryArena::CreatePage(EGeometryBufferType Type, uint32 ElementSize, uint32 NumElements, bool bDedicated)
+	{
+		if (Device == nullptr)
+		{
+			throw std::invalid_argument("Device must be set");
+		}
+
+		auto Page = std::make_unique<FPage>(NumElements);
+		Page->Buffer = CreatePageBuffer(static_cast<uint64>(NumElements)*ElementSize);
+		Page->Type = Type;
+		Page->ElementSize = ElementSize;
+		Page->bDedicated = bDedicated;
+
+		const auto FreePageIter = std::find(Pages.begin(), Pages.end(), nullptr);
+		if (FreePageIter != Pages.end())
+		{
+			*FreePageIter = std::move(Page);
+			return static_cast<uint32>(FreePageIter - Pages.begin());
+		}
+
+		Pages.push_back(std::move(Page));
+		return static_cast<uint32>(Pages.size() - 1);
+	}
+
+	ComPtr<ID3D12Resource> FGeometryArena::CreatePageBuffer(uint64 ByteSize) const
+	{
+		ComPtr<ID3D12Resource> Buffer;
+		DX::ThrowIfFailed(Device->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Buffer(ByteSize),
+			D3D12_RESOURCE_STATE_COMMON,
+			nullptr,
+			IID_PPV_ARGS(&Buffer)));
+
+		return Buffer;
+	}
+
+	void FGeometryArena::TransitionPage(FPage& Page, D3D12_RESOURCE_STATES State, ComPtr<ID3D12GraphicsCommandList> CMDList)
+	{
+		if (Page.State == State)
+		{
+			return;
+		}
+
+		CMDList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(Page.Buffer.Get(), Page.State, State));
+		Page.State = State;
+	}
+
+	D3D12_RESOURCE_STATES FGeometryArena::GetReadState(EGeometryBufferType Type) noexcept
+	{
+		return Type == EGeometryBufferType::Vertex ?
+			D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER : D3D12_RESOURCE_STATE_INDEX_BUFFER;
+	}
+}
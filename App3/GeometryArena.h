@@ -0,0 +1,232 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "pch.h"
+#include "RangeAllocator.h"
+#include "ResourcePool.h"
+#include "UploadHeap.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \enum EGeometryBufferType
+	 *
+	 * \brief Type of a buffer of the geometry arena. It defines the buffer's state between uploads
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	enum class EGeometryBufferType : uint8
+	{
+		Vertex = 0,
+		Index
+	};
+
+	/*!
+	 * \struct FGeometryRange
+	 *
+	 * \brief Range of elements of a page of FGeometryArena
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FGeometryRange
+	{
+		uint32 iPage = UINT32_MAX;
+
+		FRangeAllocation Allocation;
+	};
+
+	// Handle of a range of FGeometryArena. It stays valid when the range is moved by defragmentation
+	using FGeometryAllocation = FPoolHandle<FGeometryRange>;
+
+	/*!
+	 * \struct FGeometryLocation
+	 *
+	 * \brief Where a range of FGeometryArena is. Views cover whole pages,
+	 * so meshes of the same page share them and are drawn from their first elements
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FGeometryLocation
+	{
+		D3D12_GPU_VIRTUAL_ADDRESS BufferLocation = 0;
+
+		// Size of the whole page in bytes
+		uint32 BufferSize = 0;
+
+		// Index of the range's first element in the page
+		uint32 FirstElement = 0;
+
+		// Size of the range in bytes
+		uint32 RangeSize = 0;
+	};
+
+	/*!
+	 * \struct FGeometryArenaStats
+	 *
+	 * \brief Occupancy of FGeometryArena
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FGeometryArenaStats
+	{
+		uint32 NumPages = 0;
+
+		// Pages of ranges larger than the page size
+		uint32 NumDedicatedPages = 0;
+
+		uint32 NumAllocations = 0;
+
+		uint64 ReservedBytes = 0;
+		uint64 UsedBytes = 0;
+
+		// The worst fragmentation among shared pages (see FRangeAllocatorStats::GetFragmentation)
+		float MaxFragmentation = 0.0f;
+	};
+
+	/*!
+	 * \class FGeometryArena
+	 *
+	 * \brief Vertices and indices of all static meshes suballocated from a few large buffers (pages).
+	 * Every page keeps elements of one size (vertex stride or index size), so ranges are addressed
+	 * by their first elements and meshes of a page are drawn without rebinding its buffer.
+	 * Ranges are allocated by FRangeAllocator, freed at once and moved by defragmentation
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FGeometryArena
+	{
+	public:
+		// Size of shared pages
+		static constexpr uint32 DefaultPageSize = 16 * 1024 * 1024;
+
+		/** @brief
+		  * @param PageSize Size of shared pages in bytes (uint32)
+		  */
+		explicit FGeometryArena(uint32 PageSize = DefaultPageSize);
+		~FGeometryArena() = default;
+
+		FGeometryArena& operator=(const FGeometryArena& GeometryArena) = delete;
+		FGeometryArena(const FGeometryArena& GeometryArena) = delete;
+		FGeometryArena(FGeometryArena&& GeometryArena) = delete;
+
+		/** @brief Method set dx12 device. It'll be used for creating pages
+		  * @param Device DX12 Device (ComPtr<ID3D12Device>)
+		  * @return (void)
+		  */
+		void SetDevice(ComPtr<ID3D12Device> Device);
+
+		/** @brief Allocates a range and records upload of the data to it.
+		  * A new page is created if the range doesn't fit existing ones
+		  *	(The Device must be set!)
+		  * @param Type (EGeometryBufferType)
+		  * @param ElementSize Vertex stride or index size in bytes (uint32)
+		  * @param NumElements (uint32)
+		  * @param Data NumElements*ElementSize bytes (const void *)
+		  * @param CMDList (ComPtr<ID3D12GraphicsCommandList>)
+		  * @param UploadHeap Staging memory of the data (FUploadHeap &)
+		  * @return (WoodenEngine::FGeometryAllocation)
+		  */
+		FGeometryAllocation Allocate(
+			EGeometryBufferType Type,
+			uint32 ElementSize,
+			uint32 NumElements,
+			const void* Data,
+			ComPtr<ID3D12GraphicsCommandList> CMDList,
+			FUploadHeap& UploadHeap);
+
+		/** @brief Frees the range. The range may be reused by the next upload, which is executed
+		  * after previously submitted frames. Throws invalid_argument if the handle is stale
+		  * @param Allocation (FGeometryAllocation)
+		  * @return Released dedicated page or nullptr. Frames in flight may use it (ComPtr<ID3D12Resource>)
+		  */
+		ComPtr<ID3D12Resource> Free(FGeometryAllocation Allocation);
+
+		/** @brief Returns the current location of the range. It's changed by Defragment only
+		  * @param Allocation (FGeometryAllocation)
+		  * @return (WoodenEngine::FGeometryLocation)
+		  */
+		FGeometryLocation GetLocation(FGeometryAllocation Allocation) const;
+
+		/** @brief Compacts shared pages fragmented more than MinFragmentation.
+		  * Ranges of such a page are copied to a new buffer in the command list, so the free space is
+		  * one range at its end. Locations of moved ranges must be queried again
+		  * @param CMDList (ComPtr<ID3D12GraphicsCommandList>)
+		  * @param MinFragmentation (float)
+		  * @return Replaced buffers. Frames in flight may use them (std::vector<ComPtr<ID3D12Resource>>)
+		  */
+		std::vector<ComPtr<ID3D12Resource>> Defragment(
+			ComPtr<ID3D12GraphicsCommandList> CMDList,
+			float MinFragmentation = 0.25f);
+
+		/** @brief Collects statistics of all pages
+		  * @return (WoodenEngine::FGeometryArenaStats)
+		  */
+		FGeometryArenaStats GetStats() const;
+
+	private:
+		struct FPage
+		{
+			FPage(uint32 NumElements):
+				Allocator(NumElements)
+			{
+			}
+
+			ComPtr<ID3D12Resource> Buffer;
+
+			// State between copies
+			D3D12_RESOURCE_STATES State = D3D12_RESOURCE_STATE_COMMON;
+
+			EGeometryBufferType Type = EGeometryBufferType::Vertex;
+			uint32 ElementSize = 0;
+
+			FRangeAllocator Allocator;
+
+			bool bDedicated = false;
+		};
+
+		/** @brief Creates a page and puts it to a free place of pages
+		  * @param Type (EGeometryBufferType)
+		  * @param ElementSize (uint32)
+		  * @param NumElements (uint32)
+		  * @param bDedicated (bool)
+		  * @return Index of the page (uint32)
+		  */
+		uint32 CreatePage(EGeometryBufferType Type, uint32 ElementSize, uint32 NumElements, bool bDedicated);
+
+		/** @brief Creates a default heap buffer of the page
+		  * @param ByteSize (uint64)
+		  * @return (ComPtr<ID3D12Resource>)
+		  */
+		ComPtr<ID3D12Resource> CreatePageBuffer(uint64 ByteSize) const;
+
+		/** @brief Records the page's transition to the state, if it's in another one
+		  * @param Page (FPage &)
+		  * @param State (D3D12_RESOURCE_STATES)
+		  * @param CMDList (ComPtr<ID3D12GraphicsCommandList>)
+		  * @return (void)
+		  */
+		static void TransitionPage(FPage& Page, D3D12_RESOURCE_STATES State, ComPtr<ID3D12GraphicsCommandList> CMDList);
+
+		/** @brief Returns the state in which pages of the type are read by draws
+		  * @param Type (EGeometryBufferType)
+		  * @return (D3D12_RESOURCE_STATES)
+		  */
+		static D3D12_RESOURCE_STATES GetReadState(EGeometryBufferType Type) noexcept;
+
+		ComPtr<ID3D12Device> Device;
+
+		uint32 PageSize = DefaultPageSize;
+
+		// Released pages are nullptrs, so indices of pages don't change
+		std::vector<std::unique_ptr<FPage>> Pages;
+
+		FResourcePool<FGeometryRange> Ranges;
+	};
+}
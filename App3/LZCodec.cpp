@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "LZCodec.h"
+
+namespace WoodenEngine
+{
+	namespace
+	{
+		// Matches are at least 4 bytes and at most 64KB back
+		constexpr uint32 MinMatchSize = 4;
+		constexpr uint32 MaxMatchOffset = 65535;
+
+		// The format requires the last 5 bytes to be literals and the last match to start 12 bytes before the end
+		constexpr uint64 NumLastLiterals = 5;
+		constexpr uint64 MatchStartMargin = 12;
+
+		constexpr uint32 HashTableBits = 16;
+
+		uint32 ReadUInt32(const uint8* Data)
+		{
+			uint32 Value;
+			std::memcpy(&Value, Data, sizeof(Value));
+			return Value;
+		}
+
+		uint32 HashPrefix(uint32 Prefix)
+		{
+			return (Prefix * 2654435761u) >> (32 - HashTableBits);
+		}
+
+		/** @brief Writes the remainder of a length which doesn't fit 4 bits of the token
+		  * @param Length (uint64)
+		  * @param Out (std::vector<uint8> &)
+		  * @return (void)
+		  */
+		void WriteLengthRemainder(uint64 Length, std::vector<uint8>& Out)
+		{
+			for (; Length >= 255; Length -= 255)
+			{
+				Out.push_back(255);
+			}
+			Out.push_back(static_cast<uint8>(Length));
+		}
+
+		/** @brief Writes literals and the match which follows them. The last sequence doesn't have a match
+		  * @param Literals (const uint8 *)
+		  * @param NumLiterals (uint64)
+		  * @param MatchOffset Zero for the last sequence (uint32)
+		  * @param MatchSize (uint64)
+		  * @param Out (std::vector<uint8> &)
+		  * @return (void)
+		  */
+		void WriteSequence(const uint8* Literals, uint64 NumLiterals, uint32 MatchOffset, uint64 MatchSize, std::vector<uint8>& Out)
+		{
+			const auto MatchSizeCode = MatchOffset > 0 ? MatchSize - MinMatchSize : 0;
+			const auto Token = static_cast<uint8>((std::min<uint64>(NumLiterals, 15) << 4) | std::min<uint64>(MatchSizeCode, 15));
+			Out.push_back(Token);
+
+			if (NumLiterals >= 15)
+			{
+				WriteLengthRemainder(NumLiterals - 15, Out);
+			}
+			Out.insert(Out.end(), Literals, Literals + NumLiterals);
+
+			if (MatchOffset == 0)
+			{
+				return;
+			}
+
+			Out.push_back(static_cast<uint8>(MatchOffset & 0xFF));
+			Out.push_back(static_cast<uint8>(MatchOffset >> 8));
+			if (MatchSizeCode >= 15)
+			{
+				WriteLengthRemainder(MatchSizeCode - 15, Out);
+			}
+		}
+
+		/** @brief Reads a length whose token's 4 bits are 15
+		  * @param Src (const uint8 *)
+		  * @param SrcSize (uint64)
+		  * @param SrcPos (uint64 &)
+		  * @return (uint64)
+		  */
+		uint64 ReadLengthRemainder(const uint8* Src, uint64 SrcSize, uint64& SrcPos)
+		{
+			uint64 Length = 0;
+			uint8 Byte = 255;
+			while (Byte == 255)
+			{
+				if (SrcPos >= SrcSize)
+				{
+					throw std::invalid_argument("Compressed data is truncated");
+				}
+
+				Byte = Src[SrcPos++];
+				Length += Byte;
+			}
+
+			return Length;
+		}
+	}
+
+	std::vector<uint8> FLZCodec::Compress(const uint8* Data, uint64 Size)
+	{
+		if (Size > std::numeric_limits<uint32>::max())
+		{
+			throw std::invalid_argument("Data larger than 4GB can't be compressed");
+		}
+
+		std::vector<uint8> Out;
+		Out.reserve(static_cast<std::size_t>(GetMaxCompressedSize(Size)));
+
+		// Latest positions of 4-byte prefixes. The first position is never hashed, so it's the empty value
+		std::vector<uint32> HashTable(std::size_t(1) << HashTableBits, 0);
+
+		uint64 Anchor = 0;
+		uint64 Pos = 1;
+		const auto MatchStartLimit = Size > MatchStartMargin ? Size - MatchStartMargin : 0;
+		const auto MatchEndLimit = Size > NumLastLiterals ? Size - NumLastLiterals : 0;
+		while (Pos < MatchStartLimit)
+		{
+			const auto Prefix = ReadUInt32(Data + Pos);
+			auto& HashEntry = HashTable[HashPrefix(Prefix)];
+			const uint64 Candidate = HashEntry;
+			HashEntry = static_cast<uint32>(Pos);
+
+			if (Pos - Candidate > MaxMatchOffset || ReadUInt32(Data + Candidate) != Prefix)
+			{
+				++Pos;
+				continue;
+			}
+
+			auto MatchSize = static_cast<uint64>(MinMatchSize);
+			while (Pos + MatchSize < MatchEndLimit && Data[Candidate + MatchSize] == Data[Pos + MatchSize])
+			{
+				++MatchSize;
+			}
+
+			WriteSequence(Data + Anchor, Pos - Anchor, static_cast<uint32>(Pos - Candidate), MatchSize, Out);
+
+			Pos += MatchSize;
+			Anchor = Pos;
+		}
+
+		WriteSequence(Data + Anchor, Size - Anchor, 0, 0, Out);
+
+		return Out;
+	}
+
+	void FLZCodec::Decompress(const uint8* Src, uint64 SrcSize, uint8* Dst, uint64 DstSize)
+	{
+		uint64 SrcPos = 0;
+		uint64 DstPos = 0;
+		while (SrcPos < SrcSize)
+		{
+			const auto Token = Src[SrcPos++];
+
+			auto NumLiterals = static_cast<uint64>(Token >> 4);
+			if (NumLiterals == 15)
+			{
+				NumLiterals += ReadLengthRemainder(Src, SrcSize, SrcPos);
+			}
+
+			if (NumLiterals > SrcSize - SrcPos || NumLiterals > DstSize - DstPos)
+			{
+				throw std::invalid_argument("Compressed data has literals out of bounds");
+			}
+
+			std::memcpy(Dst + DstPos, Src + SrcPos, static_cast<std::size_t>(NumLiterals));
+			SrcPos += NumLiterals;
+			DstPos += NumLiterals;
+
+			// The last sequence doesn't have a match
+			if (SrcPos == SrcSize)
+			{
+				break;
+			}
+
+			if (SrcSize - SrcPos < 2)
+			{
+				throw std::invalid_argument("Compressed data is truncated");
+			}
+
+			const uint64 MatchOffset = Src[SrcPos] | (Src[SrcPos + 1] << 8);
+			SrcPos += 2;
+
+			auto MatchSize = static_cast<uint64>(Token & 15);
+			if (MatchSize == 15)
+			{
+				MatchSize += ReadLengthRemainder(Src, SrcSize, SrcPos);
+			}
+			MatchSize += MinMatchSize;
+
+			if (MatchOffset == 0 || MatchOffset > DstPos || MatchSize > DstSize - DstPos)
+			{
+				throw std::invalid_argument("Compressed data has a match out of bounds");
+			}
+
+			// Matches may overlap themselves, so they're copied forward byte by byte
+			const auto Match = Dst + DstPos - MatchOffset;
+			auto MatchDst = Dst + DstPos;
+			if (MatchOffset >= MatchSize)
+			{
+				std::memcpy(MatchDst, Match, static_cast<std::size_t>(MatchSize));
+			}
+			else
+			{
+				for (uint64 i = 0; i < MatchSize; ++i)
+				{
+					MatchDst[i] = Match[i];
+				}
+			}
+			DstPos += MatchSize;
+		}
+
+		if (DstPos != DstSize)
+		{
+			throw std::invalid_argument("Compressed data doesn't match its original size");
+		}
+	}
+
+	uint64 FLZCodec::GetMaxCompressedSize(uint64 Size) noexcept
+	{
+		return Size + Size / 255 + 16;
+	}
+}
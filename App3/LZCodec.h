@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+
+#include "pch.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \class FLZCodec
+	 *
+	 * \brief Byte-oriented LZ77 compression in the LZ4 block format: sequences of literals
+	 * and matches up to 64KB back. Compression is greedy with a hash table of 4-byte prefixes.
+	 * Decompression is a bounds checked copy loop, so it's fast enough for loading workers
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FLZCodec
+	{
+	public:
+		FLZCodec() = default;
+		~FLZCodec() = default;
+
+		FLZCodec& operator=(const FLZCodec& LZCodec) = delete;
+		FLZCodec(const FLZCodec& LZCodec) = delete;
+		FLZCodec(FLZCodec&& LZCodec) = delete;
+
+		/** @brief Compresses the data. Throws invalid_argument if it's larger than 4GB
+		  * @param Data (const uint8 *)
+		  * @param Size (uint64)
+		  * @return At most GetMaxCompressedSize(Size) bytes (std::vector<uint8>)
+		  */
+		static std::vector<uint8> Compress(const uint8* Data, uint64 Size);
+
+		/** @brief Decompresses the data. Throws invalid_argument if it's corrupted
+		  * or doesn't decompress to exactly DstSize bytes
+		  * @param Src (const uint8 *)
+		  * @param SrcSize (uint64)
+		  * @param Dst (uint8 *)
+		  * @param DstSize Size of the original data (uint64)
+		  * @return (void)
+		  */
+		static void Decompress(const uint8* Src, uint64 SrcSize, uint8* Dst, uint64 DstSize);
+
+		/** @brief Size of compressed incompressible data
+		  * @param Size (uint64)
+		  * @return (uint64)
+		  */
+		static uint64 GetMaxCompressedSize(uint64 Size) noexcept;
+	};
+}
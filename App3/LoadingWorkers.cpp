@@ -0,0 +1,93 @@
+#include <ppltasks.h>
+#include <stdexcept>
+#include <vector>
+
+#include "LoadingWorkers.h"
+
+namespace WoodenEngine
+{
+	FLoadingWorkers::~FLoadingWorkers()
+	{
+		// Running loads refer this
+		{
+			std::lock_guard<std::mutex> Lock(QueuedLoadsMutex);
+			QueuedLoads.clear();
+		}
+
+		Wait();
+	}
+
+	void FLoadingWorkers::Enqueue(std::function<void()> Load)
+	{
+		{
+			std::lock_guard<std::mutex> Lock(QueuedLoadsMutex);
+			QueuedLoads.push_back(std::move(Load));
+		}
+
+		StartQueuedLoads(false);
+	}
+
+	void FLoadingWorkers::Wait()
+	{
+		std::unique_lock<std::mutex> Lock(QueuedLoadsMutex);
+		LoadsFinishedCondition.wait(Lock, [this]()
+		{
+			return NumRunningLoads == 0 && QueuedLoads.empty();
+		});
+	}
+
+	void FLoadingWorkers::SetNumWorkers(uint32 NumWorkers)
+	{
+		if (NumWorkers == 0)
+		{
+			throw std::invalid_argument("NumWorkers must be positive");
+		}
+
+		{
+			std::lock_guard<std::mutex> Lock(QueuedLoadsMutex);
+			this->NumWorkers = NumWorkers;
+		}
+
+		StartQueuedLoads(false);
+	}
+
+	uint32 FLoadingWorkers::GetNumWorkers() const
+	{
+		std::lock_guard<std::mutex> Lock(QueuedLoadsMutex);
+		return NumWorkers;
+	}
+
+	void FLoadingWorkers::StartQueuedLoads(bool bLoadFinished)
+	{
+		std::vector<std::function<void()>> StartedLoads;
+		{
+			std::lock_guard<std::mutex> Lock(QueuedLoadsMutex);
+			if (bLoadFinished)
+			{
+				--NumRunningLoads;
+			}
+
+			while (NumRunningLoads < NumWorkers && !QueuedLoads.empty())
+			{
+				StartedLoads.push_back(std::move(QueuedLoads.front()));
+				QueuedLoads.pop_front();
+				++NumRunningLoads;
+			}
+
+			if (NumRunningLoads == 0)
+			{
+				LoadsFinishedCondition.notify_all();
+			}
+		}
+
+		// This isn't accessed after the unlock unless a load is started
+		for (auto& Load : StartedLoads)
+		{
+			Concurrency::create_task([this, Load]()
+			{
+				Load();
+				StartQueuedLoads(true);
+			});
+		}
+	}
+}
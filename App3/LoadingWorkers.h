@@ -0,0 +1,76 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include "pch.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \class FLoadingWorkers
+	 *
+	 * \brief Runs loads on PPL tasks, at most NumWorkers of them at the same time.
+	 * Loads are started in order of their enqueueing. It doesn't depend on a device,
+	 * so loading is measured without one
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FLoadingWorkers
+	{
+	public:
+		FLoadingWorkers() = default;
+
+		// Queued loads are dropped, running ones are waited
+		~FLoadingWorkers();
+
+		FLoadingWorkers& operator=(const FLoadingWorkers& LoadingWorkers) = delete;
+		FLoadingWorkers(const FLoadingWorkers& LoadingWorkers) = delete;
+		FLoadingWorkers(FLoadingWorkers&& LoadingWorkers) = delete;
+
+		/** @brief Queues the load and starts it if there's a free worker.
+		  * The load must not throw: its errors are reported by itself
+		  * @param Load (std::function<void()>)
+		  * @return (void)
+		  */
+		void Enqueue(std::function<void()> Load);
+
+		/** @brief Waits until all enqueued loads are finished
+		  * @return (void)
+		  */
+		void Wait();
+
+		/** @brief Sets max number of loads running at the same time
+		  * Throws invalid_argument if it's 0
+		  * @param NumWorkers (uint32)
+		  * @return (void)
+		  */
+		void SetNumWorkers(uint32 NumWorkers);
+
+		/** @brief Returns max number of loads running at the same time
+		  * @return (uint32)
+		  */
+		uint32 GetNumWorkers() const;
+
+	private:
+		/** @brief Starts queued loads while there're free workers
+		  * @param bLoadFinished Is true if it's called by a finished load (bool)
+		  * @return (void)
+		  */
+		void StartQueuedLoads(bool bLoadFinished);
+
+		// Loads waiting for a free worker. Queue is shared with workers
+		std::deque<std::function<void()>> QueuedLoads;
+
+		mutable std::mutex QueuedLoadsMutex;
+
+		std::condition_variable LoadsFinishedCondition;
+
+		uint32 NumRunningLoads = 0;
+
+		uint32 NumWorkers = 4;
+	};
+}
@@ -3,6 +3,7 @@
 #include <string>
 
 #include "EngineSettings.h"
+#include "ResourcePool.h"
 #include "TextureData.h"
 
 namespace WoodenEngine
@@ -41,6 +42,10 @@ namespace WoodenEngine
 		// Material transform uv-coordinates (for implementing effects)
 		XMFLOAT4X4 Transform = MathHelper::Identity4x4();
 
-		const FTextureData* DiffuseTexture = nullptr;
+		// Invalid or stale handle means the material isn't textured
+		FTextureHandle DiffuseTexture;
 	};
+
+	// Handle of a material of FGameResource. It becomes stale when the material is removed
+	using FMaterialHandle = FPoolHandle<FMaterialData>;
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #pragma once
+#include <algorithm>
+#include <cmath>
 #include <DirectXMath.h>
 
 namespace WoodenEngine
@@ -28,5 +30,30 @@ namespace WoodenEngine
 
 				return I;
 			}
+
+			/** @brief Returns angles of the rotation, which is inverse of XMQuaternionRotationRollPitchYawFromVector.
+			  * Roll is zero if pitch is +-90 degrees
+			  * @param Quaternion Unit quaternion (const DirectX::XMFLOAT4 &)
+			  * @return Pitch, yaw and roll in radians (DirectX::XMFLOAT3)
+			  */
+			static DirectX::XMFLOAT3 RollPitchYawFromQuaternion(const DirectX::XMFLOAT4& Quaternion) noexcept
+			{
+				const auto X = Quaternion.x;
+				const auto Y = Quaternion.y;
+				const auto Z = Quaternion.z;
+				const auto W = Quaternion.w;
+
+				// Elements of the rotation matrix, whose third row is (cos(p)sin(y), -sin(p), cos(p)cos(y))
+				const auto SinPitch = std::min(std::max(2.0f*(X*W - Y*Z), -1.0f), 1.0f);
+				const auto Pitch = std::asin(SinPitch);
+				if (std::abs(SinPitch) > 0.99999f)
+				{
+					return { Pitch, std::atan2(-2.0f*(X*Z - Y*W), 1.0f - 2.0f*(Y*Y + Z*Z)), 0.0f };
+				}
+
+				const auto Yaw = std::atan2(2.0f*(X*Z + Y*W), 1.0f - 2.0f*(X*X + Y*Y));
+				const auto Roll = std::atan2(2.0f*(X*Y + Z*W), 1.0f - 2.0f*(X*X + Z*Z));
+				return { Pitch, Yaw, Roll };
+			}
 	};
 }
\ No newline at end of file
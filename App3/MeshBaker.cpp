@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+#include "MeshBaker.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "VertexPacker.h"
+
+namespace WoodenEngine
+{
+	std::unique_ptr<FBakedMesh> FMeshBaker::Bake(
+		std::vector<std::unique_ptr<FMeshRawData>>&& SubmeshesData,
+		const std::string& MeshName,
+		const FMeshBakeSettings& Settings) const
+	{
+		auto BakedMesh = std::make_unique<FBakedMesh>();
+		BakedMesh->Name = MeshName;
+		BakedMesh->VertexFormat = Settings.VertexFormat;
+		BakedMesh->VertexStride = FVertexPacker::GetVertexStride(Settings.VertexFormat);
+
+		uint64 NumVertices = 0;
+		uint64 NumIndices = 0;
+
+		FMeshWelder MeshWelder;
+		FMeshOptimizer MeshOptimizer;
+		FMeshletBuilder MeshletBuilder;
+		std::vector<std::vector<FMeshlet>> SubmeshesMeshlets(SubmeshesData.size());
+		for (auto iMesh = 0; iMesh < SubmeshesData.size(); ++iMesh)
+		{
+			auto MeshData = SubmeshesData[iMesh].get();
+
+			// Merge duplicated vertices produced by parsers and generators
+			if (MeshData->Topology == D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
+			{
+				const auto WeldStats = MeshWelder.Weld(MeshData, Settings.WeldSettings);
+				DBOUT(MeshName + "/" + MeshData->Name + " welded vertices",
+					WeldStats.NumVerticesBefore << " -> " << WeldStats.NumVerticesAfter <<
+					", saved " << WeldStats.NumBytesSaved << " bytes");
+			}
+
+			// Reorder triangles for post-transform cache. Meshlets are grown from seeds in this order
+			auto OptimizationStats = MeshOptimizer.Optimize(MeshData, Settings.bOptimizeOverdraw);
+
+			// Split to meshlets for per-cluster culling. Triangles are regrouped by meshlets,
+			// so they're reordered for the cache inside every meshlet and vertices are reordered for fetch once again
+			if (MeshData->Topology == D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
+			{
+				const auto BuildStartTime = std::chrono::high_resolution_clock::now();
+
+				SubmeshesMeshlets[iMesh] = MeshletBuilder.Build(MeshData);
+				MeshOptimizer.OptimizeMeshletsVertexCache(MeshData, SubmeshesMeshlets[iMesh]);
+				MeshOptimizer.OptimizeVertexFetch(MeshData);
+
+				const std::chrono::duration<double, std::milli> BuildTime =
+					std::chrono::high_resolution_clock::now() - BuildStartTime;
+				DBOUT(MeshName + "/" + MeshData->Name + " meshlets",
+					SubmeshesMeshlets[iMesh].size() << " built in " << BuildTime.count() << " ms");
+
+				OptimizationStats.After = MeshOptimizer.AnalyzeVertexCache(*MeshData);
+			}
+
+			// Statistics of the final order, which is uploaded
+			DBOUT(MeshName + "/" + MeshData->Name + " ACMR",
+				OptimizationStats.Before.ACMR << " -> " << OptimizationStats.After.ACMR);
+			DBOUT(MeshName + "/" + MeshData->Name + " ATVR",
+				OptimizationStats.Before.ATVR << " -> " << OptimizationStats.After.ATVR);
+
+			NumVertices += MeshData->Vertices.size();
+			NumIndices += MeshData->Indices.size();
+		}
+
+		// Draw calls address vertices by INT base vertex and indices by UINT start index
+		if (NumVertices > INT32_MAX || NumIndices > UINT32_MAX)
+		{
+			throw std::invalid_argument("Mesh " + MeshName + " has too many vertices or indices");
+		}
+
+		const auto VertexStride = BakedMesh->VertexStride;
+
+		auto& VerticesData = BakedMesh->VerticesData;
+		std::vector<uint32> IndicesData;
+
+		VerticesData.resize(NumVertices*VertexStride);
+		IndicesData.reserve(NumIndices);
+
+		FVertexPacker VertexPacker;
+
+		uint64 NumFilledVertices = 0;
+		// Adding vertices and indices of every mesh to common arrays
+		for (auto iMesh = 0; iMesh < SubmeshesData.size(); ++iMesh)
+		{
+			auto SubmeshRawData = SubmeshesData[iMesh].get();
+
+			auto SubmeshData = std::make_unique<FSubmeshData>(SubmeshRawData->Name);
+			SubmeshData->VertexBegin = static_cast<uint32>(NumFilledVertices);
+			SubmeshData->NumVertices = static_cast<uint32>(SubmeshRawData->Vertices.size());
+			SubmeshData->IndexBegin = IndicesData.size();
+			SubmeshData->NumIndices = SubmeshRawData->Indices.size();
+			SubmeshData->Meshlets = std::move(SubmeshesMeshlets[iMesh]);
+			SubmeshData->GeometricError = SubmeshRawData->GeometricError;
+			SubmeshData->Transform = SubmeshRawData->Transform;
+			SubmeshData->MaterialIndex = SubmeshRawData->MaterialIndex;
+
+			if (!SubmeshRawData->Vertices.empty())
+			{
+				auto BoundsMin = XMLoadFloat3(&SubmeshRawData->Vertices[0].Position);
+				auto BoundsMax = BoundsMin;
+				for (const auto& Vertex : SubmeshRawData->Vertices)
+				{
+					const auto Position = XMLoadFloat3(&Vertex.Position);
+					BoundsMin = XMVectorMin(BoundsMin, Position);
+					BoundsMax = XMVectorMax(BoundsMax, Position);
+				}
+
+				XMStoreFloat3(&SubmeshData->BoundsMin, BoundsMin);
+				XMStoreFloat3(&SubmeshData->BoundsMax, BoundsMax);
+			}
+
+			// Encode vertices to the mesh's format
+			const auto PackedVertices = VerticesData.data() + NumFilledVertices*VertexStride;
+			const auto PackingStats = VertexPacker.Pack(*SubmeshRawData, Settings.VertexFormat,
+				PackedVertices, &SubmeshData->VertexQuantization);
+
+			if (Settings.VertexFormat != EVertexFormat::Full && PackingStats.NumBytesBefore > 0)
+			{
+				DBOUT(MeshName + "/" + SubmeshRawData->Name + " packed vertices",
+					PackingStats.NumBytesBefore << " -> " << PackingStats.NumBytesAfter << " bytes, fetch bandwidth -" <<
+					100 * (PackingStats.NumBytesBefore - PackingStats.NumBytesAfter) / PackingStats.NumBytesBefore << "%");
+
+#if defined(_DEBUG)
+				// Round-trip decodes every vertex, so release builds skip it
+				const auto ErrorsStats = FVertexPacker::MeasureErrors(*SubmeshRawData, Settings.VertexFormat,
+					PackedVertices, SubmeshData->VertexQuantization);
+				DBOUT(MeshName + "/" + SubmeshRawData->Name + " packing max errors",
+					"position " << ErrorsStats.MaxPositionError <<
+					", normal " << ErrorsStats.MaxNormalError << " deg" <<
+					", tangent " << ErrorsStats.MaxTangentError << " deg" <<
+					", uv " << ErrorsStats.MaxTexCError);
+#endif
+			}
+
+			NumFilledVertices += SubmeshRawData->Vertices.size();
+
+			// Indices stay relative to the submesh's VertexBegin
+			IndicesData.insert(IndicesData.end(),
+				SubmeshRawData->Indices.cbegin(), SubmeshRawData->Indices.cend());
+
+			BakedMesh->SubmeshesData.push_back(std::move(SubmeshData));
+		}
+
+		BakedMesh->IndexFormat = PackIndices(IndicesData, &BakedMesh->IndicesData);
+		DBOUT(MeshName + " indices", IndicesData.size() <<
+			(BakedMesh->IndexFormat == DXGI_FORMAT_R16_UINT ? " x 16 bit" : " x 32 bit"));
+
+		return BakedMesh;
+	}
+
+	DXGI_FORMAT FMeshBaker::PackIndices(const std::vector<uint32>& Indices, std::vector<uint8>* IndicesData)
+	{
+		const auto MaxIndex = Indices.empty() ? 0 :
+			*std::max_element(Indices.cbegin(), Indices.cend());
+
+		// Half-sized indices are used if every submesh addresses less than 2^16 vertices
+		if (MaxIndex <= UINT16_MAX)
+		{
+			IndicesData->resize(Indices.size()*sizeof(uint16));
+
+			std::transform(Indices.cbegin(), Indices.cend(), reinterpret_cast<uint16*>(IndicesData->data()),
+				[](uint32 Index) { return static_cast<uint16>(Index); });
+			return DXGI_FORMAT_R16_UINT;
+		}
+
+		IndicesData->resize(Indices.size()*sizeof(uint32));
+		std::copy(Indices.cbegin(), Indices.cend(), reinterpret_cast<uint32*>(IndicesData->data()));
+		return DXGI_FORMAT_R32_UINT;
+	}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "MeshData.h"
+#include "MeshWelder.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FMeshBakeSettings
+	 *
+	 * \brief Processing of static meshes before uploading
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FMeshBakeSettings
+	{
+		EVertexFormat VertexFormat = EVertexFormat::Full;
+
+		// Sort triangles clusters for less overdraw. It trades vertex cache efficiency for an order
+		// which isn't measured, so it's off unless a mesh is known to have much overdraw
+		bool bOptimizeOverdraw = false;
+
+		// Epsilons for welding vertices of triangle list submeshes
+		FWeldSettings WeldSettings;
+	};
+
+	/*!
+	 * \struct FBakedMesh
+	 *
+	 * \brief Static mesh in its GPU layout: vertex and index buffers' content
+	 * and submeshes' ranges in them
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FBakedMesh
+	{
+		FBakedMesh() = default;
+
+		FBakedMesh(const FBakedMesh& BakedMesh) = delete;
+		FBakedMesh& operator=(const FBakedMesh& BakedMesh) = delete;
+
+		std::string Name;
+
+		EVertexFormat VertexFormat = EVertexFormat::Full;
+		uint32 VertexStride = sizeof(SVertexData);
+		std::vector<uint8> VerticesData;
+
+		DXGI_FORMAT IndexFormat = DXGI_FORMAT_R16_UINT;
+		std::vector<uint8> IndicesData;
+
+		// Submeshes in order of their ranges in the buffers
+		std::vector<std::unique_ptr<FSubmeshData>> SubmeshesData;
+
+		// Names of the source asset's materials indexed by submeshes' MaterialIndex.
+		// They're known to importers only, so the baker leaves them empty
+		std::vector<std::string> MaterialsNames;
+	};
+
+	/*!
+	 * \class FMeshBaker
+	 *
+	 * \brief Welds, optimizes, splits to meshlets and packs submeshes of a static mesh
+	 * to content of its vertex and index buffers
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FMeshBaker
+	{
+	public:
+		FMeshBaker() = default;
+		~FMeshBaker() = default;
+
+		FMeshBaker& operator=(const FMeshBaker& MeshBaker) = delete;
+		FMeshBaker(const FMeshBaker& MeshBaker) = delete;
+		FMeshBaker(FMeshBaker&& MeshBaker) = delete;
+
+		/** @brief Bakes submeshes to one static mesh
+		  * @param SubmeshesData Submeshes. They're modified by optimizations
+		  * (std::vector<std::unique_ptr<FMeshRawData>> &&)
+		  * @param MeshName (const std::string &)
+		  * @param Settings (const FMeshBakeSettings &)
+		  * @return (std::unique_ptr<WoodenEngine::FBakedMesh>)
+		  */
+		std::unique_ptr<FBakedMesh> Bake(
+			std::vector<std::unique_ptr<FMeshRawData>>&& SubmeshesData,
+			const std::string& MeshName,
+			const FMeshBakeSettings& Settings = FMeshBakeSettings()) const;
+
+		/** @brief Writes indices as 16-bit ones if all of them fit, otherwise as 32-bit ones
+		  * @param Indices (const std::vector<uint32> &)
+		  * @param IndicesData Content of index buffer (std::vector<uint8> *)
+		  * @return Format of written indices (DXGI_FORMAT)
+		  */
+		static DXGI_FORMAT PackIndices(const std::vector<uint32>& Indices, std::vector<uint8>* IndicesData);
+	};
+}
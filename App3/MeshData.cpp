@@ -1,17 +1,336 @@
 #include <iostream>
-#include <fstream>
+#include <chrono>
 #include <sstream>
 #include <string>
 #include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <ppl.h>
 #include <assimp/Importer.hpp>
+#include <assimp/config.h>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include "Common/MappedFile.h"
 #include "MeshData.h"
 
 
 namespace WoodenEngine
 {
+	namespace
+	{
+		/*!
+		 * \struct FVerticesSoA
+		 *
+		 * \brief Scratch buffers with every vertex component in a separate array.
+		 * Arrays are padded to a multiple of 4, so generators process 4 vertices per XMVECTOR
+		 */
+		struct FVerticesSoA
+		{
+			enum EComponent
+			{
+				PositionX, PositionY, PositionZ,
+				NormalX, NormalY, NormalZ,
+				TangentX, TangentY, TangentZ,
+				TexCU, TexCV,
+				NumComponents
+			};
+
+			explicit FVerticesSoA(std::size_t NumVertices):
+				NumVertices(NumVertices),
+				NumPaddedVertices((NumVertices + 3) & ~std::size_t(3))
+			{
+				for (auto& Component : Components)
+				{
+					Component.resize(NumPaddedVertices, 0.0f);
+				}
+			}
+
+			XMVECTOR Load(EComponent Component, std::size_t iVertex) const noexcept
+			{
+				return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&Components[Component][iVertex]));
+			}
+
+			void Store(EComponent Component, std::size_t iVertex, FXMVECTOR Value) noexcept
+			{
+				XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Components[Component][iVertex]), Value);
+			}
+
+			void Deinterleave(const FVertex* Vertices) noexcept
+			{
+				for (std::size_t iVertex = 0; iVertex < NumVertices; ++iVertex)
+				{
+					const auto& Vertex = Vertices[iVertex];
+					Components[PositionX][iVertex] = Vertex.Position.x;
+					Components[PositionY][iVertex] = Vertex.Position.y;
+					Components[PositionZ][iVertex] = Vertex.Position.z;
+					Components[NormalX][iVertex] = Vertex.Normal.x;
+					Components[NormalY][iVertex] = Vertex.Normal.y;
+					Components[NormalZ][iVertex] = Vertex.Normal.z;
+					Components[TangentX][iVertex] = Vertex.Tangent.x;
+					Components[TangentY][iVertex] = Vertex.Tangent.y;
+					Components[TangentZ][iVertex] = Vertex.Tangent.z;
+					Components[TexCU][iVertex] = Vertex.TexC.x;
+					Components[TexCV][iVertex] = Vertex.TexC.y;
+				}
+			}
+
+			void Interleave(FVertex* Vertices) const noexcept
+			{
+				for (std::size_t iVertex = 0; iVertex < NumVertices; ++iVertex)
+				{
+					auto& Vertex = Vertices[iVertex];
+					Vertex.Position = { 
+						Components[PositionX][iVertex], Components[PositionY][iVertex], Components[PositionZ][iVertex] };
+					Vertex.Normal = { 
+						Components[NormalX][iVertex], Components[NormalY][iVertex], Components[NormalZ][iVertex] };
+					Vertex.Tangent = {
+						Components[TangentX][iVertex], Components[TangentY][iVertex], Components[TangentZ][iVertex] };
+					Vertex.TexC = { Components[TexCU][iVertex], Components[TexCV][iVertex] };
+				}
+			}
+
+			std::size_t NumVertices;
+			std::size_t NumPaddedVertices;
+
+			std::array<std::vector<float>, NumComponents> Components;
+		};
+
+		// Lane indices of a vector: {0, 1, 2, 3}
+		XMVECTOR GetLaneOffsets() noexcept
+		{
+			return XMVectorSet(0.0f, 1.0f, 2.0f, 3.0f);
+		}
+
+		// Size of text parsed by one task of ParseTxtData
+		constexpr std::size_t TxtChunkSize = 1 << 20;
+
+		bool IsTxtSpace(char Char) noexcept
+		{
+			return Char == ' ' || Char == '\n' || Char == '\r' || Char == '\t' || Char == '\v' || Char == '\f';
+		}
+
+		const char* SkipTxtSpaces(const char* Cursor, const char* End) noexcept
+		{
+			while (Cursor != End && IsTxtSpace(*Cursor))
+			{
+				++Cursor;
+			}
+			return Cursor;
+		}
+
+		const char* FindTxtTokenEnd(const char* Cursor, const char* End) noexcept
+		{
+			while (Cursor != End && !IsTxtSpace(*Cursor))
+			{
+				++Cursor;
+			}
+			return Cursor;
+		}
+
+		uint64 CountTxtTokens(const char* Cursor, const char* End) noexcept
+		{
+			uint64 NumTokens = 0;
+			for (Cursor = SkipTxtSpaces(Cursor, End); Cursor != End; Cursor = SkipTxtSpaces(Cursor, End))
+			{
+				Cursor = FindTxtTokenEnd(Cursor, End);
+				++NumTokens;
+			}
+			return NumTokens;
+		}
+
+		/** @brief Converts triangles of an assimp mesh to raw mesh data
+		  * @param Mesh (const aiMesh &)
+		  * @param MeshData (FMeshRawData *)
+		  * @return (void)
+		  */
+		void ConvertAssimpMesh(const aiMesh& Mesh, FMeshRawData* MeshData)
+		{
+			MeshData->Name = Mesh.mName.C_Str();
+			MeshData->MaterialIndex = Mesh.mMaterialIndex;
+			MeshData->Vertices.resize(Mesh.mNumVertices);
+
+			for (uint32 iVertex = 0; iVertex < Mesh.mNumVertices; ++iVertex)
+			{
+				XMFLOAT3 Position = {
+					Mesh.mVertices[iVertex].x,
+					Mesh.mVertices[iVertex].y,
+					Mesh.mVertices[iVertex].z
+				};
+
+				FVertex Vertex = { std::move(Position) };
+
+				if (Mesh.mNormals != nullptr)
+				{
+					Vertex.Normal = {
+						Mesh.mNormals[iVertex].x,
+						Mesh.mNormals[iVertex].y,
+						Mesh.mNormals[iVertex].z,
+					};
+				}
+
+				if (Mesh.mTangents != nullptr)
+				{
+					Vertex.Tangent = {
+						Mesh.mTangents[iVertex].x,
+						Mesh.mTangents[iVertex].y,
+						Mesh.mTangents[iVertex].z,
+					};
+				}
+
+				if (Mesh.mTextureCoords[0] != nullptr)
+				{
+					Vertex.TexC = {
+						Mesh.mTextureCoords[0][iVertex].x,
+						Mesh.mTextureCoords[0][iVertex].y,
+					};
+				}
+
+				MeshData->Vertices[iVertex] = std::move(Vertex);
+			}
+
+			// Points and lines which survived triangulation are skipped
+			MeshData->Indices.reserve(Mesh.mNumFaces * 3);
+			for (uint32 iFace = 0; iFace < Mesh.mNumFaces; ++iFace)
+			{
+				const auto& Face = Mesh.mFaces[iFace];
+				if (Face.mNumIndices == 3)
+				{
+					MeshData->Indices.insert(MeshData->Indices.end(), Face.mIndices, Face.mIndices + 3);
+				}
+			}
+		}
+
+		/** @brief Appends the submesh to the mesh in space of their scene
+		  * @param SubmeshData Submesh with transform to the scene's space (const FMeshRawData &)
+		  * @param MeshData Mesh in the scene's space (FMeshRawData *)
+		  * @return (void)
+		  */
+		void AppendTransformedSubmesh(const FMeshRawData& SubmeshData, FMeshRawData* MeshData)
+		{
+			const auto Transform = XMLoadFloat4x4(&SubmeshData.Transform);
+
+			// Normals are transformed by the inverse transpose, so they stay orthogonal under non-uniform scales
+			XMVECTOR Determinant;
+			const auto NormalTransform = XMMatrixTranspose(XMMatrixInverse(&Determinant, Transform));
+
+			const auto BaseVertex = static_cast<uint32>(MeshData->Vertices.size());
+			MeshData->Vertices.reserve(MeshData->Vertices.size() + SubmeshData.Vertices.size());
+			for (auto Vertex : SubmeshData.Vertices)
+			{
+				XMStoreFloat3(&Vertex.Position, XMVector3TransformCoord(XMLoadFloat3(&Vertex.Position), Transform));
+				XMStoreFloat3(&Vertex.Normal, XMVector3Normalize(
+					XMVector3TransformNormal(XMLoadFloat3(&Vertex.Normal), NormalTransform)));
+				XMStoreFloat3(&Vertex.Tangent, XMVector3Normalize(
+					XMVector3TransformNormal(XMLoadFloat3(&Vertex.Tangent), Transform)));
+
+				MeshData->Vertices.push_back(Vertex);
+			}
+
+			// Mirroring transforms flip the winding, so it's restored
+			const bool bMirrored = XMVectorGetX(Determinant) < 0.0f;
+
+			MeshData->Indices.reserve(MeshData->Indices.size() + SubmeshData.Indices.size());
+			for (std::size_t iIndex = 0; iIndex < SubmeshData.Indices.size(); iIndex += 3)
+			{
+				MeshData->Indices.push_back(BaseVertex + SubmeshData.Indices[iIndex]);
+				MeshData->Indices.push_back(BaseVertex + SubmeshData.Indices[iIndex + (bMirrored ? 2 : 1)]);
+				MeshData->Indices.push_back(BaseVertex + SubmeshData.Indices[iIndex + (bMirrored ? 1 : 2)]);
+			}
+		}
+
+		/** @brief Converts an unsigned decimal token. The text isn't zero-terminated
+		  * @param Begin Token's begin (const char *)
+		  * @param End Token's end (const char *)
+		  * @param Value (uint64 *)
+		  * @return false if the token isn't a number or overflows (bool)
+		  */
+		bool ParseTxtUInt(const char* Begin, const char* End, uint64* Value) noexcept
+		{
+			if (Begin == End)
+			{
+				return false;
+			}
+
+			uint64 Result = 0;
+			for (; Begin != End; ++Begin)
+			{
+				const auto Digit = static_cast<uint32>(*Begin - '0');
+				if (Digit > 9 || Result > (UINT64_MAX - Digit) / 10)
+				{
+					return false;
+				}
+
+				Result = Result * 10 + Digit;
+			}
+
+			*Value = Result;
+			return true;
+		}
+
+		/** @brief Converts a float token. The result is bit-identical to strtof (and istream >>):
+		  * short plain decimals are exact ratios of float integers, so one division rounds them correctly,
+		  * other tokens fall back to strtof
+		  * @param Begin Token's begin (const char *)
+		  * @param End Token's end (const char *)
+		  * @param Value (float *)
+		  * @return false if the token isn't a number (bool)
+		  */
+		bool ParseTxtFloat(const char* Begin, const char* End, float* Value)
+		{
+			// Powers of 10 which are exact in float
+			static const float Pow10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+			// Integers up to 2^24 are exact in float
+			constexpr uint32 MaxExactMantissa = 1 << 24;
+
+			const auto* Cursor = Begin;
+			const bool bNegative = Cursor != End && *Cursor == '-';
+			if (Cursor != End && (*Cursor == '-' || *Cursor == '+'))
+			{
+				++Cursor;
+			}
+
+			uint32 Mantissa = 0;
+			uint32 NumDigits = 0;
+			uint32 NumFractionDigits = 0;
+			bool bPoint = false;
+			bool bExact = true;
+			for (; Cursor != End && bExact; ++Cursor)
+			{
+				const auto Digit = static_cast<uint32>(*Cursor - '0');
+				if (Digit <= 9)
+				{
+					Mantissa = Mantissa * 10 + Digit;
+					NumFractionDigits += bPoint;
+					++NumDigits;
+					bExact = Mantissa <= MaxExactMantissa && NumFractionDigits < _countof(Pow10);
+				}
+				else if (*Cursor == '.' && !bPoint)
+				{
+					bPoint = true;
+				}
+				else
+				{
+					// Exponents, inf and nan
+					bExact = false;
+				}
+			}
+
+			if (bExact && NumDigits > 0)
+			{
+				const auto Result = static_cast<float>(Mantissa) / Pow10[NumFractionDigits];
+				*Value = bNegative ? -Result : Result;
+				return true;
+			}
+
+			const std::string Token(Begin, End);
+			char* TokenEnd = nullptr;
+			*Value = strtof(Token.c_str(), &TokenEnd);
+			return !Token.empty() && TokenEnd == Token.c_str() + Token.size();
+		}
+	}
+
 	FMeshGenerator::FMeshGenerator()
 	{
 
@@ -124,43 +443,63 @@ namespace WoodenEngine
 		float PhiStep = XM_PI / NumVSubdivisions;
 		float ThetaStep = 2.0f*XM_PI / NumHSubdivisions;
 
-		uint64 iVertex = 1;
-		for (auto iVSubdivision = 1; iVSubdivision <= NumVSubdivisions - 1; ++iVSubdivision)
+		const auto NumVertexInRing = NumHSubdivisions + 1;
+
+		// Theta doesn't depend on ring, so its sines and cosines are computed once
+		FVerticesSoA RingVertices(NumVertexInRing);
+		std::vector<float> SinThetas(RingVertices.NumPaddedVertices);
+		std::vector<float> CosThetas(RingVertices.NumPaddedVertices);
+
+		for (std::size_t iHSubdivision = 0; iHSubdivision < RingVertices.NumPaddedVertices; iHSubdivision += 4)
 		{
-			float Phi = PhiStep * iVSubdivision;
+			const auto Theta = XMVectorScale(
+				XMVectorAdd(XMVectorReplicate(static_cast<float>(iHSubdivision)), GetLaneOffsets()), ThetaStep);
 
-			for (auto iHSubdivision = 0; iHSubdivision <= NumHSubdivisions; ++iHSubdivision, ++iVertex)
-			{
-				float Theta = ThetaStep*iHSubdivision;
+			XMVECTOR SinTheta, CosTheta;
+			XMVectorSinCos(&SinTheta, &CosTheta, Theta);
 
-				const float SinPhi = sinf(Phi);
-				const float CosPhi = cosf(Phi);
-				const float SinTheta= sinf(Theta);
-				const float CosTheta = cosf(Theta);
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&SinThetas[iHSubdivision]), SinTheta);
+			XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&CosThetas[iHSubdivision]), CosTheta);
 
-				FVertex Vertex;
+			// Tangent is the normalized partial derivative of Position with respect to Theta
+			RingVertices.Store(FVerticesSoA::TangentX, iHSubdivision, XMVectorNegate(SinTheta));
+			RingVertices.Store(FVerticesSoA::TangentY, iHSubdivision, XMVectorZero());
+			RingVertices.Store(FVerticesSoA::TangentZ, iHSubdivision, CosTheta);
 
-				// Convert Spherical coordinates to Cartesian
-				Vertex.Position.x = Radius*SinPhi*CosTheta;
-				Vertex.Position.y = Radius*CosPhi;
-				Vertex.Position.z = Radius*SinPhi*SinTheta;
+			RingVertices.Store(FVerticesSoA::TexCU, iHSubdivision, XMVectorScale(Theta, 1.0f / XM_2PI));
+		}
 
-				// Partial derivative of Position with respect to Theta
-				Vertex.Tangent.x = -Radius*SinPhi*SinTheta;
-				Vertex.Tangent.y = 0.0f;
-				Vertex.Tangent.z = Radius*SinPhi*CosTheta;
+		uint64 iVertex = 1;
+		for (auto iVSubdivision = 1; iVSubdivision <= NumVSubdivisions - 1; ++iVSubdivision)
+		{
+			const float Phi = PhiStep * iVSubdivision;
+			const auto SinPhi = XMVectorReplicate(sinf(Phi));
+			const auto CosPhi = XMVectorReplicate(cosf(Phi));
+
+			const auto TexCV = XMVectorReplicate(Phi / XM_PI);
 
-				Vertex.TexC.x = Theta / XM_2PI;
-				Vertex.TexC.y = Phi / XM_PI;
+			for (std::size_t iHSubdivision = 0; iHSubdivision < RingVertices.NumPaddedVertices; iHSubdivision += 4)
+			{
+				const auto SinTheta = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&SinThetas[iHSubdivision]));
+				const auto CosTheta = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&CosThetas[iHSubdivision]));
 
-				// Normalize tangent vector and store it as tangent vector
-				XMStoreFloat3(&Vertex.Tangent, XMVector3Normalize(XMLoadFloat3(&Vertex.Tangent)));
+				// Convert Spherical coordinates to Cartesian. Normal is the unit position
+				const auto NormalX = XMVectorMultiply(SinPhi, CosTheta);
+				const auto NormalZ = XMVectorMultiply(SinPhi, SinTheta);
 
-				// Normalize position vector and store it as normal vector
-				XMStoreFloat3(&Vertex.Normal, XMVector3Normalize(XMLoadFloat3(&Vertex.Position)));
+				RingVertices.Store(FVerticesSoA::PositionX, iHSubdivision, XMVectorScale(NormalX, Radius));
+				RingVertices.Store(FVerticesSoA::PositionY, iHSubdivision, XMVectorScale(CosPhi, Radius));
+				RingVertices.Store(FVerticesSoA::PositionZ, iHSubdivision, XMVectorScale(NormalZ, Radius));
 
-				SphereMeshData->Vertices[iVertex] = std::move(Vertex);
+				RingVertices.Store(FVerticesSoA::NormalX, iHSubdivision, NormalX);
+				RingVertices.Store(FVerticesSoA::NormalY, iHSubdivision, CosPhi);
+				RingVertices.Store(FVerticesSoA::NormalZ, iHSubdivision, NormalZ);
+
+				RingVertices.Store(FVerticesSoA::TexCV, iHSubdivision, TexCV);
 			}
+
+			RingVertices.Interleave(&SphereMeshData->Vertices[iVertex]);
+			iVertex += NumVertexInRing;
 		}
 
 		SphereMeshData->Vertices[iVertex] = std::move(BottomVertex);
@@ -173,7 +512,6 @@ namespace WoodenEngine
 			SphereMeshData->Indices[iIndex + 2] = iVertex;
 		}
 
-		const auto NumVertexInRing = NumHSubdivisions + 1;
 		for (auto iVSubdivision = 0; iVSubdivision < NumVSubdivisions-2; ++iVSubdivision)
 		{
 			for (auto iHSubdivision = 0; iHSubdivision < NumHSubdivisions; ++iHSubdivision, iIndex +=6)
@@ -242,26 +580,64 @@ namespace WoodenEngine
 			Subdivide(MeshData.get());
 		}
 
-		for (uint32_t i = 0; i < MeshData->Vertices.size(); ++i)
-		{
-			XMVECTOR Normal = XMVector3Normalize(XMLoadFloat3(&MeshData->Vertices[i].Position));
-			XMVECTOR Position = Normal * Radius;
-			XMStoreFloat3(&MeshData->Vertices[i].Position, Position);
-			XMStoreFloat3(&MeshData->Vertices[i].Normal, Normal);
+		FVerticesSoA SphereVertices(MeshData->Vertices.size());
+		SphereVertices.Deinterleave(MeshData->Vertices.data());
 
-			float theta = atan2f(MeshData->Vertices[i].Position.z, MeshData->Vertices[i].Position.x);    // Put in [0, 2pi].    
-			if(theta < 0.0f)      
-				theta += XM_2PI;    
-			float phi = acosf(MeshData->Vertices[i].Position.y/ Radius);
-			MeshData->Vertices[i].TexC.x = theta / XM_2PI;
-			MeshData->Vertices[i].TexC.y = phi / XM_PI;
+		for (std::size_t iVertex = 0; iVertex < SphereVertices.NumPaddedVertices; iVertex += 4)
+		{
+			const auto PositionX = SphereVertices.Load(FVerticesSoA::PositionX, iVertex);
+			const auto PositionY = SphereVertices.Load(FVerticesSoA::PositionY, iVertex);
+			const auto PositionZ = SphereVertices.Load(FVerticesSoA::PositionZ, iVertex);
+
+			// Padding lanes are zero, so their length is replaced by one
+			auto Length = XMVectorSqrt(XMVectorMultiplyAdd(PositionX, PositionX,
+				XMVectorMultiplyAdd(PositionY, PositionY, XMVectorMultiply(PositionZ, PositionZ))));
+			Length = XMVectorSelect(XMVectorSplatOne(), Length, XMVectorGreater(Length, XMVectorZero()));
+
+			const auto NormalX = XMVectorDivide(PositionX, Length);
+			const auto NormalY = XMVectorDivide(PositionY, Length);
+			const auto NormalZ = XMVectorDivide(PositionZ, Length);
+
+			SphereVertices.Store(FVerticesSoA::PositionX, iVertex, XMVectorScale(NormalX, Radius));
+			SphereVertices.Store(FVerticesSoA::PositionY, iVertex, XMVectorScale(NormalY, Radius));
+			SphereVertices.Store(FVerticesSoA::PositionZ, iVertex, XMVectorScale(NormalZ, Radius));
+
+			SphereVertices.Store(FVerticesSoA::NormalX, iVertex, NormalX);
+			SphereVertices.Store(FVerticesSoA::NormalY, iVertex, NormalY);
+			SphereVertices.Store(FVerticesSoA::NormalZ, iVertex, NormalZ);
+
+			// Put theta in [0, 2pi]
+			auto Theta = XMVectorATan2(NormalZ, NormalX);
+			Theta = XMVectorSelect(Theta, XMVectorAdd(Theta, XMVectorReplicate(XM_2PI)),
+				XMVectorLess(Theta, XMVectorZero()));
+
+			const auto Phi = XMVectorACos(XMVectorClamp(NormalY, XMVectorReplicate(-1.0f), XMVectorSplatOne()));
+
+			SphereVertices.Store(FVerticesSoA::TexCU, iVertex, XMVectorScale(Theta, 1.0f / XM_2PI));
+			SphereVertices.Store(FVerticesSoA::TexCV, iVertex, XMVectorScale(Phi, 1.0f / XM_PI));
+
+			XMVECTOR SinTheta, CosTheta;
+			XMVectorSinCos(&SinTheta, &CosTheta, Theta);
+
+			// Partial derivative of Position with respect to Theta, normalized. 
+			// It's zero on poles, where sin(phi) = 0
+			const auto SinPhi = XMVectorSin(Phi);
+			const auto TangentX = XMVectorNegate(XMVectorMultiply(SinPhi, SinTheta));
+			const auto TangentZ = XMVectorMultiply(SinPhi, CosTheta);
+
+			const auto TangentLength = XMVectorSqrt(
+				XMVectorMultiplyAdd(TangentX, TangentX, XMVectorMultiply(TangentZ, TangentZ)));
+			const auto bHasTangent = XMVectorGreater(TangentLength, XMVectorZero());
+
+			SphereVertices.Store(FVerticesSoA::TangentX, iVertex, 
+				XMVectorSelect(XMVectorZero(), XMVectorDivide(TangentX, TangentLength), bHasTangent));
+			SphereVertices.Store(FVerticesSoA::TangentY, iVertex, XMVectorZero());
+			SphereVertices.Store(FVerticesSoA::TangentZ, iVertex, 
+				XMVectorSelect(XMVectorZero(), XMVectorDivide(TangentZ, TangentLength), bHasTangent));
+		}
 
-			MeshData->Vertices[i].Tangent.x = -Radius * sinf(phi)*sinf(theta);
-			MeshData->Vertices[i].Tangent.y = 0.0f;
-			MeshData->Vertices[i].Tangent.z = +Radius * sinf(phi)*cosf(theta);
+		SphereVertices.Interleave(MeshData->Vertices.data());
 
-			XMStoreFloat3(&MeshData->Vertices[i].Tangent, XMVector3Normalize(XMLoadFloat3(&MeshData->Vertices[i].Tangent)));
-		}
 		return std::move(MeshData);
 	}
 
@@ -343,6 +719,8 @@ namespace WoodenEngine
 			0, 1, 2, 3
 		};
 
+		QuadMeshData->Topology = D3D_PRIMITIVE_TOPOLOGY_4_CONTROL_POINT_PATCHLIST;
+
 		return QuadMeshData;
 	}
 
@@ -379,9 +757,16 @@ namespace WoodenEngine
 			12, 13, 14, 15
 		};
 
+		QuadMeshData->Topology = D3D_PRIMITIVE_TOPOLOGY_16_CONTROL_POINT_PATCHLIST;
+
 		return QuadMeshData;
 	}
 
+	float FMeshGenerator::GetLandscapeHeight(float X, float Z) noexcept
+	{
+		return 0.5f*(sinf(X*0.2f)*X + cosf(Z*0.2f)*Z);
+	}
+
 	std::unique_ptr<WoodenEngine::FMeshRawData> FMeshGenerator::CreateLandscapeGrid(
 		float Width,
 		float Height, 
@@ -402,190 +787,469 @@ namespace WoodenEngine
 		 * Normal = [-sin(x/5)/2-x*cos(x/5)/10 1 z*sin(z/5)/10-cos(z/5)/2]
 		 */
 		
-		for (auto& Vertex : GridData->Vertices)
+		FVerticesSoA Vertices(GridData->Vertices.size());
+		Vertices.Deinterleave(GridData->Vertices.data());
+
+		const auto Half = XMVectorReplicate(0.5f);
+		const auto Tenth = XMVectorReplicate(0.1f);
+
+		for (std::size_t iVertex = 0; iVertex < Vertices.NumPaddedVertices; iVertex += 4)
 		{
-			float z = Vertex.Position.z;
-			float x = Vertex.Position.x;
+			const auto X = Vertices.Load(FVerticesSoA::PositionX, iVertex);
+			const auto Z = Vertices.Load(FVerticesSoA::PositionZ, iVertex);
 
-			Vertex.Position.y = 0.5*(sinf(x*0.2)*x + cosf(z*0.2)*z);
-			
-			Vertex.Tangent.x = 1;
-			Vertex.Tangent.y = 
-				cosf(z / 5) / 2.0f + sinf(x / 5) / 2.0f + x * cosf(x / 5) / 10.0f - z * sinf(z / 5) / 10;
-			Vertex.Tangent.z = 1;
-			XMStoreFloat3(&Vertex.Tangent, XMVector3Normalize(XMLoadFloat3(&Vertex.Tangent)));
+			XMVECTOR SinX, CosX, SinZ, CosZ;
+			XMVectorSinCos(&SinX, &CosX, XMVectorScale(X, 0.2f));
+			XMVectorSinCos(&SinZ, &CosZ, XMVectorScale(Z, 0.2f));
+
+			// diff(y, x) and diff(y, z)
+			const auto DiffX = XMVectorMultiplyAdd(SinX, Half, XMVectorMultiply(XMVectorMultiply(X, CosX), Tenth));
+			const auto DiffZ = XMVectorNegativeMultiplySubtract(
+				XMVectorMultiply(Z, SinZ), Tenth, XMVectorMultiply(CosZ, Half));
+
+			Vertices.Store(FVerticesSoA::PositionY, iVertex, 
+				XMVectorMultiply(Half, XMVectorMultiplyAdd(SinX, X, XMVectorMultiply(CosZ, Z))));
+
+			// Tangent = [1 diff(y, x)+diff(y, z) 1] / length
+			const auto TangentY = XMVectorAdd(DiffX, DiffZ);
+			const auto InvTangentLength = XMVectorReciprocal(
+				XMVectorSqrt(XMVectorMultiplyAdd(TangentY, TangentY, XMVectorReplicate(2.0f))));
+
+			Vertices.Store(FVerticesSoA::TangentX, iVertex, InvTangentLength);
+			Vertices.Store(FVerticesSoA::TangentY, iVertex, XMVectorMultiply(TangentY, InvTangentLength));
+			Vertices.Store(FVerticesSoA::TangentZ, iVertex, InvTangentLength);
+
+			// Normal = [-diff(y, x) 1 -diff(y, z)] / length
+			const auto InvNormalLength = XMVectorReciprocal(XMVectorSqrt(XMVectorMultiplyAdd(DiffX, DiffX,
+				XMVectorMultiplyAdd(DiffZ, DiffZ, XMVectorSplatOne()))));
 
-			Vertex.Normal.x = -sinf(x / 5) / 2 - x * cosf(x / 5) / 10;
-			Vertex.Normal.y = 1;
-			Vertex.Normal.z = z * sinf(z / 5) / 10 - cosf(z / 5) / 2;
-			XMStoreFloat3(&Vertex.Normal, XMVector3Normalize(XMLoadFloat3(&Vertex.Normal)));
+			Vertices.Store(FVerticesSoA::NormalX, iVertex, XMVectorNegate(XMVectorMultiply(DiffX, InvNormalLength)));
+			Vertices.Store(FVerticesSoA::NormalY, iVertex, InvNormalLength);
+			Vertices.Store(FVerticesSoA::NormalZ, iVertex, XMVectorNegate(XMVectorMultiply(DiffZ, InvNormalLength)));
 		}
 
+		Vertices.Interleave(GridData->Vertices.data());
+
 		return GridData;
 	}
 
-	void FMeshGenerator::Subdivide(FMeshRawData* MeshData) const noexcept
+	void FMeshGenerator::Subdivide(FMeshRawData* MeshData, bool bAllowParallel) const noexcept
 	{
-		const auto CopiedMeshData = *MeshData;
+		const auto NumVertices = MeshData->Vertices.size();
+		const auto NumTriangles = MeshData->Indices.size() / 3;
+
+		if (NumTriangles == 0)
+		{
+			return;
+		}
 
-		MeshData->Vertices.resize(0);
-		MeshData->Indices.resize(0);
+		const bool bParallel = bAllowParallel && NumTriangles >= NumParallelSubdivisionTriangles;
+		const auto NumChunks = (NumTriangles + NumParallelSubdivisionTriangles - 1) / NumParallelSubdivisionTriangles;
 
-		const auto NumTriangles = CopiedMeshData.Indices.size() / 3;
-		for (auto i = 0; i < NumTriangles; ++i)
+		// Every edge is identified by the sorted pair of its vertices.
+		// Shared edges get the same key, so every midpoint is created only once
+		auto MakeEdgeKey = [](uint32 iVertex0, uint32 iVertex1) -> uint64
 		{
-			auto V0 = CopiedMeshData.Vertices[CopiedMeshData.Indices[i * 3 + 0]];
-			auto V1 = CopiedMeshData.Vertices[CopiedMeshData.Indices[i * 3 + 1]];
-			auto V2 = CopiedMeshData.Vertices[CopiedMeshData.Indices[i * 3 + 2]];
+			return (iVertex0 < iVertex1) ?
+				(static_cast<uint64>(iVertex0) << 32) | iVertex1 :
+				(static_cast<uint64>(iVertex1) << 32) | iVertex0;
+		};
 
-			auto M0 = FVertex::MidPoint(V0, V1);
-			auto M1 = FVertex::MidPoint(V1, V2);
-			auto M2 = FVertex::MidPoint(V0, V2);
+		// Runs Func(iBegin, iEnd) over triangles' ranges, on worker threads if it's allowed
+		auto ForEachTrianglesRange = [&](auto&& Func)
+		{
+			if (!bParallel)
+			{
+				Func(std::size_t(0), NumTriangles);
+				return;
+			}
 
-			MeshData->Vertices.push_back(std::move(V0));
-			MeshData->Vertices.push_back(std::move(V1));
-			MeshData->Vertices.push_back(std::move(V2));
-			MeshData->Vertices.push_back(std::move(M0));
-			MeshData->Vertices.push_back(std::move(M1));
-			MeshData->Vertices.push_back(std::move(M2));
+			Concurrency::parallel_for(std::size_t(0), NumChunks, [&](std::size_t iChunk)
+			{
+				const auto iBegin = iChunk * NumParallelSubdivisionTriangles;
+				const auto iEnd = std::min<std::size_t>(iBegin + NumParallelSubdivisionTriangles, NumTriangles);
+				Func(iBegin, iEnd);
+			});
+		};
 
-			MeshData->Indices.push_back(i * 6 + 0);
-			MeshData->Indices.push_back(i * 6 + 3);
-			MeshData->Indices.push_back(i * 6 + 5);
+		// Midpoints cache: sorted unique edges, midpoint of edge i is vertex NumVertices+i
+		std::vector<uint64> EdgeKeys(NumTriangles * 3);
+		ForEachTrianglesRange([&](std::size_t iBegin, std::size_t iEnd)
+		{
+			for (auto iTriangle = iBegin; iTriangle < iEnd; ++iTriangle)
+			{
+				const auto* Triangle = &MeshData->Indices[iTriangle * 3];
+				EdgeKeys[iTriangle * 3 + 0] = MakeEdgeKey(Triangle[0], Triangle[1]);
+				EdgeKeys[iTriangle * 3 + 1] = MakeEdgeKey(Triangle[1], Triangle[2]);
+				EdgeKeys[iTriangle * 3 + 2] = MakeEdgeKey(Triangle[0], Triangle[2]);
+			}
+		});
 
-			MeshData->Indices.push_back(i * 6 + 3);
-			MeshData->Indices.push_back(i * 6 + 4);
-			MeshData->Indices.push_back(i * 6 + 5);
+		std::vector<uint64> Edges(EdgeKeys);
+		if (bParallel)
+		{
+			Concurrency::parallel_sort(Edges.begin(), Edges.end());
+		}
+		else
+		{
+			std::sort(Edges.begin(), Edges.end());
+		}
+		Edges.erase(std::unique(Edges.begin(), Edges.end()), Edges.end());
+
+		const auto NumEdges = Edges.size();
+
+		// Output is presized: every edge adds one vertex, every triangle is split to 4 triangles
+		MeshData->Vertices.resize(NumVertices + NumEdges);
+
+		auto ComputeMidPoints = [&](std::size_t iBegin, std::size_t iEnd)
+		{
+			for (auto iEdge = iBegin; iEdge < iEnd; ++iEdge)
+			{
+				const auto iVertex0 = static_cast<uint32>(Edges[iEdge] >> 32);
+				const auto iVertex1 = static_cast<uint32>(Edges[iEdge] & 0xFFFFFFFF);
 
-			MeshData->Indices.push_back(i * 6 + 5);
-			MeshData->Indices.push_back(i * 6 + 4);
-			MeshData->Indices.push_back(i * 6 + 2);
+				MeshData->Vertices[NumVertices + iEdge] = FVertex::MidPoint(
+					MeshData->Vertices[iVertex0], MeshData->Vertices[iVertex1]);
+			}
+		};
 
-			MeshData->Indices.push_back(i * 6 + 3);
-			MeshData->Indices.push_back(i * 6 + 1);
-			MeshData->Indices.push_back(i * 6 + 4);
+		if (bParallel)
+		{
+			const auto NumEdgesChunks = (NumEdges + NumParallelSubdivisionTriangles - 1) / NumParallelSubdivisionTriangles;
+			Concurrency::parallel_for(std::size_t(0), NumEdgesChunks, [&](std::size_t iChunk)
+			{
+				const auto iBegin = iChunk * NumParallelSubdivisionTriangles;
+				ComputeMidPoints(iBegin, std::min<std::size_t>(iBegin + NumParallelSubdivisionTriangles, NumEdges));
+			});
+		}
+		else
+		{
+			ComputeMidPoints(0, NumEdges);
 		}
+
+		const auto SourceIndices = std::move(MeshData->Indices);
+		MeshData->Indices.resize(NumTriangles * 12);
+
+		ForEachTrianglesRange([&](std::size_t iBegin, std::size_t iEnd)
+		{
+			auto FindMidPoint = [&](uint64 EdgeKey)
+			{
+				const auto EdgeIter = std::lower_bound(Edges.cbegin(), Edges.cend(), EdgeKey);
+				return static_cast<uint32>(NumVertices + (EdgeIter - Edges.cbegin()));
+			};
+
+			for (auto iTriangle = iBegin; iTriangle < iEnd; ++iTriangle)
+			{
+				const auto V0 = SourceIndices[iTriangle * 3 + 0];
+				const auto V1 = SourceIndices[iTriangle * 3 + 1];
+				const auto V2 = SourceIndices[iTriangle * 3 + 2];
+
+				const auto M0 = FindMidPoint(EdgeKeys[iTriangle * 3 + 0]);
+				const auto M1 = FindMidPoint(EdgeKeys[iTriangle * 3 + 1]);
+				const auto M2 = FindMidPoint(EdgeKeys[iTriangle * 3 + 2]);
+
+				auto* Triangles = &MeshData->Indices[iTriangle * 12];
+
+				Triangles[0] = V0;
+				Triangles[1] = M0;
+				Triangles[2] = M2;
+
+				Triangles[3] = M0;
+				Triangles[4] = M1;
+				Triangles[5] = M2;
+
+				Triangles[6] = M2;
+				Triangles[7] = M1;
+				Triangles[8] = V2;
+
+				Triangles[9] = M0;
+				Triangles[10] = V1;
+				Triangles[11] = M1;
+			}
+		});
 	}
 
 	std::unique_ptr<FMeshRawData> FMeshParser::ParseTxtData(const std::string& FilePath) const
 	{
+		const auto StartTime = std::chrono::high_resolution_clock::now();
+
 		// use smart pointer for preventing memory leak if exception is thrown
 		auto MeshData = std::make_unique<FMeshRawData>();
 
-		std::ifstream File;
-		File.open(FilePath, std::ios_base::in);
+		DX::FMappedFile File(FilePath);
+		const auto* Begin = reinterpret_cast<const char*>(File.GetData());
+		const auto* End = Begin + File.GetSize();
+
+		// Header: number of vertices and number of triangles
+		uint64 NumVertices = 0;
+		uint64 NumTriangles = 0;
+
+		auto* Cursor = SkipTxtSpaces(Begin, End);
+		auto* TokenEnd = FindTxtTokenEnd(Cursor, End);
+		const bool bValidNumVertices = ParseTxtUInt(Cursor, TokenEnd, &NumVertices);
 
-		if (!File.is_open())
+		Cursor = SkipTxtSpaces(TokenEnd, End);
+		TokenEnd = FindTxtTokenEnd(Cursor, End);
+		const bool bValidNumTriangles = ParseTxtUInt(Cursor, TokenEnd, &NumTriangles);
+
+		if (!bValidNumVertices || !bValidNumTriangles || NumVertices > UINT32_MAX || NumTriangles > UINT32_MAX)
 		{
-			throw std::invalid_argument("File can't be opened by path " + FilePath);
+			throw std::invalid_argument("File " + FilePath + " has invalid vertices/triangles counts");
 		}
 
-		if (File.eof())
+		// Every vertex is 6 floats: position and normal
+		const auto NumVertexValues = NumVertices * 6;
+		const auto NumIndices = NumTriangles * 3;
+		const auto NumValues = NumVertexValues + NumIndices;
+
+		// A value takes 2 chars at least with its separator, so counts are checked before allocating
+		const auto* BodyBegin = TokenEnd;
+		if (NumValues > static_cast<uint64>(End - BodyBegin) / 2 + 1)
 		{
-			throw std::invalid_argument("File " + FilePath + "is empty");
+			throw std::invalid_argument("File " + FilePath + " is truncated");
+		}
+
+		MeshData->Vertices.resize(NumVertices);
+		MeshData->Indices.resize(NumIndices);
+
+		// Split the body to line-aligned chunks, so no token crosses their bounds
+		const auto BodySize = static_cast<std::size_t>(End - BodyBegin);
+		const auto NumChunks = std::max<std::size_t>(BodySize / TxtChunkSize, 1);
+
+		std::vector<const char*> ChunksBegins(NumChunks + 1);
+		ChunksBegins[0] = BodyBegin;
+		ChunksBegins[NumChunks] = End;
+		for (std::size_t iChunk = 1; iChunk < NumChunks; ++iChunk)
+		{
+			const auto* ChunkBegin = std::max(BodyBegin + iChunk*TxtChunkSize, ChunksBegins[iChunk - 1]);
+			ChunkBegin = std::find(ChunkBegin, End, '\n');
+			ChunksBegins[iChunk] = ChunkBegin == End ? End : ChunkBegin + 1;
 		}
-		
-		uint16 NumVertices;
-		File >> NumVertices;
-		MeshData->Vertices.reserve(NumVertices);
-		
-		uint16 NumIndices;
-		File >> NumIndices;
-		MeshData->Indices.reserve(NumIndices*3);
 
-		auto VerticesIter = MeshData->Vertices.cend();
-		std::string StrVertexData;
-		for (auto iVertex = 0; iVertex < MeshData->Vertices.capacity(); ++iVertex)
+		// Index of the first value of every chunk
+		std::vector<uint64> ChunksFirstValues(NumChunks + 1, 0);
+		concurrency::parallel_for(std::size_t(0), NumChunks, [&](std::size_t iChunk)
 		{
-			FVertex Vertex;
-			File >> Vertex.Position.x >> Vertex.Position.y >> Vertex.Position.z;
-			File >> Vertex.Normal.x >> Vertex.Normal.y >> Vertex.Normal.z;
+			ChunksFirstValues[iChunk + 1] = CountTxtTokens(ChunksBegins[iChunk], ChunksBegins[iChunk + 1]);
+		});
 
-			VerticesIter = MeshData->Vertices.insert(VerticesIter, std::move(Vertex));
-			VerticesIter++;
+		for (std::size_t iChunk = 0; iChunk < NumChunks; ++iChunk)
+		{
+			ChunksFirstValues[iChunk + 1] += ChunksFirstValues[iChunk];
 		}
 
-		auto IndicesIter = MeshData->Indices.cend();
-		std::string StrIndexData;
-		for (auto iIndex = 0; iIndex < MeshData->Indices.capacity(); ++iIndex)
+		if (ChunksFirstValues[NumChunks] < NumValues)
 		{
-			uint16 Index;
-			File >> Index;
-			IndicesIter = MeshData->Indices.insert(IndicesIter, std::move(Index));
-			IndicesIter++;
+			throw std::invalid_argument("File " + FilePath + " is truncated");
 		}
 
-		File.close();
+		auto& Vertices = MeshData->Vertices;
+		auto& Indices = MeshData->Indices;
+		concurrency::parallel_for(std::size_t(0), NumChunks, [&](std::size_t iChunk)
+		{
+			auto iValue = ChunksFirstValues[iChunk];
+			const auto* ChunkEnd = ChunksBegins[iChunk + 1];
+
+			auto* Cursor = SkipTxtSpaces(ChunksBegins[iChunk], ChunkEnd);
+			for (; Cursor != ChunkEnd && iValue < NumValues; Cursor = SkipTxtSpaces(Cursor, ChunkEnd), ++iValue)
+			{
+				const auto* TokenEnd = FindTxtTokenEnd(Cursor, ChunkEnd);
+
+				if (iValue < NumVertexValues)
+				{
+					float Value = 0.0f;
+					if (!ParseTxtFloat(Cursor, TokenEnd, &Value))
+					{
+						throw std::invalid_argument("File " + FilePath + " has invalid vertex data");
+					}
+
+					auto& Vertex = Vertices[iValue / 6];
+					switch (iValue % 6)
+					{
+					case 0: Vertex.Position.x = Value; break;
+					case 1: Vertex.Position.y = Value; break;
+					case 2: Vertex.Position.z = Value; break;
+					case 3: Vertex.Normal.x = Value; break;
+					case 4: Vertex.Normal.y = Value; break;
+					case 5: Vertex.Normal.z = Value; break;
+					}
+				}
+				else
+				{
+					uint64 Index = 0;
+					if (!ParseTxtUInt(Cursor, TokenEnd, &Index) || Index > UINT32_MAX)
+					{
+						throw std::invalid_argument("File " + FilePath + " has invalid index data");
+					}
+
+					Indices[iValue - NumVertexValues] = static_cast<uint32>(Index);
+				}
+
+				Cursor = TokenEnd;
+			}
+		});
+
+		const std::chrono::duration<double> ParseTime = std::chrono::high_resolution_clock::now() - StartTime;
+		DBOUT(FilePath + " parsed", File.GetSize() / (1024.0 * 1024.0) / ParseTime.count() << " MB/s");
+
 		return MeshData;
 	}
 
 	std::unique_ptr<FMeshRawData> FMeshParser::ParseObjFile(const std::string& FilePath) const
 	{
-		Assimp::Importer Importer;
+		const auto ImportedScene = ParseScene(FilePath, EImportPreset::Fast);
+		if (ImportedScene->SubmeshesData.empty())
+		{
+			throw std::invalid_argument("The file " + FilePath + " has no meshes");
+		}
+
+		const auto& FirstSubmeshData = *ImportedScene->SubmeshesData[0];
+
+		auto MeshData = std::make_unique<FMeshRawData>(FirstSubmeshData.Name);
+		MeshData->MaterialIndex = FirstSubmeshData.MaterialIndex;
+		for (const auto& SubmeshData : ImportedScene->SubmeshesData)
+		{
+			AppendTransformedSubmesh(*SubmeshData, MeshData.get());
+		}
 
-		const auto* Scene = Importer.ReadFile(FilePath,
+		return MeshData;
+	}
+
+	std::unique_ptr<FImportedScene> FMeshParser::ParseScene(
+		const std::string& FilePath,
+		EImportPreset Preset) const
+	{
+		const auto StartTime = std::chrono::high_resolution_clock::now();
+
+		// Points and lines are dropped, welding and cache optimizations are done by FMeshBaker
+		uint32 PostProcessFlags =
 			aiProcess_Triangulate |
-			aiProcess_ConvertToLeftHanded);
+			aiProcess_SortByPType |
+			aiProcess_ConvertToLeftHanded;
 
-		if (Scene == nullptr)
+		if (Preset == EImportPreset::Quality)
 		{
-			throw std::invalid_argument("The file " + FilePath + " can't be opened");
+			PostProcessFlags |=
+				aiProcess_GenSmoothNormals |
+				aiProcess_CalcTangentSpace |
+				aiProcess_GenUVCoords |
+				aiProcess_TransformUVCoords |
+				aiProcess_FindDegenerates |
+				aiProcess_FindInvalidData |
+				aiProcess_RemoveRedundantMaterials |
+				aiProcess_ValidateDataStructure;
 		}
 
-		auto* RootNode = (aiMesh*)(Scene->mMeshes[0]);
+		Assimp::Importer Importer;
+		Importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+		Importer.SetPropertyBool(AI_CONFIG_PP_FD_REMOVE, true);
 
-		auto MeshData = std::make_unique<FMeshRawData>();
-		MeshData->Name = RootNode->mName.C_Str();
-		MeshData->Vertices.resize(RootNode->mNumVertices);
+		const auto* Scene = Importer.ReadFile(FilePath, PostProcessFlags);
+		if (Scene == nullptr || Scene->mRootNode == nullptr)
+		{
+			throw std::invalid_argument("The file " + FilePath + " can't be imported: " + Importer.GetErrorString());
+		}
 
-		for (auto iVertex = 0; iVertex < RootNode->mNumVertices; ++iVertex)
+		const auto ReadTime = std::chrono::high_resolution_clock::now();
+
+		// Mesh instance of a node with the node's global transform
+		struct FMeshReference
 		{
-			XMFLOAT3 Position = { 
-				RootNode->mVertices[iVertex].x,
-				RootNode->mVertices[iVertex].y, 
-				RootNode->mVertices[iVertex].z 
-			};
+			uint32 iMesh;
+			std::string Name;
+			XMFLOAT4X4 Transform;
+		};
+
+		std::vector<FMeshReference> MeshesReferences;
+		std::vector<uint32> NumMeshesReferences(Scene->mNumMeshes, 0);
 
-			FVertex Vertex = { std::move(Position) };
+		// Depth-first traversal of the nodes' hierarchy
+		std::vector<std::pair<const aiNode*, aiMatrix4x4>> Nodes;
+		Nodes.emplace_back(Scene->mRootNode, Scene->mRootNode->mTransformation);
+		while (!Nodes.empty())
+		{
+			const auto* Node = Nodes.back().first;
+			const auto NodeTransform = Nodes.back().second;
+			Nodes.pop_back();
 
-			if (RootNode->mNormals != nullptr)
+			for (uint32 iChild = 0; iChild < Node->mNumChildren; ++iChild)
 			{
-				Vertex.Normal = {
-					RootNode->mNormals[iVertex].x,
-					RootNode->mNormals[iVertex].y,
-					RootNode->mNormals[iVertex].z,
-				};
+				const auto* Child = Node->mChildren[iChild];
+				Nodes.emplace_back(Child, NodeTransform * Child->mTransformation);
 			}
 
-			if (RootNode->mTangents != nullptr)
+			for (uint32 iNodeMesh = 0; iNodeMesh < Node->mNumMeshes; ++iNodeMesh)
 			{
-				Vertex.Tangent = {
-					RootNode->mTangents[iVertex].x,
-					RootNode->mTangents[iVertex].y,
-					RootNode->mTangents[iVertex].z,
-				};
+				FMeshReference MeshReference;
+				MeshReference.iMesh = Node->mMeshes[iNodeMesh];
+				MeshReference.Name = std::string(Node->mName.C_Str()) + "/" + 
+					Scene->mMeshes[MeshReference.iMesh]->mName.C_Str();
+
+				// Assimp's matrices transform column vectors, ours transform row ones
+				const auto Transform = aiMatrix4x4(NodeTransform).Transpose();
+				MeshReference.Transform = XMFLOAT4X4(&Transform.a1);
+
+				++NumMeshesReferences[MeshReference.iMesh];
+				MeshesReferences.push_back(std::move(MeshReference));
 			}
+		}
+
+		const auto TraverseTime = std::chrono::high_resolution_clock::now();
 
-			if (RootNode->mTextureCoords[0] != nullptr)
+		// Every referenced mesh is converted once
+		std::vector<std::unique_ptr<FMeshRawData>> MeshesData(Scene->mNumMeshes);
+		concurrency::parallel_for(uint32(0), Scene->mNumMeshes, [&](uint32 iMesh)
+		{
+			if (NumMeshesReferences[iMesh] > 0)
 			{
-				Vertex.TexC = {
-					RootNode->mTextureCoords[0][iVertex].x,
-					RootNode->mTextureCoords[0][iVertex].y,
-				};
+				MeshesData[iMesh] = std::make_unique<FMeshRawData>();
+				ConvertAssimpMesh(*Scene->mMeshes[iMesh], MeshesData[iMesh].get());
 			}
+		});
+
+		const auto ConvertTime = std::chrono::high_resolution_clock::now();
 
-			MeshData->Vertices[iVertex] = std::move(Vertex);
+		auto ImportedScene = std::make_unique<FImportedScene>();
+		ImportedScene->MaterialsNames.reserve(Scene->mNumMaterials);
+		for (uint32 iMaterial = 0; iMaterial < Scene->mNumMaterials; ++iMaterial)
+		{
+			aiString MaterialName;
+			Scene->mMaterials[iMaterial]->Get(AI_MATKEY_NAME, MaterialName);
+			ImportedScene->MaterialsNames.push_back(MaterialName.C_Str());
 		}
 
-		for (auto iFace = 0; iFace < RootNode->mNumFaces; ++iFace)
+		// Submeshes are keyed by names, so repeated names get the index of their reference
+		std::unordered_map<std::string, uint32> NumSubmeshesNames;
+		for (auto& MeshReference : MeshesReferences)
 		{
-			auto Face = RootNode->mFaces[iFace];
-			for (auto iIndex = 0; iIndex < Face.mNumIndices; ++iIndex)
-			{
-				MeshData->Indices.push_back(Face.mIndices[iIndex]);
-			}
+			auto& MeshData = MeshesData[MeshReference.iMesh];
+			auto SubmeshData = --NumMeshesReferences[MeshReference.iMesh] == 0 ?
+				std::move(MeshData) :
+				std::make_unique<FMeshRawData>(*MeshData);
+
+			const auto NumNames = NumSubmeshesNames[MeshReference.Name]++;
+			SubmeshData->Name = NumNames == 0 ? 
+				MeshReference.Name : 
+				MeshReference.Name + "_" + std::to_string(NumNames);
+			SubmeshData->Transform = MeshReference.Transform;
+
+			ImportedScene->SubmeshesData.push_back(std::move(SubmeshData));
 		}
 
-		return MeshData;
+		const auto EndTime = std::chrono::high_resolution_clock::now();
+		const std::chrono::duration<double, std::milli> ReadDuration = ReadTime - StartTime;
+		const std::chrono::duration<double, std::milli> TraverseDuration = TraverseTime - ReadTime;
+		const std::chrono::duration<double, std::milli> ConvertDuration = ConvertTime - TraverseTime;
+		const std::chrono::duration<double, std::milli> GatherDuration = EndTime - ConvertTime;
+		DBOUT(FilePath + " imported", Scene->mNumMeshes << " meshes, " << 
+			ImportedScene->SubmeshesData.size() << " submeshes, " <<
+			Scene->mNumMaterials << " materials");
+		DBOUT(FilePath + " import times", 
+			"read and post-process " << ReadDuration.count() << " ms, " <<
+			"nodes " << TraverseDuration.count() << " ms, " <<
+			"conversion " << ConvertDuration.count() << " ms, " <<
+			"gathering " << GatherDuration.count() << " ms");
+
+		return ImportedScene;
 	}
 }
\ No newline at end of file
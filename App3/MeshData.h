@@ -3,6 +3,8 @@
 #include <string>
 #include <unordered_map>
 
+#include "GeometryArena.h"
+#include "ResourcePool.h"
 #include "ShaderStructures.h"
 
 namespace WoodenEngine
@@ -86,9 +88,69 @@ namespace WoodenEngine
 		{ }
 
 		std::vector<FVertex> Vertices;
-		std::vector<uint16> Indices;
+		std::vector<uint32> Indices;
 
 		std::string Name;
+
+		// How indices are assembled to primitives. 
+		// Triangle lists only are processed by mesh optimizations
+		D3D_PRIMITIVE_TOPOLOGY Topology = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+		// Max distance from source vertices to the mesh in its units. Zero for non-simplified meshes
+		float GeometricError = 0.0f;
+
+		// Transform from the mesh's space to space of the whole imported scene
+		XMFLOAT4X4 Transform = MathHelper::Identity4x4();
+
+		// Index of the mesh's material in materials of its source asset
+		uint32 MaterialIndex = 0;
+	};
+
+	/*!
+	 * \enum EVertexFormat
+	 *
+	 * \brief Layout of static meshes' vertices in the GPU vertex buffer
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	enum class EVertexFormat : uint8
+	{
+		// SVertexData: float position, normal and uv (32B)
+		Full = 0,
+
+		// SPackedVertexData: float position, octahedral normal/tangent, half uv (20B)
+		Packed,
+
+		// SQuantizedVertexData: unorm16 position and uv in submesh's bounds,
+		// octahedral normal/tangent (16B)
+		Quantized
+	};
+
+	/*!
+	 * \struct FMeshlet
+	 *
+	 * \brief Cluster of a submesh's triangles, which is drawn or culled as a whole.
+	 * Its triangles are a contiguous range of the submesh's indices
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FMeshlet
+	{
+		// First index of the meshlet relative to the submesh's IndexBegin
+		uint32 IndexBegin = 0;
+		uint32 NumTriangles = 0;
+		uint32 NumVertices = 0;
+
+		XMFLOAT3 BoundingSphereCenter = { 0.0f, 0.0f, 0.0f };
+		float BoundingSphereRadius = 0.0f;
+
+		// Average normal of the meshlet's triangles
+		XMFLOAT3 ConeAxis = { 0.0f, 0.0f, 0.0f };
+
+		// Sine of the normal cone's angle. 1.0 means the meshlet can't be backface culled
+		float ConeCutoff = 1.0f;
 	};
 
 	/*!
@@ -112,7 +174,95 @@ namespace WoodenEngine
 
 		uint64 IndexBegin;
 		uint64 NumIndices;
-		uint16 VertexBegin;
+		uint32 VertexBegin;
+		uint32 NumVertices = 0;
+
+		// Axis-aligned bounds of the submesh's vertices in its local space
+		XMFLOAT3 BoundsMin = { 0.0f, 0.0f, 0.0f };
+		XMFLOAT3 BoundsMax = { 0.0f, 0.0f, 0.0f };
+
+		// Clusters of the submesh in order of its indices. Empty if the submesh isn't clusterized
+		std::vector<FMeshlet> Meshlets;
+
+		// Max distance from source vertices to the submesh in its units. Zero for non-simplified submeshes
+		float GeometricError = 0.0f;
+
+		// Simplified versions of the submesh ("<Name>_lod<i>") from detailed to coarse ones
+		std::vector<const FSubmeshData*> LODs;
+
+		// Decoding of packed vertices of the submesh. Identity for the full format
+		SVertexQuantizationData VertexQuantization;
+
+		// Transform from the submesh's space to its mesh's space. Applied before objects' world transform
+		XMFLOAT4X4 Transform = MathHelper::Identity4x4();
+
+		// Index of the submesh's material in materials of its source asset
+		uint32 MaterialIndex = 0;
+
+		// Name of the material of MaterialIndex. Empty if the source asset has no materials.
+		// Objects without their own materials are drawn with the engine's material of the name
+		std::string MaterialName;
+	};
+
+	/*!
+	 * \struct FSubmeshHandle
+	 *
+	 * \brief Submesh of a static mesh interned by FGameResource::GetSubmeshHandle.
+	 * Objects refer submeshes by it, so they're drawn without lookups by names
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FSubmeshHandle
+	{
+		static constexpr uint32 InvalidIndex = UINT32_MAX;
+
+		// Index of the submesh's slot in FGameResource
+		uint32 Index = InvalidIndex;
+
+		bool IsValid() const noexcept
+		{
+			return Index != InvalidIndex;
+		}
+	};
+
+	/*!
+	 * \enum EImportPreset
+	 *
+	 * \brief Post-processing of assets imported by assimp
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	enum class EImportPreset : uint8
+	{
+		// Triangulation only. Welding and optimizations are left for FMeshBaker
+		Fast = 0,
+
+		// Generates missing normals, tangents and uvs, removes degenerate and invalid data
+		Quality
+	};
+
+	/*!
+	 * \struct FImportedScene
+	 *
+	 * \brief Meshes of a scene imported by assimp
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FImportedScene
+	{
+		FImportedScene() = default;
+
+		FImportedScene(const FImportedScene& ImportedScene) = delete;
+		FImportedScene& operator=(const FImportedScene& ImportedScene) = delete;
+
+		// Submesh per mesh referenced by the scene's nodes. Transforms are the nodes' global ones
+		std::vector<std::unique_ptr<FMeshRawData>> SubmeshesData;
+
+		// Names of the scene's materials indexed by FMeshRawData::MaterialIndex
+		std::vector<std::string> MaterialsNames;
 	};
 
 	/*!
@@ -130,27 +280,42 @@ namespace WoodenEngine
 		FMeshData(const FMeshData& MeshData) = delete;
 		FMeshData& operator=(const FMeshData& MeshData) = delete;
 
+		// Meshes are moved inside of FResourcePool. Submeshes stay at their addresses
+		FMeshData(FMeshData&& MeshData) = default;
+		FMeshData& operator=(FMeshData&& MeshData) = default;
+
 		FMeshData(const std::string& Name):
 			Name(Name)
 		{ }
 
 		std::string Name;
 
-		// DX12 Buffer of vertices of static meshes
-		ComPtr<ID3D12Resource> VertexBuffer;
-		ComPtr<ID3D12Resource> VertexUploadBuffer;
+		// Range of vertices in the geometry arena
+		FGeometryAllocation VertexAllocation;
 
+		// View of the whole arena's page, which is shared by meshes of the page
 		D3D12_VERTEX_BUFFER_VIEW VertexBufferView;
 
-		// DX12 Buffer of indices of static meshes
-		ComPtr<ID3D12Resource> IndexBuffer;
-		ComPtr<ID3D12Resource> IndexUploadBuffer;
+		// First vertex of the mesh in the page. Added to submeshes' VertexBegin
+		uint32 BaseVertexLocation = 0;
 
+		EVertexFormat VertexFormat = EVertexFormat::Full;
+
+		// Range of indices in the geometry arena
+		FGeometryAllocation IndexAllocation;
+
+		// View of the whole arena's page, which is shared by meshes of the page
 		D3D12_INDEX_BUFFER_VIEW IndexBufferView;
+
+		// First index of the mesh in the page. Added to submeshes' IndexBegin
+		uint32 StartIndexLocation = 0;
 		
 		std::unordered_map<std::string, std::unique_ptr<FSubmeshData>> SubmeshesData;
 	};
 
+	// Handle of a static mesh of FGameResource. It becomes stale when the mesh is removed
+	using FMeshHandle = FPoolHandle<FMeshData>;
+
 	/*!
 	 * \class FMeshGenerator
 	 *
@@ -247,11 +412,26 @@ namespace WoodenEngine
 			uint32 NumHSubdivisions
 		) const noexcept;
 
-		/** @brief Subdivide mesh data (every triangle of it's to 3 triangles)
+		/** @brief Height of the landscape generated by CreateLandscapeGrid:
+		  * y = 0.5*(sin(0.2x)x + cos(0.2z)z)
+		  * @param X (float)
+		  * @param Z (float)
+		  * @return (float)
+		  */
+		static float GetLandscapeHeight(float X, float Z) noexcept;
+
+		/** @brief Subdivide mesh data (every triangle of it's to 4 triangles)
+		  * Midpoints of shared edges are shared by the adjacent triangles,
+		  * so every level multiplies number of vertices by ~4
 		  * @param MeshData Mesh data (FMeshData* MeshData)
+		  * @param bAllowParallel Splits big meshes across worker threads by triangles' ranges (bool)
 		  * @return (void)
 		  */
-		void Subdivide(FMeshRawData* MeshData) const noexcept;
+		void Subdivide(FMeshRawData* MeshData, bool bAllowParallel = true) const noexcept;
+
+	private:
+		// Number of triangles processed by one worker thread in parallel subdivision
+		static constexpr std::size_t NumParallelSubdivisionTriangles = 4096;
 	};
 
 	/*!
@@ -278,10 +458,22 @@ namespace WoodenEngine
 		*/
 		std::unique_ptr<FMeshRawData>ParseTxtData(const std::string& FilePath) const;
 
-		/** @brief Parses external .obj file with mesh data
+		/** @brief Imports every mesh of the .obj file by ParseScene and merges them in the scene's space.
+		* The merged mesh keeps material of the first mesh
 		* @param FilePath Path to file (format: *.obj) with mesh data (const std::string &)
 		* @return Parsed mesh data (WoodenEngine::FMeshData)
 		*/
 		std::unique_ptr<FMeshRawData> ParseObjFile(const std::string& FilePath) const;
+
+		/** @brief Imports every mesh of a scene file supported by assimp.
+		  * Meshes are converted in parallel, time of every import stage is logged
+		  * @param FilePath Path to file (format: *.obj, *.fbx etc) (const std::string &)
+		  * @param Preset Post-processing of the scene (EImportPreset)
+		  * @return Submeshes with their nodes' transforms and materials
+		  * (std::unique_ptr<WoodenEngine::FImportedScene>)
+		  */
+		std::unique_ptr<FImportedScene> ParseScene(
+			const std::string& FilePath, 
+			EImportPreset Preset = EImportPreset::Fast) const;
 	};
 }
\ No newline at end of file
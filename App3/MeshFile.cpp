@@ -0,0 +1,366 @@
+#include <chrono>
+#include <cstring>
+#include <fstream>
+
+#include "MeshFile.h"
+#include "VertexPacker.h"
+
+namespace WoodenEngine
+{
+	namespace
+	{
+		uint64 AlignBlobOffset(uint64 Offset)
+		{
+			return (Offset + MeshFileBlobAlignment - 1) & ~(MeshFileBlobAlignment - 1);
+		}
+
+		bool IsRangeInside(uint64 Offset, uint64 Size, uint64 ContainerSize)
+		{
+			return Offset <= ContainerSize && Size <= ContainerSize - Offset;
+		}
+	}
+
+	FMeshFile::FMeshFile(const std::string& FilePath):
+		MappedFile(std::make_unique<DX::FMappedFile>(FilePath))
+	{
+		Data = MappedFile->GetData();
+		Size = MappedFile->GetSize();
+
+		Validate("File " + FilePath);
+	}
+
+	FMeshFile::FMeshFile(std::shared_ptr<const FAssetPackage> AssetPackage, const FAssetPackageEntry& Entry)
+	{
+		const auto EntryName = AssetPackage->GetEntryName(Entry);
+		if (Entry.Compression == EAssetCompression::None)
+		{
+			Data = AssetPackage->GetEntryData(Entry);
+			this->AssetPackage = std::move(AssetPackage);
+		}
+		else
+		{
+			Bytes = AssetPackage->ReadEntry(Entry);
+			Data = Bytes.data();
+		}
+		Size = Entry.UncompressedSize;
+
+		Validate("Entry " + EntryName);
+	}
+
+	void FMeshFile::Validate(const std::string& SourceName)
+	{
+		if (Size < sizeof(FMeshFileHeader))
+		{
+			throw std::invalid_argument(SourceName + " is too small for a baked mesh");
+		}
+
+		Header = reinterpret_cast<const FMeshFileHeader*>(Data);
+		if (Header->Magic != MeshFileMagic)
+		{
+			throw std::invalid_argument(SourceName + " isn't a baked mesh");
+		}
+
+		if (Header->Version != MeshFileVersion)
+		{
+			throw std::invalid_argument(SourceName + " has unsupported version " +
+				std::to_string(Header->Version));
+		}
+
+		if (Header->VertexFormat > EVertexFormat::Quantized ||
+			(Header->IndexSize != sizeof(uint16) && Header->IndexSize != sizeof(uint32)) ||
+			Header->VertexStride != FVertexPacker::GetVertexStride(Header->VertexFormat) ||
+			Header->VerticesSize % Header->VertexStride != 0 ||
+			Header->IndicesSize % Header->IndexSize != 0)
+		{
+			throw std::invalid_argument(SourceName + " has invalid buffers' formats");
+		}
+
+		if (!IsRangeInside(Header->SubmeshesOffset, Header->NumSubmeshes*sizeof(FMeshFileSubmesh), Size) ||
+			Header->NumMeshlets > Size / sizeof(FMeshlet) ||
+			!IsRangeInside(Header->MeshletsOffset, Header->NumMeshlets*sizeof(FMeshlet), Size) ||
+			!IsRangeInside(Header->VerticesOffset, Header->VerticesSize, Size) ||
+			!IsRangeInside(Header->IndicesOffset, Header->IndicesSize, Size) ||
+			Header->NumMaterials > Size / sizeof(FMeshFileMaterial) ||
+			!IsRangeInside(Header->MaterialsOffset, Header->NumMaterials*sizeof(FMeshFileMaterial), Size))
+		{
+			throw std::invalid_argument(SourceName + " is truncated");
+		}
+
+		const auto NumVertices = Header->VerticesSize / Header->VertexStride;
+		const auto NumIndices = Header->IndicesSize / Header->IndexSize;
+
+		// Indices are relative to their submesh's first vertex
+		auto AreIndicesInside = [this](uint64 IndexBegin, uint64 NumIndices, uint32 NumVertices)
+		{
+			const auto* IndicesData = Data + Header->IndicesOffset;
+			for (auto iIndex = IndexBegin; iIndex < IndexBegin + NumIndices; ++iIndex)
+			{
+				const auto Index = Header->IndexSize == sizeof(uint16) ?
+					uint32(reinterpret_cast<const uint16*>(IndicesData)[iIndex]) :
+					reinterpret_cast<const uint32*>(IndicesData)[iIndex];
+				if (Index >= NumVertices)
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+
+		const auto* Submeshes = reinterpret_cast<const FMeshFileSubmesh*>(Data + Header->SubmeshesOffset);
+		const auto* Meshlets = reinterpret_cast<const FMeshlet*>(Data + Header->MeshletsOffset);
+		for (uint32 iSubmesh = 0; iSubmesh < Header->NumSubmeshes; ++iSubmesh)
+		{
+			const auto& Submesh = Submeshes[iSubmesh];
+			if (Submesh.Name[sizeof(Submesh.Name) - 1] != '\0' ||
+				!IsRangeInside(Submesh.IndexBegin, Submesh.NumIndices, NumIndices) ||
+				!IsRangeInside(Submesh.VertexBegin, Submesh.NumVertices, NumVertices) ||
+				!IsRangeInside(Submesh.MeshletBegin, Submesh.NumMeshlets, Header->NumMeshlets) ||
+				!AreIndicesInside(Submesh.IndexBegin, Submesh.NumIndices, Submesh.NumVertices))
+			{
+				throw std::invalid_argument(SourceName + " has invalid submesh " +
+					std::to_string(iSubmesh));
+			}
+
+			// Meshlets are triangles of the submesh's indices
+			for (auto iMeshlet = Submesh.MeshletBegin; iMeshlet < Submesh.MeshletBegin + Submesh.NumMeshlets; ++iMeshlet)
+			{
+				const auto& Meshlet = Meshlets[iMeshlet];
+				if (!IsRangeInside(Meshlet.IndexBegin, uint64(Meshlet.NumTriangles) * 3, Submesh.NumIndices) ||
+					Meshlet.NumVertices > uint64(Meshlet.NumTriangles) * 3 ||
+					Meshlet.NumVertices > Submesh.NumVertices)
+				{
+					throw std::invalid_argument(SourceName + " has invalid meshlet " +
+						std::to_string(iMeshlet) + " of submesh " + std::to_string(iSubmesh));
+				}
+			}
+		}
+
+		const auto* Materials = reinterpret_cast<const FMeshFileMaterial*>(Data + Header->MaterialsOffset);
+		for (uint64 iMaterial = 0; iMaterial < Header->NumMaterials; ++iMaterial)
+		{
+			if (Materials[iMaterial].Name[sizeof(Materials[iMaterial].Name) - 1] != '\0')
+			{
+				throw std::invalid_argument(SourceName + " has invalid material " +
+					std::to_string(iMaterial));
+			}
+		}
+	}
+
+	void FMeshFile::Save(const std::string& FilePath, const FBakedMesh& BakedMesh)
+	{
+		FMeshFileHeader Header;
+		Header.Magic = MeshFileMagic;
+		Header.Version = MeshFileVersion;
+		Header.NumSubmeshes = static_cast<uint32>(BakedMesh.SubmeshesData.size());
+		Header.VertexStride = BakedMesh.VertexStride;
+		Header.VertexFormat = BakedMesh.VertexFormat;
+		Header.IndexSize = BakedMesh.IndexFormat == DXGI_FORMAT_R16_UINT ? sizeof(uint16) : sizeof(uint32);
+
+		std::vector<FMeshFileSubmesh> Submeshes(BakedMesh.SubmeshesData.size());
+		std::vector<FMeshlet> Meshlets;
+		for (auto iSubmesh = 0; iSubmesh < Submeshes.size(); ++iSubmesh)
+		{
+			const auto& SubmeshData = *BakedMesh.SubmeshesData[iSubmesh];
+			auto& Submesh = Submeshes[iSubmesh];
+
+			if (SubmeshData.Name.size() >= sizeof(Submesh.Name))
+			{
+				throw std::invalid_argument("Name of submesh " + SubmeshData.Name + " is too long");
+			}
+
+			memcpy(Submesh.Name, SubmeshData.Name.c_str(), SubmeshData.Name.size());
+			Submesh.IndexBegin = SubmeshData.IndexBegin;
+			Submesh.NumIndices = SubmeshData.NumIndices;
+			Submesh.VertexBegin = SubmeshData.VertexBegin;
+			Submesh.NumVertices = SubmeshData.NumVertices;
+			Submesh.MeshletBegin = Meshlets.size();
+			Submesh.NumMeshlets = SubmeshData.Meshlets.size();
+			Submesh.BoundsMin = SubmeshData.BoundsMin;
+			Submesh.BoundsMax = SubmeshData.BoundsMax;
+			Submesh.GeometricError = SubmeshData.GeometricError;
+			Submesh.VertexQuantization = SubmeshData.VertexQuantization;
+			Submesh.MaterialIndex = SubmeshData.MaterialIndex;
+			Submesh.Transform = SubmeshData.Transform;
+
+			Meshlets.insert(Meshlets.end(), SubmeshData.Meshlets.cbegin(), SubmeshData.Meshlets.cend());
+		}
+
+		std::vector<FMeshFileMaterial> Materials(BakedMesh.MaterialsNames.size());
+		for (std::size_t iMaterial = 0; iMaterial < Materials.size(); ++iMaterial)
+		{
+			const auto& MaterialName = BakedMesh.MaterialsNames[iMaterial];
+			auto& Material = Materials[iMaterial];
+
+			if (MaterialName.size() >= sizeof(Material.Name))
+			{
+				throw std::invalid_argument("Name of material " + MaterialName + " is too long");
+			}
+
+			memcpy(Material.Name, MaterialName.c_str(), MaterialName.size());
+		}
+
+		Header.SubmeshesOffset = AlignBlobOffset(sizeof(FMeshFileHeader));
+
+		Header.MeshletsOffset = AlignBlobOffset(Header.SubmeshesOffset + Submeshes.size()*sizeof(FMeshFileSubmesh));
+		Header.NumMeshlets = Meshlets.size();
+
+		Header.VerticesOffset = AlignBlobOffset(Header.MeshletsOffset + Meshlets.size()*sizeof(FMeshlet));
+		Header.VerticesSize = BakedMesh.VerticesData.size();
+
+		Header.IndicesOffset = AlignBlobOffset(Header.VerticesOffset + Header.VerticesSize);
+		Header.IndicesSize = BakedMesh.IndicesData.size();
+
+		Header.MaterialsOffset = AlignBlobOffset(Header.IndicesOffset + Header.IndicesSize);
+		Header.NumMaterials = Materials.size();
+
+		std::ofstream File(FilePath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+		if (!File.is_open())
+		{
+			throw std::invalid_argument("File can't be created by path " + FilePath);
+		}
+
+		auto WriteBlob = [&File](uint64 Offset, const void* Data, uint64 Size)
+		{
+			// Zero padding up to the blob's offset
+			static const char Padding[MeshFileBlobAlignment] = {};
+			const auto PaddingSize = Offset - static_cast<uint64>(File.tellp());
+			File.write(Padding, PaddingSize);
+
+			File.write(static_cast<const char*>(Data), Size);
+		};
+
+		File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+		WriteBlob(Header.SubmeshesOffset, Submeshes.data(), Submeshes.size()*sizeof(FMeshFileSubmesh));
+		WriteBlob(Header.MeshletsOffset, Meshlets.data(), Meshlets.size()*sizeof(FMeshlet));
+		WriteBlob(Header.VerticesOffset, BakedMesh.VerticesData.data(), Header.VerticesSize);
+		WriteBlob(Header.IndicesOffset, BakedMesh.IndicesData.data(), Header.IndicesSize);
+		WriteBlob(Header.MaterialsOffset, Materials.data(), Materials.size()*sizeof(FMeshFileMaterial));
+
+		if (!File.good())
+		{
+			throw std::invalid_argument("File " + FilePath + " can't be written");
+		}
+	}
+
+	void FMeshFile::Convert(
+		const std::string& SourceFilePath,
+		const std::string& FilePath,
+		const FMeshBakeSettings& Settings)
+	{
+		const auto ExtensionBegin = SourceFilePath.find_last_of('.');
+		const auto NameBegin = SourceFilePath.find_last_of("\\/") + 1;
+		if (ExtensionBegin == std::string::npos || ExtensionBegin < NameBegin)
+		{
+			throw std::invalid_argument("File " + SourceFilePath + " has no extension");
+		}
+
+		const auto Extension = SourceFilePath.substr(ExtensionBegin);
+		const auto StartTime = std::chrono::high_resolution_clock::now();
+
+		FMeshParser MeshParser;
+		std::vector<std::unique_ptr<FMeshRawData>> SubmeshesData;
+		std::vector<std::string> MaterialsNames;
+		if (Extension == ".txt")
+		{
+			auto MeshData = MeshParser.ParseTxtData(SourceFilePath);
+			MeshData->Name = SourceFilePath.substr(NameBegin, ExtensionBegin - NameBegin);
+			SubmeshesData.push_back(std::move(MeshData));
+		}
+		else
+		{
+			// Import time doesn't matter offline
+			auto ImportedScene = MeshParser.ParseScene(SourceFilePath, EImportPreset::Quality);
+			SubmeshesData = std::move(ImportedScene->SubmeshesData);
+			MaterialsNames = std::move(ImportedScene->MaterialsNames);
+		}
+
+		if (SubmeshesData.empty())
+		{
+			throw std::invalid_argument("File " + SourceFilePath + " has no meshes");
+		}
+
+		const std::chrono::duration<double, std::milli> ParseTime =
+			std::chrono::high_resolution_clock::now() - StartTime;
+
+		Convert(std::move(SubmeshesData), FilePath, Settings, MaterialsNames);
+
+		const std::chrono::duration<double, std::milli> ConvertTime =
+			std::chrono::high_resolution_clock::now() - StartTime;
+		DBOUT(SourceFilePath + " converted", "parsed in " << ParseTime.count() << " ms, baked and saved in " <<
+			ConvertTime.count() - ParseTime.count() << " ms");
+	}
+
+	void FMeshFile::Convert(
+		std::vector<std::unique_ptr<FMeshRawData>>&& SubmeshesData,
+		const std::string& FilePath,
+		const FMeshBakeSettings& Settings,
+		const std::vector<std::string>& MaterialsNames)
+	{
+		if (SubmeshesData.empty())
+		{
+			throw std::invalid_argument("SubmeshesData must be not empty");
+		}
+
+		FMeshBaker MeshBaker;
+		auto BakedMesh = MeshBaker.Bake(std::move(SubmeshesData), FilePath, Settings);
+		BakedMesh->MaterialsNames = MaterialsNames;
+		Save(FilePath, *BakedMesh);
+	}
+
+	std::vector<std::unique_ptr<FSubmeshData>> FMeshFile::CreateSubmeshesData() const
+	{
+		const auto* Submeshes = reinterpret_cast<const FMeshFileSubmesh*>(Data + Header->SubmeshesOffset);
+		const auto* Meshlets = reinterpret_cast<const FMeshlet*>(Data + Header->MeshletsOffset);
+		const auto* Materials = reinterpret_cast<const FMeshFileMaterial*>(Data + Header->MaterialsOffset);
+
+		std::vector<std::unique_ptr<FSubmeshData>> SubmeshesData;
+		SubmeshesData.reserve(Header->NumSubmeshes);
+		for (uint32 iSubmesh = 0; iSubmesh < Header->NumSubmeshes; ++iSubmesh)
+		{
+			const auto& Submesh = Submeshes[iSubmesh];
+
+			auto SubmeshData = std::make_unique<FSubmeshData>(Submesh.Name);
+			SubmeshData->IndexBegin = Submesh.IndexBegin;
+			SubmeshData->NumIndices = Submesh.NumIndices;
+			SubmeshData->VertexBegin = Submesh.VertexBegin;
+			SubmeshData->NumVertices = Submesh.NumVertices;
+			SubmeshData->Meshlets.assign(
+				Meshlets + Submesh.MeshletBegin,
+				Meshlets + Submesh.MeshletBegin + Submesh.NumMeshlets);
+			SubmeshData->BoundsMin = Submesh.BoundsMin;
+			SubmeshData->BoundsMax = Submesh.BoundsMax;
+			SubmeshData->GeometricError = Submesh.GeometricError;
+			SubmeshData->VertexQuantization = Submesh.VertexQuantization;
+			SubmeshData->MaterialIndex = Submesh.MaterialIndex;
+			if (Submesh.MaterialIndex < Header->NumMaterials)
+			{
+				SubmeshData->MaterialName = Materials[Submesh.MaterialIndex].Name;
+			}
+			SubmeshData->Transform = Submesh.Transform;
+
+			SubmeshesData.push_back(std::move(SubmeshData));
+		}
+
+		return SubmeshesData;
+	}
+
+	const FMeshFileHeader& FMeshFile::GetHeader() const noexcept
+	{
+		return *Header;
+	}
+
+	const uint8* FMeshFile::GetVerticesData() const noexcept
+	{
+		return Data + Header->VerticesOffset;
+	}
+
+	const uint8* FMeshFile::GetIndicesData() const noexcept
+	{
+		return Data + Header->IndicesOffset;
+	}
+
+	DXGI_FORMAT FMeshFile::GetIndexFormat() const noexcept
+	{
+		return Header->IndexSize == sizeof(uint16) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	}
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <memory>
+
+#include "AssetPackage.h"
+#include "Common/MappedFile.h"
+#include "MeshBaker.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FMeshFileHeader
+	 *
+	 * \brief Header of a baked mesh file (.wmesh). Followed by the submeshes' table, meshlets,
+	 * the vertex/index buffers' content and the materials' table, every blob is aligned to MeshFileBlobAlignment
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FMeshFileHeader
+	{
+		uint32 Magic = 0;
+		uint32 Version = 0;
+
+		uint32 NumSubmeshes = 0;
+		uint32 VertexStride = 0;
+
+		EVertexFormat VertexFormat = EVertexFormat::Full;
+		uint8 IndexSize = 0;
+		uint8 Pad[6] = {};
+
+		uint64 SubmeshesOffset = 0;
+
+		uint64 MeshletsOffset = 0;
+		uint64 NumMeshlets = 0;
+
+		uint64 VerticesOffset = 0;
+		uint64 VerticesSize = 0;
+
+		uint64 IndicesOffset = 0;
+		uint64 IndicesSize = 0;
+
+		uint64 MaterialsOffset = 0;
+		uint64 NumMaterials = 0;
+	};
+
+	/*!
+	 * \struct FMeshFileSubmesh
+	 *
+	 * \brief Entry of a baked mesh file's submeshes table
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FMeshFileSubmesh
+	{
+		// Zero-terminated name
+		char Name[128] = {};
+
+		uint64 IndexBegin = 0;
+		uint64 NumIndices = 0;
+
+		uint32 VertexBegin = 0;
+		uint32 NumVertices = 0;
+
+		// Range in the file's meshlets
+		uint64 MeshletBegin = 0;
+		uint64 NumMeshlets = 0;
+
+		XMFLOAT3 BoundsMin = { 0.0f, 0.0f, 0.0f };
+		float GeometricError = 0.0f;
+
+		XMFLOAT3 BoundsMax = { 0.0f, 0.0f, 0.0f };
+		uint32 MaterialIndex = 0;
+
+		SVertexQuantizationData VertexQuantization;
+
+		XMFLOAT4X4 Transform = MathHelper::Identity4x4();
+	};
+
+	/*!
+	 * \struct FMeshFileMaterial
+	 *
+	 * \brief Entry of a baked mesh file's materials table. Submeshes refer it by MaterialIndex
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FMeshFileMaterial
+	{
+		// Zero-terminated name of the source asset's material
+		char Name[128] = {};
+	};
+
+	// "WMSH"
+	constexpr uint32 MeshFileMagic = 0x48534D57;
+	constexpr uint32 MeshFileVersion = 3;
+	constexpr uint64 MeshFileBlobAlignment = 64;
+
+	/*!
+	 * \class FMeshFile
+	 *
+	 * \brief Baked mesh file (.wmesh) mapped to memory or served from an asset package.
+	 * Its vertex and index buffers' content is uploaded as is, without parsing and conversions
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FMeshFile
+	{
+	public:
+		/** @brief Maps the file and validates its header and tables.
+		  * Throws invalid_argument if the file isn't a valid baked mesh
+		  * @param FilePath Path to file (format: *.wmesh) (const std::string &)
+		  */
+		explicit FMeshFile(const std::string& FilePath);
+
+		/** @brief Validates the package's entry. Uncompressed entry is used inside of the mapped package,
+		  * compressed one is decompressed. Throws invalid_argument if it isn't a valid baked mesh
+		  * @param AssetPackage Is kept while the mesh file exists (std::shared_ptr<const FAssetPackage>)
+		  * @param Entry (const FAssetPackageEntry &)
+		  */
+		FMeshFile(std::shared_ptr<const FAssetPackage> AssetPackage, const FAssetPackageEntry& Entry);
+		~FMeshFile() = default;
+
+		FMeshFile& operator=(const FMeshFile& MeshFile) = delete;
+		FMeshFile(const FMeshFile& MeshFile) = delete;
+		FMeshFile(FMeshFile&& MeshFile) = delete;
+
+		/** @brief Writes the baked mesh to file
+		  * @param FilePath Path to file (format: *.wmesh) (const std::string &)
+		  * @param BakedMesh (const FBakedMesh &)
+		  * @return (void)
+		  */
+		static void Save(const std::string& FilePath, const FBakedMesh& BakedMesh);
+
+		/** @brief Offline converter: parses a .txt file or imports a scene supported by assimp,
+		  * bakes and saves it with names of the scene's materials.
+		  * Submesh of a .txt file is named as the file without extension
+		  * @param SourceFilePath Path to file (format: *.txt, *.obj, *.fbx etc) (const std::string &)
+		  * @param FilePath Path to file (format: *.wmesh) (const std::string &)
+		  * @param Settings (const FMeshBakeSettings &)
+		  * @return (void)
+		  */
+		static void Convert(
+			const std::string& SourceFilePath,
+			const std::string& FilePath,
+			const FMeshBakeSettings& Settings = FMeshBakeSettings());
+
+		/** @brief Bakes submeshes produced by a custom pipeline (like generated LODs) and saves them
+		  * @param SubmeshesData (std::vector<std::unique_ptr<FMeshRawData>> &&)
+		  * @param FilePath Path to file (format: *.wmesh) (const std::string &)
+		  * @param Settings (const FMeshBakeSettings &)
+		  * @param MaterialsNames Names of materials indexed by submeshes' MaterialIndex,
+		  * like FImportedScene::MaterialsNames (const std::vector<std::string> &)
+		  * @return (void)
+		  */
+		static void Convert(
+			std::vector<std::unique_ptr<FMeshRawData>>&& SubmeshesData,
+			const std::string& FilePath,
+			const FMeshBakeSettings& Settings = FMeshBakeSettings(),
+			const std::vector<std::string>& MaterialsNames = std::vector<std::string>());
+
+		/** @brief Creates submeshes' data from the submeshes table.
+		  * Their MaterialName is resolved by the materials table
+		  * @return Submeshes in order of their ranges in the buffers
+		  * (std::vector<std::unique_ptr<WoodenEngine::FSubmeshData>>)
+		  */
+		std::vector<std::unique_ptr<FSubmeshData>> CreateSubmeshesData() const;
+
+		/** @brief Returns the file's header
+		  * @return (const WoodenEngine::FMeshFileHeader&)
+		  */
+		const FMeshFileHeader& GetHeader() const noexcept;
+
+		/** @brief Returns content of the vertex buffer inside of the mapped file
+		  * @return (const uint8 *)
+		  */
+		const uint8* GetVerticesData() const noexcept;
+
+		/** @brief Returns content of the index buffer inside of the mapped file
+		  * @return (const uint8 *)
+		  */
+		const uint8* GetIndicesData() const noexcept;
+
+		/** @brief Returns format of the index buffer
+		  * @return (DXGI_FORMAT)
+		  */
+		DXGI_FORMAT GetIndexFormat() const noexcept;
+
+	private:
+		/** @brief Validates the header and tables of Data
+		  * @param SourceName File path or package entry's name for errors (const std::string &)
+		  * @return (void)
+		  */
+		void Validate(const std::string& SourceName);
+
+		// Owner of Data: the mapped file, the mapped package or decompressed bytes
+		std::unique_ptr<DX::FMappedFile> MappedFile;
+		std::shared_ptr<const FAssetPackage> AssetPackage;
+		std::vector<uint8> Bytes;
+
+		const uint8* Data = nullptr;
+		uint64 Size = 0;
+
+		const FMeshFileHeader* Header = nullptr;
+	};
+}
@@ -0,0 +1,467 @@
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+#include "MeshOptimizer.h"
+
+namespace WoodenEngine
+{
+	namespace
+	{
+		// Forsyth's scoring constants
+		constexpr float CacheDecayPower = 1.5f;
+		constexpr float LastTriangleScore = 0.75f;
+		constexpr float ValenceBoostScale = 2.0f;
+		constexpr float ValenceBoostPower = 0.5f;
+
+		constexpr uint32 InvalidIndex = UINT32_MAX;
+
+		float FindVertexScore(uint32 NumActiveTriangles, int32 CachePosition, uint32 CacheSize)
+		{
+			if (NumActiveTriangles == 0)
+			{
+				// No triangles need this vertex
+				return -1.0f;
+			}
+
+			float Score = 0.0f;
+			if (CachePosition >= 0)
+			{
+				if (CachePosition < 3)
+				{
+					// The vertex was used in the last triangle, so it has a fixed score
+					Score = LastTriangleScore;
+				}
+				else
+				{
+					const float Scaler = 1.0f / (CacheSize - 3);
+					Score = powf(1.0f - (CachePosition - 3) * Scaler, CacheDecayPower);
+				}
+			}
+
+			// Bonus points for having a low number of triangles left, so lone vertices are removed quickly
+			Score += ValenceBoostScale * powf(static_cast<float>(NumActiveTriangles), -ValenceBoostPower);
+
+			return Score;
+		}
+	}
+
+	FMeshOptimizationStats FMeshOptimizer::Optimize(FMeshRawData* MeshData, bool bOptimizeOverdraw) const
+	{
+		FMeshOptimizationStats Stats;
+		Stats.Before = AnalyzeVertexCache(*MeshData);
+
+		if (MeshData->Topology != D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST || MeshData->Indices.size() < 3)
+		{
+			Stats.After = Stats.Before;
+			return Stats;
+		}
+
+		// Some source meshes are ordered better than Forsyth's order (skull.txt), so their order is kept
+		auto SourceIndices = MeshData->Indices;
+
+		OptimizeVertexCache(MeshData);
+
+		if (bOptimizeOverdraw)
+		{
+			OptimizeOverdraw(MeshData);
+		}
+
+		if (AnalyzeVertexCache(*MeshData).ACMR > Stats.Before.ACMR)
+		{
+			MeshData->Indices = std::move(SourceIndices);
+		}
+
+		OptimizeVertexFetch(MeshData);
+
+		Stats.After = AnalyzeVertexCache(*MeshData);
+		return Stats;
+	}
+
+	FVertexCacheStats FMeshOptimizer::AnalyzeVertexCache(
+		const FMeshRawData& MeshData,
+		uint32 CacheSize) const
+	{
+		return AnalyzeIndices(MeshData.Indices, MeshData.Vertices.size(), CacheSize);
+	}
+
+	FVertexCacheStats FMeshOptimizer::AnalyzeIndices(
+		const std::vector<uint32>& Indices,
+		uint64 NumVertices,
+		uint32 CacheSize)
+	{
+		FVertexCacheStats Stats;
+
+		const auto NumTriangles = Indices.size() / 3;
+		if (NumTriangles == 0)
+		{
+			return Stats;
+		}
+
+		// FIFO cache is simulated by timestamps: a vertex is in the cache
+		// if less than CacheSize vertices were transformed after it
+		std::vector<uint64> CacheTimestamps(NumVertices, 0);
+		std::vector<bool> bIsReferenced(NumVertices, false);
+		uint64 Timestamp = CacheSize + 1;
+		uint64 NumUniqueVertices = 0;
+
+		for (auto iIndex = 0; iIndex < NumTriangles * 3; ++iIndex)
+		{
+			const auto iVertex = Indices[iIndex];
+
+			if (Timestamp - CacheTimestamps[iVertex] > CacheSize)
+			{
+				CacheTimestamps[iVertex] = Timestamp++;
+				++Stats.NumTransformedVertices;
+			}
+
+			if (!bIsReferenced[iVertex])
+			{
+				bIsReferenced[iVertex] = true;
+				++NumUniqueVertices;
+			}
+		}
+
+		Stats.ACMR = static_cast<float>(Stats.NumTransformedVertices) / NumTriangles;
+		Stats.ATVR = static_cast<float>(Stats.NumTransformedVertices) / NumUniqueVertices;
+
+		return Stats;
+	}
+
+	void FMeshOptimizer::OptimizeVertexCache(FMeshRawData* MeshData) const
+	{
+		const auto NumVertices = MeshData->Vertices.size();
+		const auto NumTriangles = MeshData->Indices.size() / 3;
+
+		if (NumTriangles == 0)
+		{
+			return;
+		}
+
+		const auto& Indices = MeshData->Indices;
+
+		// Adjacency: triangles of every vertex. Active triangles of a vertex are kept
+		// in the beginning of its range, so removal is a swap with the last active one
+		std::vector<uint32> NumActiveTriangles(NumVertices, 0);
+		for (auto iIndex = 0; iIndex < NumTriangles * 3; ++iIndex)
+		{
+			++NumActiveTriangles[Indices[iIndex]];
+		}
+
+		std::vector<uint32> VertexTrianglesOffsets(NumVertices + 1, 0);
+		std::partial_sum(NumActiveTriangles.cbegin(), NumActiveTriangles.cend(), VertexTrianglesOffsets.begin() + 1);
+
+		std::vector<uint32> VertexTriangles(NumTriangles * 3);
+		{
+			std::vector<uint32> VertexTrianglesFilled(VertexTrianglesOffsets.cbegin(), VertexTrianglesOffsets.cend() - 1);
+			for (uint32 iTriangle = 0; iTriangle < NumTriangles; ++iTriangle)
+			{
+				for (auto iCorner = 0; iCorner < 3; ++iCorner)
+				{
+					const auto iVertex = Indices[iTriangle * 3 + iCorner];
+					VertexTriangles[VertexTrianglesFilled[iVertex]++] = iTriangle;
+				}
+			}
+		}
+
+		std::vector<int32> CachePositions(NumVertices, -1);
+		std::vector<float> VertexScores(NumVertices);
+		for (auto iVertex = 0; iVertex < NumVertices; ++iVertex)
+		{
+			VertexScores[iVertex] = FindVertexScore(NumActiveTriangles[iVertex], -1, ScoringCacheSize);
+		}
+
+		std::vector<float> TriangleScores(NumTriangles);
+		std::vector<bool> bIsTriangleAdded(NumTriangles, false);
+
+		uint32 iBestTriangle = InvalidIndex;
+		float BestScore = -1.0f;
+		for (uint32 iTriangle = 0; iTriangle < NumTriangles; ++iTriangle)
+		{
+			TriangleScores[iTriangle] =
+				VertexScores[Indices[iTriangle * 3 + 0]] +
+				VertexScores[Indices[iTriangle * 3 + 1]] +
+				VertexScores[Indices[iTriangle * 3 + 2]];
+
+			if (TriangleScores[iTriangle] > BestScore)
+			{
+				BestScore = TriangleScores[iTriangle];
+				iBestTriangle = iTriangle;
+			}
+		}
+
+		// Extra 3 entries hold vertices of the new triangle before older ones are evicted
+		std::vector<uint32> Cache;
+		std::vector<uint32> NewCache;
+		Cache.reserve(ScoringCacheSize + 3);
+		NewCache.reserve(ScoringCacheSize + 3);
+
+		std::vector<uint32> OptimizedIndices(NumTriangles * 3);
+		uint32 iNextTriangleCursor = 0;
+
+		for (auto iOutTriangle = 0; iOutTriangle < NumTriangles; ++iOutTriangle)
+		{
+			if (iBestTriangle == InvalidIndex)
+			{
+				// Dead end: none of cached vertices has active triangles, take the next unused one
+				while (bIsTriangleAdded[iNextTriangleCursor])
+				{
+					++iNextTriangleCursor;
+				}
+				iBestTriangle = iNextTriangleCursor;
+			}
+
+			const auto* Triangle = &Indices[iBestTriangle * 3];
+			bIsTriangleAdded[iBestTriangle] = true;
+
+			NewCache.clear();
+			for (auto iCorner = 0; iCorner < 3; ++iCorner)
+			{
+				const auto iVertex = Triangle[iCorner];
+				OptimizedIndices[iOutTriangle * 3 + iCorner] = iVertex;
+				NewCache.push_back(iVertex);
+
+				// Remove the triangle from the active triangles of the vertex
+				auto* ActiveTriangles = &VertexTriangles[VertexTrianglesOffsets[iVertex]];
+				auto& NumActive = NumActiveTriangles[iVertex];
+				auto* ActiveTrianglesEnd = ActiveTriangles + NumActive;
+				auto* TriangleIter = std::find(ActiveTriangles, ActiveTrianglesEnd, iBestTriangle);
+				std::swap(*TriangleIter, *(ActiveTrianglesEnd - 1));
+				--NumActive;
+			}
+
+			for (auto iVertex : Cache)
+			{
+				if (iVertex != Triangle[0] && iVertex != Triangle[1] && iVertex != Triangle[2])
+				{
+					NewCache.push_back(iVertex);
+				}
+			}
+
+			// Evicted vertices lose their cache bonus
+			for (auto iCache = ScoringCacheSize; iCache < NewCache.size(); ++iCache)
+			{
+				const auto iVertex = NewCache[iCache];
+				CachePositions[iVertex] = -1;
+				VertexScores[iVertex] = FindVertexScore(NumActiveTriangles[iVertex], -1, ScoringCacheSize);
+			}
+
+			if (NewCache.size() > ScoringCacheSize)
+			{
+				NewCache.resize(ScoringCacheSize);
+			}
+
+			std::swap(Cache, NewCache);
+
+			for (auto iCache = 0; iCache < Cache.size(); ++iCache)
+			{
+				const auto iVertex = Cache[iCache];
+				CachePositions[iVertex] = iCache;
+				VertexScores[iVertex] = FindVertexScore(NumActiveTriangles[iVertex], iCache, ScoringCacheSize);
+			}
+
+			// The next triangle is the best one among the triangles of cached vertices
+			iBestTriangle = InvalidIndex;
+			BestScore = -1.0f;
+			for (auto iVertex : Cache)
+			{
+				const auto* ActiveTriangles = &VertexTriangles[VertexTrianglesOffsets[iVertex]];
+				for (auto iActive = 0; iActive < NumActiveTriangles[iVertex]; ++iActive)
+				{
+					const auto iTriangle = ActiveTriangles[iActive];
+					const auto Score =
+						VertexScores[Indices[iTriangle * 3 + 0]] +
+						VertexScores[Indices[iTriangle * 3 + 1]] +
+						VertexScores[Indices[iTriangle * 3 + 2]];
+
+					TriangleScores[iTriangle] = Score;
+					if (Score > BestScore)
+					{
+						BestScore = Score;
+						iBestTriangle = iTriangle;
+					}
+				}
+			}
+		}
+
+		MeshData->Indices = std::move(OptimizedIndices);
+	}
+
+	void FMeshOptimizer::OptimizeMeshletsVertexCache(FMeshRawData* MeshData, const std::vector<FMeshlet>& Meshlets) const
+	{
+		// A meshlet is optimized as a small mesh of its own vertices, so work doesn't depend on the whole mesh
+		std::vector<uint32> LocalVertices(MeshData->Vertices.size(), InvalidIndex);
+		std::vector<uint32> MeshletVertices;
+		FMeshRawData MeshletData;
+
+		for (const auto& Meshlet : Meshlets)
+		{
+			const auto MeshletIndices = MeshData->Indices.data() + Meshlet.IndexBegin;
+			const auto NumIndices = Meshlet.NumTriangles * 3;
+
+			MeshletVertices.clear();
+			MeshletData.Indices.resize(NumIndices);
+			for (uint32 iIndex = 0; iIndex < NumIndices; ++iIndex)
+			{
+				const auto iVertex = MeshletIndices[iIndex];
+				if (LocalVertices[iVertex] == InvalidIndex)
+				{
+					LocalVertices[iVertex] = static_cast<uint32>(MeshletVertices.size());
+					MeshletVertices.push_back(iVertex);
+				}
+				MeshletData.Indices[iIndex] = LocalVertices[iVertex];
+			}
+			MeshletData.Vertices.resize(MeshletVertices.size());
+
+			const auto StatsBefore = AnalyzeVertexCache(MeshletData);
+			OptimizeVertexCache(&MeshletData);
+			if (AnalyzeVertexCache(MeshletData).ACMR < StatsBefore.ACMR)
+			{
+				for (uint32 iIndex = 0; iIndex < NumIndices; ++iIndex)
+				{
+					MeshletIndices[iIndex] = MeshletVertices[MeshletData.Indices[iIndex]];
+				}
+			}
+
+			for (auto iVertex : MeshletVertices)
+			{
+				LocalVertices[iVertex] = InvalidIndex;
+			}
+		}
+	}
+
+	void FMeshOptimizer::OptimizeOverdraw(FMeshRawData* MeshData, float Threshold) const
+	{
+		const auto NumTriangles = MeshData->Indices.size() / 3;
+		if (NumTriangles == 0)
+		{
+			return;
+		}
+
+		const auto StatsBefore = AnalyzeVertexCache(*MeshData);
+
+		const auto& Indices = MeshData->Indices;
+		const auto& Vertices = MeshData->Vertices;
+
+		// Clusters begin at hard boundaries: triangles which miss the cache by all 3 vertices
+		std::vector<uint32> ClustersBegins;
+		{
+			std::vector<uint64> CacheTimestamps(Vertices.size(), 0);
+			uint64 Timestamp = SimulatedCacheSize + 1;
+
+			for (uint32 iTriangle = 0; iTriangle < NumTriangles; ++iTriangle)
+			{
+				uint32 NumMisses = 0;
+				for (auto iCorner = 0; iCorner < 3; ++iCorner)
+				{
+					const auto iVertex = Indices[iTriangle * 3 + iCorner];
+					if (Timestamp - CacheTimestamps[iVertex] > SimulatedCacheSize)
+					{
+						CacheTimestamps[iVertex] = Timestamp++;
+						++NumMisses;
+					}
+				}
+
+				if (iTriangle == 0 || NumMisses == 3)
+				{
+					ClustersBegins.push_back(iTriangle);
+				}
+			}
+		}
+
+		const auto NumClusters = ClustersBegins.size();
+		ClustersBegins.push_back(NumTriangles);
+
+		// Area weighted centroids and normals of clusters
+		std::vector<XMFLOAT3> ClustersCentroids(NumClusters);
+		std::vector<XMFLOAT3> ClustersNormals(NumClusters);
+
+		auto MeshCentroid = XMVectorZero();
+		float MeshArea = 0.0f;
+
+		for (auto iCluster = 0; iCluster < NumClusters; ++iCluster)
+		{
+			auto Centroid = XMVectorZero();
+			auto Normal = XMVectorZero();
+			float Area = 0.0f;
+
+			for (auto iTriangle = ClustersBegins[iCluster]; iTriangle < ClustersBegins[iCluster + 1]; ++iTriangle)
+			{
+				const auto P0 = XMLoadFloat3(&Vertices[Indices[iTriangle * 3 + 0]].Position);
+				const auto P1 = XMLoadFloat3(&Vertices[Indices[iTriangle * 3 + 1]].Position);
+				const auto P2 = XMLoadFloat3(&Vertices[Indices[iTriangle * 3 + 2]].Position);
+
+				const auto TriangleNormal = XMVector3Cross(P1 - P0, P2 - P0);
+				const auto TriangleArea = 0.5f*XMVectorGetX(XMVector3Length(TriangleNormal));
+
+				Centroid += (P0 + P1 + P2)*(TriangleArea / 3.0f);
+				Normal += TriangleNormal;
+				Area += TriangleArea;
+			}
+
+			MeshCentroid += Centroid;
+			MeshArea += Area;
+
+			XMStoreFloat3(&ClustersCentroids[iCluster], (Area > 0.0f) ? Centroid / Area : Centroid);
+			XMStoreFloat3(&ClustersNormals[iCluster], XMVector3Normalize(Normal));
+		}
+
+		if (MeshArea > 0.0f)
+		{
+			MeshCentroid = MeshCentroid / MeshArea;
+		}
+
+		// Clusters facing outside of the mesh are likely to occlude the others, so they're drawn first
+		std::vector<float> ClustersSortKeys(NumClusters);
+		for (auto iCluster = 0; iCluster < NumClusters; ++iCluster)
+		{
+			const auto Direction = XMLoadFloat3(&ClustersCentroids[iCluster]) - MeshCentroid;
+			ClustersSortKeys[iCluster] = XMVectorGetX(
+				XMVector3Dot(Direction, XMLoadFloat3(&ClustersNormals[iCluster])));
+		}
+
+		std::vector<uint32> ClustersOrder(NumClusters);
+		std::iota(ClustersOrder.begin(), ClustersOrder.end(), 0);
+		std::stable_sort(ClustersOrder.begin(), ClustersOrder.end(), [&](uint32 iCluster0, uint32 iCluster1)
+		{
+			return ClustersSortKeys[iCluster0] > ClustersSortKeys[iCluster1];
+		});
+
+		std::vector<uint32> SortedIndices;
+		SortedIndices.reserve(Indices.size());
+		for (auto iCluster : ClustersOrder)
+		{
+			SortedIndices.insert(SortedIndices.end(),
+				Indices.cbegin() + ClustersBegins[iCluster] * 3,
+				Indices.cbegin() + ClustersBegins[iCluster + 1] * 3);
+		}
+
+		const auto StatsAfter = AnalyzeIndices(SortedIndices, Vertices.size(), SimulatedCacheSize);
+
+		if (StatsAfter.ACMR <= StatsBefore.ACMR*Threshold)
+		{
+			MeshData->Indices = std::move(SortedIndices);
+		}
+	}
+
+	void FMeshOptimizer::OptimizeVertexFetch(FMeshRawData* MeshData) const
+	{
+		std::vector<uint32> VerticesRemap(MeshData->Vertices.size(), InvalidIndex);
+
+		std::vector<FVertex> OptimizedVertices;
+		OptimizedVertices.reserve(MeshData->Vertices.size());
+
+		for (auto& Index : MeshData->Indices)
+		{
+			if (VerticesRemap[Index] == InvalidIndex)
+			{
+				VerticesRemap[Index] = OptimizedVertices.size();
+				OptimizedVertices.push_back(MeshData->Vertices[Index]);
+			}
+
+			Index = VerticesRemap[Index];
+		}
+
+		MeshData->Vertices = std::move(OptimizedVertices);
+	}
+}
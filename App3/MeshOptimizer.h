@@ -0,0 +1,126 @@
+#pragma once
+
+#include "MeshData.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FVertexCacheStats
+	 *
+	 * \brief Efficiency of post-transform vertex cache for an index buffer
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FVertexCacheStats
+	{
+		// Average cache miss ratio: transformed vertices per triangle (0.5 - ideal, 3.0 - worst)
+		float ACMR = 0.0f;
+
+		// Average transformed vertex ratio: transformed vertices per unique vertex (1.0 - ideal)
+		float ATVR = 0.0f;
+
+		uint64 NumTransformedVertices = 0;
+	};
+
+	/*!
+	 * \struct FMeshOptimizationStats
+	 *
+	 * \brief Vertex cache statistics of a mesh before and after optimization
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FMeshOptimizationStats
+	{
+		FVertexCacheStats Before;
+		FVertexCacheStats After;
+	};
+
+	/*!
+	 * \class FMeshOptimizer
+	 *
+	 * \brief Reorders triangles and vertices of a triangle list mesh
+	 * for the GPU's post-transform vertex cache, overdraw and vertex fetch
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FMeshOptimizer
+	{
+	public:
+		FMeshOptimizer() = default;
+		~FMeshOptimizer() = default;
+
+		FMeshOptimizer& operator=(const FMeshOptimizer& MeshOptimizer) = delete;
+		FMeshOptimizer(const FMeshOptimizer& MeshOptimizer) = delete;
+		FMeshOptimizer(FMeshOptimizer&& MeshOptimizer) = delete;
+
+		/** @brief Runs all optimization stages:
+		  * vertex cache -> overdraw (optional) -> vertex fetch
+		  * Triangles keep their source order if the new one misses the vertex cache more often.
+		  * Only triangle list meshes are changed, others are skipped
+		  * @param MeshData Mesh data (FMeshRawData *)
+		  * @param bOptimizeOverdraw Enables overdraw-aware clusters sorting (bool)
+		  * @return Vertex cache statistics before and after (WoodenEngine::FMeshOptimizationStats)
+		  */
+		FMeshOptimizationStats Optimize(FMeshRawData* MeshData, bool bOptimizeOverdraw = false) const;
+
+		/** @brief Simulates FIFO post-transform vertex cache on the mesh's index buffer
+		  * @param MeshData Mesh data (const FMeshRawData &)
+		  * @param CacheSize Number of entries of the simulated cache (uint32)
+		  * @return ACMR/ATVR of the mesh (WoodenEngine::FVertexCacheStats)
+		  */
+		FVertexCacheStats AnalyzeVertexCache(
+			const FMeshRawData& MeshData,
+			uint32 CacheSize = SimulatedCacheSize) const;
+
+		/** @brief Reorders triangles for vertex cache locality (Forsyth's linear-speed algorithm)
+		  * @param MeshData Mesh data (FMeshRawData *)
+		  * @return (void)
+		  */
+		void OptimizeVertexCache(FMeshRawData* MeshData) const;
+
+		/** @brief Reorders triangles inside every meshlet for vertex cache locality. Meshlets keep their ranges,
+		  * and a meshlet keeps its order if the new one misses the cache more often
+		  * @param MeshData Mesh data whose indices are split to the meshlets (FMeshRawData *)
+		  * @param Meshlets Meshlets of the mesh (const std::vector<FMeshlet> &)
+		  * @return (void)
+		  */
+		void OptimizeMeshletsVertexCache(FMeshRawData* MeshData, const std::vector<FMeshlet>& Meshlets) const;
+
+		/** @brief Splits cache-optimized triangles to clusters and sorts them
+		  * from outside-facing to inside-facing ones (Tipsify's overdraw pass).
+		  * Keeps new order only if ACMR grows less than in Threshold times
+		  * @param MeshData Mesh data (FMeshRawData *)
+		  * @param Threshold Max allowed ratio between new and old ACMR (float)
+		  * @return (void)
+		  */
+		void OptimizeOverdraw(FMeshRawData* MeshData, float Threshold = 1.05f) const;
+
+		/** @brief Reorders vertices in order of their first use in the index buffer
+		  * and removes unreferenced vertices
+		  * @param MeshData Mesh data (FMeshRawData *)
+		  * @return (void)
+		  */
+		void OptimizeVertexFetch(FMeshRawData* MeshData) const;
+
+	private:
+		/** @brief Simulates FIFO post-transform vertex cache on an index buffer
+		  * @param Indices Index buffer (const std::vector<uint32> &)
+		  * @param NumVertices Number of vertices referenced by the index buffer (uint64)
+		  * @param CacheSize Number of entries of the simulated cache (uint32)
+		  * @return (WoodenEngine::FVertexCacheStats)
+		  */
+		static FVertexCacheStats AnalyzeIndices(
+			const std::vector<uint32>& Indices,
+			uint64 NumVertices,
+			uint32 CacheSize);
+
+		// Cache size used for statistics, close to real hardware caches
+		static constexpr uint32 SimulatedCacheSize = 16;
+
+		// Cache size used for Forsyth's vertex scores
+		static constexpr uint32 ScoringCacheSize = 32;
+	};
+}
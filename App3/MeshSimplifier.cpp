@@ -0,0 +1,837 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <ppl.h>
+
+#include "MeshSimplifier.h"
+
+namespace WoodenEngine
+{
+	namespace
+	{
+		constexpr uint32 InvalidIndex = UINT32_MAX;
+
+		using FVector3d = std::array<double, 3>;
+
+		FVector3d ToVector3d(const XMFLOAT3& Vector)
+		{
+			return { Vector.x, Vector.y, Vector.z };
+		}
+
+		FVector3d Subtract(const FVector3d& V0, const FVector3d& V1)
+		{
+			return { V0[0] - V1[0], V0[1] - V1[1], V0[2] - V1[2] };
+		}
+
+		FVector3d Cross(const FVector3d& V0, const FVector3d& V1)
+		{
+			return {
+				V0[1] * V1[2] - V0[2] * V1[1],
+				V0[2] * V1[0] - V0[0] * V1[2],
+				V0[0] * V1[1] - V0[1] * V1[0]
+			};
+		}
+
+		double Dot(const FVector3d& V0, const FVector3d& V1)
+		{
+			return V0[0] * V1[0] + V0[1] * V1[1] + V0[2] * V1[2];
+		}
+
+		double Length(const FVector3d& Vector)
+		{
+			return sqrt(Dot(Vector, Vector));
+		}
+
+		FVector3d MultiplyAdd(const FVector3d& V0, const FVector3d& V1, double Scale)
+		{
+			return { V0[0] + V1[0] * Scale, V0[1] + V1[1] * Scale, V0[2] + V1[2] * Scale };
+		}
+
+		/** @brief Returns distance from the point to the triangle (closest point by Voronoi regions of its features)
+		  * @param Point (const FVector3d &)
+		  * @param A (const FVector3d &)
+		  * @param B (const FVector3d &)
+		  * @param C (const FVector3d &)
+		  * @return (double)
+		  */
+		double GetPointTriangleDistance(const FVector3d& Point, const FVector3d& A, const FVector3d& B, const FVector3d& C)
+		{
+			const auto AB = Subtract(B, A);
+			const auto AC = Subtract(C, A);
+			const auto AP = Subtract(Point, A);
+			const auto D1 = Dot(AB, AP);
+			const auto D2 = Dot(AC, AP);
+			if (D1 <= 0.0 && D2 <= 0.0)
+			{
+				return Length(AP);
+			}
+
+			const auto BP = Subtract(Point, B);
+			const auto D3 = Dot(AB, BP);
+			const auto D4 = Dot(AC, BP);
+			if (D3 >= 0.0 && D4 <= D3)
+			{
+				return Length(BP);
+			}
+
+			const auto VC = D1*D4 - D3*D2;
+			if (VC <= 0.0 && D1 >= 0.0 && D3 <= 0.0)
+			{
+				return Length(Subtract(Point, MultiplyAdd(A, AB, D1 / (D1 - D3))));
+			}
+
+			const auto CP = Subtract(Point, C);
+			const auto D5 = Dot(AB, CP);
+			const auto D6 = Dot(AC, CP);
+			if (D6 >= 0.0 && D5 <= D6)
+			{
+				return Length(CP);
+			}
+
+			const auto VB = D5*D2 - D1*D6;
+			if (VB <= 0.0 && D2 >= 0.0 && D6 <= 0.0)
+			{
+				return Length(Subtract(Point, MultiplyAdd(A, AC, D2 / (D2 - D6))));
+			}
+
+			const auto VA = D3*D6 - D5*D4;
+			if (VA <= 0.0 && D4 - D3 >= 0.0 && D5 - D6 >= 0.0)
+			{
+				return Length(Subtract(Point, MultiplyAdd(B, Subtract(C, B), (D4 - D3) / ((D4 - D3) + (D5 - D6)))));
+			}
+
+			const auto Denominator = VA + VB + VC;
+			if (Denominator <= 0.0)
+			{
+				// Degenerate triangle: the nearest of its vertices
+				return std::min(Length(AP), std::min(Length(BP), Length(CP)));
+			}
+
+			const auto Closest = MultiplyAdd(MultiplyAdd(A, AB, VB / Denominator), AC, VC / Denominator);
+			return Length(Subtract(Point, Closest));
+		}
+
+		/*!
+		 * \struct FQuadric
+		 *
+		 * \brief Sum of squared distances to weighted planes (symmetric 4x4 matrix)
+		 */
+		struct FQuadric
+		{
+			// a2, ab, ac, ad, b2, bc, bd, c2, cd, d2
+			std::array<double, 10> M = {};
+
+			// Sum of weights of surface planes
+			double Weight = 0.0;
+
+			void AddPlane(const FVector3d& Normal, double Distance, double PlaneWeight)
+			{
+				const double A = Normal[0], B = Normal[1], C = Normal[2], D = Distance;
+
+				M[0] += PlaneWeight*A*A; M[1] += PlaneWeight*A*B; M[2] += PlaneWeight*A*C; M[3] += PlaneWeight*A*D;
+				M[4] += PlaneWeight*B*B; M[5] += PlaneWeight*B*C; M[6] += PlaneWeight*B*D;
+				M[7] += PlaneWeight*C*C; M[8] += PlaneWeight*C*D;
+				M[9] += PlaneWeight*D*D;
+			}
+
+			void Add(const FQuadric& Quadric)
+			{
+				for (auto i = 0; i < 10; ++i)
+				{
+					M[i] += Quadric.M[i];
+				}
+				Weight += Quadric.Weight;
+			}
+
+			// Mean squared distance from the point to the planes
+			double Evaluate(const FVector3d& Point) const
+			{
+				const double X = Point[0], Y = Point[1], Z = Point[2];
+
+				const auto Error =
+					M[0] * X*X + 2.0*M[1] * X*Y + 2.0*M[2] * X*Z + 2.0*M[3] * X +
+					M[4] * Y*Y + 2.0*M[5] * Y*Z + 2.0*M[6] * Y +
+					M[7] * Z*Z + 2.0*M[8] * Z +
+					M[9];
+
+				return std::max(Error, 0.0) / std::max(Weight, 1e-12);
+			}
+		};
+
+		struct FCollapse
+		{
+			// Distance error with attribute penalty, collapses are sorted by it
+			double Error;
+
+			// Mean squared distance to source surface
+			double DistanceError;
+
+			uint32 iFrom;
+			uint32 iTo;
+			uint32 NumTriangles;
+		};
+
+		uint64 MakeEdgeKey(uint32 iVertex0, uint32 iVertex1)
+		{
+			return (uint64(std::min(iVertex0, iVertex1)) << 32) | std::max(iVertex0, iVertex1);
+		}
+	}
+
+	std::unique_ptr<FMeshRawData> FMeshSimplifier::Simplify(
+		const FMeshRawData& MeshData,
+		float TargetRatio,
+		float MaxError) const
+	{
+		if (MeshData.Topology != D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
+		{
+			throw std::invalid_argument("Only triangle list meshes can be simplified");
+		}
+
+		if (TargetRatio <= 0.0f || TargetRatio > 1.0f)
+		{
+			throw std::invalid_argument("TargetRatio must be in (0, 1]");
+		}
+
+		const auto& Vertices = MeshData.Vertices;
+		const auto NumVertices = static_cast<uint32>(Vertices.size());
+
+		std::vector<uint32> Indices(MeshData.Indices.begin(), MeshData.Indices.end());
+		Indices.resize(Indices.size() - Indices.size() % 3);
+
+		const auto TargetNumTriangles = std::max<std::size_t>(1, 
+			static_cast<std::size_t>(Indices.size() / 3 * TargetRatio));
+
+		// Vertices with equal positions are wedges of one position.
+		// Quadrics, borders and locks are kept per position (its first vertex).
+		// Bitwise equal vertices are one wedge, so unwelded meshes (e.g. of OBJ files) are simplified too
+		std::vector<uint32> PositionRemap(NumVertices);
+		std::vector<uint32> NextWedges(NumVertices);
+		std::vector<uint32> WedgeRemap(NumVertices);
+		{
+			std::vector<uint32> SortedVertices(NumVertices);
+			for (uint32 iVertex = 0; iVertex < NumVertices; ++iVertex)
+			{
+				SortedVertices[iVertex] = iVertex;
+			}
+
+			const auto PositionLess = [&](uint32 iVertex0, uint32 iVertex1)
+			{
+				const auto& Position0 = Vertices[iVertex0].Position;
+				const auto& Position1 = Vertices[iVertex1].Position;
+
+				if (Position0.x != Position1.x) return Position0.x < Position1.x;
+				if (Position0.y != Position1.y) return Position0.y < Position1.y;
+				if (Position0.z != Position1.z) return Position0.z < Position1.z;
+
+				const auto Compare = std::memcmp(&Vertices[iVertex0], &Vertices[iVertex1], sizeof(FVertex));
+				if (Compare != 0) return Compare < 0;
+
+				return iVertex0 < iVertex1;
+			};
+			std::sort(SortedVertices.begin(), SortedVertices.end(), PositionLess);
+
+			std::size_t iGroupBegin = 0;
+			for (std::size_t iSorted = 1; iSorted <= NumVertices; ++iSorted)
+			{
+				if (iSorted < NumVertices)
+				{
+					const auto& Position0 = Vertices[SortedVertices[iGroupBegin]].Position;
+					const auto& Position1 = Vertices[SortedVertices[iSorted]].Position;
+					if (Position0.x == Position1.x && Position0.y == Position1.y && Position0.z == Position1.z)
+					{
+						continue;
+					}
+				}
+
+				// Links distinct wedges of the group to a cycle. Duplicates are remapped to the first equal vertex
+				auto iLastWedge = SortedVertices[iGroupBegin];
+				for (auto iWedge = iGroupBegin; iWedge < iSorted; ++iWedge)
+				{
+					const auto iVertex = SortedVertices[iWedge];
+					PositionRemap[iVertex] = SortedVertices[iGroupBegin];
+					NextWedges[iVertex] = SortedVertices[iGroupBegin];
+
+					if (iWedge > iGroupBegin && 
+						std::memcmp(&Vertices[iLastWedge], &Vertices[iVertex], sizeof(FVertex)) == 0)
+					{
+						WedgeRemap[iVertex] = iLastWedge;
+						continue;
+					}
+
+					WedgeRemap[iVertex] = iVertex;
+					NextWedges[iLastWedge] = iVertex;
+					NextWedges[iVertex] = SortedVertices[iGroupBegin];
+					iLastWedge = iVertex;
+				}
+				iGroupBegin = iSorted;
+			}
+		}
+
+		for (auto& Index : Indices)
+		{
+			Index = WedgeRemap[Index];
+		}
+
+		const auto GetPosition = [&](uint32 iVertex)
+		{
+			return ToVector3d(Vertices[iVertex].Position);
+		};
+
+		std::vector<FQuadric> Quadrics(NumVertices);
+		std::vector<bool> bIsLocked(NumVertices, false);
+
+		std::vector<uint64> EdgeKeys;
+		EdgeKeys.reserve(Indices.size());
+
+		// Builds sorted position edges of current triangles
+		const auto BuildEdgeKeys = [&]()
+		{
+			EdgeKeys.clear();
+			for (std::size_t iIndex = 0; iIndex < Indices.size(); iIndex += 3)
+			{
+				for (auto iCorner = 0; iCorner < 3; ++iCorner)
+				{
+					EdgeKeys.push_back(MakeEdgeKey(
+						PositionRemap[Indices[iIndex + iCorner]],
+						PositionRemap[Indices[iIndex + (iCorner + 1) % 3]]));
+				}
+			}
+			std::sort(EdgeKeys.begin(), EdgeKeys.end());
+		};
+
+		const auto CountEdgeTriangles = [&](uint64 EdgeKey)
+		{
+			const auto EdgeRange = std::equal_range(EdgeKeys.begin(), EdgeKeys.end(), EdgeKey);
+			return static_cast<uint32>(EdgeRange.second - EdgeRange.first);
+		};
+
+		// Surface planes weighted by triangles' areas
+		for (std::size_t iIndex = 0; iIndex < Indices.size(); iIndex += 3)
+		{
+			const auto Position0 = GetPosition(Indices[iIndex]);
+			auto Normal = Cross(
+				Subtract(GetPosition(Indices[iIndex + 1]), Position0),
+				Subtract(GetPosition(Indices[iIndex + 2]), Position0));
+
+			const auto NormalLength = Length(Normal);
+			if (NormalLength == 0.0)
+			{
+				continue;
+			}
+
+			Normal = { Normal[0] / NormalLength, Normal[1] / NormalLength, Normal[2] / NormalLength };
+			const auto Area = 0.5*NormalLength;
+
+			for (auto iCorner = 0; iCorner < 3; ++iCorner)
+			{
+				auto& Quadric = Quadrics[PositionRemap[Indices[iIndex + iCorner]]];
+				Quadric.AddPlane(Normal, -Dot(Normal, Position0), Area);
+				Quadric.Weight += Area;
+			}
+		}
+
+		// Border planes are perpendicular to border triangles and keep vertices on the border line.
+		// Vertices of non-manifold edges are locked
+		BuildEdgeKeys();
+		for (std::size_t iIndex = 0; iIndex < Indices.size(); iIndex += 3)
+		{
+			const auto Position0 = GetPosition(Indices[iIndex]);
+			const auto TriangleNormal = Cross(
+				Subtract(GetPosition(Indices[iIndex + 1]), Position0),
+				Subtract(GetPosition(Indices[iIndex + 2]), Position0));
+
+			for (auto iCorner = 0; iCorner < 3; ++iCorner)
+			{
+				const auto iPosition0 = PositionRemap[Indices[iIndex + iCorner]];
+				const auto iPosition1 = PositionRemap[Indices[iIndex + (iCorner + 1) % 3]];
+
+				const auto NumEdgeTriangles = CountEdgeTriangles(MakeEdgeKey(iPosition0, iPosition1));
+				if (NumEdgeTriangles > 2)
+				{
+					bIsLocked[iPosition0] = true;
+					bIsLocked[iPosition1] = true;
+				}
+
+				if (NumEdgeTriangles != 1)
+				{
+					continue;
+				}
+
+				const auto EdgeStart = GetPosition(iPosition0);
+				const auto Edge = Subtract(GetPosition(iPosition1), EdgeStart);
+				auto Normal = Cross(Edge, TriangleNormal);
+
+				const auto NormalLength = Length(Normal);
+				if (NormalLength == 0.0)
+				{
+					continue;
+				}
+
+				Normal = { Normal[0] / NormalLength, Normal[1] / NormalLength, Normal[2] / NormalLength };
+				const auto Weight = BorderWeight*Dot(Edge, Edge);
+
+				Quadrics[iPosition0].AddPlane(Normal, -Dot(Normal, EdgeStart), Weight);
+				Quadrics[iPosition1].AddPlane(Normal, -Dot(Normal, EdgeStart), Weight);
+			}
+		}
+
+		std::vector<uint32> AdjacencyOffsets(NumVertices + 1);
+		std::vector<uint32> AdjacentTriangles;
+
+		std::vector<bool> bIsBorder(NumVertices);
+		std::vector<bool> bIsCollapseLocked(NumVertices);
+		std::vector<uint32> CollapseTargets(NumVertices);
+		std::vector<std::pair<uint32, uint32>> WedgeTargets;
+
+		// Finds for every wedge of the position iFrom the wedge of iTo sharing a triangle with it.
+		// Fails if a wedge doesn't touch iTo (collapse would break an attribute seam) or touches several its wedges.
+		// Wedges without triangles are skipped
+		const auto FindWedgeTargets = [&](uint32 iFrom, uint32 iTo)
+		{
+			WedgeTargets.clear();
+
+			auto iWedge = iFrom;
+			do
+			{
+				if (AdjacencyOffsets[iWedge] == AdjacencyOffsets[iWedge + 1])
+				{
+					iWedge = NextWedges[iWedge];
+					continue;
+				}
+
+				auto iTarget = InvalidIndex;
+				for (auto iAdjacent = AdjacencyOffsets[iWedge]; iAdjacent < AdjacencyOffsets[iWedge + 1]; ++iAdjacent)
+				{
+					const auto iTriangle = AdjacentTriangles[iAdjacent];
+					for (auto iCorner = 0; iCorner < 3; ++iCorner)
+					{
+						const auto iVertex = Indices[iTriangle * 3 + iCorner];
+						if (PositionRemap[iVertex] != iTo)
+						{
+							continue;
+						}
+
+						if (iTarget != InvalidIndex && iTarget != iVertex)
+						{
+							return false;
+						}
+						iTarget = iVertex;
+					}
+				}
+
+				if (iTarget == InvalidIndex)
+				{
+					return false;
+				}
+
+				WedgeTargets.emplace_back(iWedge, iTarget);
+				iWedge = NextWedges[iWedge];
+			} while (iWedge != iFrom);
+
+			return true;
+		};
+
+		// Checks if moving iFrom to iTo rotates any remaining triangle by more than ~90 degrees
+		const auto HasTriangleFlips = [&](uint32 iFrom, uint32 iTo)
+		{
+			const auto NewPosition = GetPosition(iTo);
+
+			auto iWedge = iFrom;
+			do
+			{
+				for (auto iAdjacent = AdjacencyOffsets[iWedge]; iAdjacent < AdjacencyOffsets[iWedge + 1]; ++iAdjacent)
+				{
+					const auto iTriangle = AdjacentTriangles[iAdjacent];
+
+					std::array<uint32, 3> TrianglePositions;
+					for (auto iCorner = 0; iCorner < 3; ++iCorner)
+					{
+						TrianglePositions[iCorner] = PositionRemap[CollapseTargets[Indices[iTriangle * 3 + iCorner]]];
+					}
+
+					// The triangle is removed by the collapse
+					if (std::find(TrianglePositions.begin(), TrianglePositions.end(), iTo) != TrianglePositions.end())
+					{
+						continue;
+					}
+
+					std::array<FVector3d, 3> Positions;
+					std::array<FVector3d, 3> NewPositions;
+					for (auto iCorner = 0; iCorner < 3; ++iCorner)
+					{
+						Positions[iCorner] = GetPosition(TrianglePositions[iCorner]);
+						NewPositions[iCorner] = TrianglePositions[iCorner] == iFrom ? NewPosition : Positions[iCorner];
+					}
+
+					const auto Normal = Cross(
+						Subtract(Positions[1], Positions[0]), Subtract(Positions[2], Positions[0]));
+					const auto NewNormal = Cross(
+						Subtract(NewPositions[1], NewPositions[0]), Subtract(NewPositions[2], NewPositions[0]));
+
+					if (Dot(Normal, NewNormal) <= 1e-2*Length(Normal)*Length(NewNormal))
+					{
+						return true;
+					}
+				}
+
+				iWedge = NextWedges[iWedge];
+			} while (iWedge != iFrom);
+
+			return false;
+		};
+
+		const auto ComputeCollapse = [&](uint32 iFrom, uint32 iTo, uint32 NumEdgeTriangles)
+		{
+			const auto FromPosition = GetPosition(iFrom);
+			const auto ToPosition = GetPosition(iTo);
+
+			auto MaxAttributeDistanceSq = 0.0;
+			for (const auto& WedgeTarget : WedgeTargets)
+			{
+				const auto& FromVertex = Vertices[WedgeTarget.first];
+				const auto& ToVertex = Vertices[WedgeTarget.second];
+
+				const auto NormalDelta = Subtract(ToVector3d(FromVertex.Normal), ToVector3d(ToVertex.Normal));
+				const auto DeltaU = double(FromVertex.TexC.x) - ToVertex.TexC.x;
+				const auto DeltaV = double(FromVertex.TexC.y) - ToVertex.TexC.y;
+
+				MaxAttributeDistanceSq = std::max(MaxAttributeDistanceSq, 
+					Dot(NormalDelta, NormalDelta) + DeltaU*DeltaU + DeltaV*DeltaV);
+			}
+
+			const auto Edge = Subtract(ToPosition, FromPosition);
+			const auto DistanceError = Quadrics[iFrom].Evaluate(ToPosition);
+
+			return FCollapse{ 
+				DistanceError + AttributeWeight*MaxAttributeDistanceSq*Dot(Edge, Edge),
+				DistanceError,
+				iFrom, 
+				iTo, 
+				NumEdgeTriangles };
+		};
+
+		// Position which every source position is collapsed to. Collapses of a pass don't share positions,
+		// so they're followed once per pass
+		std::vector<uint32> Representatives(NumVertices);
+		std::vector<uint32> PositionTargets(NumVertices);
+		for (uint32 iVertex = 0; iVertex < NumVertices; ++iVertex)
+		{
+			Representatives[iVertex] = PositionRemap[iVertex];
+			PositionTargets[iVertex] = iVertex;
+		}
+
+		std::vector<FCollapse> Collapses;
+		const auto MaxErrorSq = double(MaxError)*MaxError;
+
+		while (Indices.size() / 3 > TargetNumTriangles)
+		{
+			const auto NumTriangles = static_cast<uint32>(Indices.size() / 3);
+
+			// Vertex-triangle adjacency of current triangles
+			std::fill(AdjacencyOffsets.begin(), AdjacencyOffsets.end(), 0);
+			for (auto Index : Indices)
+			{
+				++AdjacencyOffsets[Index + 1];
+			}
+
+			for (uint32 iVertex = 0; iVertex < NumVertices; ++iVertex)
+			{
+				AdjacencyOffsets[iVertex + 1] += AdjacencyOffsets[iVertex];
+			}
+
+			AdjacentTriangles.resize(Indices.size());
+			{
+				auto FillOffsets = AdjacencyOffsets;
+				for (uint32 iIndex = 0; iIndex < Indices.size(); ++iIndex)
+				{
+					AdjacentTriangles[FillOffsets[Indices[iIndex]]++] = iIndex / 3;
+				}
+			}
+
+			BuildEdgeKeys();
+
+			std::fill(bIsBorder.begin(), bIsBorder.end(), false);
+			for (std::size_t iEdge = 0; iEdge < EdgeKeys.size(); )
+			{
+				auto iEdgeEnd = iEdge + 1;
+				while (iEdgeEnd < EdgeKeys.size() && EdgeKeys[iEdgeEnd] == EdgeKeys[iEdge])
+				{
+					++iEdgeEnd;
+				}
+
+				if (iEdgeEnd - iEdge == 1)
+				{
+					bIsBorder[EdgeKeys[iEdge] >> 32] = true;
+					bIsBorder[EdgeKeys[iEdge] & UINT32_MAX] = true;
+				}
+				iEdge = iEdgeEnd;
+			}
+
+			// The cheapest valid direction of every edge
+			Collapses.clear();
+			for (std::size_t iEdge = 0; iEdge < EdgeKeys.size(); )
+			{
+				auto iEdgeEnd = iEdge + 1;
+				while (iEdgeEnd < EdgeKeys.size() && EdgeKeys[iEdgeEnd] == EdgeKeys[iEdge])
+				{
+					++iEdgeEnd;
+				}
+
+				const auto NumEdgeTriangles = static_cast<uint32>(iEdgeEnd - iEdge);
+				const auto iPosition0 = static_cast<uint32>(EdgeKeys[iEdge] >> 32);
+				const auto iPosition1 = static_cast<uint32>(EdgeKeys[iEdge] & UINT32_MAX);
+				iEdge = iEdgeEnd;
+
+				FCollapse BestCollapse = { DBL_MAX, DBL_MAX, InvalidIndex, InvalidIndex, NumEdgeTriangles };
+				for (auto iDirection = 0; iDirection < 2; ++iDirection)
+				{
+					const auto iFrom = iDirection == 0 ? iPosition0 : iPosition1;
+					const auto iTo = iDirection == 0 ? iPosition1 : iPosition0;
+
+					// Border vertices may slide only along the border
+					if (bIsLocked[iFrom] || (bIsBorder[iFrom] && NumEdgeTriangles != 1))
+					{
+						continue;
+					}
+
+					if (!FindWedgeTargets(iFrom, iTo))
+					{
+						continue;
+					}
+
+					const auto Collapse = ComputeCollapse(iFrom, iTo, NumEdgeTriangles);
+					if (Collapse.Error < BestCollapse.Error)
+					{
+						BestCollapse = Collapse;
+					}
+				}
+
+				if (BestCollapse.iFrom != InvalidIndex)
+				{
+					Collapses.push_back(BestCollapse);
+				}
+			}
+
+			std::sort(Collapses.begin(), Collapses.end(), [](const FCollapse& Collapse0, const FCollapse& Collapse1)
+			{
+				if (Collapse0.Error != Collapse1.Error) return Collapse0.Error < Collapse1.Error;
+				if (Collapse0.iFrom != Collapse1.iFrom) return Collapse0.iFrom < Collapse1.iFrom;
+				return Collapse0.iTo < Collapse1.iTo;
+			});
+
+			// Collapses of a pass don't share positions, so their errors and wedges stay valid
+			std::fill(bIsCollapseLocked.begin(), bIsCollapseLocked.end(), false);
+			for (uint32 iVertex = 0; iVertex < NumVertices; ++iVertex)
+			{
+				CollapseTargets[iVertex] = iVertex;
+			}
+
+			const auto NumTrianglesToRemove = NumTriangles - TargetNumTriangles;
+			auto NumRemovedTriangles = 0u;
+			auto NumPerformedCollapses = 0u;
+
+			for (const auto& Collapse : Collapses)
+			{
+				if (Collapse.Error > MaxErrorSq || NumRemovedTriangles >= NumTrianglesToRemove)
+				{
+					break;
+				}
+
+				if (bIsCollapseLocked[Collapse.iFrom] || bIsCollapseLocked[Collapse.iTo])
+				{
+					continue;
+				}
+
+				if (HasTriangleFlips(Collapse.iFrom, Collapse.iTo) || !FindWedgeTargets(Collapse.iFrom, Collapse.iTo))
+				{
+					continue;
+				}
+
+				for (const auto& WedgeTarget : WedgeTargets)
+				{
+					CollapseTargets[WedgeTarget.first] = WedgeTarget.second;
+				}
+
+				Quadrics[Collapse.iTo].Add(Quadrics[Collapse.iFrom]);
+				bIsCollapseLocked[Collapse.iFrom] = true;
+				bIsCollapseLocked[Collapse.iTo] = true;
+
+				PositionTargets[Collapse.iFrom] = Collapse.iTo;
+				NumRemovedTriangles += Collapse.NumTriangles;
+				++NumPerformedCollapses;
+			}
+
+			if (NumPerformedCollapses == 0)
+			{
+				break;
+			}
+
+			for (auto& Representative : Representatives)
+			{
+				Representative = PositionTargets[Representative];
+			}
+
+			for (const auto& Collapse : Collapses)
+			{
+				PositionTargets[Collapse.iFrom] = Collapse.iFrom;
+			}
+
+			// Applies collapses and removes degenerate triangles
+			std::size_t NumIndices = 0;
+			for (std::size_t iIndex = 0; iIndex < Indices.size(); iIndex += 3)
+			{
+				const auto iVertex0 = CollapseTargets[Indices[iIndex]];
+				const auto iVertex1 = CollapseTargets[Indices[iIndex + 1]];
+				const auto iVertex2 = CollapseTargets[Indices[iIndex + 2]];
+
+				const auto iPosition0 = PositionRemap[iVertex0];
+				const auto iPosition1 = PositionRemap[iVertex1];
+				const auto iPosition2 = PositionRemap[iVertex2];
+
+				if (iPosition0 == iPosition1 || iPosition1 == iPosition2 || iPosition0 == iPosition2)
+				{
+					continue;
+				}
+
+				Indices[NumIndices++] = iVertex0;
+				Indices[NumIndices++] = iVertex1;
+				Indices[NumIndices++] = iVertex2;
+			}
+			Indices.resize(NumIndices);
+		}
+
+		// Keeps referenced vertices only in order of their first use
+		auto SimplifiedMesh = std::make_unique<FMeshRawData>(MeshData.Name);
+		SimplifiedMesh->Topology = MeshData.Topology;
+		SimplifiedMesh->GeometricError = static_cast<float>(MeasureMaxDeviation(MeshData, Indices, PositionRemap, Representatives));
+		SimplifiedMesh->Transform = MeshData.Transform;
+		SimplifiedMesh->MaterialIndex = MeshData.MaterialIndex;
+		SimplifiedMesh->Indices.reserve(Indices.size());
+
+		std::vector<uint32> VerticesRemap(NumVertices, InvalidIndex);
+		for (auto Index : Indices)
+		{
+			if (VerticesRemap[Index] == InvalidIndex)
+			{
+				VerticesRemap[Index] = static_cast<uint32>(SimplifiedMesh->Vertices.size());
+				SimplifiedMesh->Vertices.push_back(Vertices[Index]);
+			}
+
+			SimplifiedMesh->Indices.push_back(VerticesRemap[Index]);
+		}
+
+		return SimplifiedMesh;
+	}
+
+	double FMeshSimplifier::MeasureMaxDeviation(
+		const FMeshRawData& MeshData,
+		const std::vector<uint32>& Indices,
+		const std::vector<uint32>& PositionRemap,
+		const std::vector<uint32>& Representatives)
+	{
+		const auto NumVertices = static_cast<uint32>(MeshData.Vertices.size());
+		const auto GetPosition = [&](uint32 iVertex)
+		{
+			return ToVector3d(MeshData.Vertices[iVertex].Position);
+		};
+
+		// Triangles of the simplified mesh around every position
+		std::vector<uint32> AdjacencyOffsets(NumVertices + 1, 0);
+		for (auto Index : Indices)
+		{
+			++AdjacencyOffsets[PositionRemap[Index] + 1];
+		}
+
+		for (uint32 iVertex = 0; iVertex < NumVertices; ++iVertex)
+		{
+			AdjacencyOffsets[iVertex + 1] += AdjacencyOffsets[iVertex];
+		}
+
+		std::vector<uint32> AdjacentTriangles(Indices.size());
+		{
+			auto FillOffsets = AdjacencyOffsets;
+			for (uint32 iIndex = 0; iIndex < Indices.size(); ++iIndex)
+			{
+				AdjacentTriangles[FillOffsets[PositionRemap[Indices[iIndex]]]++] = iIndex / 3;
+			}
+		}
+
+		// Every source position walks from its collapse target to the nearest triangle while its distance decreases.
+		// Distance to any triangle is an upper bound of its distance to the simplified surface
+		std::vector<bool> bIsReferenced(NumVertices, false);
+		for (auto Index : MeshData.Indices)
+		{
+			bIsReferenced[PositionRemap[Index]] = true;
+		}
+
+		auto MaxDeviation = 0.0;
+		for (uint32 iPosition = 0; iPosition < NumVertices; ++iPosition)
+		{
+			const auto iRepresentative = Representatives[iPosition];
+			if (PositionRemap[iPosition] != iPosition || !bIsReferenced[iPosition] || iRepresentative == iPosition ||
+				AdjacencyOffsets[iRepresentative] == AdjacencyOffsets[iRepresentative + 1])
+			{
+				continue;
+			}
+
+			const auto Position = GetPosition(iPosition);
+			auto Deviation = DBL_MAX;
+			auto iNearestTriangle = InvalidIndex;
+			std::array<uint32, 3> SearchedPositions = { iRepresentative, iRepresentative, iRepresentative };
+			for (;;)
+			{
+				const auto PrevDeviation = Deviation;
+				for (auto iSearched : SearchedPositions)
+				{
+					for (auto iAdjacent = AdjacencyOffsets[iSearched]; iAdjacent < AdjacencyOffsets[iSearched + 1]; ++iAdjacent)
+					{
+						const auto iTriangle = AdjacentTriangles[iAdjacent];
+						const auto Distance = GetPointTriangleDistance(Position,
+							GetPosition(Indices[iTriangle * 3]), GetPosition(Indices[iTriangle * 3 + 1]), GetPosition(Indices[iTriangle * 3 + 2]));
+						if (Distance < Deviation)
+						{
+							Deviation = Distance;
+							iNearestTriangle = iTriangle;
+						}
+					}
+				}
+
+				if (Deviation >= PrevDeviation)
+				{
+					break;
+				}
+
+				for (uint32 iCorner = 0; iCorner < 3; ++iCorner)
+				{
+					SearchedPositions[iCorner] = PositionRemap[Indices[iNearestTriangle * 3 + iCorner]];
+				}
+			}
+
+			MaxDeviation = std::max(MaxDeviation, Deviation);
+		}
+
+		return MaxDeviation;
+	}
+
+	std::vector<std::unique_ptr<FMeshRawData>> FMeshSimplifier::GenerateLODs(
+		const FMeshRawData& MeshData,
+		const std::vector<float>& TargetRatios) const
+	{
+		std::vector<std::unique_ptr<FMeshRawData>> LODs(TargetRatios.size());
+
+		// Levels are independent, so they're simplified in parallel
+		Concurrency::parallel_for(std::size_t(0), TargetRatios.size(), [&](std::size_t iLOD)
+		{
+			LODs[iLOD] = Simplify(MeshData, TargetRatios[iLOD]);
+			LODs[iLOD]->Name = MeshData.Name + "_lod" + std::to_string(iLOD + 1);
+		});
+
+		return LODs;
+	}
+
+	float FMeshSimplifier::ComputeScreenSpaceError(float GeometricError, float Distance, float ProjectionScale) noexcept
+	{
+		return GeometricError*ProjectionScale / std::max(Distance, 1e-4f);
+	}
+}
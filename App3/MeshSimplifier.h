@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cfloat>
+
+#include "MeshData.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \class FMeshSimplifier
+	 *
+	 * \brief Reduces triangles of a triangle list mesh by quadric error metric edge collapses.
+	 * Vertices are collapsed onto their neighbours, so attributes aren't interpolated.
+	 * Borders and attribute seams (uv/normal splits) are kept
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FMeshSimplifier
+	{
+	public:
+		FMeshSimplifier() = default;
+		~FMeshSimplifier() = default;
+
+		FMeshSimplifier& operator=(const FMeshSimplifier& MeshSimplifier) = delete;
+		FMeshSimplifier(const FMeshSimplifier& MeshSimplifier) = delete;
+		FMeshSimplifier(FMeshSimplifier&& MeshSimplifier) = delete;
+
+		/** @brief Simplifies the mesh until the number of triangles reaches the target or
+		  * the cheapest collapse exceeds max error
+		  * @param MeshData Triangle list mesh data (const FMeshRawData &)
+		  * @param TargetRatio Target ratio of number of triangles, in (0, 1] (float)
+		  * @param MaxError Max error of a collapse: RMS distance of the moved vertex to planes of its source triangles,
+		  * in the mesh's units (float)
+		  * @return Simplified mesh with GeometricError measured as max deviation of source vertices from it
+		  * (std::unique_ptr<WoodenEngine::FMeshRawData>)
+		  */
+		std::unique_ptr<FMeshRawData> Simplify(
+			const FMeshRawData& MeshData, 
+			float TargetRatio,
+			float MaxError = FLT_MAX) const;
+
+		/** @brief Simplifies the mesh for every target ratio in parallel.
+		  * Every LOD is simplified from the source mesh and named "<Name>_lod<i>", i = 1..N
+		  * @param MeshData Triangle list mesh data (const FMeshRawData &)
+		  * @param TargetRatios Target ratios of number of triangles from detailed to coarse (const std::vector<float> &)
+		  * @return (std::vector<std::unique_ptr<WoodenEngine::FMeshRawData>>)
+		  */
+		std::vector<std::unique_ptr<FMeshRawData>> GenerateLODs(
+			const FMeshRawData& MeshData,
+			const std::vector<float>& TargetRatios) const;
+
+		/** @brief Projects geometric error to the screen
+		  * @param GeometricError World space geometric error (float)
+		  * @param Distance Distance from the camera to the object (float)
+		  * @param ProjectionScale ScreenHeight / (2 * tan(FovY / 2)) (float)
+		  * @return Error in pixels (float)
+		  */
+		static float ComputeScreenSpaceError(float GeometricError, float Distance, float ProjectionScale) noexcept;
+
+	private:
+		/** @brief Measures max distance from source vertices to the simplified surface. Every collapsed vertex
+		  * is measured to triangles around its collapse target, so the result may exceed the exact Hausdorff distance
+		  * @param MeshData Source mesh (const FMeshRawData &)
+		  * @param Indices Simplified indices of source vertices (const std::vector<uint32> &)
+		  * @param PositionRemap First vertex of every vertex's position (const std::vector<uint32> &)
+		  * @param Representatives Position which every source position is collapsed to (const std::vector<uint32> &)
+		  * @return (double)
+		  */
+		static double MeasureMaxDeviation(
+			const FMeshRawData& MeshData,
+			const std::vector<uint32>& Indices,
+			const std::vector<uint32>& PositionRemap,
+			const std::vector<uint32>& Representatives);
+
+		// Weight of planes keeping border edges relative to surface planes
+		static constexpr double BorderWeight = 10.0;
+
+		// Weight of normal and uv differences of collapsed vertices
+		static constexpr double AttributeWeight = 0.25;
+	};
+}
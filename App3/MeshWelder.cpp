@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <ppl.h>
+
+#include "MeshWelder.h"
+
+namespace WoodenEngine
+{
+	namespace
+	{
+		// Position, normal, tangent and uv quantized to cells of epsilon size.
+		// Cells are 64-bit, since positions of 21k units already exceed int32 cells at the default epsilon
+		using FQuantizedVertex = std::array<int64, 11>;
+
+		// Cells beyond the range are clamped, so huge or infinite values don't overflow the cast
+		constexpr double MaxQuantizedCell = 4.0e18;
+
+		int64 Quantize(float Value, double InvEpsilon)
+		{
+			const auto Cell = std::floor(static_cast<double>(Value)*InvEpsilon + 0.5);
+			return static_cast<int64>(std::max(-MaxQuantizedCell, std::min(Cell, MaxQuantizedCell)));
+		}
+
+		uint64 HashQuantizedVertex(const FQuantizedVertex& Key)
+		{
+			// FNV-1a over components
+			uint64 Hash = 14695981039346656037ULL;
+			for (auto Component : Key)
+			{
+				const auto Bits = static_cast<uint64>(Component);
+				Hash ^= Bits & 0xFFFFFFFFULL;
+				Hash *= 1099511628211ULL;
+				Hash ^= Bits >> 32;
+				Hash *= 1099511628211ULL;
+			}
+			return Hash;
+		}
+	}
+
+	FWeldStats FMeshWelder::Weld(FMeshRawData* MeshData, const FWeldSettings& Settings) const
+	{
+		FWeldStats Stats;
+
+		const auto NumVertices = MeshData->Vertices.size();
+		Stats.NumVerticesBefore = NumVertices;
+		Stats.NumVerticesAfter = NumVertices;
+
+		if (NumVertices == 0)
+		{
+			return Stats;
+		}
+
+		const auto InvPositionEpsilon = 1.0 / Settings.PositionEpsilon;
+		const auto InvNormalEpsilon = 1.0 / Settings.NormalEpsilon;
+		const auto InvTangentEpsilon = 1.0 / Settings.TangentEpsilon;
+		const auto InvTexCEpsilon = 1.0 / Settings.TexCEpsilon;
+
+		std::vector<FQuantizedVertex> Keys(NumVertices);
+		std::vector<uint64> Hashes(NumVertices);
+
+		// Quantizing and hashing are independent per vertex, so they're done in parallel chunks
+		const auto NumChunks = (NumVertices + NumVerticesPerChunk - 1) / NumVerticesPerChunk;
+		Concurrency::parallel_for(std::size_t(0), NumChunks, [&](std::size_t iChunk)
+		{
+			const auto iBegin = iChunk * NumVerticesPerChunk;
+			const auto iEnd = std::min(iBegin + NumVerticesPerChunk, NumVertices);
+
+			for (auto iVertex = iBegin; iVertex < iEnd; ++iVertex)
+			{
+				const auto& Vertex = MeshData->Vertices[iVertex];
+
+				Keys[iVertex] = {
+					Quantize(Vertex.Position.x, InvPositionEpsilon),
+					Quantize(Vertex.Position.y, InvPositionEpsilon),
+					Quantize(Vertex.Position.z, InvPositionEpsilon),
+					Quantize(Vertex.Normal.x, InvNormalEpsilon),
+					Quantize(Vertex.Normal.y, InvNormalEpsilon),
+					Quantize(Vertex.Normal.z, InvNormalEpsilon),
+					Quantize(Vertex.Tangent.x, InvTangentEpsilon),
+					Quantize(Vertex.Tangent.y, InvTangentEpsilon),
+					Quantize(Vertex.Tangent.z, InvTangentEpsilon),
+					Quantize(Vertex.TexC.x, InvTexCEpsilon),
+					Quantize(Vertex.TexC.y, InvTexCEpsilon)
+				};
+
+				Hashes[iVertex] = HashQuantizedVertex(Keys[iVertex]);
+			}
+		});
+
+		// Equal vertices become neighbours after sorting by (hash, key, index),
+		// so the first vertex of every run is the one which is kept
+		std::vector<uint32> SortedVertices(NumVertices);
+		for (uint32 iVertex = 0; iVertex < NumVertices; ++iVertex)
+		{
+			SortedVertices[iVertex] = iVertex;
+		}
+
+		Concurrency::parallel_sort(SortedVertices.begin(), SortedVertices.end(), [&](uint32 iVertex0, uint32 iVertex1)
+		{
+			if (Hashes[iVertex0] != Hashes[iVertex1])
+			{
+				return Hashes[iVertex0] < Hashes[iVertex1];
+			}
+
+			if (Keys[iVertex0] != Keys[iVertex1])
+			{
+				return Keys[iVertex0] < Keys[iVertex1];
+			}
+
+			return iVertex0 < iVertex1;
+		});
+
+		std::vector<uint32> Representatives(NumVertices);
+		uint32 iRepresentative = SortedVertices[0];
+		for (std::size_t iSorted = 0; iSorted < NumVertices; ++iSorted)
+		{
+			const auto iVertex = SortedVertices[iSorted];
+			if (Keys[iVertex] != Keys[iRepresentative])
+			{
+				iRepresentative = iVertex;
+			}
+			Representatives[iVertex] = iRepresentative;
+		}
+
+		// Compact kept vertices in their original order
+		std::vector<uint32> VerticesRemap(NumVertices);
+		uint32 NumWeldedVertices = 0;
+		for (uint32 iVertex = 0; iVertex < NumVertices; ++iVertex)
+		{
+			if (Representatives[iVertex] == iVertex)
+			{
+				MeshData->Vertices[NumWeldedVertices] = MeshData->Vertices[iVertex];
+				VerticesRemap[iVertex] = NumWeldedVertices++;
+			}
+			else
+			{
+				VerticesRemap[iVertex] = VerticesRemap[Representatives[iVertex]];
+			}
+		}
+
+		MeshData->Vertices.resize(NumWeldedVertices);
+
+		for (auto& Index : MeshData->Indices)
+		{
+			Index = VerticesRemap[Index];
+		}
+
+		Stats.NumVerticesAfter = NumWeldedVertices;
+		Stats.NumBytesSaved = (Stats.NumVerticesBefore - Stats.NumVerticesAfter)*sizeof(SVertexData);
+
+		return Stats;
+	}
+}
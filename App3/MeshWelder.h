@@ -0,0 +1,74 @@
+#pragma once
+
+#include "MeshData.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FWeldSettings
+	 *
+	 * \brief Sizes of cells to which attributes are quantized for welding. Vertices are welded if all their
+ * attributes fall to the same cells, so vertices closer than epsilon on different sides of a cell's border
+ * stay apart, and vertices of one cell are welded even if they differ by almost epsilon
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FWeldSettings
+	{
+		float PositionEpsilon = 1e-5f;
+		float NormalEpsilon = 1e-3f;
+		float TangentEpsilon = 1e-3f;
+		float TexCEpsilon = 1e-5f;
+	};
+
+	/*!
+	 * \struct FWeldStats
+	 *
+	 * \brief Result of vertices welding of a mesh
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FWeldStats
+	{
+		uint64 NumVerticesBefore = 0;
+		uint64 NumVerticesAfter = 0;
+
+		// Size of removed vertices in the GPU vertex buffer
+		uint64 NumBytesSaved = 0;
+	};
+
+	/*!
+	 * \class FMeshWelder
+	 *
+	 * \brief Merges duplicated vertices of a mesh and remaps its indices.
+	 * Vertices are hashed by their attributes quantized to epsilon-sized cells
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FMeshWelder
+	{
+	public:
+		FMeshWelder() = default;
+		~FMeshWelder() = default;
+
+		FMeshWelder& operator=(const FMeshWelder& MeshWelder) = delete;
+		FMeshWelder(const FMeshWelder& MeshWelder) = delete;
+		FMeshWelder(FMeshWelder&& MeshWelder) = delete;
+
+		/** @brief Welds vertices which have the same quantized position, normal, tangent and uv.
+		  * Neighbour cells aren't searched, see FWeldSettings.
+		  * The first vertex of every group is kept, vertices' order is preserved
+		  * @param MeshData Mesh data (FMeshRawData *)
+		  * @param Settings Epsilon per attribute (const FWeldSettings &)
+		  * @return Number of vertices before/after and saved bytes (WoodenEngine::FWeldStats)
+		  */
+		FWeldStats Weld(FMeshRawData* MeshData, const FWeldSettings& Settings = FWeldSettings()) const;
+
+	private:
+		// Number of vertices quantized by one worker thread
+		static constexpr std::size_t NumVerticesPerChunk = 8192;
+	};
+}
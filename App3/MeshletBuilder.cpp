@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <cmath>
+
+#include "MeshletBuilder.h"
+
+namespace WoodenEngine
+{
+	namespace
+	{
+		constexpr uint32 InvalidIndex = UINT32_MAX;
+	}
+
+	std::vector<FMeshlet> FMeshletBuilder::Build(FMeshRawData* MeshData) const
+	{
+		std::vector<FMeshlet> Meshlets;
+
+		const auto NumVertices = MeshData->Vertices.size();
+		const auto NumTriangles = static_cast<uint32>(MeshData->Indices.size() / 3);
+		if (NumTriangles == 0)
+		{
+			return Meshlets;
+		}
+
+		const auto& Indices = MeshData->Indices;
+
+		// Vertex-triangle adjacency in compressed form: triangles of vertex i
+		// are AdjacentTriangles[AdjacencyOffsets[i]...AdjacencyOffsets[i+1]]
+		std::vector<uint32> AdjacencyOffsets(NumVertices + 1, 0);
+		for (uint32 iIndex = 0; iIndex < NumTriangles * 3; ++iIndex)
+		{
+			++AdjacencyOffsets[Indices[iIndex] + 1];
+		}
+
+		for (std::size_t iVertex = 0; iVertex < NumVertices; ++iVertex)
+		{
+			AdjacencyOffsets[iVertex + 1] += AdjacencyOffsets[iVertex];
+		}
+
+		std::vector<uint32> AdjacentTriangles(NumTriangles * 3);
+		{
+			auto FillOffsets = AdjacencyOffsets;
+			for (uint32 iIndex = 0; iIndex < NumTriangles * 3; ++iIndex)
+			{
+				AdjacentTriangles[FillOffsets[Indices[iIndex]]++] = iIndex / 3;
+			}
+		}
+
+		std::vector<bool> bIsTriangleEmitted(NumTriangles, false);
+
+		// Id of the last meshlet which used the vertex/considered the triangle
+		std::vector<uint32> VertexMeshlets(NumVertices, InvalidIndex);
+		std::vector<uint32> CandidateMeshlets(NumTriangles, InvalidIndex);
+
+		std::vector<uint32> MeshletsIndices;
+		MeshletsIndices.reserve(Indices.size());
+
+		std::vector<uint32> Candidates;
+		uint32 iNextSeedTriangle = 0;
+
+		FMeshlet Meshlet;
+		auto iMeshlet = 0u;
+
+		const auto FlushMeshlet = [&]()
+		{
+			Meshlet.IndexBegin = static_cast<uint32>(MeshletsIndices.size() - Meshlet.NumTriangles * 3);
+			ComputeBounds(&Meshlet, *MeshData, MeshletsIndices.data() + Meshlet.IndexBegin);
+			Meshlets.push_back(Meshlet);
+
+			Meshlet = FMeshlet();
+			Candidates.clear();
+			++iMeshlet;
+		};
+
+		const auto NumNewVertices = [&](uint32 iTriangle)
+		{
+			auto NumNew = 0u;
+			for (auto iCorner = 0; iCorner < 3; ++iCorner)
+			{
+				NumNew += VertexMeshlets[Indices[iTriangle * 3 + iCorner]] != iMeshlet;
+			}
+			return NumNew;
+		};
+
+		for (auto NumEmittedTriangles = 0u; NumEmittedTriangles < NumTriangles; ++NumEmittedTriangles)
+		{
+			// Prefer triangles adding fewer new vertices, then triangles with lower index
+			auto iBestTriangle = InvalidIndex;
+			auto BestNumNewVertices = 4u;
+
+			auto NumCandidates = 0u;
+			for (auto iCandidate : Candidates)
+			{
+				if (bIsTriangleEmitted[iCandidate])
+				{
+					continue;
+				}
+				Candidates[NumCandidates++] = iCandidate;
+
+				const auto NumNew = NumNewVertices(iCandidate);
+				if (NumNew < BestNumNewVertices || (NumNew == BestNumNewVertices && iCandidate < iBestTriangle))
+				{
+					iBestTriangle = iCandidate;
+					BestNumNewVertices = NumNew;
+				}
+			}
+			Candidates.resize(NumCandidates);
+
+			if (iBestTriangle == InvalidIndex)
+			{
+				// No connected triangles left, so continue with the next triangle in the mesh's order
+				while (bIsTriangleEmitted[iNextSeedTriangle])
+				{
+					++iNextSeedTriangle;
+				}
+
+				iBestTriangle = iNextSeedTriangle;
+				BestNumNewVertices = NumNewVertices(iBestTriangle);
+			}
+
+			if (Meshlet.NumVertices + BestNumNewVertices > MaxNumVertices ||
+				Meshlet.NumTriangles + 1 > MaxNumTriangles)
+			{
+				FlushMeshlet();
+				BestNumNewVertices = 3;
+			}
+
+			bIsTriangleEmitted[iBestTriangle] = true;
+			++Meshlet.NumTriangles;
+
+			for (auto iCorner = 0; iCorner < 3; ++iCorner)
+			{
+				const auto iVertex = Indices[iBestTriangle * 3 + iCorner];
+				MeshletsIndices.push_back(iVertex);
+
+				if (VertexMeshlets[iVertex] == iMeshlet)
+				{
+					continue;
+				}
+
+				VertexMeshlets[iVertex] = iMeshlet;
+				++Meshlet.NumVertices;
+
+				for (auto iAdjacent = AdjacencyOffsets[iVertex]; iAdjacent < AdjacencyOffsets[iVertex + 1]; ++iAdjacent)
+				{
+					const auto iTriangle = AdjacentTriangles[iAdjacent];
+					if (!bIsTriangleEmitted[iTriangle] && CandidateMeshlets[iTriangle] != iMeshlet)
+					{
+						CandidateMeshlets[iTriangle] = iMeshlet;
+						Candidates.push_back(iTriangle);
+					}
+				}
+			}
+		}
+
+		FlushMeshlet();
+
+		MeshData->Indices = std::move(MeshletsIndices);
+
+		return Meshlets;
+	}
+
+	bool FMeshletBuilder::IsBackfacing(const FMeshlet& Meshlet, FXMVECTOR CameraPosition) noexcept
+	{
+		const auto Center = XMLoadFloat3(&Meshlet.BoundingSphereCenter);
+		const auto Axis = XMLoadFloat3(&Meshlet.ConeAxis);
+		const auto CameraToCenter = XMVectorSubtract(Center, CameraPosition);
+
+		// The camera is inside the inverted normal cone for every point of the bounding sphere
+		return XMVectorGetX(XMVector3Dot(CameraToCenter, Axis)) >=
+			Meshlet.ConeCutoff * XMVectorGetX(XMVector3Length(CameraToCenter)) + Meshlet.BoundingSphereRadius;
+	}
+
+	void FMeshletBuilder::ComputeBounds(FMeshlet* Meshlet, const FMeshRawData& MeshData, const uint32* Indices)
+	{
+		const auto NumIndices = Meshlet->NumTriangles * 3;
+
+		const auto GetPosition = [&](uint32 iIndex)
+		{
+			return XMLoadFloat3(&MeshData.Vertices[Indices[iIndex]].Position);
+		};
+
+		const auto FindFarthest = [&](FXMVECTOR Point)
+		{
+			auto Farthest = Point;
+			auto MaxDistanceSq = -1.0f;
+			for (auto iIndex = 0u; iIndex < NumIndices; ++iIndex)
+			{
+				const auto Position = GetPosition(iIndex);
+				const auto DistanceSq = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(Position, Point)));
+				if (DistanceSq > MaxDistanceSq)
+				{
+					MaxDistanceSq = DistanceSq;
+					Farthest = Position;
+				}
+			}
+			return Farthest;
+		};
+
+		// Ritter's bounding sphere: initial sphere on two distant points, then growing it by outliers
+		const auto Point0 = FindFarthest(GetPosition(0));
+		const auto Point1 = FindFarthest(Point0);
+
+		auto Center = XMVectorScale(XMVectorAdd(Point0, Point1), 0.5f);
+		auto Radius = 0.5f*XMVectorGetX(XMVector3Length(XMVectorSubtract(Point1, Point0)));
+
+		for (auto iIndex = 0u; iIndex < NumIndices; ++iIndex)
+		{
+			const auto Offset = XMVectorSubtract(GetPosition(iIndex), Center);
+			const auto Distance = XMVectorGetX(XMVector3Length(Offset));
+			if (Distance > Radius)
+			{
+				const auto NewRadius = 0.5f*(Radius + Distance);
+				Center = XMVectorAdd(Center, XMVectorScale(Offset, (NewRadius - Radius) / Distance));
+				Radius = NewRadius;
+			}
+		}
+
+		XMStoreFloat3(&Meshlet->BoundingSphereCenter, Center);
+		Meshlet->BoundingSphereRadius = Radius;
+
+		// Normal cone: average triangle normal and the max deviation from it
+		std::vector<XMVECTOR> Normals;
+		Normals.reserve(Meshlet->NumTriangles);
+
+		auto NormalsSum = XMVectorZero();
+		for (auto iIndex = 0u; iIndex < NumIndices; iIndex += 3)
+		{
+			const auto Position0 = GetPosition(iIndex);
+			const auto Normal = XMVector3Cross(
+				XMVectorSubtract(GetPosition(iIndex + 1), Position0),
+				XMVectorSubtract(GetPosition(iIndex + 2), Position0));
+
+			if (XMVectorGetX(XMVector3LengthSq(Normal)) > 0.0f)
+			{
+				Normals.push_back(XMVector3Normalize(Normal));
+				NormalsSum = XMVectorAdd(NormalsSum, Normals.back());
+			}
+		}
+
+		Meshlet->ConeAxis = { 0.0f, 0.0f, 0.0f };
+		Meshlet->ConeCutoff = 1.0f;
+
+		if (Normals.empty() || XMVectorGetX(XMVector3LengthSq(NormalsSum)) < 1e-12f)
+		{
+			return;
+		}
+
+		const auto Axis = XMVector3Normalize(NormalsSum);
+
+		auto MinDot = 1.0f;
+		for (const auto& Normal : Normals)
+		{
+			MinDot = std::min(MinDot, XMVectorGetX(XMVector3Dot(Normal, Axis)));
+		}
+
+		XMStoreFloat3(&Meshlet->ConeAxis, Axis);
+
+		// Cones wider than ~84 degrees are too wide to cull anything
+		if (MinDot > 0.1f)
+		{
+			// Angle of the normal cone is acos(MinDot); back-facing region is
+			// the cone inverted and widened by 90 degrees, so its cutoff is sin(acos(MinDot))
+			Meshlet->ConeCutoff = sqrtf(1.0f - MinDot*MinDot);
+		}
+	}
+}
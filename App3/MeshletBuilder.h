@@ -0,0 +1,53 @@
+#pragma once
+
+#include "MeshData.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \class FMeshletBuilder
+	 *
+	 * \brief Splits a triangle list mesh to meshlets with bounding spheres and normal cones.
+	 * The result depends only on the input mesh, so it's deterministic
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FMeshletBuilder
+	{
+	public:
+		FMeshletBuilder() = default;
+		~FMeshletBuilder() = default;
+
+		FMeshletBuilder& operator=(const FMeshletBuilder& MeshletBuilder) = delete;
+		FMeshletBuilder(const FMeshletBuilder& MeshletBuilder) = delete;
+		FMeshletBuilder(FMeshletBuilder&& MeshletBuilder) = delete;
+
+		/** @brief Groups triangles to meshlets, growing every meshlet by triangles
+		  * which share the most vertices with it. Reorders the mesh's indices,
+		  * so every meshlet is a contiguous range of indices
+		  * @param MeshData Triangle list mesh data (FMeshRawData *)
+		  * @return Meshlets in order of the new indices (std::vector<WoodenEngine::FMeshlet>)
+		  */
+		std::vector<FMeshlet> Build(FMeshRawData* MeshData) const;
+
+		/** @brief Checks if all triangles of the meshlet are back-facing to the camera
+		  * @param Meshlet (const FMeshlet &)
+		  * @param CameraPosition Camera position in the mesh's local space (FXMVECTOR)
+		  * @return (bool)
+		  */
+		static bool IsBackfacing(const FMeshlet& Meshlet, FXMVECTOR CameraPosition) noexcept;
+
+		static constexpr uint32 MaxNumVertices = 64;
+		static constexpr uint32 MaxNumTriangles = 124;
+
+	private:
+		/** @brief Computes bounding sphere and normal cone of the meshlet
+		  * @param Meshlet (FMeshlet *)
+		  * @param MeshData Mesh with the meshlet's triangles (const FMeshRawData &)
+		  * @param Indices Indices of the meshlet's triangles (const uint32 *)
+		  * @return (void)
+		  */
+		static void ComputeBounds(FMeshlet* Meshlet, const FMeshRawData& MeshData, const uint32* Indices);
+	};
+}
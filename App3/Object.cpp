@@ -2,32 +2,48 @@
 
 namespace WoodenEngine
 {
+	namespace
+	{
+		XMFLOAT4 QuaternionFromRotation(const XMFLOAT3& Rotation) noexcept
+		{
+			XMFLOAT4 Quaternion;
+			XMStoreFloat4(&Quaternion, XMQuaternionRotationRollPitchYawFromVector(XMLoadFloat3(&Rotation)));
+			return Quaternion;
+		}
+	}
+
+	WObject::WObject():
+		Transform(GetTransformStore().Create())
+	{
+	}
+
 	WObject::WObject(
-		const std::string& MeshName,
-		const std::string& SubmeshName,
+		FSubmeshHandle SubmeshHandle,
 		const XMFLOAT3& Position,
 		const XMFLOAT3& Rotation,
 		const XMFLOAT3& Scale) :
-		MeshName(MeshName),
-		SubmeshName(SubmeshName),
-		Position(Position),
-		Rotation(Rotation),
-		Scale(Scale),
+		SubmeshHandle(SubmeshHandle),
+		Transform(GetTransformStore().Create(Position, QuaternionFromRotation(Rotation), Scale)),
 		bIsRenderable(true)
 	{
-		UpdateWorldTransform();
+	}
+
+	WObject::~WObject()
+	{
+		GetTransformStore().Destroy(Transform);
 	}
 
 
 	WObject::WObject(const WObject& Object)
 	{
 		// Doesn't copy iConstBuffer, bIsVisible, Texture and World Transform. Recomputes the last by itself
+		auto& TransformStore = GetTransformStore();
+		Transform = TransformStore.Create(
+			TransformStore.GetPosition(Object.Transform),
+			TransformStore.GetRotation(Object.Transform),
+			TransformStore.GetScale(Object.Transform));
 
-		MeshName = Object.MeshName;
-		SubmeshName = Object.SubmeshName;
-		Position = Object.Position;
-		Rotation = Object.Rotation;
-		Scale = Object.Scale;
+		SubmeshHandle = Object.SubmeshHandle;
 		Color = Object.Color;
 
 		bIsUpdating = Object.bIsUpdating;
@@ -35,8 +51,6 @@ namespace WoodenEngine
 		bIsEnabledInputEvents = Object.bIsEnabledInputEvents;
 		Material = Object.Material;
 		WaterFactor = Object.WaterFactor;
-
-		UpdateWorldTransform();
 	}
 
 	void WObject::Update(float Delta)
@@ -47,8 +61,7 @@ namespace WoodenEngine
 
 	void WObject::SetPosition(const XMFLOAT3& Position) noexcept
 	{
-		this->Position = Position;
-		UpdateWorldTransform();
+		GetTransformStore().SetPosition(Transform, Position);
 	}
 
 	void WObject::SetPosition(const float X, const float Y, const float Z) noexcept
@@ -58,8 +71,7 @@ namespace WoodenEngine
 
 	void WObject::SetRotation(const XMFLOAT3& Rotation) noexcept
 	{
-		this->Rotation = Rotation;
-		UpdateWorldTransform();
+		GetTransformStore().SetRotation(Transform, QuaternionFromRotation(Rotation));
 	}
 
 	void WObject::SetRotation(const float X, const float Y, const float Z) noexcept
@@ -69,8 +81,7 @@ namespace WoodenEngine
 
 	void WObject::SetScale(const XMFLOAT3& Scale) noexcept
 	{
-		this->Scale = Scale;
-		UpdateWorldTransform();
+		GetTransformStore().SetScale(Transform, Scale);
 	}
 
 	void WObject::SetScale(const float X, const float Y, const float Z) noexcept
@@ -83,14 +94,6 @@ namespace WoodenEngine
 		this->Color = Color;
 	}
 
-	void WObject::UpdateWorldTransform() noexcept
-	{
-		WorldTransform =
-			DirectX::XMMatrixScalingFromVector(XMLoadFloat3(&Scale))*
-			DirectX::XMMatrixRotationRollPitchYawFromVector(XMLoadFloat3(&Rotation))*
-			DirectX::XMMatrixTranslationFromVector(XMLoadFloat3(&Position));
-	}
-
 	void WObject::InputMouseMoved(const float dx, const float dy) noexcept
 	{
 	}
@@ -119,35 +122,29 @@ namespace WoodenEngine
 		RenderPrimitiveTology = PrimitiveTopology;
 	}
 
-	void WObject::SetMaterial(const FMaterialData* Material)
+	void WObject::SetMaterial(FMaterialHandle Material)
 	{
-		if (Material == nullptr)
+		if (!Material.IsValid())
 		{
-			throw std::invalid_argument("Material must be not nullptr");
+			throw std::invalid_argument("Material must be valid");
 		}
 
 		this->Material = Material;
 	}
 
-	void WObject::SetMesh(std::string MeshName, std::string SubmeshName) noexcept
+	void WObject::SetMesh(FSubmeshHandle SubmeshHandle)
 	{
-		if (MeshName.empty())
+		if (!SubmeshHandle.IsValid())
 		{
-			throw std::length_error("Mesh name must be not empty");
+			throw std::invalid_argument("SubmeshHandle must be valid");
 		}
 
-		if (SubmeshName.empty())
-		{
-			throw std::length_error("Submesh name must be not empty");
-		}
-
-		this->MeshName = MeshName;
-		this->SubmeshName = SubmeshName;
+		this->SubmeshHandle = SubmeshHandle;
 	}
 
 	void WObject::SetWorldTransform(const XMMATRIX& WorldTransform) noexcept
 	{
-		this->WorldTransform = WorldTransform;
+		GetTransformStore().SetWorldTransform(Transform, WorldTransform);
 	}
 
 	void WObject::SetIsUpdating(const bool IsUpdating) noexcept
@@ -191,27 +188,12 @@ namespace WoodenEngine
 		return NumDirtyConstBuffers;
 	}
 
-	const std::string& WObject::GetMeshName() const
+	FSubmeshHandle WObject::GetSubmeshHandle() const noexcept
 	{
-		if (MeshName.empty())
-		{
-			throw std::length_error("Mesh name is empty");
-		}
-
-		return MeshName;
+		return SubmeshHandle;
 	}
 
-	const std::string& WObject::GetSubmeshName() const
-	{
-		if (SubmeshName.empty())
-		{
-			throw std::length_error("Submesh name is empty");
-		}
-
-		return SubmeshName;
-	}
-
-	const FMaterialData* WObject::GetMaterial() const noexcept
+	FMaterialHandle WObject::GetMaterial() const noexcept
 	{
 		return Material;
 	}
@@ -221,19 +203,19 @@ namespace WoodenEngine
 		return TextureTransform;
 	}
 
-	const XMMATRIX& WObject::GetWorldTransform() const noexcept
+	XMMATRIX WObject::GetWorldTransform() const noexcept
 	{
-		return WorldTransform;
+		return GetTransformStore().GetWorldTransform(Transform);
 	}
 
 	XMFLOAT3 WObject::GetWorldPosition() const noexcept
 	{
-		return Position;
+		return GetTransformStore().GetPosition(Transform);
 	}
 
 	XMFLOAT3 WObject::GetWorldRotation() const noexcept
 	{
-		return Rotation;
+		return MathHelper::RollPitchYawFromQuaternion(GetTransformStore().GetRotation(Transform));
 	}
 
 	bool WObject::IsUpdating() const noexcept
@@ -276,5 +258,11 @@ namespace WoodenEngine
 		return bIsVisible;
 	}
 
+	FTransformStore& WObject::GetTransformStore() noexcept
+	{
+		static FTransformStore TransformStore;
+		return TransformStore;
+	}
+
 
 }
\ No newline at end of file
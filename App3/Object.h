@@ -3,13 +3,14 @@
 #include <string>
 
 #include "ShaderStructures.h"
+#include "MaterialData.h"
+#include "MeshData.h"
 #include "MathHelper.h"
 #include "EngineSettings.h"
+#include "TransformStore.h"
 
 namespace WoodenEngine
 {
-	struct FMaterialData;
-
 	/*!
 	 * \class BObject
 	 *
@@ -21,23 +22,21 @@ namespace WoodenEngine
 	class WObject
 	{
 		public:
-			WObject()=default;
-			virtual ~WObject()=default;
+			WObject();
+			virtual ~WObject();
 
 			WObject(WObject&& Obj) = delete;
 			WObject& operator=(const WObject& Obj) = delete;
 			
 			/** @brief 
-			  * @param MeshName Name of static mesh (const std::string &)
-			  * @param SubmeshName Name of submesh (const std::string &)
+			  * @param SubmeshHandle Submesh interned by FGameResource::GetSubmeshHandle (FSubmeshHandle)
 			  * @param Position Absolute world position (const XMFLOAT3 &)
 			  * @param Rotation Absolute world rotation (const XMFLOAT3 &)
 			  * @param Scale Absolute world scale (const XMFLOAT3 &)
 			  * @return ()
 			  */
 			WObject(
-				const std::string& MeshName, 
-				const std::string& SubmeshName,
+				FSubmeshHandle SubmeshHandle,
 				const XMFLOAT3& Position = { 0.0f, 0.0f, 0.0f },
 				const XMFLOAT3& Rotation = { 0.0f, 0.0f, 0.0f },
 				const XMFLOAT3& Scale = { 1.0f, 1.0f, 1.0f });
@@ -89,18 +88,17 @@ namespace WoodenEngine
 			void SetNumDirtyConstBuffers(const uint8 NumDirtyConstBuffers) noexcept;
 
 			/** @brief Sets current material
-			  * @param Material (FMaterialData *)
+			  * @param Material Handle of a material of FGameResource (FMaterialHandle)
 			  * @return (void)
 			  */
-			void SetMaterial(const FMaterialData* Material);
+			void SetMaterial(FMaterialHandle Material);
 
 
 			/** @brief Sets mesh
-			  * @param MeshName Mesh name (std::string)
-			  * @param SubmeshName Submesh name which is included in that mesh (std::string)
+			  * @param SubmeshHandle Submesh interned by FGameResource::GetSubmeshHandle (FSubmeshHandle)
 			  * @return (void)
 			  */
-			void SetMesh(std::string MeshName, std::string SubmeshName) noexcept;
+			void SetMesh(FSubmeshHandle SubmeshHandle);
 
 			/** @brief Sets world's transform
 			  * @warning Be careful, call it only if it's necessary
@@ -192,10 +190,10 @@ namespace WoodenEngine
 			  */
 			void SetIsVisible(const bool IsVisible) noexcept;
 
-			/** @brief Returns object's world matrix for rendering
+			/** @brief Returns object's world matrix for rendering. It's recomputed if the transform was changed
 			  * @return World matrix (DirectX::XMMATRIX)
 			  */
-			const XMMATRIX& GetWorldTransform() const noexcept;
+			XMMATRIX GetWorldTransform() const noexcept;
 
 			/** @brief Returns object's world absolute position
 			  * @return World absolution position (DirectX::XMFLOAT3)
@@ -217,16 +215,10 @@ namespace WoodenEngine
 			  */
 			uint8 GetNumDirtyConstBuffers() const noexcept;
 
-			/** @brief Returns name of static mesh data. If it's empty, method throws exception
-			  * @return Name of mesh data(const std::string&)
-			  */
-			const std::string& GetMeshName() const;
-
-			/** @brief Returns name of submesh data. 
-			  * If it's empty, method throws exception
-			  * @return Name of submesh data(const std::string&)
+			/** @brief Returns handle of the submesh. Names of the mesh and submesh are kept by FGameResource
+			  * @return (WoodenEngine::FSubmeshHandle)
 			  */
-			const std::string& GetSubmeshName() const;
+			FSubmeshHandle GetSubmeshHandle() const noexcept;
 
 
 			/** @brief Returns primitive topology type for rendering
@@ -234,10 +226,11 @@ namespace WoodenEngine
 			  */
 			D3D_PRIMITIVE_TOPOLOGY GetRenderPrimitiveTopology() const noexcept;
 
-			/** @brief Returns pointer to material data or nullptr 
-			  * @return (WoodenEngine::FMaterialData*)
+			/** @brief Returns handle of the material. It's invalid if the material isn't set
+			  * and stale if the material is removed
+			  * @return (WoodenEngine::FMaterialHandle)
 			  */
-			const FMaterialData* GetMaterial() const noexcept;
+			FMaterialHandle GetMaterial() const noexcept;
 
 			/** @brief Returns texture's coordinates transform matrix
 			  * @return texture's coordinates transform matrix (const DirectX::XMFLOAT4X4&)
@@ -278,6 +271,12 @@ namespace WoodenEngine
 			  * @return visibility (bool)
 			  */
 			bool IsVisible() const noexcept;
+
+			/** @brief Returns the store of transforms of all objects. World matrices are updated by
+			  * FTransformStore::UpdateWorldTransforms once per frame
+			  * @return (WoodenEngine::FTransformStore&)
+			  */
+			static FTransformStore& GetTransformStore() noexcept;
 		protected:
 			// Flags if objects is hidden/visible or not
 			bool bIsVisible = true;
@@ -291,21 +290,12 @@ namespace WoodenEngine
 			// Enabling tracking input events (such as mouse moving)
 			bool bIsEnabledInputEvents = false;
 		private:	
-			// Absolute matrix of transformation in the world. Used for rendering
-			XMMATRIX WorldTransform = DirectX::XMMatrixIdentity();
-			
-			// Vector with an absolute position in the world
-			XMFLOAT3 Position;
-
-			// Vector with an absolute rotation in the world
-			XMFLOAT3 Rotation;
+			// Absolute position, rotation, scale and world matrix in the transform store
+			FTransformHandle Transform;
 
 			// Default shader color parameter
 			XMFLOAT4 Color;
 
-			// Vector with an absolute scale in the world (default: 1.0f, 1.0f, 1.0f)
-			XMFLOAT3 Scale = MathHelper::Identity3();
-			
 			// Texture coordinates transform matrix
 			XMFLOAT4X4 TextureTransform = MathHelper::Identity4x4();
 
@@ -315,26 +305,18 @@ namespace WoodenEngine
 			// Life time in seconds
 			float LifeTime = 0;
 
-			// Mesh data name
-			std::string MeshName;
-	
-			// Submesh name
-			std::string SubmeshName;
+			// Drawn submesh
+			FSubmeshHandle SubmeshHandle;
 
 			// Index of object in const buffer
 			uint64 iConstBuffer = UINT64_MAX;
 
 			// Current material
-			const FMaterialData* Material = nullptr;
+			FMaterialHandle Material;
 
 			// Number not updated const buffers
 			uint8 NumDirtyConstBuffers = NMR_SWAP_BUFFERS;
 
 			int WaterFactor = 0;
-
-			/** @brief Recomputes the world matrix considering Position, Rotation and Scale in the world
-			  * @return (void)
-			  */
-			void UpdateWorldTransform() noexcept;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,404 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "RangeAllocator.h"
+
+namespace WoodenEngine
+{
+	namespace
+	{
+		// Mask must be not zero
+		uint32 FindLowestSetBit(uint32 Mask) noexcept
+		{
+#if defined(_MSC_VER)
+			unsigned long iBit;
+			_BitScanForward(&iBit, Mask);
+			return iBit;
+#else
+			return static_cast<uint32>(__builtin_ctz(Mask));
+#endif
+		}
+
+		// Mask must be not zero
+		uint32 FindHighestSetBit(uint32 Mask) noexcept
+		{
+#if defined(_MSC_VER)
+			unsigned long iBit;
+			_BitScanReverse(&iBit, Mask);
+			return iBit;
+#else
+			return 31 - static_cast<uint32>(__builtin_clz(Mask));
+#endif
+		}
+	}
+
+	FRangeAllocator::FRangeAllocator(uint32 Size):
+		FreeLists(NumFirstLevels*NumSecondLevels, FRangeAllocation::InvalidBlock),
+		SecondLevelBitmaps(NumFirstLevels, 0),
+		Size(Size)
+	{
+		if (Size == 0)
+		{
+			throw std::invalid_argument("Size must be positive");
+		}
+
+		iFirstBlock = CreateBlock();
+		Blocks[iFirstBlock].Size = Size;
+		Blocks[iFirstBlock].bFree = true;
+		InsertFreeBlock(iFirstBlock);
+	}
+
+	FRangeAllocation FRangeAllocator::Allocate(uint32 Size)
+	{
+		if (Size == 0)
+		{
+			throw std::invalid_argument("Size must be positive");
+		}
+
+		FRangeAllocation Allocation;
+
+		// Every block of the found list is at least SearchSize
+		auto SearchSize = Size;
+		if (Size >= NumSecondLevels)
+		{
+			const auto Rounding = (1u << (FindHighestSetBit(Size) - SecondLevelBits)) - 1;
+			SearchSize = Size > UINT32_MAX - Rounding ? UINT32_MAX : Size + Rounding;
+		}
+
+		auto iBlock = FRangeAllocation::InvalidBlock;
+		uint32 FirstLevel;
+		uint32 SecondLevel;
+		MapSize(SearchSize, FirstLevel, SecondLevel);
+		if (FindFreeList(FirstLevel, SecondLevel))
+		{
+			iBlock = FreeLists[FirstLevel*NumSecondLevels + SecondLevel];
+		}
+
+		// Rounding of the largest sizes is clamped, so the found block is checked
+		if (iBlock == FRangeAllocation::InvalidBlock || Blocks[iBlock].Size < Size)
+		{
+			// Blocks of the size's own class may fit it too (like the whole free resource)
+			MapSize(Size, FirstLevel, SecondLevel);
+			iBlock = FreeLists[FirstLevel*NumSecondLevels + SecondLevel];
+			while (iBlock != FRangeAllocation::InvalidBlock && Blocks[iBlock].Size < Size)
+			{
+				iBlock = Blocks[iBlock].iNextFree;
+			}
+
+			if (iBlock == FRangeAllocation::InvalidBlock)
+			{
+				return Allocation;
+			}
+		}
+
+		RemoveFreeBlock(iBlock);
+
+		// The rest of the block stays free
+		if (Blocks[iBlock].Size > Size)
+		{
+			const auto iRestBlock = CreateBlock();
+			auto& Block = Blocks[iBlock];
+			auto& RestBlock = Blocks[iRestBlock];
+			RestBlock.Offset = Block.Offset + Size;
+			RestBlock.Size = Block.Size - Size;
+			RestBlock.bFree = true;
+			RestBlock.iPrevPhysical = iBlock;
+			RestBlock.iNextPhysical = Block.iNextPhysical;
+			if (Block.iNextPhysical != FRangeAllocation::InvalidBlock)
+			{
+				Blocks[Block.iNextPhysical].iPrevPhysical = iRestBlock;
+			}
+			Block.iNextPhysical = iRestBlock;
+			Block.Size = Size;
+
+			InsertFreeBlock(iRestBlock);
+		}
+
+		Blocks[iBlock].bFree = false;
+		UsedSize += Size;
+		++NumAllocations;
+
+		Allocation.Offset = Blocks[iBlock].Offset;
+		Allocation.Size = Size;
+		Allocation.iBlock = iBlock;
+		return Allocation;
+	}
+
+	void FRangeAllocator::Free(const FRangeAllocation& Allocation)
+	{
+		auto iBlock = Allocation.iBlock;
+		if (iBlock >= Blocks.size() || Blocks[iBlock].bFree || Blocks[iBlock].bUnused ||
+			Blocks[iBlock].Size != Allocation.Size)
+		{
+			throw std::invalid_argument("Allocation isn't allocated by the allocator");
+		}
+
+		UsedSize -= Allocation.Size;
+		--NumAllocations;
+		Blocks[iBlock].bFree = true;
+
+		const auto iPrevBlock = Blocks[iBlock].iPrevPhysical;
+		if (iPrevBlock != FRangeAllocation::InvalidBlock && Blocks[iPrevBlock].bFree)
+		{
+			RemoveFreeBlock(iPrevBlock);
+
+			auto& PrevBlock = Blocks[iPrevBlock];
+			PrevBlock.Size += Blocks[iBlock].Size;
+			PrevBlock.iNextPhysical = Blocks[iBlock].iNextPhysical;
+			if (PrevBlock.iNextPhysical != FRangeAllocation::InvalidBlock)
+			{
+				Blocks[PrevBlock.iNextPhysical].iPrevPhysical = iPrevBlock;
+			}
+
+			ReleaseBlock(iBlock);
+			iBlock = iPrevBlock;
+		}
+
+		const auto iNextBlock = Blocks[iBlock].iNextPhysical;
+		if (iNextBlock != FRangeAllocation::InvalidBlock && Blocks[iNextBlock].bFree)
+		{
+			RemoveFreeBlock(iNextBlock);
+
+			auto& Block = Blocks[iBlock];
+			Block.Size += Blocks[iNextBlock].Size;
+			Block.iNextPhysical = Blocks[iNextBlock].iNextPhysical;
+			if (Block.iNextPhysical != FRangeAllocation::InvalidBlock)
+			{
+				Blocks[Block.iNextPhysical].iPrevPhysical = iBlock;
+			}
+
+			ReleaseBlock(iNextBlock);
+		}
+
+		InsertFreeBlock(iBlock);
+	}
+
+	std::vector<FRangeMove> FRangeAllocator::Compact()
+	{
+		std::vector<FRangeMove> Moves;
+
+		// Allocated blocks in order of offsets. Free blocks are dropped
+		std::vector<uint32> AllocatedBlocks;
+		AllocatedBlocks.reserve(NumAllocations);
+		for (auto iBlock = iFirstBlock; iBlock != FRangeAllocation::InvalidBlock; )
+		{
+			const auto iNextBlock = Blocks[iBlock].iNextPhysical;
+			if (Blocks[iBlock].bFree)
+			{
+				RemoveFreeBlock(iBlock);
+				ReleaseBlock(iBlock);
+			}
+			else
+			{
+				AllocatedBlocks.push_back(iBlock);
+			}
+			iBlock = iNextBlock;
+		}
+
+		uint32 Offset = 0;
+		auto iPrevBlock = FRangeAllocation::InvalidBlock;
+		for (const auto iBlock : AllocatedBlocks)
+		{
+			auto& Block = Blocks[iBlock];
+			if (Block.Offset != Offset)
+			{
+				FRangeMove Move;
+				Move.iBlock = iBlock;
+				Move.SourceOffset = Block.Offset;
+				Move.DestinationOffset = Offset;
+				Move.Size = Block.Size;
+				Moves.push_back(Move);
+
+				Block.Offset = Offset;
+			}
+
+			Block.iPrevPhysical = iPrevBlock;
+			if (iPrevBlock != FRangeAllocation::InvalidBlock)
+			{
+				Blocks[iPrevBlock].iNextPhysical = iBlock;
+			}
+
+			Offset += Block.Size;
+			iPrevBlock = iBlock;
+		}
+
+		// The free space is one block at the end
+		if (Offset < Size)
+		{
+			const auto iFreeBlock = CreateBlock();
+			auto& FreeBlock = Blocks[iFreeBlock];
+			FreeBlock.Offset = Offset;
+			FreeBlock.Size = Size - Offset;
+			FreeBlock.bFree = true;
+			FreeBlock.iPrevPhysical = iPrevBlock;
+			if (iPrevBlock != FRangeAllocation::InvalidBlock)
+			{
+				Blocks[iPrevBlock].iNextPhysical = iFreeBlock;
+			}
+
+			InsertFreeBlock(iFreeBlock);
+			iPrevBlock = iFreeBlock;
+		}
+		Blocks[iPrevBlock].iNextPhysical = FRangeAllocation::InvalidBlock;
+
+		iFirstBlock = AllocatedBlocks.empty() ? iPrevBlock : AllocatedBlocks.front();
+
+		return Moves;
+	}
+
+	uint32 FRangeAllocator::GetOffset(const FRangeAllocation& Allocation) const
+	{
+		const auto iBlock = Allocation.iBlock;
+		if (iBlock >= Blocks.size() || Blocks[iBlock].bFree || Blocks[iBlock].bUnused)
+		{
+			throw std::invalid_argument("Allocation isn't allocated by the allocator");
+		}
+
+		return Blocks[iBlock].Offset;
+	}
+
+	FRangeAllocatorStats FRangeAllocator::GetStats() const
+	{
+		FRangeAllocatorStats Stats;
+		Stats.Size = Size;
+		Stats.UsedSize = UsedSize;
+		Stats.NumAllocations = NumAllocations;
+
+		for (auto iBlock = iFirstBlock; iBlock != FRangeAllocation::InvalidBlock; iBlock = Blocks[iBlock].iNextPhysical)
+		{
+			const auto& Block = Blocks[iBlock];
+			if (Block.bFree)
+			{
+				++Stats.NumFreeRanges;
+				Stats.LargestFreeRange = std::max(Stats.LargestFreeRange, Block.Size);
+			}
+		}
+
+		return Stats;
+	}
+
+	uint32 FRangeAllocator::GetSize() const noexcept
+	{
+		return Size;
+	}
+
+	uint32 FRangeAllocator::GetUsedSize() const noexcept
+	{
+		return UsedSize;
+	}
+
+	uint32 FRangeAllocator::GetNumAllocations() const noexcept
+	{
+		return NumAllocations;
+	}
+
+	bool FRangeAllocator::IsEmpty() const noexcept
+	{
+		return NumAllocations == 0;
+	}
+
+	void FRangeAllocator::MapSize(uint32 Size, uint32& FirstLevel, uint32& SecondLevel) noexcept
+	{
+		// Small sizes are classified linearly
+		if (Size < NumSecondLevels)
+		{
+			FirstLevel = 0;
+			SecondLevel = Size;
+			return;
+		}
+
+		const auto iHighestBit = FindHighestSetBit(Size);
+		FirstLevel = iHighestBit - SecondLevelBits + 1;
+		SecondLevel = (Size >> (iHighestBit - SecondLevelBits)) ^ NumSecondLevels;
+	}
+
+	bool FRangeAllocator::FindFreeList(uint32& FirstLevel, uint32& SecondLevel) const noexcept
+	{
+		auto SecondLevelMask = SecondLevelBitmaps[FirstLevel] & (~0u << SecondLevel);
+		if (SecondLevelMask == 0)
+		{
+			const auto FirstLevelMask = FirstLevelBitmap & (~0u << (FirstLevel + 1));
+			if (FirstLevelMask == 0)
+			{
+				return false;
+			}
+
+			FirstLevel = FindLowestSetBit(FirstLevelMask);
+			SecondLevelMask = SecondLevelBitmaps[FirstLevel];
+		}
+
+		SecondLevel = FindLowestSetBit(SecondLevelMask);
+		return true;
+	}
+
+	void FRangeAllocator::InsertFreeBlock(uint32 iBlock) noexcept
+	{
+		uint32 FirstLevel;
+		uint32 SecondLevel;
+		MapSize(Blocks[iBlock].Size, FirstLevel, SecondLevel);
+
+		auto& iListBlock = FreeLists[FirstLevel*NumSecondLevels + SecondLevel];
+		Blocks[iBlock].iPrevFree = FRangeAllocation::InvalidBlock;
+		Blocks[iBlock].iNextFree = iListBlock;
+		if (iListBlock != FRangeAllocation::InvalidBlock)
+		{
+			Blocks[iListBlock].iPrevFree = iBlock;
+		}
+		iListBlock = iBlock;
+
+		FirstLevelBitmap |= 1u << FirstLevel;
+		SecondLevelBitmaps[FirstLevel] |= 1u << SecondLevel;
+	}
+
+	void FRangeAllocator::RemoveFreeBlock(uint32 iBlock) noexcept
+	{
+		uint32 FirstLevel;
+		uint32 SecondLevel;
+		MapSize(Blocks[iBlock].Size, FirstLevel, SecondLevel);
+
+		const auto& Block = Blocks[iBlock];
+		if (Block.iPrevFree != FRangeAllocation::InvalidBlock)
+		{
+			Blocks[Block.iPrevFree].iNextFree = Block.iNextFree;
+		}
+		else
+		{
+			FreeLists[FirstLevel*NumSecondLevels + SecondLevel] = Block.iNextFree;
+		}
+
+		if (Block.iNextFree != FRangeAllocation::InvalidBlock)
+		{
+			Blocks[Block.iNextFree].iPrevFree = Block.iPrevFree;
+		}
+
+		if (FreeLists[FirstLevel*NumSecondLevels + SecondLevel] == FRangeAllocation::InvalidBlock)
+		{
+			SecondLevelBitmaps[FirstLevel] &= ~(1u << SecondLevel);
+			if (SecondLevelBitmaps[FirstLevel] == 0)
+			{
+				FirstLevelBitmap &= ~(1u << FirstLevel);
+			}
+		}
+	}
+
+	uint32 FRangeAllocator::CreateBlock()
+	{
+		if (!UnusedBlocks.empty())
+		{
+			const auto iBlock = UnusedBlocks.back();
+			UnusedBlocks.pop_back();
+			Blocks[iBlock] = FBlock();
+			return iBlock;
+		}
+
+		Blocks.emplace_back();
+		return static_cast<uint32>(Blocks.size() - 1);
+	}
+
+	void FRangeAllocator::ReleaseBlock(uint32 iBlock)
+	{
+		Blocks[iBlock].bFree = false;
+		Blocks[iBlock].bUnused = true;
+		UnusedBlocks.push_back(iBlock);
+	}
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <vector>
+
+#include "pch.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FRangeAllocation
+	 *
+	 * \brief Range allocated by FRangeAllocator. Its offset is changed by FRangeAllocator::Compact only
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FRangeAllocation
+	{
+		static constexpr uint32 InvalidBlock = UINT32_MAX;
+
+		uint32 Offset = 0;
+		uint32 Size = 0;
+
+		// Block of the allocator which keeps the range
+		uint32 iBlock = InvalidBlock;
+
+		bool IsValid() const noexcept
+		{
+			return iBlock != InvalidBlock;
+		}
+	};
+
+	/*!
+	 * \struct FRangeMove
+	 *
+	 * \brief Move of an allocated range planned by FRangeAllocator::Compact
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FRangeMove
+	{
+		uint32 iBlock = FRangeAllocation::InvalidBlock;
+
+		uint32 SourceOffset = 0;
+		uint32 DestinationOffset = 0;
+		uint32 Size = 0;
+	};
+
+	/*!
+	 * \struct FRangeAllocatorStats
+	 *
+	 * \brief Occupancy of FRangeAllocator
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FRangeAllocatorStats
+	{
+		uint32 Size = 0;
+		uint32 UsedSize = 0;
+
+		uint32 NumAllocations = 0;
+		uint32 NumFreeRanges = 0;
+
+		uint32 LargestFreeRange = 0;
+
+		/** @brief Part of free space which isn't in the largest free range
+		  * @return From 0 (one free range) to 1 (float)
+		  */
+		float GetFragmentation() const noexcept
+		{
+			const auto FreeSize = Size - UsedSize;
+			return FreeSize > 0 ? 1.0f - static_cast<float>(LargestFreeRange) / FreeSize : 0.0f;
+		}
+	};
+
+	/*!
+	 * \class FRangeAllocator
+	 *
+	 * \brief Two-level segregated fit (TLSF) allocator of ranges of units (bytes, vertices, indices etc)
+	 * of an external resource. Allocation and freeing are O(1): free ranges are kept in lists by size classes,
+	 * which are found by bitmaps. Freed ranges are merged with free neighbours at once.
+	 * It doesn't touch the resource, so it's used without a device
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FRangeAllocator
+	{
+	public:
+		/** @brief
+		  * @param Size Number of units of the resource (uint32)
+		  */
+		explicit FRangeAllocator(uint32 Size);
+		~FRangeAllocator() = default;
+
+		FRangeAllocator& operator=(const FRangeAllocator& RangeAllocator) = delete;
+		FRangeAllocator(const FRangeAllocator& RangeAllocator) = delete;
+		FRangeAllocator(FRangeAllocator&& RangeAllocator) = default;
+
+		/** @brief Allocates a range. Sizes are rounded up to their size class's lower bound for the search,
+		  * so a free range of the class always fits
+		  * @param Size Positive number of units (uint32)
+		  * @return Invalid allocation if there's no free range large enough (WoodenEngine::FRangeAllocation)
+		  */
+		FRangeAllocation Allocate(uint32 Size);
+
+		/** @brief Frees the range and merges it with free neighbours.
+		  * Throws invalid_argument if the allocation isn't allocated by this allocator
+		  * @param Allocation (const FRangeAllocation &)
+		  * @return (void)
+		  */
+		void Free(const FRangeAllocation& Allocation);
+
+		/** @brief Moves all allocated ranges to the start of the resource keeping their order,
+		  * so the free space is one range at the end. Allocations keep their blocks
+		  * @return Moves which must be applied to the resource's content.
+		  * Ranges are moved to lower offsets and may overlap their sources (std::vector<FRangeMove>)
+		  */
+		std::vector<FRangeMove> Compact();
+
+		/** @brief Returns the current offset of the allocation's block
+		  * @param Allocation (const FRangeAllocation &)
+		  * @return (uint32)
+		  */
+		uint32 GetOffset(const FRangeAllocation& Allocation) const;
+
+		/** @brief Collects statistics by walking all blocks
+		  * @return (WoodenEngine::FRangeAllocatorStats)
+		  */
+		FRangeAllocatorStats GetStats() const;
+
+		uint32 GetSize() const noexcept;
+
+		uint32 GetUsedSize() const noexcept;
+
+		uint32 GetNumAllocations() const noexcept;
+
+		bool IsEmpty() const noexcept;
+
+	private:
+		// Subdivisions of every power of two size class are 2^SecondLevelBits
+		static constexpr uint32 SecondLevelBits = 4;
+		static constexpr uint32 NumSecondLevels = 1 << SecondLevelBits;
+		static constexpr uint32 NumFirstLevels = 32 - SecondLevelBits + 1;
+
+		struct FBlock
+		{
+			uint32 Offset = 0;
+			uint32 Size = 0;
+
+			// Neighbours in the resource
+			uint32 iPrevPhysical = FRangeAllocation::InvalidBlock;
+			uint32 iNextPhysical = FRangeAllocation::InvalidBlock;
+
+			// Neighbours in the free list of the block's size class
+			uint32 iPrevFree = FRangeAllocation::InvalidBlock;
+			uint32 iNextFree = FRangeAllocation::InvalidBlock;
+
+			bool bFree = false;
+
+			// Block is in UnusedBlocks
+			bool bUnused = false;
+		};
+
+		/** @brief Computes the size class of a free block
+		  * @param Size (uint32)
+		  * @param FirstLevel (uint32 &)
+		  * @param SecondLevel (uint32 &)
+		  * @return (void)
+		  */
+		static void MapSize(uint32 Size, uint32& FirstLevel, uint32& SecondLevel) noexcept;
+
+		/** @brief Finds a non-empty free list of the size class or a larger one
+		  * @param FirstLevel (uint32 &)
+		  * @param SecondLevel (uint32 &)
+		  * @return False if there's no such list (bool)
+		  */
+		bool FindFreeList(uint32& FirstLevel, uint32& SecondLevel) const noexcept;
+
+		void InsertFreeBlock(uint32 iBlock) noexcept;
+
+		void RemoveFreeBlock(uint32 iBlock) noexcept;
+
+		/** @brief Returns an unused block or adds a new one
+		  * @return (uint32)
+		  */
+		uint32 CreateBlock();
+
+		void ReleaseBlock(uint32 iBlock);
+
+		std::vector<FBlock> Blocks;
+
+		// Blocks which can be reused by CreateBlock
+		std::vector<uint32> UnusedBlocks;
+
+		// First block of every free list
+		std::vector<uint32> FreeLists;
+
+		// Bit per first level which has a non-empty free list
+		uint32 FirstLevelBitmap = 0;
+
+		// Bits per non-empty free list of every first level
+		std::vector<uint32> SecondLevelBitmaps;
+
+		// Block at offset 0
+		uint32 iFirstBlock = FRangeAllocation::InvalidBlock;
+
+		uint32 Size = 0;
+		uint32 UsedSize = 0;
+		uint32 NumAllocations = 0;
+	};
+}
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <limits>
+
+#include "RectPacker.h"
+
+namespace WoodenEngine
+{
+	FMaxRectsPacker::FMaxRectsPacker(uint32 Width, uint32 Height):
+		Width(Width),
+		Height(Height)
+	{
+		FPackedRect BinRect;
+		BinRect.Width = Width;
+		BinRect.Height = Height;
+		FreeRects.push_back(BinRect);
+	}
+
+	bool FMaxRectsPacker::Insert(uint32 Width, uint32 Height, FPackedRect& Rect)
+	{
+		if (Width == 0 || Height == 0)
+		{
+			return false;
+		}
+
+		// Best short side fit. Ties are broken by the long side
+		auto BestShortSide = std::numeric_limits<uint32>::max();
+		auto BestLongSide = std::numeric_limits<uint32>::max();
+		const FPackedRect* BestFreeRect = nullptr;
+		for (const auto& FreeRect : FreeRects)
+		{
+			if (FreeRect.Width < Width || FreeRect.Height < Height)
+			{
+				continue;
+			}
+
+			const auto LeftoverX = FreeRect.Width - Width;
+			const auto LeftoverY = FreeRect.Height - Height;
+			const auto ShortSide = std::min(LeftoverX, LeftoverY);
+			const auto LongSide = std::max(LeftoverX, LeftoverY);
+
+			if (ShortSide < BestShortSide || (ShortSide == BestShortSide && LongSide < BestLongSide))
+			{
+				BestShortSide = ShortSide;
+				BestLongSide = LongSide;
+				BestFreeRect = &FreeRect;
+			}
+		}
+
+		if (BestFreeRect == nullptr)
+		{
+			return false;
+		}
+
+		Rect.X = BestFreeRect->X;
+		Rect.Y = BestFreeRect->Y;
+		Rect.Width = Width;
+		Rect.Height = Height;
+
+		SplitFreeRects(Rect);
+		PruneFreeRects();
+
+		UsedArea += static_cast<uint64>(Width)*Height;
+
+		return true;
+	}
+
+	float FMaxRectsPacker::GetOccupancy() const noexcept
+	{
+		return static_cast<float>(static_cast<double>(UsedArea) / (static_cast<double>(Width)*Height));
+	}
+
+	void FMaxRectsPacker::SplitFreeRects(const FPackedRect& UsedRect)
+	{
+		std::vector<FPackedRect> SplitRects;
+		for (auto FreeRectIter = FreeRects.begin(); FreeRectIter != FreeRects.end(); )
+		{
+			const auto FreeRect = *FreeRectIter;
+			if (UsedRect.X >= FreeRect.X + FreeRect.Width || UsedRect.X + UsedRect.Width <= FreeRect.X ||
+				UsedRect.Y >= FreeRect.Y + FreeRect.Height || UsedRect.Y + UsedRect.Height <= FreeRect.Y)
+			{
+				++FreeRectIter;
+				continue;
+			}
+
+			// Up to four maximal rectangles around the used one
+			if (UsedRect.X > FreeRect.X)
+			{
+				auto LeftRect = FreeRect;
+				LeftRect.Width = UsedRect.X - FreeRect.X;
+				SplitRects.push_back(LeftRect);
+			}
+
+			if (UsedRect.X + UsedRect.Width < FreeRect.X + FreeRect.Width)
+			{
+				auto RightRect = FreeRect;
+				RightRect.X = UsedRect.X + UsedRect.Width;
+				RightRect.Width = FreeRect.X + FreeRect.Width - RightRect.X;
+				SplitRects.push_back(RightRect);
+			}
+
+			if (UsedRect.Y > FreeRect.Y)
+			{
+				auto BottomRect = FreeRect;
+				BottomRect.Height = UsedRect.Y - FreeRect.Y;
+				SplitRects.push_back(BottomRect);
+			}
+
+			if (UsedRect.Y + UsedRect.Height < FreeRect.Y + FreeRect.Height)
+			{
+				auto TopRect = FreeRect;
+				TopRect.Y = UsedRect.Y + UsedRect.Height;
+				TopRect.Height = FreeRect.Y + FreeRect.Height - TopRect.Y;
+				SplitRects.push_back(TopRect);
+			}
+
+			FreeRectIter = FreeRects.erase(FreeRectIter);
+		}
+
+		FreeRects.insert(FreeRects.end(), SplitRects.begin(), SplitRects.end());
+	}
+
+	void FMaxRectsPacker::PruneFreeRects()
+	{
+		const auto Contains = [](const FPackedRect& A, const FPackedRect& B)
+		{
+			return B.X >= A.X && B.Y >= A.Y &&
+				B.X + B.Width <= A.X + A.Width && B.Y + B.Height <= A.Y + A.Height;
+		};
+
+		// Rectangles which are removed don't contain others, so of equal rectangles the last one is kept
+		std::vector<bool> bIsContained(FreeRects.size(), false);
+		for (size_t iFreeRect = 0; iFreeRect < FreeRects.size(); ++iFreeRect)
+		{
+			for (size_t iOtherRect = 0; iOtherRect < FreeRects.size(); ++iOtherRect)
+			{
+				if (iOtherRect != iFreeRect && !bIsContained[iOtherRect] &&
+					Contains(FreeRects[iOtherRect], FreeRects[iFreeRect]))
+				{
+					bIsContained[iFreeRect] = true;
+					break;
+				}
+			}
+		}
+
+		size_t NumKeptRects = 0;
+		for (size_t iFreeRect = 0; iFreeRect < FreeRects.size(); ++iFreeRect)
+		{
+			if (!bIsContained[iFreeRect])
+			{
+				FreeRects[NumKeptRects++] = FreeRects[iFreeRect];
+			}
+		}
+
+		FreeRects.erase(FreeRects.begin() + NumKeptRects, FreeRects.end());
+	}
+}
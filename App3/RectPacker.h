@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+
+#include "pch.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FPackedRect
+	 *
+	 * \brief Rectangle in a bin of FMaxRectsPacker
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FPackedRect
+	{
+		uint32 X = 0;
+		uint32 Y = 0;
+		uint32 Width = 0;
+		uint32 Height = 0;
+	};
+
+	/*!
+	 * \class FMaxRectsPacker
+	 *
+	 * \brief MaxRects bin packer. Keeps all maximal free rectangles of the bin
+	 * and puts every rectangle to the free one which leaves the shortest side (best short side fit).
+	 * Rectangles aren't rotated, because textures can't be
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FMaxRectsPacker
+	{
+	public:
+		/** @brief Empty bin
+		  * @param Width (uint32)
+		  * @param Height (uint32)
+		  */
+		FMaxRectsPacker(uint32 Width, uint32 Height);
+		~FMaxRectsPacker() = default;
+
+		FMaxRectsPacker& operator=(const FMaxRectsPacker& MaxRectsPacker) = delete;
+		FMaxRectsPacker(const FMaxRectsPacker& MaxRectsPacker) = delete;
+		FMaxRectsPacker(FMaxRectsPacker&& MaxRectsPacker) = delete;
+
+		/** @brief Places the rectangle to the bin
+		  * @param Width (uint32)
+		  * @param Height (uint32)
+		  * @param Rect Placed rectangle (FPackedRect &)
+		  * @return False if the rectangle doesn't fit (bool)
+		  */
+		bool Insert(uint32 Width, uint32 Height, FPackedRect& Rect);
+
+		/** @brief Returns ratio of used area to area of the bin
+		  * @return (float)
+		  */
+		float GetOccupancy() const noexcept;
+
+	private:
+		/** @brief Splits free rectangles which intersect the used one
+		  * @param UsedRect (const FPackedRect &)
+		  * @return (void)
+		  */
+		void SplitFreeRects(const FPackedRect& UsedRect);
+
+		/** @brief Removes free rectangles which are contained by other ones
+		  * @return (void)
+		  */
+		void PruneFreeRects();
+
+		uint32 Width;
+		uint32 Height;
+
+		uint64 UsedArea = 0;
+
+		std::vector<FPackedRect> FreeRects;
+	};
+}
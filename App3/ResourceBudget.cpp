@@ -0,0 +1,313 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "ResourceBudget.h"
+
+namespace WoodenEngine
+{
+	FResourceBudget::FResourceBudget(const FResourceBudgetSettings& Settings):
+		Settings(Settings)
+	{
+		Stats.BudgetBytes = Settings.BudgetBytes;
+	}
+
+	void FResourceBudget::BeginLoad(EResourceType Type, const std::string& Name, bool bReloadable)
+	{
+		auto& Resource = FindOrAddResource(Type, Name);
+		Resource.bReloadable = bReloadable;
+
+		switch (Resource.State)
+		{
+		case EResourceState::Loading:
+			return;
+		case EResourceState::Resident:
+			Resource.bWasResident = true;
+			break;
+		default:
+			// Loads in flight are accounted with the last known footprint
+			Resource.bWasResident = false;
+			AccountFootprint(Resource.Footprint, true);
+			break;
+		}
+
+		Resource.State = EResourceState::Loading;
+	}
+
+	void FResourceBudget::CompleteLoad(
+		EResourceType Type,
+		const std::string& Name,
+		bool bSucceeded,
+		const FResourceFootprint& Footprint)
+	{
+		auto Resource = FindResource(Type, Name);
+		if (Resource == nullptr || Resource->State != EResourceState::Loading)
+		{
+			throw std::invalid_argument("Resource " + Name + " isn't being loaded");
+		}
+
+		Resource->LastUsedFrame = std::max(Resource->LastUsedFrame, CurrentFrame);
+
+		if (!bSucceeded && Resource->bWasResident)
+		{
+			Resource->State = EResourceState::Resident;
+			return;
+		}
+
+		AccountFootprint(Resource->Footprint, false);
+
+		if (!bSucceeded)
+		{
+			// It'd fail again, so it isn't reloaded
+			Resource->State = EResourceState::Unloaded;
+			Resource->bReloadable = false;
+			return;
+		}
+
+		Resource->Footprint = Footprint;
+		Resource->State = EResourceState::Resident;
+		AccountFootprint(Resource->Footprint, true);
+	}
+
+	void FResourceBudget::AddResource(
+		EResourceType Type,
+		const std::string& Name,
+		const FResourceFootprint& Footprint,
+		bool bReloadable)
+	{
+		BeginLoad(Type, Name, bReloadable);
+		CompleteLoad(Type, Name, true, Footprint);
+	}
+
+	void FResourceBudget::RemoveResource(EResourceType Type, const std::string& Name)
+	{
+		auto& TypeResources = Resources[static_cast<uint8>(Type)];
+
+		auto ResourceIter = TypeResources.find(Name);
+		if (ResourceIter == TypeResources.end())
+		{
+			return;
+		}
+
+		auto& Resource = ResourceIter->second;
+		if (Resource.State == EResourceState::Resident || Resource.State == EResourceState::Loading)
+		{
+			AccountFootprint(Resource.Footprint, false);
+		}
+
+		if (Resource.NumReferences == 0)
+		{
+			TypeResources.erase(ResourceIter);
+			return;
+		}
+
+		Resource.Footprint = FResourceFootprint();
+		Resource.State = EResourceState::Unloaded;
+		Resource.bReloadable = false;
+	}
+
+	bool FResourceBudget::HasResource(EResourceType Type, const std::string& Name) const
+	{
+		return FindResource(Type, Name) != nullptr;
+	}
+
+	uint32 FResourceBudget::AddReference(EResourceType Type, const std::string& Name)
+	{
+		auto& Resource = FindOrAddResource(Type, Name);
+		return ++Resource.NumReferences;
+	}
+
+	uint32 FResourceBudget::ReleaseReference(EResourceType Type, const std::string& Name)
+	{
+		auto Resource = FindResource(Type, Name);
+		if (Resource == nullptr || Resource->NumReferences == 0)
+		{
+			throw std::invalid_argument("Resource " + Name + " isn't referenced");
+		}
+
+		// Released resources stay warm for NumUnusedFramesToEvict frames
+		Resource->LastUsedFrame = std::max(Resource->LastUsedFrame, CurrentFrame);
+
+		return --Resource->NumReferences;
+	}
+
+	uint32 FResourceBudget::GetNumReferences(EResourceType Type, const std::string& Name) const
+	{
+		auto Resource = FindResource(Type, Name);
+		return (Resource != nullptr) ? Resource->NumReferences : 0;
+	}
+
+	void FResourceBudget::MarkUsed(EResourceType Type, const std::string& Name, uint64 Frame)
+	{
+		auto Resource = FindResource(Type, Name);
+		if (Resource != nullptr)
+		{
+			Resource->LastUsedFrame = std::max(Resource->LastUsedFrame, Frame);
+		}
+	}
+
+	std::vector<FResourceRequest> FResourceBudget::Update(uint64 Frame)
+	{
+		CurrentFrame = std::max(CurrentFrame, Frame);
+
+		std::vector<FResourceRequest> Evictions;
+		std::vector<FResourceRequest> Reloads;
+		std::vector<FResource*> Candidates;
+
+		for (auto& TypeResources : Resources)
+		{
+			for (auto& ResourcePair : TypeResources)
+			{
+				auto& Resource = ResourcePair.second;
+				if (!Resource.bReloadable)
+				{
+					continue;
+				}
+
+				const bool bWanted = Resource.NumReferences > 0 || Resource.LastUsedFrame >= CurrentFrame;
+				if (Resource.State == EResourceState::Evicted && bWanted)
+				{
+					// Reloads are accounted before evictions, so they make room for them
+					Resource.State = EResourceState::Loading;
+					Resource.bWasResident = false;
+					AccountFootprint(Resource.Footprint, true);
+
+					Reloads.push_back({ Resource.Type, Resource.Name, false });
+					++Stats.NumReloaded;
+				}
+				else if (Resource.State == EResourceState::Resident && Resource.NumReferences == 0 &&
+					Resource.LastUsedFrame + Settings.NumUnusedFramesToEvict <= CurrentFrame)
+				{
+					Candidates.push_back(&Resource);
+				}
+			}
+		}
+
+		if (Stats.ResidentFootprint.GetTotalBytes() > Settings.BudgetBytes)
+		{
+			// Names keep the order stable between runs, since maps are unordered
+			std::sort(Candidates.begin(), Candidates.end(), [](const FResource* A, const FResource* B)
+			{
+				if (A->LastUsedFrame != B->LastUsedFrame)
+				{
+					return A->LastUsedFrame < B->LastUsedFrame;
+				}
+
+				if (A->Type != B->Type)
+				{
+					return A->Type < B->Type;
+				}
+
+				return A->Name < B->Name;
+			});
+
+			for (auto Resource : Candidates)
+			{
+				if (Stats.ResidentFootprint.GetTotalBytes() <= Settings.BudgetBytes)
+				{
+					break;
+				}
+
+				AccountFootprint(Resource->Footprint, false);
+				Resource->State = EResourceState::Evicted;
+
+				Evictions.push_back({ Resource->Type, Resource->Name, true });
+				++Stats.NumEvicted;
+			}
+		}
+
+		// Memory of evicted resources is freed before reloads allocate theirs
+		Evictions.insert(Evictions.end(), Reloads.begin(), Reloads.end());
+		return Evictions;
+	}
+
+	bool FResourceBudget::IsResident(EResourceType Type, const std::string& Name) const
+	{
+		auto Resource = FindResource(Type, Name);
+		return Resource != nullptr && Resource->State == EResourceState::Resident;
+	}
+
+	void FResourceBudget::SetBudget(uint64 BudgetBytes) noexcept
+	{
+		Settings.BudgetBytes = BudgetBytes;
+		Stats.BudgetBytes = BudgetBytes;
+	}
+
+	const FResourceBudgetSettings& FResourceBudget::GetSettings() const noexcept
+	{
+		return Settings;
+	}
+
+	FResourceBudgetStats FResourceBudget::GetStats() const noexcept
+	{
+		auto CurrentStats = Stats;
+		CurrentStats.NumResources = 0;
+		CurrentStats.NumResident = 0;
+
+		for (const auto& TypeResources : Resources)
+		{
+			CurrentStats.NumResources += static_cast<uint32>(TypeResources.size());
+
+			for (const auto& ResourcePair : TypeResources)
+			{
+				if (ResourcePair.second.State == EResourceState::Resident)
+				{
+					++CurrentStats.NumResident;
+				}
+			}
+		}
+
+		return CurrentStats;
+	}
+
+	FResourceBudget::FResource* FResourceBudget::FindResource(EResourceType Type, const std::string& Name)
+	{
+		auto& TypeResources = Resources[static_cast<uint8>(Type)];
+
+		auto ResourceIter = TypeResources.find(Name);
+		return (ResourceIter != TypeResources.end()) ? &ResourceIter->second : nullptr;
+	}
+
+	const FResourceBudget::FResource* FResourceBudget::FindResource(EResourceType Type, const std::string& Name) const
+	{
+		const auto& TypeResources = Resources[static_cast<uint8>(Type)];
+
+		auto ResourceIter = TypeResources.find(Name);
+		return (ResourceIter != TypeResources.cend()) ? &ResourceIter->second : nullptr;
+	}
+
+	FResourceBudget::FResource& FResourceBudget::FindOrAddResource(EResourceType Type, const std::string& Name)
+	{
+		if (Name.empty())
+		{
+			throw std::invalid_argument("Name must be not empty");
+		}
+
+		auto& TypeResources = Resources[static_cast<uint8>(Type)];
+
+		auto ResourceIter = TypeResources.find(Name);
+		if (ResourceIter == TypeResources.end())
+		{
+			ResourceIter = TypeResources.emplace(Name, FResource()).first;
+			ResourceIter->second.Type = Type;
+			ResourceIter->second.Name = Name;
+		}
+
+		return ResourceIter->second;
+	}
+
+	void FResourceBudget::AccountFootprint(const FResourceFootprint& Footprint, bool bAdd) noexcept
+	{
+		for (uint8 iMemory = 0; iMemory < static_cast<uint8>(EResourceMemory::Count); ++iMemory)
+		{
+			auto& ResidentBytes = Stats.ResidentFootprint.Bytes[iMemory];
+			if (bAdd)
+			{
+				ResidentBytes += Footprint.Bytes[iMemory];
+			}
+			else
+			{
+				ResidentBytes -= std::min(ResidentBytes, Footprint.Bytes[iMemory]);
+			}
+		}
+	}
+}
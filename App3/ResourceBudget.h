@@ -0,0 +1,337 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "pch.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \enum EResourceType
+	 *
+	 * \brief Type of a resource of FResourceBudget. Names are unique within a type
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	enum class EResourceType : uint8
+	{
+		Mesh = 0,
+		Texture,
+		Material,
+		Count
+	};
+
+	/*!
+	 * \enum EResourceMemory
+	 *
+	 * \brief Category of memory which is accounted by FResourceBudget
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	enum class EResourceMemory : uint8
+	{
+		// Copies of resources' data in system memory (submeshes, meshlets, descriptions of mips)
+		CPU = 0,
+
+		// Vertices and indices
+		GPUBuffers,
+
+		Textures,
+		Count
+	};
+
+	/*!
+	 * \struct FResourceFootprint
+	 *
+	 * \brief Bytes of a resource in every category of memory
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FResourceFootprint
+	{
+		std::array<uint64, static_cast<uint8>(EResourceMemory::Count)> Bytes = {};
+
+		uint64& operator[](EResourceMemory Memory) noexcept
+		{
+			return Bytes[static_cast<uint8>(Memory)];
+		}
+
+		uint64 operator[](EResourceMemory Memory) const noexcept
+		{
+			return Bytes[static_cast<uint8>(Memory)];
+		}
+
+		uint64 GetTotalBytes() const noexcept
+		{
+			uint64 TotalBytes = 0;
+			for (auto NumBytes : Bytes)
+			{
+				TotalBytes += NumBytes;
+			}
+			return TotalBytes;
+		}
+	};
+
+	/*!
+	 * \struct FResourceBudgetSettings
+	 *
+	 * \brief Settings of FResourceBudget
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FResourceBudgetSettings
+	{
+		// Memory of all resident resources. Referenced resources are kept even over it
+		uint64 BudgetBytes = 256 * 1024 * 1024;
+
+		// Resources used within this number of last frames aren't evicted, even if they aren't referenced
+		uint32 NumUnusedFramesToEvict = 60;
+	};
+
+	/*!
+	 * \struct FResourceRequest
+	 *
+	 * \brief Request to evict or reload a resource. It's executed by the resource's owner
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FResourceRequest
+	{
+		EResourceType Type = EResourceType::Mesh;
+
+		std::string Name;
+
+		// Reloads are confirmed by FResourceBudget::CompleteLoad. Evictions are done at once
+		bool bEvict = false;
+	};
+
+	/*!
+	 * \struct FResourceBudgetStats
+	 *
+	 * \brief Accounting of FResourceBudget
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FResourceBudgetStats
+	{
+		// Resident resources and loads in flight (with their last known footprints)
+		FResourceFootprint ResidentFootprint;
+
+		uint64 BudgetBytes = 0;
+
+		uint32 NumResources = 0;
+		uint32 NumResident = 0;
+
+		uint32 NumEvicted = 0;
+		uint32 NumReloaded = 0;
+	};
+
+	/*!
+	 * \class FResourceBudget
+	 *
+	 * \brief Decides which resources are resident within a memory budget.
+	 * Resources are referenced by their users (objects refer meshes and materials, materials refer textures),
+	 * and usage is reported every frame. When the budget is exceeded, unreferenced resources which can be reloaded
+	 * are evicted in LRU order. Evicted resources are reloaded when they're referenced or used again.
+	 * It doesn't touch resources: requests are executed by the caller and loads are confirmed by CompleteLoad
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FResourceBudget
+	{
+	public:
+		explicit FResourceBudget(const FResourceBudgetSettings& Settings = FResourceBudgetSettings());
+		~FResourceBudget() = default;
+
+		FResourceBudget& operator=(const FResourceBudget& ResourceBudget) = delete;
+		FResourceBudget(const FResourceBudget& ResourceBudget) = delete;
+		FResourceBudget(FResourceBudget&& ResourceBudget) = delete;
+
+		/** @brief Starts a load of the resource. It isn't evicted until the load is completed.
+		  * The resource is added if it isn't known yet
+		  * @param Type (EResourceType)
+		  * @param Name (const std::string &)
+		  * @param bReloadable The owner can load it again after eviction (bool)
+		  * @return (void)
+		  */
+		void BeginLoad(EResourceType Type, const std::string& Name, bool bReloadable);
+
+		/** @brief Completes the load of the resource. A failed load of a resident resource keeps it resident,
+		  * otherwise the resource isn't reloaded anymore
+		  * @param Type (EResourceType)
+		  * @param Name (const std::string &)
+		  * @param bSucceeded (bool)
+		  * @param Footprint Memory of the loaded resource (const FResourceFootprint &)
+		  * @return (void)
+		  */
+		void CompleteLoad(
+			EResourceType Type,
+			const std::string& Name,
+			bool bSucceeded,
+			const FResourceFootprint& Footprint = FResourceFootprint());
+
+		/** @brief Adds a resource which is loaded at once (BeginLoad and CompleteLoad)
+		  * @param Type (EResourceType)
+		  * @param Name (const std::string &)
+		  * @param Footprint (const FResourceFootprint &)
+		  * @param bReloadable (bool)
+		  * @return (void)
+		  */
+		void AddResource(
+			EResourceType Type,
+			const std::string& Name,
+			const FResourceFootprint& Footprint,
+			bool bReloadable);
+
+		/** @brief Forgets the resource. Referenced one is kept unloaded and not reloadable,
+		  * so its users may release their references. Unknown resources are ignored
+		  * @param Type (EResourceType)
+		  * @param Name (const std::string &)
+		  * @return (void)
+		  */
+		void RemoveResource(EResourceType Type, const std::string& Name);
+
+		/** @brief Returns true if the resource is known
+		  * @param Type (EResourceType)
+		  * @param Name (const std::string &)
+		  * @return (bool)
+		  */
+		bool HasResource(EResourceType Type, const std::string& Name) const;
+
+		/** @brief Adds a reference to the resource. The resource is added if it isn't known yet,
+		  * so users may refer resources which are being loaded
+		  * @param Type (EResourceType)
+		  * @param Name (const std::string &)
+		  * @return Number of references after adding (uint32)
+		  */
+		uint32 AddReference(EResourceType Type, const std::string& Name);
+
+		/** @brief Releases a reference to the resource.
+		  * Throws invalid_argument if the resource isn't known or isn't referenced
+		  * @param Type (EResourceType)
+		  * @param Name (const std::string &)
+		  * @return Number of references after releasing (uint32)
+		  */
+		uint32 ReleaseReference(EResourceType Type, const std::string& Name);
+
+		/** @brief Returns number of references to the resource. It's 0 for unknown resources
+		  * @param Type (EResourceType)
+		  * @param Name (const std::string &)
+		  * @return (uint32)
+		  */
+		uint32 GetNumReferences(EResourceType Type, const std::string& Name) const;
+
+		/** @brief Reports usage of the resource in the frame. Unknown resources are ignored
+		  * @param Type (EResourceType)
+		  * @param Name (const std::string &)
+		  * @param Frame Index of the current frame (uint64)
+		  * @return (void)
+		  */
+		void MarkUsed(EResourceType Type, const std::string& Name, uint64 Frame);
+
+		/** @brief Evicts unused resources over the budget and reloads wanted evicted ones
+		  * @param Frame Index of the current frame (uint64)
+		  * @return Evictions in LRU order and then reloads (std::vector<WoodenEngine::FResourceRequest>)
+		  */
+		std::vector<FResourceRequest> Update(uint64 Frame);
+
+		/** @brief Returns true if the resource is loaded and isn't evicted
+		  * @param Type (EResourceType)
+		  * @param Name (const std::string &)
+		  * @return (bool)
+		  */
+		bool IsResident(EResourceType Type, const std::string& Name) const;
+
+		/** @brief Changes the budget. Resources over it are evicted by next Update
+		  * @param BudgetBytes (uint64)
+		  * @return (void)
+		  */
+		void SetBudget(uint64 BudgetBytes) noexcept;
+
+		/** @brief Returns settings of the budget
+		  * @return (const WoodenEngine::FResourceBudgetSettings&)
+		  */
+		const FResourceBudgetSettings& GetSettings() const noexcept;
+
+		/** @brief Returns accounting of resident resources
+		  * @return (WoodenEngine::FResourceBudgetStats)
+		  */
+		FResourceBudgetStats GetStats() const noexcept;
+
+	private:
+		enum class EResourceState : uint8
+		{
+			// Referenced before its first load or its load failed
+			Unloaded = 0,
+			Loading,
+			Resident,
+			Evicted
+		};
+
+		struct FResource
+		{
+			EResourceType Type = EResourceType::Mesh;
+
+			std::string Name;
+
+			// Last loaded footprint. It's kept for evicted resources to predict their reloads
+			FResourceFootprint Footprint;
+
+			EResourceState State = EResourceState::Unloaded;
+
+			// The last load of a resident resource may fail and keep it resident
+			bool bWasResident = false;
+
+			bool bReloadable = false;
+
+			uint32 NumReferences = 0;
+
+			uint64 LastUsedFrame = 0;
+		};
+
+		using FResources = std::unordered_map<std::string, FResource>;
+
+		/** @brief Returns the resource or nullptr
+		  * @param Type (EResourceType)
+		  * @param Name (const std::string &)
+		  * @return (FResource*)
+		  */
+		FResource* FindResource(EResourceType Type, const std::string& Name);
+
+		const FResource* FindResource(EResourceType Type, const std::string& Name) const;
+
+		/** @brief Returns the resource and adds it if it isn't known
+		  * @param Type (EResourceType)
+		  * @param Name (const std::string &)
+		  * @return (FResource&)
+		  */
+		FResource& FindOrAddResource(EResourceType Type, const std::string& Name);
+
+		/** @brief Adds or subtracts the footprint from resident memory
+		  * @param Footprint (const FResourceFootprint &)
+		  * @param bAdd (bool)
+		  * @return (void)
+		  */
+		void AccountFootprint(const FResourceFootprint& Footprint, bool bAdd) noexcept;
+
+		FResourceBudgetSettings Settings;
+
+		// Resources of every type by names
+		std::array<FResources, static_cast<uint8>(EResourceType::Count)> Resources;
+
+		FResourceBudgetStats Stats;
+
+		// Frame of the last Update. Loaded resources are used in it
+		uint64 CurrentFrame = 0;
+	};
+}
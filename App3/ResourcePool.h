@@ -0,0 +1,266 @@
+#pragma once
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "pch.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FPoolHandle
+	 *
+	 * \brief Handle of a value of FResourcePool<T>. It's an index of the value's slot and the slot's generation,
+	 * so a handle of a destroyed value never refers a value created later in the same slot
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	template<typename T>
+	struct FPoolHandle
+	{
+		static constexpr uint32 InvalidIndex = UINT32_MAX;
+
+		uint32 Index = InvalidIndex;
+
+		uint32 Generation = 0;
+
+		bool IsValid() const noexcept
+		{
+			return Index != InvalidIndex;
+		}
+
+		bool operator==(const FPoolHandle& Handle) const noexcept
+		{
+			return Index == Handle.Index && Generation == Handle.Generation;
+		}
+
+		bool operator!=(const FPoolHandle& Handle) const noexcept
+		{
+			return !(*this == Handle);
+		}
+	};
+
+	/*!
+	 * \class FResourcePool
+	 *
+	 * \brief Slot map of values. Values are stored contiguously in order of creation
+	 * (destroyed value is replaced by the last one), so iteration doesn't chase pointers.
+	 * Handles are resolved through slots in O(1). Pointers to values are invalidated by Create and Destroy,
+	 * handles are invalidated only by destroying their values
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	template<typename T>
+	class FResourcePool
+	{
+	public:
+		using FHandle = FPoolHandle<T>;
+
+		FResourcePool() = default;
+		~FResourcePool() = default;
+
+		FResourcePool& operator=(const FResourcePool& ResourcePool) = delete;
+		FResourcePool(const FResourcePool& ResourcePool) = delete;
+		FResourcePool(FResourcePool&& ResourcePool) = delete;
+
+		/** @brief Constructs a value in a free slot
+		  * @param Args Arguments of T's constructor
+		  * @return (FHandle)
+		  */
+		template<typename... TArgs>
+		FHandle Create(TArgs&&... Args)
+		{
+			if (FreeSlots.empty() && Slots.size() == FHandle::InvalidIndex)
+			{
+				throw std::invalid_argument("Resource pool is full");
+			}
+
+			Values.emplace_back(std::forward<TArgs>(Args)...);
+
+			uint32 iSlot;
+			if (FreeSlots.empty())
+			{
+				iSlot = static_cast<uint32>(Slots.size());
+				Slots.emplace_back();
+			}
+			else
+			{
+				iSlot = FreeSlots.back();
+				FreeSlots.pop_back();
+			}
+
+			auto& Slot = Slots[iSlot];
+			Slot.iValue = static_cast<uint32>(Values.size() - 1);
+			ValuesSlots.push_back(iSlot);
+
+			FHandle Handle;
+			Handle.Index = iSlot;
+			Handle.Generation = Slot.Generation;
+			return Handle;
+		}
+
+		/** @brief Destroys the value and frees its slot. The last value is moved to its place.
+		  * Throws invalid_argument if the handle is stale
+		  * @param Handle (FHandle)
+		  * @return (void)
+		  */
+		void Destroy(FHandle Handle)
+		{
+			if (!Contains(Handle))
+			{
+				throw std::invalid_argument("Handle doesn't refer a value of the pool");
+			}
+
+			auto& Slot = Slots[Handle.Index];
+			const auto iValue = Slot.iValue;
+			const auto iLastValue = static_cast<uint32>(Values.size() - 1);
+			if (iValue != iLastValue)
+			{
+				Values[iValue] = std::move(Values[iLastValue]);
+				ValuesSlots[iValue] = ValuesSlots[iLastValue];
+				Slots[ValuesSlots[iValue]].iValue = iValue;
+			}
+
+			Values.pop_back();
+			ValuesSlots.pop_back();
+
+			// Handles of the destroyed value become stale
+			++Slot.Generation;
+			Slot.iValue = FHandle::InvalidIndex;
+			FreeSlots.push_back(Handle.Index);
+		}
+
+		/** @brief Returns true if the handle refers a value which isn't destroyed
+		  * @param Handle (FHandle)
+		  * @return (bool)
+		  */
+		bool Contains(FHandle Handle) const noexcept
+		{
+			return Handle.Index < Slots.size() &&
+				Slots[Handle.Index].Generation == Handle.Generation &&
+				Slots[Handle.Index].iValue != FHandle::InvalidIndex;
+		}
+
+		/** @brief Returns the value or nullptr if the handle is stale
+		  * @param Handle (FHandle)
+		  * @return (T*)
+		  */
+		T* Find(FHandle Handle) noexcept
+		{
+			return Contains(Handle) ? &Values[Slots[Handle.Index].iValue] : nullptr;
+		}
+
+		/** @brief Returns the value or nullptr if the handle is stale
+		  * @param Handle (FHandle)
+		  * @return (const T*)
+		  */
+		const T* Find(FHandle Handle) const noexcept
+		{
+			return Contains(Handle) ? &Values[Slots[Handle.Index].iValue] : nullptr;
+		}
+
+		/** @brief Returns the value. Throws invalid_argument if the handle is stale
+		  * @param Handle (FHandle)
+		  * @return (T&)
+		  */
+		T& Get(FHandle Handle)
+		{
+			auto Value = Find(Handle);
+			if (Value == nullptr)
+			{
+				throw std::invalid_argument("Handle doesn't refer a value of the pool");
+			}
+			return *Value;
+		}
+
+		/** @brief Returns the value. Throws invalid_argument if the handle is stale
+		  * @param Handle (FHandle)
+		  * @return (const T&)
+		  */
+		const T& Get(FHandle Handle) const
+		{
+			const auto Value = Find(Handle);
+			if (Value == nullptr)
+			{
+				throw std::invalid_argument("Handle doesn't refer a value of the pool");
+			}
+			return *Value;
+		}
+
+		/** @brief Returns the handle of the value with the index in contiguous storage
+		  * @param iValue Less than GetNumValues() (uint32)
+		  * @return (FHandle)
+		  */
+		FHandle GetHandle(uint32 iValue) const noexcept
+		{
+			FHandle Handle;
+			Handle.Index = ValuesSlots[iValue];
+			Handle.Generation = Slots[Handle.Index].Generation;
+			return Handle;
+		}
+
+		uint32 GetNumValues() const noexcept
+		{
+			return static_cast<uint32>(Values.size());
+		}
+
+		bool IsEmpty() const noexcept
+		{
+			return Values.empty();
+		}
+
+		/** @brief Reserves storage, so creation of NumValues values doesn't reallocate it
+		  * @param NumValues (uint32)
+		  * @return (void)
+		  */
+		void Reserve(uint32 NumValues)
+		{
+			Values.reserve(NumValues);
+			ValuesSlots.reserve(NumValues);
+			Slots.reserve(NumValues);
+		}
+
+		typename std::vector<T>::iterator begin() noexcept
+		{
+			return Values.begin();
+		}
+
+		typename std::vector<T>::iterator end() noexcept
+		{
+			return Values.end();
+		}
+
+		typename std::vector<T>::const_iterator begin() const noexcept
+		{
+			return Values.cbegin();
+		}
+
+		typename std::vector<T>::const_iterator end() const noexcept
+		{
+			return Values.cend();
+		}
+
+	private:
+		struct FSlot
+		{
+			// Index of the value in Values. InvalidIndex if the slot is free
+			uint32 iValue = FHandle::InvalidIndex;
+
+			// Incremented on destroying of the slot's value
+			uint32 Generation = 0;
+		};
+
+		// Contiguous values
+		std::vector<T> Values;
+
+		// Slot of every value, indexed as Values
+		std::vector<uint32> ValuesSlots;
+
+		std::vector<FSlot> Slots;
+
+		std::vector<uint32> FreeSlots;
+	};
+}
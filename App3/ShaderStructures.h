@@ -102,6 +102,46 @@ namespace WoodenEngine
 		XMFLOAT2 TexC;
 	};
 
+	// Octahedral normal (R10G10) and tangent's angle around the normal (B10).
+	// A2 is reserved. Decoded as DXGI_FORMAT_R10G10B10A2_UNORM
+	using SPackedNormalTangent = uint32;
+
+	struct SPackedVertexData
+	{
+		// Local coordinates
+		XMFLOAT3 Position;
+
+		SPackedNormalTangent NormalTangent;
+
+		// UV-Coordinates as half floats
+		uint16 TexC[2];
+	}; // 20B
+
+	struct SQuantizedVertexData
+	{
+		// Local coordinates in submesh's bounds as unorm16 (w is unused)
+		uint16 Position[4];
+
+		SPackedNormalTangent NormalTangent;
+
+		// UV-Coordinates in submesh's uv bounds as unorm16
+		uint16 TexC[2];
+	}; // 16B
+
+	// Root constants for decoding packed vertices of a submesh:
+	// Position = Position*PositionScale + PositionOffset
+	struct SVertexQuantizationData
+	{
+		XMFLOAT3 PositionScale = { 1.0f, 1.0f, 1.0f };
+		float Pad0 = 0.0f;
+
+		XMFLOAT3 PositionOffset = { 0.0f, 0.0f, 0.0f };
+		float Pad1 = 0.0f;
+
+		XMFLOAT2 TexCScale = { 1.0f, 1.0f };
+		XMFLOAT2 TexCOffset = { 0.0f, 0.0f };
+	}; // 48B
+
 	struct SVertexBillboardData 
 	{
 		// World space position of the billboard
@@ -122,8 +122,19 @@ struct VertexOut
 
 static const float PI = 3.14159265f;
 
+#ifdef PACKED_VERTEX
+#include "VertexPacking.hlsl"
+
+VertexOut VS(PackedVertexIn pvin)
+{
+	VertexIn vin;
+	vin.PosL = DecodePosition(pvin.PosL);
+	vin.NormalL = DecodeOctahedral(pvin.NormalTangentL.xy);
+	vin.TexC = DecodeTexC(pvin.TexC);
+#else
 VertexOut VS(VertexIn vin)
 {
+#endif
 	VertexOut vout = (VertexOut)0.0f;
 	
     if (cbIsWater > 0)
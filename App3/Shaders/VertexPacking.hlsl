@@ -0,0 +1,48 @@
+// Decoding of packed static meshes' vertices (see FVertexPacker)
+
+// Decoding constants of the drawn submesh
+cbuffer cbVertexQuantization : register(b3)
+{
+	float3 cbPositionScale;
+	float cbPad0;
+
+	float3 cbPositionOffset;
+	float cbPad1;
+
+	float2 cbTexCScale;
+	float2 cbTexCOffset;
+};
+
+struct PackedVertexIn
+{
+	// Local position (float or unorm16 in submesh's bounds)
+	float4 PosL : POSITION;
+
+	// Octahedral normal (xy) and tangent's angle around it (z). The tangent isn't used by shaders yet
+	float4 NormalTangentL : NORMAL;
+
+	// Texture coordinates (half or unorm16 in submesh's uv bounds)
+	float2 TexC : TEXCOORD;
+};
+
+float3 DecodeOctahedral(float2 uv)
+{
+	float2 f = uv * 2.0f - 1.0f;
+	float3 n = float3(f, 1.0f - abs(f.x) - abs(f.y));
+
+	float fold = saturate(-n.z);
+	n.x += n.x >= 0.0f ? -fold : fold;
+	n.y += n.y >= 0.0f ? -fold : fold;
+
+	return normalize(n);
+}
+
+float3 DecodePosition(float4 posL)
+{
+	return posL.xyz * cbPositionScale + cbPositionOffset;
+}
+
+float2 DecodeTexC(float2 texC)
+{
+	return texC * cbTexCScale + cbTexCOffset;
+}
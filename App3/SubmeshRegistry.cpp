@@ -0,0 +1,101 @@
+#include <stdexcept>
+
+#include "SubmeshRegistry.h"
+
+namespace WoodenEngine
+{
+	FSubmeshHandle FSubmeshRegistry::FindHandle(const std::string& MeshName, const std::string& SubmeshName) const
+	{
+		const auto SubmeshHandleIter = SubmeshesHandles.find(GetKey(MeshName, SubmeshName));
+		if (SubmeshHandleIter == SubmeshesHandles.cend())
+		{
+			return FSubmeshHandle();
+		}
+
+		return SubmeshHandleIter->second;
+	}
+
+	FSubmeshHandle FSubmeshRegistry::AddHandle(const std::string& MeshName, const std::string& SubmeshName)
+	{
+		if (MeshName.empty() || SubmeshName.empty())
+		{
+			throw std::invalid_argument("MeshName and SubmeshName must be not empty");
+		}
+
+		FSubmeshHandle SubmeshHandle;
+		SubmeshHandle.Index = static_cast<uint32>(SubmeshesSlots.size());
+		if (!SubmeshesHandles.emplace(GetKey(MeshName, SubmeshName), SubmeshHandle).second)
+		{
+			throw std::invalid_argument("Submesh " + SubmeshName + " of mesh " + MeshName + " is already interned");
+		}
+
+		SubmeshesSlots.emplace_back();
+		SubmeshesSlotsNames.emplace_back(MeshName, SubmeshName);
+
+		return SubmeshHandle;
+	}
+
+	void FSubmeshRegistry::ResolveSlot(
+		FSubmeshHandle SubmeshHandle,
+		FMeshHandle MeshHandle,
+		const FSubmeshData& SubmeshData,
+		const std::unordered_map<std::string, FMaterialHandle>& MaterialsHandles)
+	{
+		FSubmeshSlot SubmeshSlot;
+		SubmeshSlot.MeshHandle = MeshHandle;
+		SubmeshSlot.SubmeshData = &SubmeshData;
+
+		const auto MaterialHandleIter = MaterialsHandles.find(SubmeshData.MaterialName);
+		if (MaterialHandleIter != MaterialsHandles.cend())
+		{
+			SubmeshSlot.MaterialHandle = MaterialHandleIter->second;
+		}
+
+		SubmeshesSlots[SubmeshHandle.Index] = SubmeshSlot;
+	}
+
+	void FSubmeshRegistry::ResolveMesh(
+		FMeshHandle MeshHandle,
+		const FMeshData& MeshData,
+		const std::unordered_map<std::string, FMaterialHandle>& MaterialsHandles)
+	{
+		for (uint32 iSlot = 0; iSlot < SubmeshesSlots.size(); ++iSlot)
+		{
+			const auto& SlotNames = SubmeshesSlotsNames[iSlot];
+			if (SlotNames.first != MeshData.Name)
+			{
+				continue;
+			}
+
+			const auto SubmeshDataIter = MeshData.SubmeshesData.find(SlotNames.second);
+			if (SubmeshDataIter == MeshData.SubmeshesData.cend())
+			{
+				DBOUT("Objects aren't drawn", "mesh " << MeshData.Name << " doesn't have submesh " << SlotNames.second);
+				continue;
+			}
+
+			FSubmeshHandle SubmeshHandle;
+			SubmeshHandle.Index = iSlot;
+			ResolveSlot(SubmeshHandle, MeshHandle, *SubmeshDataIter->second, MaterialsHandles);
+		}
+	}
+
+	void FSubmeshRegistry::ResetMesh(FMeshHandle MeshHandle) noexcept
+	{
+		for (auto& SubmeshSlot : SubmeshesSlots)
+		{
+			if (SubmeshSlot.MeshHandle == MeshHandle)
+			{
+				SubmeshSlot = FSubmeshSlot();
+			}
+		}
+	}
+
+	std::string FSubmeshRegistry::GetKey(const std::string& MeshName, const std::string& SubmeshName)
+	{
+		auto Key = MeshName;
+		Key.push_back('\0');
+		Key += SubmeshName;
+		return Key;
+	}
+}
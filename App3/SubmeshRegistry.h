@@ -0,0 +1,150 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "pch.h"
+#include "ShaderStructures.h"
+#include "MaterialData.h"
+#include "MeshData.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FSubmeshSlot
+	 *
+	 * \brief Submesh interned by FSubmeshRegistry. It's resolved when its mesh is uploaded.
+	 * Submeshes are owned by unique_ptrs, so they aren't moved with their mesh inside of the pool
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FSubmeshSlot
+	{
+		FMeshHandle MeshHandle;
+		const FSubmeshData* SubmeshData = nullptr;
+
+		// Engine's material of the submesh's MaterialName
+		FMaterialHandle MaterialHandle;
+	};
+
+	/*!
+	 * \class FSubmeshRegistry
+	 *
+	 * \brief Interns names of meshes and submeshes to handles, so draws don't look them up by names.
+	 * Slots are resolved when their meshes are uploaded and reset when they're removed or evicted
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FSubmeshRegistry
+	{
+	public:
+		FSubmeshRegistry() = default;
+		~FSubmeshRegistry() = default;
+
+		FSubmeshRegistry& operator=(const FSubmeshRegistry& SubmeshRegistry) = delete;
+		FSubmeshRegistry(const FSubmeshRegistry& SubmeshRegistry) = delete;
+		FSubmeshRegistry(FSubmeshRegistry&& SubmeshRegistry) = delete;
+
+		/** @brief Returns the handle of interned names
+		  * @param MeshName (const std::string &)
+		  * @param SubmeshName (const std::string &)
+		  * @return Invalid handle if names aren't interned (WoodenEngine::FSubmeshHandle)
+		  */
+		FSubmeshHandle FindHandle(const std::string& MeshName, const std::string& SubmeshName) const;
+
+		/** @brief Interns names to a new unresolved slot. Throws invalid_argument if names are empty or interned
+		  * @param MeshName (const std::string &)
+		  * @param SubmeshName (const std::string &)
+		  * @return (WoodenEngine::FSubmeshHandle)
+		  */
+		FSubmeshHandle AddHandle(const std::string& MeshName, const std::string& SubmeshName);
+
+		/** @brief Resolves the slot to the uploaded submesh and the material of its MaterialName
+		  * @param SubmeshHandle (FSubmeshHandle)
+		  * @param MeshHandle (FMeshHandle)
+		  * @param SubmeshData (const FSubmeshData &)
+		  * @param MaterialsHandles Materials' handles, where key is a material's name
+		  * (const std::unordered_map<std::string, FMaterialHandle> &)
+		  * @return (void)
+		  */
+		void ResolveSlot(
+			FSubmeshHandle SubmeshHandle,
+			FMeshHandle MeshHandle,
+			const FSubmeshData& SubmeshData,
+			const std::unordered_map<std::string, FMaterialHandle>& MaterialsHandles);
+
+		/** @brief Resolves slots of the uploaded mesh's submeshes. Slots of submeshes which it doesn't have stay unresolved
+		  * @param MeshHandle (FMeshHandle)
+		  * @param MeshData (const FMeshData &)
+		  * @param MaterialsHandles (const std::unordered_map<std::string, FMaterialHandle> &)
+		  * @return (void)
+		  */
+		void ResolveMesh(
+			FMeshHandle MeshHandle,
+			const FMeshData& MeshData,
+			const std::unordered_map<std::string, FMaterialHandle>& MaterialsHandles);
+
+		/** @brief Unresolves slots of the removed or evicted mesh. Their handles stay valid
+		  * @param MeshHandle (FMeshHandle)
+		  * @return (void)
+		  */
+		void ResetMesh(FMeshHandle MeshHandle) noexcept;
+
+		/** @brief Returns true if the slot is resolved, so its mesh is uploaded and has the submesh
+		  * @param SubmeshHandle (FSubmeshHandle)
+		  * @return (bool)
+		  */
+		bool IsReady(FSubmeshHandle SubmeshHandle) const noexcept
+		{
+			return SubmeshHandle.Index < SubmeshesSlots.size() &&
+				SubmeshesSlots[SubmeshHandle.Index].SubmeshData != nullptr;
+		}
+
+		/** @brief Returns the slot of the valid handle without lookups by names
+		  * @param SubmeshHandle (FSubmeshHandle)
+		  * @return (const WoodenEngine::FSubmeshSlot&)
+		  */
+		const FSubmeshSlot& GetSlot(FSubmeshHandle SubmeshHandle) const noexcept
+		{
+			return SubmeshesSlots[SubmeshHandle.Index];
+		}
+
+		/** @brief Returns names of the mesh and the submesh of the valid handle
+		  * @param SubmeshHandle (FSubmeshHandle)
+		  * @return (const std::pair<std::string, std::string>&)
+		  */
+		const std::pair<std::string, std::string>& GetNames(FSubmeshHandle SubmeshHandle) const noexcept
+		{
+			return SubmeshesSlotsNames[SubmeshHandle.Index];
+		}
+
+		/** @brief Returns number of interned submeshes
+		  * @return (uint32)
+		  */
+		uint32 GetNumSlots() const noexcept
+		{
+			return static_cast<uint32>(SubmeshesSlots.size());
+		}
+
+	private:
+		/** @brief Returns the key of handles' hash-table: "<MeshName>\0<SubmeshName>"
+		  * @param MeshName (const std::string &)
+		  * @param SubmeshName (const std::string &)
+		  * @return (std::string)
+		  */
+		static std::string GetKey(const std::string& MeshName, const std::string& SubmeshName);
+
+		// Submeshes referred by objects, indexed by FSubmeshHandle
+		std::vector<FSubmeshSlot> SubmeshesSlots;
+
+		// Names of the slots' meshes and submeshes. They're read on uploads of meshes only
+		std::vector<std::pair<std::string, std::string>> SubmeshesSlotsNames;
+
+		// Handles of interned submeshes, where key is "<MeshName>\0<SubmeshName>"
+		std::unordered_map<std::string, FSubmeshHandle> SubmeshesHandles;
+	};
+}
@@ -0,0 +1,432 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "Terrain.h"
+
+namespace WoodenEngine
+{
+	FTerrain::FTerrain(const FTerrainSettings& Settings, FHeightFunction HeightFunction):
+		Settings(Settings),
+		HeightFunction(std::move(HeightFunction))
+	{
+		if (Settings.WorldSize <= 0.0f)
+		{
+			throw std::invalid_argument("WorldSize must be positive");
+		}
+
+		if (Settings.TileResolution < 2)
+		{
+			throw std::invalid_argument("TileResolution must be at least 2");
+		}
+
+		if (Settings.MaxDepth > 28)
+		{
+			throw std::invalid_argument("MaxDepth must be not greater than 28");
+		}
+
+		if (!this->HeightFunction)
+		{
+			throw std::invalid_argument("HeightFunction must be not empty");
+		}
+	}
+
+	FTerrain::~FTerrain()
+	{
+		for (auto& PendingTile : PendingTiles)
+		{
+			PendingTile.second.wait();
+		}
+	}
+
+	void FTerrain::Update(const XMFLOAT3& CameraPosition)
+	{
+		++iFrame;
+
+		CollectGeneratedTiles(false);
+
+		SelectedTiles.clear();
+		TileRequests.clear();
+		SelectTiles(0, 0, 0, XMLoadFloat3(&CameraPosition));
+
+		RequestTiles();
+		EvictTiles();
+
+		Stats.NumResidentTiles = static_cast<uint32>(ResidentTiles.size());
+		Stats.NumPendingTiles = static_cast<uint32>(PendingTiles.size());
+		Stats.NumSelectedTiles = static_cast<uint32>(SelectedTiles.size());
+	}
+
+	void FTerrain::WaitForPendingTiles()
+	{
+		CollectGeneratedTiles(true);
+
+		Stats.NumResidentTiles = static_cast<uint32>(ResidentTiles.size());
+		Stats.NumPendingTiles = static_cast<uint32>(PendingTiles.size());
+	}
+
+	const std::vector<const FTerrainTile*>& FTerrain::GetSelectedTiles() const noexcept
+	{
+		return SelectedTiles;
+	}
+
+	const FTerrainStats& FTerrain::GetStats() const noexcept
+	{
+		return Stats;
+	}
+
+	const FTerrainSettings& FTerrain::GetSettings() const noexcept
+	{
+		return Settings;
+	}
+
+	std::unique_ptr<FMeshRawData> FTerrain::GenerateTileMesh(
+		const FTerrainSettings& Settings,
+		const FHeightFunction& HeightFunction,
+		float MinX,
+		float MinZ,
+		float Size)
+	{
+		auto MeshData = std::make_unique<FMeshRawData>("TerrainTile");
+
+		const auto Resolution = Settings.TileResolution;
+		const auto Spacing = Size / (Resolution - 1);
+
+		// Heights with one extra ring around the tile for central differences
+		const auto NumSamplesInRow = Resolution + 2;
+		std::vector<float> Heights(NumSamplesInRow*NumSamplesInRow);
+		for (uint32 iSampleZ = 0; iSampleZ < NumSamplesInRow; ++iSampleZ)
+		{
+			const auto Z = MinZ + (static_cast<int32>(iSampleZ) - 1)*Spacing;
+			for (uint32 iSampleX = 0; iSampleX < NumSamplesInRow; ++iSampleX)
+			{
+				const auto X = MinX + (static_cast<int32>(iSampleX) - 1)*Spacing;
+				Heights[iSampleZ*NumSamplesInRow + iSampleX] = HeightFunction(X, Z);
+			}
+		}
+
+		const auto NumGridVertices = Resolution*Resolution;
+		MeshData->Vertices.resize(NumGridVertices + 4 * Resolution);
+
+		for (uint32 iZ = 0; iZ < Resolution; ++iZ)
+		{
+			for (uint32 iX = 0; iX < Resolution; ++iX)
+			{
+				const auto iSample = (iZ + 1)*NumSamplesInRow + iX + 1;
+				const auto DiffX = (Heights[iSample + 1] - Heights[iSample - 1]) / (2.0f*Spacing);
+				const auto DiffZ = (Heights[iSample + NumSamplesInRow] - Heights[iSample - NumSamplesInRow]) / (2.0f*Spacing);
+
+				auto& Vertex = MeshData->Vertices[iZ*Resolution + iX];
+				Vertex.Position = { MinX + iX*Spacing, Heights[iSample], MinZ + iZ*Spacing };
+
+				XMStoreFloat3(&Vertex.Normal, XMVector3Normalize(XMVectorSet(-DiffX, 1.0f, -DiffZ, 0.0f)));
+				XMStoreFloat3(&Vertex.Tangent, XMVector3Normalize(XMVectorSet(1.0f, DiffX, 0.0f, 0.0f)));
+
+				// Texture coordinates are continuous across tiles
+				Vertex.TexC = { 
+					Vertex.Position.x / Settings.WorldSize + 0.5f, 
+					Vertex.Position.z / Settings.WorldSize + 0.5f };
+			}
+		}
+
+		const auto NumGridIndices = (Resolution - 1)*(Resolution - 1) * 6;
+		const auto NumSkirtIndices = 4 * (Resolution - 1) * 6;
+		MeshData->Indices.reserve(NumGridIndices + NumSkirtIndices);
+
+		for (uint32 iZ = 0; iZ < Resolution - 1; ++iZ)
+		{
+			for (uint32 iX = 0; iX < Resolution - 1; ++iX)
+			{
+				const auto iVertex0 = static_cast<uint32>(iZ*Resolution + iX);
+				const auto iVertex1 = static_cast<uint32>((iZ + 1)*Resolution + iX);
+				const auto iVertex2 = static_cast<uint32>((iZ + 1)*Resolution + iX + 1);
+				const auto iVertex3 = static_cast<uint32>(iZ*Resolution + iX + 1);
+
+				MeshData->Indices.insert(MeshData->Indices.end(), { 
+					iVertex0, iVertex1, iVertex2, 
+					iVertex0, iVertex2, iVertex3 });
+			}
+		}
+
+		// Skirts are vertical strips under the tile's edges, facing outside.
+		// Edges are walked counterclockwise from above: south, east, north, west
+		const auto SkirtDepth = Size*Settings.SkirtDepthFactor;
+		const auto GetEdgeVertex = [Resolution](uint32 iEdge, uint32 iStep)
+		{
+			const auto iLast = Resolution - 1;
+			switch (iEdge)
+			{
+			case 0: return iStep;
+			case 1: return iStep*Resolution + iLast;
+			case 2: return iLast*Resolution + (iLast - iStep);
+			default: return (iLast - iStep)*Resolution;
+			}
+		};
+
+		for (uint32 iEdge = 0; iEdge < 4; ++iEdge)
+		{
+			const auto iSkirtBegin = NumGridVertices + iEdge*Resolution;
+			for (uint32 iStep = 0; iStep < Resolution; ++iStep)
+			{
+				auto& SkirtVertex = MeshData->Vertices[iSkirtBegin + iStep];
+				SkirtVertex = MeshData->Vertices[GetEdgeVertex(iEdge, iStep)];
+				SkirtVertex.Position.y -= SkirtDepth;
+			}
+
+			for (uint32 iStep = 0; iStep < Resolution - 1; ++iStep)
+			{
+				const auto iTop0 = static_cast<uint32>(GetEdgeVertex(iEdge, iStep));
+				const auto iTop1 = static_cast<uint32>(GetEdgeVertex(iEdge, iStep + 1));
+				const auto iBottom0 = static_cast<uint32>(iSkirtBegin + iStep);
+				const auto iBottom1 = static_cast<uint32>(iSkirtBegin + iStep + 1);
+
+				MeshData->Indices.insert(MeshData->Indices.end(), {
+					iTop0, iTop1, iBottom0,
+					iTop1, iBottom1, iBottom0 });
+			}
+		}
+
+		return MeshData;
+	}
+
+	uint64 FTerrain::GetTileNumBytes(const FTerrainSettings& Settings) noexcept
+	{
+		// Grid and 4 skirts of one row of vertices
+		const auto Resolution = uint64(Settings.TileResolution);
+		const auto NumVertices = Resolution*Resolution + 4 * Resolution;
+		const auto NumIndices = (Resolution - 1)*(Resolution - 1) * 6 + 4 * (Resolution - 1) * 6;
+		return NumVertices*sizeof(FVertex) + NumIndices*sizeof(uint32);
+	}
+
+	uint32 FTerrain::GetMaxNumSelectedTiles(const FTerrainSettings& Settings) noexcept
+	{
+		const auto NumSplitNodesPerSide = std::max(ceil(2.0*Settings.LODDistanceFactor) + 1.0, 0.0);
+
+		uint64 NumSelectedTiles = 1;
+		for (uint8 Level = 0; Level < Settings.MaxDepth; ++Level)
+		{
+			const auto NumLevelNodesPerSide = static_cast<uint64>(std::min(double(1u << Level), NumSplitNodesPerSide));
+			NumSelectedTiles += 3 * NumLevelNodesPerSide*NumLevelNodesPerSide;
+		}
+
+		return static_cast<uint32>(std::min(NumSelectedTiles, uint64(UINT32_MAX)));
+	}
+
+	uint64 FTerrain::MakeTileKey(uint8 Level, uint32 X, uint32 Z) noexcept
+	{
+		return (uint64(Level) << 56) | (uint64(X) << 28) | uint64(Z);
+	}
+
+	void FTerrain::GetNodeBounds(uint8 Level, uint32 X, uint32 Z, float* MinX, float* MinZ, float* Size) const noexcept
+	{
+		*Size = Settings.WorldSize / float(1u << Level);
+		*MinX = -0.5f*Settings.WorldSize + X*(*Size);
+		*MinZ = -0.5f*Settings.WorldSize + Z*(*Size);
+	}
+
+	bool FTerrain::SelectTiles(uint8 Level, uint32 X, uint32 Z, FXMVECTOR CameraPosition)
+	{
+		float MinX, MinZ, Size;
+		GetNodeBounds(Level, X, Z, &MinX, &MinZ, &Size);
+
+		// Distance from the camera to the node's square lifted to the terrain's height at its center
+		const auto CameraX = XMVectorGetX(CameraPosition);
+		const auto CameraZ = XMVectorGetZ(CameraPosition);
+		const auto DeltaX = std::max({ MinX - CameraX, 0.0f, CameraX - (MinX + Size) });
+		const auto DeltaZ = std::max({ MinZ - CameraZ, 0.0f, CameraZ - (MinZ + Size) });
+		const auto DeltaY = XMVectorGetY(CameraPosition) - HeightFunction(MinX + 0.5f*Size, MinZ + 0.5f*Size);
+		const auto Distance = sqrtf(DeltaX*DeltaX + DeltaY*DeltaY + DeltaZ*DeltaZ);
+
+		const auto Key = MakeTileKey(Level, X, Z);
+		const auto TileIter = ResidentTiles.find(Key);
+		const auto Tile = TileIter != ResidentTiles.end() ? TileIter->second.get() : nullptr;
+
+		if (Level < Settings.MaxDepth && Distance < Size*Settings.LODDistanceFactor)
+		{
+			const auto NumSelectedTiles = SelectedTiles.size();
+
+			auto bIsCovered = true;
+			for (uint32 iChild = 0; iChild < 4; ++iChild)
+			{
+				bIsCovered &= SelectTiles(Level + 1, 2 * X + (iChild & 1), 2 * Z + (iChild >> 1), CameraPosition);
+			}
+
+			if (bIsCovered)
+			{
+				return true;
+			}
+
+			// Children aren't generated yet, so the node is drawn instead of them
+			if (Tile != nullptr)
+			{
+				SelectedTiles.resize(NumSelectedTiles);
+				UseTile(Tile);
+				return true;
+			}
+
+			return false;
+		}
+
+		if (Tile != nullptr)
+		{
+			UseTile(Tile);
+			return true;
+		}
+
+		if (PendingTiles.find(Key) == PendingTiles.end())
+		{
+			TileRequests.push_back({ Key, Distance });
+		}
+
+		// The camera moved away, so resident children are drawn until the coarser tile is generated
+		return Level < Settings.MaxDepth && SelectResidentChildren(Level, X, Z);
+	}
+
+	bool FTerrain::SelectResidentChildren(uint8 Level, uint32 X, uint32 Z)
+	{
+		const auto NumSelectedTiles = SelectedTiles.size();
+		for (uint32 iChild = 0; iChild < 4; ++iChild)
+		{
+			const auto ChildLevel = static_cast<uint8>(Level + 1);
+			const auto ChildX = 2 * X + (iChild & 1);
+			const auto ChildZ = 2 * Z + (iChild >> 1);
+
+			const auto TileIter = ResidentTiles.find(MakeTileKey(ChildLevel, ChildX, ChildZ));
+			if (TileIter != ResidentTiles.end())
+			{
+				UseTile(TileIter->second.get());
+				continue;
+			}
+
+			// Fails at the first uncovered leaf, so subtrees without resident tiles aren't walked
+			if (ChildLevel >= Settings.MaxDepth || !SelectResidentChildren(ChildLevel, ChildX, ChildZ))
+			{
+				SelectedTiles.resize(NumSelectedTiles);
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void FTerrain::UseTile(FTerrainTile* Tile) noexcept
+	{
+		Tile->LastUsedFrame = iFrame;
+		SelectedTiles.push_back(Tile);
+	}
+
+	void FTerrain::RequestTiles()
+	{
+		// Closest tiles first
+		std::sort(TileRequests.begin(), TileRequests.end(), [](const FTileRequest& Request0, const FTileRequest& Request1)
+		{
+			if (Request0.Distance != Request1.Distance)
+			{
+				return Request0.Distance < Request1.Distance;
+			}
+			return Request0.Key < Request1.Key;
+		});
+
+		for (const auto& Request : TileRequests)
+		{
+			if (PendingTiles.size() >= Settings.MaxNumPendingTiles)
+			{
+				break;
+			}
+
+			const auto Level = static_cast<uint8>(Request.Key >> 56);
+			const auto X = static_cast<uint32>((Request.Key >> 28) & 0xFFFFFFF);
+			const auto Z = static_cast<uint32>(Request.Key & 0xFFFFFFF);
+
+			float MinX, MinZ, Size;
+			GetNodeBounds(Level, X, Z, &MinX, &MinZ, &Size);
+
+			const auto TileSettings = Settings;
+			const auto TileHeightFunction = HeightFunction;
+
+			PendingTiles[Request.Key] = Concurrency::create_task([TileSettings, TileHeightFunction, MinX, MinZ, Size]()
+			{
+				const auto StartTime = std::chrono::high_resolution_clock::now();
+
+				FGeneratedTile GeneratedTile;
+				GeneratedTile.MeshData = GenerateTileMesh(TileSettings, TileHeightFunction, MinX, MinZ, Size);
+
+				const std::chrono::duration<double> GenerationTime = 
+					std::chrono::high_resolution_clock::now() - StartTime;
+				GeneratedTile.GenerationSeconds = GenerationTime.count();
+
+				return GeneratedTile;
+			});
+		}
+	}
+
+	void FTerrain::CollectGeneratedTiles(bool bWait)
+	{
+		for (auto PendingTileIter = PendingTiles.begin(); PendingTileIter != PendingTiles.end(); )
+		{
+			auto& Task = PendingTileIter->second;
+			if (!bWait && !Task.is_done())
+			{
+				++PendingTileIter;
+				continue;
+			}
+
+			const auto GeneratedTile = Task.get();
+			const auto Key = PendingTileIter->first;
+
+			auto Tile = std::make_unique<FTerrainTile>();
+			Tile->Key = Key;
+			Tile->Level = static_cast<uint8>(Key >> 56);
+			GetNodeBounds(Tile->Level, (Key >> 28) & 0xFFFFFFF, Key & 0xFFFFFFF, &Tile->MinX, &Tile->MinZ, &Tile->Size);
+			Tile->MeshData = GeneratedTile.MeshData;
+			Tile->NumBytes = 
+				Tile->MeshData->Vertices.size()*sizeof(FVertex) + 
+				Tile->MeshData->Indices.size()*sizeof(uint32);
+
+			Stats.NumResidentBytes += Tile->NumBytes;
+			Stats.PeakNumResidentBytes = std::max(Stats.PeakNumResidentBytes, Stats.NumResidentBytes);
+
+			++Stats.NumGeneratedTiles;
+			Stats.GenerationSeconds += GeneratedTile.GenerationSeconds;
+			Stats.TilesPerSecond = Stats.NumGeneratedTiles / std::max(Stats.GenerationSeconds, 1e-9);
+
+			ResidentTiles[Key] = std::move(Tile);
+			PendingTileIter = PendingTiles.erase(PendingTileIter);
+		}
+	}
+
+	void FTerrain::EvictTiles()
+	{
+		// Pending tiles become resident soon, so their memory is reserved now
+		const auto NumPendingBytes = PendingTiles.size()*GetTileNumBytes(Settings);
+		while (Stats.NumResidentBytes + NumPendingBytes > Settings.MemoryBudget)
+		{
+			// Least recently used tile, which isn't selected now
+			auto EvictedTileIter = ResidentTiles.end();
+			for (auto TileIter = ResidentTiles.begin(); TileIter != ResidentTiles.end(); ++TileIter)
+			{
+				const auto& Tile = *TileIter->second;
+				if (Tile.LastUsedFrame == iFrame)
+				{
+					continue;
+				}
+
+				if (EvictedTileIter == ResidentTiles.end() || 
+					Tile.LastUsedFrame < EvictedTileIter->second->LastUsedFrame ||
+					(Tile.LastUsedFrame == EvictedTileIter->second->LastUsedFrame && Tile.Key < EvictedTileIter->first))
+				{
+					EvictedTileIter = TileIter;
+				}
+			}
+
+			if (EvictedTileIter == ResidentTiles.end())
+			{
+				break;
+			}
+
+			Stats.NumResidentBytes -= EvictedTileIter->second->NumBytes;
+			++Stats.NumEvictedTiles;
+			ResidentTiles.erase(EvictedTileIter);
+		}
+	}
+}
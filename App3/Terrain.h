@@ -0,0 +1,225 @@
+#pragma once
+
+#include <functional>
+#include <unordered_map>
+#include <ppltasks.h>
+
+#include "MeshData.h"
+
+namespace WoodenEngine
+{
+	// Height of terrain at world (X, Z)
+	using FHeightFunction = std::function<float(float X, float Z)>;
+
+	/*!
+	 * \struct FTerrainSettings
+	 *
+	 * \brief Layout, LOD and memory settings of streamed terrain
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FTerrainSettings
+	{
+		// Side of the square world centered at the origin
+		float WorldSize = 4096.0f;
+
+		// Number of vertices per tile's side
+		uint32 TileResolution = 33;
+
+		// Max depth of the quadtree. Tiles of the deepest level have size WorldSize / 2^MaxDepth
+		uint8 MaxDepth = 7;
+
+		// A node is split while the camera is closer to it than NodeSize * LODDistanceFactor
+		float LODDistanceFactor = 1.5f;
+
+		// Depth of skirts hiding cracks between tiles of different levels, relative to tile's size
+		float SkirtDepthFactor = 0.05f;
+
+		// Max memory of resident and pending tiles. Least recently used tiles are evicted above it.
+		// Selected tiles are never evicted, so it should fit GetMaxNumSelectedTiles() + MaxNumPendingTiles tiles
+		uint64 MemoryBudget = 64 * 1024 * 1024;
+
+		// Max number of tiles generated by worker threads at the same time
+		uint32 MaxNumPendingTiles = 16;
+	};
+
+	/*!
+	 * \struct FTerrainTile
+	 *
+	 * \brief Generated quadtree node of terrain
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FTerrainTile
+	{
+		uint64 Key = 0;
+
+		uint8 Level = 0;
+		float MinX = 0.0f;
+		float MinZ = 0.0f;
+		float Size = 0.0f;
+
+		// Grid vertices and skirts in world space
+		std::shared_ptr<FMeshRawData> MeshData;
+
+		uint64 NumBytes = 0;
+
+		// Number of the last update which selected the tile
+		uint64 LastUsedFrame = 0;
+	};
+
+	/*!
+	 * \struct FTerrainStats
+	 *
+	 * \brief Generation, selection and memory statistics of terrain
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FTerrainStats
+	{
+		uint64 NumGeneratedTiles = 0;
+		uint64 NumEvictedTiles = 0;
+
+		uint32 NumResidentTiles = 0;
+		uint32 NumPendingTiles = 0;
+		uint32 NumSelectedTiles = 0;
+
+		uint64 NumResidentBytes = 0;
+		uint64 PeakNumResidentBytes = 0;
+
+		// Sum of generation time of all worker threads
+		double GenerationSeconds = 0.0;
+
+		// Generated tiles per second of one worker thread
+		double TilesPerSecond = 0.0;
+	};
+
+	/*!
+	 * \class FTerrain
+	 *
+	 * \brief Terrain split to a quadtree of tiles with distance-based LOD.
+	 * Tiles are generated by worker threads on demand and evicted by LRU over the memory budget.
+	 * It doesn't depend on the device, so selected tiles are uploaded by the renderer
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FTerrain
+	{
+	public:
+		FTerrain(
+			const FTerrainSettings& Settings, 
+			FHeightFunction HeightFunction = &FMeshGenerator::GetLandscapeHeight);
+
+		~FTerrain();
+
+		FTerrain& operator=(const FTerrain& Terrain) = delete;
+		FTerrain(const FTerrain& Terrain) = delete;
+		FTerrain(FTerrain&& Terrain) = delete;
+
+		/** @brief Collects finished tiles, selects tiles for the camera,
+		  * requests missing tiles and evicts unused ones over the budget
+		  * @param CameraPosition (const XMFLOAT3 &)
+		  * @return (void)
+		  */
+		void Update(const XMFLOAT3& CameraPosition);
+
+		/** @brief Waits for all requested tiles and makes them resident
+		  * @return (void)
+		  */
+		void WaitForPendingTiles();
+
+		/** @brief Returns tiles covering the world for the last update's camera.
+		  * Parent tiles replace children which aren't generated yet
+		  * @return (const std::vector<const FTerrainTile*>&)
+		  */
+		const std::vector<const FTerrainTile*>& GetSelectedTiles() const noexcept;
+
+		const FTerrainStats& GetStats() const noexcept;
+
+		const FTerrainSettings& GetSettings() const noexcept;
+
+		/** @brief Generates tile's grid with skirts. Normals are computed by central differences
+		  * @param Settings (const FTerrainSettings &)
+		  * @param HeightFunction (const FHeightFunction &)
+		  * @param MinX (float)
+		  * @param MinZ (float)
+		  * @param Size Tile's side (float)
+		  * @return (std::unique_ptr<WoodenEngine::FMeshRawData>)
+		  */
+		static std::unique_ptr<FMeshRawData> GenerateTileMesh(
+			const FTerrainSettings& Settings,
+			const FHeightFunction& HeightFunction,
+			float MinX,
+			float MinZ,
+			float Size);
+
+		/** @brief Returns memory of a generated tile. All tiles have the same grid
+		  * @param Settings (const FTerrainSettings &)
+		  * @return (uint64)
+		  */
+		static uint64 GetTileNumBytes(const FTerrainSettings& Settings) noexcept;
+
+		/** @brief Returns max number of tiles selected for any camera position.
+		  * Nodes of a level which are split are within NodeSize * LODDistanceFactor of the camera,
+		  * so there are at most (ceil(2 * LODDistanceFactor) + 1)^2 of them, and every split adds 3 tiles
+		  * @param Settings (const FTerrainSettings &)
+		  * @return (uint32)
+		  */
+		static uint32 GetMaxNumSelectedTiles(const FTerrainSettings& Settings) noexcept;
+
+	private:
+		struct FGeneratedTile
+		{
+			std::shared_ptr<FMeshRawData> MeshData;
+			double GenerationSeconds;
+		};
+
+		struct FTileRequest
+		{
+			uint64 Key;
+			float Distance;
+		};
+
+		static uint64 MakeTileKey(uint8 Level, uint32 X, uint32 Z) noexcept;
+
+		/** @brief Selects resident tiles of the node's subtree
+		  * @return True if the node's area is fully covered by selected tiles (bool)
+		  */
+		bool SelectTiles(uint8 Level, uint32 X, uint32 Z, FXMVECTOR CameraPosition);
+
+		/** @brief Selects resident descendants of the node if they cover its whole area
+		  * @return True if they're selected (bool)
+		  */
+		bool SelectResidentChildren(uint8 Level, uint32 X, uint32 Z);
+
+		void GetNodeBounds(uint8 Level, uint32 X, uint32 Z, float* MinX, float* MinZ, float* Size) const noexcept;
+
+		void UseTile(FTerrainTile* Tile) noexcept;
+
+		void RequestTiles();
+
+		void CollectGeneratedTiles(bool bWait);
+
+		void EvictTiles();
+
+		FTerrainSettings Settings;
+
+		FHeightFunction HeightFunction;
+
+		std::unordered_map<uint64, std::unique_ptr<FTerrainTile>> ResidentTiles;
+
+		std::unordered_map<uint64, Concurrency::task<FGeneratedTile>> PendingTiles;
+
+		std::vector<FTileRequest> TileRequests;
+
+		std::vector<const FTerrainTile*> SelectedTiles;
+
+		FTerrainStats Stats;
+
+		uint64 iFrame = 0;
+	};
+}
@@ -0,0 +1,574 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "TextureAtlas.h"
+
+namespace WoodenEngine
+{
+	namespace
+	{
+		/** @brief Returns texels of a block and its size for formats whose blocks can be copied
+		  * @param Format (DXGI_FORMAT)
+		  * @param BlockSize (uint32 &)
+		  * @param BytesPerBlock (uint32 &)
+		  * @return False if the format isn't supported by atlases (bool)
+		  */
+		bool GetBlockInfo(DXGI_FORMAT Format, uint32& BlockSize, uint32& BytesPerBlock)
+		{
+			switch (Format)
+			{
+			case DXGI_FORMAT_BC1_UNORM:
+			case DXGI_FORMAT_BC1_UNORM_SRGB:
+			case DXGI_FORMAT_BC4_UNORM:
+			case DXGI_FORMAT_BC4_SNORM:
+				BlockSize = 4;
+				BytesPerBlock = 8;
+				return true;
+			case DXGI_FORMAT_BC2_UNORM:
+			case DXGI_FORMAT_BC2_UNORM_SRGB:
+			case DXGI_FORMAT_BC3_UNORM:
+			case DXGI_FORMAT_BC3_UNORM_SRGB:
+			case DXGI_FORMAT_BC5_UNORM:
+			case DXGI_FORMAT_BC5_SNORM:
+			case DXGI_FORMAT_BC6H_UF16:
+			case DXGI_FORMAT_BC6H_SF16:
+			case DXGI_FORMAT_BC7_UNORM:
+			case DXGI_FORMAT_BC7_UNORM_SRGB:
+				BlockSize = 4;
+				BytesPerBlock = 16;
+				return true;
+			case DXGI_FORMAT_R8G8B8A8_UNORM:
+			case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+			case DXGI_FORMAT_B8G8R8A8_UNORM:
+			case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+			case DXGI_FORMAT_B8G8R8X8_UNORM:
+			case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+				BlockSize = 1;
+				BytesPerBlock = 4;
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		/** @brief Returns true if the format is 8-bit BGRA
+		  * @param Format (DXGI_FORMAT)
+		  * @return (bool)
+		  */
+		bool IsBGRA(DXGI_FORMAT Format)
+		{
+			return Format == DXGI_FORMAT_B8G8R8A8_UNORM || Format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
+				Format == DXGI_FORMAT_B8G8R8X8_UNORM || Format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+		}
+
+		/** @brief Returns true if the format is 8-bit RGBA
+		  * @param Format (DXGI_FORMAT)
+		  * @return (bool)
+		  */
+		bool IsRGBA(DXGI_FORMAT Format)
+		{
+			return Format == DXGI_FORMAT_R8G8B8A8_UNORM || Format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+		}
+
+		/** @brief Returns true if a solid color can be encoded to a block of the format
+		  * @param Format (DXGI_FORMAT)
+		  * @return (bool)
+		  */
+		bool CanEncodeSolidBlock(DXGI_FORMAT Format)
+		{
+			switch (Format)
+			{
+			case DXGI_FORMAT_BC1_UNORM:
+			case DXGI_FORMAT_BC1_UNORM_SRGB:
+			case DXGI_FORMAT_BC2_UNORM:
+			case DXGI_FORMAT_BC2_UNORM_SRGB:
+			case DXGI_FORMAT_BC3_UNORM:
+			case DXGI_FORMAT_BC3_UNORM_SRGB:
+				return true;
+			default:
+				return IsRGBA(Format) || IsBGRA(Format);
+			}
+		}
+
+		/** @brief Writes BC1 color block whose texels are the color
+		  * @param Color RGBA (const uint8 *)
+		  * @param bPunchThrough Texels are transparent black (bool)
+		  * @param Block (uint8 *)
+		  * @return (void)
+		  */
+		void EncodeSolidColorBlock(const uint8* Color, bool bPunchThrough, uint8* Block)
+		{
+			const uint16 Color565 = static_cast<uint16>(
+				((Color[0] * 31 + 127) / 255) << 11 |
+				((Color[1] * 63 + 127) / 255) << 5 |
+				((Color[2] * 31 + 127) / 255));
+
+			// Equal endpoints select 3-color mode, whose index 3 is transparent
+			Block[0] = static_cast<uint8>(Color565 & 0xFF);
+			Block[1] = static_cast<uint8>(Color565 >> 8);
+			Block[2] = Block[0];
+			Block[3] = Block[1];
+			std::memset(Block + 4, bPunchThrough ? 0xFF : 0x00, 4);
+		}
+
+		/** @brief Writes a block of the format whose texels are the color
+		  * @param Format Format for which CanEncodeSolidBlock is true (DXGI_FORMAT)
+		  * @param Color RGBA (const uint8 *)
+		  * @param Block (uint8 *)
+		  * @return (void)
+		  */
+		void EncodeSolidBlock(DXGI_FORMAT Format, const uint8* Color, uint8* Block)
+		{
+			switch (Format)
+			{
+			case DXGI_FORMAT_BC1_UNORM:
+			case DXGI_FORMAT_BC1_UNORM_SRGB:
+				EncodeSolidColorBlock(Color, Color[3] < 128, Block);
+				break;
+			case DXGI_FORMAT_BC2_UNORM:
+			case DXGI_FORMAT_BC2_UNORM_SRGB:
+			{
+				const auto Alpha4 = static_cast<uint8>((Color[3] * 15 + 127) / 255);
+				std::memset(Block, Alpha4 << 4 | Alpha4, 8);
+				EncodeSolidColorBlock(Color, false, Block + 8);
+				break;
+			}
+			case DXGI_FORMAT_BC3_UNORM:
+			case DXGI_FORMAT_BC3_UNORM_SRGB:
+				// Equal endpoints and zero indices
+				Block[0] = Color[3];
+				Block[1] = Color[3];
+				std::memset(Block + 2, 0, 6);
+				EncodeSolidColorBlock(Color, false, Block + 8);
+				break;
+			default:
+				if (IsBGRA(Format))
+				{
+					Block[0] = Color[2];
+					Block[1] = Color[1];
+					Block[2] = Color[0];
+					Block[3] = Color[3];
+				}
+				else
+				{
+					std::memcpy(Block, Color, 4);
+				}
+				break;
+			}
+		}
+	}
+
+	DirectX::XMMATRIX FTextureAtlasEntry::GetUVTransform() const noexcept
+	{
+		return DirectX::XMMatrixScaling(UVScale.x, UVScale.y, 1.0f) *
+			DirectX::XMMatrixTranslation(UVOffset.x, UVOffset.y, 0.0f);
+	}
+
+	FTextureAtlasBuilder::FTextureAtlasBuilder(const FTextureAtlasSettings& Settings):
+		Settings(Settings)
+	{
+		if (Settings.NumMips == 0)
+		{
+			throw std::invalid_argument("Atlas must have mips");
+		}
+	}
+
+	bool FTextureAtlasBuilder::AddTexture(const std::string& Name, const std::string& FilePath)
+	{
+		auto SourceFile = std::make_unique<DX::FMappedFile>(FilePath);
+		if (!AddTexture(Name, SourceFile->GetData(), SourceFile->GetSize()))
+		{
+			return false;
+		}
+
+		SourceFiles.push_back(std::move(SourceFile));
+		return true;
+	}
+
+	bool FTextureAtlasBuilder::AddTexture(const std::string& Name, const uint8* DDSData, uint64 DDSDataSize)
+	{
+		if (Name.empty())
+		{
+			throw std::invalid_argument("Name must be not empty");
+		}
+
+		const auto SameNameIter = std::find_if(SourceTextures.cbegin(), SourceTextures.cend(),
+			[&Name](const FSourceTexture& SourceTexture) { return SourceTexture.Name == Name; });
+		if (SameNameIter != SourceTextures.cend())
+		{
+			throw std::invalid_argument("A texture with the name " + Name + " is added yet");
+		}
+
+		FSourceTexture SourceTexture;
+		SourceTexture.Name = Name;
+		SourceTexture.DDSData = DDSData;
+		if (FAILED(DirectX::GetDDSTextureLayout(DDSData, static_cast<size_t>(DDSDataSize), 0, SourceTexture.Layout)))
+		{
+			throw std::invalid_argument("Texture " + Name + " isn't a valid DDS texture");
+		}
+
+		const auto& Layout = SourceTexture.Layout;
+		if (Layout.resDim != DirectX::DDS_DIMENSION_TEXTURE2D || Layout.arraySize != 1 || Layout.isCubeMap)
+		{
+			return false;
+		}
+
+		if (Layout.width == 1 && Layout.height == 1 && (IsRGBA(Layout.format) || IsBGRA(Layout.format)))
+		{
+			if (Format != DXGI_FORMAT_UNKNOWN && !CanEncodeSolidBlock(Format))
+			{
+				return false;
+			}
+
+			const auto Texel = DDSData + Layout.subresources[0].offset;
+			if (IsBGRA(Layout.format))
+			{
+				SourceTexture.SolidColor[0] = Texel[2];
+				SourceTexture.SolidColor[1] = Texel[1];
+				SourceTexture.SolidColor[2] = Texel[0];
+				SourceTexture.SolidColor[3] = Layout.format == DXGI_FORMAT_B8G8R8A8_UNORM ||
+					Layout.format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ? Texel[3] : 255;
+			}
+			else
+			{
+				std::memcpy(SourceTexture.SolidColor, Texel, 4);
+			}
+
+			SourceTexture.bSolid = true;
+		}
+		else
+		{
+			uint32 TextureBlockSize = 0;
+			uint32 TextureBytesPerBlock = 0;
+			if (!GetBlockInfo(Layout.format, TextureBlockSize, TextureBytesPerBlock))
+			{
+				return false;
+			}
+
+			if (Format == DXGI_FORMAT_UNKNOWN)
+			{
+				const auto bHasSolidTextures = std::any_of(SourceTextures.cbegin(), SourceTextures.cend(),
+					[](const FSourceTexture& Texture) { return Texture.bSolid; });
+				if (bHasSolidTextures && !CanEncodeSolidBlock(Layout.format))
+				{
+					return false;
+				}
+			}
+			else if (Layout.format != Format)
+			{
+				return false;
+			}
+
+			// Every mip of the texture must consist of whole blocks
+			const auto Alignment = TextureBlockSize << (Settings.NumMips - 1);
+			if (Layout.mipCount < Settings.NumMips || Layout.width % Alignment != 0 || Layout.height % Alignment != 0)
+			{
+				return false;
+			}
+
+			Format = Layout.format;
+			BlockSize = TextureBlockSize;
+			BytesPerBlock = TextureBytesPerBlock;
+		}
+
+		SourceTextures.push_back(std::move(SourceTexture));
+		Entries.clear();
+
+		return true;
+	}
+
+	bool FTextureAtlasBuilder::Pack()
+	{
+		Entries.clear();
+		if (SourceTextures.empty())
+		{
+			return false;
+		}
+
+		// Solid textures only
+		if (Format == DXGI_FORMAT_UNKNOWN)
+		{
+			Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+			BlockSize = 1;
+			BytesPerBlock = 4;
+		}
+
+		// Solid textures are one block of the last mip and don't need guard bands
+		const auto Alignment = GetAlignment();
+		const auto GetPaddedWidth = [Alignment](const FSourceTexture& Texture)
+		{
+			return Texture.bSolid ? Alignment : static_cast<uint32>(Texture.Layout.width) + 2 * Alignment;
+		};
+		const auto GetPaddedHeight = [Alignment](const FSourceTexture& Texture)
+		{
+			return Texture.bSolid ? Alignment : static_cast<uint32>(Texture.Layout.height) + 2 * Alignment;
+		};
+
+		// Large rectangles are placed first
+		std::vector<uint32> Order(SourceTextures.size());
+		for (uint32 i = 0; i < Order.size(); ++i)
+		{
+			Order[i] = i;
+		}
+
+		std::sort(Order.begin(), Order.end(), [this, &GetPaddedWidth, &GetPaddedHeight](uint32 A, uint32 B)
+		{
+			const auto& TextureA = SourceTextures[A];
+			const auto& TextureB = SourceTextures[B];
+			return std::max(GetPaddedWidth(TextureA), GetPaddedHeight(TextureA)) >
+				std::max(GetPaddedWidth(TextureB), GetPaddedHeight(TextureB));
+		});
+
+		uint64 PaddedArea = 0;
+		uint32 MinWidth = 0;
+		uint32 MinHeight = 0;
+		for (const auto& Texture : SourceTextures)
+		{
+			PaddedArea += static_cast<uint64>(GetPaddedWidth(Texture))*GetPaddedHeight(Texture);
+			MinWidth = std::max(MinWidth, GetPaddedWidth(Texture));
+			MinHeight = std::max(MinHeight, GetPaddedHeight(Texture));
+		}
+
+		// Sizes are tried from the smallest area. Square atlases are preferred
+		std::vector<std::pair<uint32, uint32>> AtlasSizes;
+		for (auto AtlasWidth = MinWidth; AtlasWidth <= Settings.MaxSize; AtlasWidth += Alignment)
+		{
+			for (auto AtlasHeight = MinHeight; AtlasHeight <= Settings.MaxSize; AtlasHeight += Alignment)
+			{
+				if (static_cast<uint64>(AtlasWidth)*AtlasHeight >= PaddedArea)
+				{
+					AtlasSizes.emplace_back(AtlasWidth, AtlasHeight);
+				}
+			}
+		}
+
+		std::sort(AtlasSizes.begin(), AtlasSizes.end(),
+			[](const std::pair<uint32, uint32>& A, const std::pair<uint32, uint32>& B)
+		{
+			const auto AreaA = static_cast<uint64>(A.first)*A.second;
+			const auto AreaB = static_cast<uint64>(B.first)*B.second;
+			if (AreaA != AreaB)
+			{
+				return AreaA < AreaB;
+			}
+
+			return std::max(A.first, A.second) < std::max(B.first, B.second);
+		});
+
+		for (const auto& AtlasSize : AtlasSizes)
+		{
+			FMaxRectsPacker Packer(AtlasSize.first, AtlasSize.second);
+			std::vector<FPackedRect> PackedRects(SourceTextures.size());
+
+			auto bPacked = true;
+			for (auto iTexture : Order)
+			{
+				const auto& Texture = SourceTextures[iTexture];
+				if (!Packer.Insert(GetPaddedWidth(Texture), GetPaddedHeight(Texture), PackedRects[iTexture]))
+				{
+					bPacked = false;
+					break;
+				}
+			}
+
+			if (!bPacked)
+			{
+				continue;
+			}
+
+			Width = AtlasSize.first;
+			Height = AtlasSize.second;
+
+			uint64 TexturesArea = 0;
+			for (uint32 iTexture = 0; iTexture < SourceTextures.size(); ++iTexture)
+			{
+				const auto& Texture = SourceTextures[iTexture];
+				const auto& PackedRect = PackedRects[iTexture];
+
+				FTextureAtlasEntry Entry;
+				Entry.Name = Texture.Name;
+				Entry.bSolid = Texture.bSolid;
+				Entry.Rect = PackedRect;
+
+				if (Texture.bSolid)
+				{
+					Entry.UVScale = { 0.0f, 0.0f };
+					Entry.UVOffset = {
+						(PackedRect.X + 0.5f*PackedRect.Width) / Width,
+						(PackedRect.Y + 0.5f*PackedRect.Height) / Height };
+				}
+				else
+				{
+					Entry.Rect.X += Alignment;
+					Entry.Rect.Y += Alignment;
+					Entry.Rect.Width = static_cast<uint32>(Texture.Layout.width);
+					Entry.Rect.Height = static_cast<uint32>(Texture.Layout.height);
+
+					Entry.UVScale = {
+						static_cast<float>(Entry.Rect.Width) / Width,
+						static_cast<float>(Entry.Rect.Height) / Height };
+					Entry.UVOffset = {
+						static_cast<float>(Entry.Rect.X) / Width,
+						static_cast<float>(Entry.Rect.Y) / Height };
+				}
+
+				TexturesArea += static_cast<uint64>(Entry.Rect.Width)*Entry.Rect.Height;
+				Entries.push_back(std::move(Entry));
+			}
+
+			Occupancy = static_cast<float>(static_cast<double>(TexturesArea) / (static_cast<double>(Width)*Height));
+			return true;
+		}
+
+		return false;
+	}
+
+	std::vector<uint8> FTextureAtlasBuilder::Build() const
+	{
+		if (Entries.empty())
+		{
+			throw std::invalid_argument("Textures must be packed before building the atlas");
+		}
+
+		std::vector<size_t> MipSizes(Settings.NumMips);
+		std::vector<size_t> MipRowPitches(Settings.NumMips);
+		size_t DataSize = 0;
+		for (uint32 iMip = 0; iMip < Settings.NumMips; ++iMip)
+		{
+			size_t NumRows = 0;
+			DirectX::GetSurfaceInfo(Width >> iMip, Height >> iMip, Format,
+				&MipSizes[iMip], &MipRowPitches[iMip], &NumRows);
+			DataSize += MipSizes[iMip];
+		}
+
+		const auto Headers = DirectX::CreateDDSHeaders(Format, Width, Height, Settings.NumMips);
+		DataSize += Headers.size();
+
+		std::vector<uint8> Data(DataSize, 0);
+		std::memcpy(Data.data(), Headers.data(), Headers.size());
+
+		auto DataIter = Data.data() + Headers.size();
+
+		for (uint32 iMip = 0; iMip < Settings.NumMips; ++iMip)
+		{
+			for (uint32 iTexture = 0; iTexture < SourceTextures.size(); ++iTexture)
+			{
+				const auto& Texture = SourceTextures[iTexture];
+				if (Texture.bSolid)
+				{
+					FillMip(Texture, Entries[iTexture], iMip, DataIter, MipRowPitches[iMip]);
+				}
+				else
+				{
+					CopyMip(Texture, Entries[iTexture], iMip, DataIter, MipRowPitches[iMip]);
+				}
+			}
+
+			DataIter += MipSizes[iMip];
+		}
+
+		return Data;
+	}
+
+	bool FTextureAtlasBuilder::HasEntry(const std::string& Name) const noexcept
+	{
+		return std::any_of(Entries.cbegin(), Entries.cend(),
+			[&Name](const FTextureAtlasEntry& Entry) { return Entry.Name == Name; });
+	}
+
+	const FTextureAtlasEntry& FTextureAtlasBuilder::GetEntry(const std::string& Name) const
+	{
+		const auto EntryIter = std::find_if(Entries.cbegin(), Entries.cend(),
+			[&Name](const FTextureAtlasEntry& Entry) { return Entry.Name == Name; });
+		if (EntryIter == Entries.cend())
+		{
+			throw std::invalid_argument("Texture " + Name + " isn't packed to the atlas");
+		}
+
+		return *EntryIter;
+	}
+
+	uint32 FTextureAtlasBuilder::GetWidth() const noexcept
+	{
+		return Width;
+	}
+
+	uint32 FTextureAtlasBuilder::GetHeight() const noexcept
+	{
+		return Height;
+	}
+
+	DXGI_FORMAT FTextureAtlasBuilder::GetFormat() const noexcept
+	{
+		return Format;
+	}
+
+	float FTextureAtlasBuilder::GetOccupancy() const noexcept
+	{
+		return Occupancy;
+	}
+
+	void FTextureAtlasBuilder::CopyMip(
+		const FSourceTexture& Source,
+		const FTextureAtlasEntry& Entry,
+		uint32 Mip,
+		uint8* MipData,
+		uint64 MipRowPitch) const
+	{
+		const auto& SourceMip = Source.Layout.subresources[Mip];
+		const auto SourceData = Source.DDSData + SourceMip.offset;
+
+		const auto NumBlocksX = static_cast<uint32>(Source.Layout.width >> Mip) / BlockSize;
+		const auto NumBlocksY = static_cast<uint32>(Source.Layout.height >> Mip) / BlockSize;
+		const auto NumGuardBlocks = (GetAlignment() >> Mip) / BlockSize;
+
+		const auto FirstBlockX = (Entry.Rect.X >> Mip) / BlockSize - NumGuardBlocks;
+		const auto FirstBlockY = (Entry.Rect.Y >> Mip) / BlockSize - NumGuardBlocks;
+
+		// Guard bands repeat the opposite edges of the texture
+		for (uint32 iBlockY = 0; iBlockY < NumBlocksY + 2 * NumGuardBlocks; ++iBlockY)
+		{
+			const auto iSourceBlockY = (iBlockY + NumBlocksY - NumGuardBlocks) % NumBlocksY;
+			const auto SourceRow = SourceData + iSourceBlockY*SourceMip.rowPitch;
+			auto Row = MipData + (FirstBlockY + iBlockY)*MipRowPitch + FirstBlockX*BytesPerBlock;
+
+			for (uint32 iBlockX = 0; iBlockX < NumBlocksX + 2 * NumGuardBlocks; ++iBlockX)
+			{
+				const auto iSourceBlockX = (iBlockX + NumBlocksX - NumGuardBlocks) % NumBlocksX;
+				std::memcpy(Row + iBlockX*BytesPerBlock, SourceRow + iSourceBlockX*BytesPerBlock, BytesPerBlock);
+			}
+		}
+	}
+
+	void FTextureAtlasBuilder::FillMip(
+		const FSourceTexture& Source,
+		const FTextureAtlasEntry& Entry,
+		uint32 Mip,
+		uint8* MipData,
+		uint64 MipRowPitch) const
+	{
+		uint8 Block[16];
+		EncodeSolidBlock(Format, Source.SolidColor, Block);
+
+		const auto NumBlocksX = (Entry.Rect.Width >> Mip) / BlockSize;
+		const auto NumBlocksY = (Entry.Rect.Height >> Mip) / BlockSize;
+		const auto FirstBlockX = (Entry.Rect.X >> Mip) / BlockSize;
+		const auto FirstBlockY = (Entry.Rect.Y >> Mip) / BlockSize;
+
+		for (uint32 iBlockY = 0; iBlockY < NumBlocksY; ++iBlockY)
+		{
+			auto Row = MipData + (FirstBlockY + iBlockY)*MipRowPitch + FirstBlockX*BytesPerBlock;
+			for (uint32 iBlockX = 0; iBlockX < NumBlocksX; ++iBlockX)
+			{
+				std::memcpy(Row + iBlockX*BytesPerBlock, Block, BytesPerBlock);
+			}
+		}
+	}
+
+	uint32 FTextureAtlasBuilder::GetAlignment() const noexcept
+	{
+		return BlockSize << (Settings.NumMips - 1);
+	}
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "pch.h"
+#include "Common/DDSLayout.h"
+#include "Common/MappedFile.h"
+#include "RectPacker.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FTextureAtlasSettings
+	 *
+	 * \brief Settings of texture atlases
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FTextureAtlasSettings
+	{
+		// Max width and height of the atlas
+		uint32 MaxSize = 4096;
+
+		// Mips of the atlas. Textures with less mips aren't packed.
+		// Guard bands are as wide as one block of the last mip, so coarser mips would bleed
+		uint32 NumMips = 5;
+	};
+
+	/*!
+	 * \struct FTextureAtlasEntry
+	 *
+	 * \brief Texture packed to the atlas
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FTextureAtlasEntry
+	{
+		std::string Name;
+
+		// Texels of the texture in the most detailed mip of the atlas. Guard bands are around it
+		FPackedRect Rect;
+
+		// Texture coordinates of the texture in [0, 1] are mapped to UV*UVScale + UVOffset of the atlas
+		DirectX::XMFLOAT2 UVScale = { 1.0f, 1.0f };
+		DirectX::XMFLOAT2 UVOffset = { 0.0f, 0.0f };
+
+		// 1x1 textures are solid blocks sampled at their centers
+		bool bSolid = false;
+
+		/** @brief Returns transform of texture coordinates, which is appended to a material's one
+		  * @return (DirectX::XMMATRIX)
+		  */
+		DirectX::XMMATRIX GetUVTransform() const noexcept;
+	};
+
+	/*!
+	 * \class FTextureAtlasBuilder
+	 *
+	 * \brief Packs 2D textures of the same format to one atlas, so objects with different textures
+	 * are drawn with the same descriptor table. Rectangles are aligned by the block of the last mip,
+	 * so every mip is packed by copying compressed blocks without recompression. Textures are surrounded
+	 * by guard bands with their own wrapped texels, so filtering near edges matches wrap sampling.
+	 * Textures which are tiled by their materials can't be packed: coordinates out of [0, 1] leave the rectangle
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FTextureAtlasBuilder
+	{
+	public:
+		explicit FTextureAtlasBuilder(const FTextureAtlasSettings& Settings = FTextureAtlasSettings());
+		~FTextureAtlasBuilder() = default;
+
+		FTextureAtlasBuilder& operator=(const FTextureAtlasBuilder& TextureAtlasBuilder) = delete;
+		FTextureAtlasBuilder(const FTextureAtlasBuilder& TextureAtlasBuilder) = delete;
+		FTextureAtlasBuilder(FTextureAtlasBuilder&& TextureAtlasBuilder) = delete;
+
+		/** @brief Maps the DDS file and adds it to the atlas. The file is kept mapped until the builder is destroyed
+		  * @param Name (const std::string &)
+		  * @param FilePath (const std::string &)
+		  * @return False if the texture can't be packed with already added ones (bool)
+		  */
+		bool AddTexture(const std::string& Name, const std::string& FilePath);
+
+		/** @brief Adds the DDS texture to the atlas. Data must be alive until the atlas is built
+		  * @param Name (const std::string &)
+		  * @param DDSData Whole DDS file (const uint8 *)
+		  * @param DDSDataSize (uint64)
+		  * @return False if the texture can't be packed with already added ones (bool)
+		  */
+		bool AddTexture(const std::string& Name, const uint8* DDSData, uint64 DDSDataSize);
+
+		/** @brief Places added textures to the smallest atlas. Only headers of textures are read
+		  * @return False if they don't fit MaxSize (bool)
+		  */
+		bool Pack();
+
+		/** @brief Copies mips of packed textures and their guard bands to the atlas
+		  * @return Whole DDS file of the atlas (std::vector<uint8>)
+		  */
+		std::vector<uint8> Build() const;
+
+		/** @brief Returns true if the texture is packed
+		  * @param Name (const std::string &)
+		  * @return (bool)
+		  */
+		bool HasEntry(const std::string& Name) const noexcept;
+
+		/** @brief Returns placement of the packed texture
+		  * @param Name (const std::string &)
+		  * @return (const WoodenEngine::FTextureAtlasEntry&)
+		  */
+		const FTextureAtlasEntry& GetEntry(const std::string& Name) const;
+
+		uint32 GetWidth() const noexcept;
+
+		uint32 GetHeight() const noexcept;
+
+		DXGI_FORMAT GetFormat() const noexcept;
+
+		/** @brief Returns ratio of textures' texels to texels of the atlas. Guard bands are wasted
+		  * @return (float)
+		  */
+		float GetOccupancy() const noexcept;
+
+	private:
+		struct FSourceTexture
+		{
+			std::string Name;
+
+			const uint8* DDSData = nullptr;
+			DirectX::DDS_TEXTURE_LAYOUT Layout;
+
+			// RGBA of 1x1 textures
+			bool bSolid = false;
+			uint8 SolidColor[4] = { 0, 0, 0, 0 };
+		};
+
+		/** @brief Copies the texture's mip with wrapped guard bands to the atlas' mip
+		  * @param Source (const FSourceTexture &)
+		  * @param Entry (const FTextureAtlasEntry &)
+		  * @param Mip (uint32)
+		  * @param MipData Atlas' mip (uint8 *)
+		  * @param MipRowPitch (uint64)
+		  * @return (void)
+		  */
+		void CopyMip(
+			const FSourceTexture& Source,
+			const FTextureAtlasEntry& Entry,
+			uint32 Mip,
+			uint8* MipData,
+			uint64 MipRowPitch) const;
+
+		/** @brief Fills the solid texture's rectangle in the atlas' mip
+		  * @param Source (const FSourceTexture &)
+		  * @param Entry (const FTextureAtlasEntry &)
+		  * @param Mip (uint32)
+		  * @param MipData Atlas' mip (uint8 *)
+		  * @param MipRowPitch (uint64)
+		  * @return (void)
+		  */
+		void FillMip(
+			const FSourceTexture& Source,
+			const FTextureAtlasEntry& Entry,
+			uint32 Mip,
+			uint8* MipData,
+			uint64 MipRowPitch) const;
+
+		/** @brief Width of guard bands and alignment of rectangles in texels of the most detailed mip
+		  * @return (uint32)
+		  */
+		uint32 GetAlignment() const noexcept;
+
+		FTextureAtlasSettings Settings;
+
+		std::vector<std::unique_ptr<DX::FMappedFile>> SourceFiles;
+
+		std::vector<FSourceTexture> SourceTextures;
+
+		std::vector<FTextureAtlasEntry> Entries;
+
+		// Format of the first texture which isn't solid
+		DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+
+		// Texels of a block of the format and its size
+		uint32 BlockSize = 1;
+		uint32 BytesPerBlock = 4;
+
+		uint32 Width = 0;
+		uint32 Height = 0;
+
+		float Occupancy = 0.0f;
+	};
+}
@@ -0,0 +1,400 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ppl.h>
+#include <stdexcept>
+
+#include "TextureBuilder.h"
+#include "Common/DDSLayout.h"
+
+namespace WoodenEngine
+{
+	using namespace DirectX;
+
+	namespace
+	{
+		// Source texels which are filtered to a texel of the next mip by the Kaiser filter, per axis
+		constexpr int32 NumKaiserTaps = 6;
+
+		// Radius of the Kaiser window in source texels and its shape
+		constexpr float KaiserRadius = 3.0f;
+		constexpr float KaiserAlpha = 4.0f;
+
+		constexpr float Pi = 3.14159265358979f;
+
+		/*!
+		 * \struct FLinearImage
+		 *
+		 * \brief RGBA texels in linear space
+		 *
+		 * \author devmi
+		 * \date October 2018
+		 */
+		struct FLinearImage
+		{
+			uint32 Width = 0;
+			uint32 Height = 0;
+			std::vector<XMFLOAT4> Texels;
+		};
+
+		const std::array<float, 256>& GetSRGBToLinearTable()
+		{
+			static const auto Table = []()
+			{
+				std::array<float, 256> Values;
+				for (uint32 iValue = 0; iValue < Values.size(); ++iValue)
+				{
+					const auto Value = iValue / 255.0f;
+					Values[iValue] = Value <= 0.04045f ? Value / 12.92f : std::pow((Value + 0.055f) / 1.055f, 2.4f);
+				}
+				return Values;
+			}();
+
+			return Table;
+		}
+
+		uint8 ToUnorm8(float Value)
+		{
+			return static_cast<uint8>(std::max(0.0f, std::min(Value, 1.0f))*255.0f + 0.5f);
+		}
+
+		uint8 LinearToSRGB(float Value)
+		{
+			Value = std::max(0.0f, std::min(Value, 1.0f));
+			return ToUnorm8(Value <= 0.0031308f ? Value*12.92f : 1.055f*std::pow(Value, 1.0f / 2.4f) - 0.055f);
+		}
+
+		/** @brief Modified Bessel function of the first kind of order 0
+		  * @param X (float)
+		  * @return (float)
+		  */
+		float BesselI0(float X)
+		{
+			auto Sum = 1.0f;
+			auto Term = 1.0f;
+			const auto HalfX = X / 2.0f;
+			for (uint32 k = 1; k < 32 && Term > Sum*1e-7f; ++k)
+			{
+				Term *= (HalfX / k)*(HalfX / k);
+				Sum += Term;
+			}
+
+			return Sum;
+		}
+
+		/** @brief Weights of NumKaiserTaps source texels around the center of a texel of the next mip
+		  * @return (std::array<float, NumKaiserTaps>)
+		  */
+		std::array<float, NumKaiserTaps> ComputeKaiserWeights()
+		{
+			std::array<float, NumKaiserTaps> Weights;
+			auto WeightsSum = 0.0f;
+			for (int32 iTap = 0; iTap < NumKaiserTaps; ++iTap)
+			{
+				// Distance from the center in source texels. The sinc's cutoff is the next mip's Nyquist frequency
+				const auto Distance = iTap - (NumKaiserTaps - 1) / 2.0f;
+				const auto X = Pi*Distance / 2.0f;
+				const auto Sinc = std::abs(X) < 1e-6f ? 1.0f : std::sin(X) / X;
+
+				const auto WindowX = Distance / KaiserRadius;
+				const auto Window = BesselI0(KaiserAlpha*std::sqrt(std::max(0.0f, 1.0f - WindowX*WindowX))) / BesselI0(KaiserAlpha);
+
+				Weights[iTap] = Sinc*Window;
+				WeightsSum += Weights[iTap];
+			}
+
+			for (auto& Weight : Weights)
+			{
+				Weight /= WeightsSum;
+			}
+
+			return Weights;
+		}
+
+		/** @brief Halves the image along one axis. Kaiser filter wraps around edges, as samplers of materials do
+		  * @param Src (const FLinearImage &)
+		  * @param bHorizontal (bool)
+		  * @param Filter (EMipFilter)
+		  * @return (FLinearImage)
+		  */
+		FLinearImage Downsample(const FLinearImage& Src, bool bHorizontal, EMipFilter Filter)
+		{
+			static const auto KaiserWeights = ComputeKaiserWeights();
+
+			FLinearImage Dst;
+			Dst.Width = bHorizontal ? std::max(Src.Width / 2, 1u) : Src.Width;
+			Dst.Height = bHorizontal ? Src.Height : std::max(Src.Height / 2, 1u);
+			Dst.Texels.resize(static_cast<std::size_t>(Dst.Width)*Dst.Height);
+
+			const auto SrcSize = static_cast<int32>(bHorizontal ? Src.Width : Src.Height);
+
+			// Distance between neighbour texels along the axis
+			const std::size_t SrcStride = bHorizontal ? 1 : Src.Width;
+
+			const std::size_t NumRows = Dst.Height;
+			const auto NumChunks = (NumRows + FTextureBuilder::NumRowsPerChunk - 1) / FTextureBuilder::NumRowsPerChunk;
+			concurrency::parallel_for(std::size_t(0), NumChunks, [&](std::size_t iChunk)
+			{
+				const auto ChunkEnd = std::min((iChunk + 1)*FTextureBuilder::NumRowsPerChunk, NumRows);
+				for (auto y = iChunk*FTextureBuilder::NumRowsPerChunk; y < ChunkEnd; ++y)
+				{
+					for (std::size_t x = 0; x < Dst.Width; ++x)
+					{
+						// Position of the texel along the axis and the first texel of its row or column in the source
+						const auto DstPosition = static_cast<int32>(bHorizontal ? x : y);
+						const auto SrcLine = bHorizontal ? &Src.Texels[y*Src.Width] : &Src.Texels[x];
+
+						auto Sum = XMVectorZero();
+						if (Filter == EMipFilter::Box)
+						{
+							const auto Texel0 = std::min(DstPosition * 2, SrcSize - 1);
+							const auto Texel1 = std::min(DstPosition * 2 + 1, SrcSize - 1);
+							Sum = XMVectorAdd(
+								XMLoadFloat4(&SrcLine[Texel0*SrcStride]), XMLoadFloat4(&SrcLine[Texel1*SrcStride]));
+							Sum = XMVectorScale(Sum, 0.5f);
+						}
+						else
+						{
+							const auto FirstTexel = DstPosition * 2 - (NumKaiserTaps / 2 - 1);
+							for (int32 iTap = 0; iTap < NumKaiserTaps; ++iTap)
+							{
+								const auto Texel = ((FirstTexel + iTap) % SrcSize + SrcSize) % SrcSize;
+								Sum = XMVectorMultiplyAdd(
+									XMLoadFloat4(&SrcLine[Texel*SrcStride]), XMVectorReplicate(KaiserWeights[iTap]), Sum);
+							}
+						}
+
+						XMStoreFloat4(&Dst.Texels[y*Dst.Width + x], Sum);
+					}
+				}
+			});
+
+			return Dst;
+		}
+	}
+
+	std::vector<uint8> FTextureBuilder::Build(
+		const uint8* DDSData,
+		uint64 DDSDataSize,
+		const FTextureBuildSettings& Settings,
+		FTextureBuildStats* Stats)
+	{
+		DDS_TEXTURE_LAYOUT Layout;
+		if (FAILED(GetDDSTextureLayout(DDSData, static_cast<size_t>(DDSDataSize), 0, Layout)))
+		{
+			throw std::invalid_argument("Source texture isn't a valid DDS file");
+		}
+
+		if (Layout.resDim != DDS_DIMENSION_TEXTURE2D || Layout.arraySize != 1 || Layout.isCubeMap)
+		{
+			throw std::invalid_argument("Only 2D textures without arrays are built");
+		}
+
+		const auto Width = static_cast<uint32>(Layout.width);
+		const auto Height = static_cast<uint32>(Layout.height);
+		const auto& Mip = Layout.subresources[0];
+		const auto MipData = DDSData + Mip.offset;
+
+		std::vector<uint8> Texels(static_cast<std::size_t>(Width)*Height * 4);
+		switch (Layout.format)
+		{
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+			for (uint32 y = 0; y < Height; ++y)
+			{
+				std::memcpy(&Texels[static_cast<std::size_t>(y)*Width * 4], MipData + y*Mip.rowPitch, Width * 4);
+			}
+			break;
+		case DXGI_FORMAT_B8G8R8A8_UNORM:
+		case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8X8_UNORM:
+		case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+		{
+			const auto bOpaque = Layout.format == DXGI_FORMAT_B8G8R8X8_UNORM || Layout.format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+			for (uint32 y = 0; y < Height; ++y)
+			{
+				const auto SrcRow = MipData + y*Mip.rowPitch;
+				const auto DstRow = &Texels[static_cast<std::size_t>(y)*Width * 4];
+				for (uint32 x = 0; x < Width; ++x)
+				{
+					DstRow[x * 4 + 0] = SrcRow[x * 4 + 2];
+					DstRow[x * 4 + 1] = SrcRow[x * 4 + 1];
+					DstRow[x * 4 + 2] = SrcRow[x * 4 + 0];
+					DstRow[x * 4 + 3] = bOpaque ? 255 : SrcRow[x * 4 + 3];
+				}
+			}
+			break;
+		}
+		default:
+			if (!FBlockCompressor::IsSupported(Layout.format))
+			{
+				throw std::invalid_argument("Only RGBA8, BGRA8, BC1, BC3 and BC5 textures are built");
+			}
+
+			FBlockCompressor::Decompress(MipData, Width, Height, Layout.format, Texels.data());
+			break;
+		}
+
+		const auto SourceBlocks = Layout.format == Settings.Format ? MipData : nullptr;
+		return BuildTexture(Texels.data(), Width, Height, SourceBlocks, Settings, Stats);
+	}
+
+	std::vector<uint8> FTextureBuilder::Build(
+		const uint8* Texels,
+		uint32 Width,
+		uint32 Height,
+		const FTextureBuildSettings& Settings,
+		FTextureBuildStats* Stats)
+	{
+		return BuildTexture(Texels, Width, Height, nullptr, Settings, Stats);
+	}
+
+	std::vector<std::vector<uint8>> FTextureBuilder::GenerateMips(
+		const uint8* Texels,
+		uint32 Width,
+		uint32 Height,
+		const FTextureBuildSettings& Settings)
+	{
+		if (Width == 0 || Height == 0)
+		{
+			throw std::invalid_argument("Image must be not empty");
+		}
+
+		const auto NumFullMips = GetNumFullMips(Width, Height);
+		const auto NumMips = Settings.NumMips == 0 ? NumFullMips : std::min(Settings.NumMips, NumFullMips);
+
+		std::vector<std::vector<uint8>> Mips(NumMips);
+		Mips[0].assign(Texels, Texels + static_cast<std::size_t>(Width)*Height * 4);
+		if (NumMips == 1)
+		{
+			return Mips;
+		}
+
+		const auto& SRGBToLinear = GetSRGBToLinearTable();
+
+		FLinearImage Image;
+		Image.Width = Width;
+		Image.Height = Height;
+		Image.Texels.resize(static_cast<std::size_t>(Width)*Height);
+		for (std::size_t iTexel = 0; iTexel < Image.Texels.size(); ++iTexel)
+		{
+			const auto Texel = Texels + iTexel * 4;
+			auto& LinearTexel = Image.Texels[iTexel];
+			LinearTexel.x = Settings.bGammaCorrect ? SRGBToLinear[Texel[0]] : Texel[0] / 255.0f;
+			LinearTexel.y = Settings.bGammaCorrect ? SRGBToLinear[Texel[1]] : Texel[1] / 255.0f;
+			LinearTexel.z = Settings.bGammaCorrect ? SRGBToLinear[Texel[2]] : Texel[2] / 255.0f;
+			LinearTexel.w = Texel[3] / 255.0f;
+		}
+
+		for (uint32 iMip = 1; iMip < NumMips; ++iMip)
+		{
+			// Every mip is downsampled from the previous one before quantization
+			if (Image.Width > 1)
+			{
+				Image = Downsample(Image, true, Settings.MipFilter);
+			}
+
+			if (Image.Height > 1)
+			{
+				Image = Downsample(Image, false, Settings.MipFilter);
+			}
+
+			auto& Mip = Mips[iMip];
+			Mip.resize(Image.Texels.size() * 4);
+
+			const auto NumChunks = (Image.Height + NumRowsPerChunk - 1) / NumRowsPerChunk;
+			concurrency::parallel_for(std::size_t(0), NumChunks, [&](std::size_t iChunk)
+			{
+				const auto ChunkBegin = iChunk*NumRowsPerChunk*Image.Width;
+				const auto ChunkEnd = std::min((iChunk + 1)*NumRowsPerChunk*Image.Width, Image.Texels.size());
+				for (auto iTexel = ChunkBegin; iTexel < ChunkEnd; ++iTexel)
+				{
+					const auto& LinearTexel = Image.Texels[iTexel];
+					const auto Texel = &Mip[iTexel * 4];
+					Texel[0] = Settings.bGammaCorrect ? LinearToSRGB(LinearTexel.x) : ToUnorm8(LinearTexel.x);
+					Texel[1] = Settings.bGammaCorrect ? LinearToSRGB(LinearTexel.y) : ToUnorm8(LinearTexel.y);
+					Texel[2] = Settings.bGammaCorrect ? LinearToSRGB(LinearTexel.z) : ToUnorm8(LinearTexel.z);
+					Texel[3] = ToUnorm8(LinearTexel.w);
+				}
+			});
+		}
+
+		return Mips;
+	}
+
+	uint32 FTextureBuilder::GetNumFullMips(uint32 Width, uint32 Height) noexcept
+	{
+		uint32 NumMips = 1;
+		for (auto Size = std::max(Width, Height); Size > 1; Size >>= 1)
+		{
+			++NumMips;
+		}
+
+		return NumMips;
+	}
+
+	std::vector<uint8> FTextureBuilder::BuildTexture(
+		const uint8* Texels,
+		uint32 Width,
+		uint32 Height,
+		const uint8* SourceBlocks,
+		const FTextureBuildSettings& Settings,
+		FTextureBuildStats* Stats)
+	{
+		if (!FBlockCompressor::IsSupported(Settings.Format))
+		{
+			throw std::invalid_argument("Textures are built to BC1, BC3 or BC5 formats only");
+		}
+
+		const auto StartTime = std::chrono::high_resolution_clock::now();
+		const auto Mips = GenerateMips(Texels, Width, Height, Settings);
+		const auto MipsTime = std::chrono::high_resolution_clock::now();
+
+		const auto NumMips = static_cast<uint32>(Mips.size());
+		const auto Headers = CreateDDSHeaders(Settings.Format, Width, Height, NumMips);
+
+		auto DataSize = static_cast<uint64>(Headers.size());
+		for (uint32 iMip = 0; iMip < NumMips; ++iMip)
+		{
+			DataSize += FBlockCompressor::GetCompressedSize(
+				std::max(Width >> iMip, 1u), std::max(Height >> iMip, 1u), Settings.Format);
+		}
+
+		std::vector<uint8> Data(static_cast<std::size_t>(DataSize));
+		std::memcpy(Data.data(), Headers.data(), Headers.size());
+
+		FTextureBuildStats BuildStats;
+		BuildStats.Width = Width;
+		BuildStats.Height = Height;
+		BuildStats.NumMips = NumMips;
+		BuildStats.MipsSeconds = std::chrono::duration<double>(MipsTime - StartTime).count();
+
+		auto MipData = Data.data() + Headers.size();
+		for (uint32 iMip = 0; iMip < NumMips; ++iMip)
+		{
+			const auto MipWidth = std::max(Width >> iMip, 1u);
+			const auto MipHeight = std::max(Height >> iMip, 1u);
+			const auto MipSize = FBlockCompressor::GetCompressedSize(MipWidth, MipHeight, Settings.Format);
+			if (iMip == 0 && SourceBlocks != nullptr)
+			{
+				std::memcpy(MipData, SourceBlocks, static_cast<std::size_t>(MipSize));
+			}
+			else
+			{
+				BuildStats.Compression += FBlockCompressor::Compress(
+					Mips[iMip].data(), MipWidth, MipHeight, Settings.Format, MipData);
+			}
+
+			MipData += MipSize;
+		}
+
+		if (Stats != nullptr)
+		{
+			*Stats = BuildStats;
+		}
+
+		return Data;
+	}
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <vector>
+
+#include "pch.h"
+#include "BlockCompressor.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \enum EMipFilter
+	 *
+	 * \brief Filters which downsample mips
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	enum class EMipFilter
+	{
+		// Average of 2x2 texels. Cheap, but aliases and blurs
+		Box = 0,
+
+		// Windowed sinc over 6x6 texels. Keeps detail, may ring a little
+		Kaiser
+	};
+
+	/*!
+	 * \struct FTextureBuildSettings
+	 *
+	 * \brief Settings of building textures with mips
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FTextureBuildSettings
+	{
+		// BC1, BC3 or BC5
+		DXGI_FORMAT Format = DXGI_FORMAT_BC1_UNORM;
+
+		EMipFilter MipFilter = EMipFilter::Kaiser;
+
+		// Colors are stored in sRGB, so they're averaged in linear space. Alpha is linear always.
+		// Must be false for normal and other non-color maps
+		bool bGammaCorrect = true;
+
+		// Zero builds the full chain down to 1x1
+		uint32 NumMips = 0;
+	};
+
+	/*!
+	 * \struct FTextureBuildStats
+	 *
+	 * \brief Stats of building a texture
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FTextureBuildStats
+	{
+		uint32 Width = 0;
+		uint32 Height = 0;
+		uint32 NumMips = 0;
+
+		// Time of downsampling mips
+		double MipsSeconds = 0.0;
+
+		// Of all encoded mips. Mip 0 isn't encoded if the source has the same format
+		FTextureCompressionStats Compression;
+	};
+
+	/*!
+	 * \class FTextureBuilder
+	 *
+	 * \brief Builds block compressed textures with mips. Mips are downsampled from the most detailed one
+	 * in linear space, converted back to RGBA8 and encoded by FBlockCompressor on all cores.
+	 * The result is a DDS file which is loaded as any other one
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FTextureBuilder
+	{
+	public:
+		FTextureBuilder() = default;
+		~FTextureBuilder() = default;
+
+		FTextureBuilder& operator=(const FTextureBuilder& TextureBuilder) = delete;
+		FTextureBuilder(const FTextureBuilder& TextureBuilder) = delete;
+		FTextureBuilder(FTextureBuilder&& TextureBuilder) = delete;
+
+		/** @brief Builds the texture from the most detailed mip of the DDS texture.
+		  * Blocks of the source are copied if it has the same format
+		  * @param DDSData Whole DDS file of RGBA8, BGRA8, BC1, BC3 or BC5 texture (const uint8 *)
+		  * @param DDSDataSize (uint64)
+		  * @param Settings (const FTextureBuildSettings &)
+		  * @param Stats (FTextureBuildStats *)
+		  * @return Whole DDS file (std::vector<uint8>)
+		  */
+		static std::vector<uint8> Build(
+			const uint8* DDSData,
+			uint64 DDSDataSize,
+			const FTextureBuildSettings& Settings,
+			FTextureBuildStats* Stats = nullptr);
+
+		/** @brief Builds the texture from RGBA8 texels
+		  * @param Texels Width*Height texels (const uint8 *)
+		  * @param Width (uint32)
+		  * @param Height (uint32)
+		  * @param Settings (const FTextureBuildSettings &)
+		  * @param Stats (FTextureBuildStats *)
+		  * @return Whole DDS file (std::vector<uint8>)
+		  */
+		static std::vector<uint8> Build(
+			const uint8* Texels,
+			uint32 Width,
+			uint32 Height,
+			const FTextureBuildSettings& Settings,
+			FTextureBuildStats* Stats = nullptr);
+
+		/** @brief Downsamples RGBA8 texels to the chain of mips
+		  * @param Texels Width*Height texels (const uint8 *)
+		  * @param Width (uint32)
+		  * @param Height (uint32)
+		  * @param Settings (const FTextureBuildSettings &)
+		  * @return RGBA8 texels of every mip, the first one is a copy of the source (std::vector<std::vector<uint8>>)
+		  */
+		static std::vector<std::vector<uint8>> GenerateMips(
+			const uint8* Texels,
+			uint32 Width,
+			uint32 Height,
+			const FTextureBuildSettings& Settings);
+
+		/** @brief Number of mips in the chain down to 1x1
+		  * @param Width (uint32)
+		  * @param Height (uint32)
+		  * @return (uint32)
+		  */
+		static uint32 GetNumFullMips(uint32 Width, uint32 Height) noexcept;
+
+		// Rows of texels which are downsampled by one task
+		static constexpr std::size_t NumRowsPerChunk = 16;
+
+	private:
+		/** @brief Builds the texture from RGBA8 texels, reusing blocks of its most detailed mip if they're given
+		  * @param Texels (const uint8 *)
+		  * @param Width (uint32)
+		  * @param Height (uint32)
+		  * @param SourceBlocks Blocks of the same format as Settings.Format, nullptr to encode them (const uint8 *)
+		  * @param Settings (const FTextureBuildSettings &)
+		  * @param Stats (FTextureBuildStats *)
+		  * @return (std::vector<uint8>)
+		  */
+		static std::vector<uint8> BuildTexture(
+			const uint8* Texels,
+			uint32 Width,
+			uint32 Height,
+			const uint8* SourceBlocks,
+			const FTextureBuildSettings& Settings,
+			FTextureBuildStats* Stats);
+	};
+}
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <string.h>
 #include "pch.h"
+#include "ResourcePool.h"
 
 /*!
  * \struct FTexture
@@ -21,10 +22,29 @@ struct FTextureData
 
 	ComPtr<ID3D12Resource> Resource = nullptr;
 
-	ComPtr<ID3D12Resource> UploadResource = nullptr;
-
+	// Slot of the view read by frames. A new view is created in the back slot and the slots are swapped,
+	// because frames in flight read the current one
 	uint32 iSRVHeap = UINT32_MAX;
+	uint32 iBackSRVHeap = UINT32_MAX;
+
+	// Fence value of the frame which swapped the slots. The back slot is free since it's completed
+	uint64 SRVFenceValue = 0;
+
+	// Size of the most detailed mip in the file
+	uint32 Width = 0;
+	uint32 Height = 0;
+
+	// Sizes of all slices of every mip in the file
+	std::vector<uint64> MipsSizes;
+
+	// Index of the resource's most detailed mip among mips in the file. It's changed by streaming
+	uint32 MostDetailedMip = 0;
 
 	D3D12_SRV_DIMENSION ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
 };
 
+namespace WoodenEngine
+{
+	// Handle of a texture of FGameResource. It becomes stale when the texture is removed
+	using FTextureHandle = FPoolHandle<FTextureData>;
+}
@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "TextureStreamer.h"
+
+namespace WoodenEngine
+{
+	FTextureStreamer::FTextureStreamer(const FTextureStreamingSettings& Settings):
+		Settings(Settings)
+	{
+		Stats.BudgetBytes = Settings.BudgetBytes;
+	}
+
+	void FTextureStreamer::AddTexture(
+		const std::string& Name,
+		const std::vector<uint64>& MipsSizes,
+		uint32 Width,
+		uint32 TailMip)
+	{
+		if (Name.empty())
+		{
+			throw std::invalid_argument("Name must be not empty");
+		}
+
+		if (MipsSizes.empty() || TailMip >= MipsSizes.size())
+		{
+			throw std::invalid_argument("TailMip must be less than number of mips");
+		}
+
+		if (Textures.find(Name) != Textures.cend())
+		{
+			throw std::invalid_argument("A texture with the name " + Name + " is streamed yet");
+		}
+
+		FStreamedTexture Texture;
+		Texture.Name = Name;
+		Texture.Width = Width;
+		Texture.TailMip = TailMip;
+		Texture.ResidentMip = TailMip;
+		Texture.WantedMip = TailMip;
+
+		Texture.MipChainsSizes.resize(MipsSizes.size() + 1, 0);
+		for (auto iMip = MipsSizes.size(); iMip > 0; --iMip)
+		{
+			Texture.MipChainsSizes[iMip - 1] = Texture.MipChainsSizes[iMip] + MipsSizes[iMip - 1];
+		}
+
+		Stats.ResidentBytes += Texture.MipChainsSizes[TailMip];
+		++Stats.NumTextures;
+
+		Textures[Name] = std::move(Texture);
+	}
+
+	bool FTextureStreamer::HasTexture(const std::string& Name) const
+	{
+		return Textures.find(Name) != Textures.cend();
+	}
+
+	void FTextureStreamer::RemoveTexture(const std::string& Name)
+	{
+		auto TextureIter = Textures.find(Name);
+		if (TextureIter == Textures.end())
+		{
+			throw std::invalid_argument("Texture " + Name + " isn't streamed");
+		}
+
+		const auto& Texture = TextureIter->second;
+		if (Texture.bRequestInFlight)
+		{
+			throw std::invalid_argument("Texture " + Name + " has a request in flight");
+		}
+
+		Stats.ResidentBytes -= Texture.MipChainsSizes[Texture.ResidentMip];
+		--Stats.NumTextures;
+
+		Textures.erase(TextureIter);
+	}
+
+	void FTextureStreamer::UpdateTextureUsage(const std::string& Name, float RequiredSize, uint64 Frame)
+	{
+		auto TextureIter = Textures.find(Name);
+		if (TextureIter == Textures.end())
+		{
+			return;
+		}
+
+		// The texture may be drawn several times per frame. The largest size is required
+		auto& Texture = TextureIter->second;
+		if (Texture.LastUsedFrame != Frame)
+		{
+			Texture.RequiredSize = RequiredSize;
+			Texture.LastUsedFrame = Frame;
+		}
+		else
+		{
+			Texture.RequiredSize = std::max(Texture.RequiredSize, RequiredSize);
+		}
+	}
+
+	std::vector<FTextureStreamingRequest> FTextureStreamer::Update(uint64 Frame)
+	{
+		std::vector<FTextureStreamingRequest> Requests;
+
+		std::vector<FStreamedTexture*> Candidates;
+		for (auto& TextureIter : Textures)
+		{
+			auto& Texture = TextureIter.second;
+			Texture.WantedMip = ComputeWantedMip(Texture, Frame);
+
+			if (!Texture.bRequestInFlight && Texture.WantedMip < Texture.ResidentMip)
+			{
+				Candidates.push_back(&Texture);
+			}
+		}
+
+		// The budget may be decreased
+		if (Stats.ResidentBytes > Stats.BudgetBytes)
+		{
+			EvictUnwantedDetail(0, Requests);
+		}
+
+		std::sort(Candidates.begin(), Candidates.end(), [](const FStreamedTexture* A, const FStreamedTexture* B)
+		{
+			return ComputePriority(*A) > ComputePriority(*B);
+		});
+
+		for (auto Texture : Candidates)
+		{
+			if (Stats.NumInFlightRequests >= Settings.MaxNumInFlightRequests)
+			{
+				break;
+			}
+
+			// Less detail is loaded if the wanted one doesn't fit the budget
+			auto Mip = Texture->WantedMip;
+			for (; Mip < Texture->ResidentMip; ++Mip)
+			{
+				const auto NeededBytes =
+					Texture->MipChainsSizes[Mip] - Texture->MipChainsSizes[Texture->ResidentMip];
+				if (EvictUnwantedDetail(NeededBytes, Requests))
+				{
+					break;
+				}
+			}
+
+			if (Mip < Texture->ResidentMip)
+			{
+				AddRequest(*Texture, Mip, Requests);
+			}
+		}
+
+		return Requests;
+	}
+
+	void FTextureStreamer::CompleteRequest(const std::string& Name, bool bSucceeded)
+	{
+		auto TextureIter = Textures.find(Name);
+		if (TextureIter == Textures.end() || !TextureIter->second.bRequestInFlight)
+		{
+			throw std::invalid_argument("Texture " + Name + " doesn't have a request in flight");
+		}
+
+		auto& Texture = TextureIter->second;
+		const auto bStreamedIn = Texture.RequestedMip < Texture.ResidentMip;
+		if (bStreamedIn)
+		{
+			--Stats.NumInFlightRequests;
+		}
+
+		if (bSucceeded)
+		{
+			++(bStreamedIn ? Stats.NumStreamedIn : Stats.NumEvicted);
+			Texture.ResidentMip = Texture.RequestedMip;
+		}
+		else
+		{
+			// Memory was accounted for the requested mips
+			Stats.ResidentBytes += Texture.MipChainsSizes[Texture.ResidentMip];
+			Stats.ResidentBytes -= Texture.MipChainsSizes[Texture.RequestedMip];
+		}
+
+		Texture.bRequestInFlight = false;
+	}
+
+	uint32 FTextureStreamer::GetResidentMip(const std::string& Name) const
+	{
+		auto TextureIter = Textures.find(Name);
+		if (TextureIter == Textures.cend())
+		{
+			throw std::invalid_argument("Texture " + Name + " isn't streamed");
+		}
+
+		return TextureIter->second.ResidentMip;
+	}
+
+	void FTextureStreamer::SetBudget(uint64 BudgetBytes) noexcept
+	{
+		Settings.BudgetBytes = BudgetBytes;
+		Stats.BudgetBytes = BudgetBytes;
+	}
+
+	const FTextureStreamingSettings& FTextureStreamer::GetSettings() const noexcept
+	{
+		return Settings;
+	}
+
+	FTextureStreamingStats FTextureStreamer::GetStats() const noexcept
+	{
+		return Stats;
+	}
+
+	uint32 FTextureStreamer::ComputeWantedMip(const FStreamedTexture& Texture, uint64 Frame) const noexcept
+	{
+		// Detail of unused textures isn't wanted
+		if (Texture.LastUsedFrame + Settings.NumUnusedFramesToEvict < Frame || Texture.RequiredSize <= 0.0f)
+		{
+			return Texture.TailMip;
+		}
+
+		auto Mip = 0u;
+		while (Mip < Texture.TailMip && static_cast<float>(Texture.Width >> (Mip + 1)) >= Texture.RequiredSize)
+		{
+			++Mip;
+		}
+
+		return Mip;
+	}
+
+	float FTextureStreamer::ComputePriority(const FStreamedTexture& Texture) noexcept
+	{
+		const auto ResidentWidth = std::max(Texture.Width >> Texture.ResidentMip, 1u);
+		return Texture.RequiredSize / ResidentWidth;
+	}
+
+	bool FTextureStreamer::EvictUnwantedDetail(uint64 NeededBytes, std::vector<FTextureStreamingRequest>& Requests)
+	{
+		if (Stats.ResidentBytes + NeededBytes <= Stats.BudgetBytes)
+		{
+			return true;
+		}
+
+		std::vector<FStreamedTexture*> Victims;
+		uint64 UnwantedBytes = 0;
+		for (auto& TextureIter : Textures)
+		{
+			auto& Texture = TextureIter.second;
+			if (!Texture.bRequestInFlight && Texture.ResidentMip < Texture.WantedMip)
+			{
+				Victims.push_back(&Texture);
+				UnwantedBytes += Texture.MipChainsSizes[Texture.ResidentMip] - Texture.MipChainsSizes[Texture.WantedMip];
+			}
+		}
+
+		if (NeededBytes > 0 && Stats.ResidentBytes + NeededBytes > Stats.BudgetBytes + UnwantedBytes)
+		{
+			return false;
+		}
+
+		// Least recently used first
+		std::sort(Victims.begin(), Victims.end(), [](const FStreamedTexture* A, const FStreamedTexture* B)
+		{
+			return A->LastUsedFrame < B->LastUsedFrame;
+		});
+
+		for (auto Victim : Victims)
+		{
+			if (Stats.ResidentBytes + NeededBytes <= Stats.BudgetBytes)
+			{
+				break;
+			}
+
+			AddRequest(*Victim, Victim->WantedMip, Requests);
+		}
+
+		return Stats.ResidentBytes + NeededBytes <= Stats.BudgetBytes;
+	}
+
+	void FTextureStreamer::AddRequest(
+		FStreamedTexture& Texture,
+		uint32 Mip,
+		std::vector<FTextureStreamingRequest>& Requests)
+	{
+		FTextureStreamingRequest Request;
+		Request.TextureName = Texture.Name;
+		Request.MostDetailedMip = Mip;
+
+		if (Mip < Texture.ResidentMip)
+		{
+			Request.Priority = ComputePriority(Texture);
+			++Stats.NumInFlightRequests;
+		}
+
+		// Loaded memory is reserved and evicted one is released until the request completes
+		Stats.ResidentBytes -= Texture.MipChainsSizes[Texture.ResidentMip];
+		Stats.ResidentBytes += Texture.MipChainsSizes[Mip];
+
+		Texture.RequestedMip = Mip;
+		Texture.bRequestInFlight = true;
+
+		Requests.push_back(std::move(Request));
+	}
+}
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "pch.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FTextureStreamingSettings
+	 *
+	 * \brief Settings of texture streaming
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FTextureStreamingSettings
+	{
+		// Memory for all mips of streamed textures. Tail mips are counted, but they're never evicted
+		uint64 BudgetBytes = 32 * 1024 * 1024;
+
+		// Mips which aren't larger than it are loaded at startup and are always resident
+		uint32 TailMipSize = 64;
+
+		// Max number of textures whose detail is being loaded at the same time
+		uint32 MaxNumInFlightRequests = 2;
+
+		// Detail of textures which weren't used for more frames isn't wanted anymore
+		uint32 NumUnusedFramesToEvict = 120;
+	};
+
+	/*!
+	 * \struct FTextureStreamingRequest
+	 *
+	 * \brief Request to reload a texture with another set of mips
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FTextureStreamingRequest
+	{
+		std::string TextureName;
+
+		// Most detailed mip of the reloaded texture. It's coarser than the resident one on eviction
+		uint32 MostDetailedMip = 0;
+
+		// Ratio of wanted and resident resolution. It's zero for evictions
+		float Priority = 0.0f;
+	};
+
+	/*!
+	 * \struct FTextureStreamingStats
+	 *
+	 * \brief Statistics of texture streaming
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FTextureStreamingStats
+	{
+		// Resident mips plus mips of requests in flight
+		uint64 ResidentBytes = 0;
+		uint64 BudgetBytes = 0;
+
+		uint32 NumTextures = 0;
+		uint32 NumInFlightRequests = 0;
+
+		uint32 NumStreamedIn = 0;
+		uint32 NumEvicted = 0;
+	};
+
+	/*!
+	 * \class FTextureStreamer
+	 *
+	 * \brief Decides which mips of textures must be resident.
+	 * Textures are registered with their tail mips resident. Every frame their usage (required resolution
+	 * on the screen) is reported, and Update returns requests to load more detailed mips by priority.
+	 * When the budget is exceeded, detail which isn't wanted anymore is evicted in LRU order.
+	 * It doesn't touch GPU: requests are executed by the caller and confirmed by CompleteRequest
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FTextureStreamer
+	{
+	public:
+		explicit FTextureStreamer(const FTextureStreamingSettings& Settings = FTextureStreamingSettings());
+		~FTextureStreamer() = default;
+
+		FTextureStreamer& operator=(const FTextureStreamer& TextureStreamer) = delete;
+		FTextureStreamer(const FTextureStreamer& TextureStreamer) = delete;
+		FTextureStreamer(FTextureStreamer&& TextureStreamer) = delete;
+
+		/** @brief Registers the texture with resident mips starting from TailMip
+		  * @param Name (const std::string &)
+		  * @param MipsSizes Sizes of all slices of every mip from the most detailed one (const std::vector<uint64> &)
+		  * @param Width Width of the most detailed mip (uint32)
+		  * @param TailMip Most detailed resident mip (uint32)
+		  * @return (void)
+		  */
+		void AddTexture(
+			const std::string& Name,
+			const std::vector<uint64>& MipsSizes,
+			uint32 Width,
+			uint32 TailMip);
+
+		/** @brief Returns true if the texture is registered
+		  * @param Name (const std::string &)
+		  * @return (bool)
+		  */
+		bool HasTexture(const std::string& Name) const;
+
+		/** @brief Unregisters the texture and releases its resident memory.
+		  * Throws invalid_argument if the texture isn't registered or has a request in flight
+		  * @param Name (const std::string &)
+		  * @return (void)
+		  */
+		void RemoveTexture(const std::string& Name);
+
+		/** @brief Reports usage of the texture in the frame. Textures which aren't registered are ignored
+		  * @param Name (const std::string &)
+		  * @param RequiredSize Number of texels across the screen, which the texture is drawn with (float)
+		  * @param Frame Index of the current frame (uint64)
+		  * @return (void)
+		  */
+		void UpdateTextureUsage(const std::string& Name, float RequiredSize, uint64 Frame);
+
+		/** @brief Computes wanted mips and returns requests which fit the budget
+		  * @param Frame Index of the current frame (uint64)
+		  * @return Evictions and then loads from the highest priority (std::vector<WoodenEngine::FTextureStreamingRequest>)
+		  */
+		std::vector<FTextureStreamingRequest> Update(uint64 Frame);
+
+		/** @brief Confirms the texture's request. Memory of failed requests is released
+		  * @param Name (const std::string &)
+		  * @param bSucceeded (bool)
+		  * @return (void)
+		  */
+		void CompleteRequest(const std::string& Name, bool bSucceeded);
+
+		/** @brief Returns the most detailed resident mip of the texture
+		  * @param Name (const std::string &)
+		  * @return (uint32)
+		  */
+		uint32 GetResidentMip(const std::string& Name) const;
+
+		/** @brief Changes the budget. Unwanted detail over it is evicted by next Update
+		  * @param BudgetBytes (uint64)
+		  * @return (void)
+		  */
+		void SetBudget(uint64 BudgetBytes) noexcept;
+
+		/** @brief Returns settings of streaming
+		  * @return (const WoodenEngine::FTextureStreamingSettings&)
+		  */
+		const FTextureStreamingSettings& GetSettings() const noexcept;
+
+		/** @brief Returns statistics of streaming
+		  * @return (WoodenEngine::FTextureStreamingStats)
+		  */
+		FTextureStreamingStats GetStats() const noexcept;
+
+	private:
+		struct FStreamedTexture
+		{
+			std::string Name;
+
+			// Size of mips from i-th to the last one
+			std::vector<uint64> MipChainsSizes;
+
+			uint32 Width = 0;
+
+			uint32 TailMip = 0;
+			uint32 ResidentMip = 0;
+			uint32 WantedMip = 0;
+
+			// Valid while bRequestInFlight
+			uint32 RequestedMip = 0;
+			bool bRequestInFlight = false;
+
+			float RequiredSize = 0.0f;
+			uint64 LastUsedFrame = 0;
+		};
+
+		/** @brief Returns the most coarse mip whose width isn't less than the required size
+		  * @param Texture (const FStreamedTexture &)
+		  * @param Frame (uint64)
+		  * @return (uint32)
+		  */
+		uint32 ComputeWantedMip(const FStreamedTexture& Texture, uint64 Frame) const noexcept;
+
+		/** @brief Ratio of required and resident resolution of the texture
+		  * @param Texture (const FStreamedTexture &)
+		  * @return (float)
+		  */
+		static float ComputePriority(const FStreamedTexture& Texture) noexcept;
+
+		/** @brief Evicts unwanted detail in LRU order until NeededBytes fit the budget.
+		  * Nothing is evicted if it can't free enough memory
+		  * @param NeededBytes (uint64)
+		  * @param Requests Evictions are added to them (std::vector<FTextureStreamingRequest> &)
+		  * @return True if NeededBytes fit the budget (bool)
+		  */
+		bool EvictUnwantedDetail(uint64 NeededBytes, std::vector<FTextureStreamingRequest>& Requests);
+
+		/** @brief Starts a request and accounts its memory
+		  * @param Texture (FStreamedTexture &)
+		  * @param Mip (uint32)
+		  * @param Requests (std::vector<FTextureStreamingRequest> &)
+		  * @return (void)
+		  */
+		void AddRequest(FStreamedTexture& Texture, uint32 Mip, std::vector<FTextureStreamingRequest>& Requests);
+
+		FTextureStreamingSettings Settings;
+
+		std::unordered_map<std::string, FStreamedTexture> Textures;
+
+		FTextureStreamingStats Stats;
+	};
+}
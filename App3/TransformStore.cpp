@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "TransformStore.h"
+
+namespace WoodenEngine
+{
+	FTransformHandle FTransformStore::Create(
+		const XMFLOAT3& Position,
+		const XMFLOAT4& Rotation,
+		const XMFLOAT3& Scale)
+	{
+		if (FreeSlots.empty() && Slots.size() == FTransformHandle::InvalidIndex)
+		{
+			throw std::invalid_argument("Transform store is full");
+		}
+
+		const auto iTransform = static_cast<uint32>(TransformsSlots.size());
+
+		// Arrays grow by whole blocks. Unused lanes of the last block are computed, but not stored
+		if (iTransform % BlockSize == 0)
+		{
+			for (auto Components : { &PositionsX, &PositionsY, &PositionsZ,
+				&RotationsX, &RotationsY, &RotationsZ, &ScalesX, &ScalesY, &ScalesZ })
+			{
+				Components->resize(iTransform + BlockSize, 0.0f);
+			}
+
+			RotationsW.resize(iTransform + BlockSize, 1.0f);
+			DirtyBlocks.push_back(false);
+		}
+
+		WorldTransforms.emplace_back();
+		WorldTransformsOverrides.push_back(false);
+		WritePosition(iTransform, Position);
+		WriteRotation(iTransform, Rotation);
+		WriteScale(iTransform, Scale);
+
+		uint32 iSlot;
+		if (FreeSlots.empty())
+		{
+			iSlot = static_cast<uint32>(Slots.size());
+			Slots.emplace_back();
+		}
+		else
+		{
+			iSlot = FreeSlots.back();
+			FreeSlots.pop_back();
+		}
+
+		auto& Slot = Slots[iSlot];
+		Slot.iTransform = iTransform;
+		TransformsSlots.push_back(iSlot);
+
+		FTransformHandle Handle;
+		Handle.Index = iSlot;
+		Handle.Generation = Slot.Generation;
+		return Handle;
+	}
+
+	void FTransformStore::Destroy(FTransformHandle Handle)
+	{
+		const auto iTransform = GetTransformIndex(Handle);
+		const auto iLastTransform = static_cast<uint32>(TransformsSlots.size() - 1);
+		if (iTransform != iLastTransform)
+		{
+			for (auto Components : { &PositionsX, &PositionsY, &PositionsZ,
+				&RotationsX, &RotationsY, &RotationsZ, &RotationsW, &ScalesX, &ScalesY, &ScalesZ })
+			{
+				(*Components)[iTransform] = (*Components)[iLastTransform];
+			}
+
+			// Computed world matrix is moved too, unless it's stale
+			WorldTransforms[iTransform] = WorldTransforms[iLastTransform];
+			WorldTransformsOverrides[iTransform] = WorldTransformsOverrides[iLastTransform];
+			if (DirtyBlocks[iLastTransform / BlockSize])
+			{
+				MarkDirty(iTransform);
+			}
+
+			TransformsSlots[iTransform] = TransformsSlots[iLastTransform];
+			Slots[TransformsSlots[iTransform]].iTransform = iTransform;
+		}
+
+		WorldTransforms.pop_back();
+		WorldTransformsOverrides.pop_back();
+		TransformsSlots.pop_back();
+
+		if (iLastTransform % BlockSize == 0)
+		{
+			for (auto Components : { &PositionsX, &PositionsY, &PositionsZ,
+				&RotationsX, &RotationsY, &RotationsZ, &RotationsW, &ScalesX, &ScalesY, &ScalesZ })
+			{
+				Components->resize(iLastTransform);
+			}
+
+			DirtyBlocks.pop_back();
+			DirtyBlocksEnd = std::min(DirtyBlocksEnd, static_cast<uint32>(DirtyBlocks.size()));
+		}
+
+		// Handles of the destroyed transform become stale
+		auto& Slot = Slots[Handle.Index];
+		++Slot.Generation;
+		Slot.iTransform = FTransformHandle::InvalidIndex;
+		FreeSlots.push_back(Handle.Index);
+	}
+
+	bool FTransformStore::Contains(FTransformHandle Handle) const noexcept
+	{
+		return Handle.Index < Slots.size() &&
+			Slots[Handle.Index].Generation == Handle.Generation &&
+			Slots[Handle.Index].iTransform != FTransformHandle::InvalidIndex;
+	}
+
+	void FTransformStore::SetPosition(FTransformHandle Handle, const XMFLOAT3& Position)
+	{
+		WritePosition(GetTransformIndex(Handle), Position);
+	}
+
+	void FTransformStore::SetRotation(FTransformHandle Handle, const XMFLOAT4& Rotation)
+	{
+		WriteRotation(GetTransformIndex(Handle), Rotation);
+	}
+
+	void FTransformStore::SetScale(FTransformHandle Handle, const XMFLOAT3& Scale)
+	{
+		WriteScale(GetTransformIndex(Handle), Scale);
+	}
+
+	void FTransformStore::SetWorldTransform(FTransformHandle Handle, FXMMATRIX WorldTransform)
+	{
+		const auto iTransform = GetTransformIndex(Handle);
+		XMStoreFloat4x4(&WorldTransforms[iTransform], WorldTransform);
+		WorldTransformsOverrides[iTransform] = true;
+	}
+
+	XMFLOAT3 FTransformStore::GetPosition(FTransformHandle Handle) const
+	{
+		const auto iTransform = GetTransformIndex(Handle);
+		return { PositionsX[iTransform], PositionsY[iTransform], PositionsZ[iTransform] };
+	}
+
+	XMFLOAT4 FTransformStore::GetRotation(FTransformHandle Handle) const
+	{
+		const auto iTransform = GetTransformIndex(Handle);
+		return { RotationsX[iTransform], RotationsY[iTransform], RotationsZ[iTransform], RotationsW[iTransform] };
+	}
+
+	XMFLOAT3 FTransformStore::GetScale(FTransformHandle Handle) const
+	{
+		const auto iTransform = GetTransformIndex(Handle);
+		return { ScalesX[iTransform], ScalesY[iTransform], ScalesZ[iTransform] };
+	}
+
+	XMMATRIX FTransformStore::GetWorldTransform(FTransformHandle Handle)
+	{
+		const auto iTransform = GetTransformIndex(Handle);
+
+		const auto iBlock = iTransform / BlockSize;
+		if (DirtyBlocks[iBlock])
+		{
+			UpdateBlock(iBlock);
+			++Stats.NumLazyUpdatedBlocks;
+		}
+
+		return XMLoadFloat4x4(&WorldTransforms[iTransform]);
+	}
+
+	void FTransformStore::UpdateWorldTransforms() noexcept
+	{
+		Stats.NumUpdatedBlocks = 0;
+		Stats.NumLazyUpdatedBlocks = 0;
+
+		for (auto iBlock = DirtyBlocksBegin; iBlock < DirtyBlocksEnd; ++iBlock)
+		{
+			if (DirtyBlocks[iBlock])
+			{
+				UpdateBlock(iBlock);
+				++Stats.NumUpdatedBlocks;
+			}
+		}
+
+		DirtyBlocksBegin = UINT32_MAX;
+		DirtyBlocksEnd = 0;
+	}
+
+	uint32 FTransformStore::GetNumTransforms() const noexcept
+	{
+		return static_cast<uint32>(TransformsSlots.size());
+	}
+
+	FTransformStoreStats FTransformStore::GetStats() const noexcept
+	{
+		auto CurrentStats = Stats;
+		CurrentStats.NumTransforms = GetNumTransforms();
+		return CurrentStats;
+	}
+
+	uint32 FTransformStore::GetTransformIndex(FTransformHandle Handle) const
+	{
+		if (!Contains(Handle))
+		{
+			throw std::invalid_argument("Handle doesn't refer a transform of the store");
+		}
+
+		return Slots[Handle.Index].iTransform;
+	}
+
+	void FTransformStore::WritePosition(uint32 iTransform, const XMFLOAT3& Position) noexcept
+	{
+		PositionsX[iTransform] = Position.x;
+		PositionsY[iTransform] = Position.y;
+		PositionsZ[iTransform] = Position.z;
+
+		WorldTransformsOverrides[iTransform] = false;
+		MarkDirty(iTransform);
+	}
+
+	void FTransformStore::WriteRotation(uint32 iTransform, const XMFLOAT4& Rotation) noexcept
+	{
+		XMFLOAT4 UnitRotation;
+		XMStoreFloat4(&UnitRotation, XMQuaternionNormalize(XMLoadFloat4(&Rotation)));
+
+		RotationsX[iTransform] = UnitRotation.x;
+		RotationsY[iTransform] = UnitRotation.y;
+		RotationsZ[iTransform] = UnitRotation.z;
+		RotationsW[iTransform] = UnitRotation.w;
+
+		WorldTransformsOverrides[iTransform] = false;
+		MarkDirty(iTransform);
+	}
+
+	void FTransformStore::WriteScale(uint32 iTransform, const XMFLOAT3& Scale) noexcept
+	{
+		ScalesX[iTransform] = Scale.x;
+		ScalesY[iTransform] = Scale.y;
+		ScalesZ[iTransform] = Scale.z;
+
+		WorldTransformsOverrides[iTransform] = false;
+		MarkDirty(iTransform);
+	}
+
+	void FTransformStore::MarkDirty(uint32 iTransform) noexcept
+	{
+		const auto iBlock = iTransform / BlockSize;
+		DirtyBlocks[iBlock] = true;
+		DirtyBlocksBegin = std::min(DirtyBlocksBegin, iBlock);
+		DirtyBlocksEnd = std::max(DirtyBlocksEnd, iBlock + 1);
+	}
+
+	void FTransformStore::UpdateBlock(uint32 iBlock) noexcept
+	{
+		const auto iFirst = iBlock*BlockSize;
+		const auto LoadLanes = [iFirst](const std::vector<float>& Components)
+		{
+			return XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(&Components[iFirst]));
+		};
+
+		const auto X = LoadLanes(RotationsX);
+		const auto Y = LoadLanes(RotationsY);
+		const auto Z = LoadLanes(RotationsZ);
+		const auto W = LoadLanes(RotationsW);
+
+		// Terms of the rotation matrix of unit quaternions (see XMMatrixRotationQuaternion)
+		const auto Two = XMVectorReplicate(2.0f);
+		const auto One = XMVectorSplatOne();
+		const auto X2 = XMVectorMultiply(X, Two);
+		const auto Y2 = XMVectorMultiply(Y, Two);
+		const auto Z2 = XMVectorMultiply(Z, Two);
+
+		const auto XX = XMVectorMultiply(X, X2);
+		const auto YY = XMVectorMultiply(Y, Y2);
+		const auto ZZ = XMVectorMultiply(Z, Z2);
+		const auto XY = XMVectorMultiply(X, Y2);
+		const auto XZ = XMVectorMultiply(X, Z2);
+		const auto YZ = XMVectorMultiply(Y, Z2);
+		const auto WX = XMVectorMultiply(W, X2);
+		const auto WY = XMVectorMultiply(W, Y2);
+		const auto WZ = XMVectorMultiply(W, Z2);
+
+		// Rows of the rotation are scaled, since the scale is applied first
+		const auto SX = LoadLanes(ScalesX);
+		const auto SY = LoadLanes(ScalesY);
+		const auto SZ = LoadLanes(ScalesZ);
+
+		// Lanes are transposed to rows of transforms' matrices
+		const auto Rows0 = XMMatrixTranspose(XMMATRIX(
+			XMVectorMultiply(SX, XMVectorSubtract(One, XMVectorAdd(YY, ZZ))),
+			XMVectorMultiply(SX, XMVectorAdd(XY, WZ)),
+			XMVectorMultiply(SX, XMVectorSubtract(XZ, WY)),
+			XMVectorZero()));
+
+		const auto Rows1 = XMMatrixTranspose(XMMATRIX(
+			XMVectorMultiply(SY, XMVectorSubtract(XY, WZ)),
+			XMVectorMultiply(SY, XMVectorSubtract(One, XMVectorAdd(XX, ZZ))),
+			XMVectorMultiply(SY, XMVectorAdd(YZ, WX)),
+			XMVectorZero()));
+
+		const auto Rows2 = XMMatrixTranspose(XMMATRIX(
+			XMVectorMultiply(SZ, XMVectorAdd(XZ, WY)),
+			XMVectorMultiply(SZ, XMVectorSubtract(YZ, WX)),
+			XMVectorMultiply(SZ, XMVectorSubtract(One, XMVectorAdd(XX, YY))),
+			XMVectorZero()));
+
+		const auto Rows3 = XMMatrixTranspose(XMMATRIX(
+			LoadLanes(PositionsX),
+			LoadLanes(PositionsY),
+			LoadLanes(PositionsZ),
+			One));
+
+		const auto NumLanes = std::min(static_cast<uint32>(TransformsSlots.size()) - iFirst, uint32(BlockSize));
+		for (uint32 iLane = 0; iLane < NumLanes; ++iLane)
+		{
+			if (!WorldTransformsOverrides[iFirst + iLane])
+			{
+				XMStoreFloat4x4(&WorldTransforms[iFirst + iLane],
+					XMMATRIX(Rows0.r[iLane], Rows1.r[iLane], Rows2.r[iLane], Rows3.r[iLane]));
+			}
+		}
+
+		DirtyBlocks[iBlock] = false;
+	}
+}
@@ -0,0 +1,217 @@
+#pragma once
+
+#include <vector>
+
+#include "pch.h"
+#include "ResourcePool.h"
+
+namespace WoodenEngine
+{
+	using namespace DirectX;
+
+	class FTransformStore;
+
+	// Handle of a transform of FTransformStore. It becomes stale when the transform is destroyed
+	using FTransformHandle = FPoolHandle<FTransformStore>;
+
+	/*!
+	 * \struct FTransformStoreStats
+	 *
+	 * \brief Statistics of FTransformStore
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FTransformStoreStats
+	{
+		uint32 NumTransforms = 0;
+
+		// Transforms are recomputed in blocks of FTransformStore::BlockSize by the last UpdateWorldTransforms
+		uint32 NumUpdatedBlocks = 0;
+
+		// Blocks recomputed on demand by GetWorldTransform since the last UpdateWorldTransforms
+		uint32 NumLazyUpdatedBlocks = 0;
+	};
+
+	/*!
+	 * \class FTransformStore
+	 *
+	 * \brief Transforms of objects in structure of arrays. Translations, rotations (unit quaternions) and scales
+	 * are stored by components, so world matrices of BlockSize transforms are computed at once by SIMD lanes.
+	 * Setters only mark blocks dirty, and dirty blocks are recomputed by UpdateWorldTransforms once per frame.
+	 * Transforms are contiguous in order of creation (destroyed one is replaced by the last one),
+	 * handles are resolved through slots like in FResourcePool
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FTransformStore
+	{
+	public:
+		// Number of transforms in a SIMD vector
+		static constexpr uint32 BlockSize = 4;
+
+		FTransformStore() = default;
+		~FTransformStore() = default;
+
+		FTransformStore& operator=(const FTransformStore& TransformStore) = delete;
+		FTransformStore(const FTransformStore& TransformStore) = delete;
+		FTransformStore(FTransformStore&& TransformStore) = delete;
+
+		/** @brief Creates a transform. Its world matrix is computed by next update
+		  * @param Position (const XMFLOAT3 &)
+		  * @param Rotation Quaternion. It's normalized (const XMFLOAT4 &)
+		  * @param Scale (const XMFLOAT3 &)
+		  * @return (WoodenEngine::FTransformHandle)
+		  */
+		FTransformHandle Create(
+			const XMFLOAT3& Position = { 0.0f, 0.0f, 0.0f },
+			const XMFLOAT4& Rotation = { 0.0f, 0.0f, 0.0f, 1.0f },
+			const XMFLOAT3& Scale = { 1.0f, 1.0f, 1.0f });
+
+		/** @brief Destroys the transform. The last transform is moved to its place.
+		  * Throws invalid_argument if the handle is stale
+		  * @param Handle (FTransformHandle)
+		  * @return (void)
+		  */
+		void Destroy(FTransformHandle Handle);
+
+		/** @brief Returns true if the handle refers a transform which isn't destroyed
+		  * @param Handle (FTransformHandle)
+		  * @return (bool)
+		  */
+		bool Contains(FTransformHandle Handle) const noexcept;
+
+		/** @brief Sets the position. Setters of position, rotation and scale cancel SetWorldTransform.
+		  * Throws invalid_argument if the handle is stale
+		  * @param Handle (FTransformHandle)
+		  * @param Position (const XMFLOAT3 &)
+		  * @return (void)
+		  */
+		void SetPosition(FTransformHandle Handle, const XMFLOAT3& Position);
+
+		/** @brief Sets the rotation
+		  * @param Handle (FTransformHandle)
+		  * @param Rotation Quaternion. It's normalized (const XMFLOAT4 &)
+		  * @return (void)
+		  */
+		void SetRotation(FTransformHandle Handle, const XMFLOAT4& Rotation);
+
+		/** @brief Sets the scale
+		  * @param Handle (FTransformHandle)
+		  * @param Scale (const XMFLOAT3 &)
+		  * @return (void)
+		  */
+		void SetScale(FTransformHandle Handle, const XMFLOAT3& Scale);
+
+		/** @brief Sets the world matrix directly. It isn't recomputed until position, rotation or scale is set
+		  * @param Handle (FTransformHandle)
+		  * @param WorldTransform (FXMMATRIX)
+		  * @return (void)
+		  */
+		void SetWorldTransform(FTransformHandle Handle, FXMMATRIX WorldTransform);
+
+		XMFLOAT3 GetPosition(FTransformHandle Handle) const;
+
+		/** @brief Returns the rotation
+		  * @param Handle (FTransformHandle)
+		  * @return Unit quaternion (DirectX::XMFLOAT4)
+		  */
+		XMFLOAT4 GetRotation(FTransformHandle Handle) const;
+
+		XMFLOAT3 GetScale(FTransformHandle Handle) const;
+
+		/** @brief Returns the world matrix (scale, then rotation, then translation).
+		  * Block of a dirty transform is recomputed at once, so it's never stale
+		  * @param Handle (FTransformHandle)
+		  * @return (DirectX::XMMATRIX)
+		  */
+		XMMATRIX GetWorldTransform(FTransformHandle Handle);
+
+		/** @brief Recomputes world matrices of all dirty blocks
+		  * @return (void)
+		  */
+		void UpdateWorldTransforms() noexcept;
+
+		/** @brief Returns number of transforms
+		  * @return (uint32)
+		  */
+		uint32 GetNumTransforms() const noexcept;
+
+		FTransformStoreStats GetStats() const noexcept;
+
+	private:
+		struct FSlot
+		{
+			// Index of the transform in the arrays
+			uint32 iTransform = FTransformHandle::InvalidIndex;
+
+			uint32 Generation = 0;
+		};
+
+		/** @brief Returns index of the transform in the arrays.
+		  * Throws invalid_argument if the handle is stale
+		  * @param Handle (FTransformHandle)
+		  * @return (uint32)
+		  */
+		uint32 GetTransformIndex(FTransformHandle Handle) const;
+
+		/** @brief Writes the transform's component and cancels override of its world matrix
+		  * @param iTransform (uint32)
+		  * @param Position (const XMFLOAT3 &)
+		  * @return (void)
+		  */
+		void WritePosition(uint32 iTransform, const XMFLOAT3& Position) noexcept;
+
+		void WriteRotation(uint32 iTransform, const XMFLOAT4& Rotation) noexcept;
+
+		void WriteScale(uint32 iTransform, const XMFLOAT3& Scale) noexcept;
+
+		/** @brief Marks block of the transform dirty
+		  * @param iTransform (uint32)
+		  * @return (void)
+		  */
+		void MarkDirty(uint32 iTransform) noexcept;
+
+		/** @brief Computes world matrices of the block's transforms at once
+		  * @param iBlock (uint32)
+		  * @return (void)
+		  */
+		void UpdateBlock(uint32 iBlock) noexcept;
+
+		// Components of transforms. Their sizes are multiple of BlockSize
+		std::vector<float> PositionsX;
+		std::vector<float> PositionsY;
+		std::vector<float> PositionsZ;
+
+		std::vector<float> RotationsX;
+		std::vector<float> RotationsY;
+		std::vector<float> RotationsZ;
+		std::vector<float> RotationsW;
+
+		std::vector<float> ScalesX;
+		std::vector<float> ScalesY;
+		std::vector<float> ScalesZ;
+
+		std::vector<XMFLOAT4X4> WorldTransforms;
+
+		// Set for transforms whose world matrices are set by SetWorldTransform
+		std::vector<uint8> WorldTransformsOverrides;
+
+		// Flag of every block
+		std::vector<uint8> DirtyBlocks;
+
+		// Range of blocks which may be dirty
+		uint32 DirtyBlocksBegin = UINT32_MAX;
+		uint32 DirtyBlocksEnd = 0;
+
+		std::vector<FSlot> Slots;
+
+		// Slot of every transform
+		std::vector<uint32> TransformsSlots;
+
+		std::vector<uint32> FreeSlots;
+
+		FTransformStoreStats Stats;
+	};
+}
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "Common/DirectXHelper.h"
+#include "UploadHeap.h"
+
+namespace WoodenEngine
+{
+	FUploadHeap::FUploadHeap(uint64 RingSize):
+		Ring(RingSize)
+	{
+	}
+
+	FUploadHeap::~FUploadHeap()
+	{
+		if (RingBuffer != nullptr)
+		{
+			RingBuffer->Unmap(0, nullptr);
+		}
+
+		for (const auto& DedicatedChunk : DedicatedChunks)
+		{
+			DedicatedChunk.Resource->Unmap(0, nullptr);
+		}
+	}
+
+	void FUploadHeap::SetDevice(ComPtr<ID3D12Device> Device)
+	{
+		if (Device == nullptr)
+		{
+			throw std::invalid_argument("Device must be not nullptr");
+		}
+
+		if (Device == this->Device)
+		{
+			return;
+		}
+
+		if (RingBuffer != nullptr)
+		{
+			RingBuffer->Unmap(0, nullptr);
+		}
+
+		this->Device = Device;
+		RingBuffer = CreateBuffer(Ring.GetSize(), RingMappedData);
+	}
+
+	FUploadAllocation FUploadHeap::Allocate(uint64 Size, uint64 Alignment)
+	{
+		if (RingBuffer == nullptr)
+		{
+			throw std::invalid_argument("Device must be set");
+		}
+
+		FUploadAllocation Allocation;
+		const auto RingAllocation = Ring.Allocate(Size, Alignment);
+		if (RingAllocation.IsValid())
+		{
+			Allocation.Resource = RingBuffer.Get();
+			Allocation.Offset = RingAllocation.Offset;
+			Allocation.MappedData = RingMappedData + RingAllocation.Offset;
+		}
+		else
+		{
+			// Uploads larger than the ring or ones which don't fit until frames in flight are completed
+			FDedicatedChunk DedicatedChunk;
+			DedicatedChunk.Resource = CreateBuffer(Size, Allocation.MappedData);
+			DedicatedChunk.Size = Size;
+
+			Allocation.Resource = DedicatedChunk.Resource.Get();
+			DedicatedChunks.push_back(std::move(DedicatedChunk));
+			++NumDedicatedUploads;
+		}
+
+		UploadedSize += Size;
+		++NumUploads;
+		return Allocation;
+	}
+
+	void FUploadHeap::Retire(std::vector<ComPtr<ID3D12Resource>> Resources)
+	{
+		for (auto& Resource : Resources)
+		{
+			if (Resource != nullptr)
+			{
+				FRetiredResource RetiredResource;
+				RetiredResource.Resource = std::move(Resource);
+				RetiredResources.push_back(std::move(RetiredResource));
+			}
+		}
+	}
+
+	void FUploadHeap::Submit(uint64 FenceValue)
+	{
+		Ring.Submit(FenceValue);
+
+		for (auto& DedicatedChunk : DedicatedChunks)
+		{
+			if (DedicatedChunk.FenceValue == PendingFenceValue)
+			{
+				DedicatedChunk.FenceValue = FenceValue;
+			}
+		}
+
+		for (auto& RetiredResource : RetiredResources)
+		{
+			if (RetiredResource.FenceValue == PendingFenceValue)
+			{
+				RetiredResource.FenceValue = FenceValue;
+			}
+		}
+	}
+
+	void FUploadHeap::Reclaim(uint64 CompletedFenceValue)
+	{
+		Ring.Reclaim(CompletedFenceValue);
+
+		const auto NewDedicatedChunksEnd = std::remove_if(DedicatedChunks.begin(), DedicatedChunks.end(),
+			[CompletedFenceValue](const FDedicatedChunk& DedicatedChunk)
+		{
+			return DedicatedChunk.FenceValue <= CompletedFenceValue;
+		});
+
+		for (auto DedicatedChunkIter = NewDedicatedChunksEnd; DedicatedChunkIter != DedicatedChunks.end(); ++DedicatedChunkIter)
+		{
+			DedicatedChunkIter->Resource->Unmap(0, nullptr);
+		}
+
+		DedicatedChunks.erase(NewDedicatedChunksEnd, DedicatedChunks.end());
+
+		RetiredResources.erase(std::remove_if(RetiredResources.begin(), RetiredResources.end(),
+			[CompletedFenceValue](const FRetiredResource& RetiredResource)
+		{
+			return RetiredResource.FenceValue <= CompletedFenceValue;
+		}), RetiredResources.end());
+	}
+
+	FUploadHeapStats FUploadHeap::GetStats() const
+	{
+		FUploadHeapStats Stats;
+		Stats.RingSize = RingBuffer != nullptr ? Ring.GetSize() : 0;
+		Stats.RingUsedSize = Ring.GetUsedSize();
+		Stats.NumDedicatedChunks = static_cast<uint32>(DedicatedChunks.size());
+		for (const auto& DedicatedChunk : DedicatedChunks)
+		{
+			Stats.DedicatedChunksSize += DedicatedChunk.Size;
+		}
+
+		Stats.NumRetiredResources = static_cast<uint32>(RetiredResources.size());
+
+		Stats.UploadedSize = UploadedSize;
+		Stats.NumUploads = NumUploads;
+		Stats.NumDedicatedUploads = NumDedicatedUploads;
+		return Stats;
+	}
+
+	ComPtr<ID3D12Resource> FUploadHeap::CreateBuffer(uint64 Size, uint8*& MappedData) const
+	{
+		ComPtr<ID3D12Resource> Buffer;
+		DX::ThrowIfFailed(Device->CreateCommittedResource(
+			&CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+			D3D12_HEAP_FLAG_NONE,
+			&CD3DX12_RESOURCE_DESC::Buffer(Size),
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(&Buffer)));
+
+		// Upload buffers stay mapped for their whole lifetime
+		DX::ThrowIfFailed(Buffer->Map(0, nullptr, reinterpret_cast<void**>(&MappedData)));
+		return Buffer;
+	}
+}
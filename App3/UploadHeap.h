@@ -0,0 +1,171 @@
+#pragma once
+
+#include <vector>
+
+#include "pch.h"
+#include "UploadRing.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FUploadAllocation
+	 *
+	 * \brief Mapped range of a staging buffer of FUploadHeap. Copies from it are recorded by the caller
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FUploadAllocation
+	{
+		ID3D12Resource* Resource = nullptr;
+
+		uint64 Offset = 0;
+
+		// CPU address of the range
+		uint8* MappedData = nullptr;
+	};
+
+	/*!
+	 * \struct FUploadHeapStats
+	 *
+	 * \brief Staging memory of FUploadHeap
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FUploadHeapStats
+	{
+		uint64 RingSize = 0;
+		uint64 RingUsedSize = 0;
+
+		// Chunks of uploads which didn't fit the ring and aren't reclaimed yet
+		uint32 NumDedicatedChunks = 0;
+		uint64 DedicatedChunksSize = 0;
+
+		// Retired resources which aren't released yet
+		uint32 NumRetiredResources = 0;
+
+		// All bytes staged since creation
+		uint64 UploadedSize = 0;
+
+		uint32 NumUploads = 0;
+		uint32 NumDedicatedUploads = 0;
+
+		/** @brief Returns staging memory which is kept now
+		  * @return (uint64)
+		  */
+		uint64 GetReservedSize() const noexcept
+		{
+			return RingSize + DedicatedChunksSize;
+		}
+	};
+
+	/*!
+	 * \class FUploadHeap
+	 *
+	 * \brief Staging memory shared by all uploads of resources. Uploads are suballocated from a persistently
+	 * mapped ring (see FUploadRing) and recycled when fences of their submissions are completed.
+	 * Uploads which don't fit the ring get dedicated chunks, which are released the same way
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FUploadHeap
+	{
+	public:
+		static constexpr uint64 DefaultRingSize = 4 * 1024 * 1024;
+
+		// Alignment of buffers' uploads
+		static constexpr uint64 DefaultAlignment = 16;
+
+		/** @brief
+		  * @param RingSize Size of the ring in bytes. It's allocated by SetDevice (uint64)
+		  */
+		explicit FUploadHeap(uint64 RingSize = DefaultRingSize);
+		~FUploadHeap();
+
+		FUploadHeap& operator=(const FUploadHeap& UploadHeap) = delete;
+		FUploadHeap(const FUploadHeap& UploadHeap) = delete;
+		FUploadHeap(FUploadHeap&& UploadHeap) = delete;
+
+		/** @brief Method set dx12 device and creates the ring's buffer. It'll be used for dedicated chunks
+		  * @param Device DX12 Device (ComPtr<ID3D12Device>)
+		  * @return (void)
+		  */
+		void SetDevice(ComPtr<ID3D12Device> Device);
+
+		/** @brief Allocates a range of the ring or a dedicated chunk. It must be alive until copies from it
+		  * are executed, so it's freed by Reclaim after it's submitted
+		  *	(The Device must be set!)
+		  * @param Size Positive number of bytes (uint64)
+		  * @param Alignment Power of two up to 64KB (uint64)
+		  * @return (WoodenEngine::FUploadAllocation)
+		  */
+		FUploadAllocation Allocate(uint64 Size, uint64 Alignment = DefaultAlignment);
+
+		/** @brief Tags uploads allocated since the previous submit with the fence value.
+		  * Command lists with their copies must be executed before the fence is signaled with the value
+		  * @param FenceValue (uint64)
+		  * @return (void)
+		  */
+		void Submit(uint64 FenceValue);
+
+		/** @brief Keeps resources which frames in flight may use, like replaced or evicted ones.
+		  * They're tagged by the next Submit and released by Reclaim as uploads are
+		  * @param Resources (std::vector<ComPtr<ID3D12Resource>>)
+		  * @return (void)
+		  */
+		void Retire(std::vector<ComPtr<ID3D12Resource>> Resources);
+
+		/** @brief Recycles uploads and releases retired resources whose fence values are completed
+		  * @param CompletedFenceValue (uint64)
+		  * @return (void)
+		  */
+		void Reclaim(uint64 CompletedFenceValue);
+
+		FUploadHeapStats GetStats() const;
+
+	private:
+		// Not submitted chunks have this fence value
+		static constexpr uint64 PendingFenceValue = UINT64_MAX;
+
+		struct FDedicatedChunk
+		{
+			ComPtr<ID3D12Resource> Resource;
+
+			uint64 Size = 0;
+
+			uint64 FenceValue = PendingFenceValue;
+		};
+
+		/** @brief Creates a mapped buffer of the upload heap
+		  * @param Size (uint64)
+		  * @param MappedData (uint8 * &)
+		  * @return (ComPtr<ID3D12Resource>)
+		  */
+		ComPtr<ID3D12Resource> CreateBuffer(uint64 Size, uint8*& MappedData) const;
+
+		ComPtr<ID3D12Device> Device;
+
+		FUploadRing Ring;
+
+		ComPtr<ID3D12Resource> RingBuffer;
+
+		uint8* RingMappedData = nullptr;
+
+		std::vector<FDedicatedChunk> DedicatedChunks;
+
+		struct FRetiredResource
+		{
+			ComPtr<ID3D12Resource> Resource;
+
+			uint64 FenceValue = PendingFenceValue;
+		};
+
+		std::vector<FRetiredResource> RetiredResources;
+
+		uint64 UploadedSize = 0;
+		uint32 NumUploads = 0;
+		uint32 NumDedicatedUploads = 0;
+	};
+}
@@ -0,0 +1,121 @@
+#include <stdexcept>
+
+#include "UploadRing.h"
+
+namespace WoodenEngine
+{
+	FUploadRing::FUploadRing(uint64 Size):
+		Size(Size)
+	{
+		if (Size == 0)
+		{
+			throw std::invalid_argument("Size must be positive");
+		}
+	}
+
+	FUploadRingAllocation FUploadRing::Allocate(uint64 Size, uint64 Alignment)
+	{
+		if (Size == 0)
+		{
+			throw std::invalid_argument("Size must be positive");
+		}
+
+		if (Alignment == 0 || (Alignment & (Alignment - 1)) != 0 || this->Size % Alignment != 0)
+		{
+			throw std::invalid_argument("Alignment must be a power of two which divides the ring's size");
+		}
+
+		FUploadRingAllocation Allocation;
+		if (Size > this->Size)
+		{
+			return Allocation;
+		}
+
+		auto Start = Head;
+		auto Offset = (Start % this->Size + Alignment - 1) & ~(Alignment - 1);
+
+		// Ranges aren't split by the end of the buffer, so its rest is skipped
+		if (Offset + Size > this->Size)
+		{
+			Start += this->Size - Start % this->Size;
+			Offset = 0;
+
+			// The skipped rest of an empty ring isn't used by anything
+			if (Head == Tail)
+			{
+				Tail = Start;
+				SubmittedHead = Start;
+			}
+		}
+
+		const auto NewHead = Start - Start % this->Size + Offset + Size;
+		if (NewHead - Tail > this->Size)
+		{
+			return Allocation;
+		}
+
+		Head = NewHead;
+
+		Allocation.Offset = Offset;
+		Allocation.Size = Size;
+		return Allocation;
+	}
+
+	void FUploadRing::Submit(uint64 FenceValue)
+	{
+		if (FenceValue < LastFenceValue)
+		{
+			throw std::invalid_argument("Fence values must not decrease");
+		}
+
+		LastFenceValue = FenceValue;
+		if (Head == SubmittedHead)
+		{
+			return;
+		}
+
+		// Ranges submitted with the same fence value are freed together
+		if (!Submissions.empty() && Submissions.back().FenceValue == FenceValue)
+		{
+			Submissions.back().End = Head;
+		}
+		else
+		{
+			FSubmission Submission;
+			Submission.FenceValue = FenceValue;
+			Submission.End = Head;
+			Submissions.push_back(Submission);
+		}
+
+		SubmittedHead = Head;
+	}
+
+	void FUploadRing::Reclaim(uint64 CompletedFenceValue)
+	{
+		while (!Submissions.empty() && Submissions.front().FenceValue <= CompletedFenceValue)
+		{
+			Tail = Submissions.front().End;
+			Submissions.pop_front();
+		}
+	}
+
+	uint64 FUploadRing::GetSize() const noexcept
+	{
+		return Size;
+	}
+
+	uint64 FUploadRing::GetUsedSize() const noexcept
+	{
+		return Head - Tail;
+	}
+
+	uint32 FUploadRing::GetNumSubmissions() const noexcept
+	{
+		return static_cast<uint32>(Submissions.size());
+	}
+
+	bool FUploadRing::IsEmpty() const noexcept
+	{
+		return Head == Tail;
+	}
+}
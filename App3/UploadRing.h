@@ -0,0 +1,108 @@
+#pragma once
+
+#include <deque>
+
+#include "pch.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FUploadRingAllocation
+	 *
+	 * \brief Range allocated by FUploadRing
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FUploadRingAllocation
+	{
+		static constexpr uint64 InvalidOffset = UINT64_MAX;
+
+		uint64 Offset = InvalidOffset;
+		uint64 Size = 0;
+
+		bool IsValid() const noexcept
+		{
+			return Offset != InvalidOffset;
+		}
+	};
+
+	/*!
+	 * \class FUploadRing
+	 *
+	 * \brief Ring of ranges of a staging buffer. Ranges are allocated one after another and wrap to the start
+	 * of the buffer. Submit tags all ranges allocated since the previous submit with the fence value
+	 * of their submission, and Reclaim frees them when the fence is completed.
+	 * It doesn't touch the buffer or the fence, so it's used without a device
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FUploadRing
+	{
+	public:
+		/** @brief
+		  * @param Size Size of the staging buffer in bytes (uint64)
+		  */
+		explicit FUploadRing(uint64 Size);
+		~FUploadRing() = default;
+
+		FUploadRing& operator=(const FUploadRing& UploadRing) = delete;
+		FUploadRing(const FUploadRing& UploadRing) = delete;
+		FUploadRing(FUploadRing&& UploadRing) = delete;
+
+		/** @brief Allocates a range after the last one or at the start of the buffer
+		  * @param Size Positive number of bytes (uint64)
+		  * @param Alignment Power of two which divides the buffer's size (uint64)
+		  * @return Invalid allocation if the range doesn't fit until the next reclaim (WoodenEngine::FUploadRingAllocation)
+		  */
+		FUploadRingAllocation Allocate(uint64 Size, uint64 Alignment);
+
+		/** @brief Tags ranges allocated since the previous submit with the fence value.
+		  * Copies from them must be submitted before the fence is signaled with the value
+		  * @param FenceValue Not less than previous ones (uint64)
+		  * @return (void)
+		  */
+		void Submit(uint64 FenceValue);
+
+		/** @brief Frees ranges of submissions whose fence values are completed. Not submitted ranges are kept
+		  * @param CompletedFenceValue (uint64)
+		  * @return (void)
+		  */
+		void Reclaim(uint64 CompletedFenceValue);
+
+		uint64 GetSize() const noexcept;
+
+		/** @brief Returns bytes of not reclaimed ranges including padding and the skipped end of the buffer
+		  * @return (uint64)
+		  */
+		uint64 GetUsedSize() const noexcept;
+
+		uint32 GetNumSubmissions() const noexcept;
+
+		bool IsEmpty() const noexcept;
+
+	private:
+		struct FSubmission
+		{
+			uint64 FenceValue = 0;
+
+			// Head when the submission was made. Ranges before it are freed with the submission
+			uint64 End = 0;
+		};
+
+		uint64 Size = 0;
+
+		// Head and tail grow monotonically. Offsets in the buffer are their remainders of Size
+		uint64 Head = 0;
+		uint64 Tail = 0;
+
+		// Head of the last submission
+		uint64 SubmittedHead = 0;
+
+		uint64 LastFenceValue = 0;
+
+		// Submissions in order of their fence values
+		std::deque<FSubmission> Submissions;
+	};
+}
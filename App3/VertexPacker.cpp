@@ -0,0 +1,412 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <DirectXPackedVector.h>
+#include <ppl.h>
+
+#include "VertexPacker.h"
+
+namespace WoodenEngine
+{
+	using namespace DirectX::PackedVector;
+
+	namespace
+	{
+		constexpr uint32 NormalBitsMax = 1023;
+		constexpr uint32 UNorm16Max = 65535;
+
+		uint32 QuantizeUNorm(float Value, uint32 Max)
+		{
+			const auto Saturated = std::min(std::max(Value, 0.0f), 1.0f);
+			return static_cast<uint32>(Saturated*Max + 0.5f);
+		}
+
+		float Dot(const XMFLOAT3& V0, const XMFLOAT3& V1)
+		{
+			return V0.x*V1.x + V0.y*V1.y + V0.z*V1.z;
+		}
+
+		XMFLOAT3 Normalize(const XMFLOAT3& V)
+		{
+			const auto Length = sqrtf(Dot(V, V));
+			if (Length <= FLT_EPSILON)
+			{
+				return { 0.0f, 0.0f, 0.0f };
+			}
+			return { V.x / Length, V.y / Length, V.z / Length };
+		}
+
+		float AngleBetween(const XMFLOAT3& V0, const XMFLOAT3& V1)
+		{
+			const auto CosAngle = std::min(std::max(Dot(V0, V1), -1.0f), 1.0f);
+			return XMConvertToDegrees(acosf(CosAngle));
+		}
+
+		// Octahedral mapping of a unit vector to [0, 1]^2
+		XMFLOAT2 EncodeOctahedral(const XMFLOAT3& Normal)
+		{
+			const auto InvL1Norm = 1.0f / (fabsf(Normal.x) + fabsf(Normal.y) + fabsf(Normal.z));
+			auto X = Normal.x*InvL1Norm;
+			auto Y = Normal.y*InvL1Norm;
+
+			// Lower hemisphere is folded over the diagonals
+			if (Normal.z < 0.0f)
+			{
+				const auto FoldedX = (1.0f - fabsf(Y))*(X >= 0.0f ? 1.0f : -1.0f);
+				const auto FoldedY = (1.0f - fabsf(X))*(Y >= 0.0f ? 1.0f : -1.0f);
+				X = FoldedX;
+				Y = FoldedY;
+			}
+
+			return { X*0.5f + 0.5f, Y*0.5f + 0.5f };
+		}
+
+		XMFLOAT3 DecodeOctahedral(float U, float V)
+		{
+			XMFLOAT3 Normal = { U*2.0f - 1.0f, V*2.0f - 1.0f, 0.0f };
+			Normal.z = 1.0f - fabsf(Normal.x) - fabsf(Normal.y);
+
+			const auto Fold = std::max(-Normal.z, 0.0f);
+			Normal.x += Normal.x >= 0.0f ? -Fold : Fold;
+			Normal.y += Normal.y >= 0.0f ? -Fold : Fold;
+
+			return Normalize(Normal);
+		}
+
+		// Orthonormal basis of the plane orthogonal to the normal.
+		// Tangent's angle is measured from Basis0 to Basis1
+		void BuildTangentBasis(const XMFLOAT3& Normal, XMFLOAT3* Basis0, XMFLOAT3* Basis1)
+		{
+			if (fabsf(Normal.x) > fabsf(Normal.z))
+			{
+				*Basis0 = Normalize({ -Normal.y, Normal.x, 0.0f });
+			}
+			else
+			{
+				*Basis0 = Normalize({ 0.0f, -Normal.z, Normal.y });
+			}
+
+			*Basis1 = {
+				Normal.y*Basis0->z - Normal.z*Basis0->y,
+				Normal.z*Basis0->x - Normal.x*Basis0->z,
+				Normal.x*Basis0->y - Normal.y*Basis0->x
+			};
+		}
+	}
+
+	FVertexPackingStats FVertexPacker::Pack(
+		const FMeshRawData& MeshData,
+		EVertexFormat VertexFormat,
+		uint8* DstVertices,
+		SVertexQuantizationData* Quantization) const
+	{
+		const auto& Vertices = MeshData.Vertices;
+		const auto NumVertices = Vertices.size();
+		const auto VertexStride = GetVertexStride(VertexFormat);
+
+		FVertexPackingStats Stats;
+		Stats.NumBytesBefore = NumVertices*sizeof(SVertexData);
+		Stats.NumBytesAfter = NumVertices*VertexStride;
+
+		*Quantization = SVertexQuantizationData();
+		if (NumVertices == 0)
+		{
+			return Stats;
+		}
+
+		// Positions and uvs are quantized in the mesh's bounds
+		if (VertexFormat == EVertexFormat::Quantized)
+		{
+			auto MinPosition = XMLoadFloat3(&Vertices[0].Position);
+			auto MaxPosition = MinPosition;
+			auto MinTexC = XMLoadFloat2(&Vertices[0].TexC);
+			auto MaxTexC = MinTexC;
+			for (const auto& Vertex : Vertices)
+			{
+				const auto Position = XMLoadFloat3(&Vertex.Position);
+				const auto TexC = XMLoadFloat2(&Vertex.TexC);
+				MinPosition = XMVectorMin(MinPosition, Position);
+				MaxPosition = XMVectorMax(MaxPosition, Position);
+				MinTexC = XMVectorMin(MinTexC, TexC);
+				MaxTexC = XMVectorMax(MaxTexC, TexC);
+			}
+
+			XMStoreFloat3(&Quantization->PositionScale, MaxPosition - MinPosition);
+			XMStoreFloat3(&Quantization->PositionOffset, MinPosition);
+			XMStoreFloat2(&Quantization->TexCScale, MaxTexC - MinTexC);
+			XMStoreFloat2(&Quantization->TexCOffset, MinTexC);
+		}
+
+		const auto& PositionScale = Quantization->PositionScale;
+		const auto& PositionOffset = Quantization->PositionOffset;
+		const auto& TexCScale = Quantization->TexCScale;
+		const auto& TexCOffset = Quantization->TexCOffset;
+
+		// Degenerate axes of bounds are stored as zeros
+		auto Normalized = [](float Value, float Offset, float Scale)
+		{
+			return Scale > 0.0f ? (Value - Offset) / Scale : 0.0f;
+		};
+
+		const auto NumChunks = (NumVertices + NumVerticesPerChunk - 1) / NumVerticesPerChunk;
+		concurrency::parallel_for(std::size_t(0), NumChunks, [&](std::size_t iChunk)
+		{
+			const auto ChunkBegin = iChunk*NumVerticesPerChunk;
+			const auto ChunkEnd = std::min(ChunkBegin + NumVerticesPerChunk, NumVertices);
+			for (auto iVertex = ChunkBegin; iVertex < ChunkEnd; ++iVertex)
+			{
+				const auto& Vertex = Vertices[iVertex];
+				auto DstVertex = DstVertices + iVertex*VertexStride;
+
+				switch (VertexFormat)
+				{
+				case EVertexFormat::Full:
+				{
+					SVertexData FullVertex = { Vertex.Position, Vertex.Normal, Vertex.TexC };
+					memcpy(DstVertex, &FullVertex, sizeof(FullVertex));
+					break;
+				}
+				case EVertexFormat::Packed:
+				{
+					SPackedVertexData PackedVertex;
+					PackedVertex.Position = Vertex.Position;
+					PackedVertex.NormalTangent = EncodeNormalTangent(Vertex.Normal, Vertex.Tangent);
+					PackedVertex.TexC[0] = XMConvertFloatToHalf(Vertex.TexC.x);
+					PackedVertex.TexC[1] = XMConvertFloatToHalf(Vertex.TexC.y);
+					memcpy(DstVertex, &PackedVertex, sizeof(PackedVertex));
+					break;
+				}
+				case EVertexFormat::Quantized:
+				{
+					SQuantizedVertexData QuantizedVertex;
+					QuantizedVertex.Position[0] = QuantizeUNorm(
+						Normalized(Vertex.Position.x, PositionOffset.x, PositionScale.x), UNorm16Max);
+					QuantizedVertex.Position[1] = QuantizeUNorm(
+						Normalized(Vertex.Position.y, PositionOffset.y, PositionScale.y), UNorm16Max);
+					QuantizedVertex.Position[2] = QuantizeUNorm(
+						Normalized(Vertex.Position.z, PositionOffset.z, PositionScale.z), UNorm16Max);
+					QuantizedVertex.Position[3] = 0;
+					QuantizedVertex.NormalTangent = EncodeNormalTangent(Vertex.Normal, Vertex.Tangent);
+					QuantizedVertex.TexC[0] = QuantizeUNorm(
+						Normalized(Vertex.TexC.x, TexCOffset.x, TexCScale.x), UNorm16Max);
+					QuantizedVertex.TexC[1] = QuantizeUNorm(
+						Normalized(Vertex.TexC.y, TexCOffset.y, TexCScale.y), UNorm16Max);
+					memcpy(DstVertex, &QuantizedVertex, sizeof(QuantizedVertex));
+					break;
+				}
+				}
+			}
+		});
+
+		return Stats;
+	}
+
+	FVertexPackingStats FVertexPacker::MeasureErrors(
+		const FMeshRawData& MeshData,
+		EVertexFormat VertexFormat,
+		const uint8* PackedVertices,
+		const SVertexQuantizationData& Quantization)
+	{
+		const auto& Vertices = MeshData.Vertices;
+		const auto NumVertices = Vertices.size();
+		const auto VertexStride = GetVertexStride(VertexFormat);
+
+		FVertexPackingStats Stats;
+		Stats.NumBytesBefore = NumVertices*sizeof(SVertexData);
+		Stats.NumBytesAfter = NumVertices*VertexStride;
+
+		const auto NumChunks = (NumVertices + NumVerticesPerChunk - 1) / NumVerticesPerChunk;
+		std::vector<FVertexPackingStats> ChunksStats(NumChunks);
+
+		concurrency::parallel_for(std::size_t(0), NumChunks, [&](std::size_t iChunk)
+		{
+			auto& ChunkStats = ChunksStats[iChunk];
+
+			const auto ChunkEnd = std::min((iChunk + 1)*NumVerticesPerChunk, NumVertices);
+			for (auto iVertex = iChunk*NumVerticesPerChunk; iVertex < ChunkEnd; ++iVertex)
+			{
+				const auto& Vertex = Vertices[iVertex];
+				const auto DecodedVertex = Unpack(PackedVertices + iVertex*VertexStride, VertexFormat, Quantization);
+
+				const auto PositionError = XMVectorGetX(XMVector3Length(
+					XMLoadFloat3(&DecodedVertex.Position) - XMLoadFloat3(&Vertex.Position)));
+				ChunkStats.MaxPositionError = std::max(ChunkStats.MaxPositionError, PositionError);
+
+				const auto TexCError = XMVectorGetX(XMVector2Length(
+					XMLoadFloat2(&DecodedVertex.TexC) - XMLoadFloat2(&Vertex.TexC)));
+				ChunkStats.MaxTexCError = std::max(ChunkStats.MaxTexCError, TexCError);
+
+				const auto Normal = Normalize(Vertex.Normal);
+				if (Dot(Normal, Normal) == 0.0f)
+				{
+					continue;
+				}
+
+				ChunkStats.MaxNormalError = std::max(ChunkStats.MaxNormalError,
+					AngleBetween(Normal, Normalize(DecodedVertex.Normal)));
+
+				// Only the part of tangent orthogonal to the normal is encoded
+				const auto NormalTangentDot = Dot(Normal, Vertex.Tangent);
+				const auto Tangent = Normalize({
+					Vertex.Tangent.x - Normal.x*NormalTangentDot,
+					Vertex.Tangent.y - Normal.y*NormalTangentDot,
+					Vertex.Tangent.z - Normal.z*NormalTangentDot });
+				if (VertexFormat != EVertexFormat::Full && Dot(Tangent, Tangent) > 0.0f)
+				{
+					ChunkStats.MaxTangentError = std::max(ChunkStats.MaxTangentError,
+						AngleBetween(Tangent, DecodedVertex.Tangent));
+				}
+			}
+		});
+
+		for (const auto& ChunkStats : ChunksStats)
+		{
+			Stats.MaxPositionError = std::max(Stats.MaxPositionError, ChunkStats.MaxPositionError);
+			Stats.MaxNormalError = std::max(Stats.MaxNormalError, ChunkStats.MaxNormalError);
+			Stats.MaxTangentError = std::max(Stats.MaxTangentError, ChunkStats.MaxTangentError);
+			Stats.MaxTexCError = std::max(Stats.MaxTexCError, ChunkStats.MaxTexCError);
+		}
+
+		return Stats;
+	}
+
+	FVertex FVertexPacker::Unpack(
+		const uint8* SrcVertex,
+		EVertexFormat VertexFormat,
+		const SVertexQuantizationData& Quantization) noexcept
+	{
+		FVertex Vertex;
+		Vertex.Tangent = { 0.0f, 0.0f, 0.0f };
+
+		switch (VertexFormat)
+		{
+		case EVertexFormat::Full:
+		{
+			SVertexData FullVertex;
+			memcpy(&FullVertex, SrcVertex, sizeof(FullVertex));
+			Vertex.Position = FullVertex.Position;
+			Vertex.Normal = FullVertex.Normal;
+			Vertex.TexC = FullVertex.TexC;
+			break;
+		}
+		case EVertexFormat::Packed:
+		{
+			SPackedVertexData PackedVertex;
+			memcpy(&PackedVertex, SrcVertex, sizeof(PackedVertex));
+			Vertex.Position = PackedVertex.Position;
+			DecodeNormalTangent(PackedVertex.NormalTangent, &Vertex.Normal, &Vertex.Tangent);
+			Vertex.TexC = {
+				XMConvertHalfToFloat(PackedVertex.TexC[0]),
+				XMConvertHalfToFloat(PackedVertex.TexC[1]) };
+			break;
+		}
+		case EVertexFormat::Quantized:
+		{
+			SQuantizedVertexData QuantizedVertex;
+			memcpy(&QuantizedVertex, SrcVertex, sizeof(QuantizedVertex));
+
+			const auto& PositionScale = Quantization.PositionScale;
+			const auto& PositionOffset = Quantization.PositionOffset;
+			Vertex.Position = {
+				float(QuantizedVertex.Position[0]) / UNorm16Max*PositionScale.x + PositionOffset.x,
+				float(QuantizedVertex.Position[1]) / UNorm16Max*PositionScale.y + PositionOffset.y,
+				float(QuantizedVertex.Position[2]) / UNorm16Max*PositionScale.z + PositionOffset.z };
+
+			DecodeNormalTangent(QuantizedVertex.NormalTangent, &Vertex.Normal, &Vertex.Tangent);
+
+			Vertex.TexC = {
+				float(QuantizedVertex.TexC[0]) / UNorm16Max*Quantization.TexCScale.x + Quantization.TexCOffset.x,
+				float(QuantizedVertex.TexC[1]) / UNorm16Max*Quantization.TexCScale.y + Quantization.TexCOffset.y };
+			break;
+		}
+		}
+
+		return Vertex;
+	}
+
+	uint32 FVertexPacker::GetVertexStride(EVertexFormat VertexFormat) noexcept
+	{
+		switch (VertexFormat)
+		{
+		case EVertexFormat::Packed:
+			return sizeof(SPackedVertexData);
+		case EVertexFormat::Quantized:
+			return sizeof(SQuantizedVertexData);
+		default:
+			return sizeof(SVertexData);
+		}
+	}
+
+	SPackedNormalTangent FVertexPacker::EncodeNormalTangent(
+		const XMFLOAT3& Normal,
+		const XMFLOAT3& Tangent) noexcept
+	{
+		auto UnitNormal = Normalize(Normal);
+		if (Dot(UnitNormal, UnitNormal) == 0.0f)
+		{
+			UnitNormal = { 0.0f, 1.0f, 0.0f };
+		}
+
+		// Picks the closest to the normal of 4 neighboring quantized octahedral points
+		const auto Octahedral = EncodeOctahedral(UnitNormal);
+		const auto U = std::min(std::max(Octahedral.x, 0.0f), 1.0f)*NormalBitsMax;
+		const auto V = std::min(std::max(Octahedral.y, 0.0f), 1.0f)*NormalBitsMax;
+
+		uint32 BestU = 0;
+		uint32 BestV = 0;
+		XMFLOAT3 DecodedNormal = { 0.0f, 0.0f, 0.0f };
+		auto BestDot = -2.0f;
+		for (auto iCandidate = 0; iCandidate < 4; ++iCandidate)
+		{
+			const auto CandidateU = std::min(static_cast<uint32>(
+				(iCandidate & 1) ? ceilf(U) : floorf(U)), NormalBitsMax);
+			const auto CandidateV = std::min(static_cast<uint32>(
+				(iCandidate & 2) ? ceilf(V) : floorf(V)), NormalBitsMax);
+
+			const auto CandidateNormal = DecodeOctahedral(
+				float(CandidateU) / NormalBitsMax, float(CandidateV) / NormalBitsMax);
+			const auto CandidateDot = Dot(CandidateNormal, UnitNormal);
+			if (CandidateDot > BestDot)
+			{
+				BestDot = CandidateDot;
+				BestU = CandidateU;
+				BestV = CandidateV;
+				DecodedNormal = CandidateNormal;
+			}
+		}
+
+		// Tangent's angle is measured around the decoded normal, as the shader will see it
+		XMFLOAT3 Basis0;
+		XMFLOAT3 Basis1;
+		BuildTangentBasis(DecodedNormal, &Basis0, &Basis1);
+
+		const auto Angle = atan2f(Dot(Tangent, Basis1), Dot(Tangent, Basis0));
+		const auto Alpha = QuantizeUNorm(Angle / XM_2PI + 0.5f, NormalBitsMax);
+
+		return BestU | (BestV << 10) | (Alpha << 20);
+	}
+
+	void FVertexPacker::DecodeNormalTangent(
+		SPackedNormalTangent NormalTangent,
+		XMFLOAT3* Normal,
+		XMFLOAT3* Tangent) noexcept
+	{
+		const auto U = float(NormalTangent & NormalBitsMax) / NormalBitsMax;
+		const auto V = float((NormalTangent >> 10) & NormalBitsMax) / NormalBitsMax;
+		const auto Alpha = float((NormalTangent >> 20) & NormalBitsMax) / NormalBitsMax;
+
+		*Normal = DecodeOctahedral(U, V);
+
+		XMFLOAT3 Basis0;
+		XMFLOAT3 Basis1;
+		BuildTangentBasis(*Normal, &Basis0, &Basis1);
+
+		const auto Angle = (Alpha - 0.5f)*XM_2PI;
+		const auto CosAngle = cosf(Angle);
+		const auto SinAngle = sinf(Angle);
+		*Tangent = {
+			Basis0.x*CosAngle + Basis1.x*SinAngle,
+			Basis0.y*CosAngle + Basis1.y*SinAngle,
+			Basis0.z*CosAngle + Basis1.z*SinAngle };
+	}
+}
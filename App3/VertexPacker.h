@@ -0,0 +1,122 @@
+#pragma once
+
+#include "MeshData.h"
+
+namespace WoodenEngine
+{
+	/*!
+	 * \struct FVertexPackingStats
+	 *
+	 * \brief Sizes of a mesh's vertices before and after packing and
+	 * max errors of their encode/decode round-trip (measured by FVertexPacker::MeasureErrors)
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	struct FVertexPackingStats
+	{
+		// Size of vertices in the full format (SVertexData)
+		uint64 NumBytesBefore = 0;
+		uint64 NumBytesAfter = 0;
+
+		// Distance between source and decoded positions in mesh's units
+		float MaxPositionError = 0.0f;
+
+		// Angles between source and decoded normals/tangents in degrees
+		float MaxNormalError = 0.0f;
+		float MaxTangentError = 0.0f;
+
+		float MaxTexCError = 0.0f;
+	};
+
+	/*!
+	 * \class FVertexPacker
+	 *
+	 * \brief Encodes vertices of static meshes to compact GPU formats (EVertexFormat).
+	 * Normal is octahedral-encoded, tangent is stored as an angle around the decoded normal,
+	 * so both take 32 bits. Normal is decoded the same way by Shaders\VertexPacking.hlsl.
+	 * Shaders don't use tangents yet, so the tangent is decoded by DecodeNormalTangent only
+	 *
+	 * \author devmi
+	 * \date October 2018
+	 */
+	class FVertexPacker
+	{
+	public:
+		FVertexPacker() = default;
+		~FVertexPacker() = default;
+
+		FVertexPacker& operator=(const FVertexPacker& VertexPacker) = delete;
+		FVertexPacker(const FVertexPacker& VertexPacker) = delete;
+		FVertexPacker(FVertexPacker&& VertexPacker) = delete;
+
+		/** @brief Encodes vertices of the mesh
+		  * @param MeshData Mesh data (const FMeshRawData &)
+		  * @param VertexFormat Format of encoded vertices (EVertexFormat)
+		  * @param DstVertices Buffer of at least NumVertices*GetVertexStride(VertexFormat) bytes (uint8 *)
+		  * @param Quantization Outputs decoding constants of the mesh (SVertexQuantizationData *)
+		  * @return Sizes of vertices. Errors are zeros (WoodenEngine::FVertexPackingStats)
+		  */
+		FVertexPackingStats Pack(
+			const FMeshRawData& MeshData,
+			EVertexFormat VertexFormat,
+			uint8* DstVertices,
+			SVertexQuantizationData* Quantization) const;
+
+		/** @brief Decodes vertices encoded by Pack and measures their round-trip errors.
+		  * It decodes every vertex, so it's called by tests and debug builds only
+		  * @param MeshData Source mesh data (const FMeshRawData &)
+		  * @param VertexFormat (EVertexFormat)
+		  * @param PackedVertices Vertices encoded by Pack (const uint8 *)
+		  * @param Quantization Decoding constants returned by Pack (const SVertexQuantizationData &)
+		  * @return Sizes and round-trip errors (WoodenEngine::FVertexPackingStats)
+		  */
+		static FVertexPackingStats MeasureErrors(
+			const FMeshRawData& MeshData,
+			EVertexFormat VertexFormat,
+			const uint8* PackedVertices,
+			const SVertexQuantizationData& Quantization);
+
+		/** @brief Decodes an encoded vertex like the vertex shader does
+		  * @param SrcVertex Encoded vertex (const uint8 *)
+		  * @param VertexFormat (EVertexFormat)
+		  * @param Quantization Decoding constants of the vertex's mesh (const SVertexQuantizationData &)
+		  * @return Decoded vertex. Its tangent is zero for the full format (WoodenEngine::FVertex)
+		  */
+		static FVertex Unpack(
+			const uint8* SrcVertex,
+			EVertexFormat VertexFormat,
+			const SVertexQuantizationData& Quantization) noexcept;
+
+		/** @brief Size of one vertex in the vertex buffer
+		  * @param VertexFormat (EVertexFormat)
+		  * @return (uint32)
+		  */
+		static uint32 GetVertexStride(EVertexFormat VertexFormat) noexcept;
+
+		/** @brief Packs unit normal and tangent to 10:10:10:2 bits.
+		  * Tangent is orthogonalized to normal, zero tangent is replaced with an arbitrary one
+		  * @param Normal (const XMFLOAT3 &)
+		  * @param Tangent (const XMFLOAT3 &)
+		  * @return (WoodenEngine::SPackedNormalTangent)
+		  */
+		static SPackedNormalTangent EncodeNormalTangent(
+			const XMFLOAT3& Normal,
+			const XMFLOAT3& Tangent) noexcept;
+
+		/** @brief Unpacks normal and tangent encoded by EncodeNormalTangent
+		  * @param NormalTangent (SPackedNormalTangent)
+		  * @param Normal (XMFLOAT3 *)
+		  * @param Tangent (XMFLOAT3 *)
+		  * @return (void)
+		  */
+		static void DecodeNormalTangent(
+			SPackedNormalTangent NormalTangent,
+			XMFLOAT3* Normal,
+			XMFLOAT3* Tangent) noexcept;
+
+	private:
+		// Number of vertices encoded by one worker thread
+		static constexpr std::size_t NumVerticesPerChunk = 8192;
+	};
+}
@@ -9,7 +9,19 @@
 #include <DirectXMath.h>
 #include <memory>
 #include <vector>
+#if defined(__cplusplus_winrt)
 #include <agile.h>
+#else
+// Native targets (Tests) are built without C++/CX, which declares these types
+typedef signed __int8 int8;
+typedef signed __int16 int16;
+typedef signed __int32 int32;
+typedef signed __int64 int64;
+typedef unsigned __int8 uint8;
+typedef unsigned __int16 uint16;
+typedef unsigned __int32 uint32;
+typedef unsigned __int64 uint64;
+#endif
 #include <concrt.h>
 #include <string>
 #include "Common\d3dx12.h"
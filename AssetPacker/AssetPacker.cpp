@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "AssetPackage.h"
+
+// Packs loose asset files to an asset package (.wpak), which FGameResource serves from one mapping.
+// Names of entries are the given paths, so they're relative to the game's directory. The package is keyed
+// by sizes and write times of the files, so the game accepts it as Assets.wpak of its cache directory
+// when the files are the ones of FGameMain::InitAssetPackage in the same order.
+// Usage: AssetPacker [--store] <.wpak file> <asset files...>
+int main(int NumArguments, char* Arguments[])
+{
+	using namespace WoodenEngine;
+
+	auto bCompress = true;
+	std::vector<std::string> FilesPaths;
+	for (auto iArgument = 1; iArgument < NumArguments; ++iArgument)
+	{
+		if (std::strcmp(Arguments[iArgument], "--store") == 0)
+		{
+			bCompress = false;
+		}
+		else
+		{
+			FilesPaths.push_back(Arguments[iArgument]);
+		}
+	}
+
+	if (FilesPaths.size() < 2)
+	{
+		std::cout << "Usage: AssetPacker [--store] <.wpak file> <asset files...>\n";
+		return 1;
+	}
+
+	const auto PackageFilePath = FilesPaths[0];
+	FilesPaths.erase(FilesPaths.begin());
+
+	try
+	{
+		std::vector<std::string> FoundFilesPaths;
+		const auto SourceKey = FAssetPackageWriter::GetSourceKey(FilesPaths, FoundFilesPaths);
+		if (FoundFilesPaths.size() != FilesPaths.size())
+		{
+			for (const auto& FilePath : FilesPaths)
+			{
+				if (std::find(FoundFilesPaths.cbegin(), FoundFilesPaths.cend(), FilePath) == FoundFilesPaths.cend())
+				{
+					std::cout << FilePath << " is missing\n";
+				}
+			}
+			return 1;
+		}
+
+		FAssetPackageWriter AssetPackageWriter;
+		for (const auto& FilePath : FilesPaths)
+		{
+			AssetPackageWriter.AddFile(FilePath, bCompress);
+		}
+
+		const auto Stats = AssetPackageWriter.Save(PackageFilePath, SourceKey);
+		std::cout << PackageFilePath << ": " << Stats.NumEntries << " entries (" << Stats.NumCompressedEntries <<
+			" compressed), " << Stats.UncompressedSize << " -> " << Stats.PackageSize << " bytes in " <<
+			Stats.Seconds * 1000.0 << " ms\n";
+
+		// The written package is validated and read as the engine will load it
+		const auto StartTime = std::chrono::high_resolution_clock::now();
+
+		FAssetPackage AssetPackage(PackageFilePath);
+		uint64 NumReadBytes = 0;
+		for (const auto& FilePath : FilesPaths)
+		{
+			const auto Entry = AssetPackage.FindEntry(FilePath);
+			if (Entry == nullptr || AssetPackage.ReadEntry(*Entry).size() != Entry->UncompressedSize)
+			{
+				std::cout << FilePath << " isn't read back from the package\n";
+				return 1;
+			}
+			NumReadBytes += Entry->Size;
+		}
+
+		const std::chrono::duration<double, std::milli> LoadTime = std::chrono::high_resolution_clock::now() - StartTime;
+		std::cout << "Loaded " << AssetPackage.GetNumEntries() << " entries of " << NumReadBytes << " stored bytes in " <<
+			LoadTime.count() << " ms\n";
+	}
+	catch (const std::exception& Exception)
+	{
+		std::cout << PackageFilePath << " isn't packed: " << Exception.what() << "\n";
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,62 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include "MeshFile.h"
+
+// Converts a source mesh (.txt or a scene supported by assimp) to a baked mesh file (.wmesh),
+// which is uploaded by FGameResource::LoadStaticMeshFileAsync without parsing and conversions.
+// Usage: MeshConverter [--packed | --quantized] <source file> <.wmesh file>
+int main(int NumArguments, char* Arguments[])
+{
+	using namespace WoodenEngine;
+
+	FMeshBakeSettings Settings;
+	std::vector<std::string> FilesPaths;
+	for (auto iArgument = 1; iArgument < NumArguments; ++iArgument)
+	{
+		if (std::strcmp(Arguments[iArgument], "--packed") == 0)
+		{
+			Settings.VertexFormat = EVertexFormat::Packed;
+		}
+		else if (std::strcmp(Arguments[iArgument], "--quantized") == 0)
+		{
+			Settings.VertexFormat = EVertexFormat::Quantized;
+		}
+		else
+		{
+			FilesPaths.push_back(Arguments[iArgument]);
+		}
+	}
+
+	if (FilesPaths.size() != 2)
+	{
+		std::cout << "Usage: MeshConverter [--packed | --quantized] <source file> <.wmesh file>\n";
+		return 1;
+	}
+
+	try
+	{
+		const auto StartTime = std::chrono::high_resolution_clock::now();
+
+		FMeshFile::Convert(FilesPaths[0], FilesPaths[1], Settings);
+
+		const std::chrono::duration<double, std::milli> ConvertTime =
+			std::chrono::high_resolution_clock::now() - StartTime;
+
+		// The written file is validated as the engine will load it
+		FMeshFile MeshFile(FilesPaths[1]);
+		const auto& Header = MeshFile.GetHeader();
+		std::cout << FilesPaths[0] << " -> " << FilesPaths[1] << ": " << Header.NumSubmeshes << " submeshes, " <<
+			Header.VerticesSize / Header.VertexStride << " vertices, " << Header.IndicesSize / Header.IndexSize <<
+			" indices, " << Header.NumMeshlets << " meshlets, " << Header.NumMaterials << " materials in " <<
+			ConvertTime.count() << " ms\n";
+	}
+	catch (const std::exception& Exception)
+	{
+		std::cout << FilesPaths[0] << " isn't converted: " << Exception.what() << "\n";
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+
+#include "AssetPackage.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/** @brief Returns data of repeated text, which is compressed well
+			  * @param Size (std::size_t)
+			  * @return (std::vector<uint8>)
+			  */
+			std::vector<uint8> CreateCompressibleData(std::size_t Size)
+			{
+				const std::string Line = "v 0.125 -3.5 2.25\n";
+
+				std::vector<uint8> Data(Size);
+				for (std::size_t iByte = 0; iByte < Size; ++iByte)
+				{
+					Data[iByte] = static_cast<uint8>(Line[iByte % Line.size()]);
+				}
+
+				return Data;
+			}
+
+			/** @brief Returns random bytes, which can't be compressed
+			  * @param Size (std::size_t)
+			  * @return (std::vector<uint8>)
+			  */
+			std::vector<uint8> CreateRandomData(std::size_t Size)
+			{
+				std::mt19937 Random(7);
+				std::uniform_int_distribution<uint32> Distribution(0, 255);
+
+				std::vector<uint8> Data(Size);
+				for (auto& Byte : Data)
+				{
+					Byte = static_cast<uint8>(Distribution(Random));
+				}
+
+				return Data;
+			}
+		}
+
+		TEST(AssetPackageRoundTripsEntries)
+		{
+			const std::string FilePath = "AssetPackageRoundTripsEntries.wpak";
+
+			const std::vector<std::pair<std::string, std::vector<uint8>>> Sources = {
+				{ "Assets/Textures/Grass.DDS", CreateCompressibleData(100000) },
+				{ ".\\Assets\\Models\\rock.wmesh", CreateRandomData(5000) },
+				{ "Assets/empty.bin", {} },
+				{ "Assets/Shaders/VertexShader.cso", CreateCompressibleData(300) } };
+
+			FAssetPackageStats Stats;
+			{
+				FAssetPackageWriter AssetPackageWriter;
+				for (const auto& Source : Sources)
+				{
+					auto Data = Source.second;
+					AssetPackageWriter.AddData(Source.first, std::move(Data), Source.first.find("Shaders") == std::string::npos);
+				}
+
+				// Names differ in case and slashes only
+				CHECK_THROWS(AssetPackageWriter.AddData("assets\\textures\\grass.dds", {}, false), std::invalid_argument);
+				Stats = AssetPackageWriter.Save(FilePath, "sources-1");
+			}
+
+			uint64 FileSize = 0;
+			{
+				std::ifstream File(FilePath, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+				FileSize = static_cast<uint64>(File.tellg());
+			}
+
+			// Random data doesn't save enough, and shaders aren't compressed
+			CHECK_EQUAL(Stats.NumEntries, 4u);
+			CHECK_EQUAL(Stats.NumCompressedEntries, 1u);
+			CHECK_EQUAL(Stats.UncompressedSize, 105300u);
+			CHECK_EQUAL(Stats.PackageSize, FileSize);
+			{
+				FAssetPackage AssetPackage(FilePath);
+				CHECK_EQUAL(AssetPackage.GetNumEntries(), 4u);
+				CHECK_EQUAL(AssetPackage.GetSourceKey(), std::string("sources-1"));
+
+				// Data of entries is aligned and keeps the order of adding
+				uint64 DataEnd = 0;
+				for (const auto& Source : Sources)
+				{
+					const auto Entry = AssetPackage.FindEntry(Source.first);
+					CHECK(Entry != nullptr);
+					if (Entry == nullptr)
+					{
+						continue;
+					}
+
+					CHECK_EQUAL(AssetPackage.GetEntryName(*Entry), FAssetPackage::NormalizeName(Source.first));
+					CHECK_EQUAL(Entry->Offset % AssetPackageAlignment, 0u);
+					CHECK(Entry->Offset >= DataEnd);
+					CHECK(Entry->Offset + Entry->Size <= FileSize);
+					CHECK_EQUAL(Entry->UncompressedSize, Source.second.size());
+					DataEnd = Entry->Offset + Entry->Size;
+
+					if (Entry->Compression == EAssetCompression::None)
+					{
+						CHECK_EQUAL(Entry->Size, Source.second.size());
+						CHECK(std::equal(Source.second.cbegin(), Source.second.cend(), AssetPackage.GetEntryData(*Entry)));
+					}
+					else
+					{
+						CHECK(Entry->Size < Source.second.size()*FAssetPackageWriter::MaxCompressionRatio);
+					}
+
+					CHECK(AssetPackage.ReadEntry(*Entry) == Source.second);
+				}
+
+				const auto GrassEntry = AssetPackage.FindEntry(std::wstring(L"assets\\textures\\grass.dds"));
+				CHECK(GrassEntry != nullptr && GrassEntry->Compression == EAssetCompression::LZ);
+				CHECK(AssetPackage.FindEntry("Assets/Textures/Grass") == nullptr);
+			}
+
+			// The package is replaced by the next save
+			{
+				FAssetPackageWriter AssetPackageWriter;
+				AssetPackageWriter.AddData("Assets/other.bin", CreateRandomData(10), false);
+				AssetPackageWriter.Save(FilePath, "sources-2");
+			}
+			{
+				FAssetPackage AssetPackage(FilePath);
+				CHECK_EQUAL(AssetPackage.GetNumEntries(), 1u);
+				CHECK_EQUAL(AssetPackage.GetSourceKey(), std::string("sources-2"));
+				CHECK(AssetPackage.FindEntry("Assets/empty.bin") == nullptr);
+			}
+
+			// Truncated packages aren't mapped
+			{
+				std::ofstream File(FilePath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+				FAssetPackageHeader Header;
+				Header.Magic = AssetPackageMagic;
+				Header.Version = AssetPackageVersion;
+				Header.NumEntries = 1000;
+				Header.EntriesOffset = AssetPackageAlignment;
+				File.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+			}
+			CHECK_THROWS(FAssetPackage AssetPackage(FilePath), std::invalid_argument);
+			std::remove(FilePath.c_str());
+		}
+
+		TEST(AssetPackageKeysSourceFiles)
+		{
+			const std::string FilePath = "AssetPackageKeysSourceFiles.bin";
+			std::ofstream(FilePath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc) << "texels";
+
+			// Missing files aren't keyed
+			std::vector<std::string> FoundFilesPaths;
+			const auto SourceKey = FAssetPackageWriter::GetSourceKey({ FilePath, "AssetPackageKeysSourceFiles.missing" },
+				FoundFilesPaths);
+			CHECK(FoundFilesPaths == std::vector<std::string>{ FilePath });
+			CHECK(SourceKey.size() < sizeof(FAssetPackageHeader::SourceKey));
+			CHECK_EQUAL(FAssetPackageWriter::GetSourceKey({ FilePath }, FoundFilesPaths), SourceKey);
+			CHECK(FAssetPackageWriter::GetSourceKey({}, FoundFilesPaths) != SourceKey);
+
+			// Files of another size are another source
+			std::ofstream(FilePath, std::ios_base::out | std::ios_base::binary | std::ios_base::app) << "more texels";
+			CHECK(FAssetPackageWriter::GetSourceKey({ FilePath }, FoundFilesPaths) != SourceKey);
+			std::remove(FilePath.c_str());
+		}
+
+		BENCHMARK(LoadLooseAndPackedTextures)
+		{
+			const std::string PackageFilePath = "LoadLooseAndPackedTextures.wpak";
+
+			std::vector<std::string> FilesPaths;
+			for (const auto TextureName : { "white1x1", "WoodCrate01", "WireFence", "water1", "grass", "ice", "tile" })
+			{
+				FilesPaths.push_back(GetAssetsDirectory() + "Assets\\Textures\\" + TextureName + ".dds");
+			}
+
+			std::vector<std::string> FoundFilesPaths;
+			const auto SourceKey = FAssetPackageWriter::GetSourceKey(FilesPaths, FoundFilesPaths);
+			CHECK(!FoundFilesPaths.empty());
+
+			// As AssetPacker packs them
+			FAssetPackageStats PackageStats;
+			{
+				FAssetPackageWriter AssetPackageWriter;
+				for (const auto& FilePath : FoundFilesPaths)
+				{
+					AssetPackageWriter.AddFile(FilePath, true);
+				}
+				PackageStats = AssetPackageWriter.Save(PackageFilePath, SourceKey);
+			}
+
+			BENCH_REPORT("packing", PackageStats.NumEntries << " textures (" << PackageStats.NumCompressedEntries <<
+				" compressed), " << PackageStats.UncompressedSize << " -> " << PackageStats.PackageSize << " bytes in " <<
+				PackageStats.Seconds * 1000.0 << " ms");
+
+			// The first load of the process is the cold one: files are opened and read for the first time.
+			// The package was just written, so files are in the OS cache of both loads
+			const uint32 NumPasses = 5;
+			for (uint32 iPass = 0; iPass < NumPasses; ++iPass)
+			{
+				uint64 LooseBytes = 0;
+				FBenchTimer LooseTimer;
+				for (const auto& FilePath : FoundFilesPaths)
+				{
+					std::ifstream File(FilePath, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+					std::vector<uint8> Data(static_cast<std::size_t>(File.tellg()));
+					File.seekg(0);
+					File.read(reinterpret_cast<char*>(Data.data()), Data.size());
+					LooseBytes += Data.size();
+				}
+				const auto LooseTime = LooseTimer.GetMilliseconds();
+
+				uint64 PackedBytes = sizeof(FAssetPackageHeader);
+				uint64 UncompressedBytes = 0;
+				FBenchTimer PackedTimer;
+				{
+					FAssetPackage AssetPackage(PackageFilePath);
+					PackedBytes += AssetPackage.GetNumEntries()*sizeof(FAssetPackageEntry);
+					for (const auto& FilePath : FoundFilesPaths)
+					{
+						const auto Entry = AssetPackage.FindEntry(FilePath);
+						UncompressedBytes += AssetPackage.ReadEntry(*Entry).size();
+						PackedBytes += Entry->Size;
+					}
+				}
+				const auto PackedTime = PackedTimer.GetMilliseconds();
+
+				CHECK_EQUAL(UncompressedBytes, LooseBytes);
+				if (iPass == 0 || iPass == NumPasses - 1)
+				{
+					BENCH_REPORT((iPass == 0 ? "cold load" : "warm load"), "loose " << FoundFilesPaths.size() << " files, " <<
+						LooseBytes << " bytes read in " << LooseTime << " ms; package 1 file, " << PackedBytes <<
+						" bytes read in " << PackedTime << " ms");
+				}
+			}
+
+			std::remove(PackageFilePath.c_str());
+		}
+	}
+}
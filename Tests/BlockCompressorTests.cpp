@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+#include "BlockCompressor.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/** @brief Returns values of a BC4 block as the specification interpolates them
+			  * @param Value0 (uint32)
+			  * @param Value1 (uint32)
+			  * @return (std::vector<int32>)
+			  */
+			std::vector<int32> GetBC4Values(uint32 Value0, uint32 Value1)
+			{
+				std::vector<int32> Values = { int32(Value0), int32(Value1) };
+				if (Value0 > Value1)
+				{
+					for (uint32 iValue = 1; iValue < 7; ++iValue)
+					{
+						Values.push_back(int32(((7 - iValue)*Value0 + iValue*Value1 + 3) / 7));
+					}
+				}
+				else
+				{
+					for (uint32 iValue = 1; iValue < 5; ++iValue)
+					{
+						Values.push_back(int32(((5 - iValue)*Value0 + iValue*Value1 + 2) / 5));
+					}
+					Values.push_back(0);
+					Values.push_back(255);
+				}
+				return Values;
+			}
+
+			/** @brief Creates RGBA8 texels of smooth gradients and waves with some noise, like a photo texture.
+			  * The image is the same on every run, so benchmarks are comparable
+			  * @param Width (uint32)
+			  * @param Height (uint32)
+			  * @param bOpaque Alpha is 255, otherwise it fades from the center (bool)
+			  * @return (std::vector<uint8>)
+			  */
+			std::vector<uint8> CreateSyntheticImage(uint32 Width, uint32 Height, bool bOpaque)
+			{
+				std::mt19937 Random(5);
+				std::uniform_int_distribution<int32> Noise(-6, 6);
+
+				const auto ToByte = [](float Value) { return static_cast<uint8>(std::min(std::max(Value, 0.0f), 255.0f)); };
+
+				std::vector<uint8> Texels(static_cast<size_t>(Width)*Height * 4);
+				for (uint32 Y = 0; Y < Height; ++Y)
+				{
+					for (uint32 X = 0; X < Width; ++X)
+					{
+						const auto U = static_cast<float>(X) / Width;
+						const auto V = static_cast<float>(Y) / Height;
+						const auto Wave = std::sin(40.0f*U + 10.0f*std::sin(8.0f*V));
+
+						auto Texel = Texels.data() + (static_cast<size_t>(Y)*Width + X) * 4;
+						Texel[0] = ToByte(255.0f*U + 30.0f*Wave + Noise(Random));
+						Texel[1] = ToByte(200.0f*V + 40.0f*Wave + Noise(Random));
+						Texel[2] = ToByte(128.0f + 100.0f*std::sin(6.0f*(U + V)) + Noise(Random));
+						Texel[3] = bOpaque ? 255 : ToByte(255.0f*(1.0f - std::sqrt((U - 0.5f)*(U - 0.5f) + (V - 0.5f)*(V - 0.5f))));
+					}
+				}
+
+				return Texels;
+			}
+		}
+
+		TEST(BlockCompressorEncodesValuesToNearestDecoded)
+		{
+			std::mt19937 Random(18);
+			std::uniform_int_distribution<int32> Distribution(0, 255);
+
+			uint8 Texels[16 * 4];
+			uint8 Block[16];
+			uint8 DecodedTexels[16 * 4];
+			for (auto iBlock = 0; iBlock < 1000; ++iBlock)
+			{
+				// Narrow ranges aren't multiple of 7, so evenly spaced values differ from decoded ones
+				const auto Low = Distribution(Random);
+				const auto High = std::min(Low + 1 + iBlock % 24, 255);
+				for (uint32 iTexel = 0; iTexel < 16; ++iTexel)
+				{
+					Texels[iTexel * 4 + 0] = static_cast<uint8>(Low + Distribution(Random) % (High - Low + 1));
+					Texels[iTexel * 4 + 1] = static_cast<uint8>(Distribution(Random));
+				}
+
+				FBlockCompressor::EncodeBlock(Texels, DXGI_FORMAT_BC5_UNORM, Block);
+				FBlockCompressor::DecodeBlock(Block, DXGI_FORMAT_BC5_UNORM, DecodedTexels);
+
+				for (uint32 iChannel = 0; iChannel < 2; ++iChannel)
+				{
+					const auto ChannelBlock = Block + iChannel * 8;
+					auto MinValue = 255;
+					auto MaxValue = 0;
+					for (uint32 iTexel = 0; iTexel < 16; ++iTexel)
+					{
+						MinValue = std::min<int32>(MinValue, Texels[iTexel * 4 + iChannel]);
+						MaxValue = std::max<int32>(MaxValue, Texels[iTexel * 4 + iChannel]);
+					}
+					CHECK_EQUAL(int32(ChannelBlock[0]), MaxValue);
+					CHECK_EQUAL(int32(ChannelBlock[1]), MinValue);
+
+					// Every texel has the least error its endpoints allow
+					const auto Values = GetBC4Values(ChannelBlock[0], ChannelBlock[1]);
+					for (uint32 iTexel = 0; iTexel < 16; ++iTexel)
+					{
+						const int32 Value = Texels[iTexel * 4 + iChannel];
+						auto MinError = 255;
+						for (const auto DecodedValue : Values)
+						{
+							MinError = std::min(MinError, std::abs(DecodedValue - Value));
+						}
+						CHECK_EQUAL(std::abs(int32(DecodedTexels[iTexel * 4 + iChannel]) - Value), MinError);
+					}
+				}
+			}
+		}
+
+		TEST(BlockCompressorKeepsExactAlpha)
+		{
+			// Constant alpha and alpha of the endpoints only are lossless
+			uint8 Texels[16 * 4];
+			uint8 Block[16];
+			uint8 DecodedTexels[16 * 4];
+			for (const auto Alphas : { std::vector<uint8>{ 77, 77 }, std::vector<uint8>{ 0, 255 }, std::vector<uint8>{ 13, 14 } })
+			{
+				for (uint32 iTexel = 0; iTexel < 16; ++iTexel)
+				{
+					Texels[iTexel * 4 + 0] = 128;
+					Texels[iTexel * 4 + 1] = 64;
+					Texels[iTexel * 4 + 2] = 32;
+					Texels[iTexel * 4 + 3] = Alphas[iTexel % 2];
+				}
+
+				FBlockCompressor::EncodeBlock(Texels, DXGI_FORMAT_BC3_UNORM, Block);
+				FBlockCompressor::DecodeBlock(Block, DXGI_FORMAT_BC3_UNORM, DecodedTexels);
+				for (uint32 iTexel = 0; iTexel < 16; ++iTexel)
+				{
+					CHECK_EQUAL(int32(DecodedTexels[iTexel * 4 + 3]), int32(Alphas[iTexel % 2]));
+				}
+			}
+		}
+
+		BENCHMARK(CompressSyntheticImage)
+		{
+			const uint32 Width = 1024;
+			const uint32 Height = 1024;
+			const uint32 NumPasses = 2;
+
+			// BC1 stores 1-bit alpha, so its image is opaque
+			const auto OpaqueTexels = CreateSyntheticImage(Width, Height, true);
+			const auto Texels = CreateSyntheticImage(Width, Height, false);
+
+			for (const auto Format : { DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC3_UNORM, DXGI_FORMAT_BC5_UNORM })
+			{
+				const auto& FormatTexels = Format == DXGI_FORMAT_BC1_UNORM ? OpaqueTexels : Texels;
+				std::vector<uint8> Blocks(static_cast<size_t>(FBlockCompressor::GetCompressedSize(Width, Height, Format)));
+
+				// Passes are summed, so throughput isn't the one of a cold cache only
+				FTextureCompressionStats Stats;
+				for (uint32 iPass = 0; iPass < NumPasses; ++iPass)
+				{
+					Stats += FBlockCompressor::Compress(FormatTexels.data(), Width, Height, Format, Blocks.data());
+				}
+
+				CHECK(Stats.NumPixels == static_cast<uint64>(Width)*Height*NumPasses);
+				CHECK(Stats.GetPSNR() > 30.0);
+
+				BENCH_REPORT((Format == DXGI_FORMAT_BC1_UNORM ? "BC1 1024x1024" : Format == DXGI_FORMAT_BC3_UNORM ?
+					"BC3 1024x1024" : "BC5 1024x1024"), Stats.GetMPixelsPerSecond() << " MPix/s, PSNR " <<
+					Stats.GetPSNR() << " dB, " << Stats.Seconds*1000.0 / NumPasses << " ms per image");
+			}
+		}
+	}
+}
@@ -0,0 +1,182 @@
+#include <cstring>
+#include <fstream>
+
+#include "Common/DDSLayout.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/** @brief Returns the tag which fills the subresource of a file of CreateDDSFile
+			  * @param iSlice (size_t)
+			  * @param iMip (size_t)
+			  * @return (uint8)
+			  */
+			uint8 GetSubresourceTag(size_t iSlice, size_t iMip)
+			{
+				return static_cast<uint8>(iSlice * 16 + iMip + 1);
+			}
+
+			/** @brief Creates a DDS file of a 2D texture array. Every subresource is filled with its tag,
+			  * so layouts are checked against data
+			  * @param Format (DXGI_FORMAT)
+			  * @param Width (size_t)
+			  * @param Height (size_t)
+			  * @param MipCount (size_t)
+			  * @param ArraySize (uint32)
+			  * @return (std::vector<uint8>)
+			  */
+			std::vector<uint8> CreateDDSFile(DXGI_FORMAT Format, size_t Width, size_t Height, size_t MipCount, uint32 ArraySize)
+			{
+				auto Bytes = DirectX::CreateDDSHeaders(Format, Width, Height, MipCount);
+				auto Extension = reinterpret_cast<DDS_HEADER_DXT10*>(Bytes.data() + sizeof(uint32_t) + sizeof(DDS_HEADER));
+				Extension->arraySize = ArraySize;
+
+				for (size_t iSlice = 0; iSlice < ArraySize; ++iSlice)
+				{
+					for (size_t iMip = 0; iMip < MipCount; ++iMip)
+					{
+						size_t NumBytes = 0;
+						DirectX::GetSurfaceInfo(std::max<size_t>(Width >> iMip, 1), std::max<size_t>(Height >> iMip, 1),
+							Format, &NumBytes, nullptr, nullptr);
+						Bytes.insert(Bytes.end(), NumBytes, GetSubresourceTag(iSlice, iMip));
+					}
+				}
+
+				return Bytes;
+			}
+
+			/** @brief Returns true if every byte of the subresource is the tag
+			  * @param Bytes (const std::vector<uint8> &)
+			  * @param Subresource (const DirectX::DDS_SUBRESOURCE_LAYOUT &)
+			  * @param Tag (uint8)
+			  * @return (bool)
+			  */
+			bool IsSubresourceFilled(const std::vector<uint8>& Bytes, const DirectX::DDS_SUBRESOURCE_LAYOUT& Subresource, uint8 Tag)
+			{
+				return Subresource.offset + Subresource.slicePitch <= Bytes.size() &&
+					std::all_of(Bytes.begin() + Subresource.offset, Bytes.begin() + Subresource.offset + Subresource.slicePitch,
+						[Tag](uint8 Byte) { return Byte == Tag; });
+			}
+		}
+
+		TEST(DDSLayoutOfTextureArray)
+		{
+			const auto Bytes = CreateDDSFile(DXGI_FORMAT_BC1_UNORM, 256, 128, 9, 3);
+
+			DirectX::DDS_TEXTURE_LAYOUT Layout;
+			CHECK(SUCCEEDED(DirectX::GetDDSTextureLayout(Bytes.data(), Bytes.size(), 0, Layout)));
+
+			CHECK(Layout.resDim == DirectX::DDS_DIMENSION_TEXTURE2D);
+			CHECK(Layout.format == DXGI_FORMAT_BC1_UNORM);
+			CHECK_EQUAL(Layout.width, 256u);
+			CHECK_EQUAL(Layout.height, 128u);
+			CHECK_EQUAL(Layout.mipCount, 9u);
+			CHECK_EQUAL(Layout.skipMip, 0u);
+			CHECK_EQUAL(Layout.arraySize, 3u);
+			CHECK_EQUAL(Layout.subresources.size(), 27u);
+
+			// Subresources are mip-major inside of every slice and follow each other tightly
+			auto Offset = sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10);
+			for (size_t iSlice = 0; iSlice < 3; ++iSlice)
+			{
+				for (size_t iMip = 0; iMip < 9; ++iMip)
+				{
+					const auto& Subresource = Layout.subresources[iSlice * 9 + iMip];
+
+					// 8 bytes per block of 4x4 texels, mips smaller than a block take a whole block
+					const auto NumBlocksWide = std::max<size_t>(((256 >> iMip) + 3) / 4, 1);
+					const auto NumBlocksHigh = std::max<size_t>(((128 >> iMip) + 3) / 4, 1);
+					CHECK_EQUAL(Subresource.offset, Offset);
+					CHECK_EQUAL(Subresource.rowPitch, NumBlocksWide * 8);
+					CHECK_EQUAL(Subresource.slicePitch, NumBlocksWide * NumBlocksHigh * 8);
+					CHECK(IsSubresourceFilled(Bytes, Subresource, GetSubresourceTag(iSlice, iMip)));
+
+					Offset += Subresource.slicePitch;
+				}
+			}
+			CHECK_EQUAL(Offset, Bytes.size());
+
+			// Pitches of uncompressed formats are of texels
+			const auto RGBABytes = CreateDDSFile(DXGI_FORMAT_R8G8B8A8_UNORM, 5, 3, 1, 1);
+			CHECK(SUCCEEDED(DirectX::GetDDSTextureLayout(RGBABytes.data(), RGBABytes.size(), 0, Layout)));
+			CHECK_EQUAL(Layout.subresources[0].rowPitch, 20u);
+			CHECK_EQUAL(Layout.subresources[0].slicePitch, 60u);
+		}
+
+		TEST(DDSLayoutSkipsMipsLargerThanMaxSize)
+		{
+			const auto Bytes = CreateDDSFile(DXGI_FORMAT_BC3_UNORM, 256, 128, 9, 2);
+
+			// 256x128 and 128x64 are skipped in every slice
+			DirectX::DDS_TEXTURE_LAYOUT Layout;
+			CHECK(SUCCEEDED(DirectX::GetDDSTextureLayout(Bytes.data(), Bytes.size(), 64, Layout)));
+
+			CHECK_EQUAL(Layout.skipMip, 2u);
+			CHECK_EQUAL(Layout.mipCount, 7u);
+			CHECK_EQUAL(Layout.width, 64u);
+			CHECK_EQUAL(Layout.height, 32u);
+			CHECK_EQUAL(Layout.subresources.size(), 14u);
+
+			for (size_t iSlice = 0; iSlice < 2; ++iSlice)
+			{
+				for (size_t iMip = 0; iMip < Layout.mipCount; ++iMip)
+				{
+					CHECK(IsSubresourceFilled(Bytes, Layout.subresources[iSlice * Layout.mipCount + iMip],
+						GetSubresourceTag(iSlice, iMip + Layout.skipMip)));
+				}
+			}
+
+			// The least detailed mip is kept even if it's larger
+			CHECK(SUCCEEDED(DirectX::GetDDSTextureLayout(Bytes.data(), Bytes.size(), 1, Layout)));
+			CHECK_EQUAL(Layout.mipCount, 1u);
+			CHECK_EQUAL(Layout.width, 1u);
+		}
+
+		TEST(DDSLayoutRejectsInvalidFiles)
+		{
+			const auto Bytes = CreateDDSFile(DXGI_FORMAT_BC1_UNORM, 64, 64, 7, 2);
+			DirectX::DDS_TEXTURE_LAYOUT Layout;
+
+			CHECK(FAILED(DirectX::GetDDSTextureLayout(nullptr, Bytes.size(), 0, Layout)));
+			CHECK(FAILED(DirectX::GetDDSTextureLayout(Bytes.data(), 64, 0, Layout)));
+
+			// The last subresource doesn't fit
+			CHECK(FAILED(DirectX::GetDDSTextureLayout(Bytes.data(), Bytes.size() - 1, 0, Layout)));
+
+			auto WrongMagicBytes = Bytes;
+			WrongMagicBytes[0] = 'X';
+			CHECK(FAILED(DirectX::GetDDSTextureLayout(WrongMagicBytes.data(), WrongMagicBytes.size(), 0, Layout)));
+
+			auto EmptyArrayBytes = Bytes;
+			reinterpret_cast<DDS_HEADER_DXT10*>(EmptyArrayBytes.data() + sizeof(uint32_t) + sizeof(DDS_HEADER))->arraySize = 0;
+			CHECK(FAILED(DirectX::GetDDSTextureLayout(EmptyArrayBytes.data(), EmptyArrayBytes.size(), 0, Layout)));
+
+			// Sizes of huge mips overflow without the check
+			auto HugeBytes = Bytes;
+			reinterpret_cast<DDS_HEADER*>(HugeBytes.data() + sizeof(uint32_t))->width = 16384;
+			reinterpret_cast<DDS_HEADER*>(HugeBytes.data() + sizeof(uint32_t))->height = 16384;
+			CHECK(FAILED(DirectX::GetDDSTextureLayout(HugeBytes.data(), HugeBytes.size(), 0, Layout)));
+		}
+
+		TEST(DDSLayoutOfAssetTextures)
+		{
+			for (const auto TextureName : { "grass", "water1", "WireFence", "WoodCrate01", "ice", "tile", "white1x1" })
+			{
+				const auto FilePath = GetAssetsDirectory() + "Assets\\Textures\\" + TextureName + ".dds";
+				std::ifstream File(FilePath, std::ios_base::in | std::ios_base::binary);
+				const std::vector<uint8> Bytes((std::istreambuf_iterator<char>(File)), std::istreambuf_iterator<char>());
+
+				DirectX::DDS_TEXTURE_LAYOUT Layout;
+				CHECK(SUCCEEDED(DirectX::GetDDSTextureLayout(Bytes.data(), Bytes.size(), 0, Layout)));
+				CHECK_EQUAL(Layout.subresources.size(), Layout.mipCount * Layout.arraySize);
+
+				const auto& LastSubresource = Layout.subresources.back();
+				CHECK(LastSubresource.offset + LastSubresource.slicePitch * Layout.depth <= Bytes.size());
+			}
+		}
+	}
+}
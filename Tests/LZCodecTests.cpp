@@ -0,0 +1,186 @@
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "LZCodec.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			// Bytes after decompressed data, which must stay untouched
+			constexpr uint8 CanaryValue = 0xCD;
+			constexpr std::size_t NumCanaryBytes = 64;
+
+			/** @brief Decompresses the data into a buffer followed by canary bytes
+			  * @param Compressed (const std::vector<uint8> &)
+			  * @param DstSize (uint64)
+			  * @param Decompressed Decompressed data and canary bytes (std::vector<uint8> &)
+			  * @return False if decompression threw invalid_argument (bool)
+			  */
+			bool TryDecompress(const std::vector<uint8>& Compressed, uint64 DstSize, std::vector<uint8>& Decompressed)
+			{
+				Decompressed.assign(static_cast<std::size_t>(DstSize) + NumCanaryBytes, CanaryValue);
+				try
+				{
+					FLZCodec::Decompress(Compressed.data(), Compressed.size(), Decompressed.data(), DstSize);
+					return true;
+				}
+				catch (const std::invalid_argument&)
+				{
+					return false;
+				}
+			}
+
+			/** @brief Returns true if canary bytes after DstSize bytes are untouched
+			  * @param Decompressed (const std::vector<uint8> &)
+			  * @param DstSize (uint64)
+			  * @return (bool)
+			  */
+			bool AreCanariesKept(const std::vector<uint8>& Decompressed, uint64 DstSize)
+			{
+				return std::all_of(Decompressed.cbegin() + static_cast<std::ptrdiff_t>(DstSize), Decompressed.cend(),
+					[](uint8 Byte) { return Byte == CanaryValue; });
+			}
+
+			/** @brief Returns text-like data of words repeated in random order
+			  * @param Size (std::size_t)
+			  * @return (std::vector<uint8>)
+			  */
+			std::vector<uint8> CreateTextData(std::size_t Size)
+			{
+				const char* Words[] = { "vertex ", "index ", "texture ", "mesh ", "material ", "normal\n", "0.125 ", "-3.5 " };
+
+				std::mt19937 Random(11);
+				std::uniform_int_distribution<std::size_t> Distribution(0, 7);
+
+				std::vector<uint8> Data;
+				while (Data.size() < Size)
+				{
+					const auto Word = Words[Distribution(Random)];
+					Data.insert(Data.end(), Word, Word + std::strlen(Word));
+				}
+				Data.resize(Size);
+
+				return Data;
+			}
+
+			/** @brief Returns random bytes, which can't be compressed
+			  * @param Size (std::size_t)
+			  * @return (std::vector<uint8>)
+			  */
+			std::vector<uint8> CreateRandomData(std::size_t Size)
+			{
+				std::mt19937 Random(23);
+				std::uniform_int_distribution<uint32> Distribution(0, 255);
+
+				std::vector<uint8> Data(Size);
+				for (auto& Byte : Data)
+				{
+					Byte = static_cast<uint8>(Distribution(Random));
+				}
+
+				return Data;
+			}
+		}
+
+		TEST(LZCodecRoundTripsData)
+		{
+			// Long runs have matches which overlap themselves and lengths of many bytes
+			std::vector<uint8> Runs(300000, 7);
+			std::fill(Runs.begin() + 1000, Runs.begin() + 1300, 9);
+
+			// Repeats further than 64KB back aren't matches
+			auto FarRepeats = CreateRandomData(100000);
+			FarRepeats.insert(FarRepeats.end(), FarRepeats.cbegin(), FarRepeats.cend());
+
+			const std::vector<std::vector<uint8>> Inputs = {
+				{}, { 42 }, CreateTextData(11), CreateTextData(13), CreateTextData(100000),
+				CreateRandomData(17), CreateRandomData(100000), Runs, FarRepeats };
+
+			std::vector<uint8> Decompressed;
+			for (const auto& Input : Inputs)
+			{
+				const auto Compressed = FLZCodec::Compress(Input.data(), Input.size());
+				CHECK(Compressed.size() <= FLZCodec::GetMaxCompressedSize(Input.size()));
+				CHECK(TryDecompress(Compressed, Input.size(), Decompressed));
+				CHECK(std::equal(Input.cbegin(), Input.cend(), Decompressed.cbegin()));
+				CHECK(AreCanariesKept(Decompressed, Input.size()));
+			}
+
+			CHECK(FLZCodec::Compress(Inputs[4].data(), Inputs[4].size()).size() < Inputs[4].size() / 2);
+			CHECK(FLZCodec::Compress(Runs.data(), Runs.size()).size() < Runs.size() / 100);
+			CHECK(FLZCodec::Compress(FarRepeats.data(), FarRepeats.size()).size() >= FarRepeats.size());
+		}
+
+		TEST(LZCodecRejectsBlocksOutOfBounds)
+		{
+			std::vector<uint8> Decompressed;
+
+			// A literal followed by a match of 4 bytes which repeats it
+			const std::vector<uint8> Block = { 0x10, 'a', 0x01, 0x00 };
+			CHECK(TryDecompress(Block, 5, Decompressed));
+			CHECK(std::string(Decompressed.cbegin(), Decompressed.cbegin() + 5) == "aaaaa");
+
+			// Decompressed size must be exact
+			CHECK(!TryDecompress(Block, 4, Decompressed));
+			CHECK(AreCanariesKept(Decompressed, 4));
+			CHECK(!TryDecompress(Block, 6, Decompressed));
+
+			// Matches before the start of data or of a zero offset
+			CHECK(!TryDecompress({ 0x10, 'a', 0x02, 0x00 }, 5, Decompressed));
+			CHECK(!TryDecompress({ 0x10, 'a', 0x00, 0x00 }, 5, Decompressed));
+
+			// Literals and matches longer than the data, and lengths cut by the end of the block
+			CHECK(!TryDecompress({ 0xF0, 0xFF, 0xFF, 0x10, 'a' }, 5, Decompressed));
+			CHECK(!TryDecompress({ 0x1F, 'a', 0x01, 0x00, 0xFF, 0x00 }, 5, Decompressed));
+			CHECK(AreCanariesKept(Decompressed, 5));
+			CHECK(!TryDecompress({ 0xF0, 0xFF }, 5, Decompressed));
+			CHECK(!TryDecompress({ 0x1F, 'a', 0x01, 0x00, 0xFF }, 300, Decompressed));
+			CHECK(!TryDecompress({ 0x10, 'a', 0x01 }, 5, Decompressed));
+			CHECK(!TryDecompress({}, 5, Decompressed));
+		}
+
+		TEST(LZCodecRejectsTruncatedAndCorruptedBlocks)
+		{
+			const auto Input = CreateTextData(4000);
+			const auto Compressed = FLZCodec::Compress(Input.data(), Input.size());
+			std::vector<uint8> Decompressed;
+
+			// Every truncation misses some of the data
+			auto bTruncationsRejected = true;
+			for (std::size_t Size = 0; Size < Compressed.size(); ++Size)
+			{
+				const std::vector<uint8> Truncated(Compressed.cbegin(), Compressed.cbegin() + Size);
+				bTruncationsRejected = bTruncationsRejected && !TryDecompress(Truncated, Input.size(), Decompressed) &&
+					AreCanariesKept(Decompressed, Input.size());
+			}
+			CHECK(bTruncationsRejected);
+
+			// Corrupted bytes may decode to other data, but never write out of bounds
+			std::mt19937 Random(31);
+			std::uniform_int_distribution<std::size_t> PosDistribution(0, Compressed.size() - 1);
+			std::uniform_int_distribution<uint32> ByteDistribution(0, 255);
+
+			auto bCanariesKept = true;
+			uint32 NumRejected = 0;
+			for (uint32 iCorruption = 0; iCorruption < 2000; ++iCorruption)
+			{
+				auto Corrupted = Compressed;
+				for (uint32 iByte = 0; iByte < 1 + iCorruption % 4; ++iByte)
+				{
+					Corrupted[PosDistribution(Random)] = static_cast<uint8>(ByteDistribution(Random));
+				}
+
+				NumRejected += TryDecompress(Corrupted, Input.size(), Decompressed) ? 0 : 1;
+				bCanariesKept = bCanariesKept && AreCanariesKept(Decompressed, Input.size());
+			}
+			CHECK(bCanariesKept);
+			CHECK(NumRejected > 0);
+		}
+	}
+}
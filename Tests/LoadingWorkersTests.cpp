@@ -0,0 +1,322 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "LoadingWorkers.h"
+#include "MeshBaker.h"
+#include "Common/DDSLayout.h"
+#include "Common/MappedFile.h"
+#include "MeshTestUtils.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			// CPU part of a startup load, as FGameResource's workers produce it
+			struct FLoadedAsset
+			{
+				// Mapped file, or bytes read to the heap if the file isn't mapped
+				std::unique_ptr<DX::FMappedFile> TextureFile;
+				std::vector<uint8> TextureBytes;
+				DirectX::DDS_TEXTURE_LAYOUT TextureLayout;
+
+				std::unique_ptr<FBakedMesh> BakedMesh;
+			};
+
+			using FAssetLoad = std::function<std::unique_ptr<FLoadedAsset>()>;
+
+			/*!
+			 * \class FStubUploadDevice
+			 *
+			 * \brief Stands for the device at the upload step: subresources and buffers are copied
+			 * to its staging memory on the owner's thread, as FlushUploads records copies
+			 */
+			class FStubUploadDevice
+			{
+			public:
+				void Upload(const FLoadedAsset& LoadedAsset)
+				{
+					if (LoadedAsset.BakedMesh != nullptr)
+					{
+						Copy(LoadedAsset.BakedMesh->VerticesData.data(), LoadedAsset.BakedMesh->VerticesData.size());
+						Copy(LoadedAsset.BakedMesh->IndicesData.data(), LoadedAsset.BakedMesh->IndicesData.size());
+						return;
+					}
+
+					const auto TextureData = LoadedAsset.TextureFile != nullptr ?
+						LoadedAsset.TextureFile->GetData() : LoadedAsset.TextureBytes.data();
+					for (const auto& Subresource : LoadedAsset.TextureLayout.subresources)
+					{
+						Copy(TextureData + Subresource.offset, Subresource.slicePitch);
+					}
+				}
+
+				uint64 GetUploadedSize() const noexcept
+				{
+					return UploadedSize;
+				}
+
+			private:
+				void Copy(const uint8* Data, std::size_t Size)
+				{
+					StagingMemory.resize(std::max(StagingMemory.size(), Size));
+					std::memcpy(StagingMemory.data(), Data, Size);
+					UploadedSize += Size;
+				}
+
+				std::vector<uint8> StagingMemory;
+
+				uint64 UploadedSize = 0;
+			};
+
+			/** @brief Returns loads of the startup's textures and meshes: files are mapped and laid out,
+			  * meshes are parsed and baked
+			  * @return (std::vector<WoodenEngine::Tests::FAssetLoad>)
+			  */
+			std::vector<FAssetLoad> GetStartupLoads()
+			{
+				std::vector<FAssetLoad> Loads;
+				for (const auto TextureName : { "grass", "water1", "WireFence", "WoodCrate01", "ice", "tile", "white1x1" })
+				{
+					const auto FilePath = GetAssetsDirectory() + "Assets\\Textures\\" + TextureName + ".dds";
+					Loads.push_back([FilePath]()
+					{
+						auto LoadedAsset = std::make_unique<FLoadedAsset>();
+						LoadedAsset->TextureFile = std::make_unique<DX::FMappedFile>(FilePath);
+						DirectX::GetDDSTextureLayout(LoadedAsset->TextureFile->GetData(),
+							static_cast<size_t>(LoadedAsset->TextureFile->GetSize()), 0, LoadedAsset->TextureLayout);
+						return LoadedAsset;
+					});
+				}
+
+				Loads.push_back([]()
+				{
+					std::vector<std::unique_ptr<FMeshRawData>> SubmeshesData;
+					SubmeshesData.push_back(LoadSkullMesh());
+
+					FMeshBaker MeshBaker;
+					auto LoadedAsset = std::make_unique<FLoadedAsset>();
+					LoadedAsset->BakedMesh = MeshBaker.Bake(std::move(SubmeshesData), "skull");
+					return LoadedAsset;
+				});
+
+				// Stand for the dino and terrain tiles
+				for (auto iMesh = 0; iMesh < 3; ++iMesh)
+				{
+					Loads.push_back([iMesh]()
+					{
+						FMeshGenerator MeshGenerator;
+						std::vector<std::unique_ptr<FMeshRawData>> SubmeshesData;
+						SubmeshesData.push_back(MeshGenerator.CreateLandscapeGrid(100.0f, 100.0f, 201, 201 + iMesh));
+
+						FMeshBaker MeshBaker;
+						auto LoadedAsset = std::make_unique<FLoadedAsset>();
+						LoadedAsset->BakedMesh = MeshBaker.Bake(std::move(SubmeshesData), "landscape");
+						return LoadedAsset;
+					});
+				}
+
+				return Loads;
+			}
+
+			/** @brief Writes a DDS file of an RGBA 2D texture array with full mips chains, like treeArray2.dds
+			  * @param FilePath (const std::string &)
+			  * @param Size Width and height (uint32)
+			  * @param ArraySize (uint32)
+			  * @return (void)
+			  */
+			void WriteTextureArrayFile(const std::string& FilePath, uint32 Size, uint32 ArraySize)
+			{
+				size_t MipCount = 1;
+				while ((Size >> MipCount) > 0)
+				{
+					++MipCount;
+				}
+
+				auto Headers = DirectX::CreateDDSHeaders(DXGI_FORMAT_R8G8B8A8_UNORM, Size, Size, MipCount);
+				reinterpret_cast<DDS_HEADER_DXT10*>(Headers.data() + sizeof(uint32_t) + sizeof(DDS_HEADER))->arraySize = ArraySize;
+
+				std::ofstream File(FilePath, std::ios::binary | std::ios::trunc);
+				File.write(reinterpret_cast<const char*>(Headers.data()), Headers.size());
+
+				std::vector<char> Texels;
+				for (uint32 iSlice = 0; iSlice < ArraySize; ++iSlice)
+				{
+					for (size_t iMip = 0; iMip < MipCount; ++iMip)
+					{
+						const auto MipSize = std::max<size_t>(Size >> iMip, 1);
+						Texels.assign(MipSize*MipSize * 4, static_cast<char>(iSlice * 16 + iMip));
+						File.write(Texels.data(), Texels.size());
+					}
+				}
+			}
+		}
+
+		TEST(LoadingWorkersLimitRunningLoads)
+		{
+			FLoadingWorkers LoadingWorkers;
+			LoadingWorkers.SetNumWorkers(2);
+
+			std::atomic<int> NumRunning(0);
+			std::atomic<int> MaxNumRunning(0);
+			std::atomic<int> NumFinished(0);
+			for (auto iLoad = 0; iLoad < 16; ++iLoad)
+			{
+				LoadingWorkers.Enqueue([&]()
+				{
+					const auto Running = ++NumRunning;
+					auto MaxRunning = MaxNumRunning.load();
+					while (Running > MaxRunning && !MaxNumRunning.compare_exchange_weak(MaxRunning, Running))
+					{
+					}
+
+					std::this_thread::sleep_for(std::chrono::milliseconds(2));
+					--NumRunning;
+					++NumFinished;
+				});
+			}
+
+			LoadingWorkers.Wait();
+
+			CHECK_EQUAL(NumFinished.load(), 16);
+			CHECK(MaxNumRunning.load() <= 2);
+			CHECK_THROWS(LoadingWorkers.SetNumWorkers(0), std::invalid_argument);
+		}
+
+		BENCHMARK(StartupLoadsWithWorkers)
+		{
+			const auto Loads = GetStartupLoads();
+
+			// As the startup did: every load is done and uploaded on the owner's thread in turn
+			FStubUploadDevice SequentialDevice;
+			FBenchTimer SequentialTimer;
+			for (const auto& Load : Loads)
+			{
+				SequentialDevice.Upload(*Load());
+			}
+			const auto SequentialTime = SequentialTimer.GetMilliseconds();
+
+			BENCH_REPORT("sequential", Loads.size() << " loads, " << SequentialDevice.GetUploadedSize() / 1024 <<
+				" KB uploaded in " << SequentialTime << " ms");
+
+			for (auto NumWorkers : { 1u, 2u, 4u, 8u })
+			{
+				std::mutex LoadedAssetsMutex;
+				std::vector<std::unique_ptr<FLoadedAsset>> LoadedAssets;
+
+				FStubUploadDevice Device;
+				FBenchTimer Timer;
+				{
+					FLoadingWorkers LoadingWorkers;
+					LoadingWorkers.SetNumWorkers(NumWorkers);
+					for (const auto& Load : Loads)
+					{
+						LoadingWorkers.Enqueue([&LoadedAssetsMutex, &LoadedAssets, Load]()
+						{
+							auto LoadedAsset = Load();
+							std::lock_guard<std::mutex> Lock(LoadedAssetsMutex);
+							LoadedAssets.push_back(std::move(LoadedAsset));
+						});
+					}
+
+					// Finished loads are uploaded at the single upload point of every frame
+					for (std::size_t NumUploaded = 0; NumUploaded < Loads.size(); )
+					{
+						std::vector<std::unique_ptr<FLoadedAsset>> FinishedAssets;
+						{
+							std::lock_guard<std::mutex> Lock(LoadedAssetsMutex);
+							FinishedAssets.swap(LoadedAssets);
+						}
+
+						for (const auto& LoadedAsset : FinishedAssets)
+						{
+							Device.Upload(*LoadedAsset);
+						}
+
+						NumUploaded += FinishedAssets.size();
+						std::this_thread::yield();
+					}
+				}
+				const auto Time = Timer.GetMilliseconds();
+
+				CHECK_EQUAL(Device.GetUploadedSize(), SequentialDevice.GetUploadedSize());
+
+				BENCH_REPORT(NumWorkers << " workers", Time << " ms, " << SequentialTime / Time << "x of sequential");
+			}
+		}
+
+		BENCHMARK(TextureArrayLoadMappedAndRead)
+		{
+			// treeArray2.dds of the game if it's in the assets, otherwise an array of the same kind
+			auto FilePath = GetAssetsDirectory() + "Assets\\Textures\\treeArray2.dds";
+			const auto bSynthetic = !std::ifstream(FilePath).is_open();
+			if (bSynthetic)
+			{
+				FilePath = "TextureArrayLoadMappedAndRead.dds";
+				WriteTextureArrayFile(FilePath, 1024, 16);
+			}
+
+			const auto FileSizeMB = 
+				static_cast<double>(std::ifstream(FilePath, std::ios::binary | std::ios::ate).tellg()) / (1024.0 * 1024.0);
+			BENCH_REPORT((bSynthetic ? "synthetic array" : "treeArray2.dds"), FileSizeMB << " MB");
+
+			// Mapped load runs first, so the read load's copy doesn't raise its peak
+			for (const auto bMapped : { true, false })
+			{
+				const auto MemoryBefore = GetProcessMemory();
+
+				std::unique_ptr<FLoadedAsset> LoadedAsset;
+				FStubUploadDevice Device;
+				FBenchTimer Timer;
+				{
+					FLoadingWorkers LoadingWorkers;
+					LoadingWorkers.Enqueue([&LoadedAsset, &FilePath, bMapped]()
+					{
+						LoadedAsset = std::make_unique<FLoadedAsset>();
+						if (bMapped)
+						{
+							LoadedAsset->TextureFile = std::make_unique<DX::FMappedFile>(FilePath);
+						}
+						else
+						{
+							// As LoadTextureDataFromFile did: the whole file is read to the heap
+							std::ifstream File(FilePath, std::ios::binary | std::ios::ate);
+							LoadedAsset->TextureBytes.resize(static_cast<std::size_t>(File.tellg()));
+							File.seekg(0);
+							File.read(reinterpret_cast<char*>(LoadedAsset->TextureBytes.data()), LoadedAsset->TextureBytes.size());
+						}
+
+						const auto TextureData = bMapped ? LoadedAsset->TextureFile->GetData() : LoadedAsset->TextureBytes.data();
+						const auto TextureSize = bMapped ? LoadedAsset->TextureFile->GetSize() : LoadedAsset->TextureBytes.size();
+						DirectX::GetDDSTextureLayout(TextureData, static_cast<size_t>(TextureSize), 0, LoadedAsset->TextureLayout);
+					});
+					LoadingWorkers.Wait();
+				}
+
+				Device.Upload(*LoadedAsset);
+				const auto Time = Timer.GetMilliseconds();
+
+				// Loaded data is still referenced, so the current working set is the load's peak
+				const auto MemoryAfter = GetProcessMemory();
+				CHECK(Device.GetUploadedSize() > 0);
+
+				BENCH_REPORT((bMapped ? "mapped" : "read"), Time << " ms, " << FileSizeMB * 1000.0 / Time << " MB/s, +" <<
+					(double(MemoryAfter.WorkingSetBytes) - double(MemoryBefore.WorkingSetBytes)) / (1024.0 * 1024.0) << 
+					" MB working set, +" <<
+					(double(MemoryAfter.PrivateBytes) - double(MemoryBefore.PrivateBytes)) / (1024.0 * 1024.0) << 
+					" MB private, " << MemoryAfter.PeakWorkingSetBytes / (1024 * 1024) << " MB peak RSS");
+			}
+
+			if (bSynthetic)
+			{
+				std::remove(FilePath.c_str());
+			}
+		}
+	}
+}
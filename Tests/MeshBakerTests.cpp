@@ -0,0 +1,175 @@
+#include <cstdio>
+#include <fstream>
+
+#include "MeshBaker.h"
+#include "VertexPacker.h"
+#include "MeshTestUtils.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/** @brief Decodes the baked submesh back to raw mesh data, so it's compared with its source
+			  * @param BakedMesh (const FBakedMesh &)
+			  * @param iSubmesh (std::size_t)
+			  * @return (std::unique_ptr<WoodenEngine::FMeshRawData>)
+			  */
+			std::unique_ptr<FMeshRawData> UnbakeSubmesh(const FBakedMesh& BakedMesh, std::size_t iSubmesh)
+			{
+				const auto& SubmeshData = *BakedMesh.SubmeshesData[iSubmesh];
+
+				auto MeshData = std::make_unique<FMeshRawData>(SubmeshData.Name);
+				for (uint32 iVertex = 0; iVertex < SubmeshData.NumVertices; ++iVertex)
+				{
+					const auto SrcVertex = BakedMesh.VerticesData.data() +
+						(SubmeshData.VertexBegin + iVertex)*BakedMesh.VertexStride;
+					MeshData->Vertices.push_back(
+						FVertexPacker::Unpack(SrcVertex, BakedMesh.VertexFormat, SubmeshData.VertexQuantization));
+				}
+
+				for (uint64 iIndex = SubmeshData.IndexBegin; iIndex < SubmeshData.IndexBegin + SubmeshData.NumIndices; ++iIndex)
+				{
+					MeshData->Indices.push_back(BakedMesh.IndexFormat == DXGI_FORMAT_R16_UINT ?
+						reinterpret_cast<const uint16*>(BakedMesh.IndicesData.data())[iIndex] :
+						reinterpret_cast<const uint32*>(BakedMesh.IndicesData.data())[iIndex]);
+				}
+
+				return MeshData;
+			}
+
+			/** @brief Writes the mesh in format of skull.txt
+			  * @param MeshData (const FMeshRawData &)
+			  * @param FilePath (const std::string &)
+			  * @return (void)
+			  */
+			void WriteTxtFile(const FMeshRawData& MeshData, const std::string& FilePath)
+			{
+				std::ofstream File(FilePath, std::ios::binary);
+				File << MeshData.Vertices.size() << "\n" << MeshData.Indices.size() / 3 << "\n";
+				for (const auto& Vertex : MeshData.Vertices)
+				{
+					File << Vertex.Position.x << " " << Vertex.Position.y << " " << Vertex.Position.z << " " <<
+						Vertex.Normal.x << " " << Vertex.Normal.y << " " << Vertex.Normal.z << "\n";
+				}
+
+				for (std::size_t iIndex = 0; iIndex < MeshData.Indices.size(); iIndex += 3)
+				{
+					File << MeshData.Indices[iIndex] << " " << MeshData.Indices[iIndex + 1] << " " <<
+						MeshData.Indices[iIndex + 2] << "\n";
+				}
+			}
+		}
+
+		TEST(PackIndicesPicksIndexFormat)
+		{
+			std::vector<uint8> IndicesData;
+
+			CHECK_EQUAL(FMeshBaker::PackIndices({ 0, 1, UINT16_MAX }, &IndicesData), DXGI_FORMAT_R16_UINT);
+			CHECK_EQUAL(IndicesData.size(), 3 * sizeof(uint16));
+			CHECK_EQUAL(reinterpret_cast<const uint16*>(IndicesData.data())[2], UINT16_MAX);
+
+			CHECK_EQUAL(FMeshBaker::PackIndices({ 0, 1, UINT16_MAX + 1 }, &IndicesData), DXGI_FORMAT_R32_UINT);
+			CHECK_EQUAL(IndicesData.size(), 3 * sizeof(uint32));
+			CHECK_EQUAL(reinterpret_cast<const uint32*>(IndicesData.data())[2], UINT16_MAX + 1u);
+		}
+
+		TEST(BakeKeepsHalfIndicesOfMergedSubmeshes)
+		{
+			// Two submeshes of 40401 vertices. Together they don't fit in 16 bits, but every one does
+			FMeshGenerator MeshGenerator;
+			std::vector<std::unique_ptr<FMeshRawData>> SubmeshesData;
+			SubmeshesData.push_back(MeshGenerator.CreateGrid(10.0f, 10.0f, 201, 201));
+			SubmeshesData.back()->Name = "first";
+			SubmeshesData.push_back(MeshGenerator.CreateGrid(20.0f, 20.0f, 201, 201));
+			SubmeshesData.back()->Name = "second";
+
+			const auto SourceTriangles = GetSortedTriangles(*SubmeshesData.back());
+
+			FMeshBaker MeshBaker;
+			const auto BakedMesh = MeshBaker.Bake(std::move(SubmeshesData), "merged");
+
+			CHECK_EQUAL(BakedMesh->IndexFormat, DXGI_FORMAT_R16_UINT);
+			CHECK_EQUAL(BakedMesh->SubmeshesData[1]->VertexBegin, BakedMesh->SubmeshesData[0]->NumVertices);
+			CHECK(BakedMesh->SubmeshesData[0]->NumVertices + BakedMesh->SubmeshesData[1]->NumVertices > UINT16_MAX);
+			CHECK(GetSortedTriangles(*UnbakeSubmesh(*BakedMesh, 1)) == SourceTriangles);
+		}
+
+		TEST(BakeLargeSubmeshWithFullIndices)
+		{
+			FMeshGenerator MeshGenerator;
+			std::vector<std::unique_ptr<FMeshRawData>> SubmeshesData;
+			SubmeshesData.push_back(MeshGenerator.CreateGrid(30.0f, 30.0f, 301, 301));
+
+			const auto SourceTriangles = GetSortedTriangles(*SubmeshesData.back());
+
+			FMeshBaker MeshBaker;
+			const auto BakedMesh = MeshBaker.Bake(std::move(SubmeshesData), "large");
+
+			CHECK_EQUAL(BakedMesh->IndexFormat, DXGI_FORMAT_R32_UINT);
+			CHECK_EQUAL(BakedMesh->SubmeshesData[0]->NumVertices, 301u * 301u);
+			CHECK(GetSortedTriangles(*UnbakeSubmesh(*BakedMesh, 0)) == SourceTriangles);
+		}
+
+		TEST(ParseTxtDataWithFullIndices)
+		{
+			FMeshGenerator MeshGenerator;
+			const auto SourceMesh = MeshGenerator.CreateGrid(30.0f, 30.0f, 301, 301);
+
+			const std::string FilePath = "ParseTxtDataWithFullIndices.txt";
+			WriteTxtFile(*SourceMesh, FilePath);
+
+			FMeshParser MeshParser;
+			const auto MeshData = MeshParser.ParseTxtData(FilePath);
+			std::remove(FilePath.c_str());
+
+			CHECK_EQUAL(MeshData->Vertices.size(), SourceMesh->Vertices.size());
+			CHECK(MeshData->Indices == SourceMesh->Indices);
+			CHECK(*std::max_element(MeshData->Indices.begin(), MeshData->Indices.end()) > UINT16_MAX);
+		}
+
+		BENCHMARK(BakeMultiMillionTriangleMeshes)
+		{
+			FMeshGenerator MeshGenerator;
+			FMeshBaker MeshBaker;
+
+			// 2 and 8 million triangles
+			for (auto NumSideVertices : { 1001u, 2001u })
+			{
+				std::vector<std::unique_ptr<FMeshRawData>> SubmeshesData;
+				SubmeshesData.push_back(MeshGenerator.CreateLandscapeGrid(100.0f, 100.0f, NumSideVertices, NumSideVertices));
+
+				const auto NumSourceTriangles = SubmeshesData.back()->Indices.size() / 3;
+				const auto SourceTriangles = GetSortedTriangles(*SubmeshesData.back());
+
+				FBenchTimer Timer;
+				const auto BakedMesh = MeshBaker.Bake(std::move(SubmeshesData), "landscape");
+				const auto Time = Timer.GetMilliseconds();
+
+				CHECK_EQUAL(BakedMesh->IndexFormat, DXGI_FORMAT_R32_UINT);
+				CHECK(GetSortedTriangles(*UnbakeSubmesh(*BakedMesh, 0)) == SourceTriangles);
+
+				BENCH_REPORT("landscape " << NumSideVertices << "x" << NumSideVertices,
+					NumSourceTriangles << " triangles, " << BakedMesh->VerticesData.size() / 1024 << " KB vertices, " <<
+					BakedMesh->IndicesData.size() / 1024 << " KB 32-bit indices, baked in " << Time << " ms");
+			}
+
+			FMeshGenerator Generator;
+			const auto SourceMesh = Generator.CreateGrid(100.0f, 100.0f, 1001, 1001);
+
+			const std::string FilePath = "BakeMultiMillionTriangleMeshes.txt";
+			WriteTxtFile(*SourceMesh, FilePath);
+
+			FBenchTimer Timer;
+			FMeshParser MeshParser;
+			const auto MeshData = MeshParser.ParseTxtData(FilePath);
+			const auto Time = Timer.GetMilliseconds();
+			std::remove(FilePath.c_str());
+
+			CHECK(MeshData->Indices == SourceMesh->Indices);
+
+			BENCH_REPORT("txt 1001x1001", MeshData->Indices.size() / 3 << " triangles parsed in " << Time << " ms");
+		}
+	}
+}
@@ -0,0 +1,274 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "DerivedDataCache.h"
+#include "MeshFile.h"
+#include "MeshTestUtils.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			std::string GetSkullFilePath()
+			{
+				return GetAssetsDirectory() + "Assets\\Models\\skull.txt";
+			}
+		}
+
+		TEST(MeshFileKeepsBakedMesh)
+		{
+			auto SubmeshesData = std::vector<std::unique_ptr<FMeshRawData>>();
+			SubmeshesData.push_back(LoadSkullMesh());
+
+			FMeshBakeSettings Settings;
+			Settings.VertexFormat = EVertexFormat::Quantized;
+
+			FMeshBaker MeshBaker;
+			const auto BakedMesh = MeshBaker.Bake(std::move(SubmeshesData), "skull", Settings);
+
+			const std::string FilePath = "MeshFileKeepsBakedMesh.wmesh";
+			FMeshFile::Save(FilePath, *BakedMesh);
+			{
+				FMeshFile MeshFile(FilePath);
+				const auto& Header = MeshFile.GetHeader();
+
+				CHECK(Header.VertexFormat == EVertexFormat::Quantized);
+				CHECK_EQUAL(MeshFile.GetIndexFormat(), BakedMesh->IndexFormat);
+				CHECK_EQUAL(Header.VerticesSize, BakedMesh->VerticesData.size());
+				CHECK(std::equal(BakedMesh->VerticesData.begin(), BakedMesh->VerticesData.end(), MeshFile.GetVerticesData()));
+				CHECK(std::equal(BakedMesh->IndicesData.begin(), BakedMesh->IndicesData.end(), MeshFile.GetIndicesData()));
+
+				const auto SubmeshesData = MeshFile.CreateSubmeshesData();
+				CHECK_EQUAL(SubmeshesData.size(), 1u);
+				CHECK_EQUAL(SubmeshesData[0]->Name, std::string("skull"));
+				CHECK_EQUAL(SubmeshesData[0]->NumIndices, BakedMesh->SubmeshesData[0]->NumIndices);
+				CHECK_EQUAL(SubmeshesData[0]->Meshlets.size(), BakedMesh->SubmeshesData[0]->Meshlets.size());
+			}
+			std::remove(FilePath.c_str());
+		}
+
+		TEST(MeshFileConvertsTxtFile)
+		{
+			const std::string FilePath = "MeshFileConvertsTxtFile.wmesh";
+			FMeshFile::Convert(GetSkullFilePath(), FilePath);
+			{
+				// Submesh of a .txt file is named as the file
+				FMeshFile MeshFile(FilePath);
+				const auto SubmeshesData = MeshFile.CreateSubmeshesData();
+				CHECK_EQUAL(SubmeshesData.size(), 1u);
+				CHECK_EQUAL(SubmeshesData[0]->Name, std::string("skull"));
+				CHECK_EQUAL(SubmeshesData[0]->NumIndices, LoadSkullMesh()->Indices.size());
+			}
+			std::remove(FilePath.c_str());
+		}
+
+		TEST(MeshFileKeepsMaterialsNames)
+		{
+			const std::string SceneFilePath = "MeshFileKeepsMaterialsNames.obj";
+			const std::string FilePath = "MeshFileKeepsMaterialsNames.wmesh";
+			WriteObjScene(SceneFilePath);
+
+			FMeshFile::Convert(SceneFilePath, FilePath);
+			std::remove(SceneFilePath.c_str());
+			std::remove("MeshFileKeepsMaterialsNames.mtl");
+			{
+				FMeshFile MeshFile(FilePath);
+				const auto SubmeshesData = MeshFile.CreateSubmeshesData();
+				CHECK_EQUAL(SubmeshesData.size(), 2u);
+				for (const auto& SubmeshData : SubmeshesData)
+				{
+					const bool bBox = SubmeshData->Name.find("Box") != std::string::npos;
+					CHECK_EQUAL(SubmeshData->MaterialName, std::string(bBox ? "red" : "blue"));
+				}
+			}
+
+			// Submeshes of custom pipelines get names of their indices, indices out of the names have none
+			FMeshGenerator MeshGenerator;
+			std::vector<std::unique_ptr<FMeshRawData>> SubmeshesData;
+			SubmeshesData.push_back(MeshGenerator.CreateBox(1.0f, 1.0f, 1.0f, 0));
+			SubmeshesData.back()->MaterialIndex = 1;
+			SubmeshesData.push_back(MeshGenerator.CreateGrid(1.0f, 1.0f, 4, 4));
+			SubmeshesData.back()->MaterialIndex = 2;
+
+			FMeshFile::Convert(std::move(SubmeshesData), FilePath, FMeshBakeSettings(), { "wood", "stone" });
+			{
+				FMeshFile MeshFile(FilePath);
+				const auto CreatedSubmeshesData = MeshFile.CreateSubmeshesData();
+				CHECK_EQUAL(MeshFile.GetHeader().NumMaterials, 2u);
+				CHECK_EQUAL(CreatedSubmeshesData[0]->MaterialName, std::string("stone"));
+				CHECK(CreatedSubmeshesData[1]->MaterialName.empty());
+			}
+			std::remove(FilePath.c_str());
+		}
+
+		TEST(MeshFileRejectsInvalidFiles)
+		{
+			const std::string FilePath = "MeshFileRejectsInvalidFiles.wmesh";
+			FMeshFile::Convert(GetSkullFilePath(), FilePath);
+
+			std::vector<char> Bytes;
+			{
+				std::ifstream File(FilePath, std::ios_base::in | std::ios_base::binary);
+				Bytes.assign(std::istreambuf_iterator<char>(File), std::istreambuf_iterator<char>());
+			}
+
+			auto WriteBytes = [&FilePath](const std::vector<char>& Bytes)
+			{
+				std::ofstream File(FilePath, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+				File.write(Bytes.data(), Bytes.size());
+			};
+
+			WriteBytes(std::vector<char>(Bytes.begin(), Bytes.end() - 64));
+			CHECK_THROWS(FMeshFile{ FilePath }, std::invalid_argument);
+
+			auto WrongVersionBytes = Bytes;
+			reinterpret_cast<FMeshFileHeader*>(WrongVersionBytes.data())->Version = MeshFileVersion + 1;
+			WriteBytes(WrongVersionBytes);
+			CHECK_THROWS(FMeshFile{ FilePath }, std::invalid_argument);
+
+			const auto& Header = *reinterpret_cast<const FMeshFileHeader*>(Bytes.data());
+			CHECK(Header.NumSubmeshes > 0 && Header.NumMeshlets > 0);
+
+			// Stride of another format
+			auto WrongStrideBytes = Bytes;
+			reinterpret_cast<FMeshFileHeader*>(WrongStrideBytes.data())->VertexStride = Header.VertexStride + 4;
+			WriteBytes(WrongStrideBytes);
+			CHECK_THROWS(FMeshFile{ FilePath }, std::invalid_argument);
+
+			// Submesh's vertices past the vertex buffer
+			auto WrongSubmeshBytes = Bytes;
+			reinterpret_cast<FMeshFileSubmesh*>(WrongSubmeshBytes.data() + Header.SubmeshesOffset)->VertexBegin =
+				static_cast<uint32>(Header.VerticesSize / Header.VertexStride);
+			WriteBytes(WrongSubmeshBytes);
+			CHECK_THROWS(FMeshFile{ FilePath }, std::invalid_argument);
+
+			// Index past the submesh's vertices
+			auto WrongIndexBytes = Bytes;
+			memset(WrongIndexBytes.data() + Header.IndicesOffset, 0xFF, Header.IndexSize);
+			WriteBytes(WrongIndexBytes);
+			CHECK_THROWS(FMeshFile{ FilePath }, std::invalid_argument);
+
+			// Meshlet's triangles past the submesh's indices and meshlet with more vertices than its triangles have
+			auto WrongMeshletBytes = Bytes;
+			auto* Meshlet = reinterpret_cast<FMeshlet*>(WrongMeshletBytes.data() + Header.MeshletsOffset);
+			Meshlet->IndexBegin = UINT32_MAX - 1;
+			WriteBytes(WrongMeshletBytes);
+			CHECK_THROWS(FMeshFile{ FilePath }, std::invalid_argument);
+
+			WrongMeshletBytes = Bytes;
+			Meshlet = reinterpret_cast<FMeshlet*>(WrongMeshletBytes.data() + Header.MeshletsOffset);
+			Meshlet->NumVertices = Meshlet->NumTriangles * 3 + 1;
+			WriteBytes(WrongMeshletBytes);
+			CHECK_THROWS(FMeshFile{ FilePath }, std::invalid_argument);
+
+			// The source file is still valid
+			WriteBytes(Bytes);
+			CHECK_EQUAL(FMeshFile(FilePath).GetHeader().NumMeshlets, Header.NumMeshlets);
+
+			std::remove(FilePath.c_str());
+		}
+
+		TEST(DerivedDataCacheConvertsMeshFileOnMiss)
+		{
+			FDerivedDataCache DerivedDataCache(".");
+
+			// The key depends on the test's run, so the first lookup misses
+			auto Key = FDerivedDataKey("DerivedDataCacheConvertsMeshFileOnMiss").AddFile(GetSkullFilePath());
+			Key.Add(FBenchTimer().GetMilliseconds());
+
+			auto NumConversions = 0;
+			auto Convert = [&NumConversions](const std::string& FilePath)
+			{
+				++NumConversions;
+				FMeshFile::Convert(GetSkullFilePath(), FilePath);
+			};
+
+			const auto FilePath = DerivedDataCache.GetFile(Key, ".wmesh", Convert);
+			CHECK_EQUAL(DerivedDataCache.GetFile(Key, ".wmesh", Convert), FilePath);
+			CHECK_EQUAL(NumConversions, 1);
+			CHECK_EQUAL(DerivedDataCache.GetStats().NumMisses, 1u);
+			CHECK_EQUAL(DerivedDataCache.GetStats().NumHits, 1u);
+
+			CHECK_EQUAL(FMeshFile(FilePath).CreateSubmeshesData()[0]->Name, std::string("skull"));
+			std::remove(FilePath.c_str());
+
+			// Failed conversions don't leave files in the cache
+			const auto FailedKey = FDerivedDataKey("DerivedDataCacheConvertsMeshFileOnMiss").Add(FilePath);
+			CHECK_THROWS(DerivedDataCache.GetFile(FailedKey, ".wmesh", [](const std::string& FilePath)
+			{
+				FMeshFile::Convert("missing.txt", FilePath);
+			}), std::invalid_argument);
+			CHECK(!std::ifstream(FilePath).is_open());
+		}
+
+		TEST(DerivedDataCacheReplacesInvalidFile)
+		{
+			FDerivedDataCache DerivedDataCache(".");
+
+			auto Key = FDerivedDataKey("DerivedDataCacheReplacesInvalidFile");
+			Key.Add(FBenchTimer().GetMilliseconds());
+
+			// Left by a crashed build or an older version of the cache
+			const auto FilePath = ".\\" + Key.ToString() + ".ddc";
+			std::ofstream(FilePath, std::ios_base::out | std::ios_base::binary) << "invalid";
+
+			auto NumBuilds = 0;
+			auto Build = [&NumBuilds]()
+			{
+				++NumBuilds;
+				return std::vector<uint8>{ 1, 2, 3 };
+			};
+
+			CHECK(DerivedDataCache.GetData(Key, Build) == std::vector<uint8>({ 1, 2, 3 }));
+			CHECK(DerivedDataCache.GetData(Key, Build) == std::vector<uint8>({ 1, 2, 3 }));
+			CHECK_EQUAL(NumBuilds, 1);
+
+			std::remove(FilePath.c_str());
+		}
+
+		BENCHMARK(LoadSkullFromTxtAndMeshFile)
+		{
+			const std::string FilePath = "LoadSkullFromTxtAndMeshFile.wmesh";
+
+			FBenchTimer ConvertTimer;
+			FMeshFile::Convert(GetSkullFilePath(), FilePath);
+			const auto ConvertTime = ConvertTimer.GetMilliseconds();
+
+			// Source loads parse and bake the mesh on every start
+			FBenchTimer SourceTimer;
+			std::vector<std::unique_ptr<FMeshRawData>> SubmeshesData;
+			SubmeshesData.push_back(LoadSkullMesh());
+			FMeshBaker MeshBaker;
+			const auto BakedMesh = MeshBaker.Bake(std::move(SubmeshesData), "skull");
+			const auto SourceTime = SourceTimer.GetMilliseconds();
+
+			// Baked loads map and validate the file. Its buffers are uploaded as is
+			const auto NumLoads = 100;
+			uint64 Checksum = 0;
+			FBenchTimer FileTimer;
+			for (auto iLoad = 0; iLoad < NumLoads; ++iLoad)
+			{
+				FMeshFile MeshFile(FilePath);
+				const auto SubmeshesData = MeshFile.CreateSubmeshesData();
+				const auto& Header = MeshFile.GetHeader();
+				for (uint64 iByte = 0; iByte < Header.VerticesSize; iByte += 64)
+				{
+					Checksum += MeshFile.GetVerticesData()[iByte];
+				}
+				Checksum += SubmeshesData.size();
+			}
+			const auto FileTime = FileTimer.GetMilliseconds() / NumLoads;
+			std::remove(FilePath.c_str());
+
+			CHECK(Checksum > 0);
+
+			BENCH_REPORT("skull.txt", "parsed and baked in " << SourceTime << " ms (" <<
+				BakedMesh->VerticesData.size() + BakedMesh->IndicesData.size() << " bytes of buffers)");
+			BENCH_REPORT("skull.wmesh", "converted in " << ConvertTime << " ms, loaded in " << FileTime <<
+				" ms, " << SourceTime / FileTime << "x faster");
+		}
+	}
+}
@@ -0,0 +1,370 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <tuple>
+
+#include "MeshData.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			// Subdivision which was used before sharing of midpoints. Every triangle emits 6 own vertices
+			void SubdivideUnshared(FMeshRawData* MeshData)
+			{
+				const auto CopiedMeshData = *MeshData;
+
+				MeshData->Vertices.resize(0);
+				MeshData->Indices.resize(0);
+
+				const auto NumTriangles = static_cast<uint32>(CopiedMeshData.Indices.size() / 3);
+				for (uint32 i = 0; i < NumTriangles; ++i)
+				{
+					auto V0 = CopiedMeshData.Vertices[CopiedMeshData.Indices[i * 3 + 0]];
+					auto V1 = CopiedMeshData.Vertices[CopiedMeshData.Indices[i * 3 + 1]];
+					auto V2 = CopiedMeshData.Vertices[CopiedMeshData.Indices[i * 3 + 2]];
+
+					MeshData->Vertices.push_back(V0);
+					MeshData->Vertices.push_back(V1);
+					MeshData->Vertices.push_back(V2);
+					MeshData->Vertices.push_back(FVertex::MidPoint(V0, V1));
+					MeshData->Vertices.push_back(FVertex::MidPoint(V1, V2));
+					MeshData->Vertices.push_back(FVertex::MidPoint(V0, V2));
+
+					const uint32 Triangles[] = { 0, 3, 5,  3, 4, 5,  5, 4, 2,  3, 1, 4 };
+					for (auto Index : Triangles)
+					{
+						MeshData->Indices.push_back(i * 6 + Index);
+					}
+				}
+			}
+
+			// Scalar sphere ring vertex, which was generated before the 4-wide path
+			FVertex CreateSphereVertexScalar(float Radius, float Phi, float Theta)
+			{
+				const float SinPhi = sinf(Phi);
+				const float CosPhi = cosf(Phi);
+				const float SinTheta = sinf(Theta);
+				const float CosTheta = cosf(Theta);
+
+				FVertex Vertex;
+				Vertex.Position.x = Radius*SinPhi*CosTheta;
+				Vertex.Position.y = Radius*CosPhi;
+				Vertex.Position.z = Radius*SinPhi*SinTheta;
+
+				Vertex.Tangent.x = -Radius*SinPhi*SinTheta;
+				Vertex.Tangent.y = 0.0f;
+				Vertex.Tangent.z = Radius*SinPhi*CosTheta;
+
+				Vertex.TexC.x = Theta / XM_2PI;
+				Vertex.TexC.y = Phi / XM_PI;
+
+				XMStoreFloat3(&Vertex.Tangent, XMVector3Normalize(XMLoadFloat3(&Vertex.Tangent)));
+				XMStoreFloat3(&Vertex.Normal, XMVector3Normalize(XMLoadFloat3(&Vertex.Position)));
+				return Vertex;
+			}
+
+			// Scalar projection of a subdivided icosahedron's vertex to the sphere
+			void ProjectGeoSphereVertexScalar(FVertex* Vertex, float Radius)
+			{
+				XMVECTOR Normal = XMVector3Normalize(XMLoadFloat3(&Vertex->Position));
+				XMStoreFloat3(&Vertex->Position, Normal * Radius);
+				XMStoreFloat3(&Vertex->Normal, Normal);
+
+				float Theta = atan2f(Vertex->Position.z, Vertex->Position.x);
+				if (Theta < 0.0f)
+					Theta += XM_2PI;
+				float Phi = acosf(std::max(-1.0f, std::min(Vertex->Position.y / Radius, 1.0f)));
+				Vertex->TexC.x = Theta / XM_2PI;
+				Vertex->TexC.y = Phi / XM_PI;
+
+				Vertex->Tangent.x = -Radius * sinf(Phi)*sinf(Theta);
+				Vertex->Tangent.y = 0.0f;
+				Vertex->Tangent.z = +Radius * sinf(Phi)*cosf(Theta);
+
+				XMStoreFloat3(&Vertex->Tangent, XMVector3Normalize(XMLoadFloat3(&Vertex->Tangent)));
+			}
+
+			// Scalar landscape vertex of the grid's vertex
+			void ElevateLandscapeVertexScalar(FVertex* Vertex)
+			{
+				float z = Vertex->Position.z;
+				float x = Vertex->Position.x;
+
+				Vertex->Position.y = 0.5f*(sinf(x*0.2f)*x + cosf(z*0.2f)*z);
+
+				Vertex->Tangent.x = 1;
+				Vertex->Tangent.y =
+					cosf(z / 5) / 2.0f + sinf(x / 5) / 2.0f + x * cosf(x / 5) / 10.0f - z * sinf(z / 5) / 10;
+				Vertex->Tangent.z = 1;
+				XMStoreFloat3(&Vertex->Tangent, XMVector3Normalize(XMLoadFloat3(&Vertex->Tangent)));
+
+				Vertex->Normal.x = -sinf(x / 5) / 2 - x * cosf(x / 5) / 10;
+				Vertex->Normal.y = 1;
+				Vertex->Normal.z = z * sinf(z / 5) / 10 - cosf(z / 5) / 2;
+				XMStoreFloat3(&Vertex->Normal, XMVector3Normalize(XMLoadFloat3(&Vertex->Normal)));
+			}
+
+			// Max difference of vertices' components relative to max(1, |reference component|)
+			float GetMaxVertexDifference(const FVertex& Vertex, const FVertex& ReferenceVertex)
+			{
+				const auto* Components = &Vertex.Position.x;
+				const auto* ReferenceComponents = &ReferenceVertex.Position.x;
+
+				auto MaxDifference = 0.0f;
+				for (std::size_t iComponent = 0; iComponent < sizeof(FVertex) / sizeof(float); ++iComponent)
+				{
+					MaxDifference = std::max(MaxDifference, std::fabs(Components[iComponent] - ReferenceComponents[iComponent]) /
+						std::max(1.0f, std::fabs(ReferenceComponents[iComponent])));
+				}
+				return MaxDifference;
+			}
+
+			uint32 CountUniquePositions(const FMeshRawData& MeshData)
+			{
+				std::vector<std::tuple<float, float, float>> Positions;
+				Positions.reserve(MeshData.Vertices.size());
+				for (const auto& Vertex : MeshData.Vertices)
+				{
+					Positions.emplace_back(Vertex.Position.x, Vertex.Position.y, Vertex.Position.z);
+				}
+
+				std::sort(Positions.begin(), Positions.end());
+				return static_cast<uint32>(std::unique(Positions.begin(), Positions.end()) - Positions.begin());
+			}
+		}
+
+		TEST(SubdivideSharesEdgesMidpoints)
+		{
+			FMeshGenerator MeshGenerator;
+
+			// Closed icosahedron: V = 10*4^n + 2, every vertex is shared by its triangles
+			uint32 ExpectedNumVertices = 12;
+			for (uint16_t iLevel = 0; iLevel <= 4; ++iLevel)
+			{
+				const auto MeshData = MeshGenerator.CreateGeoSphere(1.0f, iLevel);
+
+				CHECK_EQUAL(MeshData->Vertices.size(), ExpectedNumVertices);
+				CHECK_EQUAL(MeshData->Indices.size(), 60u << (2 * iLevel));
+				CHECK_EQUAL(CountUniquePositions(*MeshData), ExpectedNumVertices);
+				CHECK(std::all_of(MeshData->Indices.cbegin(), MeshData->Indices.cend(),
+					[&MeshData](uint32 Index) { return Index < MeshData->Vertices.size(); }));
+
+				ExpectedNumVertices = (ExpectedNumVertices - 2) * 4 + 2;
+			}
+		}
+
+		TEST(SubdivideKeepsSurface)
+		{
+			FMeshGenerator MeshGenerator;
+
+			auto MeshData = MeshGenerator.CreateBox(1.0f, 2.0f, 3.0f);
+			const auto NumTriangles = MeshData->Indices.size() / 3;
+			MeshGenerator.Subdivide(MeshData.get());
+
+			CHECK_EQUAL(MeshData->Indices.size() / 3, NumTriangles * 4);
+
+			// Midpoints of the box's faces stay on the faces
+			for (const auto& Vertex : MeshData->Vertices)
+			{
+				const auto bOnFace =
+					std::fabs(std::fabs(Vertex.Position.x) - 0.5f) < 1e-5f ||
+					std::fabs(std::fabs(Vertex.Position.y) - 1.0f) < 1e-5f ||
+					std::fabs(std::fabs(Vertex.Position.z) - 1.5f) < 1e-5f;
+				CHECK(bOnFace);
+			}
+		}
+
+		TEST(SubdivideParallelMatchesSequential)
+		{
+			FMeshGenerator MeshGenerator;
+
+			// Level 4 geosphere has 5120 triangles, so the next level is split across workers
+			auto ParallelMeshData = MeshGenerator.CreateGeoSphere(1.0f, 4);
+			auto SequentialMeshData = std::make_unique<FMeshRawData>(*ParallelMeshData);
+
+			MeshGenerator.Subdivide(ParallelMeshData.get(), true);
+			MeshGenerator.Subdivide(SequentialMeshData.get(), false);
+
+			CHECK(ParallelMeshData->Indices == SequentialMeshData->Indices);
+			CHECK_EQUAL(ParallelMeshData->Vertices.size(), SequentialMeshData->Vertices.size());
+			CHECK(std::equal(ParallelMeshData->Vertices.cbegin(), ParallelMeshData->Vertices.cend(),
+				SequentialMeshData->Vertices.cbegin(), [](const FVertex& Vertex0, const FVertex& Vertex1)
+			{
+				return std::memcmp(&Vertex0, &Vertex1, sizeof(FVertex)) == 0;
+			}));
+		}
+
+		TEST(SphereMatchesScalarReference)
+		{
+			FMeshGenerator MeshGenerator;
+
+			const auto Radius = 2.5f;
+			const uint32 NumVSubdivisions = 23;
+			const uint32 NumHSubdivisions = 37;
+			const auto MeshData = MeshGenerator.CreateSphere(Radius, NumVSubdivisions, NumHSubdivisions);
+
+			auto MaxDifference = 0.0f;
+			for (uint32 iVSubdivision = 1; iVSubdivision < NumVSubdivisions; ++iVSubdivision)
+			{
+				for (uint32 iHSubdivision = 0; iHSubdivision <= NumHSubdivisions; ++iHSubdivision)
+				{
+					const auto ReferenceVertex = CreateSphereVertexScalar(Radius, 
+						XM_PI / NumVSubdivisions * iVSubdivision, 2.0f*XM_PI / NumHSubdivisions * iHSubdivision);
+					const auto& Vertex = MeshData->Vertices[1 + (iVSubdivision - 1)*(NumHSubdivisions + 1) + iHSubdivision];
+
+					MaxDifference = std::max(MaxDifference, GetMaxVertexDifference(Vertex, ReferenceVertex));
+				}
+			}
+
+			CHECK(MaxDifference < 1e-5f);
+		}
+
+		TEST(GeoSphereMatchesScalarReference)
+		{
+			FMeshGenerator MeshGenerator;
+
+			const auto Radius = 3.0f;
+			const auto MeshData = MeshGenerator.CreateGeoSphere(Radius, 3);
+
+			auto MaxDifference = 0.0f;
+			for (const auto& Vertex : MeshData->Vertices)
+			{
+				// Tangent of poles depends on rounding of sin(phi), where the scalar one may be NaN
+				if (std::fabs(Vertex.Normal.y) > 0.9999f)
+				{
+					CHECK(!std::isnan(Vertex.Tangent.x) && !std::isnan(Vertex.Tangent.z));
+					continue;
+				}
+
+				auto ReferenceVertex = Vertex;
+				ProjectGeoSphereVertexScalar(&ReferenceVertex, Radius);
+				MaxDifference = std::max(MaxDifference, GetMaxVertexDifference(Vertex, ReferenceVertex));
+			}
+
+			CHECK(MaxDifference < 1e-5f);
+		}
+
+		TEST(LandscapeMatchesScalarReference)
+		{
+			FMeshGenerator MeshGenerator;
+
+			const auto MeshData = MeshGenerator.CreateLandscapeGrid(100.0f, 100.0f, 61, 67);
+			auto ReferenceMeshData = MeshGenerator.CreateGrid(100.0f, 100.0f, 61, 67);
+			CHECK_EQUAL(MeshData->Vertices.size(), ReferenceMeshData->Vertices.size());
+
+			auto MaxDifference = 0.0f;
+			for (std::size_t iVertex = 0; iVertex < MeshData->Vertices.size(); ++iVertex)
+			{
+				ElevateLandscapeVertexScalar(&ReferenceMeshData->Vertices[iVertex]);
+				MaxDifference = std::max(MaxDifference, 
+					GetMaxVertexDifference(MeshData->Vertices[iVertex], ReferenceMeshData->Vertices[iVertex]));
+			}
+
+			CHECK(MaxDifference < 1e-5f);
+			CHECK(MeshData->Indices == ReferenceMeshData->Indices);
+		}
+
+		BENCHMARK(GenerateMeshesAgainstScalarReference)
+		{
+			FMeshGenerator MeshGenerator;
+
+			{
+				FBenchTimer GridTimer;
+				MeshGenerator.CreateGrid(2048.0f, 2048.0f, 2048, 2048);
+				const auto GridTime = GridTimer.GetMilliseconds();
+
+				FBenchTimer Timer;
+				const auto MeshData = MeshGenerator.CreateLandscapeGrid(2048.0f, 2048.0f, 2048, 2048);
+				const auto Time = Timer.GetMilliseconds() - GridTime;
+
+				auto ReferenceMeshData = MeshGenerator.CreateGrid(2048.0f, 2048.0f, 2048, 2048);
+				FBenchTimer ReferenceTimer;
+				for (auto& Vertex : ReferenceMeshData->Vertices)
+				{
+					ElevateLandscapeVertexScalar(&Vertex);
+				}
+				const auto ReferenceTime = ReferenceTimer.GetMilliseconds();
+
+				const auto NumVertices = MeshData->Vertices.size();
+				BENCH_REPORT("Landscape 2048x2048", NumVertices << " vertices elevated in " << Time << " ms (" <<
+					NumVertices / Time / 1000.0 << " M/s) without the grid, scalar " << ReferenceTime << " ms (" <<
+					NumVertices / ReferenceTime / 1000.0 << " M/s)");
+			}
+
+			{
+				const uint32 NumVSubdivisions = 1024;
+				const uint32 NumHSubdivisions = 2048;
+
+				FBenchTimer Timer;
+				const auto MeshData = MeshGenerator.CreateSphere(1.0f, NumVSubdivisions, NumHSubdivisions);
+				const auto Time = Timer.GetMilliseconds();
+
+				std::vector<FVertex> ReferenceVertices(MeshData->Vertices.size());
+				FBenchTimer ReferenceTimer;
+				for (uint32 iVSubdivision = 1, iVertex = 1; iVSubdivision < NumVSubdivisions; ++iVSubdivision)
+				{
+					for (uint32 iHSubdivision = 0; iHSubdivision <= NumHSubdivisions; ++iHSubdivision, ++iVertex)
+					{
+						ReferenceVertices[iVertex] = CreateSphereVertexScalar(1.0f, 
+							XM_PI / NumVSubdivisions * iVSubdivision, 2.0f*XM_PI / NumHSubdivisions * iHSubdivision);
+					}
+				}
+				const auto ReferenceTime = ReferenceTimer.GetMilliseconds();
+
+				BENCH_REPORT("Sphere 1024x2048", MeshData->Vertices.size() << " vertices in " << Time << 
+					" ms (indices included), scalar vertices " << ReferenceTime << " ms");
+			}
+
+			{
+				FBenchTimer Timer;
+				auto MeshData = MeshGenerator.CreateGeoSphere(1.0f, 6);
+				const auto Time = Timer.GetMilliseconds();
+
+				FBenchTimer ReferenceTimer;
+				for (auto& Vertex : MeshData->Vertices)
+				{
+					ProjectGeoSphereVertexScalar(&Vertex, 1.0f);
+				}
+				const auto ReferenceTime = ReferenceTimer.GetMilliseconds();
+
+				BENCH_REPORT("Geosphere level 6", MeshData->Vertices.size() << " vertices in " << Time << 
+					" ms (subdivision included), scalar projection " << ReferenceTime << " ms");
+			}
+		}
+
+		BENCHMARK(SubdivideAgainstUnsharedMidpoints)
+		{
+			FMeshGenerator MeshGenerator;
+
+			auto SharedMeshData = MeshGenerator.CreateGeoSphere(1.0f, 0);
+			auto SequentialMeshData = std::make_unique<FMeshRawData>(*SharedMeshData);
+			auto UnsharedMeshData = std::make_unique<FMeshRawData>(*SharedMeshData);
+
+			for (auto iLevel = 1; iLevel <= 6; ++iLevel)
+			{
+				FBenchTimer UnsharedTimer;
+				SubdivideUnshared(UnsharedMeshData.get());
+				const auto UnsharedTime = UnsharedTimer.GetMilliseconds();
+
+				FBenchTimer SequentialTimer;
+				MeshGenerator.Subdivide(SequentialMeshData.get(), false);
+				const auto SequentialTime = SequentialTimer.GetMilliseconds();
+
+				FBenchTimer SharedTimer;
+				MeshGenerator.Subdivide(SharedMeshData.get(), true);
+				const auto SharedTime = SharedTimer.GetMilliseconds();
+
+				CHECK_EQUAL(SharedMeshData->Indices.size(), UnsharedMeshData->Indices.size());
+
+				BENCH_REPORT("Level " << iLevel, UnsharedMeshData->Vertices.size() << " -> " <<
+					SharedMeshData->Vertices.size() << " vertices, " << UnsharedTime << " ms unshared, " <<
+					SequentialTime << " ms shared, " << SharedTime << " ms shared parallel");
+			}
+		}
+	}
+}
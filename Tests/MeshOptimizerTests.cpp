@@ -0,0 +1,110 @@
+#include "MeshOptimizer.h"
+#include "MeshWelder.h"
+#include "MeshTestUtils.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		TEST(OptimizeKeepsTriangles)
+		{
+			FMeshGenerator MeshGenerator;
+			auto MeshData = MeshGenerator.CreateGrid(10.0f, 10.0f, 40, 40);
+			ShuffleTriangles(MeshData.get());
+
+			const auto SourceTriangles = GetSortedTriangles(*MeshData);
+
+			FMeshOptimizer MeshOptimizer;
+			const auto Stats = MeshOptimizer.Optimize(MeshData.get(), true);
+
+			CHECK(GetSortedTriangles(*MeshData) == SourceTriangles);
+			CHECK(Stats.After.ACMR < Stats.Before.ACMR);
+			CHECK(Stats.After.ATVR >= 1.0f);
+			CHECK_NEAR(Stats.After.ACMR, MeshOptimizer.AnalyzeVertexCache(*MeshData).ACMR, 1e-5f);
+		}
+
+		TEST(OptimizeReducesCacheMissesOfShuffledMesh)
+		{
+			FMeshGenerator MeshGenerator;
+			auto MeshData = MeshGenerator.CreateGeoSphere(1.0f, 4);
+			ShuffleTriangles(MeshData.get());
+
+			FMeshOptimizer MeshOptimizer;
+			const auto Stats = MeshOptimizer.Optimize(MeshData.get());
+
+			// ACMR of a regular closed mesh can't be less than ~0.5. Forsyth's order is close to 0.7
+			CHECK(Stats.Before.ACMR > 2.0f);
+			CHECK(Stats.After.ACMR < 0.8f);
+		}
+
+		TEST(OptimizeVertexFetchOrdersVerticesByFirstUse)
+		{
+			FMeshRawData MeshData;
+			for (auto iVertex = 0; iVertex < 5; ++iVertex)
+			{
+				MeshData.Vertices.emplace_back(XMFLOAT3(static_cast<float>(iVertex), 0.0f, 0.0f));
+			}
+
+			// Vertex 1 isn't referenced
+			MeshData.Indices = { 4, 2, 0,  0, 2, 3 };
+
+			FMeshOptimizer MeshOptimizer;
+			MeshOptimizer.OptimizeVertexFetch(&MeshData);
+
+			CHECK_EQUAL(MeshData.Vertices.size(), 4u);
+			CHECK((MeshData.Indices == std::vector<uint32>{ 0, 1, 2,  2, 1, 3 }));
+			CHECK_EQUAL(MeshData.Vertices[0].Position.x, 4.0f);
+			CHECK_EQUAL(MeshData.Vertices[3].Position.x, 3.0f);
+		}
+
+		TEST(OptimizeSkipsPatchLists)
+		{
+			FMeshGenerator MeshGenerator;
+			auto MeshData = MeshGenerator.CreateBezierGrid();
+			const auto SourceIndices = MeshData->Indices;
+
+			FMeshOptimizer MeshOptimizer;
+			MeshOptimizer.Optimize(MeshData.get(), true);
+
+			CHECK(MeshData->Indices == SourceIndices);
+		}
+
+		BENCHMARK(OptimizeSkullAndGeneratedMeshes)
+		{
+			FMeshGenerator MeshGenerator;
+
+			std::vector<std::unique_ptr<FMeshRawData>> MeshesData;
+			MeshesData.push_back(LoadSkullMesh());
+			MeshesData.push_back(MeshGenerator.CreateLandscapeGrid(40.0f, 40.0f, 160, 160));
+			MeshesData.back()->Name = "landscape (shuffled)";
+			ShuffleTriangles(MeshesData.back().get());
+			MeshesData.push_back(MeshGenerator.CreateGeoSphere(1.0f, 6));
+			MeshesData.back()->Name = "geosphere (shuffled)";
+			ShuffleTriangles(MeshesData.back().get());
+
+			FMeshWelder MeshWelder;
+			FMeshOptimizer MeshOptimizer;
+			for (auto& MeshData : MeshesData)
+			{
+				MeshWelder.Weld(MeshData.get());
+
+				// The overdraw pass is compared on a copy, since it's disabled by default
+				FMeshRawData OverdrawMeshData(*MeshData);
+
+				FBenchTimer Timer;
+				const auto Stats = MeshOptimizer.Optimize(MeshData.get());
+				const auto Time = Timer.GetMilliseconds();
+
+				const auto OverdrawStats = MeshOptimizer.Optimize(&OverdrawMeshData, true);
+
+				// Optimization never makes ACMR worse, and the overdraw pass can't either
+				CHECK(Stats.After.ACMR <= Stats.Before.ACMR);
+				CHECK(OverdrawStats.After.ACMR <= Stats.Before.ACMR);
+
+				BENCH_REPORT(MeshData->Name, MeshData->Indices.size() / 3 << " triangles, ACMR " <<
+					Stats.Before.ACMR << " -> " << Stats.After.ACMR << " (" << OverdrawStats.After.ACMR <<
+					" with overdraw pass), ATVR " << Stats.Before.ATVR << " -> " << Stats.After.ATVR << " in " << Time << " ms");
+			}
+		}
+	}
+}
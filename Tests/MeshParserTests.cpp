@@ -0,0 +1,314 @@
+#include <cfloat>
+#include <cstdio>
+#include <fstream>
+
+#include "MeshTestUtils.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/** @brief Parses the .txt mesh through istream as the engine did before mapped files,
+			  * so results of ParseTxtData are compared with it
+			  * @param FilePath (const std::string &)
+			  * @return (std::unique_ptr<WoodenEngine::FMeshRawData>)
+			  */
+			std::unique_ptr<FMeshRawData> ParseTxtDataWithStream(const std::string& FilePath)
+			{
+				std::ifstream File(FilePath);
+
+				uint64 NumVertices = 0;
+				uint64 NumTriangles = 0;
+				File >> NumVertices >> NumTriangles;
+
+				auto MeshData = std::make_unique<FMeshRawData>();
+				MeshData->Vertices.resize(NumVertices);
+				for (auto& Vertex : MeshData->Vertices)
+				{
+					File >> Vertex.Position.x >> Vertex.Position.y >> Vertex.Position.z >>
+						Vertex.Normal.x >> Vertex.Normal.y >> Vertex.Normal.z;
+				}
+
+				MeshData->Indices.resize(NumTriangles * 3);
+				for (auto& Index : MeshData->Indices)
+				{
+					File >> Index;
+				}
+
+				return MeshData;
+			}
+
+			/** @brief Checks that meshes have the same bits of positions and normals, and the same indices
+			  * @param MeshData (const FMeshRawData &)
+			  * @param ExpectedMeshData (const FMeshRawData &)
+			  * @return (bool)
+			  */
+			bool IsBitIdentical(const FMeshRawData& MeshData, const FMeshRawData& ExpectedMeshData)
+			{
+				if (MeshData.Vertices.size() != ExpectedMeshData.Vertices.size() ||
+					MeshData.Indices != ExpectedMeshData.Indices)
+				{
+					return false;
+				}
+
+				for (std::size_t iVertex = 0; iVertex < MeshData.Vertices.size(); ++iVertex)
+				{
+					const auto& Vertex = MeshData.Vertices[iVertex];
+					const auto& ExpectedVertex = ExpectedMeshData.Vertices[iVertex];
+					if (std::memcmp(&Vertex.Position, &ExpectedVertex.Position, sizeof(Vertex.Position)) != 0 ||
+						std::memcmp(&Vertex.Normal, &ExpectedVertex.Normal, sizeof(Vertex.Normal)) != 0)
+					{
+						return false;
+					}
+				}
+
+				return true;
+			}
+
+			/** @brief Writes a .txt mesh of a wavy grid chunk by chunk, so the text is never kept in memory whole
+			  * @param FilePath (const std::string &)
+			  * @param NumVerticesPerSide (uint32)
+			  * @return File's size in bytes (uint64)
+			  */
+			uint64 WriteGridTxtFile(const std::string& FilePath, uint32 NumVerticesPerSide)
+			{
+				std::ofstream File(FilePath, std::ios::binary);
+				const auto NumQuadsPerSide = NumVerticesPerSide - 1;
+				File << uint64(NumVerticesPerSide)*NumVerticesPerSide << " " << 2ull*NumQuadsPerSide*NumQuadsPerSide << "\n";
+
+				std::ostringstream Chunk;
+				auto FlushChunk = [&File, &Chunk]()
+				{
+					File << Chunk.str();
+					Chunk.str(std::string());
+				};
+
+				for (uint32 Z = 0; Z < NumVerticesPerSide; ++Z)
+				{
+					for (uint32 X = 0; X < NumVerticesPerSide; ++X)
+					{
+						const auto Height = 3.0f*sinf(0.01f*X)*cosf(0.013f*Z);
+						Chunk << 0.25f*X - 100.0f << " " << Height << " " << 0.25f*Z - 100.0f << " " <<
+							-0.03f*cosf(0.01f*X) << " " << 0.999f << " " << 0.039f*sinf(0.013f*Z) << "\n";
+					}
+					FlushChunk();
+				}
+
+				for (uint32 Z = 0; Z < NumQuadsPerSide; ++Z)
+				{
+					for (uint32 X = 0; X < NumQuadsPerSide; ++X)
+					{
+						const auto iVertex = Z*NumVerticesPerSide + X;
+						Chunk << iVertex << " " << iVertex + NumVerticesPerSide << " " << iVertex + 1 << "\n" <<
+							iVertex + 1 << " " << iVertex + NumVerticesPerSide << " " << iVertex + NumVerticesPerSide + 1 << "\n";
+					}
+					FlushChunk();
+				}
+
+				return static_cast<uint64>(File.tellp());
+			}
+
+			/** @brief Writes the text as is, keeping its line ends
+			  * @param FilePath (const std::string &)
+			  * @param Text (const std::string &)
+			  * @return (void)
+			  */
+			void WriteTextFile(const std::string& FilePath, const std::string& Text)
+			{
+				std::ofstream File(FilePath, std::ios::binary);
+				File << Text;
+			}
+		}
+
+		TEST(ParseTxtDataMatchesStreamParser)
+		{
+			const auto FilePath = GetAssetsDirectory() + "Assets\\Models\\skull.txt";
+
+			FMeshParser MeshParser;
+			const auto MeshData = MeshParser.ParseTxtData(FilePath);
+
+			// skull.txt is a few MB, so it's parsed in several chunks
+			CHECK(IsBitIdentical(*MeshData, *ParseTxtDataWithStream(FilePath)));
+		}
+
+		TEST(ParseTxtDataOfUnusualTokens)
+		{
+			// Rounding cases of the exact path, the strtof fallback, signs, exponents and CRLF line ends
+			const std::string FilePath = "ParseTxtDataOfUnusualTokens.txt";
+			WriteTextFile(FilePath,
+				"3\r\n1\r\n"
+				"0.1 -0.1 +2.5 .5 5. -0\r\n"
+				"16777216 16777217 123456789.123 0.00000000001 1e-3 -2.5E+2\r\n"
+				"\t3.4028234e38   1.17549435e-38 0.3333333333333 99999.999 7 -0.000001\r\n"
+				"0 1 2\r\n");
+
+			FMeshParser MeshParser;
+			const auto MeshData = MeshParser.ParseTxtData(FilePath);
+			const auto ExpectedMeshData = ParseTxtDataWithStream(FilePath);
+			std::remove(FilePath.c_str());
+
+			CHECK(IsBitIdentical(*MeshData, *ExpectedMeshData));
+			CHECK_EQUAL(MeshData->Vertices[0].Position.x, 0.1f);
+			CHECK_EQUAL(MeshData->Vertices[1].Normal.z, -250.0f);
+		}
+
+		TEST(ParseTxtDataOfLinesAcrossChunks)
+		{
+			// A single long line spans several chunks, so chunks are aligned past it
+			FMeshGenerator MeshGenerator;
+			const auto SourceMesh = MeshGenerator.CreateLandscapeGrid(50.0f, 50.0f, 400, 400);
+
+			std::ostringstream Text;
+			Text << SourceMesh->Vertices.size() << " " << SourceMesh->Indices.size() / 3 << " ";
+			for (const auto& Vertex : SourceMesh->Vertices)
+			{
+				Text << Vertex.Position.x << " " << Vertex.Position.y << " " << Vertex.Position.z << " " <<
+					Vertex.Normal.x << " " << Vertex.Normal.y << " " << Vertex.Normal.z << " ";
+			}
+
+			Text << "\n";
+			for (std::size_t iIndex = 0; iIndex < SourceMesh->Indices.size(); ++iIndex)
+			{
+				Text << SourceMesh->Indices[iIndex] << ((iIndex % 3 == 2) ? "\n" : " ");
+			}
+
+			const std::string FilePath = "ParseTxtDataOfLinesAcrossChunks.txt";
+			WriteTextFile(FilePath, Text.str());
+
+			FMeshParser MeshParser;
+			const auto MeshData = MeshParser.ParseTxtData(FilePath);
+			const auto ExpectedMeshData = ParseTxtDataWithStream(FilePath);
+			std::remove(FilePath.c_str());
+
+			CHECK(Text.str().size() > 4 * (1 << 20));
+			CHECK(IsBitIdentical(*MeshData, *ExpectedMeshData));
+		}
+
+		TEST(ParseTxtDataRejectsInvalidFiles)
+		{
+			const std::string FilePath = "ParseTxtDataRejectsInvalidFiles.txt";
+			FMeshParser MeshParser;
+
+			const std::string InvalidTexts[] = {
+				"",
+				"1",
+				"-1 1\n0 0 0 0 0 1\n0 0 0\n",
+				"99999999999 1\n",
+				"1 1\n0 0 0 0 0 1\n0 0\n",
+				"1 1\n0 0 0 0 x 1\n0 0 0\n",
+				"1 1\n0 0 0 0 0 1\n0 -1 0\n",
+				"1 1\n0 0 0 0 0 1\n0 0 4294967296\n" };
+
+			for (const auto& Text : InvalidTexts)
+			{
+				WriteTextFile(FilePath, Text);
+				CHECK_THROWS(MeshParser.ParseTxtData(FilePath), std::invalid_argument);
+			}
+
+			// Values past the counted ones are ignored, as istream did
+			WriteTextFile(FilePath, "1 1\n0 0 0 0 0 1\n0 0 0\n1 2 3\n");
+			CHECK_EQUAL(MeshParser.ParseTxtData(FilePath)->Indices.size(), 3u);
+
+			std::remove(FilePath.c_str());
+		}
+
+		TEST(ParseSceneKeepsMeshesAndMaterials)
+		{
+			const std::string FilePath = "ParseSceneKeepsMeshesAndMaterials.obj";
+			WriteObjScene(FilePath);
+
+			FMeshParser MeshParser;
+			const auto ImportedScene = MeshParser.ParseScene(FilePath);
+			std::remove(FilePath.c_str());
+			std::remove("ParseSceneKeepsMeshesAndMaterials.mtl");
+
+			CHECK_EQUAL(ImportedScene->SubmeshesData.size(), 2u);
+
+			// Submeshes are named by their nodes' paths
+			for (const auto& SubmeshData : ImportedScene->SubmeshesData)
+			{
+				const bool bBox = SubmeshData->Name.find("Box") != std::string::npos;
+				CHECK(bBox || SubmeshData->Name.find("Roof") != std::string::npos);
+				CHECK_EQUAL(SubmeshData->Indices.size(), bBox ? 6u : 3u);
+
+				CHECK(SubmeshData->MaterialIndex < ImportedScene->MaterialsNames.size());
+				CHECK_EQUAL(ImportedScene->MaterialsNames[SubmeshData->MaterialIndex], std::string(bBox ? "red" : "blue"));
+			}
+		}
+
+		TEST(ParseObjFileMergesAllMeshes)
+		{
+			const std::string FilePath = "ParseObjFileMergesAllMeshes.obj";
+			WriteObjScene(FilePath);
+
+			FMeshParser MeshParser;
+			const auto MeshData = MeshParser.ParseObjFile(FilePath);
+			std::remove(FilePath.c_str());
+			std::remove("ParseObjFileMergesAllMeshes.mtl");
+
+			// Triangles of both objects, not of the first one only
+			CHECK_EQUAL(MeshData->Indices.size(), 9u);
+
+			auto MaxX = 0.0f;
+			for (const auto Index : MeshData->Indices)
+			{
+				CHECK(Index < MeshData->Vertices.size());
+				MaxX = std::max(MaxX, MeshData->Vertices[Index].Position.x);
+			}
+			CHECK_EQUAL(MaxX, 3.0f);
+		}
+
+		BENCHMARK(ParseSkullTxtData)
+		{
+			const auto FilePath = GetAssetsDirectory() + "Assets\\Models\\skull.txt";
+			const auto FileSizeMB =
+				static_cast<double>(std::ifstream(FilePath, std::ios::binary | std::ios::ate).tellg()) / (1024.0 * 1024.0);
+
+			FBenchTimer StreamTimer;
+			const auto ExpectedMeshData = ParseTxtDataWithStream(FilePath);
+			const auto StreamTime = StreamTimer.GetMilliseconds();
+
+			FBenchTimer Timer;
+			FMeshParser MeshParser;
+			const auto MeshData = MeshParser.ParseTxtData(FilePath);
+			const auto Time = Timer.GetMilliseconds();
+
+			CHECK(IsBitIdentical(*MeshData, *ExpectedMeshData));
+
+			BENCH_REPORT("skull.txt istream", StreamTime << " ms, " << FileSizeMB * 1000.0 / StreamTime << " MB/s");
+			BENCH_REPORT("skull.txt mapped", Time << " ms, " << FileSizeMB * 1000.0 / Time << " MB/s");
+		}
+
+		BENCHMARK(ParseGigabyteOfTxtData)
+		{
+			// A ~100 MB grid is parsed until 1 GB of text is read, so memory stays at one parsed mesh
+			const std::string FilePath = "ParseGigabyteOfTxtData.txt";
+			const uint32 NumVerticesPerSide = 1100;
+			const auto FileSize = WriteGridTxtFile(FilePath, NumVerticesPerSide);
+			const auto FileSizeMB = FileSize / (1024.0 * 1024.0);
+			const auto NumPasses = static_cast<uint32>((1ull << 30) / FileSize + 1);
+
+			FMeshParser MeshParser;
+			auto TotalTime = 0.0;
+			auto MinTime = DBL_MAX;
+			for (uint32 iPass = 0; iPass < NumPasses; ++iPass)
+			{
+				FBenchTimer Timer;
+				const auto MeshData = MeshParser.ParseTxtData(FilePath);
+				const auto Time = Timer.GetMilliseconds();
+
+				TotalTime += Time;
+				MinTime = std::min(MinTime, Time);
+				CHECK_EQUAL(MeshData->Vertices.size(), size_t(NumVerticesPerSide)*NumVerticesPerSide);
+			}
+			std::remove(FilePath.c_str());
+
+			BENCH_REPORT("Grid txt", FileSizeMB << " MB x " << NumPasses << " passes = " << FileSizeMB*NumPasses << " MB in " <<
+				TotalTime << " ms");
+			BENCH_REPORT("Throughput", FileSizeMB*NumPasses*1000.0 / TotalTime << " MB/s average, " <<
+				FileSizeMB*1000.0 / MinTime << " MB/s best pass");
+		}
+	}
+}
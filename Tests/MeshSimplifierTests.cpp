@@ -0,0 +1,196 @@
+#include "MeshSimplifier.h"
+#include "MeshWelder.h"
+#include "MeshTestUtils.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/** @brief Returns distance from the point to the segment
+			  * @param Point (FXMVECTOR)
+			  * @param A (FXMVECTOR)
+			  * @param B (FXMVECTOR)
+			  * @return (float)
+			  */
+			float GetPointSegmentDistance(FXMVECTOR Point, FXMVECTOR A, FXMVECTOR B)
+			{
+				const auto AB = XMVectorSubtract(B, A);
+				const auto LengthSq = XMVectorGetX(XMVector3Dot(AB, AB));
+				const auto T = LengthSq > 0.0f ?
+					std::min(std::max(XMVectorGetX(XMVector3Dot(XMVectorSubtract(Point, A), AB)) / LengthSq, 0.0f), 1.0f) : 0.0f;
+				return XMVectorGetX(XMVector3Length(XMVectorSubtract(Point, XMVectorAdd(A, XMVectorScale(AB, T)))));
+			}
+
+			/** @brief Returns distance from the point to the triangle: to its plane if the point projects inside it,
+			  * otherwise to its nearest edge
+			  * @param Point (FXMVECTOR)
+			  * @param P0 (FXMVECTOR)
+			  * @param P1 (FXMVECTOR)
+			  * @param P2 (GXMVECTOR)
+			  * @return (float)
+			  */
+			float GetPointTriangleDistance(FXMVECTOR Point, FXMVECTOR P0, FXMVECTOR P1, GXMVECTOR P2)
+			{
+				const auto Normal = XMVector3Cross(XMVectorSubtract(P1, P0), XMVectorSubtract(P2, P0));
+				const auto bIsInside =
+					XMVectorGetX(XMVector3Dot(XMVector3Cross(XMVectorSubtract(P1, P0), XMVectorSubtract(Point, P0)), Normal)) >= 0.0f &&
+					XMVectorGetX(XMVector3Dot(XMVector3Cross(XMVectorSubtract(P2, P1), XMVectorSubtract(Point, P1)), Normal)) >= 0.0f &&
+					XMVectorGetX(XMVector3Dot(XMVector3Cross(XMVectorSubtract(P0, P2), XMVectorSubtract(Point, P2)), Normal)) >= 0.0f;
+				if (bIsInside && XMVectorGetX(XMVector3LengthSq(Normal)) > 0.0f)
+				{
+					return std::abs(XMVectorGetX(XMVector3Dot(XMVector3Normalize(Normal), XMVectorSubtract(Point, P0))));
+				}
+
+				return std::min(GetPointSegmentDistance(Point, P0, P1),
+					std::min(GetPointSegmentDistance(Point, P1, P2), GetPointSegmentDistance(Point, P2, P0)));
+			}
+		}
+
+		TEST(SimplifyReachesTargetRatio)
+		{
+			FMeshGenerator MeshGenerator;
+			const auto MeshData = MeshGenerator.CreateGeoSphere(1.0f, 4);
+			const auto NumTriangles = MeshData->Indices.size() / 3;
+
+			FMeshSimplifier MeshSimplifier;
+			const auto SimplifiedMesh = MeshSimplifier.Simplify(*MeshData, 0.25f);
+			const auto NumSimplifiedTriangles = SimplifiedMesh->Indices.size() / 3;
+
+			CHECK(NumSimplifiedTriangles <= NumTriangles / 4);
+			CHECK(NumSimplifiedTriangles >= NumTriangles / 5);
+			CHECK(SimplifiedMesh->GeometricError > 0.0f);
+			CHECK(SimplifiedMesh->GeometricError < 0.05f);
+
+			// Vertices stay on the sphere since they're collapsed onto their neighbours
+			for (const auto& Vertex : SimplifiedMesh->Vertices)
+			{
+				CHECK_NEAR(XMVectorGetX(XMVector3Length(XMLoadFloat3(&Vertex.Position))), 1.0f, 1e-4f);
+			}
+		}
+
+		TEST(SimplifyMeasuresMaxDeviation)
+		{
+			FMeshGenerator MeshGenerator;
+			const auto MeshData = MeshGenerator.CreateGeoSphere(1.0f, 4);
+
+			FMeshSimplifier MeshSimplifier;
+			const auto SimplifiedMesh = MeshSimplifier.Simplify(*MeshData, 0.1f);
+
+			// Exact distance from every source vertex to the simplified surface
+			auto MaxDeviation = 0.0f;
+			for (const auto& SourceVertex : MeshData->Vertices)
+			{
+				const auto Position = XMLoadFloat3(&SourceVertex.Position);
+				auto Deviation = FLT_MAX;
+				for (std::size_t iIndex = 0; iIndex < SimplifiedMesh->Indices.size(); iIndex += 3)
+				{
+					Deviation = std::min(Deviation, GetPointTriangleDistance(Position,
+						XMLoadFloat3(&SimplifiedMesh->Vertices[SimplifiedMesh->Indices[iIndex]].Position),
+						XMLoadFloat3(&SimplifiedMesh->Vertices[SimplifiedMesh->Indices[iIndex + 1]].Position),
+						XMLoadFloat3(&SimplifiedMesh->Vertices[SimplifiedMesh->Indices[iIndex + 2]].Position)));
+				}
+
+				MaxDeviation = std::max(MaxDeviation, Deviation);
+			}
+
+			// GeometricError is conservative, but it stays close to the max deviation
+			CHECK(MaxDeviation > 0.0f);
+			CHECK(SimplifiedMesh->GeometricError >= MaxDeviation - 1e-5f);
+			CHECK(SimplifiedMesh->GeometricError < 2.0f * MaxDeviation);
+		}
+
+		TEST(SimplifyUnweldedMeshLikeWelded)
+		{
+			auto WeldedMesh = LoadSkullMesh();
+			FMeshWelder MeshWelder;
+			MeshWelder.Weld(WeldedMesh.get());
+
+			auto UnweldedMesh = std::make_unique<FMeshRawData>(*WeldedMesh);
+			UnweldVertices(UnweldedMesh.get());
+
+			FMeshSimplifier MeshSimplifier;
+			const auto WeldedLOD = MeshSimplifier.Simplify(*WeldedMesh, 0.25f);
+			const auto UnweldedLOD = MeshSimplifier.Simplify(*UnweldedMesh, 0.25f);
+
+			// Corners of the unwelded mesh are wedges of one vertex, so both meshes are simplified the same
+			CHECK(UnweldedLOD->Indices.size() <= WeldedMesh->Indices.size() / 4);
+			CHECK(UnweldedLOD->Indices == WeldedLOD->Indices);
+			CHECK_EQUAL(UnweldedLOD->Vertices.size(), WeldedLOD->Vertices.size());
+		}
+
+		TEST(SimplifyKeepsGridCorners)
+		{
+			FMeshGenerator MeshGenerator;
+			const auto MeshData = MeshGenerator.CreateGrid(10.0f, 10.0f, 20, 20);
+
+			FMeshSimplifier MeshSimplifier;
+			const auto SimplifiedMesh = MeshSimplifier.Simplify(*MeshData, 0.1f);
+
+			CHECK(SimplifiedMesh->Indices.size() < MeshData->Indices.size() / 5);
+
+			// Grid's vertices don't reach its +X/+Z sides, so the corners are the extremes of the source vertices
+			auto MinX = FLT_MAX, MaxX = -FLT_MAX, MinZ = FLT_MAX, MaxZ = -FLT_MAX;
+			for (const auto& Vertex : MeshData->Vertices)
+			{
+				MinX = std::min(MinX, Vertex.Position.x);
+				MaxX = std::max(MaxX, Vertex.Position.x);
+				MinZ = std::min(MinZ, Vertex.Position.z);
+				MaxZ = std::max(MaxZ, Vertex.Position.z);
+			}
+
+			auto NumCorners = 0;
+			for (const auto& Vertex : SimplifiedMesh->Vertices)
+			{
+				NumCorners += (Vertex.Position.x == MinX || Vertex.Position.x == MaxX) &&
+					(Vertex.Position.z == MinZ || Vertex.Position.z == MaxZ);
+			}
+			CHECK_EQUAL(NumCorners, 4);
+		}
+
+		TEST(SimplifyRejectsInvalidArguments)
+		{
+			FMeshGenerator MeshGenerator;
+			const auto MeshData = MeshGenerator.CreateBox(1.0f, 1.0f, 1.0f);
+			const auto PatchMeshData = MeshGenerator.CreateBezierGrid();
+
+			FMeshSimplifier MeshSimplifier;
+			CHECK_THROWS(MeshSimplifier.Simplify(*MeshData, 0.0f), std::invalid_argument);
+			CHECK_THROWS(MeshSimplifier.Simplify(*MeshData, 1.5f), std::invalid_argument);
+			CHECK_THROWS(MeshSimplifier.Simplify(*PatchMeshData, 0.5f), std::invalid_argument);
+		}
+
+		BENCHMARK(GenerateLODsOfSkull)
+		{
+			const std::vector<float> LODsRatios = { 0.5f, 0.25f, 0.1f };
+
+			auto WeldedMesh = LoadSkullMesh();
+			FMeshWelder MeshWelder;
+			MeshWelder.Weld(WeldedMesh.get());
+
+			auto UnweldedMesh = std::make_unique<FMeshRawData>(*WeldedMesh);
+			UnweldedMesh->Name = "skull (unwelded)";
+			UnweldVertices(UnweldedMesh.get());
+
+			FMeshSimplifier MeshSimplifier;
+			for (const auto* MeshData : { WeldedMesh.get(), UnweldedMesh.get() })
+			{
+				FBenchTimer Timer;
+				const auto LODs = MeshSimplifier.GenerateLODs(*MeshData, LODsRatios);
+				const auto Time = Timer.GetMilliseconds();
+
+				BENCH_REPORT(MeshData->Name, MeshData->Indices.size() / 3 << " triangles, LODs in " << Time << " ms");
+				for (std::size_t iLOD = 0; iLOD < LODs.size(); ++iLOD)
+				{
+					const auto NumTriangles = LODs[iLOD]->Indices.size() / 3;
+					CHECK(NumTriangles <= MeshData->Indices.size() / 3 * LODsRatios[iLOD] + 1);
+
+					BENCH_REPORT("  " << LODs[iLOD]->Name, NumTriangles << " triangles (" <<
+						100.0 * NumTriangles / (MeshData->Indices.size() / 3) << "%), geometric error " <<
+						LODs[iLOD]->GeometricError);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "MeshData.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		using FTrianglePositions = std::array<std::tuple<float, float, float>, 3>;
+
+		/** @brief Shuffles order of the mesh's triangles, so meshes of generators lose their cache locality
+		  * @param MeshData (FMeshRawData *)
+		  * @param Seed (uint32)
+		  * @return (void)
+		  */
+		inline void ShuffleTriangles(FMeshRawData* MeshData, uint32 Seed = 1)
+		{
+			const auto NumTriangles = MeshData->Indices.size() / 3;
+			std::vector<uint32> TrianglesOrder(NumTriangles);
+			for (uint32 iTriangle = 0; iTriangle < NumTriangles; ++iTriangle)
+			{
+				TrianglesOrder[iTriangle] = iTriangle;
+			}
+
+			std::mt19937 Random(Seed);
+			std::shuffle(TrianglesOrder.begin(), TrianglesOrder.end(), Random);
+
+			std::vector<uint32> Indices(MeshData->Indices.size());
+			for (std::size_t iTriangle = 0; iTriangle < NumTriangles; ++iTriangle)
+			{
+				std::copy_n(&MeshData->Indices[TrianglesOrder[iTriangle] * 3], 3, &Indices[iTriangle * 3]);
+			}
+
+			MeshData->Indices = std::move(Indices);
+		}
+
+		/** @brief Triangles of the mesh as positions of their vertices. Every triangle starts with its least
+		  * vertex keeping the winding, and triangles are sorted, so meshes are compared regardless of orders
+		  * @param MeshData (const FMeshRawData &)
+		  * @return (std::vector<FTrianglePositions>)
+		  */
+		inline std::vector<FTrianglePositions> GetSortedTriangles(const FMeshRawData& MeshData)
+		{
+			std::vector<FTrianglePositions> Triangles(MeshData.Indices.size() / 3);
+			for (std::size_t iTriangle = 0; iTriangle < Triangles.size(); ++iTriangle)
+			{
+				auto& Triangle = Triangles[iTriangle];
+				for (auto iCorner = 0; iCorner < 3; ++iCorner)
+				{
+					const auto& Position = MeshData.Vertices[MeshData.Indices[iTriangle * 3 + iCorner]].Position;
+					Triangle[iCorner] = std::make_tuple(Position.x, Position.y, Position.z);
+				}
+
+				std::rotate(Triangle.begin(), std::min_element(Triangle.begin(), Triangle.end()), Triangle.end());
+			}
+
+			std::sort(Triangles.begin(), Triangles.end());
+			return Triangles;
+		}
+
+		/** @brief Gives every corner of every triangle its own vertex, as parsers of OBJ files do
+		  * @param MeshData (FMeshRawData *)
+		  * @return (void)
+		  */
+		inline void UnweldVertices(FMeshRawData* MeshData)
+		{
+			std::vector<FVertex> Vertices;
+			Vertices.reserve(MeshData->Indices.size());
+			for (auto& Index : MeshData->Indices)
+			{
+				Vertices.push_back(MeshData->Vertices[Index]);
+				Index = static_cast<uint32>(Vertices.size() - 1);
+			}
+
+			MeshData->Vertices = std::move(Vertices);
+		}
+
+		/** @brief Writes an OBJ scene of two objects with their own materials:
+		  * "Box" is a quad of material "red", "Roof" is a triangle of material "blue" at X in [2, 3]
+		  * @param FilePath Path to .obj file. The .mtl file is written next to it (const std::string &)
+		  * @return (void)
+		  */
+		inline void WriteObjScene(const std::string& FilePath)
+		{
+			const auto MaterialsFilePath = FilePath.substr(0, FilePath.find_last_of('.')) + ".mtl";
+			const auto MaterialsFileName = MaterialsFilePath.substr(MaterialsFilePath.find_last_of("\\/") + 1);
+
+			std::ofstream MaterialsFile(MaterialsFilePath);
+			MaterialsFile << "newmtl red\nKd 1 0 0\n\nnewmtl blue\nKd 0 0 1\n";
+
+			std::ofstream File(FilePath);
+			File << "mtllib " << MaterialsFileName << "\n"
+				"o Box\n"
+				"v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+				"vn 0 0 1\n"
+				"usemtl red\n"
+				"f 1//1 2//1 3//1 4//1\n"
+				"o Roof\n"
+				"v 2 0 0\nv 3 0 0\nv 2.5 1 0\n"
+				"usemtl blue\n"
+				"f 5//1 6//1 7//1\n";
+		}
+
+		/** @brief Loads the skull model of the engine's assets
+		  * @return (std::unique_ptr<WoodenEngine::FMeshRawData>)
+		  */
+		inline std::unique_ptr<FMeshRawData> LoadSkullMesh()
+		{
+			FMeshParser MeshParser;
+			auto MeshData = MeshParser.ParseTxtData(GetAssetsDirectory() + "Assets\\Models\\skull.txt");
+			MeshData->Name = "skull";
+			return MeshData;
+		}
+	}
+}
@@ -0,0 +1,103 @@
+#include "MeshWelder.h"
+#include "MeshTestUtils.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			// Box with every corner unwelded: 36 vertices of 24 distinct ones (4 per face)
+			std::unique_ptr<FMeshRawData> CreateDuplicatedBox(float Scale)
+			{
+				FMeshGenerator MeshGenerator;
+				auto MeshData = MeshGenerator.CreateBox(Scale, Scale, Scale);
+
+				UnweldVertices(MeshData.get());
+				return MeshData;
+			}
+		}
+
+		TEST(WeldMergesDuplicatedVertices)
+		{
+			auto MeshData = CreateDuplicatedBox(1.0f);
+			const auto SourceTriangles = GetSortedTriangles(*MeshData);
+
+			FMeshWelder MeshWelder;
+			const auto Stats = MeshWelder.Weld(MeshData.get());
+
+			CHECK_EQUAL(Stats.NumVerticesBefore, 36u);
+			CHECK_EQUAL(Stats.NumVerticesAfter, 24u);
+			CHECK_EQUAL(MeshData->Vertices.size(), 24u);
+			CHECK_EQUAL(Stats.NumBytesSaved, 12u * sizeof(SVertexData));
+			CHECK(GetSortedTriangles(*MeshData) == SourceTriangles);
+		}
+
+		TEST(WeldKeepsVerticesApartByEpsilon)
+		{
+			FMeshRawData MeshData;
+			MeshData.Vertices.emplace_back(XMFLOAT3(0.0f, 0.0f, 0.0f));
+			MeshData.Vertices.emplace_back(XMFLOAT3(1e-7f, 0.0f, 0.0f));
+			MeshData.Vertices.emplace_back(XMFLOAT3(1e-3f, 0.0f, 0.0f));
+			MeshData.Indices = { 0, 1, 2 };
+
+			FMeshWelder MeshWelder;
+			MeshWelder.Weld(&MeshData);
+
+			CHECK_EQUAL(MeshData.Vertices.size(), 2u);
+			CHECK((MeshData.Indices == std::vector<uint32>{ 0, 0, 1 }));
+
+			FWeldSettings Settings;
+			Settings.PositionEpsilon = 1e-2f;
+			MeshWelder.Weld(&MeshData, Settings);
+
+			CHECK_EQUAL(MeshData.Vertices.size(), 1u);
+		}
+
+		TEST(WeldHandlesLargeCoordinates)
+		{
+			// Cells of 1e5 units at epsilon 1e-5 don't fit into int32
+			auto MeshData = CreateDuplicatedBox(2e5f);
+			const auto SourceTriangles = GetSortedTriangles(*MeshData);
+
+			FMeshWelder MeshWelder;
+			MeshWelder.Weld(MeshData.get());
+
+			CHECK_EQUAL(MeshData->Vertices.size(), 24u);
+			CHECK(GetSortedTriangles(*MeshData) == SourceTriangles);
+
+			// Positions, which differ by one float step far from the origin, stay apart
+			FMeshRawData FarMeshData;
+			FarMeshData.Vertices.emplace_back(XMFLOAT3(1e5f, 0.0f, 0.0f));
+			FarMeshData.Vertices.emplace_back(XMFLOAT3(-1e5f, 0.0f, 0.0f));
+			FarMeshData.Vertices.emplace_back(XMFLOAT3(1e5f + 0.0078125f, 0.0f, 0.0f));
+			FarMeshData.Indices = { 0, 1, 2 };
+			MeshWelder.Weld(&FarMeshData);
+
+			CHECK_EQUAL(FarMeshData.Vertices.size(), 3u);
+		}
+
+		BENCHMARK(WeldSkullAndGeneratedMeshes)
+		{
+			FMeshGenerator MeshGenerator;
+
+			std::vector<std::unique_ptr<FMeshRawData>> MeshesData;
+			MeshesData.push_back(LoadSkullMesh());
+			MeshesData.push_back(MeshGenerator.CreateGeoSphere(1.0f, 6));
+			MeshesData.back()->Name = "geosphere";
+			MeshesData.push_back(CreateDuplicatedBox(1.0f));
+			MeshesData.back()->Name = "box (unwelded)";
+
+			FMeshWelder MeshWelder;
+			for (auto& MeshData : MeshesData)
+			{
+				FBenchTimer Timer;
+				const auto Stats = MeshWelder.Weld(MeshData.get());
+				const auto Time = Timer.GetMilliseconds();
+
+				BENCH_REPORT(MeshData->Name, Stats.NumVerticesBefore << " -> " << Stats.NumVerticesAfter <<
+					" vertices, " << Stats.NumBytesSaved << " bytes saved in " << Time << " ms");
+			}
+		}
+	}
+}
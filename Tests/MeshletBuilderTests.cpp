@@ -0,0 +1,221 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <set>
+
+#include "MeshletBuilder.h"
+#include "MeshOptimizer.h"
+#include "MeshWelder.h"
+#include "MeshTestUtils.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			// Checks limits, coverage and bounds of the meshlets built of the mesh
+			void CheckMeshlets(const std::vector<FMeshlet>& Meshlets, const FMeshRawData& MeshData)
+			{
+				uint32 NextIndexBegin = 0;
+				for (const auto& Meshlet : Meshlets)
+				{
+					CHECK_EQUAL(Meshlet.IndexBegin, NextIndexBegin);
+					CHECK(Meshlet.NumTriangles > 0 && Meshlet.NumTriangles <= FMeshletBuilder::MaxNumTriangles);
+					NextIndexBegin += Meshlet.NumTriangles * 3;
+
+					std::set<uint32> Vertices(
+						MeshData.Indices.cbegin() + Meshlet.IndexBegin,
+						MeshData.Indices.cbegin() + Meshlet.IndexBegin + Meshlet.NumTriangles * 3);
+					CHECK_EQUAL(Meshlet.NumVertices, Vertices.size());
+					CHECK(Meshlet.NumVertices <= FMeshletBuilder::MaxNumVertices);
+
+					const auto Center = XMLoadFloat3(&Meshlet.BoundingSphereCenter);
+					for (auto iVertex : Vertices)
+					{
+						const auto Position = XMLoadFloat3(&MeshData.Vertices[iVertex].Position);
+						const auto Distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(Position, Center)));
+						CHECK(Distance <= Meshlet.BoundingSphereRadius*1.0001f + 1e-5f);
+					}
+				}
+
+				CHECK_EQUAL(NextIndexBegin, MeshData.Indices.size());
+			}
+
+			// Returns triangles of every meshlet regardless of their order
+			std::vector<std::multiset<std::array<uint32, 3>>> GetMeshletsTriangles(
+				const std::vector<FMeshlet>& Meshlets,
+				const FMeshRawData& MeshData)
+			{
+				std::vector<std::multiset<std::array<uint32, 3>>> MeshletsTriangles;
+				for (const auto& Meshlet : Meshlets)
+				{
+					MeshletsTriangles.emplace_back();
+					for (auto iIndex = Meshlet.IndexBegin; iIndex < Meshlet.IndexBegin + Meshlet.NumTriangles * 3; iIndex += 3)
+					{
+						std::array<uint32, 3> Triangle = {
+							MeshData.Indices[iIndex], MeshData.Indices[iIndex + 1], MeshData.Indices[iIndex + 2] };
+
+						// Winding is kept, so the triangle is rotated to start with its least index
+						std::rotate(Triangle.begin(), std::min_element(Triangle.begin(), Triangle.end()), Triangle.end());
+						MeshletsTriangles.back().insert(Triangle);
+					}
+				}
+				return MeshletsTriangles;
+			}
+
+			// Returns vertices transformed by draws of single meshlets, which begin with empty caches
+			uint64 GetNumMeshletsTransformedVertices(
+				const FMeshOptimizer& MeshOptimizer,
+				const std::vector<FMeshlet>& Meshlets,
+				const FMeshRawData& MeshData)
+			{
+				FMeshRawData MeshletData;
+				MeshletData.Vertices = MeshData.Vertices;
+
+				uint64 NumTransformedVertices = 0;
+				for (const auto& Meshlet : Meshlets)
+				{
+					MeshletData.Indices.assign(MeshData.Indices.cbegin() + Meshlet.IndexBegin,
+						MeshData.Indices.cbegin() + Meshlet.IndexBegin + Meshlet.NumTriangles * 3);
+					NumTransformedVertices += MeshOptimizer.AnalyzeVertexCache(MeshletData).NumTransformedVertices;
+				}
+				return NumTransformedVertices;
+			}
+		}
+
+		TEST(MeshletsCoverMeshWithinLimits)
+		{
+			FMeshGenerator MeshGenerator;
+			auto MeshData = MeshGenerator.CreateGeoSphere(1.0f, 4);
+			ShuffleTriangles(MeshData.get());
+			const auto SourceTriangles = GetSortedTriangles(*MeshData);
+
+			FMeshletBuilder MeshletBuilder;
+			const auto Meshlets = MeshletBuilder.Build(MeshData.get());
+
+			CHECK(!Meshlets.empty());
+			CHECK(GetSortedTriangles(*MeshData) == SourceTriangles);
+			CheckMeshlets(Meshlets, *MeshData);
+		}
+
+		TEST(MeshletsAreDeterministic)
+		{
+			FMeshGenerator MeshGenerator;
+			auto MeshData0 = MeshGenerator.CreateLandscapeGrid(20.0f, 20.0f, 50, 50);
+			ShuffleTriangles(MeshData0.get(), 7);
+			auto MeshData1 = std::make_unique<FMeshRawData>(*MeshData0);
+
+			FMeshletBuilder MeshletBuilder;
+			const auto Meshlets0 = MeshletBuilder.Build(MeshData0.get());
+			const auto Meshlets1 = MeshletBuilder.Build(MeshData1.get());
+
+			CHECK(MeshData0->Indices == MeshData1->Indices);
+			CHECK_EQUAL(Meshlets0.size(), Meshlets1.size());
+			CHECK(std::equal(Meshlets0.cbegin(), Meshlets0.cend(), Meshlets1.cbegin(), Meshlets1.cend(),
+				[](const FMeshlet& Meshlet0, const FMeshlet& Meshlet1)
+			{
+				return std::memcmp(&Meshlet0, &Meshlet1, sizeof(FMeshlet)) == 0;
+			}));
+		}
+
+		TEST(MeshletOfFlatGridIsBackfacingFromBehind)
+		{
+			FMeshGenerator MeshGenerator;
+			auto MeshData = MeshGenerator.CreateGrid(1.0f, 1.0f, 4, 4);
+
+			FMeshletBuilder MeshletBuilder;
+			const auto Meshlets = MeshletBuilder.Build(MeshData.get());
+
+			CHECK_EQUAL(Meshlets.size(), 1u);
+			CheckMeshlets(Meshlets, *MeshData);
+
+			const auto& Meshlet = Meshlets[0];
+			const auto Axis = XMLoadFloat3(&Meshlet.ConeAxis);
+			CHECK_NEAR(std::fabs(Meshlet.ConeAxis.y), 1.0f, 1e-4f);
+
+			const auto Front = XMVectorScale(Axis, 10.0f);
+			CHECK(!FMeshletBuilder::IsBackfacing(Meshlet, Front));
+			CHECK(FMeshletBuilder::IsBackfacing(Meshlet, XMVectorNegate(Front)));
+		}
+
+		TEST(MeshletsAreOptimizedForVertexCache)
+		{
+			FMeshGenerator MeshGenerator;
+			auto MeshData = MeshGenerator.CreateGeoSphere(1.0f, 4);
+			ShuffleTriangles(MeshData.get());
+
+			FMeshOptimizer MeshOptimizer;
+			FMeshletBuilder MeshletBuilder;
+			MeshOptimizer.Optimize(MeshData.get());
+			const auto Meshlets = MeshletBuilder.Build(MeshData.get());
+			const auto MeshletsTriangles = GetMeshletsTriangles(Meshlets, *MeshData);
+			const auto NumBuiltTransformedVertices = GetNumMeshletsTransformedVertices(MeshOptimizer, Meshlets, *MeshData);
+
+			// Triangles are reordered inside their meshlets only, and draws of meshlets miss the cache less
+			MeshOptimizer.OptimizeMeshletsVertexCache(MeshData.get(), Meshlets);
+			CHECK(GetMeshletsTriangles(Meshlets, *MeshData) == MeshletsTriangles);
+			CheckMeshlets(Meshlets, *MeshData);
+			CHECK(GetNumMeshletsTransformedVertices(MeshOptimizer, Meshlets, *MeshData) < NumBuiltTransformedVertices);
+		}
+
+		TEST(MeshletsOfEmptyMesh)
+		{
+			FMeshRawData MeshData;
+
+			FMeshletBuilder MeshletBuilder;
+			CHECK(MeshletBuilder.Build(&MeshData).empty());
+		}
+
+		BENCHMARK(BuildMeshletsOfSkullAndGeneratedMeshes)
+		{
+			FMeshGenerator MeshGenerator;
+
+			std::vector<std::unique_ptr<FMeshRawData>> MeshesData;
+			MeshesData.push_back(LoadSkullMesh());
+			MeshesData.push_back(MeshGenerator.CreateLandscapeGrid(40.0f, 40.0f, 160, 160));
+			MeshesData.back()->Name = "landscape";
+			MeshesData.push_back(MeshGenerator.CreateGeoSphere(1.0f, 6));
+			MeshesData.back()->Name = "geosphere";
+
+			FMeshWelder MeshWelder;
+			FMeshOptimizer MeshOptimizer;
+			FMeshletBuilder MeshletBuilder;
+			for (auto& MeshData : MeshesData)
+			{
+				MeshWelder.Weld(MeshData.get());
+
+				// As FMeshBaker does: meshlets are built of the optimized order and optimized inside
+				const auto OptimizedStats = MeshOptimizer.Optimize(MeshData.get());
+
+				FBenchTimer Timer;
+				const auto Meshlets = MeshletBuilder.Build(MeshData.get());
+				const auto Time = Timer.GetMilliseconds();
+				const auto BuiltStats = MeshOptimizer.AnalyzeVertexCache(*MeshData);
+				const auto NumBuiltTransformedVertices = GetNumMeshletsTransformedVertices(MeshOptimizer, Meshlets, *MeshData);
+
+				MeshOptimizer.OptimizeMeshletsVertexCache(MeshData.get(), Meshlets);
+				const auto FinalStats = MeshOptimizer.AnalyzeVertexCache(*MeshData);
+				const auto NumFinalTransformedVertices = GetNumMeshletsTransformedVertices(MeshOptimizer, Meshlets, *MeshData);
+				const auto NumTriangles = static_cast<double>(MeshData->Indices.size() / 3);
+
+				CheckMeshlets(Meshlets, *MeshData);
+
+				uint64 NumMeshletsVertices = 0;
+				uint64 NumMeshletsTriangles = 0;
+				for (const auto& Meshlet : Meshlets)
+				{
+					NumMeshletsVertices += Meshlet.NumVertices;
+					NumMeshletsTriangles += Meshlet.NumTriangles;
+				}
+
+				BENCH_REPORT(MeshData->Name, Meshlets.size() << " meshlets, " <<
+					static_cast<double>(NumMeshletsVertices) / Meshlets.size() << " vertices and " <<
+					static_cast<double>(NumMeshletsTriangles) / Meshlets.size() << " triangles per meshlet in " <<
+					Time << " ms, ACMR " << OptimizedStats.After.ACMR << " optimized -> " << BuiltStats.ACMR <<
+					" built -> " << FinalStats.ACMR << " final, ACMR of single meshlets' draws " <<
+					NumBuiltTransformedVertices / NumTriangles << " -> " << NumFinalTransformedVertices / NumTriangles);
+			}
+		}
+	}
+}
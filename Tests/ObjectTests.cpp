@@ -0,0 +1,152 @@
+#include <memory>
+#include <unordered_map>
+
+#include "Object.h"
+#include "SubmeshRegistry.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			const uint32 NumMeshes = 16;
+			const uint32 NumSubmeshesPerMesh = 8;
+
+			std::string GetMeshName(uint32 iMesh)
+			{
+				return "mesh" + std::to_string(iMesh);
+			}
+
+			std::string GetSubmeshName(uint32 iSubmesh)
+			{
+				return "submesh" + std::to_string(iSubmesh);
+			}
+
+			/** @brief Creates data of a mesh with NumSubmeshesPerMesh submeshes
+			  * @param iMesh (uint32)
+			  * @return (WoodenEngine::FMeshData)
+			  */
+			FMeshData CreateMeshData(uint32 iMesh)
+			{
+				FMeshData MeshData(GetMeshName(iMesh));
+				for (uint32 iSubmesh = 0; iSubmesh < NumSubmeshesPerMesh; ++iSubmesh)
+				{
+					auto SubmeshData = std::make_unique<FSubmeshData>(GetSubmeshName(iSubmesh));
+					SubmeshData->IndexBegin = iSubmesh * 3;
+					SubmeshData->NumIndices = 3;
+					XMStoreFloat4x4(&SubmeshData->Transform, XMMatrixTranslation(float(iSubmesh), float(iMesh), 0.0f));
+					MeshData.SubmeshesData[SubmeshData->Name] = std::move(SubmeshData);
+				}
+				return MeshData;
+			}
+
+			/** @brief Sums what a draw reads of the submesh, so the walk isn't optimized away
+			  * @param SubmeshData (const FSubmeshData &)
+			  * @param WorldTransform (const XMMATRIX &)
+			  * @return (float)
+			  */
+			float GetDrawChecksum(const FSubmeshData& SubmeshData, const XMMATRIX& WorldTransform)
+			{
+				XMFLOAT4X4 Transform;
+				XMStoreFloat4x4(&Transform, WorldTransform);
+				return Transform(3, 0) + Transform(3, 1) + Transform(3, 2) + SubmeshData.IndexBegin;
+			}
+		}
+
+		BENCHMARK(DrawWalkWith100kObjects)
+		{
+			const uint32 NumObjects = 100000;
+
+			// Meshes and interned submeshes as FGameResource keeps them: submeshes are interned before
+			// their meshes are uploaded, and their slots are resolved by the uploads
+			FResourcePool<FMeshData> MeshesData;
+			std::unordered_map<std::string, FMeshHandle> MeshesHandles;
+			const std::unordered_map<std::string, FMaterialHandle> MaterialsHandles;
+			FSubmeshRegistry SubmeshRegistry;
+			for (uint32 iMesh = 0; iMesh < NumMeshes; ++iMesh)
+			{
+				for (uint32 iSubmesh = 0; iSubmesh < NumSubmeshesPerMesh; ++iSubmesh)
+				{
+					SubmeshRegistry.AddHandle(GetMeshName(iMesh), GetSubmeshName(iSubmesh));
+				}
+			}
+
+			for (uint32 iMesh = 0; iMesh < NumMeshes; ++iMesh)
+			{
+				const auto MeshHandle = MeshesData.Create(CreateMeshData(iMesh));
+				MeshesHandles[GetMeshName(iMesh)] = MeshHandle;
+				SubmeshRegistry.ResolveMesh(MeshHandle, MeshesData.Get(MeshHandle), MaterialsHandles);
+			}
+			CHECK_EQUAL(SubmeshRegistry.GetNumSlots(), NumMeshes * NumSubmeshesPerMesh);
+
+			// Objects kept mesh and submesh names before submeshes were interned
+			std::vector<std::unique_ptr<WObject>> Objects;
+			std::vector<std::pair<std::string, std::string>> ObjectsNames;
+			for (uint32 iObject = 0; iObject < NumObjects; ++iObject)
+			{
+				const auto iSlot = (iObject * 7919) % (NumMeshes * NumSubmeshesPerMesh);
+				const auto MeshName = GetMeshName(iSlot / NumSubmeshesPerMesh);
+				const auto SubmeshName = GetSubmeshName(iSlot % NumSubmeshesPerMesh);
+				Objects.push_back(std::make_unique<WObject>(
+					SubmeshRegistry.FindHandle(MeshName, SubmeshName), XMFLOAT3(float(iObject), 0.0f, 0.0f)));
+				ObjectsNames.emplace_back(MeshName, SubmeshName);
+			}
+
+			const auto NumRuns = 10;
+
+			// As RenderObjects did: the mesh and its submesh are found by names for every draw
+			auto NamesChecksum = 0.0;
+			auto NamesTime = 1e9;
+			for (auto iRun = 0; iRun < NumRuns; ++iRun)
+			{
+				NamesChecksum = 0.0;
+				FBenchTimer Timer;
+				for (uint32 iObject = 0; iObject < NumObjects; ++iObject)
+				{
+					const auto& Object = *Objects[iObject];
+					const auto& MeshData = MeshesData.Get(MeshesHandles.at(ObjectsNames[iObject].first));
+					const auto& SubmeshData = *MeshData.SubmeshesData.at(ObjectsNames[iObject].second);
+					const auto WorldTransform = XMMatrixMultiply(XMLoadFloat4x4(&SubmeshData.Transform), Object.GetWorldTransform());
+					NamesChecksum += GetDrawChecksum(SubmeshData, WorldTransform);
+				}
+				NamesTime = std::min(NamesTime, Timer.GetMilliseconds());
+			}
+
+			// As RenderObjects does: FGameResource's IsSubmeshReady, GetMeshData and GetSubmeshData of objects' handles
+			auto HandlesChecksum = 0.0;
+			auto HandlesTime = 1e9;
+			for (auto iRun = 0; iRun < NumRuns; ++iRun)
+			{
+				HandlesChecksum = 0.0;
+				FBenchTimer Timer;
+				for (const auto& Object : Objects)
+				{
+					const auto SubmeshHandle = Object->GetSubmeshHandle();
+					if (!SubmeshRegistry.IsReady(SubmeshHandle))
+					{
+						continue;
+					}
+
+					const auto& SubmeshSlot = SubmeshRegistry.GetSlot(SubmeshHandle);
+					const auto MeshData = MeshesData.Find(SubmeshSlot.MeshHandle);
+					if (MeshData == nullptr)
+					{
+						continue;
+					}
+
+					const auto& SubmeshData = *SubmeshSlot.SubmeshData;
+					const auto WorldTransform = XMMatrixMultiply(XMLoadFloat4x4(&SubmeshData.Transform), Object->GetWorldTransform());
+					HandlesChecksum += GetDrawChecksum(SubmeshData, WorldTransform);
+				}
+				HandlesTime = std::min(HandlesTime, Timer.GetMilliseconds());
+			}
+
+			CHECK_EQUAL(HandlesChecksum, NamesChecksum);
+
+			BENCH_REPORT("names", NumObjects << " objects, " << NamesTime << " ms");
+			BENCH_REPORT("handles", NumObjects << " objects, " << HandlesTime << " ms, " << NamesTime / HandlesTime << "x faster");
+		}
+	}
+}
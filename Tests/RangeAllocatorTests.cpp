@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <iterator>
+#include <random>
+
+#include "RangeAllocator.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/** @brief Returns true if current ranges of the allocations are in the resource and don't overlap
+			  * @param RangeAllocator (const FRangeAllocator &)
+			  * @param Allocations (const std::vector<FRangeAllocation> &)
+			  * @return (bool)
+			  */
+			bool AreRangesDisjoint(const FRangeAllocator& RangeAllocator, const std::vector<FRangeAllocation>& Allocations)
+			{
+				std::vector<std::pair<uint32, uint32>> Ranges;
+				for (const auto& Allocation : Allocations)
+				{
+					Ranges.emplace_back(RangeAllocator.GetOffset(Allocation), Allocation.Size);
+				}
+				std::sort(Ranges.begin(), Ranges.end());
+
+				uint64 End = 0;
+				for (const auto& Range : Ranges)
+				{
+					if (Range.first < End)
+					{
+						return false;
+					}
+					End = uint64(Range.first) + Range.second;
+				}
+				return End <= RangeAllocator.GetSize();
+			}
+		}
+
+		TEST(RangeAllocatorMergesFreedRanges)
+		{
+			FRangeAllocator RangeAllocator(1000);
+			const auto First = RangeAllocator.Allocate(100);
+			const auto Second = RangeAllocator.Allocate(200);
+			const auto Third = RangeAllocator.Allocate(300);
+
+			CHECK(First.IsValid() && Second.IsValid() && Third.IsValid());
+			CHECK_EQUAL(First.Offset, 0u);
+			CHECK_EQUAL(Second.Offset, 100u);
+			CHECK_EQUAL(Third.Offset, 300u);
+			CHECK_EQUAL(RangeAllocator.GetUsedSize(), 600u);
+			CHECK_EQUAL(RangeAllocator.GetNumAllocations(), 3u);
+
+			RangeAllocator.Free(Second);
+			CHECK_EQUAL(RangeAllocator.GetStats().NumFreeRanges, 2u);
+			CHECK_EQUAL(RangeAllocator.GetStats().LargestFreeRange, 400u);
+			CHECK_NEAR(RangeAllocator.GetStats().GetFragmentation(), 1.0f - 400.0f / 600.0f, 1e-5f);
+
+			// The freed range is reused by an allocation which fits it
+			const auto Reused = RangeAllocator.Allocate(150);
+			CHECK_EQUAL(Reused.Offset, 100u);
+			RangeAllocator.Free(Reused);
+
+			// Neighbours of the freed range are merged with it
+			RangeAllocator.Free(First);
+			CHECK_EQUAL(RangeAllocator.GetStats().NumFreeRanges, 2u);
+			CHECK_EQUAL(RangeAllocator.GetStats().LargestFreeRange, 400u);
+
+			RangeAllocator.Free(Third);
+			CHECK(RangeAllocator.IsEmpty());
+			CHECK_EQUAL(RangeAllocator.GetStats().NumFreeRanges, 1u);
+			CHECK_EQUAL(RangeAllocator.GetStats().LargestFreeRange, 1000u);
+			CHECK_EQUAL(RangeAllocator.GetStats().GetFragmentation(), 0.0f);
+
+			// The whole resource is allocated by one range
+			const auto Whole = RangeAllocator.Allocate(1000);
+			CHECK(Whole.IsValid());
+			CHECK(!RangeAllocator.Allocate(1).IsValid());
+		}
+
+		TEST(RangeAllocatorRejectsInvalidCalls)
+		{
+			CHECK_THROWS(FRangeAllocator(0), std::invalid_argument);
+
+			FRangeAllocator RangeAllocator(64);
+			CHECK_THROWS(RangeAllocator.Allocate(0), std::invalid_argument);
+			CHECK(!RangeAllocator.Allocate(65).IsValid());
+			CHECK_THROWS(RangeAllocator.Free(FRangeAllocation()), std::invalid_argument);
+
+			const auto Allocation = RangeAllocator.Allocate(16);
+			RangeAllocator.Free(Allocation);
+			CHECK_THROWS(RangeAllocator.Free(Allocation), std::invalid_argument);
+			CHECK_THROWS(RangeAllocator.GetOffset(Allocation), std::invalid_argument);
+		}
+
+		TEST(RangeAllocatorCompactsRanges)
+		{
+			FRangeAllocator RangeAllocator(1024);
+			std::vector<FRangeAllocation> Allocations;
+			for (uint32 iAllocation = 0; iAllocation < 8; ++iAllocation)
+			{
+				Allocations.push_back(RangeAllocator.Allocate(16 + iAllocation * 8));
+			}
+
+			// Every second range is freed, so the free space is fragmented
+			std::vector<FRangeAllocation> KeptAllocations;
+			for (uint32 iAllocation = 0; iAllocation < Allocations.size(); ++iAllocation)
+			{
+				if (iAllocation % 2 == 0)
+				{
+					RangeAllocator.Free(Allocations[iAllocation]);
+				}
+				else
+				{
+					KeptAllocations.push_back(Allocations[iAllocation]);
+				}
+			}
+			CHECK(RangeAllocator.GetStats().GetFragmentation() > 0.0f);
+
+			const auto Moves = RangeAllocator.Compact();
+			CHECK_EQUAL(Moves.size(), KeptAllocations.size());
+			for (const auto& Move : Moves)
+			{
+				CHECK(Move.DestinationOffset < Move.SourceOffset);
+			}
+
+			// Ranges keep their order and follow each other from the start
+			uint32 Offset = 0;
+			for (const auto& Allocation : KeptAllocations)
+			{
+				CHECK_EQUAL(RangeAllocator.GetOffset(Allocation), Offset);
+				Offset += Allocation.Size;
+			}
+			CHECK_EQUAL(RangeAllocator.GetStats().NumFreeRanges, 1u);
+			CHECK_EQUAL(RangeAllocator.GetStats().LargestFreeRange, 1024u - Offset);
+
+			// Allocations are freed with their blocks after moves
+			for (const auto& Allocation : KeptAllocations)
+			{
+				RangeAllocator.Free(Allocation);
+			}
+			CHECK(RangeAllocator.IsEmpty());
+			CHECK_EQUAL(RangeAllocator.GetStats().LargestFreeRange, 1024u);
+		}
+
+		TEST(RangeAllocatorKeepsRangesDisjoint)
+		{
+			const uint32 Size = 1 << 20;
+			FRangeAllocator RangeAllocator(Size);
+			std::vector<FRangeAllocation> Allocations;
+			uint64 UsedSize = 0;
+
+			std::mt19937 Random(22);
+			for (auto iStep = 0; iStep < 5000; ++iStep)
+			{
+				if (!Allocations.empty() && Random() % 3 == 0)
+				{
+					const auto iAllocation = Random() % Allocations.size();
+					UsedSize -= Allocations[iAllocation].Size;
+					RangeAllocator.Free(Allocations[iAllocation]);
+					Allocations[iAllocation] = Allocations.back();
+					Allocations.pop_back();
+				}
+				else
+				{
+					const auto Allocation = RangeAllocator.Allocate(1 + Random() % 4096);
+					if (Allocation.IsValid())
+					{
+						UsedSize += Allocation.Size;
+						Allocations.push_back(Allocation);
+					}
+				}
+
+				if (iStep % 1000 == 999)
+				{
+					RangeAllocator.Compact();
+					CHECK_EQUAL(RangeAllocator.GetStats().NumFreeRanges, 1u);
+				}
+			}
+
+			CHECK_EQUAL(uint64(RangeAllocator.GetUsedSize()), UsedSize);
+			CHECK_EQUAL(std::size_t(RangeAllocator.GetNumAllocations()), Allocations.size());
+			CHECK(AreRangesDisjoint(RangeAllocator, Allocations));
+		}
+
+		BENCHMARK(RangeAllocatorRandomCycles)
+		{
+			// Ranges of vertices of a geometry arena's page: meshes of 64 to 64K units, about 3/4 of the page is used
+			const uint32 Size = 64 * 1024 * 1024;
+			const uint32 MinAllocationSize = 64;
+			const uint32 MaxAllocationSize = 64 * 1024;
+			const uint32 NumLiveAllocations = 1500;
+			const uint32 NumCycles = 1000000;
+
+			// Sizes and victims are random, but they're generated before the timer
+			std::mt19937 Random(29);
+			std::uniform_int_distribution<uint32> SizeDistribution(MinAllocationSize, MaxAllocationSize);
+			std::vector<uint32> AllocationsSizes(NumLiveAllocations + NumCycles);
+			for (auto& AllocationSize : AllocationsSizes)
+			{
+				AllocationSize = SizeDistribution(Random);
+			}
+
+			std::uniform_int_distribution<uint32> VictimDistribution(0, NumLiveAllocations - 1);
+			std::vector<uint32> Victims(NumCycles);
+			for (auto& iVictim : Victims)
+			{
+				iVictim = VictimDistribution(Random);
+			}
+
+			FRangeAllocator RangeAllocator(Size);
+			std::vector<FRangeAllocation> Allocations;
+			for (uint32 iAllocation = 0; iAllocation < NumLiveAllocations; ++iAllocation)
+			{
+				Allocations.push_back(RangeAllocator.Allocate(AllocationsSizes[iAllocation]));
+			}
+			CHECK(std::all_of(Allocations.cbegin(), Allocations.cend(),
+				[](const FRangeAllocation& Allocation) { return Allocation.IsValid(); }));
+
+			// Every cycle frees a random range and allocates another size in its place.
+			// Failed allocations keep the slot empty until it's picked again
+			uint32 NumFailed = 0;
+			FBenchTimer Timer;
+			for (uint32 iCycle = 0; iCycle < NumCycles; ++iCycle)
+			{
+				auto& Allocation = Allocations[Victims[iCycle]];
+				if (Allocation.IsValid())
+				{
+					RangeAllocator.Free(Allocation);
+				}
+
+				Allocation = RangeAllocator.Allocate(AllocationsSizes[NumLiveAllocations + iCycle]);
+				NumFailed += Allocation.IsValid() ? 0 : 1;
+			}
+			const auto Milliseconds = Timer.GetMilliseconds();
+
+			std::vector<FRangeAllocation> LiveAllocations;
+			std::copy_if(Allocations.cbegin(), Allocations.cend(), std::back_inserter(LiveAllocations),
+				[](const FRangeAllocation& Allocation) { return Allocation.IsValid(); });
+			CHECK(AreRangesDisjoint(RangeAllocator, LiveAllocations));
+
+			const auto Stats = RangeAllocator.GetStats();
+			const auto Fragmentation = Stats.GetFragmentation();
+
+			FBenchTimer CompactTimer;
+			const auto Moves = RangeAllocator.Compact();
+			const auto CompactMilliseconds = CompactTimer.GetMilliseconds();
+			CHECK_EQUAL(RangeAllocator.GetStats().GetFragmentation(), 0.0f);
+
+			BENCH_REPORT("cycles", NumCycles << " frees and allocations of " << MinAllocationSize << "-" << MaxAllocationSize <<
+				" units in " << Milliseconds << " ms, " << NumCycles / (Milliseconds / 1000.0) << " allocations/s, " <<
+				NumFailed << " failed");
+			BENCH_REPORT("fragmentation", Stats.NumAllocations << " ranges use " << 100.0 * Stats.UsedSize / Stats.Size <<
+				"% of " << Stats.Size << " units, " << Stats.NumFreeRanges << " free ranges, largest " << Stats.LargestFreeRange <<
+				", fragmentation ratio " << Fragmentation);
+			BENCH_REPORT("compaction", Moves.size() << " moves in " << CompactMilliseconds << " ms, fragmentation ratio " <<
+				RangeAllocator.GetStats().GetFragmentation());
+		}
+	}
+}
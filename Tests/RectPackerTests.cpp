@@ -0,0 +1,115 @@
+#include <random>
+
+#include "RectPacker.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/** @brief Returns true if rectangles share a texel
+			  * @param A (const FPackedRect &)
+			  * @param B (const FPackedRect &)
+			  * @return (bool)
+			  */
+			bool AreOverlapping(const FPackedRect& A, const FPackedRect& B)
+			{
+				return A.X < B.X + B.Width && B.X < A.X + A.Width &&
+					A.Y < B.Y + B.Height && B.Y < A.Y + A.Height;
+			}
+		}
+
+		TEST(RectPackerKeepsRectsInBinWithoutOverlaps)
+		{
+			const uint32 BinWidth = 256;
+			const uint32 BinHeight = 192;
+			FMaxRectsPacker Packer(BinWidth, BinHeight);
+
+			// Random sizes are inserted until the bin is full, so some of them don't fit
+			std::mt19937 Random(17);
+			std::uniform_int_distribution<uint32> SizeDistribution(1, 48);
+
+			std::vector<FPackedRect> Rects;
+			uint64 Area = 0;
+			auto NumRejected = 0;
+			for (auto iRect = 0; iRect < 400; ++iRect)
+			{
+				const auto Width = SizeDistribution(Random);
+				const auto Height = SizeDistribution(Random);
+
+				FPackedRect Rect;
+				if (!Packer.Insert(Width, Height, Rect))
+				{
+					++NumRejected;
+					continue;
+				}
+
+				CHECK(Rect.Width == Width && Rect.Height == Height);
+				Rects.push_back(Rect);
+				Area += uint64(Width)*Height;
+			}
+
+			CHECK(NumRejected > 0);
+			CHECK_NEAR(Packer.GetOccupancy(), double(Area) / (double(BinWidth)*BinHeight), 1e-6);
+			CHECK(Packer.GetOccupancy() > 0.7f);
+
+			for (std::size_t iRect = 0; iRect < Rects.size(); ++iRect)
+			{
+				const auto& Rect = Rects[iRect];
+				CHECK(Rect.X + Rect.Width <= BinWidth && Rect.Y + Rect.Height <= BinHeight);
+
+				for (auto iOtherRect = iRect + 1; iOtherRect < Rects.size(); ++iOtherRect)
+				{
+					CHECK(!AreOverlapping(Rect, Rects[iOtherRect]));
+				}
+			}
+		}
+
+		TEST(RectPackerFillsBinExactly)
+		{
+			// 16 tiles of a quarter of the side fill the bin without gaps
+			FMaxRectsPacker Packer(64, 64);
+			std::vector<FPackedRect> Rects(16);
+			for (auto& Rect : Rects)
+			{
+				CHECK(Packer.Insert(16, 16, Rect));
+			}
+
+			CHECK_EQUAL(Packer.GetOccupancy(), 1.0f);
+			for (std::size_t iRect = 0; iRect < Rects.size(); ++iRect)
+			{
+				CHECK(Rects[iRect].X % 16 == 0 && Rects[iRect].Y % 16 == 0);
+				for (auto iOtherRect = iRect + 1; iOtherRect < Rects.size(); ++iOtherRect)
+				{
+					CHECK(!AreOverlapping(Rects[iRect], Rects[iOtherRect]));
+				}
+			}
+
+			FPackedRect Rect;
+			CHECK(!Packer.Insert(1, 1, Rect));
+		}
+
+		TEST(RectPackerRejectsImpossibleFits)
+		{
+			FMaxRectsPacker Packer(64, 32);
+			FPackedRect Rect;
+
+			CHECK(!Packer.Insert(65, 1, Rect));
+			CHECK(!Packer.Insert(1, 33, Rect));
+			CHECK(!Packer.Insert(0, 8, Rect));
+			CHECK(!Packer.Insert(8, 0, Rect));
+			CHECK_EQUAL(Packer.GetOccupancy(), 0.0f);
+
+			// Columns are placed side by side, so a 16x32 rectangle is left
+			CHECK(Packer.Insert(16, 32, Rect));
+			CHECK(Packer.Insert(16, 32, Rect));
+			CHECK(Packer.Insert(16, 32, Rect) && Rect.X == 32);
+			CHECK(!Packer.Insert(32, 32, Rect));
+			CHECK(!Packer.Insert(16, 33, Rect));
+			CHECK(Packer.Insert(16, 32, Rect));
+			CHECK_EQUAL(Packer.GetOccupancy(), 1.0f);
+		}
+	}
+}
@@ -0,0 +1,163 @@
+#include "ResourceBudget.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/** @brief Returns a footprint of textures only
+			  * @param NumBytes (uint64)
+			  * @return (WoodenEngine::FResourceFootprint)
+			  */
+			FResourceFootprint GetTextureFootprint(uint64 NumBytes)
+			{
+				FResourceFootprint Footprint;
+				Footprint[EResourceMemory::Textures] = NumBytes;
+				return Footprint;
+			}
+
+			/** @brief Returns a budget whose resources are evicted after NumUnusedFramesToEvict frames
+			  * @param BudgetBytes (uint64)
+			  * @return (WoodenEngine::FResourceBudgetSettings)
+			  */
+			FResourceBudgetSettings GetSettings(uint64 BudgetBytes)
+			{
+				FResourceBudgetSettings Settings;
+				Settings.BudgetBytes = BudgetBytes;
+				Settings.NumUnusedFramesToEvict = 10;
+				return Settings;
+			}
+		}
+
+		TEST(ResourceBudgetAccountsFootprints)
+		{
+			FResourceBudget ResourceBudget(GetSettings(1000));
+
+			FResourceFootprint MeshFootprint;
+			MeshFootprint[EResourceMemory::CPU] = 10;
+			MeshFootprint[EResourceMemory::GPUBuffers] = 100;
+			ResourceBudget.AddResource(EResourceType::Mesh, "rock", MeshFootprint, true);
+			ResourceBudget.AddResource(EResourceType::Texture, "rock", GetTextureFootprint(200), true);
+
+			// Names are unique within a type only
+			auto Stats = ResourceBudget.GetStats();
+			CHECK_EQUAL(Stats.NumResources, 2u);
+			CHECK_EQUAL(Stats.NumResident, 2u);
+			CHECK_EQUAL(Stats.ResidentFootprint.GetTotalBytes(), 310u);
+			CHECK_EQUAL(Stats.ResidentFootprint[EResourceMemory::GPUBuffers], 100u);
+			CHECK_EQUAL(Stats.BudgetBytes, 1000u);
+
+			// Loads in flight are accounted with their last footprint, and completed ones with the new footprint
+			ResourceBudget.BeginLoad(EResourceType::Texture, "rock", true);
+			CHECK(!ResourceBudget.IsResident(EResourceType::Texture, "rock"));
+			ResourceBudget.CompleteLoad(EResourceType::Texture, "rock", true, GetTextureFootprint(50));
+			CHECK(ResourceBudget.IsResident(EResourceType::Texture, "rock"));
+			CHECK_EQUAL(ResourceBudget.GetStats().ResidentFootprint.GetTotalBytes(), 160u);
+
+			ResourceBudget.RemoveResource(EResourceType::Mesh, "rock");
+			CHECK(!ResourceBudget.HasResource(EResourceType::Mesh, "rock"));
+			CHECK_EQUAL(ResourceBudget.GetStats().ResidentFootprint.GetTotalBytes(), 50u);
+		}
+
+		TEST(ResourceBudgetEvictsInLRUOrder)
+		{
+			FResourceBudget ResourceBudget(GetSettings(250));
+			ResourceBudget.AddResource(EResourceType::Texture, "old", GetTextureFootprint(100), true);
+			ResourceBudget.AddResource(EResourceType::Texture, "recent", GetTextureFootprint(100), true);
+			ResourceBudget.AddResource(EResourceType::Texture, "static", GetTextureFootprint(100), false);
+			ResourceBudget.MarkUsed(EResourceType::Texture, "old", 1);
+			ResourceBudget.MarkUsed(EResourceType::Texture, "recent", 5);
+
+			// Resources used within NumUnusedFramesToEvict frames are kept even over the budget
+			CHECK(ResourceBudget.Update(10).empty());
+
+			// The least recently used one is evicted until the budget fits. Not reloadable ones are never evicted
+			const auto Requests = ResourceBudget.Update(20);
+			CHECK_EQUAL(Requests.size(), 1u);
+			CHECK(Requests.size() == 1 && Requests[0].bEvict && Requests[0].Name == "old");
+			CHECK(!ResourceBudget.IsResident(EResourceType::Texture, "old"));
+			CHECK(ResourceBudget.IsResident(EResourceType::Texture, "static"));
+			CHECK_EQUAL(ResourceBudget.GetStats().ResidentFootprint.GetTotalBytes(), 200u);
+			CHECK_EQUAL(ResourceBudget.GetStats().NumEvicted, 1u);
+
+			ResourceBudget.SetBudget(0);
+			const auto NextRequests = ResourceBudget.Update(30);
+			CHECK(NextRequests.size() == 1 && NextRequests[0].Name == "recent");
+			CHECK_EQUAL(ResourceBudget.GetStats().ResidentFootprint.GetTotalBytes(), 100u);
+		}
+
+		TEST(ResourceBudgetKeepsAndReloadsReferencedResources)
+		{
+			FResourceBudget ResourceBudget(GetSettings(0));
+			ResourceBudget.AddResource(EResourceType::Mesh, "tree", GetTextureFootprint(100), true);
+			ResourceBudget.AddResource(EResourceType::Material, "bark", GetTextureFootprint(10), true);
+			CHECK_EQUAL(ResourceBudget.AddReference(EResourceType::Mesh, "tree"), 1u);
+
+			// Referenced resources aren't evicted over the budget
+			const auto Requests = ResourceBudget.Update(100);
+			CHECK(Requests.size() == 1 && Requests[0].Type == EResourceType::Material && Requests[0].bEvict);
+			CHECK(ResourceBudget.IsResident(EResourceType::Mesh, "tree"));
+
+			// Released resources stay warm for NumUnusedFramesToEvict frames
+			CHECK_EQUAL(ResourceBudget.ReleaseReference(EResourceType::Mesh, "tree"), 0u);
+			CHECK(ResourceBudget.Update(105).empty());
+			CHECK_EQUAL(ResourceBudget.Update(110).size(), 1u);
+			CHECK(!ResourceBudget.IsResident(EResourceType::Mesh, "tree"));
+
+			// The evicted resource is reloaded when it's referenced again, and it's resident when the load completes
+			ResourceBudget.AddReference(EResourceType::Material, "bark");
+			const auto Reloads = ResourceBudget.Update(111);
+			CHECK(Reloads.size() == 1 && !Reloads[0].bEvict && Reloads[0].Name == "bark");
+			CHECK_EQUAL(ResourceBudget.GetStats().NumReloaded, 1u);
+			CHECK(ResourceBudget.Update(112).empty());
+
+			ResourceBudget.CompleteLoad(EResourceType::Material, "bark", true, GetTextureFootprint(10));
+			CHECK(ResourceBudget.IsResident(EResourceType::Material, "bark"));
+			CHECK_EQUAL(ResourceBudget.GetStats().ResidentFootprint.GetTotalBytes(), 10u);
+		}
+
+		TEST(ResourceBudgetHandlesFailedLoads)
+		{
+			FResourceBudget ResourceBudget(GetSettings(0));
+
+			// References may come before loads
+			ResourceBudget.AddReference(EResourceType::Texture, "sky");
+			CHECK(ResourceBudget.HasResource(EResourceType::Texture, "sky"));
+			CHECK(!ResourceBudget.IsResident(EResourceType::Texture, "sky"));
+
+			// A failed reload of a resident resource keeps it resident
+			ResourceBudget.AddResource(EResourceType::Texture, "sky", GetTextureFootprint(40), true);
+			ResourceBudget.BeginLoad(EResourceType::Texture, "sky", true);
+			ResourceBudget.CompleteLoad(EResourceType::Texture, "sky", false);
+			CHECK(ResourceBudget.IsResident(EResourceType::Texture, "sky"));
+			CHECK_EQUAL(ResourceBudget.GetStats().ResidentFootprint.GetTotalBytes(), 40u);
+
+			// A failed first load isn't reloaded
+			ResourceBudget.BeginLoad(EResourceType::Texture, "ground", true);
+			ResourceBudget.CompleteLoad(EResourceType::Texture, "ground", false);
+			ResourceBudget.AddReference(EResourceType::Texture, "ground");
+			CHECK(ResourceBudget.Update(100).empty());
+			CHECK(!ResourceBudget.IsResident(EResourceType::Texture, "ground"));
+
+			// Removed referenced resources are kept unloaded, so users may release them
+			ResourceBudget.RemoveResource(EResourceType::Texture, "sky");
+			CHECK(ResourceBudget.HasResource(EResourceType::Texture, "sky"));
+			CHECK_EQUAL(ResourceBudget.ReleaseReference(EResourceType::Texture, "sky"), 0u);
+		}
+
+		TEST(ResourceBudgetRejectsInvalidCalls)
+		{
+			FResourceBudget ResourceBudget;
+			CHECK_THROWS(ResourceBudget.AddReference(EResourceType::Mesh, ""), std::invalid_argument);
+			CHECK_THROWS(ResourceBudget.ReleaseReference(EResourceType::Mesh, "unknown"), std::invalid_argument);
+			CHECK_THROWS(ResourceBudget.CompleteLoad(EResourceType::Mesh, "unknown", true), std::invalid_argument);
+
+			ResourceBudget.AddResource(EResourceType::Mesh, "box", FResourceFootprint(), true);
+			CHECK_THROWS(ResourceBudget.ReleaseReference(EResourceType::Mesh, "box"), std::invalid_argument);
+			CHECK_THROWS(ResourceBudget.CompleteLoad(EResourceType::Mesh, "box", true), std::invalid_argument);
+			CHECK_EQUAL(ResourceBudget.GetNumReferences(EResourceType::Mesh, "unknown"), 0u);
+		}
+	}
+}
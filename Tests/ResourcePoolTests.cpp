@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+
+#include "ResourcePool.h"
+#include "ShaderStructures.h"
+#include "MaterialData.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/** @brief Returns a material of the benchmark. Every eighth one has dirty const buffers
+			  * @param iMaterial (uint32)
+			  * @return (WoodenEngine::FMaterialData)
+			  */
+			FMaterialData CreateMaterialData(uint32 iMaterial)
+			{
+				FMaterialData MaterialData("material" + std::to_string(iMaterial));
+				MaterialData.iConstBuffer = iMaterial;
+				MaterialData.NumDirtyConstBuffers = iMaterial % 8 == 0 ? 1 : 0;
+				MaterialData.Roughness = float(iMaterial % 100) / 100.0f;
+				return MaterialData;
+			}
+
+			/** @brief Sums what an update of the material's const buffer reads, so walks aren't optimized away
+			  * @param MaterialData (const FMaterialData &)
+			  * @return (double)
+			  */
+			double GetMaterialChecksum(const FMaterialData& MaterialData)
+			{
+				return MaterialData.NumDirtyConstBuffers > 0 ?
+					MaterialData.Roughness + MaterialData.DiffuseAlbedo.x + MaterialData.iConstBuffer : 0.0;
+			}
+		}
+
+		TEST(ResourcePoolCreatesAndFindsValues)
+		{
+			FResourcePool<std::string> Pool;
+			CHECK(Pool.IsEmpty());
+
+			const auto Grass = Pool.Create("grass");
+			const auto Water = Pool.Create(3, 'w');
+			CHECK(Grass.IsValid());
+			CHECK(Grass != Water);
+			CHECK_EQUAL(Pool.GetNumValues(), 2u);
+
+			CHECK_EQUAL(Pool.Get(Grass), std::string("grass"));
+			CHECK_EQUAL(*Pool.Find(Water), std::string("www"));
+			CHECK(Pool.Contains(Water));
+
+			// Invalid handles don't refer values
+			FResourcePool<std::string>::FHandle InvalidHandle;
+			CHECK(!InvalidHandle.IsValid());
+			CHECK(!Pool.Contains(InvalidHandle));
+			CHECK(Pool.Find(InvalidHandle) == nullptr);
+			CHECK_THROWS(Pool.Get(InvalidHandle), std::invalid_argument);
+		}
+
+		TEST(ResourcePoolInvalidatesDestroyedHandles)
+		{
+			FResourcePool<std::string> Pool;
+			const auto Grass = Pool.Create("grass");
+			Pool.Destroy(Grass);
+
+			CHECK(!Pool.Contains(Grass));
+			CHECK(Pool.Find(Grass) == nullptr);
+			CHECK_THROWS(Pool.Destroy(Grass), std::invalid_argument);
+
+			// The slot is reused with another generation, so the stale handle doesn't refer the new value
+			const auto Sand = Pool.Create("sand");
+			CHECK_EQUAL(Sand.Index, Grass.Index);
+			CHECK(Sand.Generation != Grass.Generation);
+			CHECK(Pool.Find(Grass) == nullptr);
+			CHECK_EQUAL(Pool.Get(Sand), std::string("sand"));
+		}
+
+		TEST(ResourcePoolKeepsValuesContiguous)
+		{
+			FResourcePool<int32> Pool;
+			std::vector<FPoolHandle<int32>> Handles;
+			for (auto Value = 0; Value < 5; ++Value)
+			{
+				Handles.push_back(Pool.Create(Value));
+			}
+
+			// The last value fills the hole, and handles of other values stay valid
+			Pool.Destroy(Handles[1]);
+			CHECK_EQUAL(Pool.GetNumValues(), 4u);
+			CHECK(std::vector<int32>(Pool.begin(), Pool.end()) == std::vector<int32>({ 0, 4, 2, 3 }));
+			for (auto Value : { 0, 2, 3, 4 })
+			{
+				CHECK_EQUAL(Pool.Get(Handles[Value]), Value);
+			}
+
+			// Handles are found by indices of values in storage
+			for (uint32 iValue = 0; iValue < Pool.GetNumValues(); ++iValue)
+			{
+				CHECK_EQUAL(Pool.Get(Pool.GetHandle(iValue)), *(Pool.begin() + iValue));
+			}
+
+			Pool.Destroy(Handles[4]);
+			Pool.Destroy(Handles[0]);
+			Pool.Destroy(Handles[3]);
+			Pool.Destroy(Handles[2]);
+			CHECK(Pool.IsEmpty());
+		}
+
+		BENCHMARK(MaterialsMapAndPool)
+		{
+			const uint32 NumMaterials = 16384;
+			const uint32 NumDraws = 100000;
+			const auto NumRuns = 10;
+
+			// As FGameResource kept materials before the pool: owned by unique_ptrs and found by names
+			std::unordered_map<std::string, std::unique_ptr<FMaterialData>> MaterialsMap;
+			FResourcePool<FMaterialData> MaterialsPool;
+			std::vector<FMaterialHandle> MaterialsHandles;
+			std::vector<std::string> MaterialsNames;
+			for (uint32 iMaterial = 0; iMaterial < NumMaterials; ++iMaterial)
+			{
+				auto MaterialData = CreateMaterialData(iMaterial);
+				MaterialsNames.push_back(MaterialData.Name);
+				MaterialsMap[MaterialData.Name] = std::make_unique<FMaterialData>(MaterialData);
+				MaterialsHandles.push_back(MaterialsPool.Create(std::move(MaterialData)));
+			}
+
+			// Objects refer random materials. The map's objects keep names, and the pool's ones keep handles
+			std::mt19937 Random(17);
+			std::uniform_int_distribution<uint32> Distribution(0, NumMaterials - 1);
+			std::vector<uint32> DrawsMaterials(NumDraws);
+			for (auto& iMaterial : DrawsMaterials)
+			{
+				iMaterial = Distribution(Random);
+			}
+
+			// As RenderObjects: the material of every draw is found
+			auto MapDrawsChecksum = 0.0;
+			auto MapDrawsTime = 1e9;
+			auto PoolDrawsChecksum = 0.0;
+			auto PoolDrawsTime = 1e9;
+			for (auto iRun = 0; iRun < NumRuns; ++iRun)
+			{
+				MapDrawsChecksum = 0.0;
+				FBenchTimer MapTimer;
+				for (auto iMaterial : DrawsMaterials)
+				{
+					const auto MaterialIter = MaterialsMap.find(MaterialsNames[iMaterial]);
+					MapDrawsChecksum += MaterialIter != MaterialsMap.cend() ? MaterialIter->second->Roughness : 0.0;
+				}
+				MapDrawsTime = std::min(MapDrawsTime, MapTimer.GetMilliseconds());
+
+				PoolDrawsChecksum = 0.0;
+				FBenchTimer PoolTimer;
+				for (auto iMaterial : DrawsMaterials)
+				{
+					const auto MaterialData = MaterialsPool.Find(MaterialsHandles[iMaterial]);
+					PoolDrawsChecksum += MaterialData != nullptr ? MaterialData->Roughness : 0.0;
+				}
+				PoolDrawsTime = std::min(PoolDrawsTime, PoolTimer.GetMilliseconds());
+			}
+			CHECK_EQUAL(PoolDrawsChecksum, MapDrawsChecksum);
+
+			// As UpdateMaterialsConstBuffer: every material is visited to find dirty ones
+			auto MapWalkChecksum = 0.0;
+			auto MapWalkTime = 1e9;
+			auto PoolWalkChecksum = 0.0;
+			auto PoolWalkTime = 1e9;
+			for (auto iRun = 0; iRun < NumRuns; ++iRun)
+			{
+				MapWalkChecksum = 0.0;
+				FBenchTimer MapTimer;
+				for (const auto& Material : MaterialsMap)
+				{
+					MapWalkChecksum += GetMaterialChecksum(*Material.second);
+				}
+				MapWalkTime = std::min(MapWalkTime, MapTimer.GetMilliseconds());
+
+				PoolWalkChecksum = 0.0;
+				FBenchTimer PoolTimer;
+				for (const auto& MaterialData : MaterialsPool)
+				{
+					PoolWalkChecksum += GetMaterialChecksum(MaterialData);
+				}
+				PoolWalkTime = std::min(PoolWalkTime, PoolTimer.GetMilliseconds());
+			}
+			CHECK_NEAR(PoolWalkChecksum, MapWalkChecksum, 1e-3);
+
+			BENCH_REPORT("draws", NumDraws << " lookups of " << NumMaterials << " materials, map " << MapDrawsTime <<
+				" ms, pool " << PoolDrawsTime << " ms, " << MapDrawsTime / PoolDrawsTime << "x faster");
+			BENCH_REPORT("update walk", NumMaterials << " materials, map " << MapWalkTime << " ms, pool " <<
+				PoolWalkTime << " ms, " << MapWalkTime / PoolWalkTime << "x faster");
+		}
+	}
+}
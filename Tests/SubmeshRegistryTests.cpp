@@ -0,0 +1,75 @@
+#include <memory>
+#include <unordered_map>
+
+#include "SubmeshRegistry.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/** @brief Creates data of a mesh with submeshes "top" of material "bark" and "bottom" of material "moss"
+			  * @param MeshName (const std::string &)
+			  * @return (WoodenEngine::FMeshData)
+			  */
+			FMeshData CreateMeshData(const std::string& MeshName)
+			{
+				FMeshData MeshData(MeshName);
+				for (const auto& SubmeshName : { "top", "bottom" })
+				{
+					auto SubmeshData = std::make_unique<FSubmeshData>(SubmeshName);
+					SubmeshData->MaterialName = SubmeshData->Name == "top" ? "bark" : "moss";
+					MeshData.SubmeshesData[SubmeshData->Name] = std::move(SubmeshData);
+				}
+				return MeshData;
+			}
+		}
+
+		TEST(SubmeshRegistryResolvesAndResetsSlots)
+		{
+			FResourcePool<FMeshData> MeshesData;
+			FResourcePool<FMaterialData> MaterialsData;
+			std::unordered_map<std::string, FMaterialHandle> MaterialsHandles;
+			MaterialsHandles["bark"] = MaterialsData.Create(FMaterialData("bark"));
+
+			// Submeshes are interned before their meshes are uploaded
+			FSubmeshRegistry SubmeshRegistry;
+			const auto TopHandle = SubmeshRegistry.AddHandle("tree", "top");
+			const auto BottomHandle = SubmeshRegistry.AddHandle("tree", "bottom");
+			const auto MissingHandle = SubmeshRegistry.AddHandle("tree", "roots");
+			const auto RockHandle = SubmeshRegistry.AddHandle("rock", "top");
+			CHECK_EQUAL(SubmeshRegistry.GetNumSlots(), 4u);
+			CHECK_EQUAL(SubmeshRegistry.FindHandle("tree", "bottom").Index, BottomHandle.Index);
+			CHECK(!SubmeshRegistry.FindHandle("tree", "leaves").IsValid());
+			CHECK(!SubmeshRegistry.IsReady(TopHandle));
+			CHECK(!SubmeshRegistry.IsReady(FSubmeshHandle()));
+
+			CHECK_THROWS(SubmeshRegistry.AddHandle("tree", "top"), std::invalid_argument);
+			CHECK_THROWS(SubmeshRegistry.AddHandle("", "top"), std::invalid_argument);
+
+			// Only slots of the uploaded mesh's submeshes are resolved, with materials added before
+			const auto TreeHandle = MeshesData.Create(CreateMeshData("tree"));
+			SubmeshRegistry.ResolveMesh(TreeHandle, MeshesData.Get(TreeHandle), MaterialsHandles);
+			CHECK(SubmeshRegistry.IsReady(TopHandle) && SubmeshRegistry.IsReady(BottomHandle));
+			CHECK(!SubmeshRegistry.IsReady(MissingHandle) && !SubmeshRegistry.IsReady(RockHandle));
+			CHECK(SubmeshRegistry.GetSlot(TopHandle).MeshHandle == TreeHandle);
+			CHECK(SubmeshRegistry.GetSlot(TopHandle).SubmeshData == MeshesData.Get(TreeHandle).SubmeshesData.at("top").get());
+			CHECK(SubmeshRegistry.GetSlot(TopHandle).MaterialHandle == MaterialsHandles["bark"]);
+			CHECK(!SubmeshRegistry.GetSlot(BottomHandle).MaterialHandle.IsValid());
+
+			// Slots of the evicted mesh are reset, and their handles are resolved again by the reload
+			SubmeshRegistry.ResetMesh(TreeHandle);
+			MeshesData.Destroy(TreeHandle);
+			CHECK(!SubmeshRegistry.IsReady(TopHandle) && !SubmeshRegistry.IsReady(BottomHandle));
+			CHECK_EQUAL(SubmeshRegistry.GetNames(TopHandle).first, std::string("tree"));
+
+			const auto ReloadedTreeHandle = MeshesData.Create(CreateMeshData("tree"));
+			SubmeshRegistry.ResolveMesh(ReloadedTreeHandle, MeshesData.Get(ReloadedTreeHandle), MaterialsHandles);
+			CHECK(SubmeshRegistry.IsReady(TopHandle));
+			CHECK(SubmeshRegistry.GetSlot(TopHandle).MeshHandle == ReloadedTreeHandle);
+			CHECK(MeshesData.Find(SubmeshRegistry.GetSlot(TopHandle).MeshHandle) != nullptr);
+		}
+	}
+}
@@ -0,0 +1,257 @@
+#include <algorithm>
+
+#include "Terrain.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			float GetPlaneHeight(float X, float Z)
+			{
+				return 0.25f*X - 0.5f*Z + 3.0f;
+			}
+
+			// Updates the terrain until the selection doesn't wait for tiles
+			void UpdateUntilComplete(FTerrain* Terrain, const XMFLOAT3& CameraPosition)
+			{
+				for (auto iUpdate = 0; iUpdate < 64; ++iUpdate)
+				{
+					Terrain->Update(CameraPosition);
+					if (Terrain->GetStats().NumPendingTiles == 0)
+					{
+						Terrain->Update(CameraPosition);
+						if (Terrain->GetStats().NumPendingTiles == 0)
+						{
+							return;
+						}
+					}
+					Terrain->WaitForPendingTiles();
+				}
+			}
+
+			double GetSelectedArea(const FTerrain& Terrain)
+			{
+				auto Area = 0.0;
+				for (const auto Tile : Terrain.GetSelectedTiles())
+				{
+					Area += double(Tile->Size)*Tile->Size;
+				}
+				return Area;
+			}
+		}
+
+		TEST(TerrainTileHasGridAndSkirts)
+		{
+			FTerrainSettings Settings;
+			Settings.TileResolution = 9;
+
+			const auto MeshData = FTerrain::GenerateTileMesh(Settings, &GetPlaneHeight, 16.0f, -32.0f, 8.0f);
+			const auto Resolution = Settings.TileResolution;
+
+			CHECK_EQUAL(MeshData->Vertices.size(), Resolution*Resolution + 4 * Resolution);
+			CHECK_EQUAL(MeshData->Indices.size(), (Resolution - 1)*(Resolution - 1) * 6 + 4 * (Resolution - 1) * 6);
+			CHECK_EQUAL(FTerrain::GetTileNumBytes(Settings),
+				MeshData->Vertices.size()*sizeof(FVertex) + MeshData->Indices.size()*sizeof(uint32));
+			CHECK(std::all_of(MeshData->Indices.cbegin(), MeshData->Indices.cend(),
+				[&MeshData](uint32 Index) { return Index < MeshData->Vertices.size(); }));
+
+			for (uint32 iVertex = 0; iVertex < Resolution*Resolution; ++iVertex)
+			{
+				const auto& Position = MeshData->Vertices[iVertex].Position;
+				CHECK_NEAR(Position.y, GetPlaneHeight(Position.x, Position.z), 1e-4f);
+				CHECK(Position.x >= 16.0f && Position.x <= 24.0f);
+				CHECK(Position.z >= -32.0f && Position.z <= -24.0f);
+			}
+
+			// Normal of the plane by central differences is exact
+			const auto Normal = XMVector3Normalize(XMVectorSet(-0.25f, 1.0f, 0.5f, 0.0f));
+			CHECK_NEAR(XMVectorGetX(XMVector3Dot(XMLoadFloat3(&MeshData->Vertices[0].Normal), Normal)), 1.0f, 1e-5f);
+
+			// Skirts hang under the tile's edges
+			const auto SkirtDepth = 8.0f*Settings.SkirtDepthFactor;
+			for (auto iVertex = Resolution*Resolution; iVertex < MeshData->Vertices.size(); ++iVertex)
+			{
+				const auto& Position = MeshData->Vertices[iVertex].Position;
+				CHECK_NEAR(Position.y, GetPlaneHeight(Position.x, Position.z) - SkirtDepth, 1e-4f);
+			}
+		}
+
+		TEST(TerrainSelectionCoversWorld)
+		{
+			FTerrainSettings Settings;
+			Settings.WorldSize = 1024.0f;
+			Settings.MaxDepth = 5;
+			Settings.MaxNumPendingTiles = 8;
+
+			FTerrain Terrain(Settings, &GetPlaneHeight);
+			const XMFLOAT3 CameraPosition = { 100.0f, GetPlaneHeight(100.0f, -200.0f) + 2.0f, -200.0f };
+			UpdateUntilComplete(&Terrain, CameraPosition);
+
+			const auto& SelectedTiles = Terrain.GetSelectedTiles();
+			CHECK(!SelectedTiles.empty());
+			CHECK_NEAR(GetSelectedArea(Terrain), double(Settings.WorldSize)*Settings.WorldSize, 1.0);
+
+			// The tile under the camera is of the deepest level, the farthest one is coarser
+			uint8 CameraTileLevel = 0;
+			uint8 MinLevel = Settings.MaxDepth;
+			for (const auto Tile : SelectedTiles)
+			{
+				if (CameraPosition.x >= Tile->MinX && CameraPosition.x < Tile->MinX + Tile->Size &&
+					CameraPosition.z >= Tile->MinZ && CameraPosition.z < Tile->MinZ + Tile->Size)
+				{
+					CameraTileLevel = Tile->Level;
+				}
+				MinLevel = std::min(MinLevel, Tile->Level);
+			}
+
+			CHECK_EQUAL(CameraTileLevel, Settings.MaxDepth);
+			CHECK(MinLevel < Settings.MaxDepth - 1);
+		}
+
+		TEST(TerrainCoversWorldWhileTilesArePending)
+		{
+			FTerrainSettings Settings;
+			Settings.WorldSize = 1024.0f;
+			Settings.MaxDepth = 4;
+
+			FTerrain Terrain(Settings, &GetPlaneHeight);
+			const XMFLOAT3 CameraPosition = { 0.0f, 10.0f, 0.0f };
+			UpdateUntilComplete(&Terrain, CameraPosition);
+			const auto NumGeneratedTiles = Terrain.GetStats().NumGeneratedTiles;
+
+			// Tiles of other levels are requested when the camera moves.
+			// Their resident parents or children are drawn meanwhile
+			const XMFLOAT3 FarCameraPosition = { 400.0f, 10.0f, 400.0f };
+			Terrain.Update(FarCameraPosition);
+			CHECK_NEAR(GetSelectedArea(Terrain), double(Settings.WorldSize)*Settings.WorldSize, 1.0);
+
+			UpdateUntilComplete(&Terrain, FarCameraPosition);
+			CHECK(Terrain.GetStats().NumGeneratedTiles > NumGeneratedTiles);
+			CHECK_NEAR(GetSelectedArea(Terrain), double(Settings.WorldSize)*Settings.WorldSize, 1.0);
+		}
+
+		TEST(TerrainEvictsTilesOverBudget)
+		{
+			FTerrainSettings Settings;
+			Settings.WorldSize = 1024.0f;
+			Settings.MaxDepth = 5;
+
+			FTerrain Terrain(Settings, &GetPlaneHeight);
+			UpdateUntilComplete(&Terrain, { -400.0f, 10.0f, -400.0f });
+
+			// The budget fits the selection only, so tiles of the previous position are evicted
+			Terrain.Update({ 400.0f, 10.0f, 400.0f });
+			const auto SelectedBytes = Terrain.GetStats().NumResidentBytes;
+			UpdateUntilComplete(&Terrain, { 400.0f, 10.0f, 400.0f });
+
+			FTerrainSettings SmallBudgetSettings = Settings;
+			SmallBudgetSettings.MemoryBudget = SelectedBytes / 2;
+
+			FTerrain SmallBudgetTerrain(SmallBudgetSettings, &GetPlaneHeight);
+			UpdateUntilComplete(&SmallBudgetTerrain, { -400.0f, 10.0f, -400.0f });
+			UpdateUntilComplete(&SmallBudgetTerrain, { 400.0f, 10.0f, 400.0f });
+
+			const auto& Stats = SmallBudgetTerrain.GetStats();
+			CHECK(Stats.NumEvictedTiles > 0);
+			CHECK_NEAR(GetSelectedArea(SmallBudgetTerrain), double(Settings.WorldSize)*Settings.WorldSize, 1.0);
+
+			// Only selected tiles may stay over the budget
+			uint64 SelectedTilesBytes = 0;
+			for (const auto Tile : SmallBudgetTerrain.GetSelectedTiles())
+			{
+				SelectedTilesBytes += Tile->NumBytes;
+			}
+			CHECK(Stats.NumResidentBytes <= std::max(SmallBudgetSettings.MemoryBudget, SelectedTilesBytes));
+		}
+
+		TEST(TerrainSelectionFitsGameBudget)
+		{
+			// Settings and initial camera of FGameMain
+			FTerrainSettings Settings;
+			Settings.WorldSize = 1024.0f;
+			Settings.MaxDepth = 6;
+			Settings.LODDistanceFactor = 1.0f;
+			Settings.MemoryBudget = 16 * 1024 * 1024;
+			Settings.MaxNumPendingTiles = 8;
+			const auto HeightFunction = [](float X, float Z) { return 4.0f*sinf(X*0.05f)*cosf(Z*0.05f) - 10.0f; };
+
+			// The game has an object per tile of the largest selection, and all of them fit the budget with pending tiles
+			const auto MaxNumSelectedTiles = FTerrain::GetMaxNumSelectedTiles(Settings);
+			CHECK((MaxNumSelectedTiles + Settings.MaxNumPendingTiles)*FTerrain::GetTileNumBytes(Settings) <= Settings.MemoryBudget);
+
+			FTerrain Terrain(Settings, HeightFunction);
+			UpdateUntilComplete(&Terrain, { -6.0f, 30.0f, 10.0f });
+			CHECK(Terrain.GetStats().NumSelectedTiles > 0);
+			CHECK(Terrain.GetStats().NumSelectedTiles <= MaxNumSelectedTiles);
+			CHECK_NEAR(GetSelectedArea(Terrain), double(Settings.WorldSize)*Settings.WorldSize, 1.0);
+
+			// The bound holds near the ground anywhere in the world, and nothing is evicted over the budget
+			auto NumSelectedTiles = 0u;
+			for (auto X = -512.0f; X <= 512.0f; X += 64.0f)
+			{
+				for (auto Z = -512.0f; Z <= 512.0f; Z += 64.0f)
+				{
+					UpdateUntilComplete(&Terrain, { X, HeightFunction(X, Z), Z });
+					NumSelectedTiles = std::max(NumSelectedTiles, Terrain.GetStats().NumSelectedTiles);
+				}
+			}
+			CHECK(NumSelectedTiles <= MaxNumSelectedTiles);
+			CHECK(Terrain.GetStats().PeakNumResidentBytes <= Settings.MemoryBudget);
+		}
+
+		TEST(TerrainRejectsInvalidSettings)
+		{
+			FTerrainSettings Settings;
+			Settings.TileResolution = 1;
+			CHECK_THROWS(FTerrain{ Settings }, std::invalid_argument);
+
+			Settings = FTerrainSettings();
+			Settings.WorldSize = 0.0f;
+			CHECK_THROWS(FTerrain{ Settings }, std::invalid_argument);
+
+			Settings = FTerrainSettings();
+			Settings.MaxDepth = 29;
+			CHECK_THROWS(FTerrain{ Settings }, std::invalid_argument);
+
+			// Indices are 32-bit, so tiles may have more than 64K vertices
+			Settings = FTerrainSettings();
+			Settings.TileResolution = 257;
+			FTerrain Terrain(Settings);
+			CHECK(FTerrain::GenerateTileMesh(Settings, &FMeshGenerator::GetLandscapeHeight, 0.0f, 0.0f, 1.0f)->Vertices.size() > UINT16_MAX);
+		}
+
+		BENCHMARK(TerrainFlythrough)
+		{
+			FTerrainSettings Settings;
+			Settings.MemoryBudget = 8 * 1024 * 1024;
+			FTerrain Terrain(Settings);
+
+			// The camera flies along the world's diagonal, 8 units per frame
+			const auto NumFrames = 600;
+			auto MaxNumSelectedTiles = 0u;
+
+			FBenchTimer Timer;
+			for (auto iFrame = 0; iFrame < NumFrames; ++iFrame)
+			{
+				const auto Offset = -1200.0f + 4.0f*iFrame;
+				Terrain.Update({ Offset, FMeshGenerator::GetLandscapeHeight(Offset, Offset) + 20.0f, Offset });
+				MaxNumSelectedTiles = std::max(MaxNumSelectedTiles, Terrain.GetStats().NumSelectedTiles);
+			}
+			Terrain.WaitForPendingTiles();
+			const auto Time = Timer.GetMilliseconds();
+
+			const auto& Stats = Terrain.GetStats();
+			CHECK(Stats.NumEvictedTiles > 0);
+
+			BENCH_REPORT("Flythrough", NumFrames << " frames in " << Time << " ms, " << Stats.NumGeneratedTiles <<
+				" tiles generated, " << Stats.NumEvictedTiles << " evicted, up to " << MaxNumSelectedTiles << " selected");
+			BENCH_REPORT("Generation", Stats.TilesPerSecond << " tiles/s per worker, " << 
+				Stats.NumGeneratedTiles / (Time / 1000.0) << " tiles/s overall");
+			BENCH_REPORT("Memory", (Stats.PeakNumResidentBytes >> 10) << " KB peak, " << 
+				(Stats.NumResidentBytes >> 10) << " KB resident of " << (Settings.MemoryBudget >> 10) << " KB budget");
+		}
+	}
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "pch.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		using FTestFunction = void(*)();
+
+		/*!
+		 * \struct FTestCase
+		 *
+		 * \brief Test or benchmark registered by TEST or BENCHMARK.
+		 * Benchmarks are run only with --bench, so the default run stays fast
+		 *
+		 * \author devmi
+		 * \date October 2018
+		 */
+		struct FTestCase
+		{
+			const char* Name = nullptr;
+			FTestFunction Function = nullptr;
+			bool bBenchmark = false;
+		};
+
+		/** @brief Test cases of all test files in order of their registration
+		  * @return (std::vector<FTestCase>&)
+		  */
+		std::vector<FTestCase>& GetTestCases();
+
+		/** @brief Registers a test case. Is called by static registrars of TEST and BENCHMARK
+		  */
+		struct FTestRegistrar
+		{
+			FTestRegistrar(const char* Name, FTestFunction Function, bool bBenchmark)
+			{
+				FTestCase TestCase;
+				TestCase.Name = Name;
+				TestCase.Function = Function;
+				TestCase.bBenchmark = bBenchmark;
+				GetTestCases().push_back(TestCase);
+			}
+		};
+
+		/** @brief Counts a failed check of the current test case and prints it
+		  * @param File (const char *)
+		  * @param Line (int)
+		  * @param Message (const std::string &)
+		  * @return (void)
+		  */
+		void ReportFailure(const char* File, int Line, const std::string& Message);
+
+		/** @brief Directory of test assets passed by --assets. Defaults to App3's directory
+		  * @return (const std::string&)
+		  */
+		const std::string& GetAssetsDirectory();
+
+		/*!
+		 * \struct FProcessMemory
+		 *
+		 * \brief Memory counters of the test process, as GetProcessMemoryInfo reports them
+		 *
+		 * \author devmi
+		 * \date October 2018
+		 */
+		struct FProcessMemory
+		{
+			uint64 WorkingSetBytes = 0;
+			uint64 PeakWorkingSetBytes = 0;
+
+			// Committed memory which isn't shared with other processes, so mapped files aren't counted
+			uint64 PrivateBytes = 0;
+		};
+
+		/** @brief Returns current memory counters of the process. Counters are zero if they can't be read
+		  * @return (WoodenEngine::Tests::FProcessMemory)
+		  */
+		FProcessMemory GetProcessMemory();
+
+		/*!
+		 * \class FBenchTimer
+		 *
+		 * \brief Measures wall time since its creation in milliseconds
+		 *
+		 * \author devmi
+		 * \date October 2018
+		 */
+		class FBenchTimer
+		{
+		public:
+			FBenchTimer() :
+				StartTime(std::chrono::high_resolution_clock::now())
+			{ }
+
+			double GetMilliseconds() const
+			{
+				const std::chrono::duration<double, std::milli> Duration =
+					std::chrono::high_resolution_clock::now() - StartTime;
+				return Duration.count();
+			}
+
+		private:
+			std::chrono::high_resolution_clock::time_point StartTime;
+		};
+	}
+}
+
+#define WE_TEST_CASE(Name, bBenchmark) \
+	static void Name(); \
+	static const WoodenEngine::Tests::FTestRegistrar Name##Registrar(#Name, &Name, bBenchmark); \
+	static void Name()
+
+// Defines a test, which is run by every run of the test target
+#define TEST(Name) WE_TEST_CASE(Name, false)
+
+// Defines a benchmark, which is run with --bench only
+#define BENCHMARK(Name) WE_TEST_CASE(Name, true)
+
+#define CHECK(Expression) \
+	if (!(Expression)) \
+	{ \
+		WoodenEngine::Tests::ReportFailure(__FILE__, __LINE__, #Expression); \
+	}
+
+#define CHECK_EQUAL(Actual, Expected) \
+	if (!((Actual) == (Expected))) \
+	{ \
+		std::ostringstream os_; \
+		os_ << #Actual << " == " << #Expected << " (" << (Actual) << " != " << (Expected) << ")"; \
+		WoodenEngine::Tests::ReportFailure(__FILE__, __LINE__, os_.str()); \
+	}
+
+#define CHECK_NEAR(Actual, Expected, Tolerance) \
+	if (!(std::fabs((Actual) - (Expected)) <= (Tolerance))) \
+	{ \
+		std::ostringstream os_; \
+		os_ << #Actual << " ~ " << #Expected << " (" << (Actual) << " vs " << (Expected) << ")"; \
+		WoodenEngine::Tests::ReportFailure(__FILE__, __LINE__, os_.str()); \
+	}
+
+#define CHECK_THROWS(Expression, Exception) \
+	{ \
+		auto bThrown_ = false; \
+		try { Expression; } catch (const Exception&) { bThrown_ = true; } \
+		if (!bThrown_) \
+		{ \
+			WoodenEngine::Tests::ReportFailure(__FILE__, __LINE__, #Expression " doesn't throw " #Exception); \
+		} \
+	}
+
+// Prints a line of a benchmark's report
+#define BENCH_REPORT( s , s2 ) \
+{ \
+	std::cout << "  " << s << ": " << s2 << "\n"; \
+}
@@ -0,0 +1,113 @@
+#include <cstring>
+#include <iostream>
+
+#include "TestHarness.h"
+
+#include <psapi.h>
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			uint32 NumFailures = 0;
+
+			std::string AssetsDirectory = "..\\App3\\";
+		}
+
+		std::vector<FTestCase>& GetTestCases()
+		{
+			static std::vector<FTestCase> TestCases;
+			return TestCases;
+		}
+
+		void ReportFailure(const char* File, int Line, const std::string& Message)
+		{
+			++NumFailures;
+			std::cout << "  " << File << "(" << Line << "): check failed: " << Message << "\n";
+		}
+
+		const std::string& GetAssetsDirectory()
+		{
+			return AssetsDirectory;
+		}
+
+		FProcessMemory GetProcessMemory()
+		{
+			FProcessMemory ProcessMemory;
+
+			PROCESS_MEMORY_COUNTERS_EX Counters = {};
+			if (GetProcessMemoryInfo(GetCurrentProcess(), 
+				reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&Counters), sizeof(Counters)))
+			{
+				ProcessMemory.WorkingSetBytes = Counters.WorkingSetSize;
+				ProcessMemory.PeakWorkingSetBytes = Counters.PeakWorkingSetSize;
+				ProcessMemory.PrivateBytes = Counters.PrivateUsage;
+			}
+
+			return ProcessMemory;
+		}
+	}
+}
+
+// Runs device-independent tests of the engine without a window and a GPU.
+// Usage: Tests [--bench] [--assets <App3 directory>] [name filter]
+int main(int NumArguments, char* Arguments[])
+{
+	using namespace WoodenEngine::Tests;
+
+	auto bRunBenchmarks = false;
+	std::string NameFilter;
+	for (auto iArgument = 1; iArgument < NumArguments; ++iArgument)
+	{
+		if (std::strcmp(Arguments[iArgument], "--bench") == 0)
+		{
+			bRunBenchmarks = true;
+		}
+		else if (std::strcmp(Arguments[iArgument], "--assets") == 0 && iArgument + 1 < NumArguments)
+		{
+			AssetsDirectory = Arguments[++iArgument];
+			if (!AssetsDirectory.empty() && AssetsDirectory.back() != '\\' && AssetsDirectory.back() != '/')
+			{
+				AssetsDirectory += '\\';
+			}
+		}
+		else
+		{
+			NameFilter = Arguments[iArgument];
+		}
+	}
+
+	uint32 NumRun = 0;
+	uint32 NumFailed = 0;
+	for (const auto& TestCase : GetTestCases())
+	{
+		if (TestCase.bBenchmark != bRunBenchmarks ||
+			(!NameFilter.empty() && std::string(TestCase.Name).find(NameFilter) == std::string::npos))
+		{
+			continue;
+		}
+
+		std::cout << (TestCase.bBenchmark ? "[bench] " : "[test] ") << TestCase.Name << "\n";
+
+		const auto NumFailuresBefore = NumFailures;
+		try
+		{
+			TestCase.Function();
+		}
+		catch (const std::exception& Exception)
+		{
+			ReportFailure(__FILE__, __LINE__, std::string("exception: ") + Exception.what());
+		}
+
+		++NumRun;
+		if (NumFailures != NumFailuresBefore)
+		{
+			++NumFailed;
+		}
+	}
+
+	std::cout << NumRun - NumFailed << "/" << NumRun << (bRunBenchmarks ? " benchmarks" : " tests") << " passed\n";
+	return NumFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "TextureAtlas.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/** @brief Returns the RGBA texel of a texture of CreateTaggedTexture, which encodes its position
+			  * @param X (uint32)
+			  * @param Y (uint32)
+			  * @param Tag (uint8)
+			  * @param Mip (uint32)
+			  * @return (uint32)
+			  */
+			uint32 GetTaggedTexel(uint32 X, uint32 Y, uint8 Tag, uint32 Mip)
+			{
+				return X | Y << 8 | static_cast<uint32>(Tag) << 16 | Mip << 24;
+			}
+
+			/** @brief Creates a DDS file of a RGBA texture whose texels are GetTaggedTexel
+			  * @param Width (uint32)
+			  * @param Height (uint32)
+			  * @param MipCount (uint32)
+			  * @param Tag (uint8)
+			  * @return (std::vector<uint8>)
+			  */
+			std::vector<uint8> CreateTaggedTexture(uint32 Width, uint32 Height, uint32 MipCount, uint8 Tag)
+			{
+				auto Bytes = DirectX::CreateDDSHeaders(DXGI_FORMAT_R8G8B8A8_UNORM, Width, Height, MipCount);
+				for (uint32 iMip = 0; iMip < MipCount; ++iMip)
+				{
+					for (uint32 Y = 0; Y < std::max(Height >> iMip, 1u); ++Y)
+					{
+						for (uint32 X = 0; X < std::max(Width >> iMip, 1u); ++X)
+						{
+							const auto Texel = GetTaggedTexel(X, Y, Tag, iMip);
+							const auto TexelBytes = reinterpret_cast<const uint8*>(&Texel);
+							Bytes.insert(Bytes.end(), TexelBytes, TexelBytes + sizeof(Texel));
+						}
+					}
+				}
+
+				return Bytes;
+			}
+
+			/** @brief Creates a DDS file of a texture whose mips are filled with the byte
+			  * @param Format (DXGI_FORMAT)
+			  * @param Width (uint32)
+			  * @param Height (uint32)
+			  * @param MipCount (uint32)
+			  * @param Value (uint8)
+			  * @return (std::vector<uint8>)
+			  */
+			std::vector<uint8> CreateFilledTexture(DXGI_FORMAT Format, uint32 Width, uint32 Height, uint32 MipCount, uint8 Value)
+			{
+				auto Bytes = DirectX::CreateDDSHeaders(Format, Width, Height, MipCount);
+				for (uint32 iMip = 0; iMip < MipCount; ++iMip)
+				{
+					size_t NumBytes = 0;
+					DirectX::GetSurfaceInfo(std::max(Width >> iMip, 1u), std::max(Height >> iMip, 1u),
+						Format, &NumBytes, nullptr, nullptr);
+					Bytes.insert(Bytes.end(), NumBytes, Value);
+				}
+
+				return Bytes;
+			}
+
+			/** @brief Returns bytes of the block of the atlas' mip
+			  * @param Atlas (const std::vector<uint8> &)
+			  * @param Layout Layout of the atlas (const DirectX::DDS_TEXTURE_LAYOUT &)
+			  * @param Mip (uint32)
+			  * @param BlockX (uint32)
+			  * @param BlockY (uint32)
+			  * @param BytesPerBlock (uint32)
+			  * @return (const uint8*)
+			  */
+			const uint8* GetBlock(
+				const std::vector<uint8>& Atlas,
+				const DirectX::DDS_TEXTURE_LAYOUT& Layout,
+				uint32 Mip,
+				uint32 BlockX,
+				uint32 BlockY,
+				uint32 BytesPerBlock)
+			{
+				const auto& Subresource = Layout.subresources[Mip];
+				return Atlas.data() + Subresource.offset + BlockY*Subresource.rowPitch + BlockX*BytesPerBlock;
+			}
+
+			/** @brief Returns true if the rectangles extended by the padding overlap
+			  * @param A (const FPackedRect &)
+			  * @param B (const FPackedRect &)
+			  * @param Padding (uint32)
+			  * @return (bool)
+			  */
+			bool AreOverlapping(const FPackedRect& A, const FPackedRect& B, uint32 Padding)
+			{
+				return A.X < B.X + B.Width + 2 * Padding && B.X < A.X + A.Width + 2 * Padding &&
+					A.Y < B.Y + B.Height + 2 * Padding && B.Y < A.Y + A.Height + 2 * Padding;
+			}
+		}
+
+		TEST(TextureAtlasCopiesMipsWithGuardBands)
+		{
+			FTextureAtlasSettings Settings;
+			Settings.NumMips = 2;
+			FTextureAtlasBuilder Builder(Settings);
+
+			// Mips after NumMips are dropped
+			const auto Grass = CreateTaggedTexture(8, 8, 2, 1);
+			const auto Bark = CreateTaggedTexture(16, 6, 3, 2);
+			CHECK(Builder.AddTexture("grass", Grass.data(), Grass.size()));
+			CHECK(Builder.AddTexture("bark", Bark.data(), Bark.size()));
+			CHECK(Builder.Pack());
+			CHECK(Builder.GetFormat() == DXGI_FORMAT_R8G8B8A8_UNORM);
+
+			const auto Atlas = Builder.Build();
+			DirectX::DDS_TEXTURE_LAYOUT Layout;
+			CHECK(SUCCEEDED(DirectX::GetDDSTextureLayout(Atlas.data(), Atlas.size(), 0, Layout)));
+			CHECK_EQUAL(Layout.width, Builder.GetWidth());
+			CHECK_EQUAL(Layout.height, Builder.GetHeight());
+			CHECK_EQUAL(Layout.mipCount, 2u);
+
+			// Guard bands of rectangles are as wide as a texel of the last mip
+			const uint32 Alignment = 2;
+			const auto& GrassEntry = Builder.GetEntry("grass");
+			const auto& BarkEntry = Builder.GetEntry("bark");
+			CHECK(!AreOverlapping(GrassEntry.Rect, BarkEntry.Rect, Alignment));
+			CHECK_NEAR(Builder.GetOccupancy(), (64.0f + 96.0f) / (Builder.GetWidth()*Builder.GetHeight()), 1e-6f);
+
+			const std::pair<const FTextureAtlasEntry*, uint8> Textures[] = { { &GrassEntry, 1 }, { &BarkEntry, 2 } };
+			for (const auto& Texture : Textures)
+			{
+				const auto& Entry = *Texture.first;
+				CHECK(Entry.Rect.X >= Alignment && Entry.Rect.Y >= Alignment);
+				CHECK(Entry.Rect.X + Entry.Rect.Width + Alignment <= Builder.GetWidth());
+				CHECK(Entry.Rect.Y + Entry.Rect.Height + Alignment <= Builder.GetHeight());
+				CHECK_NEAR(Entry.UVOffset.x*Builder.GetWidth(), static_cast<float>(Entry.Rect.X), 1e-3f);
+				CHECK_NEAR(Entry.UVScale.y*Builder.GetHeight(), static_cast<float>(Entry.Rect.Height), 1e-3f);
+
+				// Texels of the padded rectangle are the wrapped texels of the texture
+				auto bMatches = true;
+				for (uint32 iMip = 0; iMip < 2; ++iMip)
+				{
+					const auto Guard = Alignment >> iMip;
+					const auto MipWidth = Entry.Rect.Width >> iMip;
+					const auto MipHeight = Entry.Rect.Height >> iMip;
+					for (uint32 Y = 0; Y < MipHeight + 2 * Guard; ++Y)
+					{
+						for (uint32 X = 0; X < MipWidth + 2 * Guard; ++X)
+						{
+							uint32 Texel = 0;
+							std::memcpy(&Texel, GetBlock(Atlas, Layout, iMip,
+								(Entry.Rect.X >> iMip) - Guard + X, (Entry.Rect.Y >> iMip) - Guard + Y, 4), 4);
+
+							const auto SourceX = (X + MipWidth - Guard) % MipWidth;
+							const auto SourceY = (Y + MipHeight - Guard) % MipHeight;
+							bMatches = bMatches && Texel == GetTaggedTexel(SourceX, SourceY, Texture.second, iMip);
+						}
+					}
+				}
+
+				CHECK(bMatches);
+			}
+		}
+
+		TEST(TextureAtlasFillsSolidBlocks)
+		{
+			FTextureAtlasSettings Settings;
+			Settings.NumMips = 2;
+
+			// Solid BGRA textures are converted to RGBA of the atlas
+			FTextureAtlasBuilder Builder(Settings);
+			const auto Grass = CreateTaggedTexture(8, 8, 2, 1);
+			auto White = CreateFilledTexture(DXGI_FORMAT_B8G8R8A8_UNORM, 1, 1, 1, 0);
+			const uint8 WhiteBGRA[] = { 10, 20, 30, 40 };
+			std::memcpy(White.data() + White.size() - 4, WhiteBGRA, 4);
+			CHECK(Builder.AddTexture("white", White.data(), White.size()));
+			CHECK(Builder.AddTexture("grass", Grass.data(), Grass.size()));
+			CHECK(Builder.Pack());
+
+			const auto& WhiteEntry = Builder.GetEntry("white");
+			CHECK(WhiteEntry.bSolid);
+			CHECK_EQUAL(WhiteEntry.Rect.Width, 2u);
+			CHECK_EQUAL(WhiteEntry.Rect.Height, 2u);
+			CHECK(WhiteEntry.UVScale.x == 0.0f && WhiteEntry.UVScale.y == 0.0f);
+			CHECK_NEAR(WhiteEntry.UVOffset.x*Builder.GetWidth(), WhiteEntry.Rect.X + 1.0f, 1e-3f);
+			CHECK_NEAR(WhiteEntry.UVOffset.y*Builder.GetHeight(), WhiteEntry.Rect.Y + 1.0f, 1e-3f);
+			CHECK(!AreOverlapping(WhiteEntry.Rect, Builder.GetEntry("grass").Rect, 1));
+
+			const auto Atlas = Builder.Build();
+			DirectX::DDS_TEXTURE_LAYOUT Layout;
+			CHECK(SUCCEEDED(DirectX::GetDDSTextureLayout(Atlas.data(), Atlas.size(), 0, Layout)));
+
+			const uint8 WhiteRGBA[] = { 30, 20, 10, 40 };
+			auto bFilled = true;
+			for (uint32 iMip = 0; iMip < 2; ++iMip)
+			{
+				for (uint32 Y = 0; Y < (WhiteEntry.Rect.Height >> iMip); ++Y)
+				{
+					for (uint32 X = 0; X < (WhiteEntry.Rect.Width >> iMip); ++X)
+					{
+						const auto Texel = GetBlock(Atlas, Layout, iMip,
+							(WhiteEntry.Rect.X >> iMip) + X, (WhiteEntry.Rect.Y >> iMip) + Y, 4);
+						bFilled = bFilled && std::memcmp(Texel, WhiteRGBA, 4) == 0;
+					}
+				}
+			}
+
+			CHECK(bFilled);
+
+			// Solid colors of compressed atlases are encoded blocks, whose texels are transparent if alpha is low
+			FTextureAtlasBuilder BC1Builder(Settings);
+			const auto Rock = CreateFilledTexture(DXGI_FORMAT_BC1_UNORM, 8, 8, 2, 0x55);
+			const auto Clear = CreateFilledTexture(DXGI_FORMAT_R8G8B8A8_UNORM, 1, 1, 1, 0);
+			auto Red = Clear;
+			const uint8 RedRGBA[] = { 255, 0, 0, 255 };
+			std::memcpy(Red.data() + Red.size() - 4, RedRGBA, 4);
+			CHECK(BC1Builder.AddTexture("rock", Rock.data(), Rock.size()));
+			CHECK(BC1Builder.AddTexture("red", Red.data(), Red.size()));
+			CHECK(BC1Builder.AddTexture("clear", Clear.data(), Clear.size()));
+			CHECK(BC1Builder.Pack());
+
+			const auto BC1Atlas = BC1Builder.Build();
+			CHECK(SUCCEEDED(DirectX::GetDDSTextureLayout(BC1Atlas.data(), BC1Atlas.size(), 0, Layout)));
+
+			const uint8 RedBlock[] = { 0x00, 0xF8, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00 };
+			const uint8 ClearBlock[] = { 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0xFF };
+			const std::pair<const char*, const uint8*> SolidBlocks[] = { { "red", RedBlock }, { "clear", ClearBlock } };
+			for (const auto& SolidBlock : SolidBlocks)
+			{
+				const auto& Entry = BC1Builder.GetEntry(SolidBlock.first);
+				CHECK(Entry.bSolid);
+				CHECK_EQUAL(Entry.Rect.Width, 8u);
+
+				auto bEncoded = true;
+				for (uint32 iMip = 0; iMip < 2; ++iMip)
+				{
+					const auto NumBlocks = (Entry.Rect.Width >> iMip) / 4;
+					for (uint32 iBlockY = 0; iBlockY < NumBlocks; ++iBlockY)
+					{
+						for (uint32 iBlockX = 0; iBlockX < NumBlocks; ++iBlockX)
+						{
+							const auto Block = GetBlock(BC1Atlas, Layout, iMip,
+								(Entry.Rect.X >> iMip) / 4 + iBlockX, (Entry.Rect.Y >> iMip) / 4 + iBlockY, 8);
+							bEncoded = bEncoded && std::memcmp(Block, SolidBlock.second, 8) == 0;
+						}
+					}
+				}
+
+				CHECK(bEncoded);
+			}
+
+			// Blocks of other textures are copied as they are
+			const auto& RockEntry = BC1Builder.GetEntry("rock");
+			CHECK_EQUAL(*GetBlock(BC1Atlas, Layout, 0, RockEntry.Rect.X / 4, RockEntry.Rect.Y / 4, 8), 0x55);
+		}
+
+		TEST(TextureAtlasRejectsTexturesWhichCantBePacked)
+		{
+			FTextureAtlasSettings Settings;
+			Settings.MaxSize = 32;
+			Settings.NumMips = 3;
+			FTextureAtlasBuilder Builder(Settings);
+
+			// Rectangles are aligned by 4 texels, so every mip has whole texels
+			const auto TooFewMips = CreateTaggedTexture(8, 8, 2, 1);
+			const auto Misaligned = CreateTaggedTexture(12, 6, 3, 1);
+			CHECK(!Builder.AddTexture("few mips", TooFewMips.data(), TooFewMips.size()));
+			CHECK(!Builder.AddTexture("misaligned", Misaligned.data(), Misaligned.size()));
+			CHECK_THROWS(Builder.Build(), std::invalid_argument);
+			CHECK(!Builder.Pack());
+
+			// Textures of an atlas have one format
+			const auto Grass = CreateTaggedTexture(8, 8, 3, 1);
+			const auto Rock = CreateFilledTexture(DXGI_FORMAT_BC1_UNORM, 16, 16, 3, 0);
+			const auto Height = CreateFilledTexture(DXGI_FORMAT_R32_FLOAT, 8, 8, 3, 0);
+			CHECK(Builder.AddTexture("grass", Grass.data(), Grass.size()));
+			CHECK(!Builder.AddTexture("rock", Rock.data(), Rock.size()));
+			CHECK(!Builder.AddTexture("height", Height.data(), Height.size()));
+			CHECK_THROWS(Builder.AddTexture("grass", Grass.data(), Grass.size()), std::invalid_argument);
+			CHECK_THROWS(Builder.AddTexture("broken", Grass.data(), 16), std::invalid_argument);
+
+			// Padded rectangles of 8 + 2*4 texels fit the atlas of 32x32 texels, but one of 16 + 2*4 texels doesn't fit with them
+			const auto Leaves = CreateTaggedTexture(8, 8, 3, 2);
+			const auto Moss = CreateTaggedTexture(16, 16, 3, 3);
+			CHECK(Builder.AddTexture("leaves", Leaves.data(), Leaves.size()));
+			CHECK(Builder.Pack());
+			CHECK(Builder.AddTexture("moss", Moss.data(), Moss.size()));
+			CHECK(!Builder.Pack());
+			CHECK(!Builder.HasEntry("grass"));
+			CHECK_THROWS(Builder.GetEntry("moss"), std::invalid_argument);
+		}
+	}
+}
@@ -0,0 +1,298 @@
+#include <deque>
+
+#include "TextureStreamer.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			// 1024x1024 RGBA8 with 11 mips. Mips from 64x64 are tail ones by default
+			const uint32 TextureWidth = 1024;
+			const uint32 TextureTailMip = 4;
+
+			std::vector<uint64> GetMipsSizes()
+			{
+				std::vector<uint64> MipsSizes;
+				for (auto MipWidth = TextureWidth; MipWidth > 0; MipWidth >>= 1)
+				{
+					MipsSizes.push_back(uint64(MipWidth) * MipWidth * 4);
+				}
+				return MipsSizes;
+			}
+
+			/** @brief Returns size of mips from the mip to the last one
+			  * @param Mip (uint32)
+			  * @return (uint64)
+			  */
+			uint64 GetMipChainSize(uint32 Mip)
+			{
+				const auto MipsSizes = GetMipsSizes();
+				uint64 Size = 0;
+				for (auto iMip = Mip; iMip < MipsSizes.size(); ++iMip)
+				{
+					Size += MipsSizes[iMip];
+				}
+				return Size;
+			}
+		}
+
+		TEST(TextureStreamerRequestsWantedMip)
+		{
+			FTextureStreamer TextureStreamer;
+			TextureStreamer.AddTexture("rock", GetMipsSizes(), TextureWidth, TextureTailMip);
+			CHECK_EQUAL(TextureStreamer.GetStats().ResidentBytes, GetMipChainSize(TextureTailMip));
+
+			// 512 texels is the coarsest mip which isn't less than 300
+			TextureStreamer.UpdateTextureUsage("rock", 300.0f, 1);
+			const auto Requests = TextureStreamer.Update(1);
+			CHECK_EQUAL(Requests.size(), 1u);
+			CHECK_EQUAL(Requests[0].TextureName, std::string("rock"));
+			CHECK_EQUAL(Requests[0].MostDetailedMip, 1u);
+			CHECK_NEAR(Requests[0].Priority, 300.0f / 64.0f, 1e-5f);
+
+			// Memory of the request is reserved while it's in flight, the texture isn't requested twice
+			CHECK_EQUAL(TextureStreamer.GetStats().ResidentBytes, GetMipChainSize(1));
+			CHECK_EQUAL(TextureStreamer.GetStats().NumInFlightRequests, 1u);
+			CHECK(TextureStreamer.Update(2).empty());
+			CHECK_EQUAL(TextureStreamer.GetResidentMip("rock"), TextureTailMip);
+
+			TextureStreamer.CompleteRequest("rock", true);
+			CHECK_EQUAL(TextureStreamer.GetResidentMip("rock"), 1u);
+			CHECK_EQUAL(TextureStreamer.GetStats().NumStreamedIn, 1u);
+			CHECK_EQUAL(TextureStreamer.GetStats().NumInFlightRequests, 0u);
+
+			// Usage of textures which aren't streamed is ignored
+			TextureStreamer.UpdateTextureUsage("generated", 1024.0f, 3);
+			CHECK(TextureStreamer.Update(3).empty());
+		}
+
+		TEST(TextureStreamerLimitsRequestsByPriority)
+		{
+			FTextureStreamer TextureStreamer;
+			for (const auto Name : { "near", "middle", "far" })
+			{
+				TextureStreamer.AddTexture(Name, GetMipsSizes(), TextureWidth, TextureTailMip);
+			}
+
+			TextureStreamer.UpdateTextureUsage("far", 100.0f, 1);
+			TextureStreamer.UpdateTextureUsage("near", 800.0f, 1);
+			TextureStreamer.UpdateTextureUsage("middle", 200.0f, 1);
+
+			// The largest of several usages in a frame is required
+			TextureStreamer.UpdateTextureUsage("middle", 400.0f, 1);
+
+			const auto Requests = TextureStreamer.Update(1);
+			CHECK_EQUAL(Requests.size(), std::size_t(TextureStreamer.GetSettings().MaxNumInFlightRequests));
+			CHECK_EQUAL(Requests[0].TextureName, std::string("near"));
+			CHECK_EQUAL(Requests[0].MostDetailedMip, 0u);
+			CHECK_EQUAL(Requests[1].TextureName, std::string("middle"));
+			CHECK_EQUAL(Requests[1].MostDetailedMip, 1u);
+
+			// The rest is requested when a request completes. Recent usage is still required
+			CHECK(TextureStreamer.Update(2).empty());
+			TextureStreamer.CompleteRequest("near", true);
+
+			const auto NextRequests = TextureStreamer.Update(3);
+			CHECK_EQUAL(NextRequests.size(), 1u);
+			for (const auto& Request : NextRequests)
+			{
+				CHECK_EQUAL(Request.TextureName, std::string("far"));
+				CHECK_EQUAL(Request.MostDetailedMip, 3u);
+			}
+		}
+
+		TEST(TextureStreamerEvictsUnusedDetail)
+		{
+			// Budget fits one texture with all mips and the tail of another one
+			FTextureStreamingSettings Settings;
+			Settings.BudgetBytes = GetMipChainSize(0) + GetMipChainSize(TextureTailMip);
+			Settings.NumUnusedFramesToEvict = 2;
+
+			FTextureStreamer TextureStreamer(Settings);
+			TextureStreamer.AddTexture("old", GetMipsSizes(), TextureWidth, TextureTailMip);
+			TextureStreamer.AddTexture("new", GetMipsSizes(), TextureWidth, TextureTailMip);
+
+			TextureStreamer.UpdateTextureUsage("old", 1024.0f, 1);
+			CHECK_EQUAL(TextureStreamer.Update(1).size(), 1u);
+			TextureStreamer.CompleteRequest("old", true);
+			CHECK_EQUAL(TextureStreamer.GetStats().ResidentBytes, Settings.BudgetBytes);
+
+			// The old texture isn't used for more than 2 frames, so its detail is evicted for the new one
+			TextureStreamer.UpdateTextureUsage("new", 1024.0f, 10);
+			const auto Requests = TextureStreamer.Update(10);
+			CHECK_EQUAL(Requests.size(), 2u);
+			CHECK_EQUAL(Requests[0].TextureName, std::string("old"));
+			CHECK_EQUAL(Requests[0].MostDetailedMip, TextureTailMip);
+			CHECK_EQUAL(Requests[0].Priority, 0.0f);
+			CHECK_EQUAL(Requests[1].TextureName, std::string("new"));
+			CHECK_EQUAL(Requests[1].MostDetailedMip, 0u);
+			CHECK(TextureStreamer.GetStats().ResidentBytes <= Settings.BudgetBytes);
+
+			TextureStreamer.CompleteRequest("old", true);
+			TextureStreamer.CompleteRequest("new", true);
+			CHECK_EQUAL(TextureStreamer.GetResidentMip("old"), TextureTailMip);
+			CHECK_EQUAL(TextureStreamer.GetStats().NumEvicted, 1u);
+			CHECK_EQUAL(TextureStreamer.GetStats().NumStreamedIn, 2u);
+		}
+
+		TEST(TextureStreamerFitsRequestsToBudget)
+		{
+			// Detail which is still used isn't evicted, so less detail of the other texture is loaded
+			FTextureStreamingSettings Settings;
+			Settings.BudgetBytes = GetMipChainSize(0) + GetMipChainSize(2);
+
+			FTextureStreamer TextureStreamer(Settings);
+			TextureStreamer.AddTexture("used", GetMipsSizes(), TextureWidth, TextureTailMip);
+			TextureStreamer.AddTexture("other", GetMipsSizes(), TextureWidth, TextureTailMip);
+
+			TextureStreamer.UpdateTextureUsage("used", 1024.0f, 1);
+			TextureStreamer.Update(1);
+			TextureStreamer.CompleteRequest("used", true);
+
+			TextureStreamer.UpdateTextureUsage("used", 1024.0f, 2);
+			TextureStreamer.UpdateTextureUsage("other", 1024.0f, 2);
+			const auto Requests = TextureStreamer.Update(2);
+			CHECK_EQUAL(Requests.size(), 1u);
+			CHECK_EQUAL(Requests[0].TextureName, std::string("other"));
+			CHECK_EQUAL(Requests[0].MostDetailedMip, 2u);
+
+			// Memory of a failed request is released
+			TextureStreamer.CompleteRequest("other", false);
+			CHECK_EQUAL(TextureStreamer.GetResidentMip("other"), TextureTailMip);
+			CHECK_EQUAL(TextureStreamer.GetStats().ResidentBytes, GetMipChainSize(0) + GetMipChainSize(TextureTailMip));
+
+			// Smaller budget evicts unwanted detail only
+			TextureStreamer.SetBudget(GetMipChainSize(TextureTailMip) * 2);
+			TextureStreamer.UpdateTextureUsage("used", 1024.0f, 3);
+			CHECK(TextureStreamer.Update(3).empty());
+			CHECK_EQUAL(TextureStreamer.GetResidentMip("used"), 0u);
+		}
+
+		TEST(TextureStreamerRejectsInvalidCalls)
+		{
+			FTextureStreamer TextureStreamer;
+			TextureStreamer.AddTexture("rock", GetMipsSizes(), TextureWidth, TextureTailMip);
+
+			CHECK_THROWS(TextureStreamer.AddTexture("rock", GetMipsSizes(), TextureWidth, TextureTailMip), std::invalid_argument);
+			CHECK_THROWS(TextureStreamer.AddTexture("", GetMipsSizes(), TextureWidth, TextureTailMip), std::invalid_argument);
+			CHECK_THROWS(TextureStreamer.AddTexture("sand", GetMipsSizes(), TextureWidth, 11), std::invalid_argument);
+			CHECK_THROWS(TextureStreamer.CompleteRequest("rock", true), std::invalid_argument);
+			CHECK_THROWS(TextureStreamer.GetResidentMip("sand"), std::invalid_argument);
+
+			// Textures with requests in flight aren't removed
+			TextureStreamer.UpdateTextureUsage("rock", 1024.0f, 1);
+			TextureStreamer.Update(1);
+			CHECK_THROWS(TextureStreamer.RemoveTexture("rock"), std::invalid_argument);
+
+			TextureStreamer.CompleteRequest("rock", true);
+			TextureStreamer.RemoveTexture("rock");
+			CHECK(!TextureStreamer.HasTexture("rock"));
+			CHECK_EQUAL(TextureStreamer.GetStats().ResidentBytes, 0u);
+			CHECK_EQUAL(TextureStreamer.GetStats().NumTextures, 0u);
+		}
+
+		BENCHMARK(TextureStreamerFlythrough)
+		{
+			// 32x32 textures on a grid, 10 units apart. The camera flies across it, 1 unit per frame,
+			// and the budget fits detail of a small part of them
+			const uint32 NumTexturesPerSide = 32;
+			const auto Spacing = 10.0f;
+			const auto VisibleDistance = 60.0f;
+			const auto NumFrames = 640;
+			const uint64 NumLoadFrames = 3;
+
+			FTextureStreamingSettings Settings;
+			Settings.BudgetBytes = 48 * 1024 * 1024;
+			Settings.MaxNumInFlightRequests = 4;
+			Settings.NumUnusedFramesToEvict = 30;
+
+			FTextureStreamer TextureStreamer(Settings);
+			std::vector<std::string> TexturesNames;
+			for (uint32 iTexture = 0; iTexture < NumTexturesPerSide*NumTexturesPerSide; ++iTexture)
+			{
+				TexturesNames.push_back("texture" + std::to_string(iTexture));
+				TextureStreamer.AddTexture(TexturesNames.back(), GetMipsSizes(), TextureWidth, TextureTailMip);
+			}
+
+			// Requests are completed by loads, which take NumLoadFrames frames
+			std::deque<std::pair<std::string, uint64>> InFlightRequests;
+			std::vector<float> RequiredSizes(TexturesNames.size());
+
+			auto UpdateTime = 0.0;
+			uint64 NumRequests = 0;
+			uint64 NumUsages = 0;
+			uint64 NumResolvedUsages = 0;
+			uint64 MaxResidentBytes = 0;
+			for (uint64 Frame = 1; Frame <= NumFrames; ++Frame)
+			{
+				while (!InFlightRequests.empty() && InFlightRequests.front().second <= Frame)
+				{
+					TextureStreamer.CompleteRequest(InFlightRequests.front().first, true);
+					InFlightRequests.pop_front();
+				}
+
+				const auto CameraX = -10.0f + static_cast<float>(Frame);
+				const auto CameraZ = 0.5f*Spacing*NumTexturesPerSide;
+
+				FBenchTimer Timer;
+				for (uint32 iTexture = 0; iTexture < TexturesNames.size(); ++iTexture)
+				{
+					const auto DeltaX = Spacing*(iTexture % NumTexturesPerSide) - CameraX;
+					const auto DeltaZ = Spacing*(iTexture / NumTexturesPerSide) - CameraZ;
+					const auto Distance = sqrtf(DeltaX*DeltaX + DeltaZ*DeltaZ) + 1.0f;
+
+					// Texel density falls with distance, so far textures want coarse mips only
+					RequiredSizes[iTexture] = Distance < VisibleDistance ? 4096.0f / Distance : 0.0f;
+					if (RequiredSizes[iTexture] > 0.0f)
+					{
+						TextureStreamer.UpdateTextureUsage(TexturesNames[iTexture], RequiredSizes[iTexture], Frame);
+					}
+				}
+
+				const auto Requests = TextureStreamer.Update(Frame);
+				UpdateTime += Timer.GetMilliseconds();
+
+				for (const auto& Request : Requests)
+				{
+					InFlightRequests.emplace_back(Request.TextureName, Frame + NumLoadFrames);
+				}
+				NumRequests += Requests.size();
+				MaxResidentBytes = std::max(MaxResidentBytes, TextureStreamer.GetStats().ResidentBytes);
+
+				// A usage is resolved if its texture has the coarsest mip which isn't less than the required size
+				for (uint32 iTexture = 0; iTexture < TexturesNames.size(); ++iTexture)
+				{
+					if (RequiredSizes[iTexture] <= 0.0f)
+					{
+						continue;
+					}
+
+					auto WantedMip = 0u;
+					while (WantedMip < TextureTailMip && static_cast<float>(TextureWidth >> (WantedMip + 1)) >= RequiredSizes[iTexture])
+					{
+						++WantedMip;
+					}
+
+					++NumUsages;
+					NumResolvedUsages += TextureStreamer.GetResidentMip(TexturesNames[iTexture]) <= WantedMip ? 1 : 0;
+				}
+			}
+
+			const auto& Stats = TextureStreamer.GetStats();
+			CHECK(MaxResidentBytes <= Settings.BudgetBytes);
+			CHECK(Stats.NumEvicted > 0);
+
+			BENCH_REPORT("Flythrough", NumFrames << " frames of " << TexturesNames.size() << " textures, " <<
+				(Settings.BudgetBytes >> 20) << " MB budget, " << Settings.MaxNumInFlightRequests << " requests in flight");
+			BENCH_REPORT("Update", 1000.0 * UpdateTime / NumFrames << " us per frame, " <<
+				TexturesNames.size() * NumFrames / (UpdateTime / 1000.0) / 1e6 << " M textures/s");
+			BENCH_REPORT("Requests", NumRequests << " requests, " << Stats.NumStreamedIn << " streamed in, " <<
+				Stats.NumEvicted << " evicted, " << (MaxResidentBytes >> 20) << " MB max resident");
+			BENCH_REPORT("Resolution", 100.0 * NumResolvedUsages / std::max<uint64>(NumUsages, 1) <<
+				"% of " << NumUsages << " usages had the wanted mip resident");
+		}
+	}
+}
@@ -0,0 +1,277 @@
+#include <cmath>
+#include <random>
+
+#include "TransformStore.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/** @brief Returns true if elements of the matrices differ by the tolerance at most
+			  * @param A (FXMMATRIX)
+			  * @param B (CXMMATRIX)
+			  * @param Tolerance (float)
+			  * @return (bool)
+			  */
+			bool AreMatricesNear(FXMMATRIX A, CXMMATRIX B, float Tolerance = 1e-4f)
+			{
+				XMFLOAT4X4 AValues;
+				XMFLOAT4X4 BValues;
+				XMStoreFloat4x4(&AValues, A);
+				XMStoreFloat4x4(&BValues, B);
+				for (uint32 iRow = 0; iRow < 4; ++iRow)
+				{
+					for (uint32 iColumn = 0; iColumn < 4; ++iColumn)
+					{
+						if (std::abs(AValues(iRow, iColumn) - BValues(iRow, iColumn)) > Tolerance)
+						{
+							return false;
+						}
+					}
+				}
+				return true;
+			}
+
+			/** @brief Returns the world matrix as objects computed it before the store (scale, rotation, translation)
+			  * @param Position (const XMFLOAT3 &)
+			  * @param Rotation (const XMFLOAT4 &)
+			  * @param Scale (const XMFLOAT3 &)
+			  * @return (DirectX::XMMATRIX)
+			  */
+			XMMATRIX GetExpectedWorldTransform(const XMFLOAT3& Position, const XMFLOAT4& Rotation, const XMFLOAT3& Scale)
+			{
+				return XMMatrixMultiply(XMMatrixMultiply(
+					XMMatrixScaling(Scale.x, Scale.y, Scale.z),
+					XMMatrixRotationQuaternion(XMQuaternionNormalize(XMLoadFloat4(&Rotation)))),
+					XMMatrixTranslation(Position.x, Position.y, Position.z));
+			}
+
+			/*!
+			 * \struct FRandomTransform
+			 *
+			 * \brief Components of a transform generated by tests
+			 */
+			struct FRandomTransform
+			{
+				XMFLOAT3 Position;
+				XMFLOAT4 Rotation;
+				XMFLOAT3 Scale;
+			};
+
+			FRandomTransform GetRandomTransform(std::mt19937& Random)
+			{
+				std::uniform_real_distribution<float> Distribution(-10.0f, 10.0f);
+				std::uniform_real_distribution<float> ScaleDistribution(0.1f, 4.0f);
+
+				FRandomTransform Transform;
+				Transform.Position = { Distribution(Random), Distribution(Random), Distribution(Random) };
+				Transform.Rotation = { Distribution(Random), Distribution(Random), Distribution(Random), Distribution(Random) };
+				Transform.Scale = { ScaleDistribution(Random), ScaleDistribution(Random), ScaleDistribution(Random) };
+				return Transform;
+			}
+		}
+
+		TEST(TransformStoreComputesWorldTransforms)
+		{
+			FTransformStore TransformStore;
+			std::vector<FTransformHandle> Handles;
+			std::vector<FRandomTransform> Transforms;
+
+			// Number of transforms isn't multiple of the block size, so the last block has unused lanes
+			std::mt19937 Random(25);
+			for (auto iTransform = 0; iTransform < 37; ++iTransform)
+			{
+				Transforms.push_back(GetRandomTransform(Random));
+				Handles.push_back(TransformStore.Create(Transforms.back().Position, Transforms.back().Rotation, Transforms.back().Scale));
+			}
+			TransformStore.UpdateWorldTransforms();
+			CHECK_EQUAL(TransformStore.GetStats().NumUpdatedBlocks, 10u);
+
+			auto bNear = true;
+			for (std::size_t iTransform = 0; iTransform < Handles.size(); ++iTransform)
+			{
+				const auto& Transform = Transforms[iTransform];
+				bNear = bNear && AreMatricesNear(TransformStore.GetWorldTransform(Handles[iTransform]),
+					GetExpectedWorldTransform(Transform.Position, Transform.Rotation, Transform.Scale));
+			}
+			CHECK(bNear);
+
+			// Rotations are stored normalized
+			const auto Rotation = TransformStore.GetRotation(Handles[0]);
+			CHECK_NEAR(XMVectorGetX(XMVector4Length(XMLoadFloat4(&Rotation))), 1.0f, 1e-5f);
+			CHECK_EQUAL(TransformStore.GetStats().NumLazyUpdatedBlocks, 0u);
+		}
+
+		TEST(TransformStoreUpdatesDirtyBlocksOnly)
+		{
+			FTransformStore TransformStore;
+			std::vector<FTransformHandle> Handles;
+			for (auto iTransform = 0; iTransform < 16; ++iTransform)
+			{
+				Handles.push_back(TransformStore.Create(XMFLOAT3(float(iTransform), 0.0f, 0.0f)));
+			}
+			TransformStore.UpdateWorldTransforms();
+			CHECK_EQUAL(TransformStore.GetStats().NumUpdatedBlocks, 4u);
+
+			TransformStore.UpdateWorldTransforms();
+			CHECK_EQUAL(TransformStore.GetStats().NumUpdatedBlocks, 0u);
+
+			// Setters mark only blocks of their transforms
+			TransformStore.SetPosition(Handles[5], XMFLOAT3(0.0f, 5.0f, 0.0f));
+			TransformStore.SetScale(Handles[6], XMFLOAT3(2.0f, 2.0f, 2.0f));
+			TransformStore.SetRotation(Handles[13], XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f));
+			TransformStore.UpdateWorldTransforms();
+			CHECK_EQUAL(TransformStore.GetStats().NumUpdatedBlocks, 2u);
+
+			// Reads of dirty transforms recompute their blocks at once, so they're never stale
+			TransformStore.SetPosition(Handles[0], XMFLOAT3(1.0f, 2.0f, 3.0f));
+			CHECK(AreMatricesNear(TransformStore.GetWorldTransform(Handles[0]), XMMatrixTranslation(1.0f, 2.0f, 3.0f)));
+			CHECK_EQUAL(TransformStore.GetStats().NumLazyUpdatedBlocks, 1u);
+
+			TransformStore.UpdateWorldTransforms();
+			CHECK_EQUAL(TransformStore.GetStats().NumUpdatedBlocks, 0u);
+			CHECK_EQUAL(TransformStore.GetStats().NumLazyUpdatedBlocks, 0u);
+		}
+
+		TEST(TransformStoreKeepsOverriddenWorldTransforms)
+		{
+			FTransformStore TransformStore;
+			const auto Handle = TransformStore.Create(XMFLOAT3(1.0f, 0.0f, 0.0f));
+			const auto Neighbour = TransformStore.Create(XMFLOAT3(2.0f, 0.0f, 0.0f));
+
+			// Updates of the block don't replace the overridden matrix
+			const auto Reflection = XMMatrixScaling(1.0f, -1.0f, 1.0f);
+			TransformStore.SetWorldTransform(Handle, Reflection);
+			TransformStore.SetPosition(Neighbour, XMFLOAT3(3.0f, 0.0f, 0.0f));
+			TransformStore.UpdateWorldTransforms();
+			CHECK(AreMatricesNear(TransformStore.GetWorldTransform(Handle), Reflection));
+			CHECK(AreMatricesNear(TransformStore.GetWorldTransform(Neighbour), XMMatrixTranslation(3.0f, 0.0f, 0.0f)));
+
+			// Setting a component cancels the override
+			TransformStore.SetPosition(Handle, XMFLOAT3(4.0f, 0.0f, 0.0f));
+			CHECK(AreMatricesNear(TransformStore.GetWorldTransform(Handle), XMMatrixTranslation(4.0f, 0.0f, 0.0f)));
+		}
+
+		TEST(TransformStoreInvalidatesDestroyedHandles)
+		{
+			FTransformStore TransformStore;
+			std::vector<FTransformHandle> Handles;
+			for (auto iTransform = 0; iTransform < 9; ++iTransform)
+			{
+				Handles.push_back(TransformStore.Create(XMFLOAT3(float(iTransform), 0.0f, 0.0f)));
+			}
+			TransformStore.UpdateWorldTransforms();
+
+			// The last transform is moved to the destroyed one's place, and its handle stays valid
+			TransformStore.SetPosition(Handles[8], XMFLOAT3(0.0f, 8.0f, 0.0f));
+			TransformStore.Destroy(Handles[2]);
+			CHECK_EQUAL(TransformStore.GetNumTransforms(), 8u);
+			CHECK(!TransformStore.Contains(Handles[2]));
+			CHECK(AreMatricesNear(TransformStore.GetWorldTransform(Handles[8]), XMMatrixTranslation(0.0f, 8.0f, 0.0f)));
+			for (auto iTransform : { 0, 1, 3, 4, 5, 6, 7 })
+			{
+				CHECK(AreMatricesNear(TransformStore.GetWorldTransform(Handles[iTransform]),
+					XMMatrixTranslation(float(iTransform), 0.0f, 0.0f)));
+			}
+
+			CHECK_THROWS(TransformStore.Destroy(Handles[2]), std::invalid_argument);
+			CHECK_THROWS(TransformStore.GetPosition(Handles[2]), std::invalid_argument);
+			CHECK_THROWS(TransformStore.SetScale(FTransformHandle(), XMFLOAT3(1.0f, 1.0f, 1.0f)), std::invalid_argument);
+
+			// The slot is reused with another generation
+			const auto Reused = TransformStore.Create();
+			CHECK_EQUAL(Reused.Index, Handles[2].Index);
+			CHECK(!TransformStore.Contains(Handles[2]));
+			CHECK(TransformStore.Contains(Reused));
+
+			for (const auto Handle : Handles)
+			{
+				if (TransformStore.Contains(Handle))
+				{
+					TransformStore.Destroy(Handle);
+				}
+			}
+			TransformStore.Destroy(Reused);
+			CHECK_EQUAL(TransformStore.GetNumTransforms(), 0u);
+		}
+
+		BENCHMARK(TransformStoreUpdateWith100kObjects)
+		{
+			const uint32 NumObjects = 100000;
+			const auto NumFrames = 10;
+
+			std::mt19937 Random(25);
+			std::vector<FRandomTransform> Transforms;
+			for (uint32 iObject = 0; iObject < NumObjects; ++iObject)
+			{
+				Transforms.push_back(GetRandomTransform(Random));
+			}
+
+			// As objects did before the store: every setter recomputes the object's matrix
+			std::vector<XMFLOAT4X4> WorldTransforms(NumObjects);
+			auto SettersTime = 1e9;
+			for (auto iFrame = 0; iFrame < NumFrames; ++iFrame)
+			{
+				FBenchTimer Timer;
+				for (uint32 iObject = 0; iObject < NumObjects; ++iObject)
+				{
+					const auto& Transform = Transforms[iObject];
+					const auto Position = XMFLOAT3(Transform.Position.x + iFrame, Transform.Position.y, Transform.Position.z);
+					XMStoreFloat4x4(&WorldTransforms[iObject], GetExpectedWorldTransform(Position, Transform.Rotation, Transform.Scale));
+					XMStoreFloat4x4(&WorldTransforms[iObject], GetExpectedWorldTransform(Position, Transform.Rotation, Transform.Scale));
+				}
+				SettersTime = std::min(SettersTime, Timer.GetMilliseconds());
+			}
+
+			FTransformStore TransformStore;
+			std::vector<FTransformHandle> Handles;
+			for (const auto& Transform : Transforms)
+			{
+				Handles.push_back(TransformStore.Create(Transform.Position, Transform.Rotation, Transform.Scale));
+			}
+
+			// Positions and rotations of all objects are set, and dirty blocks are updated once per frame
+			auto StoreTime = 1e9;
+			for (auto iFrame = 0; iFrame < NumFrames; ++iFrame)
+			{
+				FBenchTimer Timer;
+				for (uint32 iObject = 0; iObject < NumObjects; ++iObject)
+				{
+					const auto& Transform = Transforms[iObject];
+					TransformStore.SetPosition(Handles[iObject],
+						XMFLOAT3(Transform.Position.x + iFrame, Transform.Position.y, Transform.Position.z));
+					TransformStore.SetRotation(Handles[iObject], Transform.Rotation);
+				}
+				TransformStore.UpdateWorldTransforms();
+				StoreTime = std::min(StoreTime, Timer.GetMilliseconds());
+			}
+
+			// Only the block of the moved object is updated
+			auto OneMovedTime = 1e9;
+			for (auto iFrame = 0; iFrame < NumFrames; ++iFrame)
+			{
+				FBenchTimer Timer;
+				TransformStore.SetPosition(Handles[iFrame], XMFLOAT3(0.0f, float(iFrame), 0.0f));
+				TransformStore.UpdateWorldTransforms();
+				OneMovedTime = std::min(OneMovedTime, Timer.GetMilliseconds());
+			}
+			CHECK_EQUAL(TransformStore.GetStats().NumUpdatedBlocks, 1u);
+
+			// Both ways give the same matrices
+			auto bNear = true;
+			for (uint32 iObject = NumFrames; iObject < NumObjects; iObject += 97)
+			{
+				bNear = bNear && AreMatricesNear(TransformStore.GetWorldTransform(Handles[iObject]),
+					XMLoadFloat4x4(&WorldTransforms[iObject]));
+			}
+			CHECK(bNear);
+
+			BENCH_REPORT("setters", NumObjects << " objects, " << SettersTime << " ms");
+			BENCH_REPORT("store", NumObjects << " objects, " << StoreTime << " ms, " << SettersTime / StoreTime << "x faster");
+			BENCH_REPORT("store, 1 moved", OneMovedTime << " ms");
+		}
+	}
+}
@@ -0,0 +1,233 @@
+#include <deque>
+#include <random>
+
+#include "UploadRing.h"
+#include "TestHarness.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			/*!
+			 * \class FFakeFence
+			 *
+			 * \brief Stands for the GPU's fence: values are signaled at submits and completed by the test,
+			 * so frames in flight are simulated without a device
+			 */
+			class FFakeFence
+			{
+			public:
+				/** @brief Returns the next value, as the queue is signaled after executing copies
+				  * @return (uint64)
+				  */
+				uint64 Signal() noexcept
+				{
+					return ++SignaledValue;
+				}
+
+				/** @brief Completes values up to the value
+				  * @param Value Not greater than the signaled one (uint64)
+				  * @return (void)
+				  */
+				void Complete(uint64 Value) noexcept
+				{
+					CompletedValue = std::max(CompletedValue, std::min(Value, SignaledValue));
+				}
+
+				uint64 GetSignaledValue() const noexcept
+				{
+					return SignaledValue;
+				}
+
+				uint64 GetCompletedValue() const noexcept
+				{
+					return CompletedValue;
+				}
+
+			private:
+				uint64 SignaledValue = 0;
+				uint64 CompletedValue = 0;
+			};
+		}
+
+		TEST(UploadRingRecyclesRangesByFence)
+		{
+			FFakeFence Fence;
+			FUploadRing UploadRing(1024);
+
+			const auto First = UploadRing.Allocate(256, 16);
+			const auto Second = UploadRing.Allocate(256, 16);
+			CHECK_EQUAL(First.Offset, 0u);
+			CHECK_EQUAL(Second.Offset, 256u);
+			const auto FirstFenceValue = Fence.Signal();
+			UploadRing.Submit(FirstFenceValue);
+
+			CHECK(UploadRing.Allocate(512, 16).IsValid());
+			UploadRing.Submit(Fence.Signal());
+			CHECK_EQUAL(UploadRing.GetNumSubmissions(), 2u);
+
+			// Ranges of submissions in flight aren't reused
+			CHECK_EQUAL(UploadRing.GetUsedSize(), 1024u);
+			CHECK(!UploadRing.Allocate(16, 16).IsValid());
+			UploadRing.Reclaim(Fence.GetCompletedValue());
+			CHECK(!UploadRing.Allocate(16, 16).IsValid());
+
+			// Completion of the first fence value frees ranges of its submission only
+			Fence.Complete(FirstFenceValue);
+			UploadRing.Reclaim(Fence.GetCompletedValue());
+			CHECK_EQUAL(UploadRing.GetUsedSize(), 512u);
+			CHECK_EQUAL(UploadRing.GetNumSubmissions(), 1u);
+
+			const auto Wrapped = UploadRing.Allocate(512, 16);
+			CHECK_EQUAL(Wrapped.Offset, 0u);
+			UploadRing.Submit(Fence.Signal());
+
+			Fence.Complete(Fence.GetSignaledValue());
+			UploadRing.Reclaim(Fence.GetCompletedValue());
+			CHECK(UploadRing.IsEmpty());
+			CHECK_EQUAL(UploadRing.GetNumSubmissions(), 0u);
+		}
+
+		TEST(UploadRingSkipsEndOfBuffer)
+		{
+			FFakeFence Fence;
+			FUploadRing UploadRing(1024);
+
+			// Offsets are aligned, and padding is used space
+			CHECK_EQUAL(UploadRing.Allocate(100, 16).Offset, 0u);
+			CHECK_EQUAL(UploadRing.Allocate(100, 256).Offset, 256u);
+			CHECK_EQUAL(UploadRing.GetUsedSize(), 356u);
+			UploadRing.Submit(Fence.Signal());
+
+			CHECK_EQUAL(UploadRing.Allocate(500, 16).Offset, 368u);
+			UploadRing.Submit(Fence.Signal());
+			Fence.Complete(1);
+			UploadRing.Reclaim(Fence.GetCompletedValue());
+
+			// The range doesn't fit the end of the buffer, so it's allocated at the start. The skipped end is used until reclaim
+			const auto Wrapped = UploadRing.Allocate(300, 16);
+			CHECK_EQUAL(Wrapped.Offset, 0u);
+			CHECK_EQUAL(UploadRing.GetUsedSize(), 1024u - 356u + 300u);
+
+			// Ranges larger than the ring never fit it
+			CHECK(!UploadRing.Allocate(1025, 16).IsValid());
+		}
+
+		TEST(UploadRingKeepsNotSubmittedRanges)
+		{
+			FUploadRing UploadRing(1024);
+			UploadRing.Submit(1);
+			UploadRing.Allocate(128, 16);
+
+			// Ranges allocated after the last submit belong to the next one
+			UploadRing.Reclaim(UINT64_MAX);
+			CHECK_EQUAL(UploadRing.GetUsedSize(), 128u);
+			CHECK_EQUAL(UploadRing.GetNumSubmissions(), 0u);
+
+			// Submits with the same fence value are freed together
+			UploadRing.Submit(2);
+			UploadRing.Allocate(128, 16);
+			UploadRing.Submit(2);
+			CHECK_EQUAL(UploadRing.GetNumSubmissions(), 1u);
+			UploadRing.Reclaim(2);
+			CHECK(UploadRing.IsEmpty());
+		}
+
+		TEST(UploadRingRejectsInvalidCalls)
+		{
+			CHECK_THROWS(FUploadRing(0), std::invalid_argument);
+
+			FUploadRing UploadRing(1024);
+			CHECK_THROWS(UploadRing.Allocate(0, 16), std::invalid_argument);
+			CHECK_THROWS(UploadRing.Allocate(16, 0), std::invalid_argument);
+			CHECK_THROWS(UploadRing.Allocate(16, 24), std::invalid_argument);
+			CHECK_THROWS(UploadRing.Allocate(16, 2048), std::invalid_argument);
+
+			UploadRing.Submit(5);
+			CHECK_THROWS(UploadRing.Submit(4), std::invalid_argument);
+		}
+
+		TEST(UploadRingDoesNotReuseRangesInFlight)
+		{
+			// Frames are submitted every step, and the GPU lags behind by a few frames.
+			// The ring fits uploads of all frames in flight and the frame being recorded
+			const uint64 RingSize = 256 * 1024;
+			const uint64 NumFramesInFlight = 3;
+
+			FFakeFence Fence;
+			FUploadRing UploadRing(RingSize);
+
+			struct FInFlightRange
+			{
+				uint64 Offset = 0;
+				uint64 Size = 0;
+				uint64 FenceValue = 0;
+			};
+			std::deque<FInFlightRange> InFlightRanges;
+			std::vector<FInFlightRange> FrameRanges;
+
+			std::mt19937 Random(23);
+			auto NumFailedAllocations = 0;
+			auto bOverlap = false;
+			for (auto iFrame = 0; iFrame < 2000; ++iFrame)
+			{
+				const auto NumUploads = Random() % 8;
+				for (uint32 iUpload = 0; iUpload < NumUploads; ++iUpload)
+				{
+					const auto Allocation = UploadRing.Allocate(1 + Random() % 8192, 256);
+					if (!Allocation.IsValid())
+					{
+						++NumFailedAllocations;
+						continue;
+					}
+
+					for (const auto& Range : InFlightRanges)
+					{
+						bOverlap = bOverlap || (Allocation.Offset < Range.Offset + Range.Size &&
+							Range.Offset < Allocation.Offset + Allocation.Size);
+					}
+					for (const auto& Range : FrameRanges)
+					{
+						bOverlap = bOverlap || (Allocation.Offset < Range.Offset + Range.Size &&
+							Range.Offset < Allocation.Offset + Allocation.Size);
+					}
+
+					FInFlightRange Range;
+					Range.Offset = Allocation.Offset;
+					Range.Size = Allocation.Size;
+					FrameRanges.push_back(Range);
+				}
+
+				const auto FenceValue = Fence.Signal();
+				UploadRing.Submit(FenceValue);
+				for (auto& Range : FrameRanges)
+				{
+					Range.FenceValue = FenceValue;
+					InFlightRanges.push_back(Range);
+				}
+				FrameRanges.clear();
+
+				if (FenceValue > NumFramesInFlight)
+				{
+					Fence.Complete(FenceValue - NumFramesInFlight);
+				}
+				UploadRing.Reclaim(Fence.GetCompletedValue());
+				while (!InFlightRanges.empty() && InFlightRanges.front().FenceValue <= Fence.GetCompletedValue())
+				{
+					InFlightRanges.pop_front();
+				}
+
+				CHECK(UploadRing.GetUsedSize() <= RingSize);
+			}
+
+			CHECK(!bOverlap);
+			CHECK_EQUAL(NumFailedAllocations, 0);
+
+			Fence.Complete(Fence.GetSignaledValue());
+			UploadRing.Reclaim(Fence.GetCompletedValue());
+			CHECK(UploadRing.IsEmpty());
+		}
+	}
+}
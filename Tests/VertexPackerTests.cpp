@@ -0,0 +1,135 @@
+#include "VertexPacker.h"
+#include "MeshTestUtils.h"
+
+namespace WoodenEngine
+{
+	namespace Tests
+	{
+		namespace
+		{
+			FVertexPackingStats PackAndMeasure(
+				const FMeshRawData& MeshData,
+				EVertexFormat VertexFormat,
+				SVertexQuantizationData* Quantization)
+			{
+				std::vector<uint8> PackedVertices(MeshData.Vertices.size()*FVertexPacker::GetVertexStride(VertexFormat));
+
+				FVertexPacker VertexPacker;
+				const auto PackingStats = VertexPacker.Pack(MeshData, VertexFormat, PackedVertices.data(), Quantization);
+
+				// Pack only encodes, errors are measured on demand
+				CHECK_EQUAL(PackingStats.MaxPositionError, 0.0f);
+				CHECK_EQUAL(PackingStats.MaxNormalError, 0.0f);
+
+				return FVertexPacker::MeasureErrors(MeshData, VertexFormat, PackedVertices.data(), *Quantization);
+			}
+		}
+
+		TEST(PackedVerticesRoundTrip)
+		{
+			FMeshGenerator MeshGenerator;
+			auto MeshData = MeshGenerator.CreateGeoSphere(2.0f, 4);
+
+			SVertexQuantizationData Quantization;
+			const auto Stats = PackAndMeasure(*MeshData, EVertexFormat::Packed, &Quantization);
+
+			CHECK_EQUAL(Stats.NumBytesAfter, MeshData->Vertices.size()*sizeof(SPackedVertexData));
+			CHECK(Stats.NumBytesAfter < Stats.NumBytesBefore);
+			CHECK_EQUAL(Stats.MaxPositionError, 0.0f);
+			CHECK(Stats.MaxNormalError < 0.25f);
+			CHECK(Stats.MaxTangentError < 0.5f);
+
+			// Half floats of uvs in [0, 1]
+			CHECK(Stats.MaxTexCError < 1e-3f);
+		}
+
+		TEST(QuantizedVerticesRoundTrip)
+		{
+			FMeshGenerator MeshGenerator;
+			auto MeshData = MeshGenerator.CreateLandscapeGrid(40.0f, 40.0f, 80, 80);
+
+			SVertexQuantizationData Quantization;
+			const auto Stats = PackAndMeasure(*MeshData, EVertexFormat::Quantized, &Quantization);
+
+			// Half of a unorm16 step along every axis of the bounds
+			const auto& Scale = Quantization.PositionScale;
+			const auto MaxPositionError = 0.5f / 65535.0f*std::sqrt(Scale.x*Scale.x + Scale.y*Scale.y + Scale.z*Scale.z);
+
+			CHECK(Stats.MaxPositionError <= MaxPositionError*1.01f);
+			CHECK(Stats.MaxNormalError < 0.25f);
+			CHECK(Stats.MaxTangentError < 0.5f);
+			CHECK(Stats.MaxTexCError < 1e-4f);
+		}
+
+		TEST(QuantizedVerticesOfFlatMesh)
+		{
+			FMeshGenerator MeshGenerator;
+			auto MeshData = MeshGenerator.CreateGrid(10.0f, 10.0f, 8, 8);
+
+			// Degenerate axis of bounds is stored as zeros and decoded to the offset
+			SVertexQuantizationData Quantization;
+			const auto Stats = PackAndMeasure(*MeshData, EVertexFormat::Quantized, &Quantization);
+
+			CHECK_EQUAL(Quantization.PositionScale.y, 0.0f);
+			CHECK(Stats.MaxPositionError < 1e-3f);
+		}
+
+		TEST(NormalTangentOfAxes)
+		{
+			const XMFLOAT3 Axes[] = {
+				{ 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f },
+				{ 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f },
+				{ 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f } };
+
+			for (const auto& Normal : Axes)
+			{
+				// Any axis orthogonal to the normal
+				const XMFLOAT3 Tangent = { Normal.y + Normal.z, Normal.x, 0.0f };
+
+				XMFLOAT3 DecodedNormal;
+				XMFLOAT3 DecodedTangent;
+				FVertexPacker::DecodeNormalTangent(
+					FVertexPacker::EncodeNormalTangent(Normal, Tangent), &DecodedNormal, &DecodedTangent);
+
+				// 10-bit octahedral coordinates don't hit the zero of [0, 1] exactly
+				CHECK_NEAR(DecodedNormal.x, Normal.x, 2e-3f);
+				CHECK_NEAR(DecodedNormal.y, Normal.y, 2e-3f);
+				CHECK_NEAR(DecodedNormal.z, Normal.z, 2e-3f);
+
+				const auto TangentDot =
+					DecodedTangent.x*Tangent.x + DecodedTangent.y*Tangent.y + DecodedTangent.z*Tangent.z;
+				CHECK(TangentDot > 0.999f);
+			}
+		}
+
+		BENCHMARK(PackSkullAndMeasureErrors)
+		{
+			auto MeshData = LoadSkullMesh();
+
+			FVertexPacker VertexPacker;
+			for (auto VertexFormat : { EVertexFormat::Packed, EVertexFormat::Quantized })
+			{
+				std::vector<uint8> PackedVertices(
+					MeshData->Vertices.size()*FVertexPacker::GetVertexStride(VertexFormat));
+				SVertexQuantizationData Quantization;
+
+				FBenchTimer PackTimer;
+				const auto PackingStats = VertexPacker.Pack(*MeshData, VertexFormat, PackedVertices.data(), &Quantization);
+				const auto PackTime = PackTimer.GetMilliseconds();
+
+				FBenchTimer MeasureTimer;
+				const auto Stats = FVertexPacker::MeasureErrors(*MeshData, VertexFormat, PackedVertices.data(), Quantization);
+				const auto MeasureTime = MeasureTimer.GetMilliseconds();
+
+				CHECK(Stats.MaxNormalError < 0.25f);
+
+				const std::string FormatName = VertexFormat == EVertexFormat::Packed ? "packed" : "quantized";
+				BENCH_REPORT(FormatName,
+					MeshData->Vertices.size() << " vertices, " << PackingStats.NumBytesBefore << " -> " <<
+					PackingStats.NumBytesAfter << " bytes, pack " << PackTime << " ms, round-trip check " <<
+					MeasureTime << " ms, max errors: position " << Stats.MaxPositionError << ", normal " <<
+					Stats.MaxNormalError << " deg, tangent " << Stats.MaxTangentError << " deg");
+			}
+		}
+	}
+}